@@ -9,12 +9,119 @@
 #include "tensor_tools.h"
 #include "../image_transforms/interpolation.h"
 #include "../threads.h"
+#include "../simd.h"
+#include <mutex>
+#include <cstring>
 
 namespace dlib
 {
+    namespace
+    {
+        struct dnn_cpu_thread_settings
+        {
+            std::mutex m;
+            bool use_default_thread_pool = true;
+            // Only used when use_default_thread_pool == false.  A null pool means all
+            // the kernels run in the calling thread.
+            std::unique_ptr<thread_pool> pool;
+        };
+
+        dnn_cpu_thread_settings& get_dnn_cpu_thread_settings (
+        )
+        {
+            static dnn_cpu_thread_settings var;
+            return var;
+        }
+    }
+
+    size_t dnn_cpu_num_threads (
+    )
+    {
+        auto& settings = get_dnn_cpu_thread_settings();
+        std::lock_guard<std::mutex> lock(settings.m);
+        if (settings.use_default_thread_pool)
+            return std::max<size_t>(1, default_thread_pool().num_threads_in_pool());
+        else if (settings.pool)
+            return settings.pool->num_threads_in_pool();
+        else
+            return 1;
+    }
+
+    void set_dnn_cpu_num_threads (
+        size_t num_threads
+    )
+    {
+        DLIB_CASSERT(num_threads > 0);
+        auto& settings = get_dnn_cpu_thread_settings();
+        std::lock_guard<std::mutex> lock(settings.m);
+        settings.use_default_thread_pool = false;
+        settings.pool.reset();
+        if (num_threads > 1)
+            settings.pool.reset(new thread_pool(num_threads));
+    }
+
     namespace cpu 
     {
 
+    // ------------------------------------------------------------------------------------
+
+        namespace
+        {
+            thread_pool* get_thread_pool (
+            )
+            {
+                auto& settings = get_dnn_cpu_thread_settings();
+                std::lock_guard<std::mutex> lock(settings.m);
+                if (settings.use_default_thread_pool)
+                    return &default_thread_pool();
+                return settings.pool.get();
+            }
+
+            // The smallest amount of work, roughly measured in floats touched, that is
+            // worth handing to another thread.  Anything smaller runs serially since the
+            // cost of waking up the thread pool would dominate.
+            const long min_work_per_task = 1<<15;
+
+            template <typename T>
+            void parallel_for_work (
+                long begin,
+                long end,
+                long work_per_item,
+                const T& funct
+            )
+            /*!
+                requires
+                    - funct(sub_begin, sub_end) is a valid expression.
+                ensures
+                    - Calls funct() on a set of non-overlapping sub ranges that together
+                      cover [begin, end), in parallel on the thread pool selected by
+                      set_dnn_cpu_num_threads().  The range is only split up if each piece
+                      gets at least min_work_per_task units of work, where each item in
+                      the range accounts for work_per_item units.
+            !*/
+            {
+                const long num = end-begin;
+                if (num <= 0)
+                    return;
+
+                thread_pool* tp = get_thread_pool();
+                const long num_workers = tp ? static_cast<long>(tp->num_threads_in_pool()) : 0;
+                const long max_tasks = std::min(num, num*std::max(1L,work_per_item)/min_work_per_task);
+                // Give each worker a few tasks so uneven pieces still balance out.
+                const long num_tasks = std::min(max_tasks, 4*num_workers);
+                if (num_workers <= 1 || num_tasks <= 1)
+                {
+                    funct(begin, end);
+                    return;
+                }
+
+                parallel_for(*tp, 0, num_tasks, [&](long i)
+                {
+                    funct(begin + num*i/num_tasks, begin + num*(i+1)/num_tasks);
+                }, 1);
+            }
+        }
+
     // -----------------------------------------------------------------------------------
 
         void multiply (
@@ -41,16 +148,19 @@ namespace dlib
             const auto s2 = src2.host();
             if (dest.size() == src1.size() && src1.size() == src2.size())
             {
-                if (add_to)
+                parallel_for_work(0, dest.size(), 1, [&](long begin, long end)
                 {
-                    for (size_t i = 0; i < src1.size(); ++i)
-                        d[i] += s1[i]*s2[i];
-                }
-                else
-                {
-                    for (size_t i = 0; i < src1.size(); ++i)
-                        d[i] = s1[i]*s2[i];
-                }
+                    if (add_to)
+                    {
+                        for (long i = begin; i < end; ++i)
+                            d[i] += s1[i]*s2[i];
+                    }
+                    else
+                    {
+                        for (long i = begin; i < end; ++i)
+                            d[i] = s1[i]*s2[i];
+                    }
+                });
             }
             else if (dest.num_samples() == 1)
             {
@@ -64,16 +174,19 @@ namespace dlib
             }
             else
             {
-                if (add_to)
-                {
-                    for (size_t i = 0; i < max_size; ++i)
-                        d[i] += s1[i%src1.size()]*s2[i%src2.size()];
-                }
-                else
+                parallel_for_work(0, max_size, 1, [&](long begin, long end)
                 {
-                    for (size_t i = 0; i < max_size; ++i)
-                        d[i] = s1[i%src1.size()]*s2[i%src2.size()];
-                }
+                    if (add_to)
+                    {
+                        for (long i = begin; i < end; ++i)
+                            d[i] += s1[i%src1.size()]*s2[i%src2.size()];
+                    }
+                    else
+                    {
+                        for (long i = begin; i < end; ++i)
+                            d[i] = s1[i%src1.size()]*s2[i%src2.size()];
+                    }
+                });
             }
         }
 
@@ -93,38 +206,26 @@ namespace dlib
             {
                 DLIB_CASSERT(src2.num_samples() == 1 && src2.nr() == 1 && src2.nc() == 1 && src2.k() == src1.k());
 
-                if (add_to)
+                const long plane = dest.nr()*dest.nc();
+                parallel_for_work(0, dest.num_samples()*dest.k(), plane, [&](long begin, long end)
                 {
-                    for (long n = 0; n < dest.num_samples(); ++n)
+                    for (long i = begin; i < end; ++i)
                     {
-                        for (long k = 0; k < dest.k(); ++k)
+                        const float scale = s2[i%dest.k()];
+                        const float* sp = s1 + i*plane;
+                        float* dp = d + i*plane;
+                        if (add_to)
                         {
-                            for (long r = 0; r < dest.nr(); ++r)
-                            {
-                                for (long c = 0; c < dest.nc(); ++c)
-                                {
-                                    *d++ += (*s1++)*s2[k];
-                                }
-                            }
+                            for (long j = 0; j < plane; ++j)
+                                dp[j] += sp[j]*scale;
                         }
-                    }
-                }
-                else
-                {
-                    for (long n = 0; n < dest.num_samples(); ++n)
-                    {
-                        for (long k = 0; k < dest.k(); ++k)
+                        else
                         {
-                            for (long r = 0; r < dest.nr(); ++r)
-                            {
-                                for (long c = 0; c < dest.nc(); ++c)
-                                {
-                                    *d++ = (*s1++)*s2[k];
-                                }
-                            }
+                            for (long j = 0; j < plane; ++j)
+                                dp[j] = sp[j]*scale;
                         }
                     }
-                }
+                });
             }
             else
             {
@@ -137,19 +238,20 @@ namespace dlib
                         d[k] = 0;
                 }
 
-                for (long n = 0; n < src1.num_samples(); ++n)
+                const long plane = src1.nr()*src1.nc();
+                parallel_for_work(0, src1.k(), src1.num_samples()*plane, [&](long begin, long end)
                 {
-                    for (long k = 0; k < src1.k(); ++k)
+                    for (long k = begin; k < end; ++k)
                     {
-                        for (long r = 0; r < src1.nr(); ++r)
+                        for (long n = 0; n < src1.num_samples(); ++n)
                         {
-                            for (long c = 0; c < src1.nc(); ++c)
-                            {
-                                d[k] += (*s1++)*(*s2++);
-                            }
+                            const float* p1 = s1 + (n*src1.k() + k)*plane;
+                            const float* p2 = s2 + (n*src1.k() + k)*plane;
+                            for (long j = 0; j < plane; ++j)
+                                d[k] += p1[j]*p2[j];
                         }
                     }
-                }
+                });
             }
         }
 
@@ -171,50 +273,32 @@ namespace dlib
             if (dest.size() == 0)
                 return;
 
-            if (add_to)
-            {
-                auto d = dest.host();
-                auto s = src.host();
-                auto scal = scales.host();
+            auto d = add_to ? dest.host() : dest.host_write_only();
+            auto s = src.host();
+            auto scal = scales.host();
 
-                for (long n = 0; n < src.num_samples(); ++n)
+            // scales has one value per channel in each sample, so it lines up with the
+            // image planes of src.
+            const long plane = src.nr()*src.nc();
+            parallel_for_work(0, src.num_samples()*src.k(), plane, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
                 {
-                    for (long k = 0; k < src.k(); ++k)
+                    const auto scale = scal[i];
+                    const float* sp = s + i*plane;
+                    float* dp = d + i*plane;
+                    if (add_to)
                     {
-                        const auto scale = scal[n*scales.k() + k];
-                        for (long r = 0; r < src.nr(); ++r)
-                        {
-                            for (long c = 0; c < src.nc(); ++c)
-                            {
-                                *d++ += (*s++) * scale;
-                            }
-                        }
+                        for (long j = 0; j < plane; ++j)
+                            dp[j] += sp[j] * scale;
                     }
-                }
-
-
-            }
-            else
-            {
-                auto d = dest.host_write_only();
-                auto s = src.host();
-                auto scal = scales.host();
-
-                for (long n = 0; n < src.num_samples(); ++n)
-                {
-                    for (long k = 0; k < src.k(); ++k)
+                    else
                     {
-                        const auto scale = scal[n*scales.k() + k];
-                        for (long r = 0; r < src.nr(); ++r)
-                        {
-                            for (long c = 0; c < src.nc(); ++c)
-                            {
-                                *d++ = (*s++) * scale;
-                            }
-                        }
+                        for (long j = 0; j < plane; ++j)
+                            dp[j] = sp[j] * scale;
                     }
                 }
-            }
+            });
         }
 
     // ------------------------------------------------------------------------------------
@@ -252,12 +336,16 @@ namespace dlib
 
             auto d = dest.host();
             auto s = src.host();
-            for (long n = 0; n < dest.num_samples(); ++n)
+            const long plane = dest.nr()*dest.nc();
+            parallel_for_work(0, dest.num_samples()*dest.k(), plane, [&](long begin, long end)
             {
-                const auto sn = src.num_samples()==1 ? 0:n;
-                for (long k = 0; k < dest.k(); ++k)
+                for (long i = begin; i < end; ++i)
                 {
+                    const long n = i/dest.k();
+                    const long k = i%dest.k();
+                    const auto sn = src.num_samples()==1 ? 0:n;
                     const auto sk = src.k()==1 ? 0:k;
+                    float* dp = d + i*plane;
                     for (long r = 0; r < dest.nr(); ++r)
                     {
                         const auto sr = src.nr()==1 ? 0:r;
@@ -266,12 +354,12 @@ namespace dlib
                             const auto sc = src.nc()==1 ? 0:c;
 
                             const auto s_idx = ((sn*src.k() + sk)*src.nr() + sr)*src.nc() + sc;
-                            *d = beta*(*d) + alpha*s[s_idx];
-                            ++d;
+                            *dp = beta*(*dp) + alpha*s[s_idx];
+                            ++dp;
                         }
                     }
                 }
-            }
+            });
         }
 
     // ----------------------------------------------------------------------------------------
@@ -290,16 +378,23 @@ namespace dlib
             if (have_same_dimensions(dest, src1) &&
                 have_same_dimensions(dest, src2))
             {
-                for (size_t i = 0; i < dest.size(); ++i)
-                    d[i] = s1[i] + s2[i];
+                parallel_for_work(0, dest.size(), 1, [&](long begin, long end)
+                {
+                    for (long i = begin; i < end; ++i)
+                        d[i] = s1[i] + s2[i];
+                });
                 return;
             }
 
             // Otherwise, do the more complex version with bounds checking.
-            for (long n = 0; n < dest.num_samples(); ++n)
+            const long plane = dest.nr()*dest.nc();
+            parallel_for_work(0, dest.num_samples()*dest.k(), plane, [&](long begin, long end)
             {
-                for (long k = 0; k < dest.k(); ++k)
+                for (long i = begin; i < end; ++i)
                 {
+                    const long n = i/dest.k();
+                    const long k = i%dest.k();
+                    float* dp = d + i*plane;
                     for (long r = 0; r < dest.nr(); ++r)
                     {
                         for (long c = 0; c < dest.nc(); ++c)
@@ -327,12 +422,59 @@ namespace dlib
                                 v2 = s2[s_idx];
                             }
 
-                            *d = v1 + v2;
-                            ++d;
+                            *dp = v1 + v2;
+                            ++dp;
                         }
                     }
                 }
-            }
+            });
+        }
+
+        void add_relu (
+            tensor& dest,
+            const tensor& src1,
+            const tensor& src2
+        )
+        {
+            DLIB_CASSERT(have_same_dimensions(dest, src1) && have_same_dimensions(dest, src2));
+            auto d = dest.host();
+            auto s1 = src1.host();
+            auto s2 = src2.host();
+            parallel_for_work(0, dest.size(), 1, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                    d[i] = std::max(s1[i] + s2[i], 0.0f);
+            });
+        }
+
+        void add_conv_bias (
+            tensor& dest,
+            const tensor& biases,
+            const bool apply_relu
+        )
+        {
+            DLIB_CASSERT(biases.size() == (size_t)dest.k());
+            auto d = dest.host();
+            auto b = biases.host();
+            const long plane = dest.nr()*dest.nc();
+            parallel_for_work(0, dest.num_samples()*dest.k(), plane, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                {
+                    const float bias = b[i%dest.k()];
+                    float* dp = d + i*plane;
+                    if (apply_relu)
+                    {
+                        for (long j = 0; j < plane; ++j)
+                            dp[j] = std::max(dp[j] + bias, 0.0f);
+                    }
+                    else
+                    {
+                        for (long j = 0; j < plane; ++j)
+                            dp[j] += bias;
+                    }
+                }
+            });
         }
 
     // ----------------------------------------------------------------------------------------
@@ -352,24 +494,31 @@ namespace dlib
             if (have_same_dimensions(dest, src1) &&
                 have_same_dimensions(dest, src2))
             {
-                if (add_to)
-                {
-                    for (size_t i = 0; i < dest.size(); ++i)
-                        d[i] += s1[i] * s2[i];
-                }
-                else
+                parallel_for_work(0, dest.size(), 1, [&](long begin, long end)
                 {
-                    for (size_t i = 0; i < dest.size(); ++i)
-                        d[i] = s1[i] * s2[i];
-                }
+                    if (add_to)
+                    {
+                        for (long i = begin; i < end; ++i)
+                            d[i] += s1[i] * s2[i];
+                    }
+                    else
+                    {
+                        for (long i = begin; i < end; ++i)
+                            d[i] = s1[i] * s2[i];
+                    }
+                });
                 return;
             }
 
             // Otherwise, do the more complex version with bounds checking.
-            for (long n = 0; n < dest.num_samples(); ++n)
+            const long plane = dest.nr()*dest.nc();
+            parallel_for_work(0, dest.num_samples()*dest.k(), plane, [&](long begin, long end)
             {
-                for (long k = 0; k < dest.k(); ++k)
+                for (long i = begin; i < end; ++i)
                 {
+                    const long n = i/dest.k();
+                    const long k = i%dest.k();
+                    float* dp = d + i*plane;
                     for (long r = 0; r < dest.nr(); ++r)
                     {
                         for (long c = 0; c < dest.nc(); ++c)
@@ -398,13 +547,79 @@ namespace dlib
                             }
 
                             if (add_to)
-                                *d += v1 * v2;
+                                *dp += v1 * v2;
                             else
-                                *d = v1 * v2;
-                            ++d;
+                                *dp = v1 * v2;
+                            ++dp;
                         }
                     }
                 }
+            });
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        void gemm (
+            float beta,
+            tensor& dest,
+            float alpha,
+            const tensor& lhs,
+            bool trans_lhs,
+            const tensor& rhs,
+            bool trans_rhs
+        )
+        {
+#ifndef DLIB_USE_BLAS
+            // Without BLAS the expressions below go to default_matrix_multiply(), which
+            // runs in the calling thread.  So big products are instead handed to the
+            // thread pool selected by set_dnn_cpu_num_threads().  Which way a product
+            // goes only depends on its size, and packed_matrix_multiply() gives the same
+            // bits for any number of threads, so the outputs don't depend on the setting.
+            const long m = trans_lhs ? mat(lhs).nc() : mat(lhs).nr();
+            const long k = trans_lhs ? mat(lhs).nr() : mat(lhs).nc();
+            const long n = trans_rhs ? mat(rhs).nr() : mat(rhs).nc();
+            if (m > 2 && n > 2 && (double)m*n*k >= 1<<21)
+            {
+                thread_pool* tp = get_thread_pool();
+                matrix<float> temp = zeros_matrix<float>(m,n);
+                if (trans_lhs && trans_rhs)
+                    ma::packed_matrix_multiply(temp, alpha*trans(mat(lhs)), trans(mat(rhs)), tp);
+                else if (!trans_lhs && trans_rhs)
+                    ma::packed_matrix_multiply(temp, alpha*mat(lhs), trans(mat(rhs)), tp);
+                else if (trans_lhs && !trans_rhs)
+                    ma::packed_matrix_multiply(temp, alpha*trans(mat(lhs)), mat(rhs), tp);
+                else
+                    ma::packed_matrix_multiply(temp, alpha*mat(lhs), mat(rhs), tp);
+
+                if (beta != 0)
+                    dest = temp + beta*mat(dest);
+                else
+                    dest = temp;
+                return;
+            }
+#endif
+
+            if (beta != 0)
+            {
+                if (trans_lhs && trans_rhs)
+                    dest = alpha*trans(mat(lhs))*trans(mat(rhs)) + beta*mat(dest);
+                else if (!trans_lhs && trans_rhs)
+                    dest = alpha*mat(lhs)*trans(mat(rhs)) + beta*mat(dest);
+                else if (trans_lhs && !trans_rhs)
+                    dest = alpha*trans(mat(lhs))*mat(rhs) + beta*mat(dest);
+                else
+                    dest = alpha*mat(lhs)*mat(rhs) + beta*mat(dest);
+            }
+            else
+            {
+                if (trans_lhs && trans_rhs)
+                    dest = alpha*trans(mat(lhs))*trans(mat(rhs));
+                else if (!trans_lhs && trans_rhs)
+                    dest = alpha*mat(lhs)*trans(mat(rhs));
+                else if (trans_lhs && !trans_rhs)
+                    dest = alpha*trans(mat(lhs))*mat(rhs);
+                else
+                    dest = alpha*mat(lhs)*mat(rhs);
             }
         }
 
@@ -425,14 +640,18 @@ namespace dlib
             auto out = grad.host();
             auto in = gradient_input.host();
 
-            for (size_t i = 0; i < grad.size(); ++i)
-                out[i] = *in++;
-
-            for (long j = 1; j < gradient_input.num_samples(); ++j)
+            const long num = grad.size();
+            parallel_for_work(0, num, gradient_input.num_samples(), [&](long begin, long end)
             {
-                for (size_t i = 0; i < grad.size(); ++i)
-                    out[i] += *in++;
-            }
+                for (long i = begin; i < end; ++i)
+                    out[i] = in[i];
+
+                for (long j = 1; j < gradient_input.num_samples(); ++j)
+                {
+                    for (long i = begin; i < end; ++i)
+                        out[i] += in[j*num + i];
+                }
+            });
         }
 
     // ------------------------------------------------------------------------------------
@@ -455,22 +674,21 @@ namespace dlib
             auto g = grad.host();
             auto gi = gradient_input.host();
 
-            for (long k = 0; k < gradient_input.k(); ++k)
-                g[k] = 0;
-
-            for (long n = 0; n < gradient_input.num_samples(); ++n)
+            const long plane = gradient_input.nr()*gradient_input.nc();
+            parallel_for_work(0, gradient_input.k(), gradient_input.num_samples()*plane, [&](long begin, long end)
             {
-                for (long k = 0; k < gradient_input.k(); ++k)
+                for (long k = begin; k < end; ++k)
                 {
-                    for (long r = 0; r < gradient_input.nr(); ++r)
+                    float sum = 0;
+                    for (long n = 0; n < gradient_input.num_samples(); ++n)
                     {
-                        for (long c = 0; c < gradient_input.nc(); ++c)
-                        {
-                            g[k] += (*gi++);
-                        }
+                        const float* p = gi + (n*gradient_input.k() + k)*plane;
+                        for (long j = 0; j < plane; ++j)
+                            sum += p[j];
                     }
+                    g[k] = sum;
                 }
-            }
+            });
         }
 
     // -----------------------------------------------------------------------------------
@@ -485,8 +703,11 @@ namespace dlib
             DLIB_CASSERT(dest.size()==src.size());
             const auto d = dest.host();
             const auto s = src.host();
-            for (size_t i = 0; i < src.size(); ++i)
-                d[i] = A*s[i] + B;
+            parallel_for_work(0, src.size(), 1, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                    d[i] = A*s[i] + B;
+            });
         }
 
         void affine_transform(
@@ -503,8 +724,11 @@ namespace dlib
             const auto d = dest.host();
             const auto s1 = src1.host();
             const auto s2 = src2.host();
-            for (size_t i = 0; i < src1.size(); ++i)
-                d[i] = A*s1[i] + B*s2[i] + C;
+            parallel_for_work(0, src1.size(), 1, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                    d[i] = A*s1[i] + B*s2[i] + C;
+            });
         }
 
         void affine_transform(
@@ -525,8 +749,11 @@ namespace dlib
             const auto s1 = src1.host();
             const auto s2 = src2.host();
             const auto s3 = src3.host();
-            for (size_t i = 0; i < src1.size(); ++i)
-                d[i] = A*s1[i] + B*s2[i] + C*s3[i] + D;
+            parallel_for_work(0, src1.size(), 1, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                    d[i] = A*s1[i] + B*s2[i] + C*s3[i] + D;
+            });
         }
 
         void affine_transform_range(
@@ -549,8 +776,11 @@ namespace dlib
             const auto s1 = src1.host();
             const auto s2 = src2.host();
             const auto s3 = src3.host();
-            for (size_t i = begin; i < end; ++i)
-                d[i] = A*s1[i] + B*s2[i] + C*s3[i];
+            parallel_for_work(begin, end, 1, [&](long sub_begin, long sub_end)
+            {
+                for (long i = sub_begin; i < sub_end; ++i)
+                    d[i] = A*s1[i] + B*s2[i] + C*s3[i];
+            });
         }
 
     // -----------------------------------------------------------------------------------
@@ -577,20 +807,24 @@ namespace dlib
             if (A.num_samples() == 1)
             {
                 const long num = src.size()/src.num_samples();
-                for (long i = 0; i < src.num_samples(); ++i)
+                parallel_for_work(0, src.size(), 1, [&](long begin, long end)
                 {
-                    for (long j = 0; j < num; ++j)
+                    long j = begin%num;
+                    for (long i = begin; i < end; ++i)
                     {
-                        *d = a[j]*(*s) + b[j];
-                        d++;
-                        s++;
+                        d[i] = a[j]*s[i] + b[j];
+                        if (++j == num)
+                            j = 0;
                     }
-                }
+                });
             }
             else
             {
-                for (size_t i = 0; i < src.size(); ++i)
-                    d[i] = a[i]*s[i] + b[i];
+                parallel_for_work(0, src.size(), 1, [&](long begin, long end)
+                {
+                    for (long i = begin; i < end; ++i)
+                        d[i] = a[i]*s[i] + b[i];
+                });
             }
         }
 
@@ -614,19 +848,18 @@ namespace dlib
             auto s = src.host();
             const auto a = A.host();
             const auto b = B.host();
-            for (long n = 0; n < dest.num_samples(); ++n)
+            const long plane = dest.nr()*dest.nc();
+            parallel_for_work(0, dest.num_samples()*dest.k(), plane, [&](long begin, long end)
             {
-                for (long k = 0; k < dest.k(); ++k)
+                for (long i = begin; i < end; ++i)
                 {
-                    for (long r = 0; r < dest.nr(); ++r)
-                    {
-                        for (long c = 0; c < dest.nc(); ++c)
-                        {
-                            *d++ = a[k]*(*s++) + b[k];
-                        }
-                    }
+                    const long k = i%dest.k();
+                    const float* sp = s + i*plane;
+                    float* dp = d + i*plane;
+                    for (long j = 0; j < plane; ++j)
+                        dp[j] = a[k]*sp[j] + b[k];
                 }
-            }
+            });
         }
 
     // ----------------------------------------------------------------------------------------
@@ -658,15 +891,17 @@ namespace dlib
 
             const auto nc = dest.size()/dest.num_samples();
 
-            for (long r = rect.top(); r <= rect.bottom(); ++r)
+            parallel_for_work(rect.top(), rect.bottom()+1, rect.width(), [&](long begin, long end)
             {
-                for (long c = rect.left(); c <= rect.right(); ++c)
+                for (long r = begin; r < end; ++r)
                 {
-                    auto idx = r*nc + c;
-                    d[idx] = s1[idx]*A + s2[idx]*B + s3[idx]*C;
+                    for (long c = rect.left(); c <= rect.right(); ++c)
+                    {
+                        auto idx = r*nc + c;
+                        d[idx] = s1[idx]*A + s2[idx]*B + s3[idx]*C;
+                    }
                 }
-            }
-
+            });
         }
 
     // -----------------------------------------------------------------------------------
@@ -703,76 +938,241 @@ namespace dlib
             auto ps = s.host_write_only();
             auto pparams = params.host();
             auto ppgrad = params_grad.host();
-            for (size_t i = begin; i < end; ++i)
+            parallel_for_work(begin, end, 4, [&](long sub_begin, long sub_end)
             {
-                float g = weight_decay*pparams[i] + ppgrad[i];
-                pm[i] = momentum1*pm[i] + (1-momentum1)*g;
-                pv[i] = momentum2*pv[i] + (1-momentum2)*g*g;
-                ps[i] = -alpha*pm[i]/(std::sqrt(pv[i]) + eps);
-            }
+                for (long i = sub_begin; i < sub_end; ++i)
+                {
+                    float g = weight_decay*pparams[i] + ppgrad[i];
+                    pm[i] = momentum1*pm[i] + (1-momentum1)*g;
+                    pv[i] = momentum2*pv[i] + (1-momentum2)*g*g;
+                    ps[i] = -alpha*pm[i]/(std::sqrt(pv[i]) + eps);
+                }
+            });
         }
 
     // -----------------------------------------------------------------------------------
 
-        void batch_normalize_inference (
-            const double eps,
-            resizable_tensor& dest,
-            const tensor& src,
-            const tensor& gamma, 
-            const tensor& beta,
-            const tensor& running_means,
-            const tensor& running_variances
+        void compute_adamw_update (
+            size_t begin,
+            size_t end,
+            tensor& s,
+            tensor& m,
+            tensor& v,
+            const float t,
+            const float learning_rate,
+            const float weight_decay,
+            const float momentum1,
+            const float momentum2,
+            const tensor& params,
+            const tensor& params_grad
         )
         {
-            DLIB_CASSERT(
-                gamma.num_samples() == 1 && 
-                gamma.nr() == src.nr() &&
-                gamma.nc() == src.nc() &&
-                gamma.k()  == src.k() &&
-                have_same_dimensions(gamma, beta) &&
-                have_same_dimensions(gamma, running_means) &&
-                have_same_dimensions(gamma, running_variances) && 
-                eps > 0, 
-                "\ngamma.num_samples(): " << gamma.num_samples() << 
-                "\ngamma.k():  " << gamma.k() << 
-                "\ngamma.nr(): " << gamma.nr() << 
-                "\ngamma.nc(): " << gamma.nc() << 
-                "\nbeta.num_samples(): " << beta.num_samples() << 
-                "\nbeta.k():   " << beta.k() << 
-                "\nbeta.nr():  " << beta.nr() << 
-                "\nbeta.nc():  " << beta.nc() << 
-                "\nrunning_means.num_samples(): " << running_means.num_samples() << 
-                "\nrunning_means.k():   " << running_means.k() << 
-                "\nrunning_means.nr():  " << running_means.nr() << 
-                "\nrunning_means.nc():  " << running_means.nc() << 
-                "\nrunning_variances.num_samples(): " << running_variances.num_samples() << 
-                "\nrunning_variances.k():   " << running_variances.k() << 
-                "\nrunning_variances.nr():  " << running_variances.nr() << 
-                "\nrunning_variances.nc():  " << running_variances.nc() << 
-                "\nsrc.k():   " << src.k() << 
-                "\nsrc.nr():  " << src.nr() << 
-                "\nsrc.nc():  " << src.nc() <<
-                "\neps:  " << eps 
-            );
-            dest.copy_size(src);
+            DLIB_CASSERT(s.size() == m.size() &&
+                         s.size() == v.size() &&
+                         s.size() == params.size() &&
+                         s.size() == params_grad.size());
+            DLIB_CASSERT(begin <= end && end <= params.size());
+            const float eps = 1e-8;
+            const float alpha = learning_rate*std::sqrt(1-std::pow(momentum2,t))/(1-std::pow(momentum1, t));
+            const float decay = learning_rate*weight_decay;
 
-            auto d = dest.host();
-            auto s = src.host();
-            auto g = gamma.host();
-            auto b = beta.host();
-            auto m = running_means.host();
+            // The loop is equivalent to doing this:
+            //   m = momentum1*m + (1-momentum1)    *   params_grad;
+            //   v = momentum2*v + (1-momentum2)*squared(params_grad);
+            //   s = -alpha*m/(sqrt(v) + eps) - learning_rate*weight_decay*params;
+            auto pm = m.host();
+            auto pv = v.host();
+            auto ps = s.host_write_only();
+            auto pparams = params.host();
+            auto ppgrad = params_grad.host();
+            parallel_for_work(begin, end, 4, [&](long sub_begin, long sub_end)
+            {
+                for (long i = sub_begin; i < sub_end; ++i)
+                {
+                    const float g = ppgrad[i];
+                    pm[i] = momentum1*pm[i] + (1-momentum1)*g;
+                    pv[i] = momentum2*pv[i] + (1-momentum2)*g*g;
+                    ps[i] = -alpha*pm[i]/(std::sqrt(pv[i]) + eps) - decay*pparams[i];
+                }
+            });
+        }
+
+    // -----------------------------------------------------------------------------------
+
+        void compute_lamb_update (
+            size_t begin,
+            size_t end,
+            tensor& s,
+            tensor& m,
+            tensor& v,
+            const float t,
+            const float learning_rate,
+            const float weight_decay,
+            const float momentum1,
+            const float momentum2,
+            const tensor& params,
+            const tensor& params_grad,
+            resizable_tensor& sums
+        )
+        {
+            DLIB_CASSERT(s.size() == m.size() &&
+                         s.size() == v.size() &&
+                         s.size() == params.size() &&
+                         s.size() == params_grad.size());
+            DLIB_CASSERT(begin <= end && end <= params.size());
+            const float eps = 1e-6;
+            const float c1 = 1/(1-std::pow(momentum1, t));
+            const float c2 = 1/(1-std::pow(momentum2, t));
+
+            // The first loop is equivalent to doing this, while also summing the squares
+            // of params and s:
+            //   m = momentum1*m + (1-momentum1)    *   params_grad;
+            //   v = momentum2*v + (1-momentum2)*squared(params_grad);
+            //   s = (c1*m)/(sqrt(c2*v) + eps) + weight_decay*params;
+            auto pm = m.host();
+            auto pv = v.host();
+            auto ps = s.host_write_only();
+            auto pparams = params.host();
+            auto ppgrad = params_grad.host();
+            std::mutex m_sums;
+            double params_sum = 0;
+            double update_sum = 0;
+            parallel_for_work(begin, end, 4, [&](long sub_begin, long sub_end)
+            {
+                float psum = 0;
+                float usum = 0;
+                for (long i = sub_begin; i < sub_end; ++i)
+                {
+                    const float g = ppgrad[i];
+                    pm[i] = momentum1*pm[i] + (1-momentum1)*g;
+                    pv[i] = momentum2*pv[i] + (1-momentum2)*g*g;
+                    ps[i] = c1*pm[i]/(std::sqrt(c2*pv[i]) + eps) + weight_decay*pparams[i];
+                    psum += pparams[i]*pparams[i];
+                    usum += ps[i]*ps[i];
+                }
+                std::lock_guard<std::mutex> lock(m_sums);
+                params_sum += psum;
+                update_sum += usum;
+            });
+
+            if (sums.size() != 2)
+                sums.set_size(2);
+            sums.host()[0] = params_sum;
+            sums.host()[1] = update_sum;
+
+            // Then scale the step so its norm is learning_rate times the norm of the
+            // parameters, which only needs to read and write s.
+            const double params_norm = std::sqrt(params_sum);
+            const double update_norm = std::sqrt(update_sum);
+            const float trust_ratio = (params_norm > 0 && update_norm > 0) ? params_norm/update_norm : 1;
+            const float scale = -learning_rate*trust_ratio;
+            parallel_for_work(begin, end, 1, [&](long sub_begin, long sub_end)
+            {
+                for (long i = sub_begin; i < sub_end; ++i)
+                    ps[i] *= scale;
+            });
+        }
+
+    // -----------------------------------------------------------------------------------
+
+        void compute_nesterov_update (
+            size_t begin,
+            size_t end,
+            tensor& s,
+            tensor& v,
+            const float learning_rate,
+            const float weight_decay,
+            const float momentum,
+            const tensor& params,
+            const tensor& params_grad
+        )
+        {
+            DLIB_CASSERT(s.size() == v.size() &&
+                         s.size() == params.size() &&
+                         s.size() == params_grad.size());
+            DLIB_CASSERT(begin <= end && end <= params.size());
+
+            // The loop is equivalent to doing this:
+            //   g = weight_decay*params + params_grad;
+            //   v = momentum*v - learning_rate*g;
+            //   s = momentum*v - learning_rate*g;
+            auto pv = v.host();
+            auto ps = s.host_write_only();
+            auto pparams = params.host();
+            auto ppgrad = params_grad.host();
+            parallel_for_work(begin, end, 2, [&](long sub_begin, long sub_end)
+            {
+                for (long i = sub_begin; i < sub_end; ++i)
+                {
+                    const float g = learning_rate*(weight_decay*pparams[i] + ppgrad[i]);
+                    pv[i] = momentum*pv[i] - g;
+                    ps[i] = momentum*pv[i] - g;
+                }
+            });
+        }
+
+    // -----------------------------------------------------------------------------------
+
+        void batch_normalize_inference (
+            const double eps,
+            resizable_tensor& dest,
+            const tensor& src,
+            const tensor& gamma, 
+            const tensor& beta,
+            const tensor& running_means,
+            const tensor& running_variances
+        )
+        {
+            DLIB_CASSERT(
+                gamma.num_samples() == 1 && 
+                gamma.nr() == src.nr() &&
+                gamma.nc() == src.nc() &&
+                gamma.k()  == src.k() &&
+                have_same_dimensions(gamma, beta) &&
+                have_same_dimensions(gamma, running_means) &&
+                have_same_dimensions(gamma, running_variances) && 
+                eps > 0, 
+                "\ngamma.num_samples(): " << gamma.num_samples() << 
+                "\ngamma.k():  " << gamma.k() << 
+                "\ngamma.nr(): " << gamma.nr() << 
+                "\ngamma.nc(): " << gamma.nc() << 
+                "\nbeta.num_samples(): " << beta.num_samples() << 
+                "\nbeta.k():   " << beta.k() << 
+                "\nbeta.nr():  " << beta.nr() << 
+                "\nbeta.nc():  " << beta.nc() << 
+                "\nrunning_means.num_samples(): " << running_means.num_samples() << 
+                "\nrunning_means.k():   " << running_means.k() << 
+                "\nrunning_means.nr():  " << running_means.nr() << 
+                "\nrunning_means.nc():  " << running_means.nc() << 
+                "\nrunning_variances.num_samples(): " << running_variances.num_samples() << 
+                "\nrunning_variances.k():   " << running_variances.k() << 
+                "\nrunning_variances.nr():  " << running_variances.nr() << 
+                "\nrunning_variances.nc():  " << running_variances.nc() << 
+                "\nsrc.k():   " << src.k() << 
+                "\nsrc.nr():  " << src.nr() << 
+                "\nsrc.nc():  " << src.nc() <<
+                "\neps:  " << eps 
+            );
+            dest.copy_size(src);
+
+            auto d = dest.host();
+            auto s = src.host();
+            auto g = gamma.host();
+            auto b = beta.host();
+            auto m = running_means.host();
             auto v = running_variances.host();
 
             const long num = src.k()*src.nr()*src.nc();
-            for (long n = 0; n < src.num_samples(); ++n)
+            parallel_for_work(0, src.num_samples(), num, [&](long begin, long end)
             {
-                for (long k = 0; k < num; ++k)
+                for (long n = begin; n < end; ++n)
                 {
-                    *d = g[k]*(*s - m[k])/std::sqrt(v[k]+eps) + b[k];
-                    ++d;
-                    ++s;
+                    const float* sp = s + n*num;
+                    float* dp = d + n*num;
+                    for (long k = 0; k < num; ++k)
+                        dp[k] = g[k]*(sp[k] - m[k])/std::sqrt(v[k]+eps) + b[k];
                 }
-            }
+            });
         }
 
         void batch_normalize (
@@ -825,15 +1225,18 @@ namespace dlib
             auto p_src = src.host();
             const long num = src.k()*src.nr()*src.nc();
             // compute means, and sum of squares
-            for (long i = 0; i < num; ++i)
+            parallel_for_work(0, num, src.num_samples(), [&](long begin, long end)
             {
                 for (long n = 0; n < src.num_samples(); ++n)
                 {
-                    float val = p_src[n*num+i];
-                    p_means[i] += val;
-                    p_invstds[i] += val*val;
+                    for (long i = begin; i < end; ++i)
+                    {
+                        float val = p_src[n*num+i];
+                        p_means[i] += val;
+                        p_invstds[i] += val*val;
+                    }
                 }
-            }
+            });
             means /= src.num_samples();
             invstds /= src.num_samples();
             // copy data back to host
@@ -859,16 +1262,18 @@ namespace dlib
             auto p_dest = dest.host();
             const auto p_gamma = gamma.host();   
             const auto p_beta = beta.host();   
-            for (long n = 0; n < src.num_samples(); ++n)
+            parallel_for_work(0, src.num_samples(), num, [&](long begin, long end)
             {
-                for (long i = 0; i < num; ++i)
+                for (long n = begin; n < end; ++n)
                 {
-                    *p_dest = (*p_src - p_means[i])*p_invstds[i];
-                    *p_dest = (*p_dest)*p_gamma[i] + p_beta[i];
-                    ++p_src;
-                    ++p_dest;
+                    for (long i = 0; i < num; ++i)
+                    {
+                        const long idx = n*num+i;
+                        p_dest[idx] = (p_src[idx] - p_means[i])*p_invstds[i];
+                        p_dest[idx] = p_dest[idx]*p_gamma[i] + p_beta[i];
+                    }
                 }
-            }
+            });
 
             // now keep track of the running means 
             running_means.copy_size(means);
@@ -920,57 +1325,51 @@ namespace dlib
             const auto p_dvars = dvars.host();
             const auto p_dmeans = dmeans.host();
 
-            for (long n = 0; n < src.num_samples(); ++n)
+            const float invnum = 1.0f/src.num_samples();
+            auto p_src_grad = src_grad.host();
+            // Each element of a sample only interacts with the same element in the other
+            // samples, so the work is split up over the elements.
+            parallel_for_work(0, num, 3*src.num_samples(), [&](long begin, long end)
             {
-                for (long i = 0; i < num; ++i)
+                for (long n = 0; n < src.num_samples(); ++n)
                 {
-                    const float x_hat = (*p_src - p_means[i])*p_invstds[i];
-                    p_beta_grad[i] += *p_grad;
-                    p_gamma_grad[i] += (*p_grad)*x_hat;
-
-                    const float dx = *p_grad * p_gamma[i];
+                    for (long i = begin; i < end; ++i)
+                    {
+                        const long idx = n*num+i;
+                        const float x_hat = (p_src[idx] - p_means[i])*p_invstds[i];
+                        p_beta_grad[i] += p_grad[idx];
+                        p_gamma_grad[i] += p_grad[idx]*x_hat;
 
-                    p_dvars[i] += dx*(*p_src - p_means[i])*-0.5*std::pow(p_invstds[i], 3.0f);
+                        const float dx = p_grad[idx] * p_gamma[i];
 
-                    ++p_grad;
-                    ++p_src;
+                        p_dvars[i] += dx*(p_src[idx] - p_means[i])*-0.5*std::pow(p_invstds[i], 3.0f);
+                    }
                 }
-            }
 
-            const float invnum = 1.0f/src.num_samples();
-            p_grad = gradient_input.host();
-            p_src = src.host();
-            for (long n = 0; n < src.num_samples(); ++n)
-            {
-                for (long i = 0; i < num; ++i)
+                for (long n = 0; n < src.num_samples(); ++n)
                 {
-                    const float dx = *p_grad * p_gamma[i];
-
-                    p_dmeans[i] += dx*-p_invstds[i] + p_dvars[i] * -2*(*p_src - p_means[i])*invnum;
+                    for (long i = begin; i < end; ++i)
+                    {
+                        const long idx = n*num+i;
+                        const float dx = p_grad[idx] * p_gamma[i];
 
-                    ++p_grad;
-                    ++p_src;
+                        p_dmeans[i] += dx*-p_invstds[i] + p_dvars[i] * -2*(p_src[idx] - p_means[i])*invnum;
+                    }
                 }
-            }
-            p_grad = gradient_input.host();
-            p_src = src.host();
-            auto p_src_grad = src_grad.host();
-            for (long n = 0; n < src.num_samples(); ++n)
-            {
-                for (long i = 0; i < num; ++i)
-                {
-                    const float dx = *p_grad * p_gamma[i];
-
-                    *p_src_grad += dx*p_invstds[i] + 
-                        p_dvars[i] *2*(*p_src - p_means[i])*invnum + 
-                        p_dmeans[i]*invnum;
 
+                for (long n = 0; n < src.num_samples(); ++n)
+                {
+                    for (long i = begin; i < end; ++i)
+                    {
+                        const long idx = n*num+i;
+                        const float dx = p_grad[idx] * p_gamma[i];
 
-                    ++p_grad;
-                    ++p_src;
-                    ++p_src_grad;
+                        p_src_grad[idx] += dx*p_invstds[i] + 
+                            p_dvars[i] *2*(p_src[idx] - p_means[i])*invnum + 
+                            p_dmeans[i]*invnum;
+                    }
                 }
-            }
+            });
         }
 
     // ----------------------------------------------------------------------------------------
@@ -1025,19 +1424,18 @@ namespace dlib
             auto v = running_variances.host();
 
             const long num = src.nr()*src.nc();
-            for (long n = 0; n < src.num_samples(); ++n)
+            parallel_for_work(0, src.num_samples()*src.k(), num, [&](long begin, long end)
             {
-                for (long k = 0; k < src.k(); ++k)
+                for (long i = begin; i < end; ++i)
                 {
+                    const long k = i%src.k();
                     const float invstd = 1.0f/std::sqrt(v[k] + eps);
+                    const float* sp = s + i*num;
+                    float* dp = d + i*num;
                     for (long j = 0; j < num; ++j)
-                    {
-                        *d = g[k]*(*s - m[k])*invstd + b[k];
-                        ++d;
-                        ++s;
-                    }
+                        dp[j] = g[k]*(sp[j] - m[k])*invstd + b[k];
                 }
-            }
+            });
         }
 
         void batch_normalize_conv (
@@ -1094,18 +1492,21 @@ namespace dlib
             auto p_src = src.host();
             const long num = src.nr()*src.nc();
             // compute means, and sum of squares
-            for (long n = 0; n < src.num_samples(); ++n)
+            parallel_for_work(0, src.k(), src.num_samples()*num, [&](long begin, long end)
             {
-                for (long k = 0; k < src.k(); ++k)
+                for (long k = begin; k < end; ++k)
                 {
-                    for (long i = 0; i < num; ++i)
+                    for (long n = 0; n < src.num_samples(); ++n)
                     {
-                        p_means[k] += *p_src;
-                        p_invstds[k] += (*p_src)*(*p_src);
-                        ++p_src;
+                        const float* sp = p_src + (n*src.k() + k)*num;
+                        for (long i = 0; i < num; ++i)
+                        {
+                            p_means[k] += sp[i];
+                            p_invstds[k] += sp[i]*sp[i];
+                        }
                     }
                 }
-            }
+            });
             means /= src.num_samples()*num;
             invstds /= src.num_samples()*num;
             // copy data back to host
@@ -1130,19 +1531,20 @@ namespace dlib
 
             p_src = src.host();
             auto p_dest = dest.host();
-            for (long n = 0; n < src.num_samples(); ++n)
+            parallel_for_work(0, src.num_samples()*src.k(), num, [&](long begin, long end)
             {
-                for (long k = 0; k < src.k(); ++k)
+                for (long j = begin; j < end; ++j)
                 {
+                    const long k = j%src.k();
+                    const float* sp = p_src + j*num;
+                    float* dp = p_dest + j*num;
                     for (long i = 0; i < num; ++i)
                     {
-                        *p_dest = (*p_src - p_means[k])*p_invstds[k];
-                        *p_dest = (*p_dest)*p_gamma[k] + p_beta[k];
-                        ++p_src;
-                        ++p_dest;
+                        dp[i] = (sp[i] - p_means[k])*p_invstds[k];
+                        dp[i] = dp[i]*p_gamma[k] + p_beta[k];
                     }
                 }
-            }
+            });
 
             // now keep track of the running means 
             running_means.copy_size(means);
@@ -1195,67 +1597,55 @@ namespace dlib
             const auto p_dvars = dvars.host();
             const auto p_dmeans = dmeans.host();
 
-            for (long n = 0; n < src.num_samples(); ++n)
+            const float invnum = 1.0f/(src.num_samples()*num);
+            auto p_src_grad = src_grad.host();
+            // The statistics of each channel are independent of the other channels, so
+            // the work is split up over the channels.
+            parallel_for_work(0, src.k(), 3*src.num_samples()*num, [&](long begin, long end)
             {
-                for (long k = 0; k < src.k(); ++k)
+                for (long k = begin; k < end; ++k)
                 {
                     const float invstd_pow = -0.5*std::pow(p_invstds[k], 3.0f);
-                    for (long i = 0; i < num; ++i)
+                    for (long n = 0; n < src.num_samples(); ++n)
                     {
-                        const float x_hat = (*p_src - p_means[k])*p_invstds[k];
-                        p_beta_grad[k] += *p_grad;
-                        p_gamma_grad[k] += (*p_grad)*x_hat;
-
-                        const float dx = *p_grad * p_gamma[k];
+                        const long offset = (n*src.k() + k)*num;
+                        for (long i = offset; i < offset+num; ++i)
+                        {
+                            const float x_hat = (p_src[i] - p_means[k])*p_invstds[k];
+                            p_beta_grad[k] += p_grad[i];
+                            p_gamma_grad[k] += p_grad[i]*x_hat;
 
-                        p_dvars[k] += dx*(*p_src - p_means[k])*invstd_pow;
+                            const float dx = p_grad[i] * p_gamma[k];
 
-                        ++p_grad;
-                        ++p_src;
+                            p_dvars[k] += dx*(p_src[i] - p_means[k])*invstd_pow;
+                        }
                     }
-                }
-            }
 
-            p_grad = gradient_input.host();
-            p_src = src.host();
-            const float invnum = 1.0f/(src.num_samples()*num);
-            for (long n = 0; n < src.num_samples(); ++n)
-            {
-                for (long k = 0; k < src.k(); ++k)
-                {
-                    for (long i = 0; i < num; ++i)
+                    for (long n = 0; n < src.num_samples(); ++n)
                     {
-                        const float dx = *p_grad * p_gamma[k];
-
-                        p_dmeans[k] += -dx*p_invstds[k] + p_dvars[k] * -2*(*p_src - p_means[k])*invnum;
+                        const long offset = (n*src.k() + k)*num;
+                        for (long i = offset; i < offset+num; ++i)
+                        {
+                            const float dx = p_grad[i] * p_gamma[k];
 
-                        ++p_grad;
-                        ++p_src;
+                            p_dmeans[k] += -dx*p_invstds[k] + p_dvars[k] * -2*(p_src[i] - p_means[k])*invnum;
+                        }
                     }
-                }
-            }
-            p_grad = gradient_input.host();
-            p_src = src.host();
-            auto p_src_grad = src_grad.host();
-            for (long n = 0; n < src.num_samples(); ++n)
-            {
-                for (long k = 0; k < src.k(); ++k)
-                {
-                    for (long i = 0; i < num; ++i)
-                    {
-                        const float dx = *p_grad * p_gamma[k];
-
-                        *p_src_grad += dx*p_invstds[k] + 
-                            p_dvars[k]*2*(*p_src - p_means[k])*invnum + 
-                            p_dmeans[k]*invnum;
 
+                    for (long n = 0; n < src.num_samples(); ++n)
+                    {
+                        const long offset = (n*src.k() + k)*num;
+                        for (long i = offset; i < offset+num; ++i)
+                        {
+                            const float dx = p_grad[i] * p_gamma[k];
 
-                        ++p_grad;
-                        ++p_src;
-                        ++p_src_grad;
+                            p_src_grad[i] += dx*p_invstds[k] + 
+                                p_dvars[k]*2*(p_src[i] - p_means[k])*invnum + 
+                                p_dmeans[k]*invnum;
+                        }
                     }
                 }
-            }
+            });
         }
 
     // -----------------------------------------------------------------------------------
@@ -1266,8 +1656,11 @@ namespace dlib
         )
         {
             const auto d = data.host();
-            for (size_t i = 0; i < data.size(); ++i)
-                d[i] = d[i]>thresh ? 1:0;
+            parallel_for_work(0, data.size(), 1, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                    d[i] = d[i]>thresh ? 1:0;
+            });
         }
 
         void dot (
@@ -1305,16 +1698,20 @@ namespace dlib
             const auto d = dest.host();
             const auto s = src.host();
 
+            // Each (sample, location) pair is normalized independently of the others.
             // Note that we subtract out the max values in each channel before applying
             // exp() to avoid numeric overflow in the subsequent computations.  Doing this
             // doesn't change the resulting output, it just makes it more numerically
             // stable.
-            for (long n = 0; n < src.num_samples(); ++n)
+            parallel_for_work(0, src.num_samples()*num_locations, 3*num_channels, [&](long begin, long end)
             {
-                auto ss = s + num_locations*num_channels*n;
-                auto dd = d + num_locations*num_channels*n;
-                for (long i = 0; i < num_locations; ++i)
+                for (long j = begin; j < end; ++j)
                 {
+                    const long n = j/num_locations;
+                    const long i = j%num_locations;
+                    const auto ss = s + num_locations*num_channels*n + i;
+                    const auto dd = d + num_locations*num_channels*n + i;
+
                     float max_val = -std::numeric_limits<float>::infinity();
                     for (long k = 0; k < num_channels; ++k)
                         max_val = std::max(max_val, ss[k*num_locations]);
@@ -1322,26 +1719,14 @@ namespace dlib
                     for (long k = 0; k < num_channels; ++k)
                         dd[k*num_locations] = std::exp(ss[k*num_locations]-max_val);
 
-                    ++ss;
-                    ++dd;
-                }
-            }
-
-            // Now normalize each channel so they sum to 1.
-            for (long n = 0; n < src.num_samples(); ++n)
-            {
-                const auto dd = d + num_locations*num_channels*n;
-                for (long i = 0; i < num_locations; ++i)
-                {
-                    const auto ddd = dd+i;
-
+                    // Now normalize each channel so they sum to 1.
                     float temp = 0;
                     for (long k = 0; k < num_channels; ++k)
-                        temp += ddd[k*num_locations];
+                        temp += dd[k*num_locations];
                     for (long k = 0; k < num_channels; ++k)
-                        ddd[k*num_locations] /= temp;
+                        dd[k*num_locations] /= temp;
                 }
-            }
+            });
         }
 
         void softmax_gradient (
@@ -1360,16 +1745,15 @@ namespace dlib
             const auto in = gradient_input.host();
 
 
-            for (long n = 0; n < grad.num_samples(); ++n)
+            parallel_for_work(0, grad.num_samples()*num_locations, 2*num_channels, [&](long begin, long end)
             {
-                const auto d2 = d + num_locations*num_channels*n;
-                const auto g2 = g + num_locations*num_channels*n;
-                const auto in2 = in + num_locations*num_channels*n;
-                for (long i = 0; i < num_locations; ++i)
+                for (long j = begin; j < end; ++j)
                 {
-                    const auto d3 = d2+i;
-                    const auto g3 = g2+i;
-                    const auto in3 = in2+i;
+                    const long n = j/num_locations;
+                    const long i = j%num_locations;
+                    const auto d3 = d + num_locations*num_channels*n + i;
+                    const auto g3 = g + num_locations*num_channels*n + i;
+                    const auto in3 = in + num_locations*num_channels*n + i;
 
                     float temp = 0;
                     for (long k = 0; k < num_channels; ++k)
@@ -1385,7 +1769,7 @@ namespace dlib
                             g3[k*num_locations] += d3[k*num_locations]*(temp+in3[k*num_locations]);
                     }
                 }
-            }
+            });
         }
         }
 
@@ -1442,8 +1826,11 @@ namespace dlib
         {
             const auto d = dest.host();
             const auto s = src.host();
-            for (size_t i = 0; i < src.size(); ++i)
-                d[i] = 1/(1+std::exp(-s[i]));
+            parallel_for_work(0, src.size(), 4, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                    d[i] = 1/(1+std::exp(-s[i]));
+            });
         }
 
         void sigmoid_gradient (
@@ -1455,16 +1842,20 @@ namespace dlib
             const auto g = grad.host();
             const auto d = dest.host();
             const auto in = gradient_input.host();
-            if (is_same_object(gradient_input, grad))
+            const bool same_object = is_same_object(gradient_input, grad);
+            parallel_for_work(0, dest.size(), 1, [&](long begin, long end)
             {
-                for (size_t i = 0; i < dest.size(); ++i)
-                    g[i] = in[i]*d[i]*(1-d[i]);
-            }
-            else
-            {
-                for (size_t i = 0; i < dest.size(); ++i)
-                    g[i] += in[i]*d[i]*(1-d[i]);
-            }
+                if (same_object)
+                {
+                    for (long i = begin; i < end; ++i)
+                        g[i] = in[i]*d[i]*(1-d[i]);
+                }
+                else
+                {
+                    for (long i = begin; i < end; ++i)
+                        g[i] += in[i]*d[i]*(1-d[i]);
+                }
+            });
         }
 
     // ------------------------------------------------------------------------------------
@@ -1474,7 +1865,13 @@ namespace dlib
             const tensor& src
         )
         {
-            dest = lowerbound(mat(src), 0);
+            const auto d = dest.host();
+            const auto s = src.host();
+            parallel_for_work(0, src.size(), 1, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                    d[i] = std::max(s[i], 0.0f);
+            });
         }
 
         void relu_gradient (
@@ -1486,24 +1883,28 @@ namespace dlib
             const float* gi = gradient_input.host();
             const float* in = dest.host();
             float* out = grad.host();
-            if (is_same_object(grad, gradient_input))
+            const bool same_object = is_same_object(grad, gradient_input);
+            parallel_for_work(0, dest.size(), 1, [&](long begin, long end)
             {
-                for (size_t i = 0; i < dest.size(); ++i)
+                if (same_object)
                 {
-                    if (in[i] > 0)
-                        out[i] = gi[i];
-                    else
-                        out[i] = 0;
+                    for (long i = begin; i < end; ++i)
+                    {
+                        if (in[i] > 0)
+                            out[i] = gi[i];
+                        else
+                            out[i] = 0;
+                    }
                 }
-            }
-            else
-            {
-                for (size_t i = 0; i < dest.size(); ++i)
+                else
                 {
-                    if (in[i] > 0)
-                        out[i] += gi[i];
+                    for (long i = begin; i < end; ++i)
+                    {
+                        if (in[i] > 0)
+                            out[i] += gi[i];
+                    }
                 }
-            }
+            });
         }
 
     // ----------------------------------------------------------------------------------------
@@ -1517,13 +1918,16 @@ namespace dlib
             const float p = param.host()[0];
             const float* s = src.host();
             float* d = dest.host();
-            for (size_t i = 0; i < dest.size(); ++i)
+            parallel_for_work(0, dest.size(), 1, [&](long begin, long end)
             {
-                if (s[i] > 0)
-                    d[i] = s[i];
-                else
-                    d[i] = p*s[i];
-            }
+                for (long i = begin; i < end; ++i)
+                {
+                    if (s[i] > 0)
+                        d[i] = s[i];
+                    else
+                        d[i] = p*s[i];
+                }
+            });
         }
 
         void prelu_gradient (
@@ -1540,18 +1944,25 @@ namespace dlib
             const float* s = src.host();
             float* out = grad.host();
             float pgrad = 0;
-            for (size_t i = 0; i < src.size(); ++i)
+            std::mutex m;
+            parallel_for_work(0, src.size(), 1, [&](long begin, long end)
             {
-                if (s[i] > 0)
+                float partial_pgrad = 0;
+                for (long i = begin; i < end; ++i)
                 {
-                    out[i] += gi[i];
+                    if (s[i] > 0)
+                    {
+                        out[i] += gi[i];
+                    }
+                    else
+                    {
+                        out[i] += p*gi[i];
+                        partial_pgrad += gi[i]*s[i];
+                    }
                 }
-                else
-                {
-                    out[i] += p*gi[i];
-                    pgrad += gi[i]*s[i];
-                }
-            }
+                std::lock_guard<std::mutex> lock(m);
+                pgrad += partial_pgrad;
+            });
             params_grad.host()[0] = pgrad;
         }
 
@@ -1564,8 +1975,11 @@ namespace dlib
         {
             const auto d = dest.host();
             const auto s = src.host();
-            for (size_t i = 0; i < src.size(); ++i)
-                d[i] = std::tanh(s[i]);
+            parallel_for_work(0, src.size(), 4, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                    d[i] = std::tanh(s[i]);
+            });
         }
 
         void tanh_gradient (
@@ -1577,16 +1991,20 @@ namespace dlib
             const auto g = grad.host();
             const auto d = dest.host();
             const auto in = gradient_input.host();
-            if (is_same_object(grad, gradient_input))
+            const bool same_object = is_same_object(grad, gradient_input);
+            parallel_for_work(0, dest.size(), 1, [&](long begin, long end)
             {
-                for (size_t i = 0; i < dest.size(); ++i)
-                    g[i] = in[i]*(1-d[i]*d[i]);
-            }
-            else
-            {
-                for (size_t i = 0; i < dest.size(); ++i)
-                    g[i] += in[i]*(1-d[i]*d[i]);
-            }
+                if (same_object)
+                {
+                    for (long i = begin; i < end; ++i)
+                        g[i] = in[i]*(1-d[i]*d[i]);
+                }
+                else
+                {
+                    for (long i = begin; i < end; ++i)
+                        g[i] += in[i]*(1-d[i]*d[i]);
+                }
+            });
         }
 
     // ----------------------------------------------------------------------------------------
@@ -1610,12 +2028,15 @@ namespace dlib
             const float* s = src.host();
             float* d = dest.host();
 
-            parallel_for(0, dest.k()*dest.num_samples(), [&](long i)
+            parallel_for_work(0, dest.k()*dest.num_samples(), dest.nr()*dest.nc(), [&](long begin, long end)
             {
-                auto simg = sub_image(s+i*src_channel_stride, src.nr(), src.nc(), src_row_stride);
-                auto dimg = sub_image(d+i*dest_channel_stride, dest.nr(), dest.nc(), dest_row_stride);
+                for (long i = begin; i < end; ++i)
+                {
+                    auto simg = sub_image(s+i*src_channel_stride, src.nr(), src.nc(), src_row_stride);
+                    auto dimg = sub_image(d+i*dest_channel_stride, dest.nr(), dest.nc(), dest_row_stride);
 
-                resize_image(simg, dimg);
+                    resize_image(simg, dimg);
+                }
             });
         }
 
@@ -1635,14 +2056,16 @@ namespace dlib
             if (gradient_input.size() == 0 || grad.size() == 0)
                 return;
 
-            const float* gi = gradient_input.host();
-            float* g = grad.host();
+            const float* gradient_input_host = gradient_input.host();
+            float* grad_host = grad.host();
             const float x_scale = (grad.nc()-1)/(float)std::max<long>((gradient_input.nc()-1),1);
             const float y_scale = (grad.nr()-1)/(float)std::max<long>((gradient_input.nr()-1),1);
-            for (long long samp = 0; samp < gradient_input.num_samples(); ++samp)
+            parallel_for_work(0, gradient_input.num_samples()*gradient_input.k(), gradient_input.nr()*gradient_input.nc(), [&](long begin, long end)
             {
-                for (long long k = 0; k < gradient_input.k(); ++k)
+                for (long i = begin; i < end; ++i)
                 {
+                    const float* gi = gradient_input_host + i*gradient_input_channel_stride;
+                    float* g = grad_host + i*grad_channel_stride;
                     for (long long r = 0; r < gradient_input.nr(); ++r)
                     {
                         const float y = r*y_scale;
@@ -1664,11 +2087,8 @@ namespace dlib
                             g[bottom*grad_row_stride+right] += tmp*(tb_frac)*(lr_frac);
                         }
                     }
-
-                    g += grad_channel_stride;
-                    gi += gradient_input_channel_stride;
                 }
-            }
+            });
         }
 
     // ------------------------------------------------------------------------------------
@@ -1767,6 +2187,29 @@ namespace dlib
                  1+(src.nr()+2*padding_y-window_height)/stride_y,
                  1+(src.nc()+2*padding_x-window_width)/stride_x
                 );
+            (*this)(static_cast<tensor&>(dest), src);
+        }
+
+        void pooling::
+        operator() (
+            tensor& dest,
+            const tensor& src
+        )
+        {
+            DLIB_CASSERT(window_width > 0);
+            DLIB_CASSERT(window_height > 0);
+            DLIB_CASSERT(stride_y > 0);
+            DLIB_CASSERT(stride_x > 0);
+            DLIB_CASSERT(0 <= padding_y && padding_y < window_height);
+            DLIB_CASSERT(0 <= padding_x && padding_x < window_width);
+            DLIB_CASSERT(window_width  <= src.nc() + 2*padding_x,
+                "Pooling windows must be small enough to fit into the padded image.");
+            DLIB_CASSERT(window_height <= src.nr() + 2*padding_y,
+                "Pooling windows must be small enough to fit into the padded image.");
+            DLIB_CASSERT(dest.num_samples() == src.num_samples());
+            DLIB_CASSERT(dest.k() == src.k());
+            DLIB_CASSERT(dest.nr() == 1+(src.nr()+2*padding_y-window_height)/stride_y);
+            DLIB_CASSERT(dest.nc() == 1+(src.nc()+2*padding_x-window_width)/stride_x);
 
             if (src.size() == 0)
             {
@@ -1776,14 +2219,18 @@ namespace dlib
 
 
             auto d = dest.host();
+            // Make sure src is on the host before the worker threads look at it.
+            src.host();
             const long x_offset = window_width/2 - padding_x;
             const long y_offset = window_height/2 - padding_y;
             if (does_max_pooling())
             {
-                for (long n = 0; n < dest.num_samples(); ++n)
+                parallel_for_work(0, dest.num_samples()*dest.k(), dest.nr()*dest.nc()*window_width*window_height, [&](long begin, long end)
                 {
-                    for (long k = 0; k < dest.k(); ++k)
+                    for (long i = begin; i < end; ++i)
                     {
+                        const long n = i/dest.k();
+                        const long k = i%dest.k();
                         auto simg = image_plane(src,n,k);
                         auto dimg = d + (n*dest.k() + k)*dest.nr()*dest.nc();
 
@@ -1799,14 +2246,16 @@ namespace dlib
                             }
                         }
                     }
-                }
+                });
             }
             else
             {
-                for (long n = 0; n < dest.num_samples(); ++n)
+                parallel_for_work(0, dest.num_samples()*dest.k(), dest.nr()*dest.nc()*window_width*window_height, [&](long begin, long end)
                 {
-                    for (long k = 0; k < dest.k(); ++k)
+                    for (long i = begin; i < end; ++i)
                     {
+                        const long n = i/dest.k();
+                        const long k = i%dest.k();
                         auto simg = image_plane(src,n,k);
                         auto dimg = d + (n*dest.k() + k)*dest.nr()*dest.nc();
 
@@ -1822,7 +2271,7 @@ namespace dlib
                             }
                         }
                     }
-                }
+                });
             }
 
         }
@@ -1846,14 +2295,17 @@ namespace dlib
 
             auto gi = gradient_input.host();
             auto g = grad.host();
+            src.host();
             const long x_offset = window_width/2 - padding_x;
             const long y_offset = window_height/2 - padding_y;
             if (does_max_pooling())
             {
-                for (long n = 0; n < dest.num_samples(); ++n)
+                parallel_for_work(0, dest.num_samples()*dest.k(), dest.nr()*dest.nc()*window_width*window_height, [&](long begin, long end)
                 {
-                    for (long k = 0; k < dest.k(); ++k)
+                    for (long i = begin; i < end; ++i)
                     {
+                        const long n = i/dest.k();
+                        const long k = i%dest.k();
                         auto simg = image_plane(src,n,k);
                         auto gimg = g + (n*grad.k() + k)*grad.nr()*grad.nc();
                         auto giimg = gi + (n*dest.k() + k)*dest.nr()*dest.nc();
@@ -1872,14 +2324,16 @@ namespace dlib
                             }
                         }
                     }
-                }
+                });
             }
             else
             {
-                for (long n = 0; n < dest.num_samples(); ++n)
+                parallel_for_work(0, dest.num_samples()*dest.k(), dest.nr()*dest.nc()*window_width*window_height, [&](long begin, long end)
                 {
-                    for (long k = 0; k < dest.k(); ++k)
+                    for (long i = begin; i < end; ++i)
                     {
+                        const long n = i/dest.k();
+                        const long k = i%dest.k();
                         auto simg = image_plane(src,n,k);
                         auto gimg = g + (n*grad.k() + k)*grad.nr()*grad.nc();
                         auto giimg = gi + (n*dest.k() + k)*dest.nr()*dest.nc();
@@ -1904,7 +2358,7 @@ namespace dlib
                             }
                         }
                     }
-                }
+                });
             }
 
         }
@@ -1922,7 +2376,9 @@ namespace dlib
             long stride_y,
             long stride_x,
             long padding_y,
-            long padding_x
+            long padding_x,
+            long k_begin,
+            long num_k
         )
         {
             const auto d = data.host() + data.k()*data.nr()*data.nc()*n;
@@ -1932,7 +2388,7 @@ namespace dlib
             const long out_nc = 1+(data.nc()+2*padding_x-filter_nc)/stride_x;
 
             output.set_size(out_nr*out_nc, 
-                            data.k()*filter_nr*filter_nc);
+                            num_k*filter_nr*filter_nc);
             DLIB_CASSERT(output.size() != 0);
             float* t = &output(0,0);
 
@@ -1944,7 +2400,7 @@ namespace dlib
             {
                 for (long c = -padding_x; c < max_c; c+=stride_x)
                 {
-                    for (long k = 0; k < data.k(); ++k)
+                    for (long k = k_begin; k < k_begin+num_k; ++k)
                     {
                         for (long y = 0; y < filter_nr; ++y)
                         {
@@ -1975,7 +2431,9 @@ namespace dlib
             long stride_y,
             long stride_x,
             long padding_y,
-            long padding_x
+            long padding_x,
+            long k_begin,
+            long num_k
         )
         {
             const auto d = data.host() + data.k()*data.nr()*data.nc()*n;
@@ -1991,7 +2449,7 @@ namespace dlib
             {
                 for (long c = -padding_x; c < max_c; c+=stride_x)
                 {
-                    for (long k = 0; k < data.k(); ++k)
+                    for (long k = k_begin; k < k_begin+num_k; ++k)
                     {
                         for (long y = 0; y < filter_nr; ++y)
                         {
@@ -2009,6 +2467,671 @@ namespace dlib
             }
         }
 
+    // ------------------------------------------------------------------------------------
+
+        namespace
+        {
+            bool is_unpadded_1x1 (
+                const tensor& filters,
+                long stride_y,
+                long stride_x,
+                long padding_y,
+                long padding_x
+            )
+            {
+                return filters.nr() == 1 && filters.nc() == 1 && 
+                       stride_y == 1 && stride_x == 1 &&
+                       padding_y == 0 && padding_x == 0;
+            }
+
+            cpu_conv_algorithm select_conv_algorithm (
+                const tensor& data,
+                const tensor& filters,
+                long stride_y,
+                long stride_x,
+                long padding_y,
+                long padding_x
+            )
+            {
+                const bool can_use_direct = filters.nr() <= 5 && filters.nc() <= 5;
+                const bool can_use_winograd = filters.nr() == 3 && filters.nc() == 3 && 
+                                              stride_y == 1 && stride_x == 1;
+
+                switch (dnn_cpu_conv_algorithm())
+                {
+                    case cpu_conv_algorithm::img2col:
+                        return cpu_conv_algorithm::img2col;
+                    case cpu_conv_algorithm::direct:
+                        return can_use_direct ? cpu_conv_algorithm::direct : cpu_conv_algorithm::img2col;
+                    case cpu_conv_algorithm::winograd:
+                        return can_use_winograd ? cpu_conv_algorithm::winograd : cpu_conv_algorithm::img2col;
+                    case cpu_conv_algorithm::automatic:
+                        break;
+                }
+
+                // 1x1 filters with no padding or striding are handled by the direct path
+                // as a plain matrix multiply.
+                if (is_unpadded_1x1(filters, stride_y, stride_x, padding_y, padding_x))
+                    return cpu_conv_algorithm::direct;
+                // The Winograd transforms only pay for themselves when they are
+                // amortized over a reasonable number of channels and output tiles.
+                if (can_use_winograd && data.k() >= 8 && filters.num_samples() >= 8 &&
+                    data.nr()*data.nc() >= 64)
+                    return cpu_conv_algorithm::winograd;
+                // When there are only a few input channels the matrix multiply is so
+                // thin that building the img2col matrix costs more than it saves.  The
+                // direct kernel is only vectorized for a horizontal stride of 1 though.
+                if (can_use_direct && stride_x == 1 && data.k() <= 4)
+                    return cpu_conv_algorithm::direct;
+                return cpu_conv_algorithm::img2col;
+            }
+
+            inline long ceil_div (long a, long b) { return a >= 0 ? (a+b-1)/b : -((-a)/b); }
+            inline long floor_div (long a, long b) { return a >= 0 ? a/b : -((-a+b-1)/b); }
+
+            void conv_direct (
+                const bool add_to_output,
+                tensor& output,
+                const tensor& data,
+                const tensor& filters,
+                long stride_y,
+                long stride_x,
+                long padding_y,
+                long padding_x,
+                long num_groups
+            )
+            {
+                if (num_groups == 1 && is_unpadded_1x1(filters, stride_y, stride_x, padding_y, padding_x))
+                {
+                    // Each sample is already laid out as the k() by nr()*nc() matrix that
+                    // img2col() would have built, so just multiply it by the filters.
+                    const long plane = data.nr()*data.nc();
+                    filters.host();
+                    parallel_for_work(0, data.num_samples(), filters.size()*plane, [&](long begin, long end)
+                    {
+                        for (long n = begin; n < end; ++n)
+                        {
+                            auto d = mat(data.host()+n*data.k()*plane, data.k(), plane);
+                            if (add_to_output)
+                                output.add_to_sample(n, mat(filters)*d);
+                            else
+                                output.set_sample(n, mat(filters)*d);
+                        }
+                    });
+                    return;
+                }
+
+                const long nr = data.nr();
+                const long nc = data.nc();
+                const long onr = output.nr();
+                const long onc = output.nc();
+                const long fnr = filters.nr();
+                const long fnc = filters.nc();
+                // The number of channels each filter looks at, which is all of them unless
+                // this is a grouped convolution.
+                const long K = filters.k();
+                const long filters_per_group = output.k()/num_groups;
+                const long plane = nr*nc;
+
+                // Output columns in [c_begin, c_end) have every filter tap inside the
+                // image horizontally, so they can be computed without bounds checks.
+                const long c_begin = std::min(onc, ceil_div(padding_x, stride_x));
+                const long c_end = std::max(c_begin, std::min(onc, floor_div(nc-fnc+padding_x, stride_x)+1));
+
+                const float* d = data.host();
+                const float* filt = filters.host();
+                float* out = output.host();
+                parallel_for_work(0, output.num_samples()*output.k(), onr*onc*K*fnr*fnc, [&](long begin, long end)
+                {
+                    for (long i = begin; i < end; ++i)
+                    {
+                        const long n = i/output.k();
+                        const long f = i%output.k();
+                        const float* in = d + (n*data.k() + f/filters_per_group*K)*plane;
+                        const float* fw = filt + f*K*fnr*fnc;
+                        float* o = out + i*onr*onc;
+                        for (long r = 0; r < onr; ++r)
+                        {
+                            float* orow = o + r*onc;
+                            const long y_begin = std::max(0L, padding_y - r*stride_y);
+                            const long y_end = std::min(fnr, nr + padding_y - r*stride_y);
+
+                            auto compute_pixel = [&](long c)
+                            {
+                                const long x_begin = std::max(0L, padding_x - c*stride_x);
+                                const long x_end = std::min(fnc, nc + padding_x - c*stride_x);
+                                float sum = 0;
+                                for (long k = 0; k < K; ++k)
+                                {
+                                    for (long y = y_begin; y < y_end; ++y)
+                                    {
+                                        const float* irow = in + k*plane + (r*stride_y - padding_y + y)*nc + c*stride_x - padding_x;
+                                        const float* w = fw + (k*fnr + y)*fnc;
+                                        for (long x = x_begin; x < x_end; ++x)
+                                            sum += w[x]*irow[x];
+                                    }
+                                }
+                                if (add_to_output)
+                                    orow[c] += sum;
+                                else
+                                    orow[c] = sum;
+                            };
+
+                            long c = 0;
+                            for (; c < c_begin; ++c)
+                                compute_pixel(c);
+
+                            if (stride_x == 1)
+                            {
+                                // Accumulate 8 adjacent outputs in a register over all the
+                                // filter taps so each output is only written once.
+                                for (; c+8 <= c_end; c += 8)
+                                {
+                                    simd8f acc = 0;
+                                    for (long k = 0; k < K; ++k)
+                                    {
+                                        for (long y = y_begin; y < y_end; ++y)
+                                        {
+                                            const float* irow = in + k*plane + (r*stride_y - padding_y + y)*nc + c - padding_x;
+                                            const float* w = fw + (k*fnr + y)*fnc;
+                                            for (long x = 0; x < fnc; ++x)
+                                            {
+                                                simd8f iv;
+                                                iv.load(irow+x);
+                                                acc += simd8f(w[x])*iv;
+                                            }
+                                        }
+                                    }
+                                    if (add_to_output)
+                                    {
+                                        simd8f ov;
+                                        ov.load(orow+c);
+                                        acc += ov;
+                                    }
+                                    acc.store(orow+c);
+                                }
+                            }
+
+                            for (; c < onc; ++c)
+                                compute_pixel(c);
+                        }
+                    }
+                });
+            }
+
+            void conv_direct_data_gradient (
+                const tensor& gradient_input,
+                const tensor& filters,
+                tensor& data_gradient,
+                long stride_y,
+                long stride_x,
+                long padding_y,
+                long padding_x,
+                long num_groups
+            )
+            /*!
+                ensures
+                    - adds the gradient of a grouped convolution with respect to its input
+                      to data_gradient, without going through col2img().
+            !*/
+            {
+                const long nr = data_gradient.nr();
+                const long nc = data_gradient.nc();
+                const long onr = gradient_input.nr();
+                const long onc = gradient_input.nc();
+                const long fnr = filters.nr();
+                const long fnc = filters.nc();
+                const long K = filters.k();
+                const long filters_per_group = filters.num_samples()/num_groups;
+                const long plane = nr*nc;
+                const long oplane = onr*onc;
+
+                const float* g = gradient_input.host();
+                const float* filt = filters.host();
+                float* dg = data_gradient.host();
+                // Each job does the channels of one group in one sample, which only the
+                // filters of that group write to, so the jobs never write to the same place.
+                parallel_for_work(0, gradient_input.num_samples()*num_groups, oplane*filters_per_group*K*fnr*fnc, [&](long begin, long end)
+                {
+                    for (long i = begin; i < end; ++i)
+                    {
+                        const long n = i/num_groups;
+                        const long group = i%num_groups;
+                        float* out = dg + (n*data_gradient.k() + group*K)*plane;
+                        for (long f = group*filters_per_group; f < (group+1)*filters_per_group; ++f)
+                        {
+                            const float* gin = g + (n*gradient_input.k() + f)*oplane;
+                            const float* fw = filt + f*K*fnr*fnc;
+                            for (long r = 0; r < onr; ++r)
+                            {
+                                const float* grow = gin + r*onc;
+                                const long y_begin = std::max(0L, padding_y - r*stride_y);
+                                const long y_end = std::min(fnr, nr + padding_y - r*stride_y);
+                                for (long k = 0; k < K; ++k)
+                                {
+                                    for (long y = y_begin; y < y_end; ++y)
+                                    {
+                                        float* drow = out + k*plane + (r*stride_y - padding_y + y)*nc - padding_x;
+                                        const float* w = fw + (k*fnr + y)*fnc;
+                                        for (long x = 0; x < fnc; ++x)
+                                        {
+                                            // The output columns whose tap x lands inside the image.
+                                            const long c_begin = std::min(onc, std::max(0L, ceil_div(padding_x - x, stride_x)));
+                                            const long c_end = std::max(c_begin, std::min(onc, floor_div(nc - 1 + padding_x - x, stride_x) + 1));
+                                            long c = c_begin;
+                                            if (stride_x == 1)
+                                            {
+                                                const simd8f wv(w[x]);
+                                                for (; c+8 <= c_end; c += 8)
+                                                {
+                                                    simd8f dv, gv;
+                                                    dv.load(drow+c+x);
+                                                    gv.load(grow+c);
+                                                    dv += wv*gv;
+                                                    dv.store(drow+c+x);
+                                                }
+                                            }
+                                            for (; c < c_end; ++c)
+                                                drow[c*stride_x+x] += w[x]*grow[c];
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                });
+            }
+
+            void conv_direct_filters_gradient (
+                const bool add_to_output,
+                const tensor& gradient_input,
+                const tensor& data,
+                tensor& filters_gradient,
+                long stride_y,
+                long stride_x,
+                long padding_y,
+                long padding_x,
+                long num_groups
+            )
+            /*!
+                ensures
+                    - computes the gradient of a grouped convolution with respect to its
+                      filters, without going through img2col().
+            !*/
+            {
+                const long nr = data.nr();
+                const long nc = data.nc();
+                const long onr = gradient_input.nr();
+                const long onc = gradient_input.nc();
+                const long fnr = filters_gradient.nr();
+                const long fnc = filters_gradient.nc();
+                const long K = filters_gradient.k();
+                const long filters_per_group = filters_gradient.num_samples()/num_groups;
+                const long plane = nr*nc;
+                const long oplane = onr*onc;
+
+                const float* g = gradient_input.host();
+                const float* d = data.host();
+                float* fg = filters_gradient.host();
+                parallel_for_work(0, filters_gradient.num_samples(), gradient_input.num_samples()*oplane*K*fnr*fnc, [&](long begin, long end)
+                {
+                    for (long f = begin; f < end; ++f)
+                    {
+                        const long group = f/filters_per_group;
+                        for (long k = 0; k < K; ++k)
+                        {
+                            for (long y = 0; y < fnr; ++y)
+                            {
+                                const long r_begin = std::min(onr, std::max(0L, ceil_div(padding_y - y, stride_y)));
+                                const long r_end = std::max(r_begin, std::min(onr, floor_div(nr - 1 + padding_y - y, stride_y) + 1));
+                                for (long x = 0; x < fnc; ++x)
+                                {
+                                    const long c_begin = std::min(onc, std::max(0L, ceil_div(padding_x - x, stride_x)));
+                                    const long c_end = std::max(c_begin, std::min(onc, floor_div(nc - 1 + padding_x - x, stride_x) + 1));
+                                    simd8f acc = 0;
+                                    float sum = 0;
+                                    for (long n = 0; n < gradient_input.num_samples(); ++n)
+                                    {
+                                        const float* gin = g + (n*gradient_input.k() + f)*oplane;
+                                        const float* in = d + (n*data.k() + group*K + k)*plane;
+                                        for (long r = r_begin; r < r_end; ++r)
+                                        {
+                                            const float* grow = gin + r*onc;
+                                            const float* irow = in + (r*stride_y - padding_y + y)*nc - padding_x + x;
+                                            long c = c_begin;
+                                            if (stride_x == 1)
+                                            {
+                                                for (; c+8 <= c_end; c += 8)
+                                                {
+                                                    simd8f gv, iv;
+                                                    gv.load(grow+c);
+                                                    iv.load(irow+c);
+                                                    acc += gv*iv;
+                                                }
+                                            }
+                                            for (; c < c_end; ++c)
+                                                sum += grow[c]*irow[c*stride_x];
+                                        }
+                                    }
+                                    float& out = fg[((f*K + k)*fnr + y)*fnc + x];
+                                    if (add_to_output)
+                                        out += sum + dlib::sum(acc);
+                                    else
+                                        out = sum + dlib::sum(acc);
+                                }
+                            }
+                        }
+                    }
+                });
+            }
+
+            bool use_direct_grouped_conv (
+                const tensor& filters
+            )
+            {
+                // Like for ungrouped convolutions, the img2col() matrix of a group is only
+                // worth building when the group has more than a few channels.
+                return filters.k() <= 4 || dnn_cpu_conv_algorithm() == cpu_conv_algorithm::direct;
+            }
+
+            void conv_grouped_img2col (
+                const bool add_to_output,
+                tensor& output,
+                const tensor& data,
+                const tensor& filters,
+                long stride_y,
+                long stride_x,
+                long padding_y,
+                long padding_x,
+                long num_groups
+            )
+            /*!
+                ensures
+                    - computes a grouped convolution as one img2col() matrix multiply per
+                      group and sample.
+            !*/
+            {
+                const long K = filters.k();
+                const long filters_per_group = filters.num_samples()/num_groups;
+                const long filter_size = K*filters.nr()*filters.nc();
+                const long oplane = output.nr()*output.nc();
+
+                data.host();
+                filters.host();
+                output.host();
+                parallel_for_work(0, data.num_samples(), output.size()/output.num_samples()*filter_size,
+                    [&](long begin, long end)
+                {
+                    matrix<float> temp, res;
+                    for (long n = begin; n < end; ++n)
+                    {
+                        for (long g = 0; g < num_groups; ++g)
+                        {
+                            img2col(temp, data, n, filters.nr(), filters.nc(), stride_y, stride_x, padding_y, padding_x, g*K, K);
+                            res = mat(filters.host()+g*filters_per_group*filter_size, filters_per_group, filter_size)*trans(temp);
+
+                            float* o = output.host() + (n*output.k() + g*filters_per_group)*oplane;
+                            const float* r = &res(0,0);
+                            if (add_to_output)
+                            {
+                                for (long i = 0; i < res.size(); ++i)
+                                    o[i] += r[i];
+                            }
+                            else
+                            {
+                                std::memcpy(o, r, res.size()*sizeof(float));
+                            }
+                        }
+                    }
+                });
+            }
+
+            void conv_grouped_img2col_data_gradient (
+                const tensor& gradient_input,
+                const tensor& filters,
+                tensor& data_gradient,
+                long stride_y,
+                long stride_x,
+                long padding_y,
+                long padding_x,
+                long num_groups
+            )
+            {
+                const long K = filters.k();
+                const long filters_per_group = filters.num_samples()/num_groups;
+                const long filter_size = K*filters.nr()*filters.nc();
+                const long oplane = gradient_input.nr()*gradient_input.nc();
+
+                gradient_input.host();
+                filters.host();
+                data_gradient.host();
+                parallel_for_work(0, gradient_input.num_samples(), gradient_input.size()/gradient_input.num_samples()*filter_size,
+                    [&](long begin, long end)
+                {
+                    matrix<float> temp;
+                    for (long n = begin; n < end; ++n)
+                    {
+                        for (long g = 0; g < num_groups; ++g)
+                        {
+                            auto gi = mat(gradient_input.host() + (n*gradient_input.k() + g*filters_per_group)*oplane, filters_per_group, oplane);
+                            temp = trans(gi)*mat(filters.host()+g*filters_per_group*filter_size, filters_per_group, filter_size);
+                            col2img(temp, data_gradient, n, filters.nr(), filters.nc(), stride_y, stride_x, padding_y, padding_x, g*K, K);
+                        }
+                    }
+                });
+            }
+
+            void conv_grouped_img2col_filters_gradient (
+                const bool add_to_output,
+                const tensor& gradient_input,
+                const tensor& data,
+                tensor& filters_gradient,
+                long stride_y,
+                long stride_x,
+                long padding_y,
+                long padding_x,
+                long num_groups
+            )
+            {
+                const long K = filters_gradient.k();
+                const long filters_per_group = filters_gradient.num_samples()/num_groups;
+                const long filter_size = K*filters_gradient.nr()*filters_gradient.nc();
+                const long oplane = gradient_input.nr()*gradient_input.nc();
+
+                gradient_input.host();
+                data.host();
+                filters_gradient.host();
+                // Each group only writes to its own filters, so the groups can be done in
+                // parallel.
+                parallel_for_work(0, num_groups, gradient_input.size()/num_groups*filter_size, [&](long begin, long end)
+                {
+                    matrix<float> temp, sum;
+                    for (long g = begin; g < end; ++g)
+                    {
+                        sum.set_size(filters_per_group, filter_size);
+                        sum = 0;
+                        for (long n = 0; n < gradient_input.num_samples(); ++n)
+                        {
+                            auto gi = mat(gradient_input.host() + (n*gradient_input.k() + g*filters_per_group)*oplane, filters_per_group, oplane);
+                            img2col(temp, data, n, filters_gradient.nr(), filters_gradient.nc(), stride_y, stride_x, padding_y, padding_x, g*K, K);
+                            sum += gi*temp;
+                        }
+
+                        float* fg = filters_gradient.host() + g*filters_per_group*filter_size;
+                        const float* s = &sum(0,0);
+                        if (add_to_output)
+                        {
+                            for (long i = 0; i < sum.size(); ++i)
+                                fg[i] += s[i];
+                        }
+                        else
+                        {
+                            std::memcpy(fg, s, sum.size()*sizeof(float));
+                        }
+                    }
+                });
+            }
+
+            void conv_winograd_2x2_3x3 (
+                const bool add_to_output,
+                tensor& output,
+                const tensor& data,
+                const tensor& filters,
+                long padding_y,
+                long padding_x
+            )
+            {
+                /*
+                    This is the F(2x2,3x3) algorithm from "Fast Algorithms for
+                    Convolutional Neural Networks" by Lavin and Gray.  Each 2x2 block of
+                    output is computed from a 4x4 block of input as:
+                        Y = trans(A)*[(G*g*trans(G)) .* (trans(B)*d*B)]*A
+                    The elementwise products summed over input channels turn into 16
+                    independent matrix multiplies, one per element of the 4x4 transformed
+                    tiles.
+                */
+                const long K = data.k();
+                const long F = filters.num_samples();
+                const long nr = data.nr();
+                const long nc = data.nc();
+                const long onr = output.nr();
+                const long onc = output.nc();
+                const long tiles_y = (onr+1)/2;
+                const long tiles_x = (onc+1)/2;
+                const long T = tiles_y*tiles_x;
+
+                // U = G*g*trans(G) for every (filter, channel) pair.  The 16 elements of
+                // each transformed tile are stored in 16 separate F by K matrices.
+                matrix<float> U(16*F, K);
+                const float* g = filters.host();
+                for (long f = 0; f < F; ++f)
+                {
+                    for (long k = 0; k < K; ++k, g += 9)
+                    {
+                        float t[4][3];
+                        for (long c = 0; c < 3; ++c)
+                        {
+                            t[0][c] = g[c];
+                            t[1][c] = 0.5f*(g[c] + g[3+c] + g[6+c]);
+                            t[2][c] = 0.5f*(g[c] - g[3+c] + g[6+c]);
+                            t[3][c] = g[6+c];
+                        }
+                        for (long r = 0; r < 4; ++r)
+                        {
+                            U((r*4+0)*F+f, k) = t[r][0];
+                            U((r*4+1)*F+f, k) = 0.5f*(t[r][0] + t[r][1] + t[r][2]);
+                            U((r*4+2)*F+f, k) = 0.5f*(t[r][0] - t[r][1] + t[r][2]);
+                            U((r*4+3)*F+f, k) = t[r][2];
+                        }
+                    }
+                }
+
+                const float* d = data.host();
+                float* out = output.host();
+                matrix<float> V(16*K, T);
+                matrix<float> M(16*F, T);
+                for (long n = 0; n < data.num_samples(); ++n)
+                {
+                    // V = trans(B)*d*B for every (channel, tile) pair.
+                    parallel_for_work(0, K, 16*T, [&](long k_begin, long k_end)
+                    {
+                        for (long k = k_begin; k < k_end; ++k)
+                        {
+                            const float* in = d + (n*K + k)*nr*nc;
+                            for (long ty = 0; ty < tiles_y; ++ty)
+                            {
+                                for (long tx = 0; tx < tiles_x; ++tx)
+                                {
+                                    float dt[4][4];
+                                    const long r0 = ty*2 - padding_y;
+                                    const long c0 = tx*2 - padding_x;
+                                    for (long r = 0; r < 4; ++r)
+                                    {
+                                        for (long c = 0; c < 4; ++c)
+                                        {
+                                            const long rr = r0+r;
+                                            const long cc = c0+c;
+                                            if (0 <= rr && rr < nr && 0 <= cc && cc < nc)
+                                                dt[r][c] = in[rr*nc + cc];
+                                            else
+                                                dt[r][c] = 0;
+                                        }
+                                    }
+    
+                                    float t[4][4];
+                                    for (long c = 0; c < 4; ++c)
+                                    {
+                                        t[0][c] = dt[0][c] - dt[2][c];
+                                        t[1][c] = dt[1][c] + dt[2][c];
+                                        t[2][c] = dt[2][c] - dt[1][c];
+                                        t[3][c] = dt[1][c] - dt[3][c];
+                                    }
+                                    const long tile = ty*tiles_x + tx;
+                                    for (long r = 0; r < 4; ++r)
+                                    {
+                                        V((r*4+0)*K+k, tile) = t[r][0] - t[r][2];
+                                        V((r*4+1)*K+k, tile) = t[r][1] + t[r][2];
+                                        V((r*4+2)*K+k, tile) = t[r][2] - t[r][1];
+                                        V((r*4+3)*K+k, tile) = t[r][1] - t[r][3];
+                                    }
+                                }
+                            }
+                        }
+                    });
+
+                    parallel_for_work(0, 16, F*K*T, [&](long begin, long end)
+                    {
+                        for (long i = begin; i < end; ++i)
+                            set_ptrm(&M(i*F,0), F, T) = mat(&U(i*F,0), F, K)*mat(&V(i*K,0), K, T);
+                    });
+
+                    // Y = trans(A)*M*A, written back to the output tensor.
+                    parallel_for_work(0, F, 16*T, [&](long f_begin, long f_end)
+                    {
+                        for (long f = f_begin; f < f_end; ++f)
+                        {
+                            float* o = out + (n*F + f)*onr*onc;
+                            for (long ty = 0; ty < tiles_y; ++ty)
+                            {
+                                for (long tx = 0; tx < tiles_x; ++tx)
+                                {
+                                    const long tile = ty*tiles_x + tx;
+                                    float m[4][4];
+                                    for (long i = 0; i < 16; ++i)
+                                        m[i/4][i%4] = M(i*F+f, tile);
+    
+                                    float t[2][4];
+                                    for (long c = 0; c < 4; ++c)
+                                    {
+                                        t[0][c] = m[0][c] + m[1][c] + m[2][c];
+                                        t[1][c] = m[1][c] - m[2][c] - m[3][c];
+                                    }
+                                    float y[2][2];
+                                    for (long r = 0; r < 2; ++r)
+                                    {
+                                        y[r][0] = t[r][0] + t[r][1] + t[r][2];
+                                        y[r][1] = t[r][1] - t[r][2] - t[r][3];
+                                    }
+    
+                                    for (long r = 0; r < 2 && ty*2+r < onr; ++r)
+                                    {
+                                        for (long c = 0; c < 2 && tx*2+c < onc; ++c)
+                                        {
+                                            float& dest = o[(ty*2+r)*onc + tx*2+c];
+                                            if (add_to_output)
+                                                dest += y[r][c];
+                                            else
+                                                dest = y[r][c];
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    });
+                }
+            }
+        }
+
         void tensor_conv::operator() (
             const bool add_to_output,
             resizable_tensor& output,
@@ -2033,7 +3156,7 @@ namespace dlib
         {
             DLIB_CASSERT(is_same_object(output,data) == false);
             DLIB_CASSERT(is_same_object(output,filters) == false);
-            DLIB_CASSERT(filters.k() == data.k());
+            DLIB_CASSERT(filters.k()*last_num_groups == data.k());
             DLIB_CASSERT(last_stride_y > 0 && last_stride_x > 0, "You must call setup() before calling this function.");
             DLIB_CASSERT(filters.nr() <= data.nr() + 2*last_padding_y,
                 "Filter windows must be small enough to fit into the padded image.");
@@ -2045,17 +3168,44 @@ namespace dlib
             DLIB_CASSERT(output.nr() == 1+(data.nr()+2*last_padding_y-filters.nr())/last_stride_y);
             DLIB_CASSERT(output.nc() == 1+(data.nc()+2*last_padding_x-filters.nc())/last_stride_x);
 
-
-            matrix<float> temp;
-            for (long n = 0; n < data.num_samples(); ++n)
+            if (last_num_groups != 1)
             {
-                img2col(temp, data, n, filters.nr(), filters.nc(), last_stride_y, last_stride_x, last_padding_y, last_padding_x);
+                if (use_direct_grouped_conv(filters))
+                    conv_direct(add_to_output, output, data, filters, last_stride_y, last_stride_x, last_padding_y, last_padding_x, last_num_groups);
+                else
+                    conv_grouped_img2col(add_to_output, output, data, filters, last_stride_y, last_stride_x, last_padding_y, last_padding_x, last_num_groups);
+                return;
+            }
 
-                if (add_to_output)
-                    output.add_to_sample(n, mat(filters)*trans(temp));
-                else 
-                    output.set_sample(n, mat(filters)*trans(temp));
+            switch (select_conv_algorithm(data, filters, last_stride_y, last_stride_x, last_padding_y, last_padding_x))
+            {
+                case cpu_conv_algorithm::direct:
+                    conv_direct(add_to_output, output, data, filters, last_stride_y, last_stride_x, last_padding_y, last_padding_x, 1);
+                    return;
+                case cpu_conv_algorithm::winograd:
+                    conv_winograd_2x2_3x3(add_to_output, output, data, filters, last_padding_y, last_padding_x);
+                    return;
+                default:
+                    break;
             }
+
+            data.host();
+            filters.host();
+            output.host();
+            parallel_for_work(0, data.num_samples(), output.size()/output.num_samples()*filters.size()/filters.num_samples(), 
+                [&](long begin, long end)
+            {
+                matrix<float> temp;
+                for (long n = begin; n < end; ++n)
+                {
+                    img2col(temp, data, n, filters.nr(), filters.nc(), last_stride_y, last_stride_x, last_padding_y, last_padding_x, 0, data.k());
+
+                    if (add_to_output)
+                        output.add_to_sample(n, mat(filters)*trans(temp));
+                    else 
+                        output.set_sample(n, mat(filters)*trans(temp));
+                }
+            });
         }
 
     // ------------------------------------------------------------------------------------
@@ -2068,19 +3218,50 @@ namespace dlib
             tensor& data_gradient
         )
         {
-            matrix<float> temp;
             if (!add_to_output)
                 data_gradient = 0;
-            for (long n = 0; n < gradient_input.num_samples(); ++n)
+
+            if (last_num_groups != 1)
             {
-                auto gi = mat(gradient_input.host()+gradient_input.k()*gradient_input.nr()*gradient_input.nc()*n,
-                              gradient_input.k(),
-                              gradient_input.nr()*gradient_input.nc());
-                                    
+                if (use_direct_grouped_conv(filters))
+                    conv_direct_data_gradient(gradient_input, filters, data_gradient, last_stride_y, last_stride_x,
+                        last_padding_y, last_padding_x, last_num_groups);
+                else
+                    conv_grouped_img2col_data_gradient(gradient_input, filters, data_gradient, last_stride_y, last_stride_x,
+                        last_padding_y, last_padding_x, last_num_groups);
+                return;
+            }
 
-                temp = trans(gi)*mat(filters);
-                col2img(temp, data_gradient, n, filters.nr(), filters.nc(), last_stride_y, last_stride_x, last_padding_y, last_padding_x);
+            if (dnn_cpu_conv_algorithm() != cpu_conv_algorithm::img2col &&
+                is_unpadded_1x1(filters, last_stride_y, last_stride_x, last_padding_y, last_padding_x))
+            {
+                const long plane = data_gradient.nr()*data_gradient.nc();
+                parallel_for_work(0, gradient_input.num_samples(), filters.size()*plane, [&](long begin, long end)
+                {
+                    for (long n = begin; n < end; ++n)
+                    {
+                        auto gi = mat(gradient_input.host()+gradient_input.k()*plane*n, gradient_input.k(), plane);
+                        data_gradient.add_to_sample(n, trans(mat(filters))*gi);
+                    }
+                });
+                return;
             }
+
+            parallel_for_work(0, gradient_input.num_samples(), gradient_input.size()/gradient_input.num_samples()*filters.size()/filters.num_samples(),
+                [&](long begin, long end)
+            {
+                matrix<float> temp;
+                for (long n = begin; n < end; ++n)
+                {
+                    auto gi = mat(gradient_input.host()+gradient_input.k()*gradient_input.nr()*gradient_input.nc()*n,
+                                  gradient_input.k(),
+                                  gradient_input.nr()*gradient_input.nc());
+                                        
+
+                    temp = trans(gi)*mat(filters);
+                    col2img(temp, data_gradient, n, filters.nr(), filters.nc(), last_stride_y, last_stride_x, last_padding_y, last_padding_x, 0, data_gradient.k());
+                }
+            });
         }
 
     // ------------------------------------------------------------------------------------
@@ -2093,6 +3274,20 @@ namespace dlib
             tensor& filters_gradient
         )
         {
+            if (last_num_groups != 1)
+            {
+                if (use_direct_grouped_conv(filters_gradient))
+                    conv_direct_filters_gradient(add_to_output, gradient_input, data, filters_gradient, last_stride_y, last_stride_x,
+                        last_padding_y, last_padding_x, last_num_groups);
+                else
+                    conv_grouped_img2col_filters_gradient(add_to_output, gradient_input, data, filters_gradient, last_stride_y, last_stride_x,
+                        last_padding_y, last_padding_x, last_num_groups);
+                return;
+            }
+
+            const bool skip_img2col = dnn_cpu_conv_algorithm() != cpu_conv_algorithm::img2col &&
+                is_unpadded_1x1(filters_gradient, last_stride_y, last_stride_x, last_padding_y, last_padding_x);
+
             matrix<float> temp;
             for (long n = 0; n < gradient_input.num_samples(); ++n)
             {
@@ -2100,8 +3295,18 @@ namespace dlib
                               gradient_input.k(),
                               gradient_input.nr()*gradient_input.nc());
 
+                if (skip_img2col)
+                {
+                    // The data is already laid out as the transpose of the img2col matrix.
+                    auto d = mat(data.host()+data.k()*data.nr()*data.nc()*n, data.k(), data.nr()*data.nc());
+                    if (n == 0 && !add_to_output)
+                        filters_gradient = gi*trans(d);
+                    else
+                        filters_gradient += gi*trans(d);
+                    continue;
+                }
 
-                img2col(temp, data, n, filters_gradient.nr(), filters_gradient.nc(), last_stride_y, last_stride_x, last_padding_y, last_padding_x);
+                img2col(temp, data, n, filters_gradient.nr(), filters_gradient.nc(), last_stride_y, last_stride_x, last_padding_y, last_padding_x, 0, data.k());
                 if (n == 0)
                 {
                     if (add_to_output)
@@ -2116,6 +3321,401 @@ namespace dlib
             }
         }
 
+     // ------------------------------------------------------------------------------------
+
+        namespace
+        {
+#if defined(DLIB_HAVE_AVX2)
+            inline int32 horizontal_sum (
+                __m256i v
+            )
+            {
+                __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v,1));
+                s = _mm_hadd_epi32(s,s);
+                s = _mm_hadd_epi32(s,s);
+                return _mm_cvtsi128_si32(s);
+            }
+
+            inline __m256i dot_accumulate (
+                __m256i acc,
+                __m256i x,
+                __m256i w
+            )
+            {
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+                return _mm256_dpbusd_epi32(acc, x, w);
+#elif defined(__AVXVNNI__)
+                return _mm256_dpbusd_avx_epi32(acc, x, w);
+#else
+                // maddubs multiplies the unsigned x by the signed w and sums adjacent pairs
+                // into 16 bits, which can't saturate since x <= 127.  Then madd with ones
+                // widens them to 32 bits.
+                return _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), _mm256_set1_epi16(1)));
+#endif
+            }
+#elif defined(DLIB_HAVE_SSE41)
+            inline int32 horizontal_sum (
+                __m128i s
+            )
+            {
+                s = _mm_hadd_epi32(s,s);
+                s = _mm_hadd_epi32(s,s);
+                return _mm_cvtsi128_si32(s);
+            }
+
+            inline __m128i dot_accumulate (
+                __m128i acc,
+                __m128i x,
+                __m128i w
+            )
+            {
+                return _mm_add_epi32(acc, _mm_madd_epi16(_mm_maddubs_epi16(x, w), _mm_set1_epi16(1)));
+            }
+#endif
+
+            void dot_uint7_int8 (
+                const std::int8_t* w,
+                const long w_stride,
+                const long num_w,
+                const std::uint8_t* x,
+                const long x_stride,
+                const long num_x,
+                const long size,
+                int32 (&out)[2][4]
+            )
+            /*!
+                requires
+                    - 1 <= num_w <= 2
+                    - 1 <= num_x <= 4
+                    - size % quantized_filter_alignment == 0
+                    - all the x values are <= 127
+                ensures
+                    - for all i < num_w and j < num_x:
+                        - out[i][j] == the dot product of w+i*w_stride and x+j*x_stride,
+                          both of which are arrays of size values.
+                    - Each value is loaded once for all the dot products it's part of.
+            !*/
+            {
+                const std::int8_t* w0 = w;
+                const std::int8_t* w1 = num_w > 1 ? w+w_stride : w;
+                const std::uint8_t* x0 = x;
+                const std::uint8_t* x1 = num_x > 1 ? x+x_stride   : x;
+                const std::uint8_t* x2 = num_x > 2 ? x+2*x_stride : x;
+                const std::uint8_t* x3 = num_x > 3 ? x+3*x_stride : x;
+#if defined(DLIB_HAVE_AVX2)
+                __m256i a00 = _mm256_setzero_si256(), a01 = a00, a02 = a00, a03 = a00;
+                __m256i a10 = a00, a11 = a00, a12 = a00, a13 = a00;
+                for (long i = 0; i < size; i += 32)
+                {
+                    const __m256i vw0 = _mm256_loadu_si256((const __m256i*)(w0+i));
+                    const __m256i vw1 = _mm256_loadu_si256((const __m256i*)(w1+i));
+                    __m256i v = _mm256_loadu_si256((const __m256i*)(x0+i));
+                    a00 = dot_accumulate(a00, v, vw0); a10 = dot_accumulate(a10, v, vw1);
+                    v = _mm256_loadu_si256((const __m256i*)(x1+i));
+                    a01 = dot_accumulate(a01, v, vw0); a11 = dot_accumulate(a11, v, vw1);
+                    v = _mm256_loadu_si256((const __m256i*)(x2+i));
+                    a02 = dot_accumulate(a02, v, vw0); a12 = dot_accumulate(a12, v, vw1);
+                    v = _mm256_loadu_si256((const __m256i*)(x3+i));
+                    a03 = dot_accumulate(a03, v, vw0); a13 = dot_accumulate(a13, v, vw1);
+                }
+                out[0][0] = horizontal_sum(a00); out[0][1] = horizontal_sum(a01);
+                out[0][2] = horizontal_sum(a02); out[0][3] = horizontal_sum(a03);
+                out[1][0] = horizontal_sum(a10); out[1][1] = horizontal_sum(a11);
+                out[1][2] = horizontal_sum(a12); out[1][3] = horizontal_sum(a13);
+#elif defined(DLIB_HAVE_SSE41)
+                __m128i a00 = _mm_setzero_si128(), a01 = a00, a02 = a00, a03 = a00;
+                __m128i a10 = a00, a11 = a00, a12 = a00, a13 = a00;
+                for (long i = 0; i < size; i += 16)
+                {
+                    const __m128i vw0 = _mm_loadu_si128((const __m128i*)(w0+i));
+                    const __m128i vw1 = _mm_loadu_si128((const __m128i*)(w1+i));
+                    __m128i v = _mm_loadu_si128((const __m128i*)(x0+i));
+                    a00 = dot_accumulate(a00, v, vw0); a10 = dot_accumulate(a10, v, vw1);
+                    v = _mm_loadu_si128((const __m128i*)(x1+i));
+                    a01 = dot_accumulate(a01, v, vw0); a11 = dot_accumulate(a11, v, vw1);
+                    v = _mm_loadu_si128((const __m128i*)(x2+i));
+                    a02 = dot_accumulate(a02, v, vw0); a12 = dot_accumulate(a12, v, vw1);
+                    v = _mm_loadu_si128((const __m128i*)(x3+i));
+                    a03 = dot_accumulate(a03, v, vw0); a13 = dot_accumulate(a13, v, vw1);
+                }
+                out[0][0] = horizontal_sum(a00); out[0][1] = horizontal_sum(a01);
+                out[0][2] = horizontal_sum(a02); out[0][3] = horizontal_sum(a03);
+                out[1][0] = horizontal_sum(a10); out[1][1] = horizontal_sum(a11);
+                out[1][2] = horizontal_sum(a12); out[1][3] = horizontal_sum(a13);
+#else
+                int32 sums[2][4] = {{0,0,0,0},{0,0,0,0}};
+                for (long i = 0; i < size; ++i)
+                {
+                    const int32 v0 = w0[i];
+                    const int32 v1 = w1[i];
+                    sums[0][0] += v0*x0[i]; sums[1][0] += v1*x0[i];
+                    sums[0][1] += v0*x1[i]; sums[1][1] += v1*x1[i];
+                    sums[0][2] += v0*x2[i]; sums[1][2] += v1*x2[i];
+                    sums[0][3] += v0*x3[i]; sums[1][3] += v1*x3[i];
+                }
+                for (long i = 0; i < 2; ++i)
+                    for (long j = 0; j < 4; ++j)
+                        out[i][j] = sums[i][j];
+#endif
+            }
+        }
+
+        void quantized_conv (
+            resizable_tensor& output,
+            const tensor& data,
+            const float data_scale,
+            const long data_offset,
+            const std::int8_t* filters,
+            const long filter_stride,
+            const float* filter_scales,
+            const float* biases,
+            const long num_filters,
+            const long filter_nr,
+            const long filter_nc,
+            const int stride_y,
+            const int stride_x,
+            const int padding_y,
+            const int padding_x,
+            const bool apply_relu
+        )
+        {
+            DLIB_CASSERT(stride_y > 0 && stride_x > 0);
+            output.set_size(data.num_samples(),
+                            num_filters,
+                            1+(data.nr()+2*padding_y-filter_nr)/stride_y,
+                            1+(data.nc()+2*padding_x-filter_nc)/stride_x);
+            quantized_conv(static_cast<tensor&>(output), data, data_scale, data_offset, filters, filter_stride,
+                filter_scales, biases, num_filters, filter_nr, filter_nc, stride_y, stride_x, padding_y, padding_x,
+                apply_relu);
+        }
+
+        void quantized_conv (
+            tensor& output,
+            const tensor& data,
+            const float data_scale,
+            const long data_offset,
+            const std::int8_t* filters,
+            const long filter_stride,
+            const float* filter_scales,
+            const float* biases,
+            const long num_filters,
+            const long filter_nr,
+            const long filter_nc,
+            const int stride_y,
+            const int stride_x,
+            const int padding_y,
+            const int padding_x,
+            const bool apply_relu
+        )
+        {
+            DLIB_CASSERT(data_scale > 0);
+            DLIB_CASSERT(0 <= data_offset && data_offset <= 127);
+            DLIB_CASSERT(filter_stride >= data.k()*filter_nr*filter_nc);
+            DLIB_CASSERT(filter_stride%quantized_filter_alignment == 0);
+            DLIB_CASSERT(stride_y > 0 && stride_x > 0);
+            DLIB_CASSERT(0 <= padding_y && padding_y < filter_nr);
+            DLIB_CASSERT(0 <= padding_x && padding_x < filter_nc);
+            DLIB_CASSERT(filter_nr <= data.nr() + 2*padding_y,
+                "Filter row size is larger than the input data size plus padding.");
+            DLIB_CASSERT(filter_nc <= data.nc() + 2*padding_x,
+                "Filter column size is larger than the input data size plus padding.");
+
+            const long out_nr = 1+(data.nr()+2*padding_y-filter_nr)/stride_y;
+            const long out_nc = 1+(data.nc()+2*padding_x-filter_nc)/stride_x;
+            DLIB_CASSERT(output.num_samples() == data.num_samples());
+            DLIB_CASSERT(output.k() == num_filters);
+            DLIB_CASSERT(output.nr() == out_nr);
+            DLIB_CASSERT(output.nc() == out_nc);
+
+            const long k = data.k();
+            const long in_plane = data.nr()*data.nc();
+            const long out_plane = out_nr*out_nc;
+            const float inv_scale = 1/data_scale;
+            // Enough output locations that their img2col rows fill roughly half the L2
+            // cache, so they stay resident while every filter is run over them.
+            const long block_size = std::max(4L, (1L<<17)/filter_stride/4*4);
+            const long num_blocks = (out_plane+block_size-1)/block_size;
+
+            // The padding around the image and after each img2col row holds the quantized
+            // value of 0, i.e. data_offset.  So the offset contributes data_offset times
+            // the sum of the filter weights to each output, which we subtract at the end.
+            std::vector<int32> offsets(num_filters);
+            for (long f = 0; f < num_filters; ++f)
+            {
+                int32 sum = 0;
+                for (long j = 0; j < filter_stride; ++j)
+                    sum += filters[f*filter_stride+j];
+                offsets[f] = sum*data_offset;
+            }
+
+            std::vector<std::uint8_t> qdata(k*in_plane);
+            std::vector<std::uint8_t> cols(out_plane*filter_stride);
+            const std::uint8_t pad = static_cast<std::uint8_t>(data_offset);
+            const float* d = data.host();
+            float* out = output.host();
+            for (long n = 0; n < data.num_samples(); ++n, d += k*in_plane, out += num_filters*out_plane)
+            {
+                parallel_for_work(0, k*in_plane, 1, [&](long begin, long end)
+                {
+                    for (long i = begin; i < end; ++i)
+                    {
+                        const float val = std::min(std::max(d[i]*inv_scale + data_offset, 0.0f), 127.0f);
+                        qdata[i] = static_cast<std::uint8_t>(val + 0.5f);
+                    }
+                });
+
+                // Lay the receptive field of each output location out as one contiguous,
+                // padded row, just like img2col() does.
+                parallel_for_work(0, out_plane, filter_stride, [&](long begin, long end)
+                {
+                    for (long p = begin; p < end; ++p)
+                    {
+                        const long r = p/out_nc*stride_y - padding_y;
+                        const long c = p%out_nc*stride_x - padding_x;
+                        const bool inside = r >= 0 && c >= 0 && r+filter_nr <= data.nr() && c+filter_nc <= data.nc();
+                        std::uint8_t* row = &cols[p*filter_stride];
+                        for (long kk = 0; kk < k; ++kk)
+                        {
+                            const std::uint8_t* in = &qdata[kk*in_plane];
+                            for (long y = r; y < r+filter_nr; ++y)
+                            {
+                                if (inside)
+                                {
+                                    std::copy(in+y*data.nc()+c, in+y*data.nc()+c+filter_nc, row);
+                                    row += filter_nc;
+                                    continue;
+                                }
+                                for (long x = c; x < c+filter_nc; ++x)
+                                {
+                                    if (0 <= y && y < data.nr() && 0 <= x && x < data.nc())
+                                        *row++ = in[y*data.nc()+x];
+                                    else
+                                        *row++ = pad;
+                                }
+                            }
+                        }
+                        std::fill(row, &cols[(p+1)*filter_stride], pad);
+                    }
+                });
+
+                parallel_for_work(0, num_blocks, block_size*num_filters*filter_stride, [&](long begin, long end)
+                {
+                    int32 acc[2][4];
+                    for (long b = begin; b < end; ++b)
+                    {
+                        const long pend = std::min(out_plane, (b+1)*block_size);
+                        for (long f = 0; f < num_filters; f += 2)
+                        {
+                            const long num_w = std::min(2L, num_filters-f);
+                            for (long p = b*block_size; p < pend; p += 4)
+                            {
+                                const long num_x = std::min(4L, pend-p);
+                                dot_uint7_int8(filters + f*filter_stride, filter_stride, num_w,
+                                    &cols[p*filter_stride], filter_stride, num_x, filter_stride, acc);
+                                for (long i = 0; i < num_w; ++i)
+                                {
+                                    const float scale = data_scale*filter_scales[f+i];
+                                    float* o = out + (f+i)*out_plane + p;
+                                    for (long j = 0; j < num_x; ++j)
+                                    {
+                                        const float val = (acc[i][j]-offsets[f+i])*scale + biases[f+i];
+                                        o[j] = (apply_relu && val < 0) ? 0 : val;
+                                    }
+                                }
+                            }
+                        }
+                    }
+                });
+            }
+        }
+
+     // ------------------------------------------------------------------------------------
+
+        void reduced_precision_fc (
+            tensor& output,
+            const tensor& data,
+            const std::uint16_t* weights,
+            const storage_precision precision,
+            const float* biases,
+            const long num_outputs,
+            const bool apply_relu
+        )
+        {
+            DLIB_CASSERT(precision != storage_precision::float32);
+            DLIB_CASSERT(output.num_samples() == data.num_samples());
+            DLIB_CASSERT((long)output.size() == data.num_samples()*num_outputs);
+
+            const long num_samples = data.num_samples();
+            const long input_size = data.size()/num_samples;
+            // Enough rows of weights to fill roughly half the L2 cache once converted to
+            // float, so they stay resident while every sample is run over them.
+            const long block_size = std::max(1L, (1L<<15)/input_size);
+            const long num_blocks = (num_outputs+block_size-1)/block_size;
+
+            const float* d = data.host();
+            float* out = output.host();
+
+            // With only a few samples, each row of weights is used so few times that a
+            // matrix multiply can't do much better than reading it.  So convert one row at
+            // a time into a buffer that stays in L1 and take its dot product with each
+            // sample directly, which avoids the overhead of a BLAS call per block.
+            const long max_direct_samples = 4;
+            if (num_samples <= max_direct_samples)
+            {
+                parallel_for_work(0, num_outputs, input_size*num_samples, [&](long begin, long end)
+                {
+                    std::vector<float> w(input_size);
+                    for (long f = begin; f < end; ++f)
+                    {
+                        convert_from_reduced_precision(weights + f*input_size, &w[0], input_size, precision);
+                        simd8f acc[max_direct_samples];
+                        for (long n = 0; n < num_samples; ++n)
+                            acc[n] = 0;
+                        long i = 0;
+                        for (; i + 8 <= input_size; i += 8)
+                        {
+                            simd8f wv, dv;
+                            wv.load(&w[i]);
+                            for (long n = 0; n < num_samples; ++n)
+                            {
+                                dv.load(d + n*input_size + i);
+                                acc[n] += wv*dv;
+                            }
+                        }
+                        for (long n = 0; n < num_samples; ++n)
+                        {
+                            float val = sum(acc[n]) + biases[f];
+                            for (long j = i; j < input_size; ++j)
+                                val += w[j]*d[n*input_size + j];
+                            out[n*num_outputs + f] = (apply_relu && val < 0) ? 0 : val;
+                        }
+                    }
+                });
+                return;
+            }
+
+            parallel_for_work(0, num_blocks, block_size*input_size*num_samples, [&](long begin, long end)
+            {
+                std::vector<float> w(block_size*input_size);
+                std::vector<float> o(num_samples*block_size);
+                for (long b = begin; b < end; ++b)
+                {
+                    const long f = b*block_size;
+                    const long rows = std::min(block_size, num_outputs-f);
+                    convert_from_reduced_precision(weights + f*input_size, &w[0], rows*input_size, precision);
+                    set_ptrm(&o[0], num_samples, rows) = mat(d, num_samples, input_size)*trans(mat(&w[0], rows, input_size));
+                    for (long n = 0; n < num_samples; ++n)
+                    {
+                        for (long i = 0; i < rows; ++i)
+                        {
+                            const float val = o[n*rows + i] + biases[f+i];
+                            out[n*num_outputs + f + i] = (apply_relu && val < 0) ? 0 : val;
+                        }
+                    }
+                }
+            });
+        }
+
      // ------------------------------------------------------------------------------------
 
         void copy_tensor(
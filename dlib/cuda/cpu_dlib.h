@@ -7,7 +7,9 @@
 // and cudnn_dlibapi.h
 
 #include "tensor.h"
+#include "reduced_precision.h"
 #include "../geometry/rectangle.h"
+#include <cstdint>
 
 namespace dlib
 {
@@ -51,6 +53,16 @@ namespace dlib
             const tensor& src
         );
 
+        void gemm (
+            float beta,
+            tensor& dest,
+            float alpha,
+            const tensor& lhs,
+            bool trans_lhs,
+            const tensor& rhs,
+            bool trans_rhs
+        );
+
         void assign_bias_gradient (
             tensor& grad,
             const tensor& gradient_input
@@ -62,6 +74,31 @@ namespace dlib
             const tensor& src2
         );
 
+        void add_relu (
+            tensor& dest,
+            const tensor& src1,
+            const tensor& src2
+        );
+        /*!
+            requires
+                - dest, src1 and src2 all have the same dimensions.
+            ensures
+                - #dest == max(0, src1 + src2), i.e. add() followed by relu() in one pass.
+        !*/
+
+        void add_conv_bias (
+            tensor& dest,
+            const tensor& biases,
+            const bool apply_relu
+        );
+        /*!
+            requires
+                - biases.size() == dest.k()
+            ensures
+                - Adds biases[k] to every element in channel k of dest.  If apply_relu is
+                  true then negative results are also replaced with 0.
+        !*/
+
         void assign_conv_bias_gradient (
             tensor& grad,
             const tensor& gradient_input
@@ -156,6 +193,55 @@ namespace dlib
             const tensor& params_grad
         );
 
+    // -----------------------------------------------------------------------------------
+
+        void compute_adamw_update (
+            size_t begin,
+            size_t end,
+            tensor& s,
+            tensor& m,
+            tensor& v,
+            const float t,
+            const float learning_rate,
+            const float weight_decay,
+            const float momentum1,
+            const float momentum2,
+            const tensor& params,
+            const tensor& params_grad
+        );
+
+    // -----------------------------------------------------------------------------------
+
+        void compute_lamb_update (
+            size_t begin,
+            size_t end,
+            tensor& s,
+            tensor& m,
+            tensor& v,
+            const float t,
+            const float learning_rate,
+            const float weight_decay,
+            const float momentum1,
+            const float momentum2,
+            const tensor& params,
+            const tensor& params_grad,
+            resizable_tensor& sums
+        );
+
+    // -----------------------------------------------------------------------------------
+
+        void compute_nesterov_update (
+            size_t begin,
+            size_t end,
+            tensor& s,
+            tensor& v,
+            const float learning_rate,
+            const float weight_decay,
+            const float momentum,
+            const tensor& params,
+            const tensor& params_grad
+        );
+
     // -----------------------------------------------------------------------------------
 
         void batch_normalize_inference (
@@ -394,6 +480,16 @@ namespace dlib
                 const tensor& src
             );
 
+            void operator() (
+                tensor& dest,
+                const tensor& src
+            );
+            /*!
+                requires
+                    - dest already has the dimensions the resizable_tensor version of this
+                      function would give it.
+            !*/
+
             void get_gradient(
                 const tensor& gradient_input, 
                 const tensor& dest,
@@ -431,17 +527,20 @@ namespace dlib
                 int stride_y,
                 int stride_x,
                 int padding_y,
-                int padding_x
+                int padding_x,
+                int num_groups = 1
             ) 
             {
                 (void)data;    /* silence compiler */
                 DLIB_CASSERT(stride_y > 0 && stride_x > 0);
                 DLIB_CASSERT(0 <= padding_y && padding_y < filters.nr());
                 DLIB_CASSERT(0 <= padding_x && padding_x < filters.nc());
+                DLIB_CASSERT(num_groups > 0 && filters.num_samples()%num_groups == 0);
                 last_stride_y = stride_y;
                 last_stride_x = stride_x;
                 last_padding_y = padding_y;
                 last_padding_x = padding_x;            
+                last_num_groups = num_groups;
             }
 
              void operator() (
@@ -478,8 +577,110 @@ namespace dlib
             long last_stride_x = 0;
             long last_padding_y = 0;
             long last_padding_x = 0;
+            long last_num_groups = 1;
         };
 
+    // -----------------------------------------------------------------------------------
+
+        const long quantized_filter_alignment = 32;
+
+        void quantized_conv (
+            resizable_tensor& output,
+            const tensor& data,
+            const float data_scale,
+            const long data_offset,
+            const std::int8_t* filters,
+            const long filter_stride,
+            const float* filter_scales,
+            const float* biases,
+            const long num_filters,
+            const long filter_nr,
+            const long filter_nc,
+            const int stride_y,
+            const int stride_x,
+            const int padding_y,
+            const int padding_x,
+            const bool apply_relu
+        );
+        /*!
+            requires
+                - data_scale > 0
+                - 0 <= data_offset <= 127
+                - filter_stride >= data.k()*filter_nr*filter_nc
+                - filter_stride % quantized_filter_alignment == 0
+                - filters points to num_filters*filter_stride values.  Filter f starts at
+                  filters + f*filter_stride, is laid out like a tensor_conv filter (i.e.
+                  k, then rows, then columns) and is zero padded to filter_stride values.
+                - filter_scales and biases point to num_filters values.
+            ensures
+                - Performs the same convolution as tensor_conv, except the arithmetic is
+                  done with 8 bit integers.  Each value in data is first quantized to the
+                  7 bit unsigned value round(data/data_scale)+data_offset, clipped to
+                  [0,127].  So data_offset == 0 suits non-negative data while 64 splits
+                  the range evenly between negative and positive values.  The real valued
+                  filter f is filters[f]*filter_scales[f].  The products are accumulated in
+                  32 bit integers and then:
+                    - #output(n,f,r,c) == data_scale*filter_scales[f]*accumulator + biases[f]
+                - if (apply_relu) then negative outputs are replaced with 0.
+        !*/
+
+        void quantized_conv (
+            tensor& output,
+            const tensor& data,
+            const float data_scale,
+            const long data_offset,
+            const std::int8_t* filters,
+            const long filter_stride,
+            const float* filter_scales,
+            const float* biases,
+            const long num_filters,
+            const long filter_nr,
+            const long filter_nc,
+            const int stride_y,
+            const int stride_x,
+            const int padding_y,
+            const int padding_x,
+            const bool apply_relu
+        );
+        /*!
+            requires
+                - output already has the dimensions the resizable_tensor version of
+                  quantized_conv() would give it.
+                - The rest of the requirements are the same as for that version.
+            ensures
+                - Computes the same thing as the resizable_tensor version of
+                  quantized_conv().
+        !*/
+
+    // -----------------------------------------------------------------------------------
+
+        void reduced_precision_fc (
+            tensor& output,
+            const tensor& data,
+            const std::uint16_t* weights,
+            const storage_precision precision,
+            const float* biases,
+            const long num_outputs,
+            const bool apply_relu
+        );
+        /*!
+            requires
+                - precision != storage_precision::float32
+                - output.num_samples() == data.num_samples()
+                - output.size() == data.num_samples()*num_outputs
+                - weights points to num_outputs*(data.size()/data.num_samples()) values
+                  in the 16 bit format precision.  It's a num_outputs by input size
+                  matrix, i.e. each output's weights are contiguous.
+                - biases points to num_outputs values.
+            ensures
+                - Computes what an fc_ layer does, with the weights stored in 16 bits.
+                  That is, #output(n,f) == dot(data sample n, weights row f) + biases[f].
+                  The weights are converted to float a block of rows at a time, just
+                  before they are used, so the products and sums are done with floats
+                  while the weights are read from memory at half the size.
+                - if (apply_relu) then negative outputs are replaced with 0.
+        !*/
+
     // -----------------------------------------------------------------------------------
 
         void copy_tensor(
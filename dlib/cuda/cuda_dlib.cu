@@ -1159,6 +1159,202 @@ namespace dlib
                     momentum1, momentum2, params.device(), params_grad.device());
         }
 
+    // -----------------------------------------------------------------------------------
+
+        __global__ void _cuda_compute_adamw_update(
+            size_t begin,
+            size_t end,
+            float* s,
+            float* m,
+            float* v,
+            const float alpha,
+            const float decay,
+            const float momentum1,
+            const float momentum2,
+            const float* params,
+            const float* params_grad
+        )
+        {
+            const float eps = 1e-8;
+            // The loop is equivalent to doing this:
+            //   m = momentum1*m + (1-momentum1)    *   params_grad;
+            //   v = momentum2*v + (1-momentum2)*squared(params_grad);
+            //   s = -alpha*m/(sqrt(v) + eps) - decay*params;
+            for (auto i : grid_stride_range(begin, end))
+            {
+                float g = params_grad[i];
+                m[i] = momentum1*m[i] + (1-momentum1)*g;
+                v[i] = momentum2*v[i] + (1-momentum2)*g*g;
+                s[i] = -alpha*m[i]/(std::sqrt(v[i]) + eps) - decay*params[i];
+            }
+        }
+
+        void compute_adamw_update (
+            size_t begin,
+            size_t end,
+            tensor& s,
+            tensor& m,
+            tensor& v,
+            const float t,
+            const float learning_rate,
+            const float weight_decay,
+            const float momentum1,
+            const float momentum2,
+            const tensor& params,
+            const tensor& params_grad
+        )
+        {
+            DLIB_CASSERT(s.size() == m.size() &&
+                         s.size() == v.size() &&
+                         s.size() == params.size() &&
+                         s.size() == params_grad.size());
+            DLIB_CASSERT(begin <= end && end <= params.size());
+            const float alpha = learning_rate*std::sqrt(1-std::pow(momentum2,t))/(1-std::pow(momentum1, t));
+
+            launch_kernel(_cuda_compute_adamw_update,max_jobs(end-begin),
+                    begin, end, s.device(), m.device(), v.device(), alpha, learning_rate*weight_decay,
+                    momentum1, momentum2, params.device(), params_grad.device());
+        }
+
+    // -----------------------------------------------------------------------------------
+
+        __global__ void _cuda_compute_lamb_update(
+            size_t begin,
+            size_t end,
+            float* s,
+            float* m,
+            float* v,
+            const float c1,
+            const float c2,
+            const float weight_decay,
+            const float momentum1,
+            const float momentum2,
+            const float* params,
+            const float* params_grad,
+            float* sums
+        )
+        {
+            const float eps = 1e-6;
+            // The loop is equivalent to doing this, while also summing the squares of
+            // params and s into sums[0] and sums[1]:
+            //   m = momentum1*m + (1-momentum1)    *   params_grad;
+            //   v = momentum2*v + (1-momentum2)*squared(params_grad);
+            //   s = (c1*m)/(sqrt(c2*v) + eps) + weight_decay*params;
+            float psum = 0;
+            float usum = 0;
+            for (auto i : grid_stride_range(begin, end))
+            {
+                float g = params_grad[i];
+                m[i] = momentum1*m[i] + (1-momentum1)*g;
+                v[i] = momentum2*v[i] + (1-momentum2)*g*g;
+                s[i] = c1*m[i]/(std::sqrt(c2*v[i]) + eps) + weight_decay*params[i];
+                psum += params[i]*params[i];
+                usum += s[i]*s[i];
+            }
+            warp_reduce_atomic_add(sums[0], psum);
+            warp_reduce_atomic_add(sums[1], usum);
+        }
+
+        __global__ void _cuda_scale_lamb_update(
+            size_t begin,
+            size_t end,
+            float* s,
+            const float learning_rate,
+            const float* sums
+        )
+        {
+            const float params_norm = std::sqrt(sums[0]);
+            const float update_norm = std::sqrt(sums[1]);
+            const float trust_ratio = (params_norm > 0 && update_norm > 0) ? params_norm/update_norm : 1;
+            const float scale = -learning_rate*trust_ratio;
+            for (auto i : grid_stride_range(begin, end))
+                s[i] *= scale;
+        }
+
+        void compute_lamb_update (
+            size_t begin,
+            size_t end,
+            tensor& s,
+            tensor& m,
+            tensor& v,
+            const float t,
+            const float learning_rate,
+            const float weight_decay,
+            const float momentum1,
+            const float momentum2,
+            const tensor& params,
+            const tensor& params_grad,
+            resizable_tensor& sums
+        )
+        {
+            DLIB_CASSERT(s.size() == m.size() &&
+                         s.size() == v.size() &&
+                         s.size() == params.size() &&
+                         s.size() == params_grad.size());
+            DLIB_CASSERT(begin <= end && end <= params.size());
+            const float c1 = 1/(1-std::pow(momentum1, t));
+            const float c2 = 1/(1-std::pow(momentum2, t));
+
+            // The norms stay on the device, so the second kernel can use them without
+            // waiting on the host.
+            if (sums.size() != 2)
+                sums.set_size(2);
+            sums = 0;
+            launch_kernel(_cuda_compute_lamb_update,max_jobs(end-begin),
+                    begin, end, s.device(), m.device(), v.device(), c1, c2, weight_decay,
+                    momentum1, momentum2, params.device(), params_grad.device(), sums.device());
+            launch_kernel(_cuda_scale_lamb_update,max_jobs(end-begin),
+                    begin, end, s.device(), learning_rate, sums.device());
+        }
+
+    // -----------------------------------------------------------------------------------
+
+        __global__ void _cuda_compute_nesterov_update(
+            size_t begin,
+            size_t end,
+            float* s,
+            float* v,
+            const float learning_rate,
+            const float weight_decay,
+            const float momentum,
+            const float* params,
+            const float* params_grad
+        )
+        {
+            // The loop is equivalent to doing this:
+            //   g = weight_decay*params + params_grad;
+            //   v = momentum*v - learning_rate*g;
+            //   s = momentum*v - learning_rate*g;
+            for (auto i : grid_stride_range(begin, end))
+            {
+                float g = learning_rate*(weight_decay*params[i] + params_grad[i]);
+                v[i] = momentum*v[i] - g;
+                s[i] = momentum*v[i] - g;
+            }
+        }
+
+        void compute_nesterov_update (
+            size_t begin,
+            size_t end,
+            tensor& s,
+            tensor& v,
+            const float learning_rate,
+            const float weight_decay,
+            const float momentum,
+            const tensor& params,
+            const tensor& params_grad
+        )
+        {
+            DLIB_CASSERT(s.size() == v.size() &&
+                         s.size() == params.size() &&
+                         s.size() == params_grad.size());
+            DLIB_CASSERT(begin <= end && end <= params.size());
+
+            launch_kernel(_cuda_compute_nesterov_update,max_jobs(end-begin),
+                    begin, end, s.device(), v.device(), learning_rate, weight_decay,
+                    momentum, params.device(), params_grad.device());
+        }
+
     // -----------------------------------------------------------------------------------
 
         __global__ void _cuda_affine_transform_conv(float* d, const float* s, size_t n, const float* A, const float* B, size_t bs, size_t ks)
@@ -729,6 +729,7 @@ namespace dlib
             stride_x = 0;
             padding_y = 0;
             padding_x = 0;
+            num_groups = 1;
             data_num_samples = 0;
             data_k = 0;
             data_nr = 0;
@@ -758,10 +759,12 @@ namespace dlib
             int stride_y_,
             int stride_x_,
             int padding_y_,
-            int padding_x_
+            int padding_x_,
+            int num_groups_
         ) 
         {
-            DLIB_CASSERT(data.k() == filters.k());
+            DLIB_CASSERT(num_groups_ > 0 && filters.num_samples()%num_groups_ == 0);
+            DLIB_CASSERT(data.k() == filters.k()*num_groups_);
 
             // if the last call to setup gave the same exact settings then don't do
             // anything.
@@ -769,6 +772,7 @@ namespace dlib
                 stride_x_ == stride_x &&
                 padding_y_ == padding_y && 
                 padding_x_ == padding_x &&
+                num_groups_ == num_groups &&
                 data_num_samples == data.num_samples() &&
                 data_k == data.k() &&
                 data_nr == data.nr() &&
@@ -788,6 +792,7 @@ namespace dlib
                 stride_x = stride_x_;
                 padding_y = padding_y_;
                 padding_x = padding_x_;
+                num_groups = num_groups_;
                 data_num_samples = data.num_samples();
                 data_k = data.k();
                 data_nr = data.nr();
@@ -826,6 +831,15 @@ namespace dlib
                         CUDNN_CROSS_CORRELATION)); // could also be CUDNN_CONVOLUTION
 #endif
 
+                if (num_groups != 1)
+                {
+#if CUDNN_MAJOR >= 7
+                    CHECK_CUDNN(cudnnSetConvolutionGroupCount((cudnnConvolutionDescriptor_t)conv_handle, num_groups));
+#else
+                    DLIB_CASSERT(false, "Grouped convolutions require cuDNN 7 or newer.");
+#endif
+                }
+
                 CHECK_CUDNN(cudnnGetConvolution2dForwardOutputDim(
                         (const cudnnConvolutionDescriptor_t)conv_handle,
                         descriptor(data),
@@ -955,7 +969,7 @@ namespace dlib
         {
             DLIB_CASSERT(is_same_object(output,data) == false);
             DLIB_CASSERT(is_same_object(output,filters) == false);
-            DLIB_CASSERT(filters.k() == data.k());
+            DLIB_CASSERT(filters.k()*num_groups == data.k());
             DLIB_CASSERT(stride_y > 0 && stride_x > 0, "You must call setup() before calling this function");
             DLIB_CASSERT(filters.nc() <= data.nc() + 2*padding_x,
                 "Filter windows must be small enough to fit into the padded image."
@@ -161,7 +161,8 @@ namespace dlib
 
     void gpu_data::
     set_size(
-        size_t new_size
+        size_t new_size,
+        bool allocate_host
     )
     {
         if (new_size == 0)
@@ -205,15 +206,18 @@ namespace dlib
                 data_device.reset();
 
                 void* data;
-                CHECK_CUDA(cudaMallocHost(&data, new_size*sizeof(float)));
-                // Note that we don't throw exceptions since the free calls are invariably
-                // called in destructors.  They also shouldn't fail anyway unless someone
-                // is resetting the GPU card in the middle of their program.
-                data_host.reset((float*)data, [](float* ptr){
-                    auto err = cudaFreeHost(ptr);
-                    if(err!=cudaSuccess)
-                        std::cerr << "cudaFreeHost() failed. Reason: " << cudaGetErrorString(err) << std::endl;
-                });
+                if (allocate_host)
+                {
+                    CHECK_CUDA(cudaMallocHost(&data, new_size*sizeof(float)));
+                    // Note that we don't throw exceptions since the free calls are invariably
+                    // called in destructors.  They also shouldn't fail anyway unless someone
+                    // is resetting the GPU card in the middle of their program.
+                    data_host.reset((float*)data, [](float* ptr){
+                        auto err = cudaFreeHost(ptr);
+                        if(err!=cudaSuccess)
+                            std::cerr << "cudaFreeHost() failed. Reason: " << cudaGetErrorString(err) << std::endl;
+                    });
+                }
 
                 CHECK_CUDA(cudaMalloc(&data, new_size*sizeof(float)));
                 data_device.reset((float*)data, [](float* ptr){
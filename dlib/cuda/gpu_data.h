@@ -7,6 +7,7 @@
 #include <memory>
 #include <cstring>
 #include "cuda_errors.h"
+#include "host_memory_pool.h"
 #include "../serialize.h"
 
 namespace dlib
@@ -56,33 +57,30 @@ namespace dlib
 
 #ifdef DLIB_USE_CUDA
         void async_copy_to_device() const; 
-        void set_size(size_t new_size);
 #else
         // Note that calls to host() or device() will block until any async transfers are complete.
         void async_copy_to_device() const{}
+#endif
+
+        void set_size(size_t new_size) { set_size(new_size, true); }
 
-        void set_size(size_t new_size)
+        void set_host_buffer(
+            std::shared_ptr<float> buffer,
+            size_t new_size
+        )
         {
-            if (new_size == 0)
-            {
-                data_size = 0;
-                host_current = true;
-                device_current = true;
-                device_in_use = false;
-                data_host.reset();
-                data_device.reset();
-            }
-            else if (new_size != data_size)
+            DLIB_CASSERT(buffer != nullptr || new_size == 0);
+            // Let set_size() deal with any device memory but not allocate host memory,
+            // since buffer is used in its place.
+            set_size(new_size, false);
+            wait_for_transfer_to_finish();
+            if (new_size != 0)
             {
-                data_size = new_size;
+                data_host = std::move(buffer);
                 host_current = true;
-                device_current = true;
-                device_in_use = false;
-                data_host.reset(new float[new_size], std::default_delete<float[]>());
-                data_device.reset();
+                device_current = false;
             }
         }
-#endif
 
         const float* host() const 
         { 
@@ -163,10 +161,35 @@ namespace dlib
         void copy_to_device() const;
         void copy_to_host() const;
         void wait_for_transfer_to_finish() const;
+        void set_size(size_t new_size, bool allocate_host);
 #else
         void copy_to_device() const{}
         void copy_to_host() const{}
         void wait_for_transfer_to_finish() const{}
+
+        void set_size(size_t new_size, bool allocate_host)
+        {
+            if (new_size == 0)
+            {
+                data_size = 0;
+                host_current = true;
+                device_current = true;
+                device_in_use = false;
+                data_host.reset();
+                data_device.reset();
+            }
+            else if (new_size != data_size)
+            {
+                data_size = new_size;
+                host_current = true;
+                device_current = true;
+                device_in_use = false;
+                data_host.reset();
+                if (allocate_host)
+                    data_host = impl::host_memory_pool::get()->allocate(new_size);
+                data_device.reset();
+            }
+        }
 #endif
 
 
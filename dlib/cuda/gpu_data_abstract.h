@@ -4,6 +4,7 @@
 #ifdef DLIB_GPU_DaTA_ABSTRACT_H_
 
 #include "cuda_errors.h"
+#include "host_memory_pool_abstract.h"
 #include "../serialize.h"
 
 namespace dlib
@@ -83,6 +84,28 @@ namespace dlib
         /*!
             ensures
                 - #size() == new_size
+                - If DLIB_USE_CUDA is not #defined, the host memory comes from the pool
+                  described in host_memory_pool_abstract.h and host() is aligned to 64
+                  bytes.
+        !*/
+
+        void set_host_buffer(
+            std::shared_ptr<float> buffer,
+            size_t new_size
+        );
+        /*!
+            requires
+                - buffer points to at least new_size floats or new_size == 0.
+            ensures
+                - #size() == new_size
+                - if (new_size != 0) then
+                    - This object uses the memory buffer points to as its host memory
+                      rather than allocating its own.  So #host() == buffer.get() and
+                      writes through host() change the contents of buffer.  This object
+                      keeps a copy of buffer until it is resized or destroyed, so you can
+                      use the shared_ptr's deleter to release the memory.
+                    - #host_ready() == true
+                    - #device_ready() == false
         !*/
 
         bool host_ready (
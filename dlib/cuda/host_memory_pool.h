@@ -0,0 +1,273 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_HOST_MEMORY_POOL_H_
+#define DLIB_HOST_MEMORY_POOL_H_
+
+#include "host_memory_pool_abstract.h"
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    struct host_memory_pool_stats
+    {
+        size_t bytes_in_use = 0;
+        size_t peak_bytes_in_use = 0;
+        size_t bytes_cached = 0;
+        size_t num_allocations = 0;
+        size_t num_cache_hits = 0;
+    };
+
+    inline std::ostream& operator<< (
+        std::ostream& out,
+        const host_memory_pool_stats& item
+    )
+    {
+        out << "bytes in use: " << item.bytes_in_use
+            << ", peak bytes in use: " << item.peak_bytes_in_use
+            << ", bytes cached: " << item.bytes_cached
+            << ", allocations: " << item.num_allocations
+            << ", cache hits: " << item.num_cache_hits;
+        return out;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        const size_t host_memory_alignment = 64;
+
+        inline size_t host_memory_size_class (
+            size_t num_bytes
+        )
+        /*!
+            ensures
+                - returns the size of the block used for an allocation of num_bytes.
+                  Small sizes are rounded up to a multiple of host_memory_alignment.
+                  Larger ones are rounded up to the next of 4 evenly spaced sizes in each
+                  power of two interval, so no more than 25% of a block is wasted while
+                  there are still few enough sizes that blocks get reused when tensor
+                  shapes vary a little.
+        !*/
+        {
+            if (num_bytes <= 4*host_memory_alignment)
+                return (num_bytes + host_memory_alignment-1)/host_memory_alignment*host_memory_alignment;
+
+            size_t p = 1;
+            while (p <= (num_bytes-1)/2)
+                p *= 2;
+            const size_t step = p/4;
+            return (num_bytes + step-1)/step*step;
+        }
+
+        class host_memory_pool
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    A cache of 64 byte aligned memory blocks, one free list for each size
+                    class.  Blocks given out by allocate() come back to the free list of
+                    their size class when the last shared_ptr to them goes away, unless
+                    that would put more than max_cached_bytes in the cache.
+            !*/
+        public:
+
+            static std::shared_ptr<host_memory_pool> get (
+            )
+            {
+                // The blocks hold a shared_ptr to the pool, so the pool lives until the
+                // last of them is freed even if that happens during static destruction.
+                static std::shared_ptr<host_memory_pool> pool = std::make_shared<host_memory_pool>();
+                return pool;
+            }
+
+            ~host_memory_pool (
+            )
+            {
+                trim();
+            }
+
+            std::shared_ptr<float> allocate (
+                size_t num_floats
+            )
+            {
+                const size_t block_size = host_memory_size_class(num_floats*sizeof(float));
+                void* block = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    ++stats.num_allocations;
+                    auto i = free_blocks.find(block_size);
+                    if (i != free_blocks.end() && i->second.size() != 0)
+                    {
+                        block = i->second.back();
+                        i->second.pop_back();
+                        stats.bytes_cached -= block_size;
+                        ++stats.num_cache_hits;
+                    }
+                    stats.bytes_in_use += block_size;
+                    stats.peak_bytes_in_use = std::max(stats.peak_bytes_in_use, stats.bytes_in_use);
+                }
+
+                if (!block)
+                {
+                    block = aligned_malloc(block_size);
+                    if (!block)
+                    {
+                        // Give back what's in the cache and try again before giving up.
+                        trim();
+                        block = aligned_malloc(block_size);
+                    }
+                    if (!block)
+                    {
+                        std::lock_guard<std::mutex> lock(m);
+                        stats.bytes_in_use -= block_size;
+                        throw std::bad_alloc();
+                    }
+                }
+
+                auto self = get();
+                return std::shared_ptr<float>(static_cast<float*>(block), [self, block_size](float* ptr)
+                {
+                    self->release(ptr, block_size);
+                });
+            }
+
+            void trim (
+            )
+            {
+                std::unordered_map<size_t, std::vector<void*>> blocks;
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    blocks.swap(free_blocks);
+                    stats.bytes_cached = 0;
+                }
+                for (auto& b : blocks)
+                {
+                    for (auto ptr : b.second)
+                        aligned_free(ptr);
+                }
+            }
+
+            host_memory_pool_stats get_stats (
+            ) const
+            {
+                std::lock_guard<std::mutex> lock(m);
+                return stats;
+            }
+
+            void clear_stats (
+            )
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stats.peak_bytes_in_use = stats.bytes_in_use;
+                stats.num_allocations = 0;
+                stats.num_cache_hits = 0;
+            }
+
+            size_t get_max_cached_bytes (
+            ) const
+            {
+                std::lock_guard<std::mutex> lock(m);
+                return max_cached_bytes;
+            }
+
+            void set_max_cached_bytes (
+                size_t num_bytes
+            )
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    max_cached_bytes = num_bytes;
+                    if (stats.bytes_cached <= max_cached_bytes)
+                        return;
+                }
+                trim();
+            }
+
+        private:
+
+            void release (
+                float* ptr,
+                size_t block_size
+            )
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    stats.bytes_in_use -= block_size;
+                    if (stats.bytes_cached + block_size <= max_cached_bytes)
+                    {
+                        free_blocks[block_size].push_back(ptr);
+                        stats.bytes_cached += block_size;
+                        return;
+                    }
+                }
+                aligned_free(ptr);
+            }
+
+            static void* aligned_malloc (
+                size_t num_bytes
+            )
+            {
+#ifdef _WIN32
+                return _aligned_malloc(num_bytes, host_memory_alignment);
+#else
+                void* ptr = nullptr;
+                if (posix_memalign(&ptr, host_memory_alignment, num_bytes) != 0)
+                    return nullptr;
+                return ptr;
+#endif
+            }
+
+            static void aligned_free (
+                void* ptr
+            )
+            {
+#ifdef _WIN32
+                _aligned_free(ptr);
+#else
+                std::free(ptr);
+#endif
+            }
+
+            mutable std::mutex m;
+            std::unordered_map<size_t, std::vector<void*>> free_blocks;
+            host_memory_pool_stats stats;
+            size_t max_cached_bytes = 64*1024*1024;
+        };
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline host_memory_pool_stats get_host_memory_pool_stats (
+    ) { return impl::host_memory_pool::get()->get_stats(); }
+
+    inline void clear_host_memory_pool_stats (
+    ) { impl::host_memory_pool::get()->clear_stats(); }
+
+    inline void trim_host_memory_pool (
+    ) { impl::host_memory_pool::get()->trim(); }
+
+    inline size_t get_host_memory_pool_max_cached_bytes (
+    ) { return impl::host_memory_pool::get()->get_max_cached_bytes(); }
+
+    inline void set_host_memory_pool_max_cached_bytes (
+        size_t num_bytes
+    ) { impl::host_memory_pool::get()->set_max_cached_bytes(num_bytes); }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_HOST_MEMORY_POOL_H_
+
@@ -0,0 +1,119 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_HOST_MEMORY_POOL_ABSTRACT_H_
+#ifdef DLIB_HOST_MEMORY_POOL_ABSTRACT_H_
+
+#include <iostream>
+
+namespace dlib
+{
+
+    /*!
+        When DLIB_USE_CUDA is not #defined, gpu_data, and therefore every tensor, gets
+        its memory from a pool rather than from new and delete.  Tensors are resized all
+        the time, e.g. when a network is run on images of different sizes or on
+        mini-batches of different sizes, and each time the old memory used to be freed
+        and new memory allocated, which for big tensors means new pages that the
+        operating system has to fault in and zero.  The pool instead keeps freed blocks
+        around and hands them out again.
+
+        Block sizes are rounded up to one of a set of size classes, 4 in each power of
+        two interval, so a block can be reused by a slightly different shape, and every
+        block is aligned to 64 bytes, the size of a cache line.  Freed blocks are kept
+        until get_host_memory_pool_max_cached_bytes() bytes are cached, after which
+        they go back to the operating system.
+
+        The pool is shared by all threads and is thread safe.
+
+        When DLIB_USE_CUDA is #defined host memory is allocated by CUDA as pinned memory
+        and the pool isn't used, so the statistics below stay at 0.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    struct host_memory_pool_stats
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                Statistics about the host memory pool.  Byte counts are in whole blocks,
+                i.e. after rounding allocations up to their size class.
+        !*/
+
+        // The bytes given out and not freed yet, and the largest that has ever been.
+        size_t bytes_in_use = 0;
+        size_t peak_bytes_in_use = 0;
+
+        // The bytes in freed blocks that the pool keeps for reuse.
+        size_t bytes_cached = 0;
+
+        // The number of allocations made and how many of them reused a cached block.
+        size_t num_allocations = 0;
+        size_t num_cache_hits = 0;
+    };
+
+    std::ostream& operator<< (
+        std::ostream& out,
+        const host_memory_pool_stats& item
+    );
+    /*!
+        ensures
+            - prints item to out in a human readable format.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    host_memory_pool_stats get_host_memory_pool_stats (
+    );
+    /*!
+        ensures
+            - returns the current statistics of the host memory pool.
+    !*/
+
+    void clear_host_memory_pool_stats (
+    );
+    /*!
+        ensures
+            - #get_host_memory_pool_stats().num_allocations == 0
+            - #get_host_memory_pool_stats().num_cache_hits == 0
+            - #get_host_memory_pool_stats().peak_bytes_in_use == get_host_memory_pool_stats().bytes_in_use
+    !*/
+
+    void trim_host_memory_pool (
+    );
+    /*!
+        ensures
+            - Gives all the cached blocks back to the operating system.
+            - #get_host_memory_pool_stats().bytes_cached == 0
+    !*/
+
+    size_t get_host_memory_pool_max_cached_bytes (
+    );
+    /*!
+        ensures
+            - returns the largest number of bytes the pool keeps in freed blocks.  Blocks
+              freed while there are already that many cached are given back to the
+              operating system.
+            - The default is 64MB, enough for the activations of a modest network
+              without keeping much memory from the rest of the program.  Training
+              large networks on the CPU may go faster with a bigger cache, see
+              set_host_memory_pool_max_cached_bytes().
+    !*/
+
+    void set_host_memory_pool_max_cached_bytes (
+        size_t num_bytes
+    );
+    /*!
+        ensures
+            - #get_host_memory_pool_max_cached_bytes() == num_bytes
+            - if (more than num_bytes are cached) then
+                - calls trim_host_memory_pool()
+            - Setting this to 0 turns off caching, so every allocation gets new memory
+              from the operating system, as it would without the pool.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_HOST_MEMORY_POOL_ABSTRACT_H_
+
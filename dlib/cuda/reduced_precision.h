@@ -0,0 +1,231 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_REDUCED_PRECISION_H_
+#define DLIB_REDUCED_PRECISION_H_
+
+#include "reduced_precision_abstract.h"
+#include "tensor.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    enum class storage_precision
+    {
+        float32,
+        bfloat16,
+        float16
+    };
+
+    inline std::ostream& operator<< (
+        std::ostream& out,
+        const storage_precision& item
+    )
+    {
+        switch (item)
+        {
+            case storage_precision::float32:  out << "float32"; break;
+            case storage_precision::bfloat16: out << "bfloat16"; break;
+            case storage_precision::float16:  out << "float16"; break;
+        }
+        return out;
+    }
+
+    inline void serialize(const storage_precision& item, std::ostream& out)
+    {
+        serialize(static_cast<int>(item), out);
+    }
+
+    inline void deserialize(storage_precision& item, std::istream& in)
+    {
+        int temp;
+        deserialize(temp, in);
+        if (temp < 0 || temp > 2)
+            throw serialization_error("Invalid value found while deserializing dlib::storage_precision.");
+        item = static_cast<storage_precision>(temp);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline std::uint16_t float_to_bfloat16 (
+        float val
+    )
+    {
+        std::uint32_t x;
+        std::memcpy(&x, &val, sizeof(x));
+        // Keep NaNs NaNs, rather than letting the rounding below turn them into infinity.
+        if ((x & 0x7fffffff) > 0x7f800000)
+            return static_cast<std::uint16_t>((x >> 16) | 0x40);
+        // Round to nearest, ties to even.
+        x += 0x7fff + ((x >> 16) & 1);
+        return static_cast<std::uint16_t>(x >> 16);
+    }
+
+    inline float bfloat16_to_float (
+        std::uint16_t val
+    )
+    {
+        const std::uint32_t x = static_cast<std::uint32_t>(val) << 16;
+        float temp;
+        std::memcpy(&temp, &x, sizeof(temp));
+        return temp;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline std::uint16_t float_to_float16 (
+        float val
+    )
+    {
+        std::uint32_t x;
+        std::memcpy(&x, &val, sizeof(x));
+        const std::uint32_t sign = (x >> 16) & 0x8000;
+        x &= 0x7fffffff;
+
+        // Infinity and NaN
+        if (x >= 0x7f800000)
+            return static_cast<std::uint16_t>(sign | (x > 0x7f800000 ? 0x7e00 : 0x7c00));
+        // Values that round to something bigger than 65504, the largest float16.
+        if (x >= 0x477ff000)
+            return static_cast<std::uint16_t>(sign | 0x7c00);
+        // Values below 2^-14 become subnormal float16 values, which are multiples of
+        // 2^-24.  nearbyint() rounds ties to even.
+        if (x < 0x38800000)
+        {
+            float mag;
+            std::memcpy(&mag, &x, sizeof(mag));
+            return static_cast<std::uint16_t>(sign | static_cast<std::uint32_t>(std::nearbyint(mag*16777216.0f)));
+        }
+        // Normal values.  Round the mantissa to 10 bits, ties to even, and rebias the
+        // exponent.  A carry out of the mantissa correctly bumps up the exponent.
+        x += 0xfff + ((x >> 13) & 1);
+        x -= (127-15) << 23;
+        return static_cast<std::uint16_t>(sign | (x >> 13));
+    }
+
+    inline float float16_to_float (
+        std::uint16_t val
+    )
+    {
+        const std::uint32_t sign = static_cast<std::uint32_t>(val & 0x8000) << 16;
+        const std::uint32_t e = (val >> 10) & 0x1f;
+        const std::uint32_t m = val & 0x3ff;
+        std::uint32_t x;
+        if (e == 0)
+        {
+            // Zero and subnormal values are m*2^-24.
+            const float mag = m/16777216.0f;
+            std::memcpy(&x, &mag, sizeof(x));
+            x |= sign;
+        }
+        else if (e == 31)
+        {
+            x = sign | 0x7f800000 | (m << 13);
+        }
+        else
+        {
+            x = sign | ((e + 127-15) << 23) | (m << 13);
+        }
+        float temp;
+        std::memcpy(&temp, &x, sizeof(temp));
+        return temp;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline void convert_to_reduced_precision (
+        const float* in,
+        std::uint16_t* out,
+        size_t num,
+        storage_precision precision
+    )
+    {
+        DLIB_ASSERT(precision != storage_precision::float32);
+        size_t i = 0;
+        if (precision == storage_precision::bfloat16)
+        {
+            for (; i < num; ++i)
+                out[i] = float_to_bfloat16(in[i]);
+            return;
+        }
+#ifdef __F16C__
+        for (; i + 8 <= num; i += 8)
+        {
+            const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in+i), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out+i), h);
+        }
+#endif
+        for (; i < num; ++i)
+            out[i] = float_to_float16(in[i]);
+    }
+
+    inline void convert_from_reduced_precision (
+        const std::uint16_t* in,
+        float* out,
+        size_t num,
+        storage_precision precision
+    )
+    {
+        DLIB_ASSERT(precision != storage_precision::float32);
+        size_t i = 0;
+        if (precision == storage_precision::bfloat16)
+        {
+            // A plain loop of shifts, which the compiler turns into SIMD instructions.
+            for (; i < num; ++i)
+                out[i] = bfloat16_to_float(in[i]);
+            return;
+        }
+#ifdef __F16C__
+        for (; i + 8 <= num; i += 8)
+        {
+            const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in+i));
+            _mm256_storeu_ps(out+i, _mm256_cvtph_ps(h));
+        }
+#endif
+        for (; i < num; ++i)
+            out[i] = float16_to_float(in[i]);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline float round_to_precision (
+        float val,
+        storage_precision precision
+    )
+    {
+        switch (precision)
+        {
+            case storage_precision::bfloat16: return bfloat16_to_float(float_to_bfloat16(val));
+            case storage_precision::float16:  return float16_to_float(float_to_float16(val));
+            case storage_precision::float32:  break;
+        }
+        return val;
+    }
+
+    inline void round_to_precision (
+        tensor& t,
+        storage_precision precision
+    )
+    {
+        if (precision == storage_precision::float32)
+            return;
+        float* data = t.host();
+        for (size_t i = 0; i < t.size(); ++i)
+            data[i] = round_to_precision(data[i], precision);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_REDUCED_PRECISION_H_
+
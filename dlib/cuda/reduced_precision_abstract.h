@@ -0,0 +1,150 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_REDUCED_PRECISION_ABSTRACT_H_
+#ifdef DLIB_REDUCED_PRECISION_ABSTRACT_H_
+
+#include "tensor_abstract.h"
+#include <cstdint>
+#include <iostream>
+
+namespace dlib
+{
+
+    /*!
+        Tensors always hold 32 bit floats, which is what all the dnn kernels compute
+        with.  But a network's parameters don't need that much precision to be stored,
+        and storing them in 16 bits halves the memory they use and the memory bandwidth
+        needed to read them.  The tools in this file convert between floats and the two
+        common 16 bit formats:
+            - bfloat16: the top 16 bits of a float.  It has the same range as a float
+              but only 8 bits of precision.
+            - float16: the IEEE 754 half precision format.  It has 11 bits of precision
+              but its largest value is 65504 and values below about 6e-8 become 0.
+        Conversions to 16 bits round to the nearest value, with ties going to the even
+        one.  Conversions to float are exact.
+
+        If the compiler is told to target the F16C instructions (e.g. with -mf16c or
+        -march=native) they are used for float16 conversions.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    enum class storage_precision
+    {
+        float32,
+        bfloat16,
+        float16
+    };
+
+    std::ostream& operator<< (
+        std::ostream& out,
+        const storage_precision& item
+    );
+    /*!
+        ensures
+            - prints the name of item to out.
+    !*/
+
+    void serialize(const storage_precision& item, std::ostream& out);
+    void deserialize(storage_precision& item, std::istream& in);
+    /*!
+        provides serialization support
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    std::uint16_t float_to_bfloat16 (
+        float val
+    );
+    /*!
+        ensures
+            - returns val rounded to the nearest bfloat16 value.  NaN values stay NaN.
+    !*/
+
+    float bfloat16_to_float (
+        std::uint16_t val
+    );
+    /*!
+        ensures
+            - returns the bfloat16 value val as a float.
+    !*/
+
+    std::uint16_t float_to_float16 (
+        float val
+    );
+    /*!
+        ensures
+            - returns val rounded to the nearest float16 value.  Values too big for a
+              float16 become infinity and NaN values stay NaN.
+    !*/
+
+    float float16_to_float (
+        std::uint16_t val
+    );
+    /*!
+        ensures
+            - returns the float16 value val as a float.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    void convert_to_reduced_precision (
+        const float* in,
+        std::uint16_t* out,
+        size_t num,
+        storage_precision precision
+    );
+    /*!
+        requires
+            - precision != storage_precision::float32
+            - in and out point to arrays of num elements.
+        ensures
+            - for all valid i:
+                - #out[i] == in[i] converted to the 16 bit format precision.
+    !*/
+
+    void convert_from_reduced_precision (
+        const std::uint16_t* in,
+        float* out,
+        size_t num,
+        storage_precision precision
+    );
+    /*!
+        requires
+            - precision != storage_precision::float32
+            - in and out point to arrays of num elements.
+        ensures
+            - for all valid i:
+                - #out[i] == in[i], a value in the 16 bit format precision, converted to
+                  a float.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    float round_to_precision (
+        float val,
+        storage_precision precision
+    );
+    /*!
+        ensures
+            - returns val after converting it to precision and back to a float.  So if
+              precision == storage_precision::float32 this is just val.
+    !*/
+
+    void round_to_precision (
+        tensor& t,
+        storage_precision precision
+    );
+    /*!
+        ensures
+            - Replaces every value in t with round_to_precision(value, precision).
+            - The rounding is done on the CPU, so if t lives on a GPU it's copied to the
+              host and back.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_REDUCED_PRECISION_ABSTRACT_H_
+
@@ -395,6 +395,25 @@ namespace dlib
         }
 
 
+        void set_host_buffer(
+            std::shared_ptr<float> buffer,
+            long long n_, long long k_ = 1, long long nr_ = 1, long long nc_ = 1
+        )
+        {
+            DLIB_ASSERT( n_ >= 0 && k_ >= 0 && nr_ >= 0 && nc_ >= 0);
+
+            // Not set_size() since that would allocate memory just for buffer to replace.
+            m_n = n_;
+            m_k = k_;
+            m_nr = nr_;
+            m_nc = nc_;
+            m_size = n_*k_*nr_*nc_;
+            data_instance.set_host_buffer(std::move(buffer), m_size);
+#ifdef DLIB_USE_CUDA
+            cudnn_descriptor.set_size(m_n,m_k,m_nr,m_nc);
+#endif
+        }
+
         resizable_tensor& operator= (const resizable_tensor& item) 
         {
             resizable_tensor temp(item);
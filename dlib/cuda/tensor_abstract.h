@@ -542,6 +542,32 @@ namespace dlib
                   (i.e. capacity() never goes down when calling set_size().)
         !*/
 
+        void set_host_buffer(
+            std::shared_ptr<float> buffer,
+            long long n_, long long k_ = 1, long long nr_ = 1, long long nc_ = 1
+        );
+        /*!
+            requires
+                - n_ >= 0
+                - k_ >= 0
+                - nr_ >= 0
+                - nc_ >= 0
+                - buffer points to at least n_*k_*nr_*nc_ floats.
+            ensures
+                - #size() == n_*k_*nr_*nc_
+                - #num_samples() == n_
+                - #k() == k_
+                - #nr() == nr_
+                - #nc() == nc_
+                - #capacity() == #size()
+                - This tensor holds its values in the memory buffer points to instead of
+                  memory of its own, so there is no copying and any changes made to the
+                  tensor are made to buffer.  This is how you can use memory you don't
+                  own, e.g. a memory mapped file, as a tensor.  A copy of buffer is kept
+                  until the tensor is resized to more than capacity() values, cleared or
+                  destroyed.  Copies of this tensor allocate their own memory as usual.
+        !*/
+
         template <typename EXP>
         resizable_tensor& operator= (
             const matrix_exp<EXP>& item
@@ -17,6 +17,13 @@ namespace dlib
             static std::atomic<bool> var(true);
             return var;
         }
+
+        std::atomic<cpu_conv_algorithm>& dnn_cpu_conv_algo (
+        )
+        {
+            static std::atomic<cpu_conv_algorithm> var(cpu_conv_algorithm::automatic);
+            return var;
+        }
     }
 
     bool dnn_prefer_fastest_algorithms (
@@ -36,6 +43,19 @@ namespace dlib
     {
         dnn_prefer_fastest_algo() = false;
     }
+
+    cpu_conv_algorithm dnn_cpu_conv_algorithm (
+    )
+    {
+        return dnn_cpu_conv_algo();
+    }
+
+    void set_dnn_cpu_conv_algorithm(
+        cpu_conv_algorithm algo
+    )
+    {
+        dnn_cpu_conv_algo() = algo;
+    }
 }
 
 namespace dlib { namespace tt
@@ -215,28 +235,7 @@ namespace dlib { namespace tt
 #ifdef DLIB_USE_CUDA
         cuda::gemm(beta, dest, alpha, lhs, trans_lhs, rhs, trans_rhs);
 #else
-        if (beta != 0)
-        {
-            if (trans_lhs && trans_rhs)
-                dest = alpha*trans(mat(lhs))*trans(mat(rhs)) + beta*mat(dest);
-            else if (!trans_lhs && trans_rhs)
-                dest = alpha*mat(lhs)*trans(mat(rhs)) + beta*mat(dest);
-            else if (trans_lhs && !trans_rhs)
-                dest = alpha*trans(mat(lhs))*mat(rhs) + beta*mat(dest);
-            else
-                dest = alpha*mat(lhs)*mat(rhs) + beta*mat(dest);
-        }
-        else
-        {
-            if (trans_lhs && trans_rhs)
-                dest = alpha*trans(mat(lhs))*trans(mat(rhs));
-            else if (!trans_lhs && trans_rhs)
-                dest = alpha*mat(lhs)*trans(mat(rhs));
-            else if (trans_lhs && !trans_rhs)
-                dest = alpha*trans(mat(lhs))*mat(rhs);
-            else
-                dest = alpha*mat(lhs)*mat(rhs);
-        }
+        cpu::gemm(beta, dest, alpha, lhs, trans_lhs, rhs, trans_rhs);
 #endif
     }
 
@@ -539,6 +538,82 @@ namespace dlib { namespace tt
 #endif
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void compute_adamw_update (
+        size_t begin,
+        size_t end,
+        tensor& s,
+        tensor& m,
+        tensor& v,
+        const float t,
+        const float learning_rate,
+        const float weight_decay,
+        const float momentum1,
+        const float momentum2,
+        const tensor& params,
+        const tensor& params_grad
+    )
+    {
+#ifdef DLIB_USE_CUDA
+        cuda::compute_adamw_update(begin, end, s, m, v, t, learning_rate, weight_decay, momentum1,
+            momentum2, params, params_grad);
+#else
+        cpu::compute_adamw_update(begin, end, s, m, v, t, learning_rate, weight_decay, momentum1,
+            momentum2, params, params_grad);
+#endif
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void compute_lamb_update (
+        size_t begin,
+        size_t end,
+        tensor& s,
+        tensor& m,
+        tensor& v,
+        const float t,
+        const float learning_rate,
+        const float weight_decay,
+        const float momentum1,
+        const float momentum2,
+        const tensor& params,
+        const tensor& params_grad,
+        resizable_tensor& sums
+    )
+    {
+#ifdef DLIB_USE_CUDA
+        cuda::compute_lamb_update(begin, end, s, m, v, t, learning_rate, weight_decay, momentum1,
+            momentum2, params, params_grad, sums);
+#else
+        cpu::compute_lamb_update(begin, end, s, m, v, t, learning_rate, weight_decay, momentum1,
+            momentum2, params, params_grad, sums);
+#endif
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void compute_nesterov_update (
+        size_t begin,
+        size_t end,
+        tensor& s,
+        tensor& v,
+        const float learning_rate,
+        const float weight_decay,
+        const float momentum,
+        const tensor& params,
+        const tensor& params_grad
+    )
+    {
+#ifdef DLIB_USE_CUDA
+        cuda::compute_nesterov_update(begin, end, s, v, learning_rate, weight_decay, momentum,
+            params, params_grad);
+#else
+        cpu::compute_nesterov_update(begin, end, s, v, learning_rate, weight_decay, momentum,
+            params, params_grad);
+#endif
+    }
+
 // ----------------------------------------------------------------------------------------
 
     void batch_normalize_inference (
@@ -20,6 +20,19 @@ namespace dlib
     bool dnn_prefer_fastest_algorithms();
     void set_dnn_prefer_fastest_algorithms();
     void set_dnn_prefer_smallest_algorithms();
+
+    enum class cpu_conv_algorithm
+    {
+        automatic,
+        img2col,
+        direct,
+        winograd
+    };
+    cpu_conv_algorithm dnn_cpu_conv_algorithm();
+    void set_dnn_cpu_conv_algorithm(cpu_conv_algorithm algo);
+
+    size_t dnn_cpu_num_threads();
+    void set_dnn_cpu_num_threads(size_t num_threads);
 }
 
 namespace dlib { namespace tt
@@ -599,6 +612,126 @@ namespace dlib { namespace tt
               set begin to 0 and end to params.size().
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    void compute_adamw_update (
+        size_t begin,
+        size_t end,
+        tensor& s,
+        tensor& m,
+        tensor& v,
+        const float t,
+        const float learning_rate,
+        const float weight_decay,
+        const float momentum1,
+        const float momentum2,
+        const tensor& params,
+        const tensor& params_grad
+    );
+    /*!
+        requires
+            - s.size() == m.size() = v.size() == params.size() == params_grad.size()
+            - t > 0
+            - learning_rate > 0
+            - weight_decay >= 0
+            - 0 <= momentum1 < 1
+            - 0 <= momentum2 < 1
+            - begin <= end <= params.size()
+        ensures
+            - This function implements the AdamW parameter update method described in
+              the paper:
+                Loshchilov, Ilya, and Frank Hutter. "Decoupled weight decay
+                regularization." International Conference on Learning Representations.
+                2019.
+              That is, it's compute_adam_update() except the weight decay isn't added to
+              the gradient but subtracted from the parameters directly, as
+              learning_rate*weight_decay*params.
+            - #s is the update vector that should be added to the parameters.
+            - The function only operates in the half open range [begin,end) of the memory
+              blocks of each tensor.  E.g. to make this function run on the entire tensor
+              set begin to 0 and end to params.size().
+            - The update is computed in a single pass over the tensors.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    void compute_lamb_update (
+        size_t begin,
+        size_t end,
+        tensor& s,
+        tensor& m,
+        tensor& v,
+        const float t,
+        const float learning_rate,
+        const float weight_decay,
+        const float momentum1,
+        const float momentum2,
+        const tensor& params,
+        const tensor& params_grad,
+        resizable_tensor& sums
+    );
+    /*!
+        requires
+            - s.size() == m.size() = v.size() == params.size() == params_grad.size()
+            - t > 0
+            - learning_rate > 0
+            - weight_decay >= 0
+            - 0 <= momentum1 < 1
+            - 0 <= momentum2 < 1
+            - begin <= end <= params.size()
+        ensures
+            - This function implements the LAMB parameter update method described in the
+              paper:
+                You, Yang, et al. "Large batch optimization for deep learning: Training
+                BERT in 76 minutes." International Conference on Learning
+                Representations. 2020.
+              That is, it computes the bias corrected Adam direction r plus
+              weight_decay*params, and then scales it so the step's length is
+              learning_rate times the length of the parameters: 
+                #s == -learning_rate*(length(params)/length(r))*r
+              where the lengths are over the range [begin,end).  If either length is 0
+              the ratio is taken to be 1.
+            - #s is the update vector that should be added to the parameters.
+            - The function only operates in the half open range [begin,end) of the memory
+              blocks of each tensor.  E.g. to make this function run on the entire tensor
+              set begin to 0 and end to params.size().
+            - #sums.size() == 2, and #sums holds the squares of length(params) and
+              length(r).  sums is only scratch memory, so pass the same tensor each
+              time to avoid allocating it on every call.
+            - The update is computed in a single pass over the tensors, followed by a
+              pass over s to scale it.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    void compute_nesterov_update (
+        size_t begin,
+        size_t end,
+        tensor& s,
+        tensor& v,
+        const float learning_rate,
+        const float weight_decay,
+        const float momentum,
+        const tensor& params,
+        const tensor& params_grad
+    );
+    /*!
+        requires
+            - s.size() == v.size() == params.size() == params_grad.size()
+            - begin <= end <= params.size()
+        ensures
+            - This function implements stochastic gradient descent with Nesterov momentum,
+              in the form used by most deep learning tools.  Letting
+              g = learning_rate*(weight_decay*params + params_grad), it does:
+                - #v == momentum*v - g
+                - #s == momentum*#v - g
+            - #s is the update vector that should be added to the parameters.
+            - The function only operates in the half open range [begin,end) of the memory
+              blocks of each tensor.  E.g. to make this function run on the entire tensor
+              set begin to 0 and end to params.size().
+            - The update is computed in a single pass over the tensors.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     void batch_normalize_inference (
@@ -942,10 +1075,10 @@ namespace dlib { namespace tt
         /*!
             requires
                 - setup() has been called.  Specifically, setup() has been called like this:
-                    this->setup(data, filters, stride_y, stride_x, padding_y, padding_x);
+                    this->setup(data, filters, stride_y, stride_x, padding_y, padding_x, num_groups);
                 - is_same_object(output,data) == false
                 - is_same_object(output,filters) == false
-                - filters.k() == data.k()
+                - filters.k()*num_groups == data.k()
                 - filters.nr() <= src.nr() + 2*padding_y
                 - filters.nc() <= src.nc() + 2*padding_x
                 - #output.num_samples() == data.num_samples()
@@ -968,10 +1101,10 @@ namespace dlib { namespace tt
         /*!
             requires
                 - setup() has been called.  Specifically, setup() has been called like this:
-                    this->setup(data, filters, stride_y, stride_x, padding_y, padding_x);
+                    this->setup(data, filters, stride_y, stride_x, padding_y, padding_x, num_groups);
                 - is_same_object(output,data) == false
                 - is_same_object(output,filters) == false
-                - filters.k() == data.k()
+                - filters.k()*num_groups == data.k()
                 - filters.nr() <= src.nr() + 2*padding_y
                 - filters.nc() <= src.nc() + 2*padding_x
             ensures
@@ -998,7 +1131,7 @@ namespace dlib { namespace tt
                       last call to operator().  Also, data_gradient has the same dimensions
                       as the data object given to the last call to operator().
                     - setup() has been called.  Specifically, setup() has been called like this:
-                      this->setup(data_gradient, filters, stride_y, stride_x, padding_y, padding_x);
+                      this->setup(data_gradient, filters, stride_y, stride_x, padding_y, padding_x, num_groups);
                 - gradient_input has the following dimensions:
                     - gradient_input.num_samples() == data_gradient.num_samples()
                     - gradient_input.k() == filters.num_samples()
@@ -1033,7 +1166,7 @@ namespace dlib { namespace tt
                       to the last call to operator().  Also, data has the same dimensions
                       as the data object given to the last call to operator().
                     - setup() has been called.  Specifically, setup() has been called like this:
-                      this->setup(data, filters_gradient, stride_y, stride_x, padding_y, padding_x);
+                      this->setup(data, filters_gradient, stride_y, stride_x, padding_y, padding_x, num_groups);
                 - gradient_input has the following dimensions:
                     - gradient_input.num_samples() == data.num_samples()
                     - gradient_input.k() == filters.num_samples()
@@ -1062,11 +1195,14 @@ namespace dlib { namespace tt
             int stride_y,
             int stride_x,
             int padding_y,
-            int padding_x
-        ) {impl.setup(data,filters,stride_y,stride_x,padding_y,padding_x); }
+            int padding_x,
+            int num_groups = 1
+        ) {impl.setup(data,filters,stride_y,stride_x,padding_y,padding_x,num_groups); }
         /*!
             requires
-                - filters.k() == data.k()
+                - num_groups > 0
+                - filters.k()*num_groups == data.k()
+                - filters.num_samples()%num_groups == 0
                 - stride_y > 0
                 - stride_x > 0
                 - 0 <= padding_y < filters.nr()
@@ -1077,6 +1213,13 @@ namespace dlib { namespace tt
                     - output.nc() == 1+(data.nc() + 2*padding_x - filters.nc())/stride_x
                     - output.num_samples() == data.num_samples()
                     - output.k() == filters.num_samples()
+                - If num_groups > 1 then this is a grouped convolution.  That is, the
+                  channels of data and the filters are both split into num_groups
+                  consecutive groups, and the filters in group g only look at the channels
+                  of data in group g.  So each filter has data.k()/num_groups channels and
+                  output channel i comes from the filter i, which is in the group
+                  i/(filters.num_samples()/num_groups).  When num_groups == data.k() this
+                  is a depthwise convolution.
                 - The point of setup() is to allow this object to gather information about
                   all the tensor sizes and filter layouts involved in the computation.  In
                   particular, the reason the tensors are input into setup() is just to
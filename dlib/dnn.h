@@ -31,6 +31,13 @@
 #include "cuda/tensor_tools.h"
 #include "dnn/utilities.h"
 #include "dnn/validation.h"
+#include "dnn/inference.h"
+#include "dnn/onnx.h"
+#include "dnn/quantization.h"
+#include "dnn/batching.h"
+#include "dnn/mapped_network.h"
+#include "dnn/profiler.h"
+#include "dnn/tiled_detection.h"
 
 #endif // DLIB_DNn_
 
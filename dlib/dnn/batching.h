@@ -0,0 +1,309 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNn_BATCHING_H_
+#define DLIB_DNn_BATCHING_H_
+
+#include "batching_abstract.h"
+#include "inference.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    struct inference_batcher_stats
+    {
+        size_t num_requests = 0;
+        size_t num_batches = 0;
+        double latency_p50 = 0;
+        double latency_p99 = 0;
+        double latency_max = 0;
+        std::vector<size_t> batch_size_histogram;
+
+        double mean_batch_size (
+        ) const { return num_batches == 0 ? 0 : num_requests/(double)num_batches; }
+    };
+
+    inline std::ostream& operator<< (
+        std::ostream& out,
+        const inference_batcher_stats& item
+    )
+    {
+        out << "requests: " << item.num_requests << ", batches: " << item.num_batches
+            << ", mean batch size: " << item.mean_batch_size() << "\n";
+        out << "latency p50: " << item.latency_p50*1000 << " ms, p99: " << item.latency_p99*1000
+            << " ms, max: " << item.latency_max*1000 << " ms\n";
+        out << "batch size histogram:\n";
+        for (size_t i = 1; i < item.batch_size_histogram.size(); ++i)
+        {
+            if (item.batch_size_histogram[i] != 0)
+                out << std::setw(6) << i << ": " << item.batch_size_histogram[i] << "\n";
+        }
+        return out;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    class inference_batcher
+    {
+    public:
+
+        typedef typename net_type::input_type input_type;
+        typedef typename net_type::output_label_type output_label_type;
+
+        explicit inference_batcher (
+            const net_type& net,
+            size_t max_batch_size_ = 32,
+            std::chrono::microseconds max_wait_ = std::chrono::milliseconds(5),
+            size_t num_workers = 1,
+            size_t latency_window_ = 10000
+        ) :
+            snet(net),
+            max_batch_size(max_batch_size_),
+            max_wait(max_wait_),
+            latency_window(latency_window_),
+            histogram(max_batch_size_+1, 0)
+        {
+            DLIB_CASSERT(max_batch_size_ > 0);
+            DLIB_CASSERT(max_wait_.count() >= 0);
+            DLIB_CASSERT(num_workers > 0);
+            DLIB_CASSERT(latency_window_ > 0);
+
+            for (size_t i = 0; i < num_workers; ++i)
+                workers.emplace_back([this]() { work(); });
+        }
+
+        inference_batcher(const inference_batcher&) = delete;
+        inference_batcher& operator=(const inference_batcher&) = delete;
+
+        ~inference_batcher (
+        )
+        {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stopping = true;
+            }
+            new_request.notify_all();
+            for (auto& t : workers)
+                t.join();
+        }
+
+        std::future<output_label_type> submit (
+            input_type x
+        )
+        {
+            request r;
+            r.x = std::move(x);
+            r.arrival = clock::now();
+            auto result = r.label.get_future();
+            {
+                std::lock_guard<std::mutex> lock(m);
+                queue.push_back(std::move(r));
+            }
+            new_request.notify_one();
+            return result;
+        }
+
+        output_label_type operator() (
+            input_type x
+        )
+        {
+            return submit(std::move(x)).get();
+        }
+
+        size_t get_max_batch_size (
+        ) const { return max_batch_size; }
+
+        std::chrono::microseconds get_max_wait (
+        ) const { return max_wait; }
+
+        size_t num_workers (
+        ) const { return workers.size(); }
+
+        size_t num_pending (
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            return queue.size();
+        }
+
+        inference_batcher_stats get_stats (
+        ) const
+        {
+            std::vector<float> temp;
+            inference_batcher_stats stats;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stats.num_requests = num_requests;
+                stats.num_batches = num_batches;
+                stats.batch_size_histogram = histogram;
+                temp = latencies;
+            }
+            if (temp.size() != 0)
+            {
+                stats.latency_p50 = percentile(temp, 0.50);
+                stats.latency_p99 = percentile(temp, 0.99);
+                stats.latency_max = *std::max_element(temp.begin(), temp.end());
+            }
+            return stats;
+        }
+
+        void clear_stats (
+        )
+        {
+            std::lock_guard<std::mutex> lock(m);
+            num_requests = 0;
+            num_batches = 0;
+            std::fill(histogram.begin(), histogram.end(), 0);
+            latencies.clear();
+            next_latency = 0;
+        }
+
+    private:
+
+        typedef std::chrono::steady_clock clock;
+
+        struct request
+        {
+            input_type x;
+            std::promise<output_label_type> label;
+            clock::time_point arrival;
+        };
+
+        static double percentile (
+            std::vector<float>& v,
+            double p
+        )
+        {
+            auto i = v.begin() + std::min<size_t>(v.size()-1, p*v.size());
+            std::nth_element(v.begin(), i, v.end());
+            return *i;
+        }
+
+        void work (
+        )
+        {
+            std::vector<request> batch;
+            std::vector<input_type> inputs;
+            while (true)
+            {
+                batch.clear();
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    new_request.wait(lock, [&]{ return stopping || !queue.empty(); });
+                    if (queue.empty())
+                        return;
+
+                    // Hold the oldest request back until either a full batch has
+                    // arrived or it has waited max_wait, whichever comes first.  When
+                    // stopping we don't wait, we just drain what's left.
+                    const auto deadline = queue.front().arrival + max_wait;
+                    new_request.wait_until(lock, deadline, [&]{ return stopping || queue.size() >= max_batch_size; });
+
+                    // Another worker may have taken the requests while we waited.
+                    const size_t num = std::min(max_batch_size, queue.size());
+                    for (size_t i = 0; i < num; ++i)
+                    {
+                        batch.push_back(std::move(queue.front()));
+                        queue.pop_front();
+                    }
+                    // submit() only wakes one worker per request, so if requests are
+                    // left over make sure another worker goes after them.
+                    if (!queue.empty())
+                        new_request.notify_one();
+                }
+                if (batch.size() == 0)
+                    continue;
+
+                inputs.clear();
+                for (auto& r : batch)
+                    inputs.push_back(std::move(r.x));
+
+                std::vector<output_label_type> labels;
+                std::exception_ptr eptr;
+                try
+                {
+                    labels = snet(inputs, inputs.size());
+                }
+                catch (...)
+                {
+                    eptr = std::current_exception();
+                }
+
+                // Update the counters before handing out the results, so that a caller
+                // who has its result also sees its request in get_stats().
+                record(batch);
+
+                for (size_t i = 0; i < batch.size(); ++i)
+                {
+                    if (eptr)
+                        batch[i].label.set_exception(eptr);
+                    else
+                        batch[i].label.set_value(std::move(labels[i]));
+                }
+            }
+        }
+
+        void record (
+            const std::vector<request>& batch
+        )
+        {
+            const auto now = clock::now();
+            std::lock_guard<std::mutex> lock(m);
+            num_requests += batch.size();
+            ++num_batches;
+            ++histogram[batch.size()];
+            for (auto& r : batch)
+            {
+                const float secs = std::chrono::duration<float>(now - r.arrival).count();
+                if (latencies.size() < latency_window)
+                {
+                    latencies.push_back(secs);
+                }
+                else
+                {
+                    latencies[next_latency] = secs;
+                    next_latency = (next_latency+1)%latency_window;
+                }
+            }
+        }
+
+        const shared_inference_net<net_type> snet;
+        const size_t max_batch_size;
+        const std::chrono::microseconds max_wait;
+        const size_t latency_window;
+
+        mutable std::mutex m;
+        std::condition_variable new_request;
+        std::deque<request> queue;
+        bool stopping = false;
+
+        size_t num_requests = 0;
+        size_t num_batches = 0;
+        std::vector<size_t> histogram;
+        std::vector<float> latencies;
+        size_t next_latency = 0;
+
+        // Declared last so the workers start after everything they use is constructed.
+        std::vector<std::thread> workers;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_BATCHING_H_
+
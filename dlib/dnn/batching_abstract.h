@@ -0,0 +1,209 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DNn_BATCHING_ABSTRACT_H_
+#ifdef DLIB_DNn_BATCHING_ABSTRACT_H_
+
+#include "inference_abstract.h"
+#include <chrono>
+#include <future>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    struct inference_batcher_stats
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object is a snapshot of the counters kept by an inference_batcher.
+                Latencies are in seconds and measure the time from when a request was
+                submitted until its result was ready, so they include the time spent
+                waiting for a batch to fill up.
+        !*/
+
+        size_t num_requests = 0;
+        size_t num_batches = 0;
+
+        // Percentiles over the most recent requests, see inference_batcher's
+        // latency_window.
+        double latency_p50 = 0;
+        double latency_p99 = 0;
+        double latency_max = 0;
+
+        // batch_size_histogram[i] == the number of batches that held i requests.
+        std::vector<size_t> batch_size_histogram;
+
+        double mean_batch_size (
+        ) const;
+        /*!
+            ensures
+                - returns num_requests/num_batches, or 0 if num_batches == 0.
+        !*/
+    };
+
+    std::ostream& operator<< (
+        std::ostream& out,
+        const inference_batcher_stats& item
+    );
+    /*!
+        ensures
+            - prints item to out in a human readable form.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    class inference_batcher
+    {
+        /*!
+            REQUIREMENTS ON net_type
+                - net_type meets the requirements of shared_inference_net.  In
+                  particular this rules out loss_mmod_, so detectors such as the dlib
+                  face detector can't be served by this object.
+                - net_type::input_type is movable.
+                - Any mix of inputs that can be submitted at the same time can be
+                  converted into one tensor by the network's input layer.  For the
+                  image input layers this means all the images must be the same size.
+                  If a batch can't be converted, every request in it gets the exception.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object runs a network on requests that arrive one at a time from
+                many threads, e.g. the threads of a server_http, by grouping them into
+                mini-batches.  Running one forward pass over a batch is much cheaper
+                than running one per request, so this raises throughput at the cost of
+                some latency.
+
+                Requests are put in a queue.  Worker threads take up to
+                get_max_batch_size() requests from the queue at a time and run them
+                through the network with a shared_inference_net.  A worker starts a
+                batch as soon as the queue holds get_max_batch_size() requests or the
+                oldest request has waited get_max_wait(), whichever comes first.  So
+                under light load requests go through alone after at most get_max_wait()
+                and under heavy load the batches fill up.
+
+                The object also counts requests and batches, and keeps the latencies of
+                the most recent requests so you can monitor it with get_stats().
+
+            THREAD SAFETY
+                It is safe to call submit(), operator(), num_pending(), get_stats() and
+                clear_stats() from any number of threads at the same time.
+        !*/
+
+    public:
+
+        typedef typename net_type::input_type input_type;
+        typedef typename net_type::output_label_type output_label_type;
+
+        explicit inference_batcher (
+            const net_type& net,
+            size_t max_batch_size = 32,
+            std::chrono::microseconds max_wait = std::chrono::milliseconds(5),
+            size_t num_workers = 1,
+            size_t latency_window = 10000
+        );
+        /*!
+            requires
+                - net has been run forward at least once, so all its layers are allocated.
+                - max_batch_size > 0
+                - max_wait.count() >= 0
+                - num_workers > 0
+                - latency_window > 0
+            ensures
+                - #get_max_batch_size() == max_batch_size
+                - #get_max_wait() == max_wait
+                - #num_workers() == num_workers
+                - get_stats() will report latency percentiles over the last
+                  latency_window requests.
+                - This object computes the same thing as net.  net isn't referenced after
+                  the constructor returns.
+            throws
+                - dlib::error if net contains a layer that inference_net doesn't support.
+        !*/
+
+        ~inference_batcher (
+        );
+        /*!
+            ensures
+                - Finishes all the pending requests and then stops the worker threads.
+        !*/
+
+        inference_batcher(const inference_batcher&) = delete;
+        inference_batcher& operator=(const inference_batcher&) = delete;
+
+        std::future<output_label_type> submit (
+            input_type x
+        );
+        /*!
+            ensures
+                - Queues x to be run through the network and returns a future that will
+                  hold its output label, the same label net(x) would give for the net
+                  this object was made from.  If running the network throws, the
+                  exception is stored in the future instead.
+        !*/
+
+        output_label_type operator() (
+            input_type x
+        );
+        /*!
+            ensures
+                - returns submit(x).get().  That is, it blocks until x has gone through
+                  the network as part of some batch and then returns its label.
+        !*/
+
+        size_t get_max_batch_size (
+        ) const;
+        /*!
+            ensures
+                - returns the largest number of requests run through the network at once.
+        !*/
+
+        std::chrono::microseconds get_max_wait (
+        ) const;
+        /*!
+            ensures
+                - returns how long a request may wait for others to join its batch.
+        !*/
+
+        size_t num_workers (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads running batches.  Each batch is run by a
+                  single worker, which splits the work over the threads selected by
+                  set_dnn_cpu_num_threads().
+        !*/
+
+        size_t num_pending (
+        ) const;
+        /*!
+            ensures
+                - returns the number of requests waiting to be put in a batch.
+        !*/
+
+        inference_batcher_stats get_stats (
+        ) const;
+        /*!
+            ensures
+                - returns the counters for the requests finished since this object was
+                  created or clear_stats() was last called.
+                - #get_stats().batch_size_histogram.size() == get_max_batch_size()+1
+        !*/
+
+        void clear_stats (
+        );
+        /*!
+            ensures
+                - resets all the counters to 0.
+        !*/
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_BATCHING_ABSTRACT_H_
+
@@ -19,6 +19,10 @@
 #include "../cuda/tensor_tools.h"
 #include <type_traits>
 #include "../metaprogramming.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 #ifdef _MSC_VER
 // Tell Visual Studio not to recursively inline functions very much because otherwise it
@@ -31,6 +35,202 @@
 namespace dlib
 {
 
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        enum class layer_profile_event
+        {
+            forward,
+            backward,
+            update
+        };
+
+        class layer_profiler_hook
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This is the interface dnn_profiler uses to find out where the time goes
+                    in a network.  While a hook is installed in active_layer_profiler_hook(),
+                    every add_layer and add_loss_layer reports the time it spends on its own
+                    computations, not counting the time spent in the layers below it.
+
+                    A layer grabs the hook when it starts a computation and calls record()
+                    when it's done, so the hook counts how many computations are in flight.
+                    uninstall_layer_profiler_hook() waits for them to finish, after which
+                    record() won't be called again and the hook can be destroyed.
+            !*/
+        public:
+            virtual ~layer_profiler_hook() = default;
+
+            virtual void record (
+                const void* layer,
+                layer_profile_event event,
+                std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point stop,
+                const tensor* input,
+                const tensor* output
+            ) = 0;
+
+            void begin_computation (
+            )
+            {
+                std::lock_guard<std::mutex> lock(in_flight_mutex);
+                ++in_flight;
+            }
+
+            void end_computation (
+            )
+            {
+                std::lock_guard<std::mutex> lock(in_flight_mutex);
+                if (--in_flight == 0)
+                    in_flight_done.notify_all();
+            }
+
+            void wait_for_computations (
+            )
+            {
+                std::unique_lock<std::mutex> lock(in_flight_mutex);
+                in_flight_done.wait(lock, [this]() { return in_flight == 0; });
+            }
+
+        private:
+            std::mutex in_flight_mutex;
+            std::condition_variable in_flight_done;
+            long in_flight = 0;
+        };
+
+        inline std::atomic<layer_profiler_hook*>& active_layer_profiler_hook (
+        )
+        {
+            static std::atomic<layer_profiler_hook*> hook(nullptr);
+            return hook;
+        }
+
+        inline std::mutex& layer_profiler_hook_mutex (
+        )
+        {
+            // Held while installing or uninstalling a hook and while a layer grabs the
+            // active one, so a layer can't grab a hook that's being uninstalled.
+            static std::mutex m;
+            return m;
+        }
+
+        inline bool install_layer_profiler_hook (
+            layer_profiler_hook* hook
+        )
+        /*!
+            ensures
+                - Makes hook the active hook if there isn't one.  Returns false if some
+                  other hook is active.
+        !*/
+        {
+            std::lock_guard<std::mutex> lock(layer_profiler_hook_mutex());
+            layer_profiler_hook* expected = nullptr;
+            return active_layer_profiler_hook().compare_exchange_strong(expected, hook) || expected == hook;
+        }
+
+        inline void uninstall_layer_profiler_hook (
+            layer_profiler_hook* hook
+        )
+        /*!
+            ensures
+                - If hook is the active hook then it isn't anymore.
+                - Waits until every computation that grabbed hook has called record().
+        !*/
+        {
+            {
+                std::lock_guard<std::mutex> lock(layer_profiler_hook_mutex());
+                layer_profiler_hook* expected = hook;
+                active_layer_profiler_hook().compare_exchange_strong(expected, nullptr);
+            }
+            hook->wait_for_computations();
+        }
+
+        inline layer_profiler_hook* begin_layer_profiler_computation (
+        )
+        /*!
+            ensures
+                - If a hook is active then calls begin_computation() on it and returns it.
+                  The caller must call end_computation() on it when done.
+                - Otherwise returns nullptr.
+        !*/
+        {
+            // Don't take the mutex unless a profiler is running.
+            if (active_layer_profiler_hook().load(std::memory_order_acquire) == nullptr)
+                return nullptr;
+            std::lock_guard<std::mutex> lock(layer_profiler_hook_mutex());
+            layer_profiler_hook* hook = active_layer_profiler_hook().load();
+            if (hook)
+                hook->begin_computation();
+            return hook;
+        }
+
+        class layer_profile_timer
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    Times one computation of a layer and reports it to the active
+                    layer_profiler_hook.  When no hook is installed this costs a single
+                    atomic load.
+            !*/
+        public:
+            layer_profile_timer (
+                const void* layer_,
+                layer_profile_event event_
+            ) : hook(begin_layer_profiler_computation()), layer(layer_), event(event_)
+            {
+                if (hook)
+                {
+                    synchronize();
+                    start = std::chrono::steady_clock::now();
+                }
+            }
+
+            layer_profile_timer(const layer_profile_timer&) = delete;
+            layer_profile_timer& operator=(const layer_profile_timer&) = delete;
+
+            ~layer_profile_timer (
+            )
+            {
+                // If the layer threw we never got to stop(), but the hook still needs to
+                // know we are done with it.
+                if (hook)
+                    hook->end_computation();
+            }
+
+            void stop (
+                const tensor* input = nullptr,
+                const tensor* output = nullptr
+            )
+            {
+                if (hook)
+                {
+                    synchronize();
+                    hook->record(layer, event, start, std::chrono::steady_clock::now(), input, output);
+                    hook->end_computation();
+                    hook = nullptr;
+                }
+            }
+
+        private:
+            static void synchronize (
+            )
+            {
+#ifdef DLIB_USE_CUDA
+                // CUDA kernels run asynchronously, so wait for them to finish or their time
+                // would be charged to whichever layer happens to block next.
+                cuda::device_synchronize(cuda::get_device());
+#endif
+            }
+
+            layer_profiler_hook* hook;
+            const void* layer;
+            layer_profile_event event;
+            std::chrono::steady_clock::time_point start;
+        };
+    }
+
 // ----------------------------------------------------------------------------------------
 
     namespace impl
@@ -140,8 +340,8 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
-    // Tell us if T is one of the special layer types (i.e. add_layer, repeat, add_tag_layer, or
-    // add_skip_layer).
+    // Tell us if T is one of the special layer types (i.e. add_layer, repeat, checkpoint,
+    // add_tag_layer, or add_skip_layer).
     template <typename T> struct is_nonloss_layer_type : std::false_type {};
     // Tell us if T is an instance of add_loss_layer.
     template <typename T> struct is_loss_layer_type : std::false_type {};
@@ -637,6 +837,8 @@ namespace dlib
         friend class add_skip_layer;
         template <size_t N, template<typename> class L, typename S>
         friend class repeat;
+        template <template<typename> class B, typename S>
+        friend class checkpoint;
 
         // Allow copying networks from one to another as long as their corresponding 
         // layers can be constructed from each other.
@@ -791,6 +993,7 @@ namespace dlib
         {
             subnetwork->forward(x);
             const dimpl::subnet_wrapper<subnet_type> wsub(*subnetwork);
+            impl::layer_profile_timer timer(this, impl::layer_profile_event::forward);
             if (!this_layer_setup_called)
             {
                 details.setup(wsub);
@@ -800,6 +1003,7 @@ namespace dlib
                 impl::call_layer_forward(details, wsub, private_get_output());
             else
                 impl::call_layer_forward(details, wsub, cached_output);
+            timer.stop(&subnetwork->private_get_output(), &private_get_output());
 
             gradient_input_is_stale = true;
             return private_get_output();
@@ -856,9 +1060,11 @@ namespace dlib
         void back_propagate_error(const tensor& x, const tensor& gradient_input)
         {
             dimpl::subnet_wrapper<subnet_type> wsub(*subnetwork);
+            impl::layer_profile_timer timer(this, impl::layer_profile_event::backward);
             params_grad.copy_size(details.get_layer_params());
             impl::call_layer_backward(details, private_get_output(),
                 gradient_input, wsub, static_cast<tensor&>(params_grad));
+            timer.stop();
 
             subnetwork->back_propagate_error(x); 
 
@@ -874,8 +1080,10 @@ namespace dlib
             // learning rate is disabled for this layer.
             if (params_grad.size() != 0 && get_learning_rate_multiplier(details) != 0)
             {
+                impl::layer_profile_timer timer(this, impl::layer_profile_event::update);
                 const tensor& step = solvers.top()(learning_rate, details, static_cast<const tensor&>(params_grad));
                 tt::add(details.get_layer_params(), details.get_layer_params(), step);
+                timer.stop();
             }
             subnetwork->update_parameters(solvers.pop(), learning_rate);
         }
@@ -965,6 +1173,17 @@ namespace dlib
             return impl::backward_requires_forward_output(details, *subnetwork);
         }
 
+        void release_activations(
+        )
+        {
+            // Like clean(), but keeps params_grad since the solvers haven't used it yet.
+            x_grad.clear();
+            cached_output.clear();
+            temp_tensor.clear();
+            gradient_input_is_stale = true;
+            subnetwork->release_activations();
+        }
+
         void swap(add_layer& item)
         {
             std::swap(subnetwork,item.subnetwork);
@@ -1043,6 +1262,8 @@ namespace dlib
         friend class add_skip_layer;
         template <size_t N, template<typename> class L, typename S>
         friend class repeat;
+        template <template<typename> class B, typename S>
+        friend class checkpoint;
 
         // Allow copying networks from one to another as long as their corresponding 
         // layers can be constructed from each other.
@@ -1169,12 +1390,14 @@ namespace dlib
             DLIB_CASSERT(sample_expansion_factor() != 0, "You must call to_tensor() before this function can be used.");
             DLIB_CASSERT(x.num_samples()%sample_expansion_factor() == 0);
             subnet_wrapper wsub(x, grad_final, _sample_expansion_factor);
+            impl::layer_profile_timer timer(this, impl::layer_profile_event::forward);
             if (!this_layer_setup_called)
             {
                 details.setup(wsub);
                 this_layer_setup_called = true;
             }
             impl::call_layer_forward(details, wsub, cached_output);
+            timer.stop(&x, &cached_output);
             gradient_input_is_stale = true;
             return private_get_output();
         }
@@ -1222,9 +1445,11 @@ namespace dlib
             grad_final = 0;  
 
             subnet_wrapper wsub(x, grad_final, _sample_expansion_factor);
+            impl::layer_profile_timer timer(this, impl::layer_profile_event::backward);
             params_grad.copy_size(details.get_layer_params());
             impl::call_layer_backward(details, private_get_output(),
                 gradient_input, wsub, static_cast<tensor&>(params_grad));
+            timer.stop();
 
             // zero out get_gradient_input()
             gradient_input_is_stale = true;
@@ -1238,8 +1463,10 @@ namespace dlib
             // learning rate is disabled for this layer.
             if (params_grad.size() != 0 && get_learning_rate_multiplier(details) != 0) 
             {
+                impl::layer_profile_timer timer(this, impl::layer_profile_event::update);
                 const tensor& step = solvers.top()(learning_rate, details, static_cast<const tensor&>(params_grad));
                 tt::add(details.get_layer_params(), details.get_layer_params(), step);
+                timer.stop();
             }
         }
 
@@ -1329,6 +1556,17 @@ namespace dlib
             return impl::backward_requires_forward_output(details, wsub);
         }
 
+        void release_activations(
+        )
+        {
+            // grad_final is left alone since it's what the layer below gets as its
+            // gradient input once this network has been back propagated.
+            x_grad.clear();
+            cached_output.clear();
+            temp_tensor.clear();
+            gradient_input_is_stale = true;
+        }
+
         class subnet_wrapper
         {
         public:
@@ -1540,6 +1778,8 @@ namespace dlib
         friend class add_skip_layer;
         template <size_t N, template<typename> class L, typename S>
         friend class repeat;
+        template <template<typename> class B, typename S>
+        friend class checkpoint;
 
         // You wouldn't put a tag on a layer if you didn't want to access its forward
         // outputs.  So this is always true.
@@ -1557,6 +1797,9 @@ namespace dlib
             DLIB_CASSERT(false,"This should never happen");
         }
 
+        void release_activations(
+        ) { subnetwork.release_activations(); }
+
         tensor& private_get_output() const
         { return subnetwork.private_get_output(); }
         tensor& private_get_gradient_input() 
@@ -1839,6 +2082,8 @@ namespace dlib
         friend class add_skip_layer;
         template <size_t N, template<typename> class L, typename S>
         friend class repeat;
+        template <template<typename> class B, typename S>
+        friend class checkpoint;
 
         bool this_layer_requires_forward_output(
         ) 
@@ -1852,6 +2097,15 @@ namespace dlib
             details[0].disable_output_and_gradient_getters();
         }
 
+        void release_activations(
+        )
+        {
+            temp_tensor.clear();
+            subnetwork.release_activations();
+            for (auto&& d : details)
+                d.release_activations();
+        }
+
 
         std::vector<repeated_layer_type> details; 
         subnet_type subnetwork;
@@ -1868,6 +2122,277 @@ namespace dlib
         >
     struct is_nonloss_layer_type<repeat<num,REPEATED_LAYER,SUBNET>> : std::true_type {};
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        template<typename> class BLOCK,
+        typename SUBNET
+        >
+    class checkpoint
+    {
+    public:
+        typedef SUBNET subnet_type;
+        typedef typename SUBNET::input_type input_type;
+        typedef int layer_details_type; // not really used anywhere, but required by subnet_wrapper.
+        const static size_t comp_layers_in_block = (BLOCK<SUBNET>::num_computational_layers-SUBNET::num_computational_layers);
+        const static size_t num_computational_layers = BLOCK<SUBNET>::num_computational_layers;
+        const static size_t layers_in_block = (BLOCK<SUBNET>::num_layers-SUBNET::num_layers);
+        const static size_t num_layers = BLOCK<SUBNET>::num_layers;
+
+        typedef BLOCK<impl::repeat_input_layer> block_type;
+
+        checkpoint(
+        ) :
+            gradient_input_is_stale(true),
+            get_output_and_gradient_input_disabled(false)
+        {
+        }
+
+        const block_type& get_block (
+        ) const { return block; }
+
+        block_type& get_block (
+        ) { return block; }
+
+        checkpoint(const checkpoint&) = default;
+        checkpoint(checkpoint&&) = default;
+        checkpoint& operator=(checkpoint&&) = default;
+        checkpoint& operator=(const checkpoint&) = default;
+
+        template <template<typename> class T, typename U>
+        checkpoint(
+            const checkpoint<T,U>& item
+        ) :
+            block(item.block),
+            subnetwork(item.subnetwork),
+            gradient_input_is_stale(true),
+            get_output_and_gradient_input_disabled(false)
+        {
+        }
+
+        template <typename T, typename ...U>
+        checkpoint(
+            T arg1,
+            U ...args2
+        ):
+            block(std::move(arg1)),
+            subnetwork(std::move(args2)...),
+            gradient_input_is_stale(true),
+            get_output_and_gradient_input_disabled(false)
+        {
+        }
+
+        template <typename T, typename ...U>
+        checkpoint(
+            std::tuple<>,
+            T arg1,
+            U ...args2
+        ):
+            block(std::move(arg1)),
+            subnetwork(std::move(args2)...),
+            gradient_input_is_stale(true),
+            get_output_and_gradient_input_disabled(false)
+        {
+        }
+
+        template <typename forward_iterator>
+        void to_tensor (
+            forward_iterator ibegin,
+            forward_iterator iend,
+            resizable_tensor& data
+        ) const
+        {
+            subnetwork.to_tensor(ibegin,iend,data);
+            // Like in repeat, this is only here to populate the _sample_expansion_factor
+            // values inside the block.
+            block.to_tensor(ibegin, iend, data);
+        }
+
+        template <typename forward_iterator>
+        const tensor& operator() (
+            forward_iterator ibegin,
+            forward_iterator iend
+        )
+        {
+            to_tensor(ibegin,iend,temp_tensor);
+            return forward(temp_tensor);
+        }
+
+        const tensor& operator() (const input_type& x)
+        {
+            return (*this)(&x, &x+1);
+        }
+
+        const tensor& forward(const tensor& x)
+        {
+            subnetwork.forward(x);
+            // Keep only the output of the block.  Everything else it computed is thrown
+            // away and computed again by back_propagate_error().
+            cached_output = block.forward(subnetwork.get_output());
+            block.release_activations();
+            gradient_input_is_stale = true;
+            return private_get_output();
+        }
+
+    private:
+        tensor& private_get_output() const
+        {
+            return const_cast<resizable_tensor&>(cached_output);
+        }
+        tensor& private_get_gradient_input()
+        {
+            if (gradient_input_is_stale)
+            {
+                gradient_input_is_stale = false;
+                x_grad.copy_size(private_get_output());
+                x_grad = 0;
+            }
+            return x_grad;
+        }
+    public:
+        const tensor& get_output() const
+        {
+            if (get_output_and_gradient_input_disabled)
+                throw dlib::error("Accessing this layer's get_output() is disabled because an in-place layer has been stacked on top of it.");
+            return private_get_output();
+        }
+        tensor& get_gradient_input()
+        {
+            if (get_output_and_gradient_input_disabled)
+                throw dlib::error("Accessing this layer's get_gradient_input() is disabled because an in-place layer has been stacked on top of it.");
+            return private_get_gradient_input();
+        }
+
+        const tensor& get_final_data_gradient(
+        ) const { return subnetwork.get_final_data_gradient(); }
+
+        const tensor& get_parameter_gradient(
+        ) const { return block.get_parameter_gradient(); }
+
+        tensor& get_parameter_gradient (
+        ) { return block.get_parameter_gradient(); }
+
+        void back_propagate_error(const tensor& x)
+        {
+            back_propagate_error(x, private_get_gradient_input());
+        }
+        void back_propagate_error(const tensor& x, const tensor& gradient_input)
+        {
+            // Recompute the outputs forward() threw away, use them, and throw them away
+            // again before moving on to the layers below.
+            block.forward(subnetwork.get_output());
+            block.back_propagate_error(subnetwork.get_output(), gradient_input);
+            block.release_activations();
+            subnetwork.back_propagate_error(x, block.get_final_data_gradient());
+
+            // zero out get_gradient_input()
+            gradient_input_is_stale = true;
+        }
+
+        template <typename solver_type>
+        void update_parameters(sstack<solver_type> solvers, double learning_rate)
+        {
+            block.update_parameters(solvers, learning_rate);
+            subnetwork.update_parameters(solvers.pop(comp_layers_in_block), learning_rate);
+        }
+
+        const subnet_type& subnet() const { return subnetwork; }
+        subnet_type& subnet() { return subnetwork; }
+
+        unsigned int sample_expansion_factor() const { return subnet().sample_expansion_factor(); }
+
+        void clean()
+        {
+            x_grad.clear();
+            cached_output.clear();
+            temp_tensor.clear();
+            gradient_input_is_stale = true;
+            block.clean();
+            subnetwork.clean();
+        }
+
+        friend void serialize(const checkpoint& item, std::ostream& out)
+        {
+            int version = 1;
+            serialize(version, out);
+            serialize(item.block, out);
+            serialize(item.subnetwork, out);
+        }
+
+        friend void deserialize(checkpoint& item, std::istream& in)
+        {
+            int version = 0;
+            deserialize(version, in);
+            if (version != 1)
+                throw serialization_error("Unexpected version found while deserializing dlib::checkpoint.");
+            deserialize(item.block, in);
+            deserialize(item.subnetwork, in);
+        }
+
+        friend std::ostream& operator<< (std::ostream& out, const checkpoint& item)
+        {
+            int min_length = 0;
+            item.print(out, 0, min_length);
+            return out;
+        }
+
+        void print (std::ostream& out, unsigned long idx, int& min_length) const
+        {
+            block.print(out, idx, min_length);
+            subnet().print(out, idx+layers_in_block, min_length);
+        }
+    private:
+
+        template <typename T, typename U, typename E>
+        friend class add_layer;
+        template <typename T, bool is_first, typename E>
+        friend class dimpl::subnet_wrapper;
+        template <unsigned long T, typename U, typename E>
+        friend class add_tag_layer;
+        template <template<typename> class T, typename U>
+        friend class add_skip_layer;
+        template <size_t N, template<typename> class L, typename S>
+        friend class repeat;
+        template <template<typename> class B, typename S>
+        friend class checkpoint;
+
+        // back_propagate_error() runs the block again instead of looking at the output
+        // of this layer, so in-place layers can always overwrite it.
+        bool this_layer_requires_forward_output(
+        ) { return false; }
+
+        void disable_output_and_gradient_getters (
+        ) { get_output_and_gradient_input_disabled = true; }
+
+        void release_activations(
+        )
+        {
+            x_grad.clear();
+            cached_output.clear();
+            temp_tensor.clear();
+            gradient_input_is_stale = true;
+            block.release_activations();
+            subnetwork.release_activations();
+        }
+
+        block_type block;
+        subnet_type subnetwork;
+        bool gradient_input_is_stale;
+        bool get_output_and_gradient_input_disabled;
+        resizable_tensor x_grad;
+        resizable_tensor cached_output;
+
+        // temp_tensor doesn't logically contribute to the state of this class.
+        // It is here only to void needing to reallocate it over and over.
+        resizable_tensor temp_tensor;
+    };
+
+    template <
+        template<typename> class BLOCK,
+        typename SUBNET
+        >
+    struct is_nonloss_layer_type<checkpoint<BLOCK,SUBNET>> : std::true_type {};
+
 // ----------------------------------------------------------------------------------------
 
 // This version of add_tag_layer handles the special case where the subnetwork being given
@@ -2076,6 +2601,8 @@ namespace dlib
         friend class add_skip_layer;
         template <size_t N, template<typename> class L, typename S>
         friend class repeat;
+        template <template<typename> class B, typename S>
+        friend class checkpoint;
 
         // You woudln't put a tag on a layer if you didn't want to access its forward
         // outputs.  So this is always true.
@@ -2093,6 +2620,14 @@ namespace dlib
             DLIB_CASSERT(false,"This should never happen");
         }
 
+        void release_activations(
+        )
+        {
+            // grad_final is this layer's gradient input, which is also what the layer
+            // below gets as its gradient input, so it's left alone.
+            cached_output.clear();
+        }
+
         tensor& private_get_output() const
         { return const_cast<tensor&>(get_output()); }
         tensor& private_get_gradient_input() 
@@ -2340,7 +2875,10 @@ namespace dlib
         {
             subnetwork.forward(x);
             dimpl::subnet_wrapper<subnet_type> wsub(subnetwork);
-            return loss.compute_loss_value_and_gradient(x, lbegin, wsub);
+            impl::layer_profile_timer timer(this, impl::layer_profile_event::forward);
+            const double l = loss.compute_loss_value_and_gradient(x, lbegin, wsub);
+            timer.stop(&subnetwork.get_output());
+            return l;
         }
 
         template <typename forward_iterator, typename label_iterator>
@@ -2360,7 +2898,10 @@ namespace dlib
         {
             subnetwork.forward(x);
             dimpl::subnet_wrapper<subnet_type> wsub(subnetwork);
-            return loss.compute_loss_value_and_gradient(x, wsub);
+            impl::layer_profile_timer timer(this, impl::layer_profile_event::forward);
+            const double l = loss.compute_loss_value_and_gradient(x, wsub);
+            timer.stop(&subnetwork.get_output());
+            return l;
         }
 
         template <typename forward_iterator>
@@ -2381,7 +2922,9 @@ namespace dlib
         {
             subnetwork.forward(x);
             dimpl::subnet_wrapper<subnet_type> wsub(subnetwork);
+            impl::layer_profile_timer timer(this, impl::layer_profile_event::forward);
             double l = loss.compute_loss_value_and_gradient(x, lbegin, wsub);
+            timer.stop(&subnetwork.get_output());
             subnetwork.back_propagate_error(x);
             return l;
         }
@@ -2401,7 +2944,9 @@ namespace dlib
         {
             subnetwork.forward(x);
             dimpl::subnet_wrapper<subnet_type> wsub(subnetwork);
+            impl::layer_profile_timer timer(this, impl::layer_profile_event::forward);
             double l = loss.compute_loss_value_and_gradient(x, wsub);
+            timer.stop(&subnetwork.get_output());
             subnetwork.back_propagate_error(x);
             return l;
         }
@@ -2604,6 +3149,91 @@ namespace dlib
             }
         };
 
+        template <
+            unsigned int i,
+            template<typename> class B, typename S
+        >
+        struct layer_helper<i,checkpoint<B,S>, typename std::enable_if<(i!=0&&i>=checkpoint<B,S>::layers_in_block)>::type>
+        {
+            const static size_t layers_in_block = checkpoint<B,S>::layers_in_block;
+
+            static checkpoint<B,S>& makeT();
+            using next_type = typename std::remove_reference<decltype(makeT().subnet())>::type;
+            using type = typename layer_helper<i-layers_in_block,next_type>::type;
+            static type& layer(checkpoint<B,S>& n)
+            {
+                return layer_helper<i-layers_in_block,next_type>::layer(n.subnet());
+            }
+        };
+        template <
+            unsigned int i,
+            template<typename> class B, typename S
+        >
+        struct layer_helper<i,checkpoint<B,S>, typename std::enable_if<(i!=0&&i<checkpoint<B,S>::layers_in_block)>::type>
+        {
+            using next_type = typename checkpoint<B,S>::block_type;
+            using type = typename layer_helper<i,next_type>::type;
+            static type& layer(checkpoint<B,S>& n)
+            {
+                return layer_helper<i,next_type>::layer(n.get_block());
+            }
+        };
+        template <
+            template<typename> class B, typename S
+        >
+        struct layer_helper<0,checkpoint<B,S>, void>
+        {
+            // The block might itself start with a checkpoint, so look inside it too.
+            using next_type = typename checkpoint<B,S>::block_type;
+            using type = typename layer_helper<0,next_type>::type;
+            static type& layer(checkpoint<B,S>& n)
+            {
+                return layer_helper<0,next_type>::layer(n.get_block());
+            }
+        };
+
+        template <
+            unsigned int i,
+            template<typename> class B, typename S
+        >
+        struct layer_helper<i,const checkpoint<B,S>, typename std::enable_if<(i!=0&&i>=checkpoint<B,S>::layers_in_block)>::type>
+        {
+            const static size_t layers_in_block = checkpoint<B,S>::layers_in_block;
+
+            static const checkpoint<B,S>& makeT();
+            using next_type = const typename std::remove_reference<decltype(makeT().subnet())>::type;
+            using type = const typename layer_helper<i-layers_in_block,next_type>::type;
+            static type& layer(const checkpoint<B,S>& n)
+            {
+                return layer_helper<i-layers_in_block,next_type>::layer(n.subnet());
+            }
+        };
+        template <
+            unsigned int i,
+            template<typename> class B, typename S
+        >
+        struct layer_helper<i,const checkpoint<B,S>, typename std::enable_if<(i!=0&&i<checkpoint<B,S>::layers_in_block)>::type>
+        {
+            using next_type = const typename checkpoint<B,S>::block_type;
+            using type = const typename layer_helper<i,next_type>::type;
+            static type& layer(const checkpoint<B,S>& n)
+            {
+                return layer_helper<i,next_type>::layer(n.get_block());
+            }
+        };
+        template <
+            template<typename> class B, typename S
+        >
+        struct layer_helper<0,const checkpoint<B,S>, void>
+        {
+            using next_type = const typename checkpoint<B,S>::block_type;
+            using type = const typename layer_helper<0,next_type>::type;
+            static type& layer(const checkpoint<B,S>& n)
+            {
+                return layer_helper<0,next_type>::layer(n.get_block());
+            }
+        };
+
 
 
         template <typename T>
@@ -2880,6 +3510,8 @@ namespace dlib
         friend class add_skip_layer;
         template <size_t N, template<typename> class L, typename S>
         friend class repeat;
+        template <template<typename> class B, typename S>
+        friend class checkpoint;
 
         bool this_layer_requires_forward_output(
         ) { return layer<TAG_TYPE>(subnetwork).this_layer_requires_forward_output(); } 
@@ -2887,6 +3519,9 @@ namespace dlib
         void disable_output_and_gradient_getters (
         ) { layer<TAG_TYPE>(subnetwork).disable_output_and_gradient_getters(); }
 
+        void release_activations(
+        ) { subnetwork.release_activations(); }
+
         tensor& private_get_output() const
         { return layer<TAG_TYPE>(subnetwork).private_get_output(); }
         tensor& private_get_gradient_input() 
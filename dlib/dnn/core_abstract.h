@@ -92,6 +92,77 @@ namespace dlib
             - #dnn_prefer_fastest_algorithms() == false 
     !*/
 
+    enum class cpu_conv_algorithm
+    {
+        automatic,
+        img2col,
+        direct,
+        winograd
+    };
+
+    cpu_conv_algorithm dnn_cpu_conv_algorithm(
+    );
+    /*!
+        ensures
+            - returns the convolution algorithm used by the CPU implementation of
+              tt::tensor_conv (i.e. when dlib is not using CUDA).  The options are:
+                - automatic: pick an algorithm for each layer based on its shape.  1x1
+                  unpadded stride 1 convolutions are computed directly with a matrix
+                  multiply, 3x3 stride 1 convolutions with enough channels and a large
+                  enough image use the Winograd F(2x2,3x3) algorithm, horizontal stride 1
+                  convolutions of filters no larger than 5x5 over inputs with few
+                  channels use a direct SIMD kernel, and everything else is lowered with
+                  img2col() into a matrix multiply.
+                - img2col: always lower the convolution into a matrix multiply.
+                - direct: use the direct kernel whenever the filter is no larger than
+                  5x5, otherwise fall back to img2col.
+                - winograd: use the Winograd kernel for 3x3 stride 1 convolutions,
+                  otherwise fall back to img2col.
+            - The backward passes always use img2col, except for 1x1 unpadded stride 1
+              convolutions which skip it unless the algorithm is img2col.
+            - Grouped convolutions (i.e. ones set up with num_groups > 1, like those in
+              grouped_con_ and depthwise_con_) use direct kernels in both the forward
+              and backward passes when each group has at most 4 channels or the
+              algorithm is direct.  Otherwise each group is lowered with img2col() into
+              its own matrix multiply.
+            - On program startup this function will default to automatic.
+    !*/
+
+    void set_dnn_cpu_conv_algorithm(
+        cpu_conv_algorithm algo
+    );
+    /*!
+        ensures
+            - #dnn_cpu_conv_algorithm() == algo
+    !*/
+
+    size_t dnn_cpu_num_threads(
+    );
+    /*!
+        ensures
+            - returns the number of threads the CPU implementations of the tt:: tensor
+              routines (i.e. the ones used when dlib is not using CUDA) split their work
+              across.  Small tensors are always processed in the calling thread since
+              handing them to other threads would cost more than it saves.
+            - On program startup the kernels run on default_thread_pool(), so this
+              function returns the number of threads in that pool.
+    !*/
+
+    void set_dnn_cpu_num_threads(
+        size_t num_threads
+    );
+    /*!
+        requires
+            - num_threads > 0
+            - No deep neural network computations are running on the CPU while this
+              function is called.
+        ensures
+            - #dnn_cpu_num_threads() == num_threads
+            - The CPU tensor routines stop using default_thread_pool() and instead run on
+              a thread pool owned by dlib with num_threads threads.  If num_threads == 1
+              then everything runs serially in the calling thread.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -1240,6 +1311,140 @@ namespace dlib
         provides serialization support  
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        template<typename> class BLOCK,
+        typename SUBNET
+        >
+    class checkpoint
+    {
+        /*!
+            REQUIREMENTS ON BLOCK
+                - BLOCK must be a template that stacks more layers onto a deep neural
+                  network.  For example, if net_type were a network without a loss layer,
+                  then it should be legal to create a deeper network with a type of
+                  BLOCK<net_type>.
+
+            REQUIREMENTS ON SUBNET
+                - One of the following must be true:
+                    - SUBNET is an add_layer object.
+                    - SUBNET is an add_tag_layer object.
+                    - SUBNET is an add_skip_layer object.
+                    - SUBNET is a repeat object.
+                    - SUBNET is a checkpoint object.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object adds BLOCK on top of SUBNET, so checkpoint<BLOCK,SUBNET>
+                computes the same thing as BLOCK<SUBNET>.  The difference is in how much
+                memory training takes.  Normally every layer keeps its output from the
+                forward pass until back propagation is done, so the memory needed to
+                train a network grows with its depth.  A checkpoint keeps only the output
+                of the whole BLOCK.  The outputs of the layers inside BLOCK are thrown
+                away at the end of forward() and computed again, from the output of
+                SUBNET, when back_propagate_error() gets to this object.  So if you make
+                each residual block of a deep network a checkpoint then only one block
+                at a time holds all its outputs, at the cost of running the forward pass
+                of the network twice when training.  For example:
+                    template <typename SUBNET> using ckpt_block = checkpoint<block,SUBNET>;
+                    using net_type = loss_multiclass_log<fc<10,ckpt_block<ckpt_block<
+                                     relu<con<16,3,3,1,1,input_rgb_image>>>>>>;
+
+                The recomputed outputs are only the same as the original ones if the
+                forward pass of BLOCK is deterministic.  So BLOCK shouldn't contain
+                dropout layers, since they would draw a new dropout mask.  Also note that
+                bn_ layers in BLOCK update their running statistics twice per training
+                step, once for each forward pass, which has the same effect as making
+                their running_stats_window_size() a little smaller.
+
+                Like with repeat, the layers in BLOCK see the output of SUBNET as the
+                input of their network, so skip layers in BLOCK can only refer to tags
+                that are also in BLOCK.  Functions like layer<i>() see through a
+                checkpoint, that is, layer<0>(item) is the top layer of BLOCK and
+                layer<checkpoint::layers_in_block>(item) is item.subnet().  Other than
+                that, this object provides an interface identical to the one defined by
+                the add_layer object except that we add the get_block() method.
+        !*/
+
+    public:
+
+        typedef SUBNET subnet_type;
+        typedef typename SUBNET::input_type input_type;
+        const static size_t num_computational_layers = BLOCK<SUBNET>::num_computational_layers;
+        const static size_t num_layers = BLOCK<SUBNET>::num_layers;
+        const static size_t layers_in_block = BLOCK<SUBNET>::num_layers - SUBNET::num_layers;
+        typedef BLOCK<an_unspecified_input_type> block_type;
+
+        template <typename T, typename ...U>
+        checkpoint(
+            T arg1,
+            U ...args2
+        );
+        /*!
+            ensures
+                - arg1 is used to initialize the BLOCK inside this object.
+                - The rest of the arguments to the constructor, i.e. args2, are passed to
+                  SUBNET's constructor.
+        !*/
+
+        const block_type& get_block (
+        ) const;
+        /*!
+            ensures
+                - returns a reference to the BLOCK inside this object.  Note that outside
+                  of a call to back_propagate_error() the layers in it don't hold their
+                  outputs.
+        !*/
+
+        block_type& get_block (
+        );
+        /*!
+            ensures
+                - returns a reference to the BLOCK inside this object.  Note that outside
+                  of a call to back_propagate_error() the layers in it don't hold their
+                  outputs.
+        !*/
+
+        const tensor& get_output(
+        ) const;
+        /*!
+            ensures
+                - returns the output of BLOCK from the most recent call to forward().
+                  This object holds its own copy of it, since the outputs of the layers
+                  in BLOCK are thrown away.
+        !*/
+
+        const subnet_type& subnet(
+        ) const;
+        /*!
+            ensures
+                - returns the SUBNET base network that checkpoint sits on top of.  If you
+                  want to access the BLOCK components then you must use get_block().
+        !*/
+
+        subnet_type& subnet(
+        );
+        /*!
+            ensures
+                - returns the SUBNET base network that checkpoint sits on top of.  If you
+                  want to access the BLOCK components then you must use get_block().
+        !*/
+    };
+
+    template <template<typename> class T, typename U>
+    std::ostream& operator<<(std::ostream& out, const checkpoint<T,U>& item);
+    /*!
+        prints the network architecture to the given output stream.
+    !*/
+
+    template <template<typename> class T, typename U>
+    void serialize(const checkpoint<T,U>& item, std::ostream& out);
+    template <template<typename> class T, typename U>
+    void deserialize(checkpoint<T,U>& item, std::istream& in);
+    /*!
+        provides serialization support
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
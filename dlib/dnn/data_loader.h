@@ -0,0 +1,215 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNn_DATA_LOADER_H_
+#define DLIB_DNn_DATA_LOADER_H_
+
+#include "data_loader_abstract.h"
+#include "core.h"
+#include "../pipe.h"
+#include "../rand.h"
+#include "../cuda/cuda_dlib.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    class dnn_data_loader
+    {
+    public:
+
+        typedef typename net_type::input_type input_type;
+        typedef typename net_type::training_label_type training_label_type;
+        typedef std::function<void(input_type&, training_label_type&, dlib::rand&)> generator_type;
+
+        struct mini_batch
+        {
+            std::vector<input_type> samples;
+            std::vector<training_label_type> labels;
+            resizable_tensor data;
+        };
+
+        dnn_data_loader (
+            const net_type& net,
+            generator_type generator_,
+            size_t mini_batch_size_,
+            size_t num_workers = std::max(1u, std::thread::hardware_concurrency()),
+            size_t num_prefetch = 2,
+            unsigned long seed = 0
+        ) :
+            generator(std::move(generator_)),
+            mini_batch_size(mini_batch_size_),
+            ready(num_prefetch),
+            device(dlib::cuda::get_device())
+        {
+            DLIB_CASSERT(generator != nullptr);
+            DLIB_CASSERT(mini_batch_size_ > 0);
+            DLIB_CASSERT(num_workers > 0);
+            DLIB_CASSERT(num_prefetch > 0);
+
+            for (size_t i = 0; i < num_workers; ++i)
+            {
+                workers.emplace_back([this, &net, i, seed]()
+                {
+                    work(input_layer(net), seed + i);
+                });
+            }
+            // The workers copy the input layer as they start, so wait for that before
+            // returning because net doesn't need to outlive the constructor.
+            std::unique_lock<std::mutex> lock(m);
+            workers_started.wait(lock, [&]{ return num_started == workers.size(); });
+        }
+
+        dnn_data_loader(const dnn_data_loader&) = delete;
+        dnn_data_loader& operator=(const dnn_data_loader&) = delete;
+
+        ~dnn_data_loader (
+        )
+        {
+            ready.disable();
+            for (auto& t : workers)
+                t.join();
+        }
+
+        size_t get_mini_batch_size (
+        ) const { return mini_batch_size; }
+
+        size_t num_workers (
+        ) const { return workers.size(); }
+
+        size_t num_prefetch (
+        ) const { return ready.max_size(); }
+
+        void get_next (
+            mini_batch& batch
+        )
+        {
+            const bool stall = ready.size() == 0;
+            const auto start = std::chrono::steady_clock::now();
+            if (!ready.dequeue(batch))
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if (eptr)
+                    std::rethrow_exception(eptr);
+                throw dlib::error("The dnn_data_loader has stopped.");
+            }
+
+            std::lock_guard<std::mutex> lock(m);
+            ++num_batches;
+            if (stall)
+            {
+                ++num_stall;
+                stall_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+            }
+        }
+
+        size_t get_num_mini_batches (
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            return num_batches;
+        }
+
+        size_t get_num_stalls (
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            return num_stall;
+        }
+
+        double get_total_stall_seconds (
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            return stall_seconds;
+        }
+
+        void clear_stats (
+        )
+        {
+            std::lock_guard<std::mutex> lock(m);
+            num_batches = 0;
+            num_stall = 0;
+            stall_seconds = 0;
+        }
+
+    private:
+
+        typedef typename std::decay<decltype(input_layer(std::declval<const net_type&>()))>::type input_layer_type;
+
+        void work (
+            input_layer_type input,
+            unsigned long worker_seed
+        )
+        {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                ++num_started;
+            }
+            workers_started.notify_all();
+
+            try
+            {
+                // Allocate the tensors on the device that was current when this object
+                // was made, the same as if to_tensor() had been called from there.
+                dlib::cuda::set_device(device);
+                dlib::rand rnd(worker_seed);
+                mini_batch batch;
+                while (ready.is_enabled())
+                {
+                    batch.samples.resize(mini_batch_size);
+                    batch.labels.resize(mini_batch_size);
+                    for (size_t i = 0; i < mini_batch_size; ++i)
+                        generator(batch.samples[i], batch.labels[i], rnd);
+                    input.to_tensor(batch.samples.begin(), batch.samples.end(), batch.data);
+                    // This blocks while num_prefetch() mini-batches are waiting to be
+                    // used.  When it returns batch holds an old mini-batch whose memory
+                    // we reuse for the next one.
+                    if (!ready.enqueue(batch))
+                        return;
+                }
+            }
+            catch (...)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    if (!eptr)
+                        eptr = std::current_exception();
+                }
+                ready.disable();
+            }
+        }
+
+        const generator_type generator;
+        const size_t mini_batch_size;
+        dlib::pipe<mini_batch> ready;
+        const int device;
+
+        mutable std::mutex m;
+        std::condition_variable workers_started;
+        size_t num_started = 0;
+        std::exception_ptr eptr;
+        size_t num_batches = 0;
+        size_t num_stall = 0;
+        double stall_seconds = 0;
+
+        std::vector<std::thread> workers;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_DATA_LOADER_H_
+
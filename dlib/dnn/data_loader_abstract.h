@@ -0,0 +1,195 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DNn_DATA_LOADER_ABSTRACT_H_
+#ifdef DLIB_DNn_DATA_LOADER_ABSTRACT_H_
+
+#include "core_abstract.h"
+#include "../rand/rand_kernel_abstract.h"
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    class dnn_data_loader
+    {
+        /*!
+            REQUIREMENTS ON net_type
+                - net_type is an object of type add_layer, add_loss_layer, add_skip_layer,
+                  or add_tag_layer.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object makes mini-batches of training data in a pool of background
+                threads so that they are ready when a dnn_trainer needs them.  When you
+                call train_one_step() with a std::vector of samples, everything that
+                goes into making those samples, e.g. loading images from disk, decoding
+                them and applying random crops or other augmentations, and then the
+                conversion of the samples into a tensor by the network's input layer,
+                happens in the same thread as training, and the GPU sits idle while it
+                happens.  With this object you instead supply a generator function that
+                makes one random training sample.  The worker threads call it to fill
+                each mini-batch, convert the mini-batch into a tensor, and keep up to
+                num_prefetch() finished mini-batches waiting in a queue.  So while the
+                network trains on one mini-batch the next ones are being made.
+
+                Pass the loader to dnn_trainer::train_one_step() or test_one_step(), or
+                call get_next() yourself.
+
+                If the network spends time waiting on the loader the loader is too slow
+                and you should use more workers or a cheaper generator.
+                get_num_stalls() and get_total_stall_seconds() tell you if that happens.
+
+            THREAD SAFETY
+                The generator is called concurrently from all the worker threads, so it
+                must be safe to do so.  Each worker passes it its own dlib::rand, which
+                should be used for all random choices the generator makes.
+                get_next() must not be called concurrently from more than one thread.
+                The other member functions may be called from any thread.
+        !*/
+
+    public:
+
+        typedef typename net_type::input_type input_type;
+        typedef typename net_type::training_label_type training_label_type;
+        typedef std::function<void(input_type&, training_label_type&, dlib::rand&)> generator_type;
+
+        struct mini_batch
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    One mini-batch made by the loader.  data is the result of calling
+                    to_tensor() on samples with the network's input layer, and labels[i]
+                    is the label of samples[i].
+            !*/
+
+            std::vector<input_type> samples;
+            std::vector<training_label_type> labels;
+            resizable_tensor data;
+        };
+
+        dnn_data_loader (
+            const net_type& net,
+            generator_type generator,
+            size_t mini_batch_size,
+            size_t num_workers = std::max(1u, std::thread::hardware_concurrency()),
+            size_t num_prefetch = 2,
+            unsigned long seed = 0
+        );
+        /*!
+            requires
+                - generator != nullptr
+                - mini_batch_size > 0
+                - num_workers > 0
+                - num_prefetch > 0
+            ensures
+                - #get_mini_batch_size() == mini_batch_size
+                - #num_workers() == num_workers
+                - #num_prefetch() == num_prefetch
+                - #get_num_mini_batches() == 0
+                - #get_num_stalls() == 0
+                - Starts num_workers threads that make mini-batches by calling
+                  generator(sample, label, rnd) mini_batch_size times and then converting
+                  the samples into a tensor with a copy of input_layer(net).  The tensors
+                  are made on the CUDA device that is current when this constructor is
+                  called.
+                - The i-th worker seeds its dlib::rand with seed+i.  Note that the order
+                  in which get_next() returns the mini-batches of different workers
+                  depends on thread timing.
+                - This object copies the input layer of net, so net doesn't need to
+                  outlive it.
+        !*/
+
+        ~dnn_data_loader (
+        );
+        /*!
+            ensures
+                - Stops the worker threads and waits for them to finish the mini-batches
+                  they are working on.
+        !*/
+
+        size_t get_mini_batch_size (
+        ) const;
+        /*!
+            ensures
+                - returns the number of samples in each mini-batch.
+        !*/
+
+        size_t num_workers (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads making mini-batches.
+        !*/
+
+        size_t num_prefetch (
+        ) const;
+        /*!
+            ensures
+                - returns the largest number of finished mini-batches that wait to be
+                  taken by get_next().  Once there are that many the workers wait.
+        !*/
+
+        void get_next (
+            mini_batch& batch
+        );
+        /*!
+            ensures
+                - Waits for a finished mini-batch and swaps it into batch.  The old
+                  contents of batch are given back to the workers, which reuse its memory
+                  for a later mini-batch.
+                - #get_num_mini_batches() == get_num_mini_batches() + 1
+                - If no finished mini-batch was waiting when this function was called,
+                  #get_num_stalls() == get_num_stalls() + 1 and the time spent waiting
+                  is added to get_total_stall_seconds().
+            throws
+                - If the generator or the input layer throws an exception in a worker
+                  thread then all the workers stop and the exception is rethrown here,
+                  from this call and all later ones.
+        !*/
+
+        size_t get_num_mini_batches (
+        ) const;
+        /*!
+            ensures
+                - returns the number of mini-batches returned by get_next() since this
+                  object was made or clear_stats() was last called.
+        !*/
+
+        size_t get_num_stalls (
+        ) const;
+        /*!
+            ensures
+                - returns the number of those calls to get_next() that had to wait for
+                  the workers to finish a mini-batch.
+        !*/
+
+        double get_total_stall_seconds (
+        ) const;
+        /*!
+            ensures
+                - returns the total number of seconds those calls to get_next() spent
+                  waiting.
+        !*/
+
+        void clear_stats (
+        );
+        /*!
+            ensures
+                - #get_num_mini_batches() == 0
+                - #get_num_stalls() == 0
+                - #get_total_stall_seconds() == 0
+        !*/
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_DATA_LOADER_ABSTRACT_H_
+
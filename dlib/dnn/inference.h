@@ -0,0 +1,1191 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNn_INFERENCE_H_
+#define DLIB_DNn_INFERENCE_H_
+
+#include "inference_abstract.h"
+#include "core.h"
+#include "layers.h"
+#include "../cuda/cpu_dlib.h"
+#include "../cuda/reduced_precision.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        enum class inference_op_type
+        {
+            conv,
+            relu,
+            affine,
+            max_pool,
+            avg_pool,
+            add_prev
+        };
+
+        struct inference_op
+        {
+            inference_op_type type = inference_op_type::relu;
+
+            // Indices into inference_graph's buffers.  Buffer 0 is the network input.
+            long input = 0;
+            long input2 = 0;
+            long output = 0;
+
+            // Used by conv, affine and add_prev.  Apply a relu to the output.
+            bool relu = false;
+
+            // Used by conv and the pooling ops.  Both con_ and fc_ become conv ops, fc_ as
+            // a filter covering the whole input, which is marked by nr == nc == 0.  For
+            // pooling, nr == 0 or nc == 0 means the window spans the whole input plane.
+            long nr = 0;
+            long nc = 0;
+            long stride_y = 1;
+            long stride_x = 1;
+            long padding_y = 0;
+            long padding_x = 0;
+
+            // Used by conv.  Until quantize() is called the filters are the float ones,
+            // shaped like tensor_conv filters for con_ and as a num_filters by filter_size
+            // matrix for fc_.  After that float_filters is empty and the int8 ones are used
+            // instead.  Likewise, use_reduced_precision() moves them into reduced_filters.
+            long num_filters = 0;
+            long filter_size = 0;
+            resizable_tensor biases;
+            resizable_tensor float_filters;
+            storage_precision filter_precision = storage_precision::float32;
+            std::vector<std::uint16_t> reduced_filters;
+            float input_min = 0;
+            float input_max = 0;
+            float input_scale = 1;
+            long input_offset = 0;
+            long filter_stride = 0;
+            std::vector<std::int8_t> filters;
+            std::vector<float> filter_scales;
+
+            // Used by affine.
+            resizable_tensor gamma;
+            resizable_tensor beta;
+            int mode = CONV_MODE;
+        };
+
+        struct buffer_dims
+        {
+            long long num_samples = 0;
+            long long k = 0;
+            long long nr = 0;
+            long long nc = 0;
+
+            size_t size() const { return num_samples*k*nr*nc; }
+        };
+
+        struct inference_buffers
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This is the memory an inference_graph runs in, which is kept apart from
+                    the graph so many threads can run one graph at once, each with its own
+                    inference_buffers.  Copies start out empty since there's no point in
+                    copying the contents of buffers that get overwritten by every run.
+            !*/
+
+            inference_buffers() = default;
+            inference_buffers(const inference_buffers&) {}
+            inference_buffers& operator=(const inference_buffers&) { clear(); return *this; }
+
+            size_t peak_memory_usage (
+            ) const { return arena.size()*sizeof(float); }
+
+            void clear (
+            )
+            {
+                planned_input = buffer_dims();
+                dims.clear();
+                offsets.clear();
+                views.clear();
+                arena.clear();
+            }
+
+            buffer_dims planned_input;
+            std::vector<buffer_dims> dims;
+            std::vector<size_t> offsets;
+            resizable_tensor arena;
+            // Views of each buffer's part of the arena.  Buffer 0 is the input to run(), so
+            // it gets an empty view.
+            std::vector<alias_tensor_instance> views;
+        };
+
+        class inference_graph
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This is the list of operations run by inference_net and quantized_net.
+                    It is built by inference_graph_builder, which gives the output of every
+                    op its own buffer index.  plan_buffers() then lets relu and affine ops
+                    overwrite their inputs when nothing else needs them.
+
+                    The buffers themselves are slices of the arena tensor in the
+                    inference_buffers given to run().  Whenever run() sees an input with new
+                    dimensions it works out the size of every buffer and where each one
+                    lives in the arena, such that buffers that are in use at the same time
+                    don't overlap.  run() only accesses the graph through const references,
+                    so it can be called from many threads at once as long as each has its own
+                    inference_buffers.  In particular, the non-const host() of a tensor isn't
+                    thread safe, so run() must never use it on the tensors in the ops.
+            !*/
+        public:
+
+            std::vector<inference_op> ops;
+            long num_buffers = 1;
+            long output_buffer = 0;
+
+            const tensor& run (
+                const tensor& x,
+                inference_buffers& buffers
+            ) const
+            {
+                return run(x, buffers, nullptr);
+            }
+
+            void record_input_ranges (
+                const tensor& x,
+                inference_buffers& buffers
+            )
+            /*!
+                ensures
+                    - Runs x through the graph and widens the input_min and input_max of
+                      every conv op to include the values of its input.
+            !*/
+            {
+                std::vector<std::pair<float,float>> ranges;
+                for (auto& op : ops)
+                    ranges.emplace_back(op.input_min, op.input_max);
+                run(x, buffers, &ranges);
+                for (size_t i = 0; i < ops.size(); ++i)
+                {
+                    ops[i].input_min = ranges[i].first;
+                    ops[i].input_max = ranges[i].second;
+                }
+            }
+
+            void plan_buffers (
+            )
+            /*!
+                ensures
+                    - Makes each relu and affine op write into its input buffer if no later
+                      op reads that buffer, and renumbers the buffers so the ones no op
+                      writes to anymore are dropped.
+            !*/
+            {
+                std::vector<long> last_use(num_buffers, -1);
+                for (size_t i = 0; i < ops.size(); ++i)
+                {
+                    last_use[ops[i].input] = i;
+                    if (ops[i].type == inference_op_type::add_prev)
+                        last_use[ops[i].input2] = i;
+                }
+                last_use[output_buffer] = ops.size();
+
+                for (size_t i = 0; i < ops.size(); ++i)
+                {
+                    auto& op = ops[i];
+                    if ((op.type != inference_op_type::relu && op.type != inference_op_type::affine) ||
+                        op.input == 0 || last_use[op.input] != (long)i)
+                        continue;
+
+                    const long old = op.output;
+                    op.output = op.input;
+                    for (size_t j = i+1; j < ops.size(); ++j)
+                    {
+                        if (ops[j].input == old)  ops[j].input = op.input;
+                        if (ops[j].input2 == old) ops[j].input2 = op.input;
+                    }
+                    if (output_buffer == old)
+                        output_buffer = op.input;
+                    last_use[op.input] = last_use[old];
+                }
+
+                std::vector<long> id(num_buffers, -1);
+                id[0] = 0;
+                long num = 1;
+                for (auto& op : ops)
+                {
+                    if (id[op.output] == -1)
+                        id[op.output] = num++;
+                }
+                for (auto& op : ops)
+                {
+                    op.input = id[op.input];
+                    op.input2 = id[op.input2];
+                    op.output = id[op.output];
+                }
+                output_buffer = id[output_buffer];
+                num_buffers = num;
+            }
+
+            void quantize (
+            )
+            {
+                for (auto& op : ops)
+                {
+                    if (op.type != inference_op_type::conv)
+                        continue;
+
+                    const long align = cpu::quantized_filter_alignment;
+                    op.filter_stride = (op.filter_size+align-1)/align*align;
+                    op.filters.assign(op.num_filters*op.filter_stride, 0);
+                    op.filter_scales.resize(op.num_filters);
+                    const float* w = op.float_filters.host();
+                    for (long f = 0; f < op.num_filters; ++f, w += op.filter_size)
+                    {
+                        // Symmetric per output channel quantization of the filters.
+                        const float largest = max(abs(dlib::mat(w, op.filter_size, 1)));
+                        const float scale = largest > 0 ? largest/127 : 1;
+                        std::int8_t* q = &op.filters[f*op.filter_stride];
+                        for (long j = 0; j < op.filter_size; ++j)
+                            q[j] = static_cast<std::int8_t>(std::lround(std::min(std::max(w[j]/scale, -127.0f), 127.0f)));
+                        op.filter_scales[f] = scale;
+                    }
+                    // The inputs get a single scale for the whole tensor, picked so the
+                    // range seen while recording the input ranges fits in the 7 bits
+                    // quantized_conv() uses.  Most layers follow a relu so their inputs
+                    // are never negative and can use all of it.
+                    float scale;
+                    if (op.input_min >= 0)
+                    {
+                        op.input_offset = 0;
+                        scale = op.input_max/127;
+                    }
+                    else
+                    {
+                        op.input_offset = 64;
+                        scale = std::max(-op.input_min/64, op.input_max/63);
+                    }
+                    op.input_scale = scale > 0 ? scale : 1;
+                    op.float_filters.clear();
+                }
+            }
+
+            void use_reduced_precision (
+                storage_precision precision
+            )
+            /*!
+                ensures
+                    - Stores the float filters of every conv op in precision instead.
+            !*/
+            {
+                if (precision == storage_precision::float32)
+                    return;
+                for (auto& op : ops)
+                {
+                    if (op.type != inference_op_type::conv || op.float_filters.size() == 0)
+                        continue;
+                    op.filter_precision = precision;
+                    op.reduced_filters.resize(op.float_filters.size());
+                    convert_to_reduced_precision(op.float_filters.host(), &op.reduced_filters[0],
+                        op.reduced_filters.size(), precision);
+                    op.float_filters.clear();
+                }
+            }
+
+            size_t num_quantized_ops (
+            ) const
+            {
+                size_t num = 0;
+                for (auto& op : ops)
+                {
+                    if (op.type == inference_op_type::conv && !op.filters.empty())
+                        ++num;
+                }
+                return num;
+            }
+
+            friend void serialize(const inference_graph& item, std::ostream& out)
+            {
+                serialize("inference_graph2", out);
+                serialize(item.num_buffers, out);
+                serialize(item.output_buffer, out);
+                serialize(item.ops.size(), out);
+                for (auto& op : item.ops)
+                {
+                    serialize((int)op.type, out);
+                    serialize(op.input, out);
+                    serialize(op.input2, out);
+                    serialize(op.output, out);
+                    serialize(op.relu, out);
+                    serialize(op.nr, out);
+                    serialize(op.nc, out);
+                    serialize(op.stride_y, out);
+                    serialize(op.stride_x, out);
+                    serialize(op.padding_y, out);
+                    serialize(op.padding_x, out);
+                    serialize(op.num_filters, out);
+                    serialize(op.filter_size, out);
+                    serialize(op.biases, out);
+                    serialize(op.float_filters, out);
+                    serialize(op.input_scale, out);
+                    serialize(op.input_offset, out);
+                    serialize(op.filter_stride, out);
+                    std::vector<char> temp(op.filters.size());
+                    if (temp.size() != 0)
+                        std::memcpy(&temp[0], &op.filters[0], temp.size());
+                    serialize(temp, out);
+                    serialize(op.filter_scales, out);
+                    serialize(op.gamma, out);
+                    serialize(op.beta, out);
+                    serialize(op.mode, out);
+                    serialize(op.filter_precision, out);
+                    serialize(op.reduced_filters, out);
+                }
+            }
+
+            friend void deserialize(inference_graph& item, std::istream& in)
+            {
+                std::string version;
+                deserialize(version, in);
+                if (version != "inference_graph2")
+                    throw serialization_error("Unexpected version '"+version+"' found while deserializing dlib::impl::inference_graph.");
+                deserialize(item.num_buffers, in);
+                deserialize(item.output_buffer, in);
+                size_t num;
+                deserialize(num, in);
+                item.ops.resize(num);
+                for (auto& op : item.ops)
+                {
+                    int type;
+                    deserialize(type, in);
+                    op.type = (inference_op_type)type;
+                    deserialize(op.input, in);
+                    deserialize(op.input2, in);
+                    deserialize(op.output, in);
+                    deserialize(op.relu, in);
+                    deserialize(op.nr, in);
+                    deserialize(op.nc, in);
+                    deserialize(op.stride_y, in);
+                    deserialize(op.stride_x, in);
+                    deserialize(op.padding_y, in);
+                    deserialize(op.padding_x, in);
+                    deserialize(op.num_filters, in);
+                    deserialize(op.filter_size, in);
+                    deserialize(op.biases, in);
+                    deserialize(op.float_filters, in);
+                    deserialize(op.input_scale, in);
+                    deserialize(op.input_offset, in);
+                    deserialize(op.filter_stride, in);
+                    std::vector<char> temp;
+                    deserialize(temp, in);
+                    op.filters.resize(temp.size());
+                    if (temp.size() != 0)
+                        std::memcpy(&op.filters[0], &temp[0], temp.size());
+                    deserialize(op.filter_scales, in);
+                    deserialize(op.gamma, in);
+                    deserialize(op.beta, in);
+                    deserialize(op.mode, in);
+                    deserialize(op.filter_precision, in);
+                    deserialize(op.reduced_filters, in);
+                }
+            }
+
+            friend std::ostream& operator<< (std::ostream& out, const inference_graph& item)
+            {
+                for (size_t i = 0; i < item.ops.size(); ++i)
+                {
+                    auto& op = item.ops[i];
+                    out << "op" << i << "\t";
+                    switch (op.type)
+                    {
+                        case inference_op_type::conv:
+                            if (!op.filters.empty())
+                                out << "int8 ";
+                            else if (!op.reduced_filters.empty())
+                                out << op.filter_precision << " ";
+                            if (op.nr == 0 && op.nc == 0)
+                                out << "fc\t (num_outputs="<<op.num_filters<<")";
+                            else
+                                out << "con\t (num_filters="<<op.num_filters<<", nr="<<op.nr<<", nc="<<op.nc
+                                    <<", stride_y="<<op.stride_y<<", stride_x="<<op.stride_x
+                                    <<", padding_y="<<op.padding_y<<", padding_x="<<op.padding_x<<")";
+                            break;
+                        case inference_op_type::relu:     out << "relu"; break;
+                        case inference_op_type::affine:   out << "affine"; break;
+                        case inference_op_type::max_pool: out << "max_pool\t (nr="<<op.nr<<", nc="<<op.nc<<", stride_y="<<op.stride_y<<", stride_x="<<op.stride_x<<")"; break;
+                        case inference_op_type::avg_pool: out << "avg_pool\t (nr="<<op.nr<<", nc="<<op.nc<<", stride_y="<<op.stride_y<<", stride_x="<<op.stride_x<<")"; break;
+                        case inference_op_type::add_prev: out << "add_prev"; break;
+                    }
+                    if (op.relu)
+                        out << " + relu";
+                    out << "\n";
+                }
+                return out;
+            }
+
+        private:
+
+            const tensor& run (
+                const tensor& x,
+                inference_buffers& buffers,
+                std::vector<std::pair<float,float>>* input_ranges
+            ) const
+            {
+                const auto& planned_input = buffers.planned_input;
+                if ((long)buffers.dims.size() != num_buffers || planned_input.num_samples != x.num_samples() ||
+                    planned_input.k != x.k() || planned_input.nr != x.nr() || planned_input.nc != x.nc())
+                {
+                    plan_memory(x, buffers);
+                }
+
+                auto& views = buffers.views;
+                auto get = [&](long i) -> const tensor& { if (i == 0) return x; else return views[i]; };
+
+                for (size_t i = 0; i < ops.size(); ++i)
+                {
+                    const auto& op = ops[i];
+                    const tensor& in = get(op.input);
+                    tensor& out = views[op.output];
+                    switch (op.type)
+                    {
+                        case inference_op_type::conv:
+                            {
+                                const bool is_fc = op.nr == 0 && op.nc == 0;
+                                const long nr = is_fc ? in.nr() : op.nr;
+                                const long nc = is_fc ? in.nc() : op.nc;
+                                if (input_ranges)
+                                {
+                                    auto& r = (*input_ranges)[i];
+                                    r.first = std::min(r.first, min(dlib::mat(in)));
+                                    r.second = std::max(r.second, max(dlib::mat(in)));
+                                }
+
+                                if (!op.filters.empty())
+                                {
+                                    cpu::quantized_conv(out, in, op.input_scale, op.input_offset, &op.filters[0], op.filter_stride,
+                                        &op.filter_scales[0], op.biases.host(), op.num_filters, nr, nc,
+                                        op.stride_y, op.stride_x, op.padding_y, op.padding_x, op.relu);
+                                    break;
+                                }
+
+                                if (!op.reduced_filters.empty() && is_fc)
+                                {
+                                    cpu::reduced_precision_fc(out, in, &op.reduced_filters[0], op.filter_precision,
+                                        op.biases.host(), op.num_filters, op.relu);
+                                    break;
+                                }
+
+                                if (!op.reduced_filters.empty())
+                                {
+                                    // Convolutions do many operations per filter value, so
+                                    // converting all the filters up front costs little.
+                                    resizable_tensor filters(op.num_filters, op.filter_size/(op.nr*op.nc), op.nr, op.nc);
+                                    convert_from_reduced_precision(&op.reduced_filters[0], filters.host(),
+                                        filters.size(), op.filter_precision);
+                                    cpu::tensor_conv conv;
+                                    conv.setup(in, filters, op.stride_y, op.stride_x, op.padding_y, op.padding_x);
+                                    conv(false, out, in, filters);
+                                }
+                                else if (is_fc)
+                                {
+                                    set_ptrm(out.host(), in.num_samples(), op.num_filters) =
+                                        dlib::mat(in.host(), in.num_samples(), op.filter_size)*trans(dlib::mat(op.float_filters));
+                                }
+                                else
+                                {
+                                    cpu::tensor_conv conv;
+                                    conv.setup(in, op.float_filters, op.stride_y, op.stride_x, op.padding_y, op.padding_x);
+                                    conv(false, out, in, op.float_filters);
+                                }
+                                cpu::add_conv_bias(out, op.biases, op.relu);
+                            } break;
+                        case inference_op_type::relu:
+                            cpu::relu(out, in);
+                            break;
+                        case inference_op_type::affine:
+                            if (op.mode == FC_MODE)
+                                cpu::affine_transform(out, in, op.gamma, op.beta);
+                            else
+                                cpu::affine_transform_conv(out, in, op.gamma, op.beta);
+                            if (op.relu)
+                                cpu::relu(out, out);
+                            break;
+                        case inference_op_type::max_pool:
+                        case inference_op_type::avg_pool:
+                            {
+                                cpu::pooling mp;
+                                const long nr = op.nr != 0 ? op.nr : in.nr();
+                                const long nc = op.nc != 0 ? op.nc : in.nc();
+                                if (op.type == inference_op_type::max_pool)
+                                    mp.setup_max_pooling(nr, nc, op.stride_y, op.stride_x, op.padding_y, op.padding_x);
+                                else
+                                    mp.setup_avg_pooling(nr, nc, op.stride_y, op.stride_x, op.padding_y, op.padding_x);
+                                mp(out, in);
+                            } break;
+                        case inference_op_type::add_prev:
+                            {
+                                const tensor& in2 = get(op.input2);
+                                if (op.relu && have_same_dimensions(in, in2))
+                                {
+                                    cpu::add_relu(out, in, in2);
+                                }
+                                else
+                                {
+                                    cpu::add(out, in, in2);
+                                    if (op.relu)
+                                        cpu::relu(out, out);
+                                }
+                            } break;
+                    }
+                }
+
+                return get(output_buffer);
+            }
+
+            void plan_memory (
+                const tensor& x,
+                inference_buffers& buffers
+            ) const
+            {
+                auto& dims = buffers.dims;
+                auto& offsets = buffers.offsets;
+                auto& planned_input = buffers.planned_input;
+                const long num_ops = ops.size();
+                planned_input.num_samples = x.num_samples();
+                planned_input.k = x.k();
+                planned_input.nr = x.nr();
+                planned_input.nc = x.nc();
+
+                // Find the dimensions of each buffer, as well as the first and last op that
+                // uses it.
+                dims.assign(num_buffers, buffer_dims());
+                dims[0] = planned_input;
+                std::vector<long> first(num_buffers, num_ops), last(num_buffers, -1);
+                for (long i = 0; i < num_ops; ++i)
+                {
+                    const auto& op = ops[i];
+                    dims[op.output] = output_dims(op, dims[op.input], dims[op.input2]);
+                    first[op.output] = std::min(first[op.output], i);
+                    last[op.output] = std::max(last[op.output], i);
+                    last[op.input] = i;
+                    if (op.type == inference_op_type::add_prev)
+                        last[op.input2] = i;
+                }
+                last[output_buffer] = num_ops;
+
+                // Place the buffers in the arena, biggest first, each at the lowest offset
+                // where it doesn't overlap a buffer that's in use at the same time.
+                std::vector<long> order;
+                for (long i = 1; i < num_buffers; ++i)
+                    order.push_back(i);
+                std::stable_sort(order.begin(), order.end(), [&](long a, long b) { return dims[a].size() > dims[b].size(); });
+                auto padded_size = [&](long b) { return (dims[b].size()+15)/16*16; };
+
+                offsets.assign(num_buffers, 0);
+                std::vector<long> placed;
+                size_t arena_size = 0;
+                for (long b : order)
+                {
+                    std::vector<long> live;
+                    for (long p : placed)
+                    {
+                        if (first[p] <= last[b] && first[b] <= last[p])
+                            live.push_back(p);
+                    }
+                    std::sort(live.begin(), live.end(), [&](long a, long c) { return offsets[a] < offsets[c]; });
+
+                    size_t offset = 0;
+                    for (long p : live)
+                    {
+                        if (offset + padded_size(b) <= offsets[p])
+                            break;
+                        offset = std::max(offset, offsets[p] + padded_size(p));
+                    }
+                    offsets[b] = offset;
+                    arena_size = std::max(arena_size, offset + padded_size(b));
+                    placed.push_back(b);
+                }
+                buffers.arena.set_size(arena_size);
+
+                buffers.views.clear();
+                buffers.views.push_back(alias_tensor()(buffers.arena));
+                for (long i = 1; i < num_buffers; ++i)
+                {
+                    const auto& d = dims[i];
+                    buffers.views.push_back(alias_tensor(d.num_samples, d.k, d.nr, d.nc)(buffers.arena, offsets[i]));
+                }
+            }
+
+            static buffer_dims output_dims (
+                const inference_op& op,
+                const buffer_dims& in,
+                const buffer_dims& in2
+            )
+            {
+                buffer_dims out = in;
+                switch (op.type)
+                {
+                    case inference_op_type::conv:
+                        out.k = op.num_filters;
+                        if (op.nr == 0 && op.nc == 0)
+                        {
+                            DLIB_CASSERT(in.k*in.nr*in.nc == op.filter_size,
+                                "The input doesn't have the dimensions the network was built for.");
+                            out.nr = 1;
+                            out.nc = 1;
+                        }
+                        else
+                        {
+                            DLIB_CASSERT(in.k*op.nr*op.nc == op.filter_size,
+                                "The input doesn't have the dimensions the network was built for.");
+                            out.nr = 1+(in.nr+2*op.padding_y-op.nr)/op.stride_y;
+                            out.nc = 1+(in.nc+2*op.padding_x-op.nc)/op.stride_x;
+                        }
+                        break;
+                    case inference_op_type::max_pool:
+                    case inference_op_type::avg_pool:
+                        {
+                            const long nr = op.nr != 0 ? op.nr : in.nr;
+                            const long nc = op.nc != 0 ? op.nc : in.nc;
+                            out.nr = 1+(in.nr+2*op.padding_y-nr)/op.stride_y;
+                            out.nc = 1+(in.nc+2*op.padding_x-nc)/op.stride_x;
+                        } break;
+                    case inference_op_type::add_prev:
+                        out.num_samples = std::max(in.num_samples, in2.num_samples);
+                        out.k = std::max(in.k, in2.k);
+                        out.nr = std::max(in.nr, in2.nr);
+                        out.nc = std::max(in.nc, in2.nc);
+                        break;
+                    case inference_op_type::relu:
+                    case inference_op_type::affine:
+                        break;
+                }
+                return out;
+            }
+        };
+
+    // ------------------------------------------------------------------------------------
+
+        class inference_graph_builder
+        {
+            /*!
+                This object is given to visit_layers_backwards() to translate a network
+                into an inference_graph, starting from the input layer.  It tracks which
+                buffer holds the output of the most recent layer and which buffers are
+                referenced by tag layers, since a layer can only be folded into the one
+                before it when nothing else looks at that layer's output.
+            !*/
+        public:
+
+            inference_graph_builder(
+                inference_graph& graph_
+            ) : graph(graph_) {}
+
+            template <typename input_layer_type>
+            void operator()(size_t, const input_layer_type&)
+            {
+                graph.output_buffer = 0;
+            }
+
+            template <typename T, typename U>
+            void operator()(size_t, const add_loss_layer<T,U>&)
+            {
+            }
+
+            template <unsigned long ID, typename U, typename E>
+            void operator()(size_t, const add_tag_layer<ID,U,E>&)
+            {
+                tags[ID] = graph.output_buffer;
+                tagged.insert(graph.output_buffer);
+            }
+
+            template <template<typename> class TAG_TYPE, typename U>
+            void operator()(size_t, const add_skip_layer<TAG_TYPE,U>&)
+            {
+                graph.output_buffer = find_tag(tag_id<TAG_TYPE>::id);
+            }
+
+            template <typename T, typename U, typename E>
+            void operator()(size_t, const add_layer<T,U,E>& l)
+            {
+                add(l.layer_details());
+            }
+
+            // The rest of the interface builds the graph one op at a time, for the
+            // importers that don't start from a dlib network.
+
+            long current_buffer (
+            ) const { return graph.output_buffer; }
+
+            void set_current_buffer (
+                long buffer
+            ) { graph.output_buffer = buffer; }
+
+            void mark_shared (
+                long buffer
+            )
+            /*!
+                ensures
+                    - Keeps the following ops from being folded into the op that writes
+                      buffer, like a tag layer does.
+            !*/
+            {
+                tagged.insert(buffer);
+            }
+
+            inference_op new_op (
+                inference_op_type type
+            ) const
+            {
+                inference_op op;
+                op.type = type;
+                op.input = graph.output_buffer;
+                op.output = graph.num_buffers;
+                return op;
+            }
+
+            void push (
+                const inference_op& op
+            )
+            {
+                graph.ops.push_back(op);
+                graph.output_buffer = graph.num_buffers++;
+            }
+
+            void add_relu (
+            )
+            {
+                inference_op* prev = foldable_op();
+                if (prev && prev->type != inference_op_type::max_pool && prev->type != inference_op_type::avg_pool &&
+                    prev->type != inference_op_type::relu)
+                {
+                    prev->relu = true;
+                    return;
+                }
+                push(new_op(inference_op_type::relu));
+            }
+
+            void add_affine (
+                const tensor& g,
+                const tensor& b,
+                int mode
+            )
+            {
+                inference_op* prev = foldable_op();
+                if (prev && prev->type == inference_op_type::conv && (long)g.size() == prev->num_filters)
+                {
+                    // Scale each filter and its bias so the convolution computes the
+                    // affine transform of its output directly.
+                    const float* gg = g.host();
+                    const float* bb = b.host();
+                    float* w = prev->float_filters.host();
+                    float* bias = prev->biases.host();
+                    for (long f = 0; f < prev->num_filters; ++f)
+                    {
+                        for (long j = 0; j < prev->filter_size; ++j)
+                            w[f*prev->filter_size+j] *= gg[f];
+                        bias[f] = gg[f]*bias[f] + bb[f];
+                    }
+                    return;
+                }
+
+                inference_op op = new_op(inference_op_type::affine);
+                op.gamma.copy_size(g);
+                op.beta.copy_size(b);
+                memcpy(op.gamma, g);
+                memcpy(op.beta, b);
+                op.mode = mode;
+                push(op);
+            }
+
+        private:
+
+            template <long num_filters, long nr, long nc, int stride_y, int stride_x, int padding_y, int padding_x>
+            void add(const con_<num_filters,nr,nc,stride_y,stride_x,padding_y,padding_x>& l)
+            {
+                const tensor& params = l.get_layer_params();
+                DLIB_CASSERT(params.size() != 0, "The network must be initialized before it can be compiled for inference.");
+                inference_op op = new_op(inference_op_type::conv);
+                op.num_filters = l.num_filters();
+                op.filter_size = params.size()/op.num_filters - 1;
+                op.nr = l.nr();
+                op.nc = l.nc();
+                op.stride_y = l.stride_y();
+                op.stride_x = l.stride_x();
+                op.padding_y = l.padding_y();
+                op.padding_x = l.padding_x();
+                op.float_filters.set_size(op.num_filters, op.filter_size/(op.nr*op.nc), op.nr, op.nc);
+                op.biases.set_size(1, op.num_filters);
+                std::memcpy(op.float_filters.host(), params.host(), op.float_filters.size()*sizeof(float));
+                std::memcpy(op.biases.host(), params.host()+op.float_filters.size(), op.biases.size()*sizeof(float));
+                push(op);
+            }
+
+            template <unsigned long num_outputs, fc_bias_mode bias_mode>
+            void add(const fc_<num_outputs,bias_mode>& l)
+            {
+                const tensor& params = l.get_layer_params();
+                DLIB_CASSERT(params.size() != 0, "The network must be initialized before it can be compiled for inference.");
+                inference_op op = new_op(inference_op_type::conv);
+                op.num_filters = l.get_num_outputs();
+                const bool has_bias = l.get_bias_mode() == FC_HAS_BIAS;
+                op.filter_size = params.size()/op.num_filters - (has_bias ? 1 : 0);
+                // fc_ stores its weights as a num_inputs by num_outputs matrix, so the
+                // filters are its transpose.
+                op.float_filters.set_size(op.num_filters, op.filter_size);
+                op.float_filters = trans(dlib::mat(params.host(), op.filter_size, op.num_filters));
+                op.biases.set_size(1, op.num_filters);
+                if (has_bias)
+                    std::memcpy(op.biases.host(), params.host()+op.float_filters.size(), op.biases.size()*sizeof(float));
+                else
+                    op.biases = 0;
+                push(op);
+            }
+
+            void add(const relu_&)
+            {
+                add_relu();
+            }
+
+            void add(const affine_& l)
+            {
+                auto gamma = l.get_gamma();
+                auto beta = l.get_beta();
+                add_affine(gamma.get(), beta.get(), l.get_mode());
+            }
+
+            template <layer_mode mode>
+            void add(const bn_<mode>& l)
+            {
+                // Batch normalization is applied as it would be at inference time.
+                add(affine_(l));
+            }
+
+            template <long nr, long nc, int stride_y, int stride_x, int padding_y, int padding_x>
+            void add(const max_pool_<nr,nc,stride_y,stride_x,padding_y,padding_x>& l)
+            {
+                add_pooling(inference_op_type::max_pool, l);
+            }
+
+            template <long nr, long nc, int stride_y, int stride_x, int padding_y, int padding_x>
+            void add(const avg_pool_<nr,nc,stride_y,stride_x,padding_y,padding_x>& l)
+            {
+                add_pooling(inference_op_type::avg_pool, l);
+            }
+
+            template <template<typename> class tag>
+            void add(const add_prev_<tag>&)
+            {
+                inference_op op = new_op(inference_op_type::add_prev);
+                op.input2 = find_tag(add_prev_<tag>::id);
+                push(op);
+            }
+
+            template <typename T>
+            void add(const T& l)
+            {
+                std::ostringstream sout;
+                sout << l;
+                throw dlib::error("Can't compile the network for inference because the " + sout.str() + " layer isn't supported.");
+            }
+
+            template <typename T>
+            void add_pooling(inference_op_type type, const T& l)
+            {
+                inference_op op = new_op(type);
+                op.nr = l.nr();
+                op.nc = l.nc();
+                op.stride_y = l.stride_y();
+                op.stride_x = l.stride_x();
+                op.padding_y = l.padding_y();
+                op.padding_x = l.padding_x();
+                push(op);
+            }
+
+            inference_op* foldable_op (
+            )
+            /*!
+                ensures
+                    - returns the op that produced the current output if the following
+                      layer can be folded into it.  That is, if nothing else reads its
+                      output and it doesn't already end with a relu.
+                    - returns nullptr otherwise.
+            !*/
+            {
+                if (graph.ops.empty())
+                    return nullptr;
+                inference_op& prev = graph.ops.back();
+                if (prev.relu || prev.output != graph.output_buffer || tagged.count(graph.output_buffer) != 0)
+                    return nullptr;
+                return &prev;
+            }
+
+            long find_tag (
+                unsigned long id
+            ) const
+            {
+                auto i = tags.find(id);
+                DLIB_CASSERT(i != tags.end(), "Tag " << id << " not found in the network.");
+                return i->second;
+            }
+
+            inference_graph& graph;
+            std::map<unsigned long,long> tags;
+            std::set<long> tagged;
+        };
+
+        template <typename net_type>
+        void build_inference_graph (
+            const net_type& net,
+            inference_graph& graph
+        )
+        {
+            graph = inference_graph();
+            visit_layers_backwards(net, inference_graph_builder(graph));
+            graph.plan_buffers();
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    class inference_net;
+
+    template <typename net_type>
+    inference_net compile_for_inference (
+        const net_type& net,
+        storage_precision precision = storage_precision::float32
+    );
+
+    // Defined in onnx.h
+    inline inference_net import_from_onnx (
+        std::istream& in
+    );
+
+// ----------------------------------------------------------------------------------------
+
+    class inference_net
+    {
+    public:
+
+        inference_net(
+        ) = default;
+
+        const tensor& forward (
+            const tensor& x
+        )
+        {
+            DLIB_CASSERT(num_ops() != 0);
+            return graph->run(x, buffers);
+        }
+
+        size_t num_ops (
+        ) const { return graph ? graph->ops.size() : 0; }
+
+        size_t peak_memory_usage (
+        ) const { return buffers.peak_memory_usage(); }
+
+        friend void serialize(const inference_net& item, std::ostream& out)
+        {
+            serialize("inference_net", out);
+            serialize(item.graph ? *item.graph : impl::inference_graph(), out);
+        }
+
+        friend void deserialize(inference_net& item, std::istream& in)
+        {
+            std::string version;
+            deserialize(version, in);
+            if (version != "inference_net")
+                throw serialization_error("Unexpected version '"+version+"' found while deserializing dlib::inference_net.");
+            auto graph = std::make_shared<impl::inference_graph>();
+            deserialize(*graph, in);
+            item.graph = graph;
+            item.buffers.clear();
+        }
+
+        friend std::ostream& operator<< (std::ostream& out, const inference_net& item)
+        {
+            if (item.graph)
+                out << *item.graph;
+            return out;
+        }
+
+    private:
+        template <typename net_type>
+        friend inference_net compile_for_inference(const net_type& net, storage_precision precision);
+        friend inference_net import_from_onnx(std::istream& in);
+
+        // The graph is never modified once it's built, so copies of this object share it.
+        std::shared_ptr<const impl::inference_graph> graph;
+        impl::inference_buffers buffers;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename net_type>
+    inference_net compile_for_inference (
+        const net_type& net,
+        storage_precision precision
+    )
+    {
+        auto graph = std::make_shared<impl::inference_graph>();
+        impl::build_inference_graph(net, *graph);
+        graph->use_reduced_precision(precision);
+        inference_net inet;
+        inet.graph = graph;
+        return inet;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        class inference_output
+        {
+            /*!
+                This object stands in for the subnetwork given to a loss layer's
+                to_label(), for the loss layers that only look at its output.
+            !*/
+        public:
+            explicit inference_output(const tensor& output_) : output(output_) {}
+
+            const tensor& get_output() const { return output; }
+            unsigned int sample_expansion_factor() const { return 1; }
+
+        private:
+            const tensor& output;
+        };
+    }
+
+    template <
+        typename net_type
+        >
+    class shared_inference_net
+    {
+    public:
+
+        typedef typename net_type::input_type input_type;
+        typedef typename net_type::output_label_type output_label_type;
+
+        explicit shared_inference_net (
+            const net_type& net
+        ) :
+            input(input_layer(net)),
+            loss(net.loss_details()),
+            inet(compile_for_inference(net))
+        {}
+
+        shared_inference_net(const shared_inference_net&) = delete;
+        shared_inference_net& operator=(const shared_inference_net&) = delete;
+
+        output_label_type operator() (
+            const input_type& x
+        ) const
+        {
+            output_label_type label;
+            process(&x, &x+1, &label, 1);
+            return label;
+        }
+
+        template <typename iterable_type>
+        std::vector<output_label_type> operator() (
+            const iterable_type& data,
+            size_t batch_size = 128
+        ) const
+        {
+            DLIB_CASSERT(batch_size > 0);
+            std::vector<output_label_type> results(std::distance(data.begin(), data.end()));
+            process(data.begin(), data.end(), results.begin(), batch_size);
+            return results;
+        }
+
+        size_t num_contexts (
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            return num_created;
+        }
+
+        size_t num_ops (
+        ) const { return inet.num_ops(); }
+
+    private:
+
+        struct context
+        {
+            inference_net net;
+            resizable_tensor x;
+        };
+
+        template <typename forward_iterator, typename output_iterator>
+        void process (
+            forward_iterator ibegin,
+            forward_iterator iend,
+            output_iterator obegin,
+            size_t batch_size
+        ) const
+        {
+            // Borrow a context for the duration of this call, or make a new one if every
+            // existing context is being used by some other thread.
+            struct lease
+            {
+                lease(const shared_inference_net& owner_) : owner(owner_)
+                {
+                    std::lock_guard<std::mutex> lock(owner.m);
+                    if (owner.free_contexts.empty())
+                    {
+                        ctx.reset(new context{owner.inet, resizable_tensor()});
+                        ++owner.num_created;
+                    }
+                    else
+                    {
+                        ctx = std::move(owner.free_contexts.back());
+                        owner.free_contexts.pop_back();
+                    }
+                }
+                ~lease()
+                {
+                    std::lock_guard<std::mutex> lock(owner.m);
+                    owner.free_contexts.push_back(std::move(ctx));
+                }
+                const shared_inference_net& owner;
+                std::unique_ptr<context> ctx;
+            } l(*this);
+
+            while (ibegin != iend)
+            {
+                const auto num = std::min<size_t>(batch_size, std::distance(ibegin, iend));
+                const auto end = std::next(ibegin, num);
+                input.to_tensor(ibegin, end, l.ctx->x);
+                const impl::inference_output sub(l.ctx->net.forward(l.ctx->x));
+                loss.to_label(l.ctx->x, sub, obegin);
+                ibegin = end;
+                std::advance(obegin, num);
+            }
+        }
+
+        typedef typename std::decay<decltype(input_layer(std::declval<const net_type&>()))>::type input_layer_type;
+        typedef typename net_type::loss_details_type loss_details_type;
+
+        const input_layer_type input;
+        const loss_details_type loss;
+        const inference_net inet;
+
+        mutable std::mutex m;
+        mutable std::vector<std::unique_ptr<context>> free_contexts;
+        mutable size_t num_created = 0;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_INFERENCE_H_
+
@@ -0,0 +1,266 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DNn_INFERENCE_ABSTRACT_H_
+#ifdef DLIB_DNn_INFERENCE_ABSTRACT_H_
+
+#include "core_abstract.h"
+#include "layers_abstract.h"
+#include "../cuda/reduced_precision_abstract.h"
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class inference_net
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object is an immutable, inference only copy of a trained deep neural
+                network.  You create one with compile_for_inference() and then use it in
+                place of the original network's subnet().forward().  It computes the same
+                thing, but with fewer passes over memory and using less of it.  You can
+                also create one from a model trained elsewhere with import_from_onnx().
+
+                In particular, when the network is compiled:
+                    - Each bn_ layer is turned into the affine_ layer it's equivalent to
+                      at inference time.
+                    - Any affine_ or bn_ layer that directly follows a con_ or fc_ layer is
+                      folded into that layer's filters and biases, so it costs nothing.
+                    - Any relu_ layer that directly follows a con_, fc_, affine_ or
+                      add_prev_ layer is applied while that layer writes its output rather
+                      than as a separate pass.
+                    - The outputs of all the operations live in one block of memory and
+                      share it whenever they aren't needed at the same time.  A relu_ or
+                      affine_ layer that can't be folded into the layer before it writes
+                      over its input when nothing else needs that input.  So the memory
+                      used is roughly the largest set of outputs needed at any one time,
+                      while the original network keeps the output of every layer.  This
+                      is worked out when forward() is first called and again whenever it
+                      is given an input with different dimensions, so it's cheapest to
+                      keep using the same mini-batch size.
+                A layer is not folded into the one before it if the output of that layer is
+                also referenced by a tag layer.
+
+                The supported layers are con_, fc_, relu_, affine_, bn_, max_pool_,
+                avg_pool_, add_prev_, tag layers and skip layers.  The computations always
+                happen on the CPU, even if dlib is using CUDA.
+
+            THREAD SAFETY
+                forward() modifies internal buffers, so you need one inference_net per
+                thread.  However, copying an inference_net is cheap.  The copies share
+                the same read only parameters and each only gets its own buffers, so the
+                usual way to run one network from many threads is to give each thread a
+                copy.  See also shared_inference_net, which does this for you.
+
+                The CPU kernels split their work over the threads selected by
+                set_dnn_cpu_num_threads().
+        !*/
+
+    public:
+
+        inference_net(
+        );
+        /*!
+            ensures
+                - #num_ops() == 0
+                - #peak_memory_usage() == 0
+        !*/
+
+        const tensor& forward (
+            const tensor& x
+        );
+        /*!
+            requires
+                - num_ops() != 0
+                - x has the form produced by the to_tensor() member of the network this
+                  object was created from.  The input to every fc_ layer must have the
+                  same size it had in that network.
+            ensures
+                - Runs x through the network and returns the result.  This is what the
+                  original network's subnet().get_output() (or get_output() for networks
+                  without a loss layer) would contain after a forward pass on x, up to
+                  floating point rounding.  Note that bn_ layers always use their running
+                  statistics, as they do when the original network is run on a single
+                  sample.
+                - The returned tensor is valid until the next call to forward() or until
+                  this object is modified.
+        !*/
+
+        size_t num_ops (
+        ) const;
+        /*!
+            ensures
+                - returns the number of operations this network runs for each call to
+                  forward().  Layers folded into another don't count and neither do tag
+                  and skip layers.
+        !*/
+
+        size_t peak_memory_usage (
+        ) const;
+        /*!
+            ensures
+                - returns the number of bytes of memory used to hold the outputs of the
+                  operations during the last call to forward(), or 0 if forward() hasn't
+                  been called since this object was created or deserialized.
+                  This doesn't include the input tensor given to forward().
+        !*/
+    };
+
+    void serialize(const inference_net& item, std::ostream& out);
+    void deserialize(inference_net& item, std::istream& in);
+    /*!
+        provides serialization support
+    !*/
+
+    std::ostream& operator<< (std::ostream& out, const inference_net& item);
+    /*!
+        ensures
+            - prints the operations item runs, one per line, so you can see which layers
+              were folded together.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    inference_net compile_for_inference (
+        const net_type& net,
+        storage_precision precision = storage_precision::float32
+    );
+    /*!
+        requires
+            - net_type is an object of type add_layer, add_loss_layer, add_skip_layer, or
+              add_tag_layer.  It contains only the layer types listed in the
+              inference_net documentation.
+            - net has been run forward at least once, so all its layers are allocated.
+        ensures
+            - returns an inference_net that computes the same thing as net.
+            - The returned network is independent of net.
+            - if (precision != storage_precision::float32) then
+                - The filters of the con_ and fc_ layers, after the layers after them
+                  are folded in, are stored in the 16 bit format precision, which
+                  halves the memory they use.  The arithmetic is still done with floats,
+                  so the outputs only differ from net's by the rounding of the filters.
+                - fc_ layers convert their weights to float a few rows at a time, just
+                  before using them.  Running an fc_ layer on a small mini-batch mostly
+                  consists of reading its weights, so this makes those layers faster.
+                  Converting float16 values is only fast if the compiler targets the
+                  F16C instructions, otherwise prefer bfloat16.
+                  con_ layers convert all their filters at the start of each forward()
+                  call, since a convolution does many operations per filter value.
+                - Biases and the parameters of affine_ and bn_ layers that aren't folded
+                  into another layer stay floats, as do the layer outputs.
+                - This is only a storage format for inference.  net is trained, and keeps
+                  its parameters, in float32, and the filters are rounded when the
+                  returned network is made.  This costs accuracy: bfloat16 keeps 8
+                  significant bits, about 2 decimal digits, and float16 keeps 11 but
+                  turns filter values of 65520 or more into infinity and ones below
+                  about 3e-8 into 0.  So check the returned network on held out data.
+                - While a con_ layer runs, forward() also holds a float copy of that
+                  layer's filters, which peak_memory_usage() doesn't include.  Only
+                  the memory used for storing the network is halved.
+        throws
+            - dlib::error if net contains a layer that inference_net doesn't support.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    class shared_inference_net
+    {
+        /*!
+            REQUIREMENTS ON net_type
+                - net_type is an add_loss_layer object whose subnetwork contains only the
+                  layer types listed in the inference_net documentation.
+                - The loss layer's to_label() only uses the get_output() and
+                  sample_expansion_factor() members of the subnetwork it's given.  This is
+                  true of most loss layers, e.g. loss_multiclass_log_ and loss_metric_, but
+                  not loss_mmod_.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object lets many threads run a trained network at the same time while
+                keeping only one copy of its parameters.  It holds the network compiled
+                into an inference_net, along with copies of its input and loss layers, and
+                then hands each thread that calls operator() an execution context of its
+                own.  A context holds only the memory the network needs for its layer
+                outputs.  Contexts are reused, so there are never more of them than the
+                largest number of threads that have called operator() at once.
+
+            THREAD SAFETY
+                It is safe to call the const members of this object from any number of
+                threads at the same time.
+        !*/
+
+    public:
+
+        typedef typename net_type::input_type input_type;
+        typedef typename net_type::output_label_type output_label_type;
+
+        explicit shared_inference_net (
+            const net_type& net
+        );
+        /*!
+            requires
+                - net has been run forward at least once, so all its layers are allocated.
+            ensures
+                - #num_contexts() == 0
+                - This object computes the same thing as net.  net isn't referenced after
+                  the constructor returns.
+            throws
+                - dlib::error if net contains a layer that inference_net doesn't support.
+        !*/
+
+        shared_inference_net(const shared_inference_net&) = delete;
+        shared_inference_net& operator=(const shared_inference_net&) = delete;
+
+        output_label_type operator() (
+            const input_type& x
+        ) const;
+        /*!
+            ensures
+                - runs x through the network and returns the output label, just like
+                  net(x) would for the net this object was made from.
+        !*/
+
+        template <typename iterable_type>
+        std::vector<output_label_type> operator() (
+            const iterable_type& data,
+            size_t batch_size = 128
+        ) const;
+        /*!
+            requires
+                - batch_size > 0
+                - data is a container of input_type objects.
+            ensures
+                - runs all the objects in data through the network, batch_size at a
+                  time, and returns their output labels in the same order, just like
+                  net(data, batch_size) would.  Note that bn_ layers always use their
+                  running statistics.
+        !*/
+
+        size_t num_contexts (
+        ) const;
+        /*!
+            ensures
+                - returns the number of execution contexts this object has created.
+        !*/
+
+        size_t num_ops (
+        ) const;
+        /*!
+            ensures
+                - returns the number of operations the compiled network runs.  See
+                  inference_net::num_ops().
+        !*/
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_INFERENCE_ABSTRACT_H_
+
@@ -341,6 +341,543 @@ namespace dlib
         >
     using con = add_layer<con_<num_filters,nr,nc,stride_y,stride_x>, SUBNET>;
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        long _num_filters,
+        long _nr,
+        long _nc,
+        int _stride_y,
+        int _stride_x,
+        long _num_groups,
+        int _padding_y = _stride_y!=1? 0 : _nr/2,
+        int _padding_x = _stride_x!=1? 0 : _nc/2
+        >
+    class grouped_con_
+    {
+    public:
+
+        static_assert(_num_filters > 0, "The number of filters must be > 0");
+        static_assert(_nr > 0, "The number of rows in a filter must be > 0");
+        static_assert(_nc > 0, "The number of columns in a filter must be > 0");
+        static_assert(_stride_y > 0, "The filter stride must be > 0");
+        static_assert(_stride_x > 0, "The filter stride must be > 0");
+        static_assert(_num_groups > 0, "The number of groups must be > 0");
+        static_assert(_num_filters%_num_groups == 0, "The number of filters must be a multiple of the number of groups");
+        static_assert(0 <= _padding_y && _padding_y < _nr, "The padding must be smaller than the filter size.");
+        static_assert(0 <= _padding_x && _padding_x < _nc, "The padding must be smaller than the filter size.");
+
+        grouped_con_(
+        ) :
+            learning_rate_multiplier(1),
+            weight_decay_multiplier(1),
+            bias_learning_rate_multiplier(1),
+            bias_weight_decay_multiplier(0)
+        {
+        }
+
+        long num_filters() const { return _num_filters; }
+        long num_groups() const { return _num_groups; }
+        long nr() const { return _nr; }
+        long nc() const { return _nc; }
+        long stride_y() const { return _stride_y; }
+        long stride_x() const { return _stride_x; }
+        long padding_y() const { return _padding_y; }
+        long padding_x() const { return _padding_x; }
+
+        double get_learning_rate_multiplier () const  { return learning_rate_multiplier; }
+        double get_weight_decay_multiplier () const   { return weight_decay_multiplier; }
+        void set_learning_rate_multiplier(double val) { learning_rate_multiplier = val; }
+        void set_weight_decay_multiplier(double val)  { weight_decay_multiplier  = val; }
+
+        double get_bias_learning_rate_multiplier () const  { return bias_learning_rate_multiplier; }
+        double get_bias_weight_decay_multiplier () const   { return bias_weight_decay_multiplier; }
+        void set_bias_learning_rate_multiplier(double val) { bias_learning_rate_multiplier = val; }
+        void set_bias_weight_decay_multiplier(double val)  { bias_weight_decay_multiplier  = val; }
+
+        inline dpoint map_input_to_output (
+            dpoint p
+        ) const
+        {
+            p.x() = (p.x()+padding_x()-nc()/2)/stride_x();
+            p.y() = (p.y()+padding_y()-nr()/2)/stride_y();
+            return p;
+        }
+
+        inline dpoint map_output_to_input (
+            dpoint p
+        ) const
+        {
+            p.x() = p.x()*stride_x() - padding_x() + nc()/2;
+            p.y() = p.y()*stride_y() - padding_y() + nr()/2;
+            return p;
+        }
+
+        grouped_con_ (
+            const grouped_con_& item
+        ) :
+            params(item.params),
+            filters(item.filters),
+            biases(item.biases),
+            learning_rate_multiplier(item.learning_rate_multiplier),
+            weight_decay_multiplier(item.weight_decay_multiplier),
+            bias_learning_rate_multiplier(item.bias_learning_rate_multiplier),
+            bias_weight_decay_multiplier(item.bias_weight_decay_multiplier)
+        {
+            // this->conv is non-copyable and basically stateless, so we have to write our
+            // own copy to avoid trying to copy it and getting an error.
+        }
+
+        grouped_con_& operator= (
+            const grouped_con_& item
+        )
+        {
+            if (this == &item)
+                return *this;
+
+            params = item.params;
+            filters = item.filters;
+            biases = item.biases;
+            learning_rate_multiplier = item.learning_rate_multiplier;
+            weight_decay_multiplier = item.weight_decay_multiplier;
+            bias_learning_rate_multiplier = item.bias_learning_rate_multiplier;
+            bias_weight_decay_multiplier = item.bias_weight_decay_multiplier;
+            return *this;
+        }
+
+        template <typename SUBNET>
+        void setup (const SUBNET& sub)
+        {
+            const long k = sub.get_output().k();
+            DLIB_CASSERT(k%_num_groups == 0,
+                "The number of input channels (" << k << ") must be a multiple of the number of groups (" << _num_groups << ").");
+
+            // Each filter only looks at the k/_num_groups channels in its own group.
+            long num_inputs = _nr*_nc*(k/_num_groups);
+            long num_outputs = _num_filters/_num_groups;
+            params.set_size(num_inputs*_num_filters + _num_filters);
+
+            dlib::rand rnd(std::rand());
+            randomize_parameters(params, num_inputs+num_outputs, rnd);
+
+            filters = alias_tensor(_num_filters, k/_num_groups, _nr, _nc);
+            biases = alias_tensor(1,_num_filters);
+
+            // set the initial bias values to zero
+            biases(params,filters.size()) = 0;
+        }
+
+        template <typename SUBNET>
+        void forward(const SUBNET& sub, resizable_tensor& output)
+        {
+            conv.setup(sub.get_output(),
+                       filters(params,0),
+                       _stride_y,
+                       _stride_x,
+                       _padding_y,
+                       _padding_x,
+                       _num_groups);
+            conv(false, output,
+                sub.get_output(),
+                filters(params,0));
+
+            tt::add(1,output,1,biases(params,filters.size()));
+        }
+
+        template <typename SUBNET>
+        void backward(const tensor& gradient_input, SUBNET& sub, tensor& params_grad)
+        {
+            conv.get_gradient_for_data (true, gradient_input, filters(params,0), sub.get_gradient_input());
+            if (learning_rate_multiplier != 0)
+            {
+                auto filt = filters(params_grad,0);
+                conv.get_gradient_for_filters (false, gradient_input, sub.get_output(), filt);
+                auto b = biases(params_grad, filters.size());
+                tt::assign_conv_bias_gradient(b, gradient_input);
+            }
+        }
+
+        const tensor& get_layer_params() const { return params; }
+        tensor& get_layer_params() { return params; }
+
+        friend void serialize(const grouped_con_& item, std::ostream& out)
+        {
+            serialize("grouped_con_", out);
+            serialize(item.params, out);
+            serialize(_num_filters, out);
+            serialize(_nr, out);
+            serialize(_nc, out);
+            serialize(_stride_y, out);
+            serialize(_stride_x, out);
+            serialize(_num_groups, out);
+            serialize(_padding_y, out);
+            serialize(_padding_x, out);
+            serialize(item.filters, out);
+            serialize(item.biases, out);
+            serialize(item.learning_rate_multiplier, out);
+            serialize(item.weight_decay_multiplier, out);
+            serialize(item.bias_learning_rate_multiplier, out);
+            serialize(item.bias_weight_decay_multiplier, out);
+        }
+
+        friend void deserialize(grouped_con_& item, std::istream& in)
+        {
+            std::string version;
+            deserialize(version, in);
+            if (version != "grouped_con_")
+                throw serialization_error("Unexpected version '"+version+"' found while deserializing dlib::grouped_con_.");
+
+            long num_filters;
+            long nr;
+            long nc;
+            int stride_y;
+            int stride_x;
+            long num_groups;
+            int padding_y;
+            int padding_x;
+            deserialize(item.params, in);
+            deserialize(num_filters, in);
+            deserialize(nr, in);
+            deserialize(nc, in);
+            deserialize(stride_y, in);
+            deserialize(stride_x, in);
+            deserialize(num_groups, in);
+            deserialize(padding_y, in);
+            deserialize(padding_x, in);
+            deserialize(item.filters, in);
+            deserialize(item.biases, in);
+            deserialize(item.learning_rate_multiplier, in);
+            deserialize(item.weight_decay_multiplier, in);
+            deserialize(item.bias_learning_rate_multiplier, in);
+            deserialize(item.bias_weight_decay_multiplier, in);
+            if (num_filters != _num_filters) throw serialization_error("Wrong num_filters found while deserializing dlib::grouped_con_");
+            if (nr != _nr) throw serialization_error("Wrong nr found while deserializing dlib::grouped_con_");
+            if (nc != _nc) throw serialization_error("Wrong nc found while deserializing dlib::grouped_con_");
+            if (stride_y != _stride_y) throw serialization_error("Wrong stride_y found while deserializing dlib::grouped_con_");
+            if (stride_x != _stride_x) throw serialization_error("Wrong stride_x found while deserializing dlib::grouped_con_");
+            if (num_groups != _num_groups) throw serialization_error("Wrong num_groups found while deserializing dlib::grouped_con_");
+            if (padding_y != _padding_y) throw serialization_error("Wrong padding_y found while deserializing dlib::grouped_con_");
+            if (padding_x != _padding_x) throw serialization_error("Wrong padding_x found while deserializing dlib::grouped_con_");
+        }
+
+        friend std::ostream& operator<<(std::ostream& out, const grouped_con_& item)
+        {
+            out << "grouped_con\t ("
+                << "num_filters="<<_num_filters
+                << ", nr="<<_nr
+                << ", nc="<<_nc
+                << ", stride_y="<<_stride_y
+                << ", stride_x="<<_stride_x
+                << ", num_groups="<<_num_groups
+                << ", padding_y="<<_padding_y
+                << ", padding_x="<<_padding_x
+                << ")";
+            out << " learning_rate_mult="<<item.learning_rate_multiplier;
+            out << " weight_decay_mult="<<item.weight_decay_multiplier;
+            out << " bias_learning_rate_mult="<<item.bias_learning_rate_multiplier;
+            out << " bias_weight_decay_mult="<<item.bias_weight_decay_multiplier;
+            return out;
+        }
+
+        friend void to_xml(const grouped_con_& item, std::ostream& out)
+        {
+            out << "<grouped_con"
+                << " num_filters='"<<_num_filters<<"'"
+                << " nr='"<<_nr<<"'"
+                << " nc='"<<_nc<<"'"
+                << " stride_y='"<<_stride_y<<"'"
+                << " stride_x='"<<_stride_x<<"'"
+                << " num_groups='"<<_num_groups<<"'"
+                << " padding_y='"<<_padding_y<<"'"
+                << " padding_x='"<<_padding_x<<"'"
+                << " learning_rate_mult='"<<item.learning_rate_multiplier<<"'"
+                << " weight_decay_mult='"<<item.weight_decay_multiplier<<"'"
+                << " bias_learning_rate_mult='"<<item.bias_learning_rate_multiplier<<"'"
+                << " bias_weight_decay_mult='"<<item.bias_weight_decay_multiplier<<"'>\n";
+            out << mat(item.params);
+            out << "</grouped_con>";
+        }
+
+    private:
+
+        resizable_tensor params;
+        alias_tensor filters, biases;
+
+        tt::tensor_conv conv;
+        double learning_rate_multiplier;
+        double weight_decay_multiplier;
+        double bias_learning_rate_multiplier;
+        double bias_weight_decay_multiplier;
+    };
+
+    template <
+        long num_filters,
+        long nr,
+        long nc,
+        int stride_y,
+        int stride_x,
+        long num_groups,
+        typename SUBNET
+        >
+    using grouped_con = add_layer<grouped_con_<num_filters,nr,nc,stride_y,stride_x,num_groups>, SUBNET>;
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        long _nr,
+        long _nc,
+        int _stride_y,
+        int _stride_x,
+        int _padding_y = _stride_y!=1? 0 : _nr/2,
+        int _padding_x = _stride_x!=1? 0 : _nc/2
+        >
+    class depthwise_con_
+    {
+    public:
+
+        static_assert(_nr > 0, "The number of rows in a filter must be > 0");
+        static_assert(_nc > 0, "The number of columns in a filter must be > 0");
+        static_assert(_stride_y > 0, "The filter stride must be > 0");
+        static_assert(_stride_x > 0, "The filter stride must be > 0");
+        static_assert(0 <= _padding_y && _padding_y < _nr, "The padding must be smaller than the filter size.");
+        static_assert(0 <= _padding_x && _padding_x < _nc, "The padding must be smaller than the filter size.");
+
+        depthwise_con_(
+        ) :
+            learning_rate_multiplier(1),
+            weight_decay_multiplier(1),
+            bias_learning_rate_multiplier(1),
+            bias_weight_decay_multiplier(0)
+        {
+        }
+
+        long num_channels() const { return filters.num_samples(); }
+        long nr() const { return _nr; }
+        long nc() const { return _nc; }
+        long stride_y() const { return _stride_y; }
+        long stride_x() const { return _stride_x; }
+        long padding_y() const { return _padding_y; }
+        long padding_x() const { return _padding_x; }
+
+        double get_learning_rate_multiplier () const  { return learning_rate_multiplier; }
+        double get_weight_decay_multiplier () const   { return weight_decay_multiplier; }
+        void set_learning_rate_multiplier(double val) { learning_rate_multiplier = val; }
+        void set_weight_decay_multiplier(double val)  { weight_decay_multiplier  = val; }
+
+        double get_bias_learning_rate_multiplier () const  { return bias_learning_rate_multiplier; }
+        double get_bias_weight_decay_multiplier () const   { return bias_weight_decay_multiplier; }
+        void set_bias_learning_rate_multiplier(double val) { bias_learning_rate_multiplier = val; }
+        void set_bias_weight_decay_multiplier(double val)  { bias_weight_decay_multiplier  = val; }
+
+        inline dpoint map_input_to_output (
+            dpoint p
+        ) const
+        {
+            p.x() = (p.x()+padding_x()-nc()/2)/stride_x();
+            p.y() = (p.y()+padding_y()-nr()/2)/stride_y();
+            return p;
+        }
+
+        inline dpoint map_output_to_input (
+            dpoint p
+        ) const
+        {
+            p.x() = p.x()*stride_x() - padding_x() + nc()/2;
+            p.y() = p.y()*stride_y() - padding_y() + nr()/2;
+            return p;
+        }
+
+        depthwise_con_ (
+            const depthwise_con_& item
+        ) :
+            params(item.params),
+            filters(item.filters),
+            biases(item.biases),
+            learning_rate_multiplier(item.learning_rate_multiplier),
+            weight_decay_multiplier(item.weight_decay_multiplier),
+            bias_learning_rate_multiplier(item.bias_learning_rate_multiplier),
+            bias_weight_decay_multiplier(item.bias_weight_decay_multiplier)
+        {
+            // this->conv is non-copyable and basically stateless, so we have to write our
+            // own copy to avoid trying to copy it and getting an error.
+        }
+
+        depthwise_con_& operator= (
+            const depthwise_con_& item
+        )
+        {
+            if (this == &item)
+                return *this;
+
+            params = item.params;
+            filters = item.filters;
+            biases = item.biases;
+            learning_rate_multiplier = item.learning_rate_multiplier;
+            weight_decay_multiplier = item.weight_decay_multiplier;
+            bias_learning_rate_multiplier = item.bias_learning_rate_multiplier;
+            bias_weight_decay_multiplier = item.bias_weight_decay_multiplier;
+            return *this;
+        }
+
+        template <typename SUBNET>
+        void setup (const SUBNET& sub)
+        {
+            // One filter per input channel, so there are as many groups as channels.
+            const long k = sub.get_output().k();
+            long num_inputs = _nr*_nc;
+            long num_outputs = 1;
+            params.set_size(num_inputs*k + k);
+
+            dlib::rand rnd(std::rand());
+            randomize_parameters(params, num_inputs+num_outputs, rnd);
+
+            filters = alias_tensor(k, 1, _nr, _nc);
+            biases = alias_tensor(1,k);
+
+            // set the initial bias values to zero
+            biases(params,filters.size()) = 0;
+        }
+
+        template <typename SUBNET>
+        void forward(const SUBNET& sub, resizable_tensor& output)
+        {
+            conv.setup(sub.get_output(),
+                       filters(params,0),
+                       _stride_y,
+                       _stride_x,
+                       _padding_y,
+                       _padding_x,
+                       filters.num_samples());
+            conv(false, output,
+                sub.get_output(),
+                filters(params,0));
+
+            tt::add(1,output,1,biases(params,filters.size()));
+        }
+
+        template <typename SUBNET>
+        void backward(const tensor& gradient_input, SUBNET& sub, tensor& params_grad)
+        {
+            conv.get_gradient_for_data (true, gradient_input, filters(params,0), sub.get_gradient_input());
+            if (learning_rate_multiplier != 0)
+            {
+                auto filt = filters(params_grad,0);
+                conv.get_gradient_for_filters (false, gradient_input, sub.get_output(), filt);
+                auto b = biases(params_grad, filters.size());
+                tt::assign_conv_bias_gradient(b, gradient_input);
+            }
+        }
+
+        const tensor& get_layer_params() const { return params; }
+        tensor& get_layer_params() { return params; }
+
+        friend void serialize(const depthwise_con_& item, std::ostream& out)
+        {
+            serialize("depthwise_con_", out);
+            serialize(item.params, out);
+            serialize(_nr, out);
+            serialize(_nc, out);
+            serialize(_stride_y, out);
+            serialize(_stride_x, out);
+            serialize(_padding_y, out);
+            serialize(_padding_x, out);
+            serialize(item.filters, out);
+            serialize(item.biases, out);
+            serialize(item.learning_rate_multiplier, out);
+            serialize(item.weight_decay_multiplier, out);
+            serialize(item.bias_learning_rate_multiplier, out);
+            serialize(item.bias_weight_decay_multiplier, out);
+        }
+
+        friend void deserialize(depthwise_con_& item, std::istream& in)
+        {
+            std::string version;
+            deserialize(version, in);
+            if (version != "depthwise_con_")
+                throw serialization_error("Unexpected version '"+version+"' found while deserializing dlib::depthwise_con_.");
+
+            long nr;
+            long nc;
+            int stride_y;
+            int stride_x;
+            int padding_y;
+            int padding_x;
+            deserialize(item.params, in);
+            deserialize(nr, in);
+            deserialize(nc, in);
+            deserialize(stride_y, in);
+            deserialize(stride_x, in);
+            deserialize(padding_y, in);
+            deserialize(padding_x, in);
+            deserialize(item.filters, in);
+            deserialize(item.biases, in);
+            deserialize(item.learning_rate_multiplier, in);
+            deserialize(item.weight_decay_multiplier, in);
+            deserialize(item.bias_learning_rate_multiplier, in);
+            deserialize(item.bias_weight_decay_multiplier, in);
+            if (nr != _nr) throw serialization_error("Wrong nr found while deserializing dlib::depthwise_con_");
+            if (nc != _nc) throw serialization_error("Wrong nc found while deserializing dlib::depthwise_con_");
+            if (stride_y != _stride_y) throw serialization_error("Wrong stride_y found while deserializing dlib::depthwise_con_");
+            if (stride_x != _stride_x) throw serialization_error("Wrong stride_x found while deserializing dlib::depthwise_con_");
+            if (padding_y != _padding_y) throw serialization_error("Wrong padding_y found while deserializing dlib::depthwise_con_");
+            if (padding_x != _padding_x) throw serialization_error("Wrong padding_x found while deserializing dlib::depthwise_con_");
+        }
+
+        friend std::ostream& operator<<(std::ostream& out, const depthwise_con_& item)
+        {
+            out << "depthwise_con\t ("
+                << "nr="<<_nr
+                << ", nc="<<_nc
+                << ", stride_y="<<_stride_y
+                << ", stride_x="<<_stride_x
+                << ", padding_y="<<_padding_y
+                << ", padding_x="<<_padding_x
+                << ")";
+            out << " learning_rate_mult="<<item.learning_rate_multiplier;
+            out << " weight_decay_mult="<<item.weight_decay_multiplier;
+            out << " bias_learning_rate_mult="<<item.bias_learning_rate_multiplier;
+            out << " bias_weight_decay_mult="<<item.bias_weight_decay_multiplier;
+            return out;
+        }
+
+        friend void to_xml(const depthwise_con_& item, std::ostream& out)
+        {
+            out << "<depthwise_con"
+                << " nr='"<<_nr<<"'"
+                << " nc='"<<_nc<<"'"
+                << " stride_y='"<<_stride_y<<"'"
+                << " stride_x='"<<_stride_x<<"'"
+                << " padding_y='"<<_padding_y<<"'"
+                << " padding_x='"<<_padding_x<<"'"
+                << " learning_rate_mult='"<<item.learning_rate_multiplier<<"'"
+                << " weight_decay_mult='"<<item.weight_decay_multiplier<<"'"
+                << " bias_learning_rate_mult='"<<item.bias_learning_rate_multiplier<<"'"
+                << " bias_weight_decay_mult='"<<item.bias_weight_decay_multiplier<<"'>\n";
+            out << mat(item.params);
+            out << "</depthwise_con>";
+        }
+
+    private:
+
+        resizable_tensor params;
+        alias_tensor filters, biases;
+
+        tt::tensor_conv conv;
+        double learning_rate_multiplier;
+        double weight_decay_multiplier;
+        double bias_learning_rate_multiplier;
+        double bias_weight_decay_multiplier;
+    };
+
+    template <
+        long nr,
+        long nc,
+        int stride_y,
+        int stride_x,
+        typename SUBNET
+        >
+    using depthwise_con = add_layer<depthwise_con_<nr,nc,stride_y,stride_x>, SUBNET>;
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -2045,6 +2582,11 @@ namespace dlib
 
         layer_mode get_mode() const { return mode; }
 
+        alias_tensor_const_instance get_gamma() const { return gamma(params,0); }
+        alias_tensor_instance get_gamma() { return gamma(params,0); }
+        alias_tensor_const_instance get_beta() const { return beta(params,gamma.size()); }
+        alias_tensor_instance get_beta() { return beta(params,gamma.size()); }
+
         inline dpoint map_input_to_output (const dpoint& p) const { return p; }
         inline dpoint map_output_to_input (const dpoint& p) const { return p; }
 
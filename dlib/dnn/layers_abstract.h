@@ -926,6 +926,308 @@ namespace dlib
         >
     using con = add_layer<con_<num_filters,nr,nc,stride_y,stride_x>, SUBNET>;
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        long _num_filters,
+        long _nr,
+        long _nc,
+        int _stride_y,
+        int _stride_x,
+        long _num_groups,
+        int _padding_y = _stride_y!=1? 0 : _nr/2,
+        int _padding_x = _stride_x!=1? 0 : _nc/2
+        >
+    class grouped_con_
+    {
+        /*!
+            REQUIREMENTS ON TEMPLATE ARGUMENTS
+                - _num_filters > 0
+                - _nr > 0
+                - _nc > 0
+                - _stride_y > 0
+                - _stride_x > 0
+                - _num_groups > 0
+                - _num_filters % _num_groups == 0
+                - 0 <= _padding_y < _nr
+                - 0 <= _padding_x < _nc
+
+            WHAT THIS OBJECT REPRESENTS
+                This is an implementation of the EXAMPLE_COMPUTATIONAL_LAYER_ interface
+                defined above.  In particular, it defines a grouped convolution layer.
+                This is just like con_ except that the input channels are split into
+                _num_groups equally sized groups, and so are the filters.  Each filter
+                only looks at the channels in its own group, so the layer has
+                _num_groups times fewer parameters and does _num_groups times less work
+                than a con_ with the same number of filters.  Setting _num_groups to 1
+                gives the same result as con_.
+
+                The number of channels in the input tensor must be a multiple of
+                _num_groups.  The dimensions of the tensors output by this layer are as
+                follows (letting IN be the input tensor and OUT the output tensor):
+                    - OUT.num_samples() == IN.num_samples()
+                    - OUT.k()  == num_filters()
+                    - OUT.nr() == 1+(IN.nr() + 2*padding_y() - nr())/stride_y()
+                    - OUT.nc() == 1+(IN.nc() + 2*padding_x() - nc())/stride_x()
+                and channel i of OUT only depends on the channels of IN in the range
+                [g*IN.k()/_num_groups, (g+1)*IN.k()/_num_groups), where
+                g == i/(num_filters()/_num_groups).
+        !*/
+
+    public:
+        grouped_con_(
+        );
+        /*!
+            ensures
+                - #num_filters() == _num_filters
+                - #num_groups() == _num_groups
+                - #nr() == _nr
+                - #nc() == _nc
+                - #stride_y() == _stride_y
+                - #stride_x() == _stride_x
+                - #padding_y() == _padding_y
+                - #padding_x() == _padding_x
+                - #get_learning_rate_multiplier()      == 1
+                - #get_weight_decay_multiplier()       == 1
+                - #get_bias_learning_rate_multiplier() == 1
+                - #get_bias_weight_decay_multiplier()  == 0
+        !*/
+
+        long num_filters(
+        ) const; 
+        /*!
+            ensures
+                - returns the number of filters contained in this layer.  The k dimension
+                  of the output tensors produced by this layer will be equal to the number
+                  of filters.
+        !*/
+
+        long num_groups(
+        ) const; 
+        /*!
+            ensures
+                - returns the number of groups the input channels and the filters are
+                  split into.
+        !*/
+
+        long nr(
+        ) const; 
+        /*!
+            ensures
+                - returns the number of rows in the filters in this layer.
+        !*/
+
+        long nc(
+        ) const;
+        /*!
+            ensures
+                - returns the number of columns in the filters in this layer.
+        !*/
+
+        long stride_y(
+        ) const; 
+        /*!
+            ensures
+                - returns the vertical stride used when convolving the filters over an
+                  image.
+        !*/
+
+        long stride_x(
+        ) const;
+        /*!
+            ensures
+                - returns the horizontal stride used when convolving the filters over an
+                  image.
+        !*/
+
+        long padding_y(
+        ) const; 
+        /*!
+            ensures
+                - returns the number of pixels of zero padding added to the top and bottom
+                  sides of the image.
+        !*/
+
+        long padding_x(
+        ) const; 
+        /*!
+            ensures
+                - returns the number of pixels of zero padding added to the left and right 
+                  sides of the image.
+        !*/
+
+        double get_learning_rate_multiplier(
+        ) const;  
+        double get_weight_decay_multiplier(
+        ) const; 
+        void set_learning_rate_multiplier(
+            double val
+        );
+        void set_weight_decay_multiplier(
+            double val
+        ); 
+        double get_bias_learning_rate_multiplier(
+        ) const; 
+        double get_bias_weight_decay_multiplier(
+        ) const; 
+        void set_bias_learning_rate_multiplier(
+            double val
+        ); 
+        void set_bias_weight_decay_multiplier(
+            double val
+        ); 
+        /*!
+            These functions behave just like the ones with the same names in con_.
+        !*/
+
+        template <typename SUBNET> void setup (const SUBNET& sub);
+        template <typename SUBNET> void forward(const SUBNET& sub, resizable_tensor& output);
+        template <typename SUBNET> void backward(const tensor& gradient_input, SUBNET& sub, tensor& params_grad);
+        dpoint map_input_to_output(dpoint p) const;
+        dpoint map_output_to_input(dpoint p) const;
+        const tensor& get_layer_params() const; 
+        tensor& get_layer_params(); 
+        /*!
+            These functions are implemented as described in the EXAMPLE_COMPUTATIONAL_LAYER_ interface.
+        !*/
+
+    };
+
+    template <
+        long num_filters,
+        long nr,
+        long nc,
+        int stride_y,
+        int stride_x,
+        long num_groups,
+        typename SUBNET
+        >
+    using grouped_con = add_layer<grouped_con_<num_filters,nr,nc,stride_y,stride_x,num_groups>, SUBNET>;
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        long _nr,
+        long _nc,
+        int _stride_y,
+        int _stride_x,
+        int _padding_y = _stride_y!=1? 0 : _nr/2,
+        int _padding_x = _stride_x!=1? 0 : _nc/2
+        >
+    class depthwise_con_
+    {
+        /*!
+            REQUIREMENTS ON TEMPLATE ARGUMENTS
+                - _nr > 0
+                - _nc > 0
+                - _stride_y > 0
+                - _stride_x > 0
+                - 0 <= _padding_y < _nr
+                - 0 <= _padding_x < _nc
+
+            WHAT THIS OBJECT REPRESENTS
+                This is an implementation of the EXAMPLE_COMPUTATIONAL_LAYER_ interface
+                defined above.  In particular, it defines a depthwise convolution layer,
+                which convolves each channel of its input with its own _nr by _nc filter.
+                That is, it is a grouped_con_ with as many groups and filters as there
+                are input channels.  Following it with a 1x1 con_ gives the depthwise
+                separable convolutions used by networks like MobileNet, which need far
+                fewer parameters and operations than a full con_ with the same receptive
+                field.
+
+                The dimensions of the tensors output by this layer are as follows (letting
+                IN be the input tensor and OUT the output tensor):
+                    - OUT.num_samples() == IN.num_samples()
+                    - OUT.k()  == IN.k()
+                    - OUT.nr() == 1+(IN.nr() + 2*padding_y() - nr())/stride_y()
+                    - OUT.nc() == 1+(IN.nc() + 2*padding_x() - nc())/stride_x()
+        !*/
+
+    public:
+        depthwise_con_(
+        );
+        /*!
+            ensures
+                - #num_channels() == 0
+                - #nr() == _nr
+                - #nc() == _nc
+                - #stride_y() == _stride_y
+                - #stride_x() == _stride_x
+                - #padding_y() == _padding_y
+                - #padding_x() == _padding_x
+                - #get_learning_rate_multiplier()      == 1
+                - #get_weight_decay_multiplier()       == 1
+                - #get_bias_learning_rate_multiplier() == 1
+                - #get_bias_weight_decay_multiplier()  == 0
+        !*/
+
+        long num_channels(
+        ) const; 
+        /*!
+            ensures
+                - returns the number of channels this layer convolves, which is the number
+                  of filters it contains.  This is 0 until setup() has been called, after
+                  which it is the k() of the input tensor.
+        !*/
+
+        long nr(
+        ) const; 
+        long nc(
+        ) const;
+        long stride_y(
+        ) const; 
+        long stride_x(
+        ) const;
+        long padding_y(
+        ) const; 
+        long padding_x(
+        ) const; 
+        double get_learning_rate_multiplier(
+        ) const;  
+        double get_weight_decay_multiplier(
+        ) const; 
+        void set_learning_rate_multiplier(
+            double val
+        );
+        void set_weight_decay_multiplier(
+            double val
+        ); 
+        double get_bias_learning_rate_multiplier(
+        ) const; 
+        double get_bias_weight_decay_multiplier(
+        ) const; 
+        void set_bias_learning_rate_multiplier(
+            double val
+        ); 
+        void set_bias_weight_decay_multiplier(
+            double val
+        ); 
+        /*!
+            These functions behave just like the ones with the same names in con_.
+        !*/
+
+        template <typename SUBNET> void setup (const SUBNET& sub);
+        template <typename SUBNET> void forward(const SUBNET& sub, resizable_tensor& output);
+        template <typename SUBNET> void backward(const tensor& gradient_input, SUBNET& sub, tensor& params_grad);
+        dpoint map_input_to_output(dpoint p) const;
+        dpoint map_output_to_input(dpoint p) const;
+        const tensor& get_layer_params() const; 
+        tensor& get_layer_params(); 
+        /*!
+            These functions are implemented as described in the EXAMPLE_COMPUTATIONAL_LAYER_ interface.
+        !*/
+
+    };
+
+    template <
+        long nr,
+        long nc,
+        int stride_y,
+        int stride_x,
+        typename SUBNET
+        >
+    using depthwise_con = add_layer<depthwise_con_<nr,nc,stride_y,stride_x>, SUBNET>;
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -1692,6 +1994,31 @@ namespace dlib
                 - returns the mode of this layer, either CONV_MODE or FC_MODE.  
         !*/
 
+        alias_tensor_const_instance get_gamma(
+        ) const;
+        alias_tensor_instance get_gamma(
+        );
+        /*!
+            requires
+                - setup() has been called, or this object was constructed from a bn_.
+            ensures
+                - returns the A tensor this layer multiplies its input by.  If
+                  get_mode()==CONV_MODE it has k() equal to the number of channels and all
+                  other dimensions set to 1.
+        !*/
+
+        alias_tensor_const_instance get_beta(
+        ) const;
+        alias_tensor_instance get_beta(
+        );
+        /*!
+            requires
+                - setup() has been called, or this object was constructed from a bn_.
+            ensures
+                - returns the B tensor this layer adds to its output.  It always has the
+                  same dimensions as get_gamma().
+        !*/
+
         template <typename SUBNET> void setup (const SUBNET& sub);
         void forward_inplace(const tensor& input, tensor& output);
         void backward_inplace(const tensor& computed_output, const tensor& gradient_input, tensor& data_grad, tensor& params_grad);
@@ -9,6 +9,7 @@
 #include "../cuda/tensor_tools.h"
 #include "../geometry.h"
 #include "../image_processing/box_overlap_testing.h"
+#include "../image_processing/non_max_suppression.h"
 #include "../image_processing/full_object_detection.h"
 #include "../svm/ranking_tools.h"
 #include <sstream>
@@ -1067,18 +1068,19 @@ namespace dlib
             DLIB_CASSERT(sub.sample_expansion_factor() == 1,  sub.sample_expansion_factor());
 
             std::vector<intermediate_detection> dets_accum;
+            std::vector<rectangle> boxes;
             output_label_type final_dets;
             for (long i = 0; i < output_tensor.num_samples(); ++i)
             {
                 tensor_to_dets(input_tensor, output_tensor, i, dets_accum, adjust_threshold, sub);
 
                 // Do non-max suppression
+                boxes.clear();
+                for (auto&& d : dets_accum)
+                    boxes.push_back(d.rect_bbr);
                 final_dets.clear();
-                for (unsigned long i = 0; i < dets_accum.size(); ++i)
+                for (auto i : non_max_suppression(options.overlaps_nms, boxes))
                 {
-                    if (overlaps_any_box_nms(final_dets, dets_accum[i].rect_bbr))
-                        continue;
-
                     final_dets.push_back(mmod_rect(dets_accum[i].rect_bbr,
                                                    dets_accum[i].detection_confidence,
                                                    options.detector_windows[dets_accum[i].tensor_channel].label));
@@ -1448,44 +1450,42 @@ namespace dlib
             const float* out_data = output_tensor.host() + output_tensor.k()*output_tensor.nr()*output_tensor.nc()*i;
             // scan the final layer and output the positive scoring locations
             dets_accum.clear();
-            for (long k = 0; k < (long)options.detector_windows.size(); ++k)
+            const long plane_size = output_tensor.nr()*output_tensor.nc();
+            std::vector<unsigned long> positives;
+            find_scores_above_threshold(out_data, options.detector_windows.size()*plane_size, adjust_threshold, positives);
+            for (auto idx : positives)
             {
-                for (long r = 0; r < output_tensor.nr(); ++r)
-                {
-                    for (long c = 0; c < output_tensor.nc(); ++c)
-                    {
-                        double score = out_data[(k*output_tensor.nr() + r)*output_tensor.nc() + c];
-                        if (score > adjust_threshold)
-                        {
-                            dpoint p = output_tensor_to_input_tensor(net, point(c,r));
-                            drectangle rect = centered_drect(p, options.detector_windows[k].width, options.detector_windows[k].height);
-                            rect = input_layer(net).tensor_space_to_image_space(input_tensor,rect);
+                const long k = idx/plane_size;
+                const long r = (idx%plane_size)/output_tensor.nc();
+                const long c = idx%output_tensor.nc();
+                double score = out_data[idx];
 
-                            dets_accum.push_back(intermediate_detection(rect, score, (k*output_tensor.nr() + r)*output_tensor.nc() + c, k));
+                dpoint p = output_tensor_to_input_tensor(net, point(c,r));
+                drectangle rect = centered_drect(p, options.detector_windows[k].width, options.detector_windows[k].height);
+                rect = input_layer(net).tensor_space_to_image_space(input_tensor,rect);
 
-                            if (options.use_bounding_box_regression)
-                            {
-                                const auto offset = options.detector_windows.size() + k*4;
-                                dets_accum.back().tensor_offset_dx = ((offset+0)*output_tensor.nr() + r)*output_tensor.nc() + c;
-                                dets_accum.back().tensor_offset_dy = ((offset+1)*output_tensor.nr() + r)*output_tensor.nc() + c;
-                                dets_accum.back().tensor_offset_dw = ((offset+2)*output_tensor.nr() + r)*output_tensor.nc() + c;
-                                dets_accum.back().tensor_offset_dh = ((offset+3)*output_tensor.nr() + r)*output_tensor.nc() + c;
-
-                                // apply BBR to dets_accum.back()
-                                double dx = out_data[dets_accum.back().tensor_offset_dx];
-                                double dy = out_data[dets_accum.back().tensor_offset_dy];
-                                double dw = out_data[dets_accum.back().tensor_offset_dw];
-                                double dh = out_data[dets_accum.back().tensor_offset_dh];
-                                dw = std::exp(dw);
-                                dh = std::exp(dh);
-                                double w = rect.width()-1;
-                                double h = rect.height()-1;
-                                rect = translate_rect(rect, dpoint(dx*w,dy*h));
-                                rect = centered_drect(rect, w*dw+1, h*dh+1);
-                                dets_accum.back().rect_bbr = rect;
-                            }
-                        }
-                    }
+                dets_accum.push_back(intermediate_detection(rect, score, idx, k));
+
+                if (options.use_bounding_box_regression)
+                {
+                    const auto offset = options.detector_windows.size() + k*4;
+                    dets_accum.back().tensor_offset_dx = ((offset+0)*output_tensor.nr() + r)*output_tensor.nc() + c;
+                    dets_accum.back().tensor_offset_dy = ((offset+1)*output_tensor.nr() + r)*output_tensor.nc() + c;
+                    dets_accum.back().tensor_offset_dw = ((offset+2)*output_tensor.nr() + r)*output_tensor.nc() + c;
+                    dets_accum.back().tensor_offset_dh = ((offset+3)*output_tensor.nr() + r)*output_tensor.nc() + c;
+
+                    // apply BBR to dets_accum.back()
+                    double dx = out_data[dets_accum.back().tensor_offset_dx];
+                    double dy = out_data[dets_accum.back().tensor_offset_dy];
+                    double dw = out_data[dets_accum.back().tensor_offset_dw];
+                    double dh = out_data[dets_accum.back().tensor_offset_dh];
+                    dw = std::exp(dw);
+                    dh = std::exp(dh);
+                    double w = rect.width()-1;
+                    double h = rect.height()-1;
+                    rect = translate_rect(rect, dpoint(dx*w,dy*h));
+                    rect = centered_drect(rect, w*dw+1, h*dh+1);
+                    dets_accum.back().rect_bbr = rect;
                 }
             }
             std::sort(dets_accum.rbegin(), dets_accum.rend());
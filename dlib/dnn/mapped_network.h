@@ -0,0 +1,349 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNn_MAPPED_NETWORK_H_
+#define DLIB_DNn_MAPPED_NETWORK_H_
+
+#include "mapped_network_abstract.h"
+#include "core.h"
+#include "../platform.h"
+#include "../byte_orderer.h"
+#include "../serialize.h"
+#include "../uintn.h"
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef WIN32
+#include "../windows_magic.h"
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        class mapped_file
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    A whole file mapped into memory copy-on-write.  The pages are shared
+                    with every other process that maps the same file until someone
+                    writes to them, at which point the writer gets a private copy.  The
+                    file itself is never modified.
+            !*/
+        public:
+            explicit mapped_file (
+                const std::string& filename
+            )
+            {
+#ifdef WIN32
+                file_handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+                if (file_handle == INVALID_HANDLE_VALUE)
+                    throw serialization_error("Unable to open " + filename + " for reading.");
+                LARGE_INTEGER file_size;
+                if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0)
+                {
+                    CloseHandle(file_handle);
+                    throw serialization_error("Unable to map " + filename + " into memory.");
+                }
+                mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+                if (mapping_handle != NULL)
+                    ptr = MapViewOfFile(mapping_handle, FILE_MAP_COPY, 0, 0, 0);
+                if (ptr == NULL)
+                {
+                    if (mapping_handle != NULL)
+                        CloseHandle(mapping_handle);
+                    CloseHandle(file_handle);
+                    throw serialization_error("Unable to map " + filename + " into memory.");
+                }
+                num_bytes = file_size.QuadPart;
+#else
+                const int fd = open(filename.c_str(), O_RDONLY);
+                if (fd == -1)
+                    throw serialization_error("Unable to open " + filename + " for reading.");
+                struct stat st;
+                if (fstat(fd, &st) != 0 || st.st_size == 0)
+                {
+                    close(fd);
+                    throw serialization_error("Unable to map " + filename + " into memory.");
+                }
+                num_bytes = st.st_size;
+                ptr = mmap(nullptr, num_bytes, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+                // The mapping stays valid after the file descriptor is closed.
+                close(fd);
+                if (ptr == MAP_FAILED)
+                    throw serialization_error("Unable to map " + filename + " into memory.");
+#endif
+            }
+
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+
+            ~mapped_file (
+            )
+            {
+#ifdef WIN32
+                UnmapViewOfFile(ptr);
+                CloseHandle(mapping_handle);
+                CloseHandle(file_handle);
+#else
+                munmap(ptr, num_bytes);
+#endif
+            }
+
+            char* data (
+            ) const { return static_cast<char*>(ptr); }
+
+            size_t size (
+            ) const { return num_bytes; }
+
+        private:
+            void* ptr = nullptr;
+            size_t num_bytes = 0;
+#ifdef WIN32
+            HANDLE file_handle = INVALID_HANDLE_VALUE;
+            HANDLE mapping_handle = NULL;
+#endif
+        };
+
+    // ------------------------------------------------------------------------------------
+
+        // Layout of a mapped network file:
+        //   - the 8 byte mapped_network_magic
+        //   - the size of the header as a little endian uint64
+        //   - the header, written with dlib's serialize(): a version number, the network
+        //     with all its layer parameter tensors emptied, and then the dimensions and
+        //     offset of each parameter tensor in the order visit_layer_parameters()
+        //     visits them.
+        //   - padding up to a multiple of mapped_network_alignment bytes
+        //   - the parameter tensors as raw little endian floats, each one starting at a
+        //     multiple of mapped_network_alignment bytes.  Offsets are relative to the
+        //     start of this section.
+        const char mapped_network_magic[8] = {'d','l','i','b','m','n','e','t'};
+        const size_t mapped_network_alignment = 64;
+
+        struct mapped_tensor_info
+        {
+            long long n = 0, k = 0, nr = 0, nc = 0;
+            uint64 offset = 0;
+
+            size_t size() const { return n*k*nr*nc; }
+        };
+
+        inline void serialize(const mapped_tensor_info& item, std::ostream& out)
+        {
+            dlib::serialize(item.n, out);
+            dlib::serialize(item.k, out);
+            dlib::serialize(item.nr, out);
+            dlib::serialize(item.nc, out);
+            dlib::serialize(item.offset, out);
+        }
+
+        inline void deserialize(mapped_tensor_info& item, std::istream& in)
+        {
+            dlib::deserialize(item.n, in);
+            dlib::deserialize(item.k, in);
+            dlib::deserialize(item.nr, in);
+            dlib::deserialize(item.nc, in);
+            dlib::deserialize(item.offset, in);
+            if (item.n < 0 || item.k < 0 || item.nr < 0 || item.nc < 0)
+                throw serialization_error("Invalid tensor dimensions found while loading a mapped network.");
+            // Make sure size() can't overflow.
+            uint64 size = 1;
+            for (auto d : {item.n, item.k, item.nr, item.nc})
+            {
+                if (d != 0 && size > static_cast<uint64>(std::numeric_limits<long long>::max())/static_cast<uint64>(d))
+                    throw serialization_error("Invalid tensor dimensions found while loading a mapped network.");
+                size *= d;
+            }
+        }
+
+        inline uint64 align_to_mapped_network (
+            uint64 offset
+        )
+        {
+            return (offset + mapped_network_alignment-1)/mapped_network_alignment*mapped_network_alignment;
+        }
+
+        inline resizable_tensor& as_resizable_tensor (
+            tensor& t
+        )
+        {
+            auto ptr = dynamic_cast<resizable_tensor*>(&t);
+            if (ptr == nullptr)
+                throw dlib::error("Mapped networks require every layer to keep its parameters in a resizable_tensor.");
+            return *ptr;
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    void save_mapped_network (
+        const net_type& net,
+        const std::string& filename
+    )
+    {
+        using namespace impl;
+
+        // Move the parameters out of a copy of the network so that what's left, the
+        // structure and everything other than the parameters, can be serialized into
+        // the header the usual way.
+        net_type temp(net);
+        std::vector<resizable_tensor> params;
+        std::vector<mapped_tensor_info> infos;
+        uint64 offset = 0;
+        visit_layer_parameters(temp, [&](size_t, tensor& t)
+        {
+            auto& p = as_resizable_tensor(t);
+            mapped_tensor_info info;
+            info.n = p.num_samples();
+            info.k = p.k();
+            info.nr = p.nr();
+            info.nc = p.nc();
+            info.offset = offset;
+            offset = align_to_mapped_network(offset + info.size()*sizeof(float));
+            infos.push_back(info);
+            params.emplace_back();
+            params.back().swap(p);
+        });
+
+        std::ostringstream sout;
+        int version = 1;
+        serialize(version, sout);
+        serialize(temp, sout);
+        serialize(infos, sout);
+        const std::string header = sout.str();
+
+        std::ofstream fout(filename, std::ios::binary);
+        if (!fout)
+            throw serialization_error("Unable to open " + filename + " for writing.");
+
+        byte_orderer bo;
+        uint64 header_size = header.size();
+        bo.host_to_little(header_size);
+        fout.write(mapped_network_magic, sizeof(mapped_network_magic));
+        fout.write((const char*)&header_size, sizeof(header_size));
+        fout.write(header.data(), header.size());
+
+        const uint64 data_start = align_to_mapped_network(sizeof(mapped_network_magic) + sizeof(header_size) + header.size());
+        uint64 pos = sizeof(mapped_network_magic) + sizeof(header_size) + header.size();
+        const char zeros[mapped_network_alignment] = {};
+        std::vector<float> temp_data;
+        for (size_t i = 0; i < params.size(); ++i)
+        {
+            const uint64 start = data_start + infos[i].offset;
+            fout.write(zeros, start - pos);
+            const float* data = params[i].host();
+            const size_t num = params[i].size();
+            if (!bo.host_is_little_endian())
+            {
+                temp_data.assign(data, data+num);
+                for (auto& v : temp_data)
+                    bo.host_to_little(v);
+                data = temp_data.data();
+            }
+            fout.write((const char*)data, num*sizeof(float));
+            pos = start + num*sizeof(float);
+        }
+
+        if (!fout)
+            throw serialization_error("Error writing the mapped network to " + filename + ".");
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    void load_mapped_network (
+        net_type& net,
+        const std::string& filename
+    )
+    {
+        using namespace impl;
+
+        auto file = std::make_shared<mapped_file>(filename);
+        const size_t preamble_size = sizeof(mapped_network_magic) + sizeof(uint64);
+        if (file->size() < preamble_size || std::memcmp(file->data(), mapped_network_magic, sizeof(mapped_network_magic)) != 0)
+            throw serialization_error(filename + " is not a mapped network file.");
+
+        byte_orderer bo;
+        uint64 header_size;
+        std::memcpy(&header_size, file->data()+sizeof(mapped_network_magic), sizeof(header_size));
+        bo.little_to_host(header_size);
+        if (header_size > file->size() - preamble_size)
+            throw serialization_error("The mapped network file " + filename + " is truncated.");
+
+        std::istringstream sin(std::string(file->data()+preamble_size, header_size));
+        int version;
+        deserialize(version, sin);
+        if (version != 1)
+            throw serialization_error("Unexpected version found while loading a mapped network.");
+        deserialize(net, sin);
+        std::vector<mapped_tensor_info> infos;
+        deserialize(infos, sin);
+
+        const uint64 data_start = align_to_mapped_network(preamble_size + header_size);
+        const uint64 data_size = data_start <= file->size() ? file->size() - data_start : 0;
+        size_t i = 0;
+        visit_layer_parameters(net, [&](size_t, tensor& t)
+        {
+            if (i >= infos.size())
+                throw serialization_error("The mapped network in " + filename + " doesn't match the network type it's being loaded into.");
+            const auto& info = infos[i++];
+            auto& p = as_resizable_tensor(t);
+            if (info.size() == 0)
+            {
+                p.set_size(info.n, info.k, info.nr, info.nc);
+                return;
+            }
+
+            // The mapping itself is page aligned, so this makes sure data points to
+            // properly aligned floats.
+            if (info.offset%alignof(float) != 0)
+                throw serialization_error("The mapped network file " + filename + " contains a misaligned tensor.");
+            // Written this way so that a corrupt offset or size can't overflow.
+            if (info.offset > data_size || info.size() > (data_size - info.offset)/sizeof(float))
+                throw serialization_error("The mapped network file " + filename + " is truncated.");
+            float* data = reinterpret_cast<float*>(file->data() + data_start + info.offset);
+            if (bo.host_is_little_endian())
+            {
+                // Share ownership of the mapping with the tensor so it stays mapped for
+                // as long as the tensor uses it.
+                p.set_host_buffer(std::shared_ptr<float>(file, data), info.n, info.k, info.nr, info.nc);
+            }
+            else
+            {
+                p.set_size(info.n, info.k, info.nr, info.nc);
+                float* dest = p.host_write_only();
+                std::memcpy(dest, data, info.size()*sizeof(float));
+                for (size_t j = 0; j < info.size(); ++j)
+                    bo.little_to_host(dest[j]);
+            }
+        });
+        if (i != infos.size())
+            throw serialization_error("The mapped network in " + filename + " doesn't match the network type it's being loaded into.");
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_MAPPED_NETWORK_H_
+
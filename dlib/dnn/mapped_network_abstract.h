@@ -0,0 +1,96 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DNn_MAPPED_NETWORK_ABSTRACT_H_
+#ifdef DLIB_DNn_MAPPED_NETWORK_ABSTRACT_H_
+
+#include "core_abstract.h"
+#include <string>
+
+namespace dlib
+{
+
+    /*!
+        The functions in this file save and load networks in a format meant for
+        starting up quickly and for running many processes on the same machine.
+
+        The usual way of saving a network, serialize(), writes each parameter in a
+        portable encoding that has to be decoded, one number at a time, when the
+        network is loaded.  For big networks that takes a while, and each process
+        that loads the network gets its own copy of the parameters.  A mapped network
+        file holds the same information, but the parameters are stored as raw little
+        endian floats, suitably aligned.  load_mapped_network() maps the file into
+        memory and the network's parameter tensors use the mapped memory directly.  So
+        loading costs about the same no matter how big the network is, and the
+        operating system keeps a single copy of the parameters in its page cache
+        that's shared by every process that has loaded the file.
+
+        The mapping is copy-on-write.  If you modify a loaded network's parameters,
+        e.g. by training it, the pages you modify are copied and the file on disk is
+        never changed.  Copying a loaded network also copies its parameters into
+        ordinary memory.
+
+        To convert a network saved with serialize() just load it and save it again:
+            deserialize("model.dat") >> net;
+            save_mapped_network(net, "model.dnet");
+        and to go back:
+            load_mapped_network(net, "model.dnet");
+            serialize("model.dat") << net;
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    void save_mapped_network (
+        const net_type& net,
+        const std::string& filename
+    );
+    /*!
+        requires
+            - net_type is an object of type add_layer, add_loss_layer, add_skip_layer, or
+              add_tag_layer.
+            - Every layer in net keeps its parameters in a resizable_tensor, as all of
+              dlib's layers do.
+        ensures
+            - Saves net to the given file in the mapped network format.  Everything
+              serialize() would save is saved, and the file can be loaded with
+              load_mapped_network().
+            - The parameters are written as raw little endian floats regardless of the
+              byte order of the machine, so the file can be loaded on any machine.
+        throws
+            - serialization_error if the file can't be written.
+            - dlib::error if a layer doesn't keep its parameters in a resizable_tensor.
+    !*/
+
+    template <
+        typename net_type
+        >
+    void load_mapped_network (
+        net_type& net,
+        const std::string& filename
+    );
+    /*!
+        requires
+            - net_type is an object of type add_layer, add_loss_layer, add_skip_layer, or
+              add_tag_layer.
+        ensures
+            - Loads the network saved in filename by save_mapped_network() into net.
+              This gives the same network as if it had been saved with serialize() and
+              loaded with deserialize().
+            - On little endian machines the layer parameters of #net are not copied but
+              refer to a copy-on-write memory mapping of the file.  The file stays
+              mapped until none of #net's parameter tensors use it, e.g. until net is
+              destroyed.  On big endian machines the parameters are copied into
+              ordinary memory.
+        throws
+            - serialization_error if the file can't be opened or mapped, isn't a
+              mapped network file, or holds a different type of network.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_MAPPED_NETWORK_ABSTRACT_H_
+
@@ -0,0 +1,1396 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNn_ONNX_H_
+#define DLIB_DNn_ONNX_H_
+
+#include "onnx_abstract.h"
+#include "core.h"
+#include "inference.h"
+#include "../byte_orderer.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        // The ONNX format is a protocol buffer message, described in the onnx.proto file
+        // of the ONNX project.  These two objects read and write the protocol buffer wire
+        // format, which is all that's needed to produce and parse the few message types
+        // used here without depending on the protobuf library.
+
+        class protobuf_writer
+        {
+        public:
+
+            void write_int (
+                int field,
+                std::int64_t value
+            )
+            {
+                write_key(field, 0);
+                write_varint(static_cast<std::uint64_t>(value));
+            }
+
+            void write_ints (
+                int field,
+                const std::vector<long long>& values
+            )
+            {
+                for (auto v : values)
+                    write_int(field, v);
+            }
+
+            void write_bytes (
+                int field,
+                const std::string& value
+            )
+            {
+                write_key(field, 2);
+                write_varint(value.size());
+                buf += value;
+            }
+
+            void write_message (
+                int field,
+                const protobuf_writer& message
+            )
+            {
+                write_bytes(field, message.buf);
+            }
+
+            const std::string& str (
+            ) const { return buf; }
+
+        private:
+
+            void write_key (
+                int field,
+                int wire_type
+            )
+            {
+                write_varint((static_cast<std::uint64_t>(field) << 3) | wire_type);
+            }
+
+            void write_varint (
+                std::uint64_t value
+            )
+            {
+                while (value >= 0x80)
+                {
+                    buf += static_cast<char>((value & 0x7F) | 0x80);
+                    value >>= 7;
+                }
+                buf += static_cast<char>(value);
+            }
+
+            std::string buf;
+        };
+
+        struct protobuf_field
+        {
+            int number = 0;
+            int wire_type = 0;
+            // The value of varint and fixed size fields.
+            std::uint64_t value = 0;
+            // The contents of length delimited fields.
+            const char* data = nullptr;
+            size_t size = 0;
+
+            std::int64_t as_int() const { return static_cast<std::int64_t>(value); }
+
+            float as_float (
+            ) const
+            {
+                if (wire_type != 5)
+                    throw serialization_error("Expected a float in the ONNX data.");
+                std::uint32_t bits = static_cast<std::uint32_t>(value);
+                float f;
+                std::memcpy(&f, &bits, sizeof(f));
+                return f;
+            }
+
+            std::string as_string() const { return std::string(data, size); }
+        };
+
+        class protobuf_reader
+        {
+        public:
+
+            protobuf_reader (
+                const char* data,
+                size_t size
+            )
+            {
+                const char* end = data + size;
+                while (data != end)
+                {
+                    protobuf_field f;
+                    const std::uint64_t key = read_varint(data, end);
+                    f.number = static_cast<int>(key >> 3);
+                    f.wire_type = static_cast<int>(key & 7);
+                    switch (f.wire_type)
+                    {
+                        case 0:
+                            f.value = read_varint(data, end);
+                            break;
+                        case 1:
+                            f.value = read_fixed(data, end, 8);
+                            break;
+                        case 5:
+                            f.value = read_fixed(data, end, 4);
+                            break;
+                        case 2:
+                            f.size = read_varint(data, end);
+                            if (f.size > static_cast<size_t>(end-data))
+                                throw serialization_error("Truncated ONNX data.");
+                            f.data = data;
+                            data += f.size;
+                            break;
+                        default:
+                            throw serialization_error("Unsupported protocol buffer wire type found in the ONNX data.");
+                    }
+                    fields.push_back(f);
+                }
+            }
+
+            std::vector<protobuf_field> all (
+                int number
+            ) const
+            {
+                std::vector<protobuf_field> result;
+                for (auto& f : fields)
+                {
+                    if (f.number == number)
+                        result.push_back(f);
+                }
+                return result;
+            }
+
+            bool has (
+                int number
+            ) const
+            {
+                for (auto& f : fields)
+                {
+                    if (f.number == number)
+                        return true;
+                }
+                return false;
+            }
+
+            protobuf_field get (
+                int number
+            ) const
+            {
+                // Like protocol buffers do, the last occurrence of a field wins.
+                for (auto i = fields.rbegin(); i != fields.rend(); ++i)
+                {
+                    if (i->number == number)
+                        return *i;
+                }
+                return protobuf_field();
+            }
+
+            std::vector<long long> get_ints (
+                int number
+            ) const
+            {
+                // Repeated integers may be packed into one length delimited field or
+                // written as separate varints.
+                std::vector<long long> result;
+                for (auto& f : all(number))
+                {
+                    if (f.wire_type == 2)
+                    {
+                        const char* data = f.data;
+                        while (data != f.data+f.size)
+                            result.push_back(static_cast<std::int64_t>(read_varint(data, f.data+f.size)));
+                    }
+                    else
+                    {
+                        result.push_back(f.as_int());
+                    }
+                }
+                return result;
+            }
+
+            std::vector<float> get_floats (
+                int number
+            ) const
+            {
+                std::vector<float> result;
+                for (auto& f : all(number))
+                {
+                    if (f.wire_type == 2)
+                    {
+                        const char* data = f.data;
+                        while (data != f.data+f.size)
+                        {
+                            protobuf_field v;
+                            v.wire_type = 5;
+                            v.value = read_fixed(data, f.data+f.size, 4);
+                            result.push_back(v.as_float());
+                        }
+                    }
+                    else
+                    {
+                        result.push_back(f.as_float());
+                    }
+                }
+                return result;
+            }
+
+        private:
+
+            static std::uint64_t read_varint (
+                const char*& data,
+                const char* end
+            )
+            {
+                std::uint64_t value = 0;
+                for (int shift = 0; shift < 64; shift += 7)
+                {
+                    if (data == end)
+                        throw serialization_error("Truncated ONNX data.");
+                    const unsigned char byte = static_cast<unsigned char>(*data++);
+                    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0)
+                        return value;
+                }
+                throw serialization_error("Invalid varint found in the ONNX data.");
+            }
+
+            static std::uint64_t read_fixed (
+                const char*& data,
+                const char* end,
+                int num_bytes
+            )
+            {
+                if (end-data < num_bytes)
+                    throw serialization_error("Truncated ONNX data.");
+                // Fixed size values are little endian.
+                std::uint64_t value = 0;
+                for (int i = 0; i < num_bytes; ++i)
+                    value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (8*i);
+                data += num_bytes;
+                return value;
+            }
+
+            std::vector<protobuf_field> fields;
+        };
+
+    // ------------------------------------------------------------------------------------
+
+        // Field numbers and enum values from onnx.proto.
+        namespace onnx
+        {
+            enum model_fields { model_ir_version = 1, model_producer_name = 2,
+                model_graph = 7, model_opset_import = 8 };
+            enum opset_fields { opset_domain = 1, opset_version = 2 };
+            enum graph_fields { graph_node = 1, graph_name = 2, graph_initializer = 5, graph_input = 11,
+                graph_output = 12 };
+            enum node_fields { node_input = 1, node_output = 2, node_name = 3, node_op_type = 4,
+                node_attribute = 5, node_domain = 7 };
+            enum attribute_fields { attribute_name = 1, attribute_f = 2, attribute_i = 3, attribute_s = 4, attribute_t = 5,
+                attribute_ints = 8, attribute_type = 20 };
+            enum attribute_types { attribute_type_int = 2, attribute_type_ints = 7 };
+            enum tensor_fields { tensor_dims = 1, tensor_data_type = 2, tensor_float_data = 4,
+                tensor_int64_data = 7, tensor_name = 8, tensor_raw_data = 9, tensor_data_location = 14 };
+            enum tensor_types { tensor_type_float = 1, tensor_type_int64 = 7 };
+            enum value_info_fields { value_info_name = 1, value_info_type = 2 };
+            enum type_fields { type_tensor_type = 1, type_tensor_elem_type = 1, type_tensor_shape = 2,
+                shape_dim = 1, dim_value = 1, dim_param = 2 };
+
+            // The versions written by export_to_onnx().  Opset 13 is supported by every
+            // ONNX runtime in common use.
+            const long long ir_version = 7;
+            const long long operator_set_version = 13;
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        class onnx_exporter
+        {
+            /*!
+                This object writes an inference_graph as an ONNX GraphProto.  The graph
+                must come straight from inference_graph_builder, without plan_buffers(),
+                so that every op writes a buffer of its own.  Buffer b becomes the ONNX
+                value named "input" if b is 0, "output" if it's the output of the graph and
+                "t<b>" otherwise.
+            !*/
+        public:
+
+            std::string write (
+                const inference_graph& graph
+            )
+            {
+                if (graph.ops.empty() || graph.output_buffer == 0)
+                    throw dlib::error("Can't export a network that doesn't do anything to ONNX.");
+                output_buffer = graph.output_buffer;
+                shapes[0] = buffer_shape{-1, 0};
+
+                protobuf_writer g;
+                g.write_bytes(onnx::graph_name, "dlib");
+                for (size_t i = 0; i < graph.ops.size(); ++i)
+                    write_op(g, graph.ops[i], "op" + cast_to_string(i));
+                for (auto& t : initializers)
+                    g.write_message(onnx::graph_initializer, t);
+                g.write_message(onnx::graph_input, value_info("input", input_dims(graph)));
+                g.write_message(onnx::graph_output, value_info("output", {-1, -1, -1, -1}));
+
+                protobuf_writer opset;
+                opset.write_bytes(onnx::opset_domain, "");
+                opset.write_int(onnx::opset_version, onnx::operator_set_version);
+
+                protobuf_writer model;
+                model.write_int(onnx::model_ir_version, onnx::ir_version);
+                model.write_bytes(onnx::model_producer_name, "dlib");
+                model.write_message(onnx::model_graph, g);
+                model.write_message(onnx::model_opset_import, opset);
+                return model.str();
+            }
+
+        private:
+
+            std::string name (
+                long buffer
+            ) const
+            {
+                if (buffer == 0)
+                    return "input";
+                if (buffer == output_buffer)
+                    return "output";
+                return "t" + cast_to_string(buffer);
+            }
+
+            static std::vector<long long> input_dims (
+                const inference_graph& graph
+            )
+            {
+                // The number of channels is only known if the first op is a convolution.
+                // The other dimensions are left for the runtime to fill in.
+                const auto& op = graph.ops[0];
+                if (op.type == inference_op_type::conv && op.nr != 0 && op.nc != 0)
+                    return {-1, op.filter_size/(op.nr*op.nc), -1, -1};
+                return {-1, -1, -1, -1};
+            }
+
+            static protobuf_writer value_info (
+                const std::string& name,
+                const std::vector<long long>& dims
+            )
+            {
+                // Unknown dimensions, marked by -1, get a symbolic name instead of a
+                // value.  Dimensions with the same name must have the same size, which is
+                // only true of the number of samples.
+                const char* dim_names[] = {"N", "_k", "_nr", "_nc"};
+                protobuf_writer shape;
+                for (size_t i = 0; i < dims.size(); ++i)
+                {
+                    protobuf_writer dim;
+                    if (dims[i] >= 0)
+                        dim.write_int(onnx::dim_value, dims[i]);
+                    else
+                        dim.write_bytes(onnx::dim_param, i == 0 ? dim_names[i] : name + dim_names[i]);
+                    shape.write_message(onnx::shape_dim, dim);
+                }
+                protobuf_writer tensor_type;
+                tensor_type.write_int(onnx::type_tensor_elem_type, onnx::tensor_type_float);
+                tensor_type.write_message(onnx::type_tensor_shape, shape);
+                protobuf_writer type;
+                type.write_message(onnx::type_tensor_type, tensor_type);
+
+                protobuf_writer info;
+                info.write_bytes(onnx::value_info_name, name);
+                info.write_message(onnx::value_info_type, type);
+                return info;
+            }
+
+            std::string add_initializer (
+                const std::string& name,
+                const std::vector<long long>& dims,
+                const float* data
+            )
+            {
+                long long size = 1;
+                for (auto d : dims)
+                    size *= d;
+                std::string raw(size*sizeof(float), 0);
+                byte_orderer bo;
+                for (long long i = 0; i < size; ++i)
+                {
+                    std::uint32_t bits;
+                    std::memcpy(&bits, data+i, sizeof(bits));
+                    bo.host_to_little(bits);
+                    std::memcpy(&raw[i*sizeof(float)], &bits, sizeof(bits));
+                }
+
+                protobuf_writer t;
+                t.write_ints(onnx::tensor_dims, dims);
+                t.write_int(onnx::tensor_data_type, onnx::tensor_type_float);
+                t.write_bytes(onnx::tensor_name, name);
+                t.write_bytes(onnx::tensor_raw_data, raw);
+                initializers.push_back(t);
+                return name;
+            }
+
+            std::string add_int_initializer (
+                const std::string& name,
+                const std::vector<long long>& values
+            )
+            {
+                protobuf_writer t;
+                t.write_int(onnx::tensor_dims, values.size());
+                t.write_int(onnx::tensor_data_type, onnx::tensor_type_int64);
+                t.write_bytes(onnx::tensor_name, name);
+                t.write_ints(onnx::tensor_int64_data, values);
+                initializers.push_back(t);
+                return name;
+            }
+
+            struct attribute
+            {
+                attribute(const std::string& name_, long long i) : name(name_), type(onnx::attribute_type_int), ints(1,i) {}
+                attribute(const std::string& name_, const std::vector<long long>& ints_) : name(name_), type(onnx::attribute_type_ints), ints(ints_) {}
+
+                std::string name;
+                int type;
+                std::vector<long long> ints;
+            };
+
+            static void add_node (
+                protobuf_writer& graph,
+                const std::string& op_type,
+                const std::string& node_name,
+                const std::vector<std::string>& inputs,
+                const std::string& output,
+                const std::vector<attribute>& attributes = std::vector<attribute>()
+            )
+            {
+                protobuf_writer node;
+                for (auto& in : inputs)
+                    node.write_bytes(onnx::node_input, in);
+                node.write_bytes(onnx::node_output, output);
+                node.write_bytes(onnx::node_name, node_name);
+                node.write_bytes(onnx::node_op_type, op_type);
+                for (auto& a : attributes)
+                {
+                    protobuf_writer attr;
+                    attr.write_bytes(onnx::attribute_name, a.name);
+                    attr.write_int(onnx::attribute_type, a.type);
+                    if (a.type == onnx::attribute_type_int)
+                        attr.write_int(onnx::attribute_i, a.ints[0]);
+                    else
+                        attr.write_ints(onnx::attribute_ints, a.ints);
+                    node.write_message(onnx::node_attribute, attr);
+                }
+                graph.write_message(onnx::graph_node, node);
+            }
+
+            void write_op (
+                protobuf_writer& g,
+                const inference_op& op,
+                const std::string& op_name
+            )
+            {
+                const std::string in = name(op.input);
+                const std::string out = name(op.output);
+                // Ops that end with a relu write their output to a temporary value that
+                // the Relu node then reads.
+                const std::string result = op.relu ? out + "_" + op_name : out;
+
+                switch (op.type)
+                {
+                    case inference_op_type::conv:
+                        {
+                            const std::string b = add_initializer(op_name + "_B", {op.num_filters}, op.biases.host());
+                            if (op.nr == 0 && op.nc == 0)
+                            {
+                                // An fc_ layer.  Its output is kept 4D, as it is in dlib,
+                                // so the ops after it see the same shapes.
+                                const std::string w = add_initializer(op_name + "_W", {op.num_filters, op.filter_size}, op.float_filters.host());
+                                const std::string shape = add_int_initializer(op_name + "_shape", {0, -1, 1, 1});
+                                add_node(g, "Flatten", op_name + "_flatten", {in}, out + "_flat", {attribute("axis", 1)});
+                                add_node(g, "Gemm", op_name, {out + "_flat", w, b}, out + "_gemm", {attribute("transB", 1)});
+                                add_node(g, "Reshape", op_name + "_reshape", {out + "_gemm", shape}, result);
+                            }
+                            else
+                            {
+                                const std::string w = add_initializer(op_name + "_W",
+                                    {op.num_filters, op.filter_size/(op.nr*op.nc), op.nr, op.nc}, op.float_filters.host());
+                                add_node(g, "Conv", op_name, {in, w, b}, result, {
+                                    attribute("kernel_shape", {op.nr, op.nc}),
+                                    attribute("strides", {op.stride_y, op.stride_x}),
+                                    attribute("pads", {op.padding_y, op.padding_x, op.padding_y, op.padding_x})});
+                            }
+                        } break;
+                    case inference_op_type::relu:
+                        add_node(g, "Relu", op_name, {in}, result);
+                        break;
+                    case inference_op_type::affine:
+                        {
+                            // In both modes gamma and beta have the shape of one sample,
+                            // or of one pixel for CONV_MODE, so they broadcast over the
+                            // input.
+                            const std::vector<long long> dims = {1, op.gamma.k(), op.gamma.nr(), op.gamma.nc()};
+                            const std::string gamma = add_initializer(op_name + "_gamma", dims, op.gamma.host());
+                            const std::string beta = add_initializer(op_name + "_beta", dims, op.beta.host());
+                            add_node(g, "Mul", op_name + "_mul", {in, gamma}, out + "_scaled");
+                            add_node(g, "Add", op_name, {out + "_scaled", beta}, result);
+                        } break;
+                    case inference_op_type::max_pool:
+                    case inference_op_type::avg_pool:
+                        {
+                            const bool is_max = op.type == inference_op_type::max_pool;
+                            if (op.nr == 0 && op.nc == 0 && op.padding_y == 0 && op.padding_x == 0)
+                            {
+                                add_node(g, is_max ? "GlobalMaxPool" : "GlobalAveragePool", op_name, {in}, result);
+                            }
+                            else if (op.nr == 0 || op.nc == 0)
+                            {
+                                throw dlib::error("Can't export pooling layers that span only one dimension of their input to ONNX.");
+                            }
+                            else
+                            {
+                                // dlib's average pooling ignores the padding, which is
+                                // ONNX's default.
+                                add_node(g, is_max ? "MaxPool" : "AveragePool", op_name, {in}, result, {
+                                    attribute("kernel_shape", {op.nr, op.nc}),
+                                    attribute("strides", {op.stride_y, op.stride_x}),
+                                    attribute("pads", {op.padding_y, op.padding_x, op.padding_y, op.padding_x})});
+                            }
+                        } break;
+                    case inference_op_type::add_prev:
+                        {
+                            // add_prev_ zero pads whichever of its inputs is smaller, while
+                            // ONNX's Add needs them to have the same shape.  So unless they
+                            // certainly do, both are padded to the larger of their shapes
+                            // when the model runs.
+                            std::string in1 = in, in2 = name(op.input2);
+                            if (!(shapes[op.input] == shapes[op.input2]))
+                            {
+                                const std::string zeros = add_int_initializer(op_name + "_zeros", {0, 0, 0, 0});
+                                add_node(g, "Shape", op_name + "_shape1", {in1}, out + "_shape1");
+                                add_node(g, "Shape", op_name + "_shape2", {in2}, out + "_shape2");
+                                add_node(g, "Max", op_name + "_max", {out + "_shape1", out + "_shape2"}, out + "_shape");
+                                auto pad_to_shape = [&](std::string& input, const std::string& suffix)
+                                {
+                                    // Pads only go after the end of each dimension.
+                                    add_node(g, "Sub", op_name + suffix + "_sub", {out + "_shape", out + "_shape" + suffix}, out + suffix + "_growth");
+                                    add_node(g, "Concat", op_name + suffix + "_pads", {zeros, out + suffix + "_growth"}, out + suffix + "_pads", {attribute("axis", 0)});
+                                    add_node(g, "Pad", op_name + suffix + "_pad", {input, out + suffix + "_pads"}, out + suffix + "_padded");
+                                    input = out + suffix + "_padded";
+                                };
+                                pad_to_shape(in1, "1");
+                                pad_to_shape(in2, "2");
+                            }
+                            add_node(g, "Add", op_name, {in1, in2}, result);
+                        } break;
+                }
+                shapes[op.output] = output_shape(op);
+
+                if (op.relu)
+                    add_node(g, "Relu", op_name + "_relu", {result}, out);
+            }
+
+            struct buffer_shape
+            {
+                // The number of channels.  Negative values stand for numbers that aren't
+                // known until the model runs, with -1 being the number of channels in the
+                // network's input.
+                long k;
+                // Buffers with the same value here have the same number of rows and
+                // columns.
+                long size_id;
+
+                bool operator== (const buffer_shape& item) const { return k == item.k && size_id == item.size_id; }
+            };
+
+            buffer_shape output_shape (
+                const inference_op& op
+            )
+            {
+                const buffer_shape in = shapes[op.input];
+                // Ops that keep the rows and columns of their input, which is what most
+                // layers in a network do, keep its size_id.  Anything else gets a new one.
+                const bool same_size = op.stride_y == 1 && op.stride_x == 1 &&
+                    op.nr == 2*op.padding_y+1 && op.nc == 2*op.padding_x+1;
+                switch (op.type)
+                {
+                    case inference_op_type::conv:
+                        return buffer_shape{op.num_filters, same_size ? in.size_id : op.output};
+                    case inference_op_type::max_pool:
+                    case inference_op_type::avg_pool:
+                        return buffer_shape{in.k, same_size ? in.size_id : op.output};
+                    case inference_op_type::add_prev:
+                        {
+                            const buffer_shape in2 = shapes[op.input2];
+                            if (in == in2)
+                                return in;
+                            return buffer_shape{in.k > 0 && in2.k > 0 ? std::max(in.k, in2.k) : -1-op.output, op.output};
+                        }
+                    default:
+                        return in;
+                }
+            }
+
+            long output_buffer = 0;
+            std::vector<protobuf_writer> initializers;
+            std::map<long,buffer_shape> shapes;
+        };
+
+    // ------------------------------------------------------------------------------------
+
+        class onnx_importer
+        {
+            /*!
+                This object translates an ONNX ModelProto into an inference_graph using
+                inference_graph_builder, so ops are folded together just like when a dlib
+                network is compiled.
+            !*/
+        public:
+
+            void read (
+                const std::string& model_data,
+                inference_graph& graph
+            )
+            {
+                protobuf_reader model(model_data.data(), model_data.size());
+                for (auto& f : model.all(onnx::model_opset_import))
+                {
+                    protobuf_reader opset(f.data, f.size);
+                    const std::string domain = opset.get(onnx::opset_domain).as_string();
+                    if ((domain.empty() || domain == "ai.onnx") && opset.get(onnx::opset_version).as_int() < 7)
+                        throw dlib::error("ONNX models using operator sets older than version 7 aren't supported.");
+                }
+                if (!model.has(onnx::model_graph))
+                    throw serialization_error("The ONNX model doesn't contain a graph.");
+                const auto gf = model.get(onnx::model_graph);
+                protobuf_reader g(gf.data, gf.size);
+
+                for (auto& f : g.all(onnx::graph_initializer))
+                {
+                    protobuf_reader t(f.data, f.size);
+                    constants[t.get(onnx::tensor_name).as_string()] = read_tensor(t);
+                }
+
+                const auto nodes = g.all(onnx::graph_node);
+                std::vector<std::string> outputs;
+                for (auto& f : g.all(onnx::graph_output))
+                    outputs.push_back(protobuf_reader(f.data, f.size).get(onnx::value_info_name).as_string());
+                if (outputs.size() != 1)
+                    throw dlib::error("Only ONNX models with exactly one output can be imported.");
+
+                // The network input is the graph input that isn't an initializer.
+                std::string input_name;
+                for (auto& f : g.all(onnx::graph_input))
+                {
+                    const std::string n = protobuf_reader(f.data, f.size).get(onnx::value_info_name).as_string();
+                    if (constants.count(n) == 0)
+                    {
+                        if (!input_name.empty())
+                            throw dlib::error("Only ONNX models with exactly one input can be imported.");
+                        input_name = n;
+                    }
+                }
+                if (input_name.empty())
+                    throw dlib::error("The ONNX model doesn't have an input.");
+
+                // A value read by more than one node, or by a node and the caller, can't
+                // be overwritten by folding the next layer into the op that writes it.
+                for (auto& f : nodes)
+                {
+                    protobuf_reader node(f.data, f.size);
+                    // Looking at the shape of a value doesn't need its contents.
+                    if (node.get(onnx::node_op_type).as_string() == "Shape")
+                        continue;
+                    for (auto& in : node.all(onnx::node_input))
+                        ++num_readers[in.as_string()];
+                }
+                ++num_readers[outputs[0]];
+
+                graph = inference_graph();
+                inference_graph_builder builder(graph);
+                buffers[input_name] = 0;
+                for (size_t i = 0; i < nodes.size(); ++i)
+                {
+                    // Nodes merged into the one before them are skipped.
+                    if (i == skip_node)
+                        continue;
+                    protobuf_reader node(nodes[i].data, nodes[i].size);
+                    add_node(builder, node, i+1 < nodes.size() ? &nodes[i+1] : nullptr, i);
+                }
+
+                graph.output_buffer = buffer_of(outputs[0]);
+                if (graph.output_buffer == 0 || graph.ops.empty())
+                    throw dlib::error("The ONNX model doesn't do anything to its input.");
+                graph.plan_buffers();
+            }
+
+        private:
+
+            struct onnx_tensor
+            {
+                std::vector<long long> dims;
+                std::vector<float> values;
+                std::vector<long long> int_values;
+
+                long long size (
+                ) const
+                {
+                    long long n = 1;
+                    for (auto d : dims)
+                        n *= d;
+                    return n;
+                }
+            };
+
+            static onnx_tensor read_tensor (
+                const protobuf_reader& t
+            )
+            {
+                onnx_tensor result;
+                result.dims = t.get_ints(onnx::tensor_dims);
+                if (t.has(onnx::tensor_data_location) && t.get(onnx::tensor_data_location).as_int() != 0)
+                    throw dlib::error("ONNX models with external data aren't supported.");
+
+                const auto type = t.get(onnx::tensor_data_type).as_int();
+                const auto raw = t.get(onnx::tensor_raw_data);
+                if (type == onnx::tensor_type_float)
+                {
+                    if (t.has(onnx::tensor_raw_data))
+                    {
+                        result.values.resize(raw.size/sizeof(float));
+                        byte_orderer bo;
+                        for (size_t i = 0; i < result.values.size(); ++i)
+                        {
+                            std::uint32_t bits;
+                            std::memcpy(&bits, raw.data + i*sizeof(float), sizeof(bits));
+                            bo.little_to_host(bits);
+                            std::memcpy(&result.values[i], &bits, sizeof(bits));
+                        }
+                    }
+                    else
+                    {
+                        result.values = t.get_floats(onnx::tensor_float_data);
+                    }
+                    if ((long long)result.values.size() != result.size())
+                        throw serialization_error("An ONNX tensor has the wrong number of values.");
+                }
+                else if (type == onnx::tensor_type_int64)
+                {
+                    if (t.has(onnx::tensor_raw_data))
+                    {
+                        result.int_values.resize(raw.size/8);
+                        for (size_t i = 0; i < result.int_values.size(); ++i)
+                        {
+                            std::uint64_t v = 0;
+                            for (int j = 0; j < 8; ++j)
+                                v |= static_cast<std::uint64_t>(static_cast<unsigned char>(raw.data[i*8+j])) << (8*j);
+                            result.int_values[i] = static_cast<std::int64_t>(v);
+                        }
+                    }
+                    else
+                    {
+                        result.int_values = t.get_ints(onnx::tensor_int64_data);
+                    }
+                }
+                // Tensors of other types are only accepted as long as nothing uses them.
+                return result;
+            }
+
+            struct node_attributes
+            {
+                std::map<std::string,long long> ints;
+                std::map<std::string,float> floats;
+                std::map<std::string,std::vector<long long>> int_lists;
+                std::map<std::string,std::string> strings;
+                std::map<std::string,onnx_tensor> tensors;
+
+                long long get_int(const std::string& name, long long default_value) const
+                {
+                    auto i = ints.find(name);
+                    return i == ints.end() ? default_value : i->second;
+                }
+
+                float get_float(const std::string& name, float default_value) const
+                {
+                    auto i = floats.find(name);
+                    return i == floats.end() ? default_value : i->second;
+                }
+
+                std::vector<long long> get_ints(const std::string& name, const std::vector<long long>& default_value) const
+                {
+                    auto i = int_lists.find(name);
+                    return i == int_lists.end() ? default_value : i->second;
+                }
+            };
+
+            static node_attributes read_attributes (
+                const protobuf_reader& node
+            )
+            {
+                node_attributes result;
+                for (auto& f : node.all(onnx::node_attribute))
+                {
+                    protobuf_reader a(f.data, f.size);
+                    const std::string name = a.get(onnx::attribute_name).as_string();
+                    if (a.has(onnx::attribute_i))
+                        result.ints[name] = a.get(onnx::attribute_i).as_int();
+                    if (a.has(onnx::attribute_f))
+                        result.floats[name] = a.get(onnx::attribute_f).as_float();
+                    if (a.has(onnx::attribute_s))
+                        result.strings[name] = a.get(onnx::attribute_s).as_string();
+                    if (a.has(onnx::attribute_ints))
+                        result.int_lists[name] = a.get_ints(onnx::attribute_ints);
+                    if (a.has(onnx::attribute_t))
+                    {
+                        const auto t = a.get(onnx::attribute_t);
+                        result.tensors[name] = read_tensor(protobuf_reader(t.data, t.size));
+                    }
+                }
+                return result;
+            }
+
+            long buffer_of (
+                const std::string& value
+            ) const
+            {
+                auto i = buffers.find(value);
+                if (i == buffers.end())
+                    throw dlib::error("The ONNX value '" + value + "' is used before it's computed, or is a constant where dlib needs a computed value.");
+                return i->second;
+            }
+
+            const onnx_tensor& constant (
+                const std::string& value,
+                const std::string& op_type
+            ) const
+            {
+                auto i = constants.find(value);
+                if (i == constants.end())
+                    throw dlib::error("The " + op_type + " ONNX nodes can only be imported when '" + value + "' is a constant.");
+                return i->second;
+            }
+
+            static void unsupported (
+                const std::string& op_type,
+                const std::string& why
+            )
+            {
+                throw dlib::error("Can't import the " + op_type + " ONNX node because " + why + ".");
+            }
+
+            static void get_pads (
+                const std::string& op_type,
+                const node_attributes& attrs,
+                inference_op& op
+            )
+            {
+                const auto auto_pad = attrs.strings.find("auto_pad");
+                if (auto_pad != attrs.strings.end() && auto_pad->second != "NOTSET")
+                    unsupported(op_type, "auto_pad isn't supported");
+                if (attrs.ints.count("ceil_mode") && attrs.get_int("ceil_mode", 0) != 0)
+                    unsupported(op_type, "ceil_mode isn't supported");
+                for (auto d : attrs.get_ints("dilations", {1,1}))
+                {
+                    if (d != 1)
+                        unsupported(op_type, "dilated convolutions and pooling aren't supported");
+                }
+                const auto strides = attrs.get_ints("strides", {1,1});
+                const auto pads = attrs.get_ints("pads", {0,0,0,0});
+                if (strides.size() != 2 || pads.size() != 4)
+                    unsupported(op_type, "only 2D convolutions and pooling are supported");
+                if (pads[0] != pads[2] || pads[1] != pads[3])
+                    unsupported(op_type, "dlib only supports the same padding on both sides of an image");
+                op.stride_y = strides[0];
+                op.stride_x = strides[1];
+                op.padding_y = pads[0];
+                op.padding_x = pads[1];
+            }
+
+            void add_conv (
+                inference_graph_builder& builder,
+                const std::string& op_type,
+                const onnx_tensor& w,
+                const onnx_tensor* b,
+                bool transposed_weights,
+                const node_attributes& attrs
+            )
+            {
+                if (w.values.size() == 0 || (b && (long long)b->values.size() != b->size()))
+                    unsupported(op_type, "its weights aren't floats");
+                inference_op op = builder.new_op(inference_op_type::conv);
+                if (op_type == "Conv")
+                {
+                    if (w.dims.size() != 4)
+                        unsupported(op_type, "only 2D convolutions are supported");
+                    if (attrs.get_int("group", 1) != 1)
+                        unsupported(op_type, "grouped convolutions aren't supported");
+                    get_pads(op_type, attrs, op);
+                    op.num_filters = w.dims[0];
+                    op.nr = w.dims[2];
+                    op.nc = w.dims[3];
+                    op.filter_size = w.dims[1]*op.nr*op.nc;
+                    op.float_filters.set_size(w.dims[0], w.dims[1], w.dims[2], w.dims[3]);
+                    std::copy(w.values.begin(), w.values.end(), op.float_filters.host());
+                }
+                else
+                {
+                    if (w.dims.size() != 2)
+                        unsupported(op_type, "its weights aren't a matrix");
+                    // dlib keeps fc weights as a num_outputs by num_inputs matrix, which is
+                    // the transpose of the usual ONNX layout.
+                    const auto W = dlib::mat(&w.values[0], w.dims[0], w.dims[1]);
+                    op.num_filters = transposed_weights ? w.dims[0] : w.dims[1];
+                    op.filter_size = transposed_weights ? w.dims[1] : w.dims[0];
+                    op.float_filters.set_size(op.num_filters, op.filter_size);
+                    if (transposed_weights)
+                        op.float_filters = W;
+                    else
+                        op.float_filters = trans(W);
+                }
+
+                op.biases.set_size(1, op.num_filters);
+                op.biases = 0;
+                if (b)
+                {
+                    if (b->size() != op.num_filters && b->size() != 1)
+                        unsupported(op_type, "its bias doesn't have one value per output");
+                    float* bias = op.biases.host();
+                    for (long i = 0; i < op.num_filters; ++i)
+                        bias[i] = b->values[b->size() == 1 ? 0 : i];
+                }
+                builder.push(op);
+            }
+
+            void add_affine (
+                inference_graph_builder& builder,
+                const std::string& op_type,
+                const onnx_tensor& gamma,
+                const onnx_tensor& beta
+            )
+            {
+                // The constants must hold one value per channel, which is CONV_MODE, or
+                // one value per element of a sample, which is FC_MODE.
+                auto dims_of = [&](const onnx_tensor& t) -> std::vector<long long>
+                {
+                    std::vector<long long> d = t.dims;
+                    while (d.size() < 4)
+                        d.insert(d.begin(), 1);
+                    if (t.dims.size() < 3 || d.size() != 4 || d[0] != 1 || (long long)t.values.size() != t.size())
+                        unsupported(op_type, "its constant can't be applied to each sample in the same way");
+                    return d;
+                };
+                const auto d = dims_of(gamma);
+                if (d != dims_of(beta))
+                    unsupported(op_type, "its scale and offset have different shapes");
+                const int mode = d[2] == 1 && d[3] == 1 ? CONV_MODE : FC_MODE;
+
+                resizable_tensor g(1, d[1], d[2], d[3]), b(1, d[1], d[2], d[3]);
+                std::copy(gamma.values.begin(), gamma.values.end(), g.host());
+                std::copy(beta.values.begin(), beta.values.end(), b.host());
+                builder.add_affine(g, b, mode);
+            }
+
+            static onnx_tensor filled_like (
+                const onnx_tensor& t,
+                float value
+            )
+            {
+                onnx_tensor result;
+                result.dims = t.dims;
+                result.values.assign(t.size(), value);
+                return result;
+            }
+
+            void add_node (
+                inference_graph_builder& builder,
+                const protobuf_reader& node,
+                const protobuf_field* next_node,
+                size_t node_index
+            )
+            {
+                const std::string op_type = node.get(onnx::node_op_type).as_string();
+                const std::string domain = node.get(onnx::node_domain).as_string();
+                if (!domain.empty() && domain != "ai.onnx")
+                    unsupported(op_type, "it's from the operator set '" + domain + "'");
+                std::vector<std::string> inputs;
+                for (auto& f : node.all(onnx::node_input))
+                    inputs.push_back(f.as_string());
+                const auto outputs = node.all(onnx::node_output);
+                if (outputs.empty())
+                    unsupported(op_type, "it has no outputs");
+                const std::string output = outputs[0].as_string();
+                const auto attrs = read_attributes(node);
+
+                auto require_inputs = [&](size_t min_num, size_t max_num)
+                {
+                    if (inputs.size() < min_num || inputs.size() > max_num)
+                        unsupported(op_type, "it has the wrong number of inputs");
+                };
+                auto is_constant = [&](const std::string& value) { return constants.count(value) != 0; };
+
+                if (op_type == "Constant")
+                {
+                    if (attrs.tensors.count("value") == 0)
+                        unsupported(op_type, "only constants given as a tensor are supported");
+                    constants[output] = attrs.tensors.at("value");
+                    return;
+                }
+
+                if (op_type == "Identity" || op_type == "Dropout")
+                {
+                    require_inputs(1, 3);
+                    if (is_constant(inputs[0]))
+                    {
+                        constants[output] = constants[inputs[0]];
+                    }
+                    else
+                    {
+                        builder.set_current_buffer(buffer_of(inputs[0]));
+                        set_output(builder, output);
+                        if (flattened.count(inputs[0]) != 0)
+                            flattened.insert(output);
+                    }
+                    return;
+                }
+
+                if (op_type == "Flatten" || op_type == "Reshape")
+                {
+                    // dlib tensors are already laid out like a flattened one, so these
+                    // are free, as long as only ops that don't care about the image
+                    // dimensions read the result.  The one exception is reshaping a
+                    // flattened value back into a tensor of 1x1 images, which is what
+                    // dlib's tensors look like after an fc_ layer.
+                    bool flat = true;
+                    if (op_type == "Flatten")
+                    {
+                        require_inputs(1, 1);
+                        if (attrs.get_int("axis", 1) != 1)
+                            unsupported(op_type, "only flattening everything but the samples is supported");
+                    }
+                    else
+                    {
+                        require_inputs(2, 2);
+                        const auto& shape = constant(inputs[1], op_type).int_values;
+                        if ((shape.size() != 2 && shape.size() != 4) || shape[0] > 0)
+                            unsupported(op_type, "only reshapes that keep the samples separate are supported");
+                        if (shape.size() == 4)
+                        {
+                            if (shape[2] != 1 || shape[3] != 1 || flattened.count(inputs[0]) == 0)
+                                unsupported(op_type, "only reshapes of flattened values into 1x1 images are supported");
+                            flat = false;
+                        }
+                    }
+                    builder.set_current_buffer(buffer_of(inputs[0]));
+                    set_output(builder, output);
+                    if (flat)
+                        flattened.insert(output);
+                    return;
+                }
+
+                if (op_type == "Shape")
+                {
+                    require_inputs(1, 1);
+                    buffer_of(inputs[0]);
+                    shape_values.insert(output);
+                    return;
+                }
+
+                if ((op_type == "Max" || op_type == "Sub" || op_type == "Concat") && !inputs.empty())
+                {
+                    // Arithmetic on shapes is only used to compute the padding of a Pad
+                    // node.
+                    bool on_shapes = true;
+                    for (auto& in : inputs)
+                        on_shapes = on_shapes && (shape_values.count(in) != 0 || is_constant(in));
+                    if (!on_shapes)
+                        unsupported(op_type, "only arithmetic on the shapes of tensors is supported");
+                    shape_values.insert(output);
+                    return;
+                }
+
+                if (op_type == "Pad")
+                {
+                    // Zero padding the end of each dimension is free when the result is
+                    // added to another tensor, since add_prev_ does that itself.  This is
+                    // how export_to_onnx() writes add_prev_ layers that add tensors of
+                    // different sizes.  When the padding is computed from the shapes of
+                    // tensors it's assumed to be doing just that.
+                    require_inputs(2, 3);
+                    const auto mode = attrs.strings.find("mode");
+                    if (mode != attrs.strings.end() && mode->second != "constant")
+                        unsupported(op_type, "only zero padding is supported");
+                    if (inputs.size() > 2 && !inputs[2].empty())
+                    {
+                        const auto& value = constant(inputs[2], op_type).values;
+                        if (value.size() != 1 || value[0] != 0)
+                            unsupported(op_type, "only zero padding is supported");
+                    }
+                    if (shape_values.count(inputs[1]) == 0)
+                    {
+                        const auto& pads = constant(inputs[1], op_type).int_values;
+                        if (pads.size() != 8 || pads[0] != 0 || pads[1] != 0 || pads[2] != 0 || pads[3] != 0 ||
+                            pads[4] != 0 || pads[5] < 0 || pads[6] < 0 || pads[7] < 0)
+                            unsupported(op_type, "only padding the end of the channels, rows and columns is supported");
+                    }
+                    if (num_readers[output] != 1)
+                        unsupported(op_type, "its output has to be read by exactly one Add node");
+                    builder.set_current_buffer(buffer_of(inputs[0]));
+                    set_output(builder, output);
+                    resized.insert(output);
+                    return;
+                }
+
+                // Only these ops can read a flattened value, since they don't look at the
+                // image dimensions.
+                for (auto& in : inputs)
+                {
+                    if (flattened.count(in) != 0 && op_type != "Gemm" && op_type != "MatMul" && op_type != "Relu")
+                        unsupported(op_type, "it reads the output of a Flatten or Reshape node");
+                    if (resized.count(in) != 0 && (op_type != "Add" || is_constant(inputs[0]) || is_constant(inputs[1])))
+                        unsupported(op_type, "it reads the output of a Pad node");
+                }
+
+                if (op_type == "Conv")
+                {
+                    require_inputs(2, 3);
+                    builder.set_current_buffer(buffer_of(inputs[0]));
+                    add_conv(builder, op_type, constant(inputs[1], op_type),
+                        inputs.size() > 2 ? &constant(inputs[2], op_type) : nullptr, false, attrs);
+                }
+                else if (op_type == "Gemm")
+                {
+                    require_inputs(2, 3);
+                    if (attrs.get_int("transA", 0) != 0 || attrs.get_float("alpha", 1) != 1 || attrs.get_float("beta", 1) != 1)
+                        unsupported(op_type, "only transB is supported");
+                    builder.set_current_buffer(buffer_of(inputs[0]));
+                    add_conv(builder, op_type, constant(inputs[1], op_type),
+                        inputs.size() > 2 ? &constant(inputs[2], op_type) : nullptr, attrs.get_int("transB", 0) != 0, attrs);
+                    // Like Flatten, Gemm outputs a matrix rather than a tensor of images.
+                    flattened.insert(output);
+                }
+                else if (op_type == "MatMul")
+                {
+                    require_inputs(2, 2);
+                    builder.set_current_buffer(buffer_of(inputs[0]));
+                    // A MatMul followed by the Add of a bias is a Gemm.
+                    const onnx_tensor* bias = nullptr;
+                    std::string result = output;
+                    if (next_node && num_readers[output] == 1)
+                    {
+                        protobuf_reader next(next_node->data, next_node->size);
+                        const auto next_inputs = next.all(onnx::node_input);
+                        if (next.get(onnx::node_op_type).as_string() == "Add" && next_inputs.size() == 2)
+                        {
+                            const std::string a = next_inputs[0].as_string(), b = next_inputs[1].as_string();
+                            const std::string other = a == output ? b : a;
+                            if ((a == output || b == output) && is_constant(other))
+                            {
+                                bias = &constants[other];
+                                result = next.get(onnx::node_output).as_string();
+                                skip_node = node_index+1;
+                            }
+                        }
+                    }
+                    add_conv(builder, op_type, constant(inputs[1], op_type), bias, false, attrs);
+                    set_output(builder, result);
+                    flattened.insert(result);
+                    return;
+                }
+                else if (op_type == "Relu")
+                {
+                    require_inputs(1, 1);
+                    builder.set_current_buffer(buffer_of(inputs[0]));
+                    builder.add_relu();
+                    if (flattened.count(inputs[0]) != 0)
+                        flattened.insert(output);
+                }
+                else if (op_type == "BatchNormalization")
+                {
+                    require_inputs(5, 5);
+                    builder.set_current_buffer(buffer_of(inputs[0]));
+                    const auto& scale = constant(inputs[1], op_type);
+                    const auto& bias = constant(inputs[2], op_type);
+                    const auto& mean = constant(inputs[3], op_type);
+                    const auto& var = constant(inputs[4], op_type);
+                    const float eps = attrs.get_float("epsilon", 1e-5f);
+                    if (scale.values.size() == 0 || bias.values.size() != scale.values.size() ||
+                        mean.values.size() != scale.values.size() || var.values.size() != scale.values.size())
+                        unsupported(op_type, "its parameters don't all have one value per channel");
+                    onnx_tensor gamma = scale, beta = bias;
+                    gamma.dims = beta.dims = {scale.size(), 1, 1};
+                    for (long long i = 0; i < scale.size(); ++i)
+                    {
+                        gamma.values[i] = scale.values[i]/std::sqrt(var.values[i] + eps);
+                        beta.values[i] = bias.values[i] - mean.values[i]*gamma.values[i];
+                    }
+                    add_affine(builder, op_type, gamma, beta);
+                }
+                else if ((op_type == "Mul" || op_type == "Add") && inputs.size() == 2 &&
+                         (is_constant(inputs[0]) || is_constant(inputs[1])))
+                {
+                    const bool first_is_constant = is_constant(inputs[0]);
+                    const std::string in = first_is_constant ? inputs[1] : inputs[0];
+                    const onnx_tensor& c = constants[first_is_constant ? inputs[0] : inputs[1]];
+                    builder.set_current_buffer(buffer_of(in));
+                    onnx_tensor gamma = op_type == "Mul" ? c : filled_like(c, 1);
+                    onnx_tensor beta = op_type == "Mul" ? filled_like(c, 0) : c;
+                    std::string result = output;
+
+                    // A Mul followed by an Add of a constant of the same shape is one
+                    // affine_ layer, which is how export_to_onnx() writes them.
+                    if (op_type == "Mul" && next_node && num_readers[output] == 1)
+                    {
+                        protobuf_reader next(next_node->data, next_node->size);
+                        const auto next_inputs = next.all(onnx::node_input);
+                        if (next.get(onnx::node_op_type).as_string() == "Add" && next_inputs.size() == 2)
+                        {
+                            const std::string a = next_inputs[0].as_string(), b = next_inputs[1].as_string();
+                            const std::string other = a == output ? b : a;
+                            if ((a == output || b == output) && is_constant(other) && constants[other].dims == c.dims)
+                            {
+                                beta = constants[other];
+                                result = next.get(onnx::node_output).as_string();
+                                skip_node = node_index+1;
+                            }
+                        }
+                    }
+                    add_affine(builder, op_type, gamma, beta);
+                    set_output(builder, result);
+                    return;
+                }
+                else if (op_type == "Add")
+                {
+                    require_inputs(2, 2);
+                    builder.set_current_buffer(buffer_of(inputs[0]));
+                    inference_op op = builder.new_op(inference_op_type::add_prev);
+                    op.input2 = buffer_of(inputs[1]);
+                    builder.push(op);
+                }
+                else if (op_type == "MaxPool" || op_type == "AveragePool")
+                {
+                    require_inputs(1, 1);
+                    if (outputs.size() > 1 && !outputs[1].as_string().empty())
+                        unsupported(op_type, "the indices output isn't supported");
+                    if (attrs.get_int("count_include_pad", 0) != 0)
+                        unsupported(op_type, "dlib's average pooling doesn't count the padding");
+                    builder.set_current_buffer(buffer_of(inputs[0]));
+                    inference_op op = builder.new_op(op_type == "MaxPool" ? inference_op_type::max_pool : inference_op_type::avg_pool);
+                    const auto kernel = attrs.get_ints("kernel_shape", {});
+                    if (kernel.size() != 2)
+                        unsupported(op_type, "only 2D pooling is supported");
+                    op.nr = kernel[0];
+                    op.nc = kernel[1];
+                    get_pads(op_type, attrs, op);
+                    builder.push(op);
+                }
+                else if (op_type == "GlobalMaxPool" || op_type == "GlobalAveragePool")
+                {
+                    require_inputs(1, 1);
+                    builder.set_current_buffer(buffer_of(inputs[0]));
+                    builder.push(builder.new_op(op_type == "GlobalMaxPool" ? inference_op_type::max_pool : inference_op_type::avg_pool));
+                }
+                else
+                {
+                    unsupported(op_type, "dlib doesn't support that type of node");
+                }
+
+                set_output(builder, output);
+            }
+
+            void set_output (
+                inference_graph_builder& builder,
+                const std::string& output
+            )
+            {
+                buffers[output] = builder.current_buffer();
+                if (num_readers[output] > 1)
+                    builder.mark_shared(builder.current_buffer());
+            }
+
+            std::map<std::string,onnx_tensor> constants;
+            std::map<std::string,long> buffers;
+            std::map<std::string,long> num_readers;
+            std::set<std::string> flattened;
+            std::set<std::string> resized;
+            std::set<std::string> shape_values;
+            size_t skip_node = (size_t)-1;
+        };
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    void export_to_onnx (
+        const net_type& net,
+        std::ostream& out
+    )
+    {
+        // Build the graph without plan_buffers() so that every op has its own output.
+        impl::inference_graph graph;
+        visit_layers_backwards(net, impl::inference_graph_builder(graph));
+        const std::string data = impl::onnx_exporter().write(graph);
+        out.write(data.data(), data.size());
+        if (!out)
+            throw dlib::error("Error writing the ONNX model.");
+    }
+
+    template <
+        typename net_type
+        >
+    void export_to_onnx (
+        const net_type& net,
+        const std::string& filename
+    )
+    {
+        std::ofstream fout(filename, std::ios::binary);
+        if (!fout)
+            throw dlib::error("Unable to open " + filename + " for writing.");
+        export_to_onnx(net, fout);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline inference_net import_from_onnx (
+        std::istream& in
+    )
+    {
+        const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        auto graph = std::make_shared<impl::inference_graph>();
+        impl::onnx_importer().read(data, *graph);
+        inference_net inet;
+        inet.graph = graph;
+        return inet;
+    }
+
+    inline inference_net import_from_onnx (
+        const std::string& filename
+    )
+    {
+        std::ifstream fin(filename, std::ios::binary);
+        if (!fin)
+            throw dlib::error("Unable to open " + filename + " for reading.");
+        return import_from_onnx(fin);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_ONNX_H_
+
@@ -0,0 +1,117 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DNn_ONNX_ABSTRACT_H_
+#ifdef DLIB_DNn_ONNX_ABSTRACT_H_
+
+#include "inference_abstract.h"
+#include <iostream>
+#include <string>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    void export_to_onnx (
+        const net_type& net,
+        std::ostream& out
+    );
+    /*!
+        requires
+            - net_type is an object of type add_layer, add_loss_layer, add_skip_layer, or
+              add_tag_layer.  It contains only the layer types supported by
+              compile_for_inference().
+            - net has been run forward at least once, so all its layers are allocated.
+        ensures
+            - Writes net to out as an ONNX model, so it can be run by other frameworks
+              and runtimes that read the ONNX format.  The model computes what
+              net.subnet().get_output() (or net.get_output() for networks without a loss
+              layer) contains after a forward pass.  The loss layer isn't exported, so
+              turning the output into labels is up to the program running the model.
+            - The model has one input, named "input", which takes a float tensor of
+              shape [num_samples, k, nr, nc], the form produced by net's to_tensor().
+              Its one output is named "output".  The output of fc_ layers keeps dlib's
+              shape of [num_samples, num_outputs, 1, 1].
+            - Layers are folded together just like compile_for_inference() does, so bn_
+              and affine_ layers after a con_ or fc_ layer don't appear in the model.
+            - The model uses ONNX operator set 13.  Each layer is written as:
+                - con_: Conv
+                - fc_: Flatten, Gemm and Reshape
+                - relu_: Relu
+                - affine_ and bn_: Mul and Add
+                - max_pool_ and avg_pool_: MaxPool and AveragePool, or GlobalMaxPool and
+                  GlobalAveragePool when they pool over the whole image
+                - add_prev_: Add.  When its inputs might have different sizes, both are
+                  first zero padded to the larger size with Pad nodes, as add_prev_ does.
+        throws
+            - dlib::error if net contains a layer that can't be exported.
+    !*/
+
+    template <
+        typename net_type
+        >
+    void export_to_onnx (
+        const net_type& net,
+        const std::string& filename
+    );
+    /*!
+        ensures
+            - performs export_to_onnx(net, out) where out is the file named filename,
+              opened in binary mode.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    inference_net import_from_onnx (
+        std::istream& in
+    );
+    /*!
+        ensures
+            - Reads an ONNX model from in and returns an inference_net that computes the
+              same thing.  Any model written by export_to_onnx() can be read back.
+            - The model must have one input and one output, and the nodes must be in
+              topological order, as the ONNX format requires.  The supported nodes are:
+                - Conv, with group == 1, no dilation and the same padding on both sides
+                  of each dimension.
+                - Gemm, with alpha == beta == 1 and transA == 0, and MatMul.  Their
+                  weights must be constants and the MatMul may be followed by the Add of
+                  a constant bias.
+                - Relu.
+                - BatchNormalization, in inference mode.
+                - Mul and Add of a constant with one value per channel or one value per
+                  element of a sample.
+                - Add of two computed values.
+                - Pad of zeros after the end of each dimension, when it's read by an Add.
+                  The padding may be computed with Shape, Max, Sub and Concat nodes.
+                - MaxPool and AveragePool, with count_include_pad == 0 and ceil_mode ==
+                  0, GlobalMaxPool and GlobalAveragePool.
+                - Flatten, Reshape into [num_samples, -1] or back into 1x1 images,
+                  Identity, Dropout and Constant.
+              All tensors must be 4D images or the 2D output of Flatten or Gemm, and the
+              weights must be floats stored in the model file.
+            - The nodes are folded together the same way compile_for_inference() folds
+              layers, so the returned network is as fast as one compiled from an
+              equivalent dlib network.
+        throws
+            - serialization_error if in doesn't contain a valid ONNX model.
+            - dlib::error if the model contains anything unsupported.
+    !*/
+
+    inference_net import_from_onnx (
+        const std::string& filename
+    );
+    /*!
+        ensures
+            - returns import_from_onnx(in) where in is the file named filename, opened in
+              binary mode.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_ONNX_ABSTRACT_H_
+
@@ -0,0 +1,369 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNn_PROCESS_GROUP_H_
+#define DLIB_DNn_PROCESS_GROUP_H_
+
+#include "process_group_abstract.h"
+#include "../cuda/tensor.h"
+#include "../sockets.h"
+#include "../byte_orderer.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class dnn_process_group
+    {
+    public:
+
+        dnn_process_group(const dnn_process_group&) = delete;
+        dnn_process_group& operator=(const dnn_process_group&) = delete;
+
+        dnn_process_group (
+            size_t rank,
+            const std::vector<network_address>& workers,
+            std::chrono::milliseconds timeout = std::chrono::seconds(60)
+        ) : dnn_process_group(rank, workers, listen_for_previous_worker(rank, workers), timeout)
+        {
+        }
+
+        dnn_process_group (
+            size_t rank,
+            const std::vector<network_address>& workers,
+            std::unique_ptr<listener> list,
+            std::chrono::milliseconds timeout = std::chrono::seconds(60)
+        ) : my_rank(rank), num_workers(workers.size())
+        {
+            DLIB_CASSERT(rank < workers.size());
+            if (num_workers == 1)
+                return;
+            DLIB_CASSERT(list != nullptr);
+
+            using namespace std::chrono;
+            const auto deadline = steady_clock::now() + timeout;
+
+            // The next worker might not be listening yet, so keep trying until it is.
+            // Connecting doesn't need the other side to call accept(), so no worker waits
+            // on another one here.
+            const network_address& next_addr = workers[(my_rank+1)%num_workers];
+            while (true)
+            {
+                try
+                {
+                    next.reset(connect(next_addr));
+                    break;
+                }
+                catch (socket_error&)
+                {
+                    if (steady_clock::now() > deadline)
+                        throw socket_error("dnn_process_group: unable to connect to worker at " + cast_to_string(next_addr));
+                    std::this_thread::sleep_for(milliseconds(50));
+                }
+            }
+
+            const auto time_left = duration_cast<milliseconds>(deadline - steady_clock::now()).count();
+            if (time_left <= 0 || list->accept(prev, std::min<long long>(time_left, 1000000)) != 0)
+                throw socket_error("dnn_process_group: the previous worker never connected to this one");
+            next->disable_nagle();
+            prev->disable_nagle();
+
+            // Make sure the ring is what everyone thinks it is.  The handshake is sent
+            // little endian so it can be read on any machine, but the floats exchanged
+            // later are sent as they are in memory, so the byte orders have to match.
+            byte_orderer bo;
+            std::uint32_t hello[3] = {(std::uint32_t)my_rank, (std::uint32_t)num_workers, (std::uint32_t)bo.host_is_little_endian()};
+            std::uint32_t prev_hello[3];
+            for (auto& v : hello)
+                bo.host_to_little(v);
+            write_all(reinterpret_cast<const char*>(hello), sizeof(hello));
+            read_all(reinterpret_cast<char*>(prev_hello), sizeof(prev_hello));
+            for (auto& v : prev_hello)
+                bo.little_to_host(v);
+            if (prev_hello[0] != (my_rank+num_workers-1)%num_workers || prev_hello[1] != num_workers)
+            {
+                std::ostringstream sout;
+                sout << "dnn_process_group: worker " << my_rank << " of " << num_workers << " was connected to by worker "
+                     << prev_hello[0] << " of " << prev_hello[1] << ".  All workers must be given the same list of workers.";
+                throw socket_error(sout.str());
+            }
+            if (prev_hello[2] != (std::uint32_t)bo.host_is_little_endian())
+            {
+                throw socket_error("dnn_process_group: worker " + cast_to_string(prev_hello[0]) + 
+                    " runs on a machine with a different byte order than worker " + cast_to_string(my_rank) + 
+                    ".  All workers must use the same byte order.");
+            }
+
+            sender = std::thread([this]() { send_thread(); });
+        }
+
+        ~dnn_process_group(
+        )
+        {
+            if (sender.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(send_m);
+                    stopping = true;
+                }
+                send_cv.notify_all();
+                sender.join();
+            }
+            if (next)
+                next->shutdown();
+            if (prev)
+                prev->shutdown();
+        }
+
+        size_t rank (
+        ) const { return my_rank; }
+
+        size_t size (
+        ) const { return num_workers; }
+
+        void sum (
+            float* data,
+            size_t num
+        )
+        {
+            const size_t n = num_workers;
+            if (n == 1 || num == 0)
+                return;
+
+            // The data is split into n chunks.  In the first n-1 steps each worker adds
+            // the chunk it gets from the previous worker to its own and passes the result
+            // on, so that afterwards each worker has the total of one chunk.  In the next
+            // n-1 steps those totals are passed around the ring.
+            auto chunk_begin = [&](size_t c) { return c*num/n; };
+            auto chunk_size = [&](size_t c) { return chunk_begin(c+1) - chunk_begin(c); };
+            buf.resize(num/n + 1);
+            for (size_t s = 0; s+1 < n; ++s)
+            {
+                const size_t send_c = (my_rank + n - s)%n;
+                const size_t recv_c = (my_rank + 2*n - s - 1)%n;
+                exchange(data + chunk_begin(send_c), chunk_size(send_c), buf.data(), chunk_size(recv_c));
+                float* dest = data + chunk_begin(recv_c);
+                for (size_t i = 0; i < chunk_size(recv_c); ++i)
+                    dest[i] += buf[i];
+            }
+            for (size_t s = 0; s+1 < n; ++s)
+            {
+                const size_t send_c = (my_rank + 1 + n - s)%n;
+                const size_t recv_c = (my_rank + n - s)%n;
+                exchange(data + chunk_begin(send_c), chunk_size(send_c), data + chunk_begin(recv_c), chunk_size(recv_c));
+            }
+        }
+
+        void average (
+            const std::vector<tensor*>& tensors
+        )
+        {
+            if (num_workers == 1)
+                return;
+            pack(tensors);
+            sum(packed.data(), packed.size());
+            const float scale = 1.0f/num_workers;
+            for (auto& v : packed)
+                v *= scale;
+            unpack(tensors);
+        }
+
+        void broadcast (
+            float* data,
+            size_t num
+        )
+        {
+            if (num_workers == 1)
+                return;
+            // Pass the data down the chain 0, 1, ..., size()-1 in blocks, so the workers
+            // forward one block while receiving the next.
+            const size_t block_size = 1<<16;
+            for (size_t i = 0; i < num; i += block_size)
+            {
+                const size_t len = std::min(block_size, num-i);
+                if (my_rank != 0)
+                    read_all(reinterpret_cast<char*>(data+i), len*sizeof(float));
+                if (my_rank+1 != num_workers)
+                    write_all(reinterpret_cast<const char*>(data+i), len*sizeof(float));
+            }
+        }
+
+        void broadcast (
+            const std::vector<tensor*>& tensors
+        )
+        {
+            if (num_workers == 1)
+                return;
+            pack(tensors);
+            broadcast(packed.data(), packed.size());
+            unpack(tensors);
+        }
+
+    private:
+
+        static std::unique_ptr<listener> listen_for_previous_worker (
+            size_t rank,
+            const std::vector<network_address>& workers
+        )
+        {
+            DLIB_CASSERT(rank < workers.size());
+            std::unique_ptr<listener> list;
+            if (workers.size() == 1)
+                return list;
+            if (create_listener(list, workers[rank].port) != 0)
+                throw socket_error("dnn_process_group: unable to listen on port " + cast_to_string(workers[rank].port));
+            return list;
+        }
+
+        void pack(const std::vector<tensor*>& tensors)
+        {
+            size_t total = 0;
+            for (auto t : tensors)
+                total += t->size();
+            packed.resize(total);
+            float* p = packed.data();
+            for (auto t : tensors)
+                p = std::copy(t->host(), t->host()+t->size(), p);
+        }
+
+        void unpack(const std::vector<tensor*>& tensors)
+        {
+            const float* p = packed.data();
+            for (auto t : tensors)
+            {
+                std::copy(p, p+t->size(), t->host_write_only());
+                p += t->size();
+            }
+        }
+
+        void exchange (
+            const float* send_data,
+            size_t send_num,
+            float* recv_data,
+            size_t recv_num
+        )
+        /*!
+            ensures
+                - sends send_data to the next worker while receiving recv_data from the
+                  previous one.  This has to happen at the same time, otherwise every
+                  worker could be stuck writing a chunk too big for the socket buffers.
+        !*/
+        {
+            {
+                std::lock_guard<std::mutex> lock(send_m);
+                send_job = reinterpret_cast<const char*>(send_data);
+                send_job_size = send_num*sizeof(float);
+                send_pending = true;
+                send_error = nullptr;
+            }
+            send_cv.notify_all();
+
+            auto wait_for_sender = [&]() {
+                std::unique_lock<std::mutex> lock(send_m);
+                send_cv.wait(lock, [&]{ return !send_pending; });
+            };
+            try
+            {
+                read_all(reinterpret_cast<char*>(recv_data), recv_num*sizeof(float));
+            }
+            catch (...)
+            {
+                // Unblock the sender before waiting on it.
+                next->shutdown_outgoing();
+                wait_for_sender();
+                throw;
+            }
+            wait_for_sender();
+            if (send_error)
+                std::rethrow_exception(send_error);
+        }
+
+        void send_thread (
+        )
+        /*!
+            ensures
+                - writes each buffer exchange() hands over to the next worker, until this
+                  object is destroyed.  The thread lives as long as the process group so
+                  that the ring steps don't each pay for starting a thread.
+        !*/
+        {
+            std::unique_lock<std::mutex> lock(send_m);
+            while (true)
+            {
+                send_cv.wait(lock, [&]{ return stopping || send_pending; });
+                if (stopping)
+                    return;
+
+                const char* data = send_job;
+                const size_t num = send_job_size;
+                lock.unlock();
+                std::exception_ptr eptr;
+                try { write_all(data, num); }
+                catch (...) { eptr = std::current_exception(); }
+                lock.lock();
+
+                send_error = eptr;
+                send_pending = false;
+                send_cv.notify_all();
+            }
+        }
+
+        void write_all(const char* data, size_t num)
+        {
+            while (num != 0)
+            {
+                const long len = (long)std::min<size_t>(num, 1<<30);
+                if (next->write(data, len) != len)
+                    throw socket_error("dnn_process_group: lost the connection to worker " + cast_to_string((my_rank+1)%num_workers));
+                data += len;
+                num -= len;
+            }
+        }
+
+        void read_all(char* data, size_t num)
+        {
+            while (num != 0)
+            {
+                const long len = prev->read(data, (long)std::min<size_t>(num, 1<<30));
+                if (len <= 0)
+                    throw socket_error("dnn_process_group: lost the connection to worker " + cast_to_string((my_rank+num_workers-1)%num_workers));
+                data += len;
+                num -= len;
+            }
+        }
+
+        size_t my_rank;
+        size_t num_workers;
+        std::unique_ptr<connection> next;
+        std::unique_ptr<connection> prev;
+        std::vector<float> buf;
+        std::vector<float> packed;
+
+        // The buffer exchange() hands to send_thread(), which is being sent while
+        // send_pending is true.
+        std::thread sender;
+        std::mutex send_m;
+        std::condition_variable send_cv;
+        const char* send_job = nullptr;
+        size_t send_job_size = 0;
+        bool send_pending = false;
+        std::exception_ptr send_error;
+        bool stopping = false;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_PROCESS_GROUP_H_
+
@@ -0,0 +1,185 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DNn_PROCESS_GROUP_ABSTRACT_H_
+#ifdef DLIB_DNn_PROCESS_GROUP_ABSTRACT_H_
+
+#include "../cuda/tensor_abstract.h"
+#include "../sockets/sockets_extensions_abstract.h"
+#include <memory>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class dnn_process_group
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object connects a set of processes, called workers, that train
+                copies of the same network in data-parallel fashion.  Each worker runs
+                its own dnn_trainer on its own share of every mini-batch, and after each
+                step they all average their parameter gradients, so their networks stay
+                identical.  You use it by creating one dnn_process_group in each worker
+                and giving it to the worker's dnn_trainer with
+                dnn_trainer::set_process_group().
+
+                The workers talk over TCP, so they can be on one machine, e.g. one per
+                NUMA node or socket, or on several.  They are connected in a ring, each
+                worker sending to the next one and receiving from the previous one, and
+                sums are computed with the ring allreduce algorithm.  That is, each
+                worker sends and receives about 2*N*(size()-1)/size() values to sum N
+                values, no matter how many workers there are.
+
+                All the workers must be on machines with the same float format and byte
+                order, since floats are sent as raw bytes.  Workers whose byte orders
+                differ are refused when the process group is created.
+
+            THREAD SAFETY
+                The functions of this object are collective operations.  Every worker
+                must call the same functions, with the same sizes, in the same order,
+                and only one thread may use a dnn_process_group at a time.
+        !*/
+
+    public:
+
+        dnn_process_group(
+            const dnn_process_group&
+        ) = delete;
+        dnn_process_group& operator=(
+            const dnn_process_group&
+        ) = delete;
+
+        dnn_process_group (
+            size_t rank,
+            const std::vector<network_address>& workers,
+            std::chrono::milliseconds timeout = std::chrono::seconds(60)
+        );
+        /*!
+            requires
+                - rank < workers.size()
+            ensures
+                - Connects this worker to the others.  workers[i] is the address of the
+                  worker with rank i, and this worker listens for its previous worker on
+                  the port of workers[rank].  Every worker must be given the same list.
+                - The workers can be started in any order.  This constructor blocks until
+                  this worker is connected to its neighbors in the ring.
+                - #rank() == rank
+                - #size() == workers.size()
+            throws
+                - socket_error if the workers couldn't be connected within timeout,
+                  if they weren't all given the same number of workers, or if the
+                  previous worker's machine has a different byte order.
+        !*/
+
+        dnn_process_group (
+            size_t rank,
+            const std::vector<network_address>& workers,
+            std::unique_ptr<listener> list,
+            std::chrono::milliseconds timeout = std::chrono::seconds(60)
+        );
+        /*!
+            requires
+                - rank < workers.size()
+                - if (workers.size() > 1) then
+                    - list != nullptr
+                    - list is listening on the port the other workers were given as
+                      the port of workers[rank].
+            ensures
+                - Does the same as the constructor above, except that this worker waits
+                  for its previous worker on list rather than creating a listener itself,
+                  so the port of workers[rank] is ignored.  This lets you use a port
+                  picked by the operating system, i.e. create list with
+                  create_listener(list, 0) and tell the other workers
+                  list->get_listening_port() before creating this object.
+            throws
+                - socket_error if the workers couldn't be connected within timeout,
+                  if they weren't all given the same number of workers, or if the
+                  previous worker's machine has a different byte order.
+        !*/
+
+        ~dnn_process_group(
+        );
+        /*!
+            ensures
+                - closes the connections to the other workers.
+        !*/
+
+        size_t rank (
+        ) const;
+        /*!
+            ensures
+                - returns the number that identifies this worker, which is in the range
+                  [0, size()).
+        !*/
+
+        size_t size (
+        ) const;
+        /*!
+            ensures
+                - returns the number of workers.
+        !*/
+
+        void sum (
+            float* data,
+            size_t num
+        );
+        /*!
+            requires
+                - data points to an array of num floats.
+                - all workers call sum() with the same num.
+            ensures
+                - #data[i] == the sum of data[i] over all the workers.  All the workers
+                  get exactly the same result.
+            throws
+                - socket_error if the connection to another worker failed.
+        !*/
+
+        void average (
+            const std::vector<tensor*>& tensors
+        );
+        /*!
+            requires
+                - all workers call average() with tensors of the same sizes.
+            ensures
+                - Replaces each of the tensors with its average over all the workers.
+            throws
+                - socket_error if the connection to another worker failed.
+        !*/
+
+        void broadcast (
+            float* data,
+            size_t num
+        );
+        /*!
+            requires
+                - data points to an array of num floats.
+                - all workers call broadcast() with the same num.
+            ensures
+                - copies the values of data in the worker with rank 0 into the data of
+                  all the other workers.
+            throws
+                - socket_error if the connection to another worker failed.
+        !*/
+
+        void broadcast (
+            const std::vector<tensor*>& tensors
+        );
+        /*!
+            requires
+                - all workers call broadcast() with tensors of the same sizes.
+            ensures
+                - copies the tensors of the worker with rank 0 into the tensors of all the
+                  other workers.
+            throws
+                - socket_error if the connection to another worker failed.
+        !*/
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_PROCESS_GROUP_ABSTRACT_H_
+
@@ -0,0 +1,447 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNn_PROFILER_H_
+#define DLIB_DNn_PROFILER_H_
+
+#include "profiler_abstract.h"
+#include "core.h"
+#include "layers.h"
+#include "../serialize.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    struct dnn_layer_timing
+    {
+        size_t count = 0;
+        double total_seconds = 0;
+
+        double mean_seconds (
+        ) const { return count == 0 ? 0 : total_seconds/count; }
+    };
+
+    struct dnn_layer_profile
+    {
+        size_t index = 0;
+        std::string name;
+
+        long long num_samples = 0;
+        long long k = 0;
+        long long nr = 0;
+        long long nc = 0;
+
+        dnn_layer_timing forward;
+        dnn_layer_timing backward;
+        dnn_layer_timing update;
+
+        double forward_flops = 0;
+        double forward_bytes = 0;
+
+        double total_seconds (
+        ) const { return forward.total_seconds + backward.total_seconds + update.total_seconds; }
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        struct profile_shape
+        {
+            long long n = 0, k = 0, nr = 0, nc = 0;
+            double size() const { return (double)n*k*nr*nc; }
+        };
+
+        inline profile_shape profile_shape_of (
+            const tensor* t
+        )
+        {
+            profile_shape s;
+            if (t)
+            {
+                s.n = t->num_samples();
+                s.k = t->k();
+                s.nr = t->nr();
+                s.nc = t->nc();
+            }
+            return s;
+        }
+
+        // Rough estimates of the floating point operations a layer does in one forward
+        // pass.  Convolutions and fully connected layers do a multiply and an add per
+        // weight use, everything else is taken to do about one operation per output.
+        template <typename LAYER_DETAILS>
+        double estimate_forward_flops (
+            const LAYER_DETAILS&,
+            const profile_shape&,
+            const profile_shape& out
+        ) { return out.size(); }
+
+        template <long nf, long nr, long nc, int sy, int sx, int py, int px>
+        double estimate_forward_flops (
+            const con_<nf,nr,nc,sy,sx,py,px>&,
+            const profile_shape& in,
+            const profile_shape& out
+        ) { return 2.0*out.size()*in.k*nr*nc; }
+
+        template <long nf, long nr, long nc, int sy, int sx, int py, int px>
+        double estimate_forward_flops (
+            const cont_<nf,nr,nc,sy,sx,py,px>&,
+            const profile_shape& in,
+            const profile_shape& out
+        ) { return 2.0*in.size()*out.k*nr*nc; }
+
+        template <long nf, long nr, long nc, int sy, int sx, long ng, int py, int px>
+        double estimate_forward_flops (
+            const grouped_con_<nf,nr,nc,sy,sx,ng,py,px>&,
+            const profile_shape& in,
+            const profile_shape& out
+        ) { return 2.0*out.size()*(in.k/ng)*nr*nc; }
+
+        template <long nr, long nc, int sy, int sx, int py, int px>
+        double estimate_forward_flops (
+            const depthwise_con_<nr,nc,sy,sx,py,px>&,
+            const profile_shape&,
+            const profile_shape& out
+        ) { return 2.0*out.size()*nr*nc; }
+
+        template <unsigned long num_outputs, fc_bias_mode bias_mode>
+        double estimate_forward_flops (
+            const fc_<num_outputs,bias_mode>&,
+            const profile_shape& in,
+            const profile_shape& out
+        ) { return in.n == 0 ? 0 : 2.0*in.size()*out.size()/in.n; }
+
+        template <typename T>
+        std::string layer_profile_name (
+            const T& item
+        )
+        {
+            // Layers print themselves as their name followed by their settings, e.g.
+            // "con\t (num_filters=..."
+            std::ostringstream sout;
+            sout << item;
+            std::string name = sout.str();
+            return name.substr(0, name.find_first_of(" \t\n("));
+        }
+
+        inline std::string json_escape (
+            const std::string& str
+        )
+        {
+            std::string result;
+            for (char c : str)
+            {
+                if (c == '"' || c == '\\')
+                    result += '\\';
+                result += c;
+            }
+            return result;
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    class dnn_profiler : private impl::layer_profiler_hook
+    {
+    public:
+
+        explicit dnn_profiler (
+            net_type& net,
+            size_t max_trace_events_ = 1000000
+        ) : max_trace_events(max_trace_events_), epoch(std::chrono::steady_clock::now())
+        {
+            visit_layers(net, layer_finder(*this));
+        }
+
+        dnn_profiler(const dnn_profiler&) = delete;
+        dnn_profiler& operator=(const dnn_profiler&) = delete;
+
+        ~dnn_profiler (
+        )
+        {
+            stop();
+        }
+
+        void start (
+        )
+        {
+            if (!impl::install_layer_profiler_hook(this))
+                throw dlib::error("Only one dnn_profiler can be running at a time.");
+        }
+
+        void stop (
+        )
+        {
+            // This also waits for layers that are in the middle of a computation to
+            // record it, so it's safe to destroy the profiler once this returns.
+            impl::uninstall_layer_profiler_hook(this);
+        }
+
+        bool is_running (
+        ) const { return impl::active_layer_profiler_hook().load() == this; }
+
+        void clear (
+        )
+        {
+            std::lock_guard<std::mutex> lock(m);
+            for (auto& l : layers)
+            {
+                l.profile.num_samples = l.profile.k = l.profile.nr = l.profile.nc = 0;
+                l.profile.forward = l.profile.backward = l.profile.update = dnn_layer_timing();
+                l.profile.forward_flops = l.profile.forward_bytes = 0;
+            }
+            events.clear();
+            thread_ids.clear();
+            epoch = std::chrono::steady_clock::now();
+        }
+
+        std::vector<dnn_layer_profile> get_layer_profiles (
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            std::vector<dnn_layer_profile> result;
+            for (auto& l : layers)
+                result.push_back(l.profile);
+            return result;
+        }
+
+        void print_table (
+            std::ostream& out
+        ) const
+        {
+            const auto profiles = get_layer_profiles();
+            double total = 0;
+            for (auto& p : profiles)
+                total += p.total_seconds();
+
+            std::ostringstream sout;
+            sout << std::left << std::setw(6) << "layer" << std::setw(22) << "name" << std::setw(20) << "output"
+                 << std::right << std::setw(11) << "fwd ms" << std::setw(11) << "bwd ms" << std::setw(11) << "upd ms"
+                 << std::setw(8) << "%" << std::setw(11) << "GFLOPS" << std::setw(10) << "GB/s" << "\n";
+            for (auto& p : profiles)
+            {
+                std::ostringstream shape;
+                shape << p.num_samples << "x" << p.k << "x" << p.nr << "x" << p.nc;
+                const double fwd = p.forward.mean_seconds();
+                sout << std::left << std::setw(6) << p.index << std::setw(22) << p.name.substr(0,21) << std::setw(20) << shape.str()
+                     << std::right << std::fixed << std::setprecision(3)
+                     << std::setw(11) << fwd*1000
+                     << std::setw(11) << p.backward.mean_seconds()*1000
+                     << std::setw(11) << p.update.mean_seconds()*1000
+                     << std::setprecision(1) << std::setw(8) << (total == 0 ? 0 : 100*p.total_seconds()/total)
+                     << std::setprecision(2) << std::setw(11) << (fwd == 0 ? 0 : p.forward_flops/fwd/1e9)
+                     << std::setw(10) << (fwd == 0 ? 0 : p.forward_bytes/fwd/1e9) << "\n";
+            }
+            sout << "Times are the mean per call, GFLOPS and GB/s are for the forward pass.\n";
+            out << sout.str();
+        }
+
+        void save_chrome_trace (
+            const std::string& filename
+        ) const
+        {
+            std::ofstream fout(filename);
+            if (!fout)
+                throw dlib::error("Unable to open " + filename + " for writing.");
+            write_chrome_trace(fout);
+        }
+
+        void write_chrome_trace (
+            std::ostream& out
+        ) const
+        {
+            static const char* const event_names[] = {"forward", "backward", "update"};
+            std::lock_guard<std::mutex> lock(m);
+            std::ostringstream sout;
+            sout << std::fixed << std::setprecision(3);
+            sout << "{\"traceEvents\":[\n";
+            for (size_t i = 0; i < events.size(); ++i)
+            {
+                const auto& e = events[i];
+                const auto& p = layers[e.layer].profile;
+                sout << "{\"name\":\"" << impl::json_escape(p.name) << " " << p.index << "\","
+                     << "\"cat\":\"" << event_names[(int)e.event] << "\","
+                     << "\"ph\":\"X\",\"pid\":0,\"tid\":" << e.thread
+                     << ",\"ts\":" << e.start_us << ",\"dur\":" << e.duration_us
+                     << ",\"args\":{\"layer\":" << p.index << "}}"
+                     << (i+1 < events.size() ? ",\n" : "\n");
+            }
+            sout << "],\"displayTimeUnit\":\"ms\"}\n";
+            out << sout.str();
+        }
+
+        size_t num_trace_events (
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            return events.size();
+        }
+
+        size_t get_max_trace_events (
+        ) const { return max_trace_events; }
+
+    private:
+
+        struct layer_info
+        {
+            dnn_layer_profile profile;
+            std::function<double(const impl::profile_shape&, const impl::profile_shape&)> flops;
+            double num_params = 0;
+        };
+
+        struct trace_event
+        {
+            size_t layer;
+            impl::layer_profile_event event;
+            size_t thread;
+            double start_us;
+            double duration_us;
+        };
+
+        class layer_finder
+        {
+        public:
+            layer_finder(dnn_profiler& p_) : p(p_) {}
+
+            template <typename T>
+            void operator()(size_t, T&) const {}
+
+            template <typename LOSS_DETAILS, typename SUBNET>
+            void operator()(size_t idx, add_loss_layer<LOSS_DETAILS,SUBNET>& l) const
+            {
+                p.add_layer_info(idx, &l, impl::layer_profile_name(l.loss_details()), 0,
+                    [](const impl::profile_shape& in, const impl::profile_shape&) { return in.size(); });
+            }
+
+            template <typename LAYER_DETAILS, typename SUBNET, typename E>
+            void operator()(size_t idx, add_layer<LAYER_DETAILS,SUBNET,E>& l) const
+            {
+                const LAYER_DETAILS* details = &l.layer_details();
+                p.add_layer_info(idx, &l, impl::layer_profile_name(l.layer_details()), l.layer_details().get_layer_params().size(),
+                    [details](const impl::profile_shape& in, const impl::profile_shape& out) { return impl::estimate_forward_flops(*details, in, out); });
+            }
+
+        private:
+            dnn_profiler& p;
+        };
+
+        template <typename F>
+        void add_layer_info (
+            size_t idx,
+            const void* address,
+            const std::string& name,
+            double num_params,
+            F flops
+        )
+        {
+            layer_info info;
+            info.profile.index = idx;
+            info.profile.name = name;
+            info.flops = flops;
+            info.num_params = num_params;
+            index_of[address] = layers.size();
+            layers.push_back(info);
+        }
+
+        void record (
+            const void* layer,
+            impl::layer_profile_event event,
+            std::chrono::steady_clock::time_point start,
+            std::chrono::steady_clock::time_point stop,
+            const tensor* input,
+            const tensor* output
+        ) override
+        {
+            // Layers of other networks, e.g. the copies dnn_trainer makes for
+            // additional GPUs, aren't part of the network being profiled.
+            auto i = index_of.find(layer);
+            if (i == index_of.end())
+                return;
+
+            const double secs = std::chrono::duration<double>(stop-start).count();
+            std::lock_guard<std::mutex> lock(m);
+            auto& l = layers[i->second];
+            switch (event)
+            {
+                case impl::layer_profile_event::forward:
+                    {
+                        ++l.profile.forward.count;
+                        l.profile.forward.total_seconds += secs;
+                        const auto in = impl::profile_shape_of(input);
+                        const auto out = impl::profile_shape_of(output);
+                        // Loss layers don't have an output tensor so show what they
+                        // were given instead.
+                        const auto& shape = output ? out : in;
+                        l.profile.num_samples = shape.n;
+                        l.profile.k = shape.k;
+                        l.profile.nr = shape.nr;
+                        l.profile.nc = shape.nc;
+                        l.profile.forward_flops = l.flops(in, out);
+                        l.profile.forward_bytes = (in.size() + out.size() + l.num_params)*sizeof(float);
+                    } break;
+                case impl::layer_profile_event::backward:
+                    ++l.profile.backward.count;
+                    l.profile.backward.total_seconds += secs;
+                    break;
+                case impl::layer_profile_event::update:
+                    ++l.profile.update.count;
+                    l.profile.update.total_seconds += secs;
+                    break;
+            }
+
+            if (events.size() < max_trace_events)
+            {
+                auto t = thread_ids.insert(std::make_pair(std::this_thread::get_id(), thread_ids.size())).first;
+                trace_event e;
+                e.layer = i->second;
+                e.event = event;
+                e.thread = t->second;
+                e.start_us = std::chrono::duration<double,std::micro>(start-epoch).count();
+                e.duration_us = secs*1e6;
+                events.push_back(e);
+            }
+        }
+
+        const size_t max_trace_events;
+        std::vector<layer_info> layers;
+        std::unordered_map<const void*, size_t> index_of;
+
+        mutable std::mutex m;
+        std::vector<trace_event> events;
+        std::map<std::thread::id, size_t> thread_ids;
+        std::chrono::steady_clock::time_point epoch;
+    };
+
+    template <typename net_type>
+    std::ostream& operator<< (
+        std::ostream& out,
+        const dnn_profiler<net_type>& item
+    )
+    {
+        item.print_table(out);
+        return out;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_PROFILER_H_
+
@@ -0,0 +1,247 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DNn_PROFILER_ABSTRACT_H_
+#ifdef DLIB_DNn_PROFILER_ABSTRACT_H_
+
+#include "core_abstract.h"
+#include <string>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    struct dnn_layer_timing
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object holds the total time spent on one kind of computation of a
+                layer, e.g. its forward pass, over some number of calls.
+        !*/
+
+        size_t count = 0;
+        double total_seconds = 0;
+
+        double mean_seconds (
+        ) const;
+        /*!
+            ensures
+                - returns total_seconds/count, or 0 if count == 0.
+        !*/
+    };
+
+    struct dnn_layer_profile
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object describes where the time goes in one layer of a network, as
+                measured by a dnn_profiler.
+        !*/
+
+        // The layer is layer<index>(net) and name is the name the layer prints itself
+        // with, e.g. "con" or "loss_multiclass_log".
+        size_t index = 0;
+        std::string name;
+
+        // The dimensions of the layer's output the last time it was run forward.  For
+        // loss layers these are the dimensions of their input instead.
+        long long num_samples = 0;
+        long long k = 0;
+        long long nr = 0;
+        long long nc = 0;
+
+        // The time spent in the layer's own computations, not counting the layers below
+        // it.  For loss layers, forward is the time spent computing the loss and its
+        // gradient.  update is the time spent by the solver updating the layer's
+        // parameters.
+        dnn_layer_timing forward;
+        dnn_layer_timing backward;
+        dnn_layer_timing update;
+
+        // Estimates of the floating point operations done and the bytes of memory
+        // read and written by the last forward pass.  They count the input, output and
+        // parameters once each, so they are rough, but good enough to tell compute
+        // bound layers from memory bound ones.  The backward pass costs about twice as
+        // much as the forward pass.
+        double forward_flops = 0;
+        double forward_bytes = 0;
+
+        double total_seconds (
+        ) const;
+        /*!
+            ensures
+                - returns forward.total_seconds + backward.total_seconds + update.total_seconds
+        !*/
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    class dnn_profiler
+    {
+        /*!
+            REQUIREMENTS ON net_type
+                - net_type is an object of type add_layer, add_loss_layer, add_skip_layer,
+                  or add_tag_layer.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object measures how much time each layer of a network takes.  You
+                make one for your network, call start(), use the network as you normally
+                would, e.g. run it or train it with a dnn_trainer, and then call stop().
+                The time spent in every forward pass, backward pass and solver update of
+                each add_layer, and in the loss computations of the add_loss_layer, is
+                added up over however many iterations were run.  You can then print the
+                results as a table or save them as a trace that the Chrome browser's
+                trace viewer (chrome://tracing) or Perfetto can display.
+
+                The profiling hooks are built into every network.  They cost next to
+                nothing when no profiler is running.  When dlib uses CUDA the profiler
+                waits for the GPU to finish before and after timing each layer, which
+                slows training somewhat but is needed to attribute the time correctly.
+
+                Only the network given to the constructor is profiled.  Networks with the
+                same type, and the copies of the network dnn_trainer makes when it uses
+                more than one GPU, are ignored.
+
+            THREAD SAFETY
+                Only one dnn_profiler can be running at a time.  The network may be run
+                from any thread while the profiler is running.
+        !*/
+
+    public:
+
+        explicit dnn_profiler (
+            net_type& net,
+            size_t max_trace_events = 1000000
+        );
+        /*!
+            ensures
+                - #is_running() == false
+                - #get_layer_profiles() holds one entry, with all counts 0, for each
+                  add_layer and add_loss_layer in net, in the order visit_layers()
+                  visits them.
+                - #get_max_trace_events() == max_trace_events
+                - This object keeps a reference to net, so net must outlive it and must
+                  not be moved.
+        !*/
+
+        ~dnn_profiler (
+        );
+        /*!
+            ensures
+                - calls stop().  So it's safe to destroy a running profiler while the
+                  network is being used in some other thread.
+        !*/
+
+        void start (
+        );
+        /*!
+            ensures
+                - #is_running() == true
+                - Begins recording layer timings.  Calling start() on a running profiler
+                  does nothing.
+            throws
+                - dlib::error if some other dnn_profiler is running.
+        !*/
+
+        void stop (
+        );
+        /*!
+            ensures
+                - #is_running() == false
+                - The results recorded so far are kept.
+                - If other threads are in the middle of running a layer of the network,
+                  waits for them to finish that layer and record it.  No more results are
+                  recorded after stop() returns.
+        !*/
+
+        bool is_running (
+        ) const;
+        /*!
+            ensures
+                - returns true if this profiler is recording layer timings.
+        !*/
+
+        void clear (
+        );
+        /*!
+            ensures
+                - Throws away everything recorded so far.
+        !*/
+
+        std::vector<dnn_layer_profile> get_layer_profiles (
+        ) const;
+        /*!
+            ensures
+                - returns the results for each layer, ordered from the output of the
+                  network to its input.
+        !*/
+
+        void print_table (
+            std::ostream& out
+        ) const;
+        /*!
+            ensures
+                - prints get_layer_profiles() to out as a table, one line per layer,
+                  showing the mean time per call, each layer's share of the total time,
+                  and the GFLOPS and GB/s achieved by its forward pass.
+        !*/
+
+        void write_chrome_trace (
+            std::ostream& out
+        ) const;
+        /*!
+            ensures
+                - writes the recorded computations to out in the Chrome trace event JSON
+                  format.  Each forward pass, backward pass and update of each layer is
+                  one event, and the events are shown on a separate track for each
+                  thread that ran the network.
+        !*/
+
+        void save_chrome_trace (
+            const std::string& filename
+        ) const;
+        /*!
+            ensures
+                - calls write_chrome_trace() on the given file.
+            throws
+                - dlib::error if the file can't be opened.
+        !*/
+
+        size_t num_trace_events (
+        ) const;
+        /*!
+            ensures
+                - returns the number of events that will be written by
+                  write_chrome_trace().
+        !*/
+
+        size_t get_max_trace_events (
+        ) const;
+        /*!
+            ensures
+                - returns the largest number of events this object keeps for
+                  write_chrome_trace().  Once there are that many, further events are
+                  still added to get_layer_profiles() but not to the trace.
+        !*/
+    };
+
+    template <typename net_type>
+    std::ostream& operator<< (
+        std::ostream& out,
+        const dnn_profiler<net_type>& item
+    );
+    /*!
+        ensures
+            - performs item.print_table(out) and returns out.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_PROFILER_ABSTRACT_H_
+
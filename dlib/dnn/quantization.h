@@ -0,0 +1,162 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNn_QUANTIZATION_H_
+#define DLIB_DNn_QUANTIZATION_H_
+
+#include "quantization_abstract.h"
+#include "core.h"
+#include "inference.h"
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class quantized_net;
+
+    template <
+        typename net_type,
+        typename forward_iterator
+        >
+    quantized_net quantize_network (
+        net_type& net,
+        forward_iterator ibegin,
+        forward_iterator iend,
+        size_t mini_batch_size = 32
+    );
+
+// ----------------------------------------------------------------------------------------
+
+    class quantized_net
+    {
+    public:
+
+        quantized_net(
+        ) = default;
+
+        const tensor& forward (
+            const tensor& x
+        )
+        {
+            DLIB_CASSERT(num_ops() != 0);
+            return graph->run(x, buffers);
+        }
+
+        size_t num_ops (
+        ) const { return graph ? graph->ops.size() : 0; }
+
+        size_t num_quantized_layers (
+        ) const { return graph ? graph->num_quantized_ops() : 0; }
+
+        size_t peak_memory_usage (
+        ) const { return buffers.peak_memory_usage(); }
+
+        friend void serialize(const quantized_net& item, std::ostream& out)
+        {
+            serialize("quantized_net", out);
+            serialize(item.graph ? *item.graph : impl::inference_graph(), out);
+        }
+
+        friend void deserialize(quantized_net& item, std::istream& in)
+        {
+            std::string version;
+            deserialize(version, in);
+            if (version != "quantized_net")
+                throw serialization_error("Unexpected version '"+version+"' found while deserializing dlib::quantized_net.");
+            auto graph = std::make_shared<impl::inference_graph>();
+            deserialize(*graph, in);
+            item.graph = graph;
+            item.buffers.clear();
+        }
+
+        friend std::ostream& operator<< (std::ostream& out, const quantized_net& item)
+        {
+            if (item.graph)
+                out << *item.graph;
+            return out;
+        }
+
+    private:
+        template <typename net_type, typename forward_iterator>
+        friend quantized_net quantize_network(net_type&, forward_iterator, forward_iterator, size_t);
+
+        std::shared_ptr<const impl::inference_graph> graph;
+        impl::inference_buffers buffers;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        template <typename T, typename U>
+        void forward_nonloss (
+            add_loss_layer<T,U>& net,
+            const tensor& x
+        )
+        {
+            net.subnet().forward(x);
+        }
+
+        template <typename net_type>
+        void forward_nonloss (
+            net_type& net,
+            const tensor& x
+        )
+        {
+            net.forward(x);
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type,
+        typename forward_iterator
+        >
+    quantized_net quantize_network (
+        net_type& net,
+        forward_iterator ibegin,
+        forward_iterator iend,
+        size_t mini_batch_size
+    )
+    {
+        DLIB_CASSERT(std::distance(ibegin, iend) > 0);
+        DLIB_CASSERT(mini_batch_size > 0);
+
+        resizable_tensor x;
+        auto next_batch = [&](forward_iterator i)
+        {
+            const auto num = std::min<size_t>(mini_batch_size, std::distance(i, iend));
+            const auto end = std::next(i, num);
+            net.to_tensor(i, end, x);
+            return end;
+        };
+
+        // Run the network once so all its layers are allocated.
+        next_batch(ibegin);
+        impl::forward_nonloss(net, x);
+
+        auto graph = std::make_shared<impl::inference_graph>();
+        impl::build_inference_graph(net, *graph);
+
+        // Run the float version of the graph over the samples to find the range of the
+        // inputs to each con_ and fc_ layer.
+        impl::inference_buffers buffers;
+        for (auto i = ibegin; i != iend;)
+        {
+            i = next_batch(i);
+            graph->record_input_ranges(x, buffers);
+        }
+        graph->quantize();
+
+        quantized_net qnet;
+        qnet.graph = graph;
+        return qnet;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_QUANTIZATION_H_
+
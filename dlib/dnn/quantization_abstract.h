@@ -0,0 +1,152 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DNn_QUANTIZATION_ABSTRACT_H_
+#ifdef DLIB_DNn_QUANTIZATION_ABSTRACT_H_
+
+#include "core_abstract.h"
+#include "inference_abstract.h"
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class quantized_net
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object is an inference only copy of a trained deep neural network
+                where the con_ and fc_ layers use 8 bit integer arithmetic.  You create
+                one with quantize_network() and then use it in place of the original
+                network's subnet().forward(), which typically makes the network run a
+                good deal faster on the CPU at the cost of a small loss of accuracy.
+
+                In particular, each con_ and fc_ layer has its filters stored as int8
+                values with one scale per output channel, while its input is quantized
+                to 7 bit unsigned values with a single scale per layer chosen from the
+                range of values seen while running the network on a calibration set.  The
+                products are accumulated in 32 bit integers and the results converted
+                back to float.  So all the other layers still operate on float tensors.
+
+                Other than that, the network is compiled the same way as an inference_net,
+                so affine_, bn_ and relu_ layers are folded into the layers before them and
+                layer outputs share memory.  See inference_net for the details.
+
+                The supported layers are con_, fc_, relu_, affine_, bn_, max_pool_,
+                avg_pool_, add_prev_, tag layers and skip layers.  The computations always
+                happen on the CPU, even if dlib is using CUDA.  The int8 kernels need SIMD
+                instructions to be fast, so build dlib with USE_SSE4_INSTRUCTIONS or
+                USE_AVX_INSTRUCTIONS turned on.  AVX2 and VNNI instructions are also used
+                if the compiler is told to target them (e.g. with -march=native).
+
+            THREAD SAFETY
+                forward() modifies internal buffers, so you need one quantized_net per
+                thread.  The int8 kernels split their work over the threads selected by
+                set_dnn_cpu_num_threads().
+        !*/
+
+    public:
+
+        quantized_net(
+        );
+        /*!
+            ensures
+                - #num_ops() == 0
+        !*/
+
+        const tensor& forward (
+            const tensor& x
+        );
+        /*!
+            requires
+                - num_ops() != 0
+                - x has the form produced by the to_tensor() member of the network this
+                  object was created from.  The input to every fc_ layer must have the
+                  same size it had in that network.
+            ensures
+                - Runs x through the quantized network and returns the result.  This is an
+                  approximation of what the original network's subnet().get_output() (or
+                  get_output() for networks without a loss layer) would contain after a
+                  forward pass on x.
+                - The returned tensor is valid until the next call to forward() or until
+                  this object is modified.
+        !*/
+
+        size_t num_ops (
+        ) const;
+        /*!
+            ensures
+                - returns the number of operations this network runs for each call to
+                  forward().  Layers folded into a con_ or fc_ don't count and neither do
+                  tag and skip layers.
+        !*/
+
+        size_t num_quantized_layers (
+        ) const;
+        /*!
+            ensures
+                - returns the number of con_ and fc_ layers that run with int8 arithmetic.
+        !*/
+
+        size_t peak_memory_usage (
+        ) const;
+        /*!
+            ensures
+                - returns the number of bytes of memory used to hold the outputs of the
+                  operations during the last call to forward(), or 0 if forward() hasn't
+                  been called since this object was created or deserialized.
+        !*/
+    };
+
+    void serialize(const quantized_net& item, std::ostream& out);
+    void deserialize(quantized_net& item, std::istream& in);
+    /*!
+        provides serialization support
+    !*/
+
+    std::ostream& operator<< (std::ostream& out, const quantized_net& item);
+    /*!
+        ensures
+            - prints the operations item runs, one per line, so you can see which layers
+              were folded together.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type,
+        typename forward_iterator
+        >
+    quantized_net quantize_network (
+        net_type& net,
+        forward_iterator ibegin,
+        forward_iterator iend,
+        size_t mini_batch_size = 32
+    );
+    /*!
+        requires
+            - net_type is an object of type add_layer, add_loss_layer, add_skip_layer, or
+              add_tag_layer.  It contains only the layer types listed in the quantized_net
+              documentation.
+            - [ibegin, iend) is a non-empty range of input samples net can process, i.e.
+              net.to_tensor(ibegin, iend, x) is a valid expression.  They should be
+              representative of the data the network will see, since they determine the
+              ranges the layer inputs are quantized to.
+            - mini_batch_size > 0
+        ensures
+            - Runs net on the samples in [ibegin, iend), mini_batch_size at a time, to
+              record the range of the inputs to each con_ and fc_ layer, then returns a
+              quantized_net that computes the same thing as net using int8 arithmetic.
+            - The returned network is independent of net.  net itself is only modified in
+              that it is run forward once on the first mini-batch, which allocates its
+              parameters if that hasn't happened yet.
+        throws
+            - dlib::error if net contains a layer that quantized_net doesn't support.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_QUANTIZATION_ABSTRACT_H_
+
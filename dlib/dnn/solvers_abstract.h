@@ -131,6 +131,71 @@ namespace dlib
         Prints the solver's name and parameters to out.
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    class nesterov_sgd
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object implements the EXAMPLE_SOLVER interface defined above.  It is
+                the same as sgd except that it uses Nesterov momentum, which looks ahead
+                along the momentum direction.  This often converges in fewer steps than
+                sgd's plain momentum.  In particular, it computes the update vector S
+                according to:
+                    G = learning_rate*(weight_decay*l.get_layer_params() + params_grad);
+                    V = momentum*V - G;
+                    S = momentum*V - G;
+                Here V is a momentum term that is remembered by the solver from one
+                invocation of operator() to the next.  All of this is done in a single pass
+                over the tensors by tt::compute_nesterov_update().
+
+
+                Note that the actual learning rate and weight decay used by the solver are
+                multiplied by the per layer multipliers.  That is, the solver will call
+                get_learning_rate_multiplier(l) and get_weight_decay_multiplier(l) and
+                multiply these values with the nominal learning rate and weight decay,
+                respectively, to determine the values it will use during each step.  It is
+                also overloaded to allow additional learning rate multipliers to be applied
+                to fc_ and con_ bias parameters.
+        !*/
+    public:
+
+        nesterov_sgd(
+        ); 
+        /*!
+            ensures
+                - #get_weight_decay()  == 0.0005 
+                - #get_momentum()      == 0.9 
+        !*/
+
+        explicit nesterov_sgd(
+            float weight_decay,
+            float momentum = 0.9
+        ); 
+        /*!
+            requires
+                - weight_decay >= 0
+                - momentum >= 0
+            ensures
+                - #get_weight_decay()  == weight_decay 
+                - #get_momentum()      == momentum 
+        !*/
+
+        float get_weight_decay () const;
+        float get_momentum () const; 
+    };
+
+    void serialize(const nesterov_sgd& item, std::ostream& out);
+    void deserialize(nesterov_sgd& item, std::istream& in);
+    /*!
+        provides serialization support  
+    !*/
+
+    std::ostream& operator<< (std::ostream& out, const nesterov_sgd& item);
+    /*!
+        Prints the solver's name and parameters to out.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     class adam
@@ -196,6 +261,150 @@ namespace dlib
         Prints the solver's name and parameters to out.
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    class adamw
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object implements the EXAMPLE_SOLVER interface defined above.  In
+                particular, it implements the AdamW parameter update method described in
+                the paper:
+                    Loshchilov, Ilya, and Frank Hutter. "Decoupled weight decay
+                    regularization." International Conference on Learning Representations.
+                    2019.
+                This is adam except the weight decay is applied to the parameters directly,
+                rather than being added to the gradient where adam's normalization would
+                scale it differently for each parameter.  So the weight decay works as
+                intended and is typically set much larger than adam's.  The update is
+                computed in a single pass over the tensors by tt::compute_adamw_update().
+
+
+                Note that the actual learning rate and weight decay used by the solver are
+                multiplied by the per layer multipliers.  That is, the solver will call
+                get_learning_rate_multiplier(l) and get_weight_decay_multiplier(l) and
+                multiply these values with the nominal learning rate and weight decay,
+                respectively, to determine the values it will use during each step.  It is
+                also overloaded to allow additional learning rate multipliers to be applied
+                to fc_ and con_ bias parameters.
+        !*/
+
+    public:
+
+        adamw(
+        ); 
+        /*!
+            ensures
+                - #get_weight_decay()  == 0.01 
+                - #get_momentum1()     == 0.9 
+                - #get_momentum2()     == 0.999 
+        !*/
+
+        adamw(
+            float weight_decay,
+            float momentum1, 
+            float momentum2 
+        ); 
+        /*!
+            requires
+                - weight_decay >= 0
+                - 0 <= momentum1 < 1
+                - 0 <= momentum2 < 1
+            ensures
+                - #get_weight_decay()  == weight_decay 
+                - #get_momentum1()     == momentum1
+                - #get_momentum2()     == momentum2
+        !*/
+
+        float get_weight_decay () const;
+        float get_momentum1 () const; 
+        float get_momentum2 () const; 
+    };
+
+    void serialize(const adamw& item, std::ostream& out);
+    void deserialize(adamw& item, std::istream& in);
+    /*!
+        provides serialization support  
+    !*/
+
+    std::ostream& operator<< (std::ostream& out, const adamw& item);
+    /*!
+        Prints the solver's name and parameters to out.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    class lamb
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object implements the EXAMPLE_SOLVER interface defined above.  In
+                particular, it implements the LAMB parameter update method described in the
+                paper:
+                    You, Yang, et al. "Large batch optimization for deep learning: Training
+                    BERT in 76 minutes." International Conference on Learning
+                    Representations. 2020.
+                It computes the same direction as adamw, then scales each layer's step so
+                its length is the learning rate times the length of the layer's
+                parameters.  This makes the step size of every layer right for its scale
+                and lets training use very large mini-batches, and so fewer steps, with
+                a large learning rate.  The weights and biases of fc_, con_, cont_ and bn_
+                layers are scaled separately.  The update is computed by
+                tt::compute_lamb_update().
+
+
+                Note that the actual learning rate and weight decay used by the solver are
+                multiplied by the per layer multipliers.  That is, the solver will call
+                get_learning_rate_multiplier(l) and get_weight_decay_multiplier(l) and
+                multiply these values with the nominal learning rate and weight decay,
+                respectively, to determine the values it will use during each step.  It is
+                also overloaded to allow additional learning rate multipliers to be applied
+                to fc_ and con_ bias parameters.
+        !*/
+
+    public:
+
+        lamb(
+        ); 
+        /*!
+            ensures
+                - #get_weight_decay()  == 0.01 
+                - #get_momentum1()     == 0.9 
+                - #get_momentum2()     == 0.999 
+        !*/
+
+        lamb(
+            float weight_decay,
+            float momentum1, 
+            float momentum2 
+        ); 
+        /*!
+            requires
+                - weight_decay >= 0
+                - 0 <= momentum1 < 1
+                - 0 <= momentum2 < 1
+            ensures
+                - #get_weight_decay()  == weight_decay 
+                - #get_momentum1()     == momentum1
+                - #get_momentum2()     == momentum2
+        !*/
+
+        float get_weight_decay () const;
+        float get_momentum1 () const; 
+        float get_momentum2 () const; 
+    };
+
+    void serialize(const lamb& item, std::ostream& out);
+    void deserialize(lamb& item, std::istream& in);
+    /*!
+        provides serialization support  
+    !*/
+
+    std::ostream& operator<< (std::ostream& out, const lamb& item);
+    /*!
+        Prints the solver's name and parameters to out.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
@@ -0,0 +1,533 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNn_TILED_DETECTION_H_
+#define DLIB_DNn_TILED_DETECTION_H_
+
+#include "tiled_detection_abstract.h"
+#include "inference.h"
+#include "input.h"
+#include "loss.h"
+#include "utilities.h"
+#include "../image_transforms/image_pyramid.h"
+#include "../image_processing/non_max_suppression.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        struct window_layer
+        {
+            long nr, nc;
+            long stride_y, stride_x;
+            long padding_y, padding_x;
+        };
+
+        class visitor_window_layers
+        {
+            /*!
+                Walks a network from its output to its input, like
+                visitor_net_map_output_to_input, and appends the layers that slide a
+                filter or pooling window over their input to layers, in that order.
+                Only the main path through add_prev style layers is followed, which is
+                where all the convolutions are in the detectors this is used for.
+            !*/
+        public:
+            visitor_window_layers(std::vector<window_layer>& layers_) : layers(layers_) {}
+
+            template<typename input_layer_type>
+            void operator()(const input_layer_type& )
+            {
+            }
+
+            template <typename T, typename U>
+            void operator()(const add_loss_layer<T,U>& net)
+            {
+                (*this)(net.subnet());
+            }
+
+            template <typename T, typename U, typename E>
+            void operator()(const add_layer<T,U,E>& net)
+            {
+                add(special_(), net.layer_details());
+                (*this)(net.subnet());
+            }
+            template <bool B, typename T, typename U, typename E>
+            void operator()(const dimpl::subnet_wrapper<add_layer<T,U,E>,B>& net)
+            {
+                add(special_(), net.layer_details());
+                (*this)(net.subnet());
+            }
+
+            template <unsigned long ID, typename U, typename E>
+            void operator()(const add_tag_layer<ID,U,E>& net)
+            {
+                (*this)(net.subnet());
+            }
+            template <bool is_first, unsigned long ID, typename U, typename E>
+            void operator()(const dimpl::subnet_wrapper<add_tag_layer<ID,U,E>,is_first>& net)
+            {
+                (*this)(net.subnet());
+            }
+
+            template <template<typename> class TAG_TYPE, typename U>
+            void operator()(const add_skip_layer<TAG_TYPE,U>& net)
+            {
+                (*this)(layer<TAG_TYPE>(net));
+            }
+            template <bool is_first, template<typename> class TAG_TYPE, typename SUBNET>
+            void operator()(const dimpl::subnet_wrapper<add_skip_layer<TAG_TYPE,SUBNET>,is_first>& net)
+            {
+                (*this)(layer<TAG_TYPE>(net));
+            }
+
+        private:
+
+            // Layers with a filter or pooling window, i.e. con_, max_pool_ and avg_pool_.
+            template <typename layer_type>
+            auto add(special_, const layer_type& l) -> decltype(l.stride_y(), l.padding_y(), l.nr(), l.nc(), void())
+            {
+                if (l.nr() == 0 || l.nc() == 0)
+                    throw dlib::error("tiled_mmod_detector can't be used with layers that pool over their entire input.");
+                layers.push_back(window_layer{l.nr(), l.nc(), l.stride_y(), l.stride_x(), l.padding_y(), l.padding_x()});
+            }
+
+            // Everything else works element by element.
+            template <typename layer_type>
+            void add(general_, const layer_type&)
+            {
+            }
+
+            std::vector<window_layer>& layers;
+        };
+
+        template <typename pyramid_type>
+        void image_to_level_tensor (
+            const input_rgb_image_pyramid<pyramid_type>& input,
+            const matrix<rgb_pixel>& img,
+            resizable_tensor& data
+        )
+        {
+            // This must give exactly the same numbers as input_rgb_image_pyramid::to_tensor().
+            const float avg_red = input.get_avg_red();
+            const float avg_green = input.get_avg_green();
+            const float avg_blue = input.get_avg_blue();
+            data.set_size(1, 3, img.nr(), img.nc());
+            float* r = data.host_write_only();
+            float* g = r + img.size();
+            float* b = g + img.size();
+            for (long y = 0; y < img.nr(); ++y)
+            {
+                for (long x = 0; x < img.nc(); ++x)
+                {
+                    *r++ = (img(y,x).red-avg_red)/256.0;
+                    *g++ = (img(y,x).green-avg_green)/256.0;
+                    *b++ = (img(y,x).blue-avg_blue)/256.0;
+                }
+            }
+        }
+
+        template <typename pyramid_type>
+        void image_to_level_tensor (
+            const input_grayscale_image_pyramid<pyramid_type>& ,
+            const matrix<unsigned char>& img,
+            resizable_tensor& data
+        )
+        {
+            data.set_size(1, 1, img.nr(), img.nc());
+            float* p = data.host_write_only();
+            for (long y = 0; y < img.nr(); ++y)
+            {
+                for (long x = 0; x < img.nc(); ++x)
+                    *p++ = (img(y,x))/256.0;
+            }
+        }
+
+        // Like x%m but always in the range [0, m).
+        inline long positive_mod(long x, long m) { return ((x%m)+m)%m; }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    class tiled_mmod_detector
+    {
+    public:
+
+        typedef typename net_type::input_type input_type;
+
+        explicit tiled_mmod_detector (
+            const net_type& net,
+            long tile_size_ = 512,
+            size_t max_batch_size_ = 4,
+            size_t num_threads_ = 1
+        ) :
+            input(input_layer(net)),
+            options(net.loss_details().get_options()),
+            inet(compile_for_inference(net)),
+            tile_size(tile_size_),
+            max_batch_size(max_batch_size_),
+            num_threads(num_threads_)
+        {
+            DLIB_CASSERT(tile_size > 0);
+            DLIB_CASSERT(max_batch_size > 0);
+            DLIB_CASSERT(num_threads > 0);
+
+            // The networks used for detection map the output tensor back to the input
+            // with a fixed stride and offset.  Find them so we know where the outputs
+            // of each tile are without keeping the network around.
+            const dpoint p0 = output_tensor_to_input_tensor(net.subnet(), dpoint(0,0));
+            const dpoint p1 = output_tensor_to_input_tensor(net.subnet(), dpoint(1,1));
+            stride_x = std::lround(p1.x()-p0.x());
+            stride_y = std::lround(p1.y()-p0.y());
+            offset_x = p0.x();
+            offset_y = p0.y();
+            DLIB_CASSERT(stride_x > 0 && stride_y > 0);
+
+            impl::visitor_window_layers temp(layers);
+            temp(net);
+
+            // The receptive field is centered on the point each output maps to, so the
+            // tiles need to extend past their cores by half of it.
+            long rf_nr = 1, rf_nc = 1;
+            for (auto&& l : layers)
+            {
+                rf_nr = (rf_nr-1)*l.stride_y + l.nr;
+                rf_nc = (rf_nc-1)*l.stride_x + l.nc;
+            }
+            margin = std::max(rf_nr, rf_nc)/2 + 1;
+
+            // How many outputs a tile needs in front of its core to see margin pixels
+            // in front of it.
+            lead_x = std::max(0L, (long)std::ceil((margin - offset_x)/stride_x));
+            lead_y = std::max(0L, (long)std::ceil((margin - offset_y)/stride_y));
+        }
+
+        tiled_mmod_detector(const tiled_mmod_detector&) = delete;
+        tiled_mmod_detector& operator=(const tiled_mmod_detector&) = delete;
+
+        long get_tile_size (
+        ) const { return tile_size; }
+
+        size_t get_max_batch_size (
+        ) const { return max_batch_size; }
+
+        size_t get_num_threads (
+        ) const { return num_threads; }
+
+        long get_margin (
+        ) const { return margin; }
+
+        size_t peak_memory_usage (
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            return peak_memory;
+        }
+
+        std::vector<mmod_rect> operator() (
+            const input_type& img,
+            double adjust_threshold = 0
+        ) const
+        {
+            pyramid_type pyr;
+
+            // Lay out the pyramid the same way the input layer would, so the outputs of
+            // the tiles line up with the outputs the whole network would compute.
+            std::vector<rectangle> rects;
+            long pyramid_nr, pyramid_nc;
+            impl::compute_tiled_image_pyramid_details(pyr, img.nr(), img.nc(), input.get_pyramid_padding(),
+                input.get_pyramid_outer_padding(), rects, pyramid_nr, pyramid_nc);
+            if (rects.size() == 0)
+                return std::vector<mmod_rect>();
+
+            // The size of the output the whole network would compute for that image.
+            long out_nr = pyramid_nr, out_nc = pyramid_nc;
+            for (auto l = layers.rbegin(); l != layers.rend(); ++l)
+            {
+                out_nr = 1+(out_nr+2*l->padding_y-l->nr)/l->stride_y;
+                out_nc = 1+(out_nc+2*l->padding_x-l->nc)/l->stride_x;
+            }
+            if (out_nr <= 0 || out_nc <= 0)
+                return std::vector<mmod_rect>();
+
+            // Every tile has the same size so they can be run as a batch.  The tiles at
+            // the bottom and right end where the pyramid image does, so that every layer
+            // of the network sees the same edges in them as in the whole image.  That
+            // only works if their size keeps them on the grid of strides.
+            const long core_nr = std::min(out_nr, std::max(1L, tile_size/stride_y));
+            const long core_nc = std::min(out_nc, std::max(1L, tile_size/stride_x));
+            long tile_nr = (long)std::ceil((lead_y+core_nr-1)*stride_y + offset_y) + margin + 1;
+            long tile_nc = (long)std::ceil((lead_x+core_nc-1)*stride_x + offset_x) + margin + 1;
+            tile_nr = std::min(pyramid_nr, tile_nr + impl::positive_mod(pyramid_nr - tile_nr, stride_y));
+            tile_nc = std::min(pyramid_nc, tile_nc + impl::positive_mod(pyramid_nc - tile_nc, stride_x));
+
+            // Split the output into the cores of the tiles.
+            std::vector<tile> tiles;
+            for (long y = 0; y < out_nr; y += core_nr)
+            {
+                for (long x = 0; x < out_nc; x += core_nc)
+                {
+                    tile t;
+                    t.core = rectangle(x, y, x+core_nc-1, y+core_nr-1).intersect(rectangle(out_nc, out_nr));
+                    t.origin.x() = std::max(0L, std::min((x-lead_x)*stride_x, pyramid_nc-tile_nc));
+                    t.origin.y() = std::max(0L, std::min((y-lead_y)*stride_y, pyramid_nr-tile_nr));
+                    tiles.push_back(t);
+                }
+            }
+
+            // The tiles are cut out of the tiled pyramid image, which is never made.
+            // Only its levels are kept, without the padding between them.
+            std::vector<resizable_tensor> levels(rects.size());
+            impl::image_to_level_tensor(input, img, levels[0]);
+            for (size_t l = 1; l < rects.size(); ++l)
+            {
+                levels[l].set_size(1, levels[l-1].k(), rects[l].height(), rects[l].width());
+                tt::resize_bilinear(levels[l], levels[l-1]);
+            }
+
+            std::vector<detection> dets;
+            run_tiles(levels, rects, tiles, tile_nr, tile_nc, adjust_threshold, dets);
+
+            // Non-max suppression over everything found, the same as loss_mmod_ does.
+            std::stable_sort(dets.begin(), dets.end(), [](const detection& a, const detection& b)
+                             { return a.detection_confidence > b.detection_confidence; });
+            std::vector<rectangle> boxes;
+            boxes.reserve(dets.size());
+            for (auto&& d : dets)
+                boxes.push_back(d.rect_bbr);
+            std::vector<mmod_rect> final_dets;
+            for (auto i : non_max_suppression(options.overlaps_nms, boxes))
+                final_dets.push_back(mmod_rect(dets[i].rect_bbr, dets[i].detection_confidence, options.detector_windows[dets[i].channel].label));
+            return final_dets;
+        }
+
+    private:
+
+        typedef typename std::decay<decltype(input_layer(std::declval<const net_type&>()))>::type input_layer_type;
+        typedef typename input_layer_type::pyramid_type pyramid_type;
+
+        struct detection
+        {
+            drectangle rect_bbr;
+            double detection_confidence;
+            long channel;
+        };
+
+        struct tile
+        {
+            // The outputs, of the network run on the whole tiled pyramid image, whose
+            // detections come from this tile and where the tile starts in that image.
+            rectangle core;
+            point origin;
+        };
+
+        struct context
+        {
+            inference_net net;
+            resizable_tensor x;
+        };
+
+        dpoint output_to_pyramid (
+            long c,
+            long r
+        ) const
+        {
+            return dpoint(c*stride_x + offset_x, r*stride_y + offset_y);
+        }
+
+        void run_tiles (
+            const std::vector<resizable_tensor>& levels,
+            const std::vector<rectangle>& rects,
+            const std::vector<tile>& tiles,
+            const long tile_nr,
+            const long tile_nc,
+            const double adjust_threshold,
+            std::vector<detection>& dets
+        ) const
+        {
+            const size_t num_batches = (tiles.size() + max_batch_size-1)/max_batch_size;
+            std::vector<std::vector<detection>> batch_dets(num_batches);
+            std::atomic<size_t> next_batch(0);
+            std::exception_ptr eptr;
+            auto work = [&]()
+            {
+                try
+                {
+                    auto ctx = get_context();
+                    size_t b;
+                    while ((b = next_batch++) < num_batches)
+                    {
+                        const size_t begin = b*max_batch_size;
+                        const size_t end = std::min(tiles.size(), begin+max_batch_size);
+                        run_batch(*ctx, levels, rects, tiles, begin, end, tile_nr, tile_nc, adjust_threshold, batch_dets[b]);
+                    }
+                    release_context(std::move(ctx));
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    if (!eptr)
+                        eptr = std::current_exception();
+                }
+            };
+
+            const size_t threads_to_use = std::min(num_threads, num_batches);
+            std::vector<std::thread> threads;
+            for (size_t i = 1; i < threads_to_use; ++i)
+                threads.emplace_back(work);
+            work();
+            for (auto& t : threads)
+                t.join();
+            if (eptr)
+                std::rethrow_exception(eptr);
+
+            for (auto& d : batch_dets)
+                dets.insert(dets.end(), d.begin(), d.end());
+        }
+
+        void run_batch (
+            context& ctx,
+            const std::vector<resizable_tensor>& levels,
+            const std::vector<rectangle>& rects,
+            const std::vector<tile>& tiles,
+            const size_t begin,
+            const size_t end,
+            const long tile_nr,
+            const long tile_nc,
+            const double adjust_threshold,
+            std::vector<detection>& dets
+        ) const
+        {
+            // Copy the part of each level that the tile covers into x.  Everything else
+            // is 0, like the padding in the input layer's tiled pyramid image.
+            const long k = levels[0].k();
+            ctx.x.set_size(end-begin, k, tile_nr, tile_nc);
+            float* x = ctx.x.host_write_only();
+            std::fill(x, x+ctx.x.size(), 0.0f);
+            for (size_t i = begin; i < end; ++i)
+            {
+                const rectangle area = translate_rect(rectangle(tile_nc, tile_nr), tiles[i].origin);
+                for (size_t l = 0; l < levels.size(); ++l)
+                {
+                    const rectangle part = area.intersect(rects[l]);
+                    if (part.is_empty())
+                        continue;
+                    const tensor& level = levels[l];
+                    for (long c = 0; c < k; ++c)
+                    {
+                        const float* plane = level.host() + c*level.nr()*level.nc();
+                        for (long r = part.top(); r <= part.bottom(); ++r)
+                        {
+                            const float* in = plane + (r-rects[l].top())*level.nc() + part.left()-rects[l].left();
+                            float* row = x + (c*tile_nr + r-area.top())*tile_nc + part.left()-area.left();
+                            std::copy(in, in+part.width(), row);
+                        }
+                    }
+                }
+                x += k*tile_nr*tile_nc;
+            }
+
+            const tensor& out = ctx.net.forward(ctx.x);
+            {
+                std::lock_guard<std::mutex> lock(m);
+                peak_memory = std::max(peak_memory, ctx.net.peak_memory_usage() + ctx.x.size()*sizeof(float));
+            }
+
+            const long num_windows = options.detector_windows.size();
+            const float* out_data = out.host();
+            const long plane_size = out.nr()*out.nc();
+            std::vector<unsigned long> positives;
+            for (size_t i = begin; i < end; ++i, out_data += out.k()*plane_size)
+            {
+                // The tile starts on the grid of strides, so its outputs are those of
+                // the whole network, shifted by this much.
+                const long first_c = tiles[i].origin.x()/stride_x;
+                const long first_r = tiles[i].origin.y()/stride_y;
+                // This mirrors loss_mmod_::tensor_to_dets().
+                find_scores_above_threshold(out_data, num_windows*plane_size, adjust_threshold, positives);
+                for (auto idx : positives)
+                {
+                    const long kk = idx/plane_size;
+                    const long r = (idx%plane_size)/out.nc();
+                    const long c = idx%out.nc();
+                    const double score = out_data[idx];
+
+                    if (!tiles[i].core.contains(c+first_c, r+first_r))
+                        continue;
+                    drectangle rect = centered_drect(output_to_pyramid(c+first_c, r+first_r),
+                        options.detector_windows[kk].width, options.detector_windows[kk].height);
+                    rect = tiled_pyramid_to_image<pyramid_type>(rects, rect);
+
+                    if (options.use_bounding_box_regression)
+                    {
+                        const auto offset = num_windows + kk*4;
+                        double dx = out_data[((offset+0)*out.nr() + r)*out.nc() + c];
+                        double dy = out_data[((offset+1)*out.nr() + r)*out.nc() + c];
+                        double dw = out_data[((offset+2)*out.nr() + r)*out.nc() + c];
+                        double dh = out_data[((offset+3)*out.nr() + r)*out.nc() + c];
+                        dw = std::exp(dw);
+                        dh = std::exp(dh);
+                        double w = rect.width()-1;
+                        double h = rect.height()-1;
+                        rect = translate_rect(rect, dpoint(dx*w,dy*h));
+                        rect = centered_drect(rect, w*dw+1, h*dh+1);
+                    }
+
+                    dets.push_back(detection{rect, score, kk});
+                }
+            }
+        }
+        std::unique_ptr<context> get_context (
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (free_contexts.empty())
+                return std::unique_ptr<context>(new context{inet, resizable_tensor()});
+            auto ctx = std::move(free_contexts.back());
+            free_contexts.pop_back();
+            return ctx;
+        }
+
+        void release_context (
+            std::unique_ptr<context> ctx
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            free_contexts.push_back(std::move(ctx));
+        }
+
+        const input_layer_type input;
+        const mmod_options options;
+        const inference_net inet;
+        const long tile_size;
+        const size_t max_batch_size;
+        const size_t num_threads;
+        std::vector<impl::window_layer> layers;
+        long stride_x, stride_y;
+        double offset_x, offset_y;
+        long margin;
+        long lead_x, lead_y;
+
+        mutable std::mutex m;
+        mutable std::vector<std::unique_ptr<context>> free_contexts;
+        mutable size_t peak_memory = 0;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_TILED_DETECTION_H_
+
@@ -0,0 +1,155 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DNn_TILED_DETECTION_ABSTRACT_H_
+#ifdef DLIB_DNn_TILED_DETECTION_ABSTRACT_H_
+
+#include "inference_abstract.h"
+#include "loss_abstract.h"
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    class tiled_mmod_detector
+    {
+        /*!
+            REQUIREMENTS ON net_type
+                - net_type is a loss_mmod network whose input layer is an
+                  input_rgb_image_pyramid or an input_grayscale_image_pyramid.
+                - The subnetwork contains only the layer types listed in the
+                  inference_net documentation and no layer pools over its whole input.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object finds objects in very large images with a trained MMOD
+                detector while using a bounded amount of memory.
+
+                When you run a loss_mmod network on an image, the input layer puts the
+                whole image pyramid into one tiled pyramid image and every layer of the
+                network then holds its output for all of it.  For a 20 megapixel image
+                that's gigabytes of memory.  This object instead splits the network's
+                output into tiles of at most get_tile_size() by get_tile_size() pixels of
+                that tiled pyramid image and runs the network on one tile at a time.  Each
+                tile is extended by get_margin() pixels on every side, half the size of
+                the network's receptive field, so the network sees the same pixels around
+                every location it scores as it would in the whole image.  The tiles are
+                run through the network get_max_batch_size() at a time, optionally from
+                several threads, and then the detections from all the tiles are merged
+                with the same non-max suppression loss_mmod_ uses.
+
+                The tiles are placed on the same grid of strides as the network's
+                outputs, and each output is mapped back to the image the way the input
+                layer's tensor_space_to_image_space() does, i.e. through the pyramid
+                level nearest to it in the tiled pyramid image.  That includes the outputs
+                in the padding and in the parts of the tiled pyramid image no level
+                covers.  So the detections are the same as those of net(img), up to
+                floating point rounding.
+
+                The network is run as an inference_net, so bn_ layers always use their
+                running statistics, as they do when a network is run on a single image.
+
+                The memory used for the network's layers is proportional to
+                get_max_batch_size()*get_num_threads() tiles rather than to the size of
+                the image.  The levels of the image pyramid are also kept in memory as
+                floats while it's processed, which is about as much memory as the input
+                layer's tensor takes without the padding between the levels.
+
+            THREAD SAFETY
+                It is safe to call the const members of this object from any number of
+                threads at the same time.
+        !*/
+
+    public:
+
+        typedef typename net_type::input_type input_type;
+
+        explicit tiled_mmod_detector (
+            const net_type& net,
+            long tile_size = 512,
+            size_t max_batch_size = 4,
+            size_t num_threads = 1
+        );
+        /*!
+            requires
+                - tile_size > 0
+                - max_batch_size > 0
+                - num_threads > 0
+                - net has been run forward at least once, so all its layers are allocated.
+            ensures
+                - #get_tile_size() == tile_size
+                - #get_max_batch_size() == max_batch_size
+                - #get_num_threads() == num_threads
+                - #peak_memory_usage() == 0
+                - This object detects the same objects as net.  net isn't referenced after
+                  the constructor returns.
+            throws
+                - dlib::error if net contains a layer that inference_net doesn't support.
+        !*/
+
+        tiled_mmod_detector(const tiled_mmod_detector&) = delete;
+        tiled_mmod_detector& operator=(const tiled_mmod_detector&) = delete;
+
+        long get_tile_size (
+        ) const;
+        /*!
+            ensures
+                - returns the largest height and width, in pixels of the input layer's
+                  tiled pyramid image, of the part of it each tile finds detections in.
+        !*/
+
+        size_t get_max_batch_size (
+        ) const;
+        /*!
+            ensures
+                - returns the largest number of tiles run through the network at once.
+        !*/
+
+        size_t get_num_threads (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads operator() uses to run the tiles.
+        !*/
+
+        long get_margin (
+        ) const;
+        /*!
+            ensures
+                - returns the number of pixels each tile extends past the part of the
+                  image it finds detections in.  This is half the size of the network's
+                  receptive field, worked out from its convolution and pooling layers,
+                  plus one pixel.
+        !*/
+
+        size_t peak_memory_usage (
+        ) const;
+        /*!
+            ensures
+                - returns the largest number of bytes used by the network for one batch
+                  of tiles, including the tiles themselves, so far.  Each thread uses
+                  this much.  See inference_net::peak_memory_usage().
+        !*/
+
+        std::vector<mmod_rect> operator() (
+            const input_type& img,
+            double adjust_threshold = 0
+        ) const;
+        /*!
+            ensures
+                - returns the objects found in img, the same as net(img, adjust_threshold)
+                  would for the net this object was made from, subject to the notes
+                  above.
+                - The detections are sorted from the most to the least confident.
+        !*/
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_TILED_DETECTION_ABSTRACT_H_
+
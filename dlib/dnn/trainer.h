@@ -6,6 +6,8 @@
 #include "trainer_abstract.h"
 #include "core.h"
 #include "solvers.h"
+#include "data_loader.h"
+#include "process_group.h"
 #include "../statistics.h"
 #include <chrono>
 #include <fstream>
@@ -160,6 +162,28 @@ namespace dlib
             mini_batch_size = batch_size;
         }
 
+        unsigned long get_micro_batch_size (
+        ) const { return micro_batch_size; }
+
+        void set_micro_batch_size (
+            unsigned long batch_size 
+        )
+        {
+            micro_batch_size = batch_size;
+        }
+
+        void set_process_group (
+            dnn_process_group& group
+        )
+        {
+            wait_for_thread_to_pause();
+            propagate_exception();
+            process_group = &group;
+        }
+
+        dnn_process_group* get_process_group (
+        ) const { return process_group; }
+
         unsigned long get_max_num_epochs (
         ) const { return max_num_epochs; }
 
@@ -243,6 +267,17 @@ namespace dlib
             ++train_one_step_calls;
         }
 
+        void train_one_step (
+            dnn_data_loader<net_type>& loader
+        )
+        {
+            print_periodic_verbose_status();
+            sync_to_disk();
+            loader.get_next(loaded_batch);
+            send_job(false, loaded_batch);
+            ++train_one_step_calls;
+        }
+
         void test_one_step (
             const std::vector<input_type>& data,
             const std::vector<training_label_type>& labels 
@@ -294,6 +329,17 @@ namespace dlib
             ++test_one_step_calls;
         }
 
+        void test_one_step (
+            dnn_data_loader<net_type>& loader
+        )
+        {
+            print_periodic_verbose_status();
+            sync_to_disk();
+            loader.get_next(loaded_batch);
+            send_job(true, loaded_batch);
+            ++test_one_step_calls;
+        }
+
         void train (
             const std::vector<input_type>& data,
             const std::vector<training_label_type>& labels 
@@ -305,13 +351,13 @@ namespace dlib
             // instead use class members is so we can include the state of the loops in the
             // stuff written by sync_to_disk()
             for (; 
-                epoch_iteration < max_num_epochs && learning_rate >= min_learning_rate; 
+                epoch_iteration < max_num_epochs && get_learning_rate() >= min_learning_rate; 
                 ++epoch_iteration)
             {
                 using namespace std::chrono;
                 last_time = system_clock::now();
                 clear_average_loss();
-                for (; epoch_pos < data.size() && learning_rate >= min_learning_rate; epoch_pos += mini_batch_size)
+                for (; epoch_pos < data.size() && get_learning_rate() >= min_learning_rate; epoch_pos += mini_batch_size)
                 {
                     if (verbose)
                     {
@@ -363,13 +409,13 @@ namespace dlib
             // instead use class members is so we can include the state of the loops in the
             // stuff written by sync_to_disk()
             for (; 
-                epoch_iteration < max_num_epochs && learning_rate >= min_learning_rate; 
+                epoch_iteration < max_num_epochs && get_learning_rate() >= min_learning_rate; 
                 ++epoch_iteration)
             {
                 using namespace std::chrono;
                 last_time = system_clock::now();
                 clear_average_loss();
-                for (; epoch_pos < data.size() && learning_rate >= min_learning_rate; epoch_pos += mini_batch_size)
+                for (; epoch_pos < data.size() && get_learning_rate() >= min_learning_rate; epoch_pos += mini_batch_size)
                 {
                     if (verbose)
                     {
@@ -611,10 +657,11 @@ namespace dlib
             {
                 auto&& dev = *devices[device];
                 dlib::cuda::set_device(dev.device_id);
+                auto lbegin = next_job.labels[device].begin();
                 if (next_job.test_only)
-                    return dev.net.compute_loss(next_job.t[device], next_job.labels[device].begin());
+                    return run_micro_batches(device, next_job.t[device], false, [&](const tensor& x, size_t start) { return dev.net.compute_loss(x, lbegin+start); });
                 else
-                    return dev.net.compute_parameter_gradients(next_job.t[device], next_job.labels[device].begin());
+                    return run_micro_batches(device, next_job.t[device], true, [&](const tensor& x, size_t start) { return dev.net.compute_parameter_gradients(x, lbegin+start); });
             }
             else
             {
@@ -630,9 +677,9 @@ namespace dlib
                 dlib::cuda::set_device(dev.device_id);
                 no_label_type pick_which_run_update;
                 if (next_job.test_only)
-                    return dev.net.compute_loss(next_job.t[device]);
+                    return run_micro_batches(device, next_job.t[device], false, [&](const tensor& x, size_t) { return dev.net.compute_loss(x); });
                 else
-                    return dev.net.compute_parameter_gradients(next_job.t[device]);
+                    return run_micro_batches(device, next_job.t[device], true, [&](const tensor& x, size_t) { return dev.net.compute_parameter_gradients(x); });
             }
             else
             {
@@ -640,6 +687,69 @@ namespace dlib
             }
         }
 
+        // Calls run(part, start) on each micro-batch of x, where part holds the samples
+        // of x starting with sample number start, and returns the average of the losses
+        // it returns, weighted by the micro-batch sizes.  If compute_gradients then the
+        // network's parameter gradients are left holding the same weighted average of
+        // the micro-batch gradients.
+        template <typename run_fn>
+        double run_micro_batches(
+            size_t device,
+            const tensor& x,
+            bool compute_gradients,
+            run_fn run
+        )
+        {
+            auto&& dev = *devices[device];
+            const size_t num = x.num_samples()/dev.net.sample_expansion_factor();
+            const size_t micro_size = micro_batch_size;
+            if (micro_size == 0 || num <= micro_size)
+                return run(x, 0);
+
+            const size_t rows_per_sample = dev.net.sample_expansion_factor();
+            const size_t row_size = x.k()*x.nr()*x.nc();
+            dev.accumulated_gradients.resize(num_computational_layers);
+            double loss = 0;
+            for (size_t start = 0; start < num; start += micro_size)
+            {
+                const size_t stop = std::min(num, start+micro_size);
+                const bool is_last = stop == num;
+                const float weight = (stop-start)/(double)num;
+
+                alias_tensor part((stop-start)*rows_per_sample, x.k(), x.nr(), x.nc());
+                dev.micro_batch.set_size(part.num_samples(), part.k(), part.nr(), part.nc());
+                memcpy(dev.micro_batch, part(x, start*rows_per_sample*row_size));
+                loss += weight*run(dev.micro_batch, start);
+
+                if (!compute_gradients)
+                    continue;
+
+                // Sum the weighted gradients in accumulated_gradients, except for the
+                // last micro-batch, whose gradients are added to the sum in place so the
+                // result ends up where update_parameters() looks for it.
+                visit_layer_parameter_gradients(dev.net, [&](size_t i, tensor& g)
+                {
+                    if (g.size() == 0)
+                        return;
+                    resizable_tensor& acc = dev.accumulated_gradients[i];
+                    if (start == 0)
+                    {
+                        acc.copy_size(g);
+                        tt::affine_transform(acc, g, weight);
+                    }
+                    else if (!is_last)
+                    {
+                        tt::add(1, acc, weight, g);
+                    }
+                    else
+                    {
+                        tt::add(weight, g, 1, acc);
+                    }
+                });
+            }
+            return loss;
+        }
+
         void update_parameters(size_t device)
         {
             auto&& dev = *devices[device];
@@ -674,8 +784,21 @@ namespace dlib
 
 
             main_iteration_counter = 0;
+            size_t num_jobs_processed = 0;
+            auto last_sync_request_time = std::chrono::steady_clock::now();
             while(job_pipe.dequeue(next_job))
             {
+                const size_t job_number = num_jobs_processed++;
+
+                // The workers in a process group have to stop training at the same step,
+                // but each one checks the learning rate while its training thread is
+                // somewhere in the middle of a step, so some might send more jobs than
+                // others.  So the jobs are dropped here instead, once the learning rate
+                // is below the minimum.  The averaging of the losses in each step keeps
+                // the learning rate the same on every worker, so they all drop the same
+                // jobs without having to tell each other.
+                if (process_group && learning_rate < min_learning_rate)
+                    continue;
                 if (next_job.test_only)
                 {
                     // compute the testing loss
@@ -685,7 +808,10 @@ namespace dlib
                     double theloss = 0;
                     for (auto&& loss : losses)
                         theloss += loss.get();
-                    record_test_loss(theloss/losses.size());
+                    theloss /= losses.size();
+                    if (process_group)
+                        reduce_over_process_group(theloss, false, job_number, last_sync_request_time);
+                    record_test_loss(theloss);
 
                     // Check if we should shrink the learning rate based on how the test
                     // error has been doing lately.
@@ -721,7 +847,7 @@ namespace dlib
                 double theloss = 0;
                 for (auto&& loss : losses)
                     theloss += loss.get();
-                record_loss(theloss/losses.size());
+                theloss /= losses.size();
 
                 // Now, if there is more than one active device we need to synchronize the
                 // gradient updates between devices.  So we do that now.
@@ -766,6 +892,11 @@ namespace dlib
                         avg.average();
                 }
 
+                // And then between the processes in the process group, if there is one.
+                if (process_group)
+                    reduce_over_process_group(theloss, true, job_number, last_sync_request_time);
+                record_loss(theloss);
+
 
                 // Now apply all the updates to each device.
                 for (size_t i = 0; i < devices.size(); ++i)
@@ -781,6 +912,8 @@ namespace dlib
                 // the different networks may be initialized differently when tensor data
                 // is first passed through them.  So this code block deals with these
                 // issues.
+                if (process_group && main_iteration_counter%2000 == 1)
+                    process_group->broadcast(reference_params);
                 if (devices.size() > 1 && main_iteration_counter%2000 == 1)
                 {
                     for (size_t i = 1; i < devices.size(); ++i)
@@ -844,6 +977,57 @@ namespace dlib
             eptr = std::current_exception();
         }
 
+        void reduce_over_process_group (
+            double& loss,
+            bool include_gradients,
+            size_t job_number,
+            std::chrono::steady_clock::time_point& last_sync_request_time
+        )
+        {
+            // Average the loss, and the gradients if this is a training step, over all
+            // the workers.  Since they all then record the same loss and apply the same
+            // update, their learning rates and networks stay the same too.
+            std::vector<tensor*> grads(num_computational_layers);
+            std::vector<tensor*> tensors;
+            if (include_gradients)
+            {
+                visit_layer_parameter_gradients(devices[0]->net, [&](size_t j, tensor& t) {
+                    grads[j] = &t;
+                    if (t.size() != 0)
+                        tensors.push_back(&t);
+                });
+            }
+
+            // The workers also have to sync to disk at the same step, so the one with rank 0
+            // decides when that is and tells the others here.
+            const auto now = std::chrono::steady_clock::now();
+            const bool request_sync = process_group->rank() == 0 && now - last_sync_request_time > time_between_syncs;
+            if (request_sync)
+                last_sync_request_time = now;
+
+            process_group_values.set_size(2);
+            process_group_values.host()[0] = loss;
+            process_group_values.host()[1] = request_sync ? 1 : 0;
+            tensors.push_back(&process_group_values);
+            process_group->average(tensors);
+            loss = process_group_values.host()[0];
+            if (process_group_values.host()[1] != 0)
+                sync_requested_at_job = job_number;
+
+            // The devices have already averaged their gradients, so give them all the
+            // result from the first one.
+            if (include_gradients)
+            {
+                for (size_t i = 1; i < devices.size(); ++i)
+                {
+                    visit_layer_parameter_gradients(devices[i]->net, [&](size_t j, tensor& t) {
+                        if (t.size() != 0)
+                            memcpy(t, *grads[j]);
+                    });
+                }
+            }
+        }
+
         void wait_for_thread_to_pause() const
         {
             job_pipe.wait_for_num_blocked_dequeues(1);
@@ -857,6 +1041,11 @@ namespace dlib
         {
             max_num_epochs = 10000;
             mini_batch_size = 128;
+            micro_batch_size = 0;
+            process_group = nullptr;
+            time_between_syncs = std::chrono::minutes(15);
+            num_jobs_sent = 0;
+            sync_requested_at_job = -1;
             verbose = false;
             learning_rate = 1e-2;
             min_learning_rate = 1e-5;
@@ -991,8 +1180,10 @@ namespace dlib
             bool do_it_now = false
         ) 
         {
-            // don't sync anything if we haven't updated the network since the last sync
-            if (!updated_net_since_last_sync)
+            // don't sync anything if we haven't updated the network since the last sync.
+            // The workers in a process group can't tell when their training thread gets
+            // to the next step, so they skip this check to stay in step with each other.
+            if (!updated_net_since_last_sync && !process_group)
                 return;
 
             // If the sync file isn't set then don't do anything.
@@ -1000,9 +1191,15 @@ namespace dlib
                 return;
 
             // Only sync if it has been long enough since the last sync or we are being
-            // explicitly forced to do it.
-            if (std::chrono::system_clock::now() - last_sync_time > time_between_syncs ||
-                do_it_now)
+            // explicitly forced to do it.  In a process group, the worker with rank 0
+            // decides when it has been long enough and the training thread records the
+            // job where it did.  That job is finished once the one after it has been
+            // sent, so all the workers see the request before sending the same job.
+            const long long requested_job = sync_requested_at_job;
+            const bool time_to_sync = process_group ?
+                (requested_job >= 0 && num_jobs_sent >= (unsigned long long)requested_job + 2) :
+                (std::chrono::system_clock::now() - last_sync_time > time_between_syncs);
+            if (time_to_sync || do_it_now)
             {
                 wait_for_thread_to_pause();
 
@@ -1034,6 +1231,11 @@ namespace dlib
                 last_sync_time = std::chrono::system_clock::now();
                 main_iteration_counter_at_last_disk_sync = main_iteration_counter;
                 updated_net_since_last_sync = false;
+                if (process_group && time_to_sync)
+                {
+                    long long temp = requested_job;
+                    sync_requested_at_job.compare_exchange_strong(temp, -1);
+                }
             }
         }
 
@@ -1121,6 +1323,10 @@ namespace dlib
             std::shared_ptr<net_type> net_copy;
             net_type& net;
             std::vector<solver_type> solvers;
+
+            // Scratch space for training with micro-batches.
+            resizable_tensor micro_batch;
+            std::vector<resizable_tensor> accumulated_gradients;
         };
 
         template <
@@ -1166,6 +1372,7 @@ namespace dlib
             }
 
             dlib::cuda::set_device(prev_dev);
+            ++num_jobs_sent;
             job_pipe.enqueue(job);
         }
 
@@ -1182,6 +1389,74 @@ namespace dlib
             send_job(test_only, dbegin, dend, nothing);
         }
 
+        void send_job (
+            bool test_only,
+            typename dnn_data_loader<net_type>::mini_batch& batch
+        )
+        {
+            propagate_exception();
+            const size_t num = batch.samples.size();
+            const size_t devs = devices.size();
+            job.t.resize(devs);
+            job.labels.resize(devs);
+            job.have_data.resize(devs);
+            job.test_only = test_only;
+
+            // The loader made the tensors with a copy of the input layer, so the networks
+            // haven't seen to_tensor() yet if this is the first mini-batch they get.
+            // Running it on one sample is enough to set their sample_expansion_factor().
+            const auto prev_dev = dlib::cuda::get_device();
+            for (size_t i = 0; i < devs; ++i)
+            {
+                if (devices[i]->net.sample_expansion_factor() == 0)
+                {
+                    dlib::cuda::set_device(devices[i]->device_id);
+                    resizable_tensor temp;
+                    devices[i]->net.to_tensor(batch.samples.begin(), batch.samples.begin()+1, temp);
+                }
+            }
+
+            if (devs == 1 && devices[0]->device_id == batch.data.device_id())
+            {
+                // There is nothing to convert, just take the loader's tensor.
+                job.t[0].swap(batch.data);
+                job.labels[0].swap(batch.labels);
+                job.have_data[0] = true;
+            }
+            else
+            {
+                // Split the mini-batch between the devices the same way the other
+                // send_job() does, copying each part into memory that belongs to the
+                // device that will use it.
+                const size_t block_size = (num+devs-1)/devs;
+                const size_t rows_per_sample = batch.data.num_samples()/num;
+                for (size_t i = 0; i < devs; ++i)
+                {
+                    dlib::cuda::set_device(devices[i]->device_id);
+
+                    size_t start = i*block_size;
+                    size_t stop  = std::min(num, start+block_size);
+
+                    if (start < stop)
+                    {
+                        alias_tensor part((stop-start)*rows_per_sample, batch.data.k(), batch.data.nr(), batch.data.nc());
+                        job.t[i].set_size(part.num_samples(), part.k(), part.nr(), part.nc());
+                        memcpy(job.t[i], part(batch.data, start*rows_per_sample*batch.data.k()*batch.data.nr()*batch.data.nc()));
+                        job.labels[i].assign(batch.labels.begin()+start, batch.labels.begin()+stop);
+                        job.have_data[i] = true;
+                    }
+                    else
+                    {
+                        job.have_data[i] = false;
+                    }
+                }
+            }
+
+            dlib::cuda::set_device(prev_dev);
+            ++num_jobs_sent;
+            job_pipe.enqueue(job);
+        }
+
         void print_progress()
         {
             if (lr_schedule.size() == 0)
@@ -1229,6 +1504,7 @@ namespace dlib
         std::vector<std::shared_ptr<device_data>> devices;
         dlib::pipe<job_t> job_pipe;
         job_t job;
+        typename dnn_data_loader<net_type>::mini_batch loaded_batch;
 
 
         running_stats<double> rs;
@@ -1236,6 +1512,7 @@ namespace dlib
         std::deque<double> previous_loss_values;
         unsigned long max_num_epochs;
         size_t mini_batch_size;
+        std::atomic<unsigned long> micro_batch_size;
         bool verbose;
         net_type& net;
         std::atomic<double> learning_rate;
@@ -1278,6 +1555,10 @@ namespace dlib
         std::atomic<bool> updated_net_since_last_sync;
 
         bool sync_file_reloaded;
+        dnn_process_group* process_group;
+        resizable_tensor process_group_values;
+        unsigned long long num_jobs_sent;
+        std::atomic<long long> sync_requested_at_job;
         unsigned long previous_loss_values_dump_amount;
         unsigned long test_previous_loss_values_dump_amount;
     };
@@ -5,6 +5,8 @@
 
 #include "core_abstract.h"
 #include "solvers_abstract.h"
+#include "data_loader_abstract.h"
+#include "process_group_abstract.h"
 #include <vector>
 #include <chrono>
 
@@ -80,6 +82,8 @@ namespace dlib
                   provided solver instance.
                 - #get_max_num_epochs() == 10000
                 - #get_mini_batch_size() == 128
+                - #get_micro_batch_size() == 0
+                - #get_process_group() == nullptr
                 - #get_learning_rate() == 1e-2 
                 - #get_min_learning_rate() == 1e-5
                 - #get_iterations_without_progress_threshold() == 2000
@@ -147,6 +151,95 @@ namespace dlib
                 - #get_mini_batch_size() == batch_size
         !*/
 
+        unsigned long get_micro_batch_size (
+        ) const; 
+        /*!
+            ensures
+                - returns the largest number of samples the network is run on at once.
+                  The memory needed to train a network grows with the number of samples
+                  it's run on, since every layer keeps its outputs for the backward pass.
+                  So if a mini-batch is bigger than get_micro_batch_size() it's split into
+                  micro-batches of at most get_micro_batch_size() samples.  The network
+                  is run forward and backward on each of them in turn, their parameter
+                  gradients are accumulated, and then the solvers are called once with
+                  the gradient of the whole mini-batch.  So the peak memory use is that of
+                  a micro-batch, plus one extra copy of the parameter gradients, while
+                  everything else, including the learning rate schedule, the loss
+                  history and the synchronization file, sees one step per mini-batch.
+                - The accumulated gradient is the average of the micro-batch gradients,
+                  weighted by their number of samples.  For loss layers that compute a
+                  loss for each sample and average them, which is most of dlib's, this is
+                  the gradient of the whole mini-batch.  It isn't for anything that
+                  couples the samples of a mini-batch, since that only ever sees one
+                  micro-batch:
+                    - Layers that compute statistics over a mini-batch, like bn_.
+                    - Loss layers that compare the samples of a mini-batch with each
+                      other.  loss_metric_ uses every pair of samples and loss_ranking_
+                      every pair of a relevant and a non-relevant sample, so with
+                      micro-batches they only learn from the pairs inside each
+                      micro-batch, and the loss they report is for those pairs too.
+                      Use micro-batches that are as large as memory allows with these
+                      losses, and shuffle the samples so each micro-batch has pairs of
+                      every kind.
+                - This is also done in test_one_step(), where it saves the memory of the
+                  forward pass.
+                - if (get_micro_batch_size() == 0) then
+                    - mini-batches are never split.  This is the default.
+        !*/
+
+        void set_micro_batch_size (
+            unsigned long batch_size 
+        );
+        /*!
+            ensures
+                - #get_micro_batch_size() == batch_size
+        !*/
+
+        dnn_process_group* get_process_group (
+        ) const;
+        /*!
+            ensures
+                - returns the process group this trainer is a worker in, or nullptr if it
+                  trains on its own.
+        !*/
+
+        void set_process_group (
+            dnn_process_group& group
+        );
+        /*!
+            requires
+                - group outlives this trainer.
+            ensures
+                - #get_process_group() == &group
+                - Makes this trainer one of the workers doing data-parallel training in
+                  group.  Each worker trains its own copy of the network, with the same
+                  architecture and solver, and gets its own share of every mini-batch.
+                  After computing its gradients, every worker averages them, and its loss,
+                  with those of the other workers.  So every worker applies the same
+                  update and ends up with the same network, learning rate and loss history.
+                  If the workers get equal sized shares, this is the same as training
+                  one network on the whole mini-batches.  Every 2000 steps, and after the
+                  first one, the network of the worker with rank 0 is also copied to the
+                  others, in case they started from different random initializations.
+                - This works with the CUDA devices and micro-batches of each worker.  The
+                  devices of a worker average their gradients before the workers do.
+                - All the workers must make the same sequence of calls to train_one_step(),
+                  test_one_step() and train(), since each step needs every worker.
+                - Once get_learning_rate() drops below get_min_learning_rate(), the workers
+                  skip the steps they are given, including test_one_step() calls, until
+                  the learning rate is raised again with set_learning_rate().  Each
+                  worker's main thread sees the drop at a slightly different time, so
+                  this is what makes them all stop at the same step.  So if you write
+                  your own training loop, stop it when get_learning_rate() is below
+                  get_min_learning_rate(), like train() does.
+                - The workers sync to disk at the same steps, when the worker with rank 0
+                  decides to.  So if they all call set_synchronization_file() with the
+                  same time_between_syncs and their own filename, e.g. one with their
+                  rank in it, they all have a checkpoint of the same step and all resume
+                  from it.  Also, since their losses are the same, they all reload their
+                  checkpoints if the loss starts increasing.
+        !*/
+
         unsigned long get_max_num_epochs (
         ) const; 
         /*!
@@ -542,6 +635,33 @@ namespace dlib
                   accessing the network.
                 - #get_train_one_step_calls() == get_train_one_step_calls() + 1.
         !*/
+
+        void train_one_step (
+            dnn_data_loader<net_type>& loader
+        );
+        /*!
+            requires
+                - loader was constructed from a network with the same input layer as
+                  get_net().
+            ensures
+                - Takes the next mini-batch from loader, i.e. calls loader.get_next(), and
+                  performs one stochastic gradient update step with it.  This is the same
+                  as calling train_one_step() with the samples and labels made by the
+                  loader's generator, except that the loader has already converted them
+                  into a tensor in its own threads.  So the samples for the next
+                  mini-batches are made while the network trains on this one.
+                - When the trainer uses only one device and the loader made the mini-batch
+                  on that device, the tensor is used as is, without being copied.
+                - You can observe the current average loss value by calling get_average_loss().
+                - The network training will happen in another thread.  Therefore, after
+                  calling this function you should call get_net() before you touch the net
+                  object from the calling thread to ensure no other threads are still
+                  accessing the network.
+                - #get_train_one_step_calls() == get_train_one_step_calls() + 1.
+            throws
+                - Any exception thrown by the loader's generator, as described in
+                  dnn_data_loader::get_next().
+        !*/
         
         double get_average_loss (
         ) const;
@@ -696,6 +816,30 @@ namespace dlib
                 - #get_test_one_step_calls() == get_test_one_step_calls() + 1.
         !*/
 
+        void test_one_step (
+            dnn_data_loader<net_type>& loader
+        );
+        /*!
+            requires
+                - loader was constructed from a network with the same input layer as
+                  get_net().
+            ensures
+                - Takes the next mini-batch from loader, i.e. calls loader.get_next(), and
+                  runs it through the network to compute and record the loss, the same as
+                  calling test_one_step() with the samples and labels made by the
+                  loader's generator.
+                - This call does not modify network parameters.
+                - You can observe the current average loss value by calling get_average_test_loss().
+                - The computation will happen in another thread.  Therefore, after calling
+                  this function you should call get_net() before you touch the net object
+                  from the calling thread to ensure no other threads are still accessing
+                  the network.
+                - #get_test_one_step_calls() == get_test_one_step_calls() + 1.
+            throws
+                - Any exception thrown by the loader's generator, as described in
+                  dnn_data_loader::get_next().
+        !*/
+
         void set_test_iterations_without_progress_threshold (
             unsigned long thresh 
         );
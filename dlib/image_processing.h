@@ -13,6 +13,7 @@
 #include "image_processing/detection_template_tools.h"
 #include "image_processing/object_detector.h"
 #include "image_processing/box_overlap_testing.h"
+#include "image_processing/non_max_suppression.h"
 #include "image_processing/scan_image_pyramid_tools.h"
 #include "image_processing/setup_hashed_features.h"
 #include "image_processing/scan_image_boxes.h"
@@ -0,0 +1,230 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_NON_MAX_SUPPRESSIoN_Hh_
+#define DLIB_NON_MAX_SUPPRESSIoN_Hh_
+
+#include "non_max_suppression_abstract.h"
+#include "box_overlap_testing.h"
+#include "../geometry.h"
+#include "../simd.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class box_overlap_index
+    {
+    public:
+
+        box_overlap_index (
+        ) : box_overlap_index(test_box_overlap(), rectangle(), 1) {}
+
+        box_overlap_index (
+            const test_box_overlap& overlaps_,
+            const rectangle& area_,
+            long cell_size_
+        ) : overlaps(overlaps_), area(area_), cell_size(cell_size_)
+        {
+            DLIB_ASSERT(cell_size > 0,
+                "\t box_overlap_index::box_overlap_index()"
+                << "\n\t Invalid inputs were given to this function "
+                << "\n\t cell_size: " << cell_size
+                );
+
+            if (area.is_empty())
+                area = rectangle(0,0,0,0);
+            grid_nc = (area.width()+cell_size-1)/cell_size;
+            grid_nr = (area.height()+cell_size-1)/cell_size;
+            cells.resize(grid_nr*grid_nc);
+        }
+
+        const test_box_overlap& get_overlap_tester (
+        ) const { return overlaps; }
+
+        const rectangle& get_area (
+        ) const { return area; }
+
+        long get_cell_size (
+        ) const { return cell_size; }
+
+        size_t size (
+        ) const { return boxes.size(); }
+
+        const std::vector<rectangle>& get_boxes (
+        ) const { return boxes; }
+
+        void clear (
+        )
+        {
+            boxes.clear();
+            for (auto& c : cells)
+                c.clear();
+        }
+
+        void add (
+            const rectangle& rect
+        )
+        {
+            const rectangle cr = cell_range(rect);
+            for (long r = cr.top(); r <= cr.bottom(); ++r)
+            {
+                for (long c = cr.left(); c <= cr.right(); ++c)
+                    cells[r*grid_nc + c].push_back(boxes.size());
+            }
+            boxes.push_back(rect);
+        }
+
+        bool overlaps_any_box (
+            const rectangle& rect
+        ) const
+        {
+            const rectangle cr = cell_range(rect);
+            for (long r = cr.top(); r <= cr.bottom(); ++r)
+            {
+                for (long c = cr.left(); c <= cr.right(); ++c)
+                {
+                    for (auto i : cells[r*grid_nc + c])
+                    {
+                        // A box is in every cell it touches, so only test it in the
+                        // first cell it shares with rect.  Boxes that don't share a
+                        // cell don't intersect, and so can't overlap.
+                        const rectangle bcr = cell_range(boxes[i]);
+                        if (c != std::max(cr.left(), bcr.left()) || r != std::max(cr.top(), bcr.top()))
+                            continue;
+                        if (overlaps(boxes[i], rect))
+                            return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+    private:
+
+        rectangle cell_range (
+            const rectangle& rect
+        ) const
+        {
+            // Boxes outside the area go in the cells on its border.  Clamping keeps
+            // boxes that intersect in at least one common cell.
+            if (rect.is_empty())
+                return rectangle();
+            return rectangle(to_cell(rect.left()-area.left(), grid_nc),
+                             to_cell(rect.top()-area.top(), grid_nr),
+                             to_cell(rect.right()-area.left(), grid_nc),
+                             to_cell(rect.bottom()-area.top(), grid_nr));
+        }
+
+        long to_cell (
+            long offset,
+            long grid_size
+        ) const
+        {
+            if (offset < 0)
+                return 0;
+            return std::min(offset/cell_size, grid_size-1);
+        }
+
+        test_box_overlap overlaps;
+        rectangle area;
+        long cell_size;
+        long grid_nr;
+        long grid_nc;
+        std::vector<std::vector<unsigned long>> cells;
+        std::vector<rectangle> boxes;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    inline std::vector<unsigned long> non_max_suppression (
+        const test_box_overlap& overlaps,
+        const std::vector<rectangle>& boxes
+    )
+    {
+        std::vector<unsigned long> keep;
+        if (boxes.size() == 0)
+            return keep;
+
+        // Size the cells like the boxes, so most boxes touch only a few cells, but don't
+        // make many more cells than there are boxes.
+        rectangle area;
+        double total_size = 0;
+        for (auto& b : boxes)
+        {
+            if (b.is_empty())
+                continue;
+            area += b;
+            total_size += std::max(b.width(), b.height());
+        }
+        long cell_size = std::max<long>(1, std::lround(total_size/boxes.size()));
+        cell_size = std::max<long>(cell_size, std::ceil(std::sqrt(area.area()/(4.0*boxes.size()))));
+
+        box_overlap_index index(overlaps, area, cell_size);
+        for (unsigned long i = 0; i < boxes.size(); ++i)
+        {
+            if (index.overlaps_any_box(boxes[i]))
+                continue;
+            index.add(boxes[i]);
+            keep.push_back(i);
+        }
+        return keep;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline void find_scores_above_threshold (
+        const float* scores,
+        size_t num,
+        double thresh,
+        std::vector<unsigned long>& idx
+    )
+    {
+        idx.clear();
+
+        // Compare in float against the largest float <= thresh.  A float is > that if
+        // and only if it's > thresh.
+        float fthresh = static_cast<float>(thresh);
+        if (fthresh > thresh)
+            fthresh = std::nextafter(fthresh, -std::numeric_limits<float>::infinity());
+
+        // Detector outputs are almost all below threshold, so check blocks of scores
+        // with SIMD instructions and only look at the individual scores of blocks that
+        // have something in them.
+        const size_t block_size = 64;
+        const simd8f t(fthresh), one(1), zero(0);
+        size_t i = 0;
+        for (; i + block_size <= num; i += block_size)
+        {
+            simd8f count(0), v;
+            for (size_t j = 0; j < block_size; j += 8)
+            {
+                v.load(scores+i+j);
+                count += select(v > t, one, zero);
+            }
+            if (sum(count) == 0)
+                continue;
+
+            for (size_t j = i; j < i+block_size; ++j)
+            {
+                if (scores[j] > thresh)
+                    idx.push_back(j);
+            }
+        }
+        for (; i < num; ++i)
+        {
+            if (scores[i] > thresh)
+                idx.push_back(i);
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_NON_MAX_SUPPRESSIoN_Hh_
+
@@ -0,0 +1,174 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_NON_MAX_SUPPRESSIoN_ABSTRACT_Hh_
+#ifdef DLIB_NON_MAX_SUPPRESSIoN_ABSTRACT_Hh_
+
+#include "box_overlap_testing_abstract.h"
+#include "../geometry.h"
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class box_overlap_index
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object is a set of boxes that can quickly tell you if a new box
+                overlaps any of them, according to a test_box_overlap.  It's what you
+                need for greedy non-max suppression, where each detection is kept only if
+                it doesn't overlap a more confident detection that was kept.
+
+                Checking a box against every kept box takes time proportional to the
+                number of kept boxes, which makes non-max suppression quadratic in the
+                number of detections.  This object instead puts the boxes into a grid of
+                get_cell_size() by get_cell_size() pixel cells covering get_area() and
+                only checks the boxes in the cells a new box touches.  Boxes that don't
+                intersect never overlap, so the answers are exactly the same as checking
+                every box.  Boxes outside get_area() are allowed, they are just put into
+                the cells on its border.
+        !*/
+
+    public:
+
+        box_overlap_index (
+        );
+        /*!
+            ensures
+                - #size() == 0
+                - #get_overlap_tester() == test_box_overlap()
+                - #get_area() == rectangle(0,0,0,0)
+                - #get_cell_size() == 1
+        !*/
+
+        box_overlap_index (
+            const test_box_overlap& overlaps,
+            const rectangle& area,
+            long cell_size
+        );
+        /*!
+            requires
+                - cell_size > 0
+            ensures
+                - #size() == 0
+                - #get_overlap_tester() == overlaps
+                - if (area.is_empty()) then
+                    - #get_area() == rectangle(0,0,0,0)
+                - else
+                    - #get_area() == area
+                - #get_cell_size() == cell_size
+        !*/
+
+        const test_box_overlap& get_overlap_tester (
+        ) const;
+        /*!
+            ensures
+                - returns the test used to decide if two boxes overlap.
+        !*/
+
+        const rectangle& get_area (
+        ) const;
+        /*!
+            ensures
+                - returns the part of the image covered by the grid.  Most of the boxes
+                  should be inside it.
+        !*/
+
+        long get_cell_size (
+        ) const;
+        /*!
+            ensures
+                - returns the width and height of the grid cells.  This is best set to
+                  about the size of the boxes.
+        !*/
+
+        size_t size (
+        ) const;
+        /*!
+            ensures
+                - returns the number of boxes in this object.
+        !*/
+
+        const std::vector<rectangle>& get_boxes (
+        ) const;
+        /*!
+            ensures
+                - returns the boxes in this object, in the order they were added.
+        !*/
+
+        void clear (
+        );
+        /*!
+            ensures
+                - #size() == 0
+                - The overlap tester, area and cell size are unchanged.
+        !*/
+
+        void add (
+            const rectangle& rect
+        );
+        /*!
+            ensures
+                - #size() == size() + 1
+                - #get_boxes().back() == rect
+        !*/
+
+        bool overlaps_any_box (
+            const rectangle& rect
+        ) const;
+        /*!
+            ensures
+                - returns true if get_overlap_tester()(b, rect) is true for some box b in
+                  get_boxes() and false otherwise.
+        !*/
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    std::vector<unsigned long> non_max_suppression (
+        const test_box_overlap& overlaps,
+        const std::vector<rectangle>& boxes
+    );
+    /*!
+        requires
+            - boxes is sorted from the most to the least confident detection.
+        ensures
+            - Performs greedy non-max suppression on boxes.  That is, each box is kept if
+              it doesn't overlap, according to overlaps, any of the boxes before it that
+              were kept.
+            - returns the indices of the boxes that were kept, in increasing order.
+            - The result is the same as checking each box against all the kept boxes
+              before it.  But this function uses a box_overlap_index, with its area and
+              cell size picked from boxes, and so takes about linear rather than
+              quadratic time in boxes.size().  object_detector, scan_fhog_pyramid and
+              loss_mmod_ all do their non-max suppression with it.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    void find_scores_above_threshold (
+        const float* scores,
+        size_t num,
+        double thresh,
+        std::vector<unsigned long>& idx
+    );
+    /*!
+        requires
+            - scores points to an array of num floats.
+        ensures
+            - #idx contains, in increasing order, all the i < num for which
+              scores[i] > thresh.
+            - This is the first step of turning a detector's output into detections, and
+              with most of the scores below thresh, it's mostly spent reading scores.  So
+              this function checks blocks of scores with SIMD instructions and only looks
+              at individual scores in blocks that have one above thresh.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_NON_MAX_SUPPRESSIoN_ABSTRACT_Hh_
+
@@ -7,6 +7,7 @@
 #include "../geometry.h"
 #include <vector>
 #include "box_overlap_testing.h"
+#include "non_max_suppression.h"
 #include "full_object_detection.h"
 
 namespace dlib
@@ -191,19 +192,6 @@ namespace dlib
 
     private:
 
-        bool overlaps_any_box (
-            const std::vector<rect_detection>& rects,
-            const dlib::rectangle& rect
-        ) const
-        {
-            for (unsigned long i = 0; i < rects.size(); ++i)
-            {
-                if (boxes_overlap(rects[i].rect, rect))
-                    return true;
-            }
-            return false;
-        }
-
         test_box_overlap boxes_overlap;
         std::vector<processed_weight_vector<image_scanner_type> > w;
         image_scanner_type scanner;
@@ -451,13 +439,12 @@ namespace dlib
         final_dets.clear();
         if (w.size() > 1)
             std::sort(dets_accum.rbegin(), dets_accum.rend());
+        std::vector<rectangle> boxes;
+        boxes.reserve(dets_accum.size());
         for (unsigned long i = 0; i < dets_accum.size(); ++i)
-        {
-            if (overlaps_any_box(final_dets, dets_accum[i].rect))
-                continue;
-
+            boxes.push_back(dets_accum[i].rect);
+        for (auto i : non_max_suppression(boxes_overlap, boxes))
             final_dets.push_back(dets_accum[i]);
-        }
     }
 
 // ----------------------------------------------------------------------------------------
@@ -806,22 +806,6 @@ namespace dlib
             std::sort(dets.rbegin(), dets.rend(), compare_pair_rect);
         }
 
-        inline bool overlaps_any_box (
-            const test_box_overlap& tester,
-            const std::vector<rect_detection>& rects,
-            const rect_detection& rect
-        ) 
-        {
-            for (unsigned long i = 0; i < rects.size(); ++i)
-            {
-                // Only compare detections from the same detector.  That is, we don't want
-                // the output of one detector to stop on the output of another detector. 
-                if (rects[i].weight_index == rect.weight_index && tester(rects[i].rect, rect.rect))
-                    return true;
-            }
-            return false;
-        }
-
     }
 
 // ----------------------------------------------------------------------------------------
@@ -1308,13 +1292,30 @@ namespace dlib
         // Do non-max suppression
         if (detectors.size() > 1)
             std::sort(dets_accum.rbegin(), dets_accum.rend());
+        // Only compare detections from the same detector.  That is, we don't want the
+        // output of one detector to stop on the output of another detector.
+        std::vector<bool> keep(dets_accum.size(), false);
+        std::vector<rectangle> boxes;
+        std::vector<unsigned long> idx;
+        for (unsigned long d = 0; d < detectors.size(); ++d)
+        {
+            boxes.clear();
+            idx.clear();
+            for (unsigned long i = 0; i < dets_accum.size(); ++i)
+            {
+                if (dets_accum[i].weight_index == d)
+                {
+                    boxes.push_back(dets_accum[i].rect);
+                    idx.push_back(i);
+                }
+            }
+            for (auto i : non_max_suppression(detectors[d].get_overlap_tester(), boxes))
+                keep[idx[i]] = true;
+        }
         for (unsigned long i = 0; i < dets_accum.size(); ++i)
         {
-            const test_box_overlap tester = detectors[dets_accum[i].weight_index].get_overlap_tester();
-            if (impl::overlaps_any_box(tester, dets, dets_accum[i]))
-                continue;
-
-            dets.push_back(dets_accum[i]);
+            if (keep[i])
+                dets.push_back(dets_accum[i]);
         }
     }
 
@@ -12,6 +12,7 @@
 #include "../geometry/border_enumerator.h"
 #include "../simd.h"
 #include <limits>
+#include <memory>
 #include "assign_image.h"
 
 namespace dlib
@@ -21,6 +22,49 @@ namespace dlib
 
     namespace impl
     {
+        template <
+            typename in_image_type,
+            typename EXP
+            >
+        typename enable_if_c<pixel_traits<typename image_traits<in_image_type>::pixel_type>::grayscale,
+                             std::shared_ptr<const matrix<typename EXP::type> > >::type
+        fft_filter_image_if_worthwhile (
+            const in_image_type& in_img,
+            const matrix_exp<EXP>& filter
+        )
+        /*!
+            ensures
+                - If the filter is big enough that it's faster to apply it with FFTs then
+                  this function returns xcorr_valid(in_img, filter), computed with FFTs.
+                  Element (r,c) of it is the filter output for the pixel at
+                  (r+filter.nr()/2, c+filter.nc()/2).
+                - Otherwise returns a null pointer.
+        !*/
+        {
+            typedef typename EXP::type ptype;
+            const long nr = num_rows(in_img);
+            const long nc = num_columns(in_img);
+            return fft_conv_if_worthwhile<true>(matrix_cast<ptype>(mat(in_img)), filter,
+                filter.nr()-1, filter.nc()-1, nr-filter.nr()+1, nc-filter.nc()+1);
+        }
+
+        template <
+            typename in_image_type,
+            typename EXP
+            >
+        typename disable_if_c<pixel_traits<typename image_traits<in_image_type>::pixel_type>::grayscale,
+                              std::shared_ptr<const matrix<typename EXP::type> > >::type
+        fft_filter_image_if_worthwhile (
+            const in_image_type& ,
+            const matrix_exp<EXP>& 
+        )
+        {
+            // Color images are always filtered with the direct loops.
+            return std::shared_ptr<const matrix<typename EXP::type> >();
+        }
+
+    // ------------------------------------------------------------------------------------
+
         template <
             typename in_image_type,
             typename out_image_type,
@@ -76,6 +120,8 @@ namespace dlib
             if (!add_to)
                 zero_border_pixels(out_img_, non_border); 
 
+            const auto fft_result = fft_filter_image_if_worthwhile(in_img_, filter);
+
             // apply the filter to the image
             for (long r = first_row; r < last_row; ++r)
             {
@@ -84,13 +130,20 @@ namespace dlib
                     typedef typename EXP::type ptype;
                     ptype p;
                     ptype temp = 0;
-                    for (long m = 0; m < filter.nr(); ++m)
+                    if (fft_result)
                     {
-                        for (long n = 0; n < filter.nc(); ++n)
+                        temp = (*fft_result)(r-first_row, c-first_col);
+                    }
+                    else
+                    {
+                        for (long m = 0; m < filter.nr(); ++m)
                         {
-                            // pull out the current pixel and put it into p
-                            p = get_pixel_intensity(in_img[r-first_row+m][c-first_col+n]);
-                            temp += p*filter(m,n);
+                            for (long n = 0; n < filter.nc(); ++n)
+                            {
+                                // pull out the current pixel and put it into p
+                                p = get_pixel_intensity(in_img[r-first_row+m][c-first_col+n]);
+                                temp += p*filter(m,n);
+                            }
                         }
                     }
 
@@ -167,6 +220,23 @@ namespace dlib
             if (!add_to)
                 zero_border_pixels(out_img_, non_border); 
 
+            // Big filters are faster with FFTs.
+            const auto fft_result = fft_filter_image_if_worthwhile(in_img_, filter);
+            if (fft_result)
+            {
+                for (long r = first_row; r < last_row; ++r)
+                {
+                    for (long c = first_col; c < last_col; ++c)
+                    {
+                        if (add_to == false)
+                            out_img[r][c] = (*fft_result)(r-first_row, c-first_col);
+                        else
+                            out_img[r][c] += (*fft_result)(r-first_row, c-first_col);
+                    }
+                }
+                return non_border;
+            }
+
             // apply the filter to the image
             for (long r = first_row; r < last_row; ++r)
             {
@@ -46,6 +46,10 @@ namespace dlib
               cross-correlates in_img with filter).  Also divides each resulting pixel by scale.  
             - The intermediate filter computations will be carried out using variables of type EXP::type.
               This is whatever scalar type is used inside the filter matrix. 
+            - if (in_img contains grayscale pixels, EXP::type is float, double, or long
+              double, and filter.size() >= get_conv_fft_threshold()) then
+                - The filter is applied with FFTs rather than the direct loops.  This is
+                  much faster for big filters and gives the same output, up to rounding.
             - Pixel values are stored into out_img using the assign_pixel() function and therefore
               any applicable color space conversion or value saturation is performed.  Note that if 
               add_to is true then the filtered output value will be added to out_img rather than 
@@ -9,6 +9,7 @@
 #include "matrix/matrix_math_functions.h"
 #include "matrix/matrix_assign.h"
 #include "matrix/matrix_la.h"
+#include "matrix/sparse_matrix.h"
 #include "matrix/symmetric_matrix_cache.h"
 #include "matrix/matrix_conv.h"
 #include "matrix/matrix_read_from_istream.h"
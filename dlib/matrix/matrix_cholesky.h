@@ -15,6 +15,7 @@
 #endif
 
 #include "matrix_trsm.h"
+#include "matrix_la_blocked.h"
 
 namespace dlib 
 {
@@ -154,85 +155,124 @@ namespace dlib
 
         const type eps2 = max(abs(diag(A)))*std::sqrt(std::numeric_limits<type>::epsilon())/100;
 
-
-
-        // compute the upper left corner
-        if (A(0,0) > 0)
-        {
-            L_(0,0) = std::sqrt(A(0,0));
-            if (A(0,0) <= eps2)
-                isspd = false;
-        }
-        else
-        {
-            isspd = false;
-            L_(0,0) = 0;
-        }
-
-        // compute the first column
-        for (long r = 1; r < A.nr(); ++r)
+        // check if the matrix is actually symmetric
+        for (long r = 1; r < n; ++r)
         {
-            // if (L_(0,0) > 0)
-            if (L_(0,0) > eps*std::abs(A(r,0)))
-            {
-                L_(r,0) = A(r,0)/L_(0,0);
-            }
-            else
+            for (long c = 0; c < r; ++c)
             {
-                isspd = false;
-                L_(r,0) = 0;
+                isspd = isspd && (std::abs(A(r,c) - A(c,r)) <= eps*std::abs(A(r,c)) ); 
             }
-
-            isspd = isspd && (std::abs(A(r,0) - A(0,r)) <= eps*std::abs(A(r,0)) ); 
         }
 
-        // now compute all the other columns
-        for (long c = 1; c < A.nc(); ++c)
-        {
-            // compute the diagonal element
-            type temp = A(c,c);
-            for (long i = 0; i < c; ++i)
-                temp -= L_(c,i)*L_(c,i);
+        L_ = lowerm(A);
 
-            if (temp > 0)
-            {
-                L_(c,c) = std::sqrt(temp);
-                if (temp <= eps2)
-                    isspd = false;
-            }
-            else
-            {
-                L_(c,c) = 0;
-                isspd = false;
-            }
-
-            for (long r = 0; r < c; ++r)
-                L_(r,c) = 0;
+        // Compute L_ a panel of columns at a time.  The columns of each panel are
+        // computed with the usual dot product algorithm, using only the columns of
+        // the panel itself, since the contributions of earlier panels have already
+        // been subtracted from the rest of the matrix by the matrix multiply at the
+        // bottom of the loop.
+        const long bs = blocked_la::block_size;
+        for (long k0 = 0; k0 < n; k0 += bs)
+        {
+            const long kend = std::min(k0+bs, n);
 
-            // compute the non diagonal elements
-            for (long r = c+1; r < A.nr(); ++r)
+            // Factor the diagonal block.
+            for (long c = k0; c < kend; ++c)
             {
-                temp = A(r,c);
-                for (long i = 0; i < c; ++i)
-                {
-                    temp -= L_(r,i)*L_(c,i);
-                }
+                // compute the diagonal element
+                type temp = L_(c,c);
+                for (long i = k0; i < c; ++i)
+                    temp -= L_(c,i)*L_(c,i);
 
-                // if (L_(c,c) > 0)
-                if (L_(c,c) > eps*std::abs(temp))
+                if (temp > 0)
                 {
-                    L_(r,c) = temp/L_(c,c);
+                    L_(c,c) = std::sqrt(temp);
+                    if (temp <= eps2)
+                        isspd = false;
                 }
                 else
                 {
+                    L_(c,c) = 0;
                     isspd = false;
-                    L_(r,c) = 0;
                 }
 
-                isspd = isspd && (std::abs(A(r,c) - A(c,r)) <= eps*std::abs(A(r,c)) ); 
+                // compute the non diagonal elements
+                for (long r = c+1; r < kend; ++r)
+                {
+                    temp = L_(r,c);
+                    for (long i = k0; i < c; ++i)
+                        temp -= L_(r,i)*L_(c,i);
+
+                    if (L_(c,c) > eps*std::abs(temp))
+                    {
+                        L_(r,c) = temp/L_(c,c);
+                    }
+                    else
+                    {
+                        isspd = false;
+                        L_(r,c) = 0;
+                    }
+                }
             }
+
+            if (kend == n)
+                break;
+
+            // Compute the part of the panel below the diagonal block.  Each row is
+            // independent of the others.
+            dlib::mutex mut;
+            blocked_la::parallel_for_blocked_if_worthwhile(kend, n, (kend-k0)*(kend-k0), 
+                [&](long begin, long end)
+                {
+                    bool ok = true;
+                    for (long r = begin; r < end; ++r)
+                    {
+                        for (long c = k0; c < kend; ++c)
+                        {
+                            type temp = L_(r,c);
+                            for (long i = k0; i < c; ++i)
+                                temp -= L_(r,i)*L_(c,i);
+
+                            if (L_(c,c) > eps*std::abs(temp))
+                            {
+                                L_(r,c) = temp/L_(c,c);
+                            }
+                            else
+                            {
+                                ok = false;
+                                L_(r,c) = 0;
+                            }
+                        }
+                    }
+                    if (!ok)
+                    {
+                        auto_mutex lock(mut);
+                        isspd = false;
+                    }
+                });
+
+            // Subtract the panel's contribution from the lower triangle of the rest of
+            // the matrix.  That is, A22 -= L21*trans(L21), done one block of columns at
+            // a time so that only the lower triangle is computed.
+            const long num = (n-kend+bs-1)/bs;
+            blocked_la::parallel_for_blocked_if_worthwhile(0, num, (n-kend)*bs*(kend-k0), 
+                [&](long begin, long end)
+                {
+                    for (long b = begin; b < end; ++b)
+                    {
+                        const long c = kend + b*bs;
+                        const long width = std::min(bs, n-c);
+                        auto sub = set_subm(L_, c, c, n-c, width);
+                        default_matrix_multiply(sub, -subm(L_, c, k0, n-c, kend-k0), 
+                            trans(subm(L_, c, k0, width, kend-k0)));
+                    }
+                });
         }
 
+        // The matrix multiplies above also wrote to the upper triangle of the
+        // diagonal blocks, so clear that out.
+        L_ = lowerm(L_);
+
 #endif
     }
 
@@ -6,6 +6,10 @@
 #include "matrix_conv_abstract.h"
 #include "matrix.h"
 #include "matrix_fft.h"
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
 
 namespace dlib
 {
@@ -20,6 +24,317 @@ namespace dlib
         std::complex<T> conj(const std::complex<T>& item) { return std::conj(item); }
     }
 
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        // The default for get_conv_fft_threshold().  It's roughly where the FFT path starts
+        // to beat the direct loops on a typical x86 machine.  Run
+        // tools/benchmarks/conv_fft_benchmark to find the crossover on yours.
+        const long default_conv_fft_threshold = 400;
+
+        inline std::atomic<long>& conv_fft_threshold (
+        )
+        {
+            static std::atomic<long> threshold(default_conv_fft_threshold);
+            return threshold;
+        }
+    }
+
+    inline long get_conv_fft_threshold (
+    )
+    {
+        return impl::conv_fft_threshold();
+    }
+
+    inline void set_conv_fft_threshold (
+        long threshold
+    )
+    {
+        impl::conv_fft_threshold() = threshold;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        template <typename T>
+        struct is_fft_conv_type
+        {
+            const static bool value = is_same_type<T,float>::value ||
+                                      is_same_type<T,double>::value ||
+                                      is_same_type<T,long double>::value;
+        };
+
+        struct fft_conv_layout
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This object describes how an image is cut up for overlap-add
+                    convolution.  The image is split into tiles of tile_nr by tile_nc
+                    pixels (the tiles in the last row and column can be smaller) and each
+                    tile is convolved with the filter using FFTs of size fft_nr by fft_nc.
+            !*/
+            long tile_nr = 0;
+            long tile_nc = 0;
+            long fft_nr = 0;
+            long fft_nc = 0;
+
+            bool can_convolve (
+                long filter_nr,
+                long filter_nc
+            ) const
+            /*!
+                ensures
+                    - returns true if the FFTs are big enough to hold the convolution of a
+                      tile with a filter_nr by filter_nc filter without wrapping around.
+            !*/
+            {
+                return tile_nr > 0 && fft_nr >= tile_nr+filter_nr-1 && fft_nc >= tile_nc+filter_nc-1;
+            }
+        };
+
+        inline std::vector<long> fft_conv_candidate_sizes (
+            long n,
+            long k
+        )
+        /*!
+            ensures
+                - returns the FFT lengths worth considering for one dimension of an image
+                  of length n convolved with a filter of length k.  That's every length
+                  with only small prime factors, from the smallest that fits the filter up
+                  to the one that fits the whole image in one tile.
+        !*/
+        {
+            std::vector<long> sizes;
+            const long biggest = fft_fast_size(n+k-1);
+            for (long len = fft_fast_size(k); ; len = fft_fast_size(len+1))
+            {
+                sizes.push_back(len);
+                if (len >= biggest)
+                    break;
+            }
+            return sizes;
+        }
+
+        inline fft_conv_layout choose_fft_conv_layout (
+            long nr,
+            long nc,
+            long filter_nr,
+            long filter_nc
+        )
+        /*!
+            requires
+                - nr, nc, filter_nr, and filter_nc are all > 0
+            ensures
+                - returns the layout that minimizes the estimated cost of the FFTs needed
+                  to convolve an nr by nc image with a filter_nr by filter_nc filter.
+                  Bigger FFTs waste less work on the overlap between tiles but cost more
+                  per pixel, so we just try them all.
+        !*/
+        {
+            fft_conv_layout best;
+            double best_cost = std::numeric_limits<double>::infinity();
+            for (auto fnr : fft_conv_candidate_sizes(nr, filter_nr))
+            {
+                const long tnr = std::min(fnr-filter_nr+1, nr);
+                for (auto fnc : fft_conv_candidate_sizes(nc, filter_nc))
+                {
+                    const long tnc = std::min(fnc-filter_nc+1, nc);
+                    const long num_tiles = ((nr+tnr-1)/tnr)*((nc+tnc-1)/tnc);
+                    // The tiles are transformed two at a time.
+                    const double size = static_cast<double>(fnr)*fnc;
+                    const double cost = ((num_tiles+1)/2)*size*std::log2(size);
+                    if (cost < best_cost)
+                    {
+                        best_cost = cost;
+                        best.tile_nr = tnr;
+                        best.tile_nc = tnc;
+                        best.fft_nr = fnr;
+                        best.fft_nc = fnc;
+                    }
+                }
+            }
+            return best;
+        }
+
+        template <typename T>
+        void fft_conv_tile_pair (
+            const matrix<T>& img,
+            const fft_conv_layout& layout,
+            long tile,
+            matrix<std::complex<T> >& spectrum
+        )
+        /*!
+            ensures
+                - #spectrum == the FFT of a fft_nr by fft_nc complex matrix that holds the
+                  given tile of img in its real part and the next tile, if there is one, in
+                  its imaginary part.  Since the filters are real, the convolutions of the
+                  two tiles come out in the real and imaginary parts of a single inverse
+                  FFT.
+        !*/
+        {
+            const long tiles_per_row = (img.nc()+layout.tile_nc-1)/layout.tile_nc;
+            const long num_tiles = ((img.nr()+layout.tile_nr-1)/layout.tile_nr)*tiles_per_row;
+            spectrum.set_size(layout.fft_nr, layout.fft_nc);
+            spectrum = 0;
+            for (long t = tile; t < std::min(tile+2, num_tiles); ++t)
+            {
+                const long top = (t/tiles_per_row)*layout.tile_nr;
+                const long left = (t%tiles_per_row)*layout.tile_nc;
+                const long height = std::min(layout.tile_nr, img.nr()-top);
+                const long width = std::min(layout.tile_nc, img.nc()-left);
+                for (long r = 0; r < height; ++r)
+                {
+                    for (long c = 0; c < width; ++c)
+                    {
+                        if (t == tile)
+                            spectrum(r,c).real(img(top+r,left+c));
+                        else
+                            spectrum(r,c).imag(img(top+r,left+c));
+                    }
+                }
+            }
+            fft_inplace(spectrum);
+        }
+
+        template <typename T, typename EXP>
+        matrix<T> fft_conv (
+            const matrix<T>& img,
+            const matrix_exp<EXP>& filter,
+            bool flip_filter,
+            long top,
+            long left,
+            long out_nr,
+            long out_nc,
+            const fft_conv_layout& layout,
+            const std::vector<matrix<std::complex<T> > >* cached_spectra
+        )
+        /*!
+            requires
+                - img.size() != 0 && filter.size() != 0
+                - out_nr > 0 && out_nc > 0
+                - layout.can_convolve(filter.nr(), filter.nc())
+                - if (cached_spectra != 0) then
+                    - cached_spectra holds the outputs of fft_conv_tile_pair() for every
+                      other tile of img, starting with tile 0.
+            ensures
+                - Let F == conv(img,filter) if flip_filter is false and xcorr(img,filter)
+                  otherwise.  This function returns subm(F, top, left, out_nr, out_nc),
+                  computed with overlap-add FFT convolution.
+        !*/
+        {
+            const long filter_nr = filter.nr();
+            const long filter_nc = filter.nc();
+
+            // Transform the filter.  We also fold the 1/N scale of the inverse FFT into
+            // it.
+            matrix<T> padded_filter = zeros_matrix<T>(layout.fft_nr, layout.fft_nc);
+            if (flip_filter)
+                set_subm(padded_filter, 0, 0, filter_nr, filter_nc) = matrix_cast<T>(flip(filter));
+            else
+                set_subm(padded_filter, 0, 0, filter_nr, filter_nc) = matrix_cast<T>(filter);
+            const matrix<std::complex<T> > filter_spectrum = fft(padded_filter)/static_cast<T>(layout.fft_nr*layout.fft_nc);
+
+            matrix<T> out = zeros_matrix<T>(out_nr, out_nc);
+            const long tiles_per_row = (img.nc()+layout.tile_nc-1)/layout.tile_nc;
+            const long num_tiles = ((img.nr()+layout.tile_nr-1)/layout.tile_nr)*tiles_per_row;
+            matrix<std::complex<T> > spectrum, temp;
+            for (long tile = 0; tile < num_tiles; tile += 2)
+            {
+                // Skip tiles that don't touch the part of the output we want.
+                bool needed = false;
+                for (long t = tile; t < std::min(tile+2, num_tiles); ++t)
+                {
+                    const long r = (t/tiles_per_row)*layout.tile_nr;
+                    const long c = (t%tiles_per_row)*layout.tile_nc;
+                    needed = needed || (r+layout.tile_nr+filter_nr-1 > top && r < top+out_nr &&
+                                        c+layout.tile_nc+filter_nc-1 > left && c < left+out_nc);
+                }
+                if (!needed)
+                    continue;
+
+                if (cached_spectra)
+                {
+                    temp = pointwise_multiply((*cached_spectra)[tile/2], filter_spectrum);
+                }
+                else
+                {
+                    fft_conv_tile_pair(img, layout, tile, spectrum);
+                    temp = pointwise_multiply(spectrum, filter_spectrum);
+                }
+                ifft_inplace(temp);
+
+                // Add the convolutions of the tiles into the output.
+                for (long t = tile; t < std::min(tile+2, num_tiles); ++t)
+                {
+                    const long tile_top = (t/tiles_per_row)*layout.tile_nr;
+                    const long tile_left = (t%tiles_per_row)*layout.tile_nc;
+                    const long height = std::min(layout.tile_nr, img.nr()-tile_top) + filter_nr-1;
+                    const long width = std::min(layout.tile_nc, img.nc()-tile_left) + filter_nc-1;
+                    const long r_begin = std::max(tile_top, top);
+                    const long r_end = std::min(tile_top+height, top+out_nr);
+                    const long c_begin = std::max(tile_left, left);
+                    const long c_end = std::min(tile_left+width, left+out_nc);
+                    for (long r = r_begin; r < r_end; ++r)
+                    {
+                        for (long c = c_begin; c < c_end; ++c)
+                        {
+                            const std::complex<T>& v = temp(r-tile_top, c-tile_left);
+                            out(r-top, c-left) += (t == tile) ? v.real() : v.imag();
+                        }
+                    }
+                }
+            }
+            return out;
+        }
+
+        template <bool flip_filter, typename M1, typename M2>
+        typename enable_if<is_fft_conv_type<typename M1::type>,std::shared_ptr<const matrix<typename M1::type> > >::type
+        fft_conv_if_worthwhile (
+            const M1& m1,
+            const M2& m2,
+            long top,
+            long left,
+            long out_nr,
+            long out_nc
+        )
+        /*!
+            ensures
+                - If convolving m1 with m2 is big enough that doing it with FFTs is
+                  faster, then this function returns the same thing as
+                  fft_conv(m1,m2,flip_filter,top,left,out_nr,out_nc,...).  Otherwise it
+                  returns a null pointer.
+        !*/
+        {
+            typedef typename M1::type T;
+            const long threshold = get_conv_fft_threshold();
+            if (out_nr <= 0 || out_nc <= 0 || m1.size() == 0 || m2.size() == 0 ||
+                std::min(m1.size(), m2.size()) < threshold || out_nr*out_nc < threshold)
+                return std::shared_ptr<const matrix<T> >();
+
+            const matrix<T> img(m1);
+            const auto layout = choose_fft_conv_layout(img.nr(), img.nc(), m2.nr(), m2.nc());
+            return std::make_shared<const matrix<T> >(fft_conv<T>(img, m2, flip_filter, top, left, out_nr, out_nc, layout, nullptr));
+        }
+
+        template <bool flip_filter, typename M1, typename M2>
+        typename disable_if<is_fft_conv_type<typename M1::type>,std::shared_ptr<const matrix<typename M1::type> > >::type
+        fft_conv_if_worthwhile (
+            const M1& ,
+            const M2& ,
+            long ,
+            long ,
+            long ,
+            long 
+        )
+        {
+            // We only use FFTs on real floating point data.  Integer convolutions must be
+            // exact so they always use the direct loops.
+            return std::shared_ptr<const matrix<typename M1::type> >();
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
 
@@ -36,12 +351,17 @@ namespace dlib
                 nr_ = 0;
             if (nc_ < 0 || m1.size() == 0 || m2.size() == 0)
                 nc_ = 0;
+
+            fft_result = impl::fft_conv_if_worthwhile<flip_m2>(m1, m2, 0, 0, nr_, nc_);
         }
 
         const M1& m1;
         const M2& m2;
         long nr_; 
         long nc_;
+        // When the filter is big we compute the whole result with FFTs up front and
+        // apply() just reads it out.
+        std::shared_ptr<const matrix<typename M1::type> > fft_result;
 
         const static long cost = (M1::cost+M2::cost)*10;
         const static long NR = (M1::NR*M2::NR==0) ? (0) : (M1::NR+M2::NR-1);
@@ -53,6 +373,9 @@ namespace dlib
 
         const_ret_type apply (long r, long c) const 
         { 
+            if (fft_result)
+                return (*fft_result)(r,c);
+
             type temp = 0;
 
             const long min_rr = std::max<long>(r-m2.nr()+1, 0);
@@ -115,19 +438,6 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
-    namespace impl
-    {
-        inline size_t bounding_power_of_two (
-            size_t n
-        )
-        {
-            size_t s = 1;
-            for (unsigned int i = 0; i < sizeof(s)*8 && s < n; ++i)
-                s <<= 1;
-            return s;
-        }
-    }
-
     template <
         typename EXP1, 
         typename EXP2
@@ -141,8 +451,9 @@ namespace dlib
         using T = typename EXP1::type;
         COMPILE_TIME_ASSERT((is_same_type<double,T>::value || is_same_type<float,T>::value || is_same_type<long double,T>::value ));
 
-        const long pad_nr = impl::bounding_power_of_two(u.nr() + v.nr() - 1);
-        const long pad_nc = impl::bounding_power_of_two(u.nc() + v.nc() - 1);
+        // fft() works with any size, but it's fastest on sizes with only small factors.
+        const long pad_nr = impl::fft_fast_size(u.nr() + v.nr() - 1);
+        const long pad_nc = impl::fft_fast_size(u.nc() + v.nc() - 1);
 
         matrix<std::complex<T>> U(pad_nr, pad_nc), V(pad_nr,pad_nc);
 
@@ -174,12 +485,17 @@ namespace dlib
                 nr_ = 0;
             if (m1.size() == 0 || m2.size() == 0)
                 nc_ = 0;
+
+            fft_result = impl::fft_conv_if_worthwhile<flip_m2>(m1, m2, m2.nr()/2, m2.nc()/2, nr_, nc_);
         }
 
         const M1& m1;
         const M2& m2;
         long nr_;
         long nc_;
+        // When the filter is big we compute the whole result with FFTs up front and
+        // apply() just reads it out.
+        std::shared_ptr<const matrix<typename M1::type> > fft_result;
 
         const static long cost = (M1::cost+M2::cost)*10;
         const static long NR = M1::NR;
@@ -191,6 +507,9 @@ namespace dlib
 
         const_ret_type apply (long r, long c) const 
         { 
+            if (fft_result)
+                return (*fft_result)(r,c);
+
             r += m2.nr()/2;
             c += m2.nc()/2;
 
@@ -269,12 +588,17 @@ namespace dlib
                 nr_ = 0;
             if (nc_ < 0 || nr_ <= 0 || m1.size() == 0 || m2.size() == 0)
                 nc_ = 0;
+
+            fft_result = impl::fft_conv_if_worthwhile<flip_m2>(m1, m2, m2.nr()-1, m2.nc()-1, nr_, nc_);
         }
 
         const M1& m1;
         const M2& m2;
         long nr_; 
         long nc_;
+        // When the filter is big we compute the whole result with FFTs up front and
+        // apply() just reads it out.
+        std::shared_ptr<const matrix<typename M1::type> > fft_result;
 
         const static long cost = (M1::cost+M2::cost)*10;
         const static long NR = (M1::NR*M2::NR==0) ? (0) : (M1::NR-M2::NR+1);
@@ -286,6 +610,9 @@ namespace dlib
 
         const_ret_type apply (long r, long c) const 
         { 
+            if (fft_result)
+                return (*fft_result)(r,c);
+
             r += m2.nr()-1;
             c += m2.nc()-1;
 
@@ -352,6 +679,113 @@ namespace dlib
 // ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
 
+// ----------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    class fft_convolver
+    {
+        COMPILE_TIME_ASSERT(impl::is_fft_conv_type<T>::value);
+
+    public:
+        typedef T type;
+
+        fft_convolver (
+        ) = default;
+
+        template <typename EXP>
+        explicit fft_convolver (
+            const matrix_exp<EXP>& img
+        )
+        {
+            set_image(img);
+        }
+
+        template <typename EXP>
+        void set_image (
+            const matrix_exp<EXP>& img
+        )
+        {
+            COMPILE_TIME_ASSERT((is_same_type<typename EXP::type,T>::value == true));
+            image = img;
+            spectra.clear();
+            layout = impl::fft_conv_layout();
+        }
+
+        long nr (
+        ) const { return image.nr(); }
+
+        long nc (
+        ) const { return image.nc(); }
+
+        template <typename EXP>
+        matrix<T> conv (
+            const matrix_exp<EXP>& filter
+        ) { return convolve(filter, false, 0, 0, image.nr()+filter.nr()-1, image.nc()+filter.nc()-1); }
+
+        template <typename EXP>
+        matrix<T> xcorr (
+            const matrix_exp<EXP>& filter
+        ) { return convolve(filter, true, 0, 0, image.nr()+filter.nr()-1, image.nc()+filter.nc()-1); }
+
+        template <typename EXP>
+        matrix<T> conv_same (
+            const matrix_exp<EXP>& filter
+        ) { return convolve(filter, false, filter.nr()/2, filter.nc()/2, image.nr(), image.nc()); }
+
+        template <typename EXP>
+        matrix<T> xcorr_same (
+            const matrix_exp<EXP>& filter
+        ) { return convolve(filter, true, filter.nr()/2, filter.nc()/2, image.nr(), image.nc()); }
+
+        template <typename EXP>
+        matrix<T> conv_valid (
+            const matrix_exp<EXP>& filter
+        ) { return convolve(filter, false, filter.nr()-1, filter.nc()-1, image.nr()-filter.nr()+1, image.nc()-filter.nc()+1); }
+
+        template <typename EXP>
+        matrix<T> xcorr_valid (
+            const matrix_exp<EXP>& filter
+        ) { return convolve(filter, true, filter.nr()-1, filter.nc()-1, image.nr()-filter.nr()+1, image.nc()-filter.nc()+1); }
+
+    private:
+
+        template <typename EXP>
+        matrix<T> convolve (
+            const matrix_exp<EXP>& filter,
+            bool flip_filter,
+            long top,
+            long left,
+            long out_nr,
+            long out_nc
+        )
+        {
+            COMPILE_TIME_ASSERT((is_same_type<typename EXP::type,T>::value == true));
+            if (image.size() == 0 || filter.size() == 0 || out_nr <= 0 || out_nc <= 0)
+                return matrix<T>();
+
+            // The transforms of the image tiles only depend on the layout, so we keep
+            // them around for as long as the layout can handle the filters we are given.
+            if (!layout.can_convolve(filter.nr(), filter.nc()))
+            {
+                layout = impl::choose_fft_conv_layout(image.nr(), image.nc(), filter.nr(), filter.nc());
+                spectra.clear();
+                const long num_tiles = ((image.nr()+layout.tile_nr-1)/layout.tile_nr)*
+                                       ((image.nc()+layout.tile_nc-1)/layout.tile_nc);
+                spectra.resize((num_tiles+1)/2);
+                for (long tile = 0; tile < num_tiles; tile += 2)
+                    impl::fft_conv_tile_pair(image, layout, tile, spectra[tile/2]);
+            }
+            return impl::fft_conv(image, filter, flip_filter, top, left, out_nr, out_nc, layout, &spectra);
+        }
+
+        matrix<T> image;
+        impl::fft_conv_layout layout;
+        std::vector<matrix<std::complex<T> > > spectra;
+    };
+
+// ----------------------------------------------------------------------------------------
+
 }
 
 #endif // DLIB_MATRIx_CONV_Hh_
@@ -24,6 +24,11 @@ namespace dlib
                 - R::type == the same type that was in m1 and m2.
                 - R.nr() == m1.nr()+m2.nr()-1
                 - R.nc() == m1.nc()+m2.nc()-1
+            - If m1 and m2 contain float, double, or long double values and m1.size(),
+              m2.size(), and R.size() are all >= get_conv_fft_threshold() then R is computed
+              with overlap-add FFT convolution when this function is called rather than
+              one element at a time.  Otherwise the direct loops are used.  The results
+              are the same either way, up to rounding.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -43,6 +48,8 @@ namespace dlib
                 - R::type == the same type that was in m1 and m2.
                 - R.nr() == m1.nr()+m2.nr()-1
                 - R.nc() == m1.nc()+m2.nc()-1
+            - Like conv(), this function uses FFTs when m2 is large.  See
+              get_conv_fft_threshold().
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -81,6 +88,8 @@ namespace dlib
                 - R::type == the same type that was in m1 and m2.
                 - R.nr() == m1.nr()
                 - R.nc() == m1.nc()
+            - Like conv(), this function uses FFTs when m2 is large.  See
+              get_conv_fft_threshold().
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -100,6 +109,8 @@ namespace dlib
                 - R::type == the same type that was in m1 and m2.
                 - R.nr() == m1.nr()
                 - R.nc() == m1.nc()
+            - Like conv(), this function uses FFTs when m2 is large.  See
+              get_conv_fft_threshold().
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -124,6 +135,8 @@ namespace dlib
                 - else
                     - R.nr() == 0
                     - R.nc() == 0
+            - Like conv(), this function uses FFTs when m2 is large.  See
+              get_conv_fft_threshold().
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -147,8 +160,185 @@ namespace dlib
                 - else
                     - R.nr() == 0
                     - R.nc() == 0
+            - Like conv(), this function uses FFTs when m2 is large.  See
+              get_conv_fft_threshold().
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    long get_conv_fft_threshold (
+    );
+    /*!
+        ensures
+            - returns the size, in elements, that a filter must reach before conv(),
+              conv_same(), conv_valid(), the xcorr versions of them, and
+              spatially_filter_image() switch from direct convolution to FFT based
+              convolution.  The output must also have at least this many elements.
+            - The default is 400, i.e. a 20x20 filter.  The best value depends on the
+              machine, so tools/benchmarks/conv_fft_benchmark measures it and prints a
+              recommended setting.
+    !*/
+
+    void set_conv_fft_threshold (
+        long threshold
+    );
+    /*!
+        ensures
+            - #get_conv_fft_threshold() == threshold
+            - This setting is global to the program and is safe to change from any
+              thread.  Setting it to 0 makes every float, double, and long double
+              convolution use FFTs.  Setting it to std::numeric_limits<long>::max()
+              disables the FFT path.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class fft_convolver
+    {
+        /*!
+            REQUIREMENTS ON T
+                T must be float, double, or long double.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object convolves one image with many filters using FFTs.  The image
+                is cut into tiles and each tile is transformed once, the first time a
+                filter is applied.  Every filter after that only costs one transform of
+                the filter and the inverse transforms of the tiles.  So if you are
+                applying a bank of filters to the same image this is much faster than
+                calling conv() or xcorr() once per filter.
+
+                The tile transforms are kept as long as the filters fit in the tiles.  If
+                you give a filter bigger than any you gave before, the tiles are chosen
+                again and transformed again.  So it's best to apply the biggest filter
+                first.
+
+            THREAD SAFETY
+                Since the convolution methods update the cached transforms, they are
+                not const and you must not call them on the same object from multiple
+                threads at once.
+        !*/
+
+    public:
+        typedef T type;
+
+        fft_convolver (
+        );
+        /*!
+            ensures
+                - #nr() == 0
+                - #nc() == 0
+        !*/
+
+        template <typename EXP>
+        explicit fft_convolver (
+            const matrix_exp<EXP>& img
+        );
+        /*!
+            requires
+                - EXP::type == T
+            ensures
+                - performs set_image(img)
+        !*/
+
+        template <typename EXP>
+        void set_image (
+            const matrix_exp<EXP>& img
+        );
+        /*!
+            requires
+                - EXP::type == T
+            ensures
+                - This object now convolves filters with a copy of img.
+                - #nr() == img.nr()
+                - #nc() == img.nc()
+        !*/
+
+        long nr (
+        ) const;
+        /*!
+            ensures
+                - returns the number of rows in the image.
+        !*/
+
+        long nc (
+        ) const;
+        /*!
+            ensures
+                - returns the number of columns in the image.
+        !*/
+
+        template <typename EXP>
+        matrix<T> conv (
+            const matrix_exp<EXP>& filter
+        );
+        /*!
+            requires
+                - EXP::type == T
+            ensures
+                - returns dlib::conv(IMG, filter), where IMG is the image given to
+                  set_image().  The result is computed with FFTs regardless of
+                  get_conv_fft_threshold().
+        !*/
+
+        template <typename EXP>
+        matrix<T> xcorr (
+            const matrix_exp<EXP>& filter
+        );
+        /*!
+            requires
+                - EXP::type == T
+            ensures
+                - returns dlib::xcorr(IMG, filter), computed with FFTs.
+        !*/
+
+        template <typename EXP>
+        matrix<T> conv_same (
+            const matrix_exp<EXP>& filter
+        );
+        /*!
+            requires
+                - EXP::type == T
+            ensures
+                - returns dlib::conv_same(IMG, filter), computed with FFTs.
+        !*/
+
+        template <typename EXP>
+        matrix<T> xcorr_same (
+            const matrix_exp<EXP>& filter
+        );
+        /*!
+            requires
+                - EXP::type == T
+            ensures
+                - returns dlib::xcorr_same(IMG, filter), computed with FFTs.
+        !*/
+
+        template <typename EXP>
+        matrix<T> conv_valid (
+            const matrix_exp<EXP>& filter
+        );
+        /*!
+            requires
+                - EXP::type == T
+            ensures
+                - returns dlib::conv_valid(IMG, filter), computed with FFTs.
+        !*/
+
+        template <typename EXP>
+        matrix<T> xcorr_valid (
+            const matrix_exp<EXP>& filter
+        );
+        /*!
+            requires
+                - EXP::type == T
+            ensures
+                - returns dlib::xcorr_valid(IMG, filter), computed with FFTs.
+        !*/
+    };
+
 // ----------------------------------------------------------------------------------------
 
 }
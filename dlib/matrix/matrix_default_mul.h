@@ -7,6 +7,9 @@
 #include "matrix.h"
 #include "matrix_utilities.h"
 #include "../enable_if.h"
+#include "../simd.h"
+#include "../threads/parallel_for_extension.h"
+#include <vector>
 
 namespace dlib
 {
@@ -21,6 +24,344 @@ namespace dlib
         struct matrix_is_vector<EXP, typename enable_if_c<EXP::NR==1 || EXP::NC==1>::type > { static const bool value = true; };
     }
 
+// ------------------------------------------------------------------------------------
+
+    namespace ma
+    {
+        /*!
+            The float and double matrix multiplies below are done the way optimized BLAS
+            libraries do them.  lhs and rhs are copied, a block at a time, into buffers
+            laid out in the order a small kernel reads them.  The kernel then computes an
+            MR by NR tile of the result, keeping it in registers for the whole length of
+            the block.  The block sizes are picked so that a KC by NR sliver of rhs stays
+            in the L1 cache, an MC by KC block of lhs in the L2 cache and a KC by NC block
+            of rhs in the L3 cache.  Copying the blocks costs little next to the
+            multiplication and it lets the kernel read memory sequentially whatever kind
+            of matrix expression lhs and rhs are.  Large products can be split over the
+            threads of a thread_pool, but default_matrix_multiply() always runs in the
+            calling thread.  It is often called from code that is already running on a
+            thread pool, or that has promised its callers not to start any threads.
+        !*/
+
+        template <typename T>
+        struct gemm_kernel
+        {
+            // This generic kernel is for double, which the compiler vectorizes well for
+            // this tile size on each instruction set we have tried.
+            const static long MR = 4;
+            const static long NR = 8;
+
+            static void multiply (
+                long kc,
+                const T* a,
+                const T* b,
+                T* c
+            )
+            {
+                T acc[MR][NR] = {};
+                for (long p = 0; p < kc; ++p, a += MR, b += NR)
+                {
+                    for (long i = 0; i < MR; ++i)
+                    {
+                        const T ai = a[i];
+                        for (long j = 0; j < NR; ++j)
+                            acc[i][j] += ai*b[j];
+                    }
+                }
+                for (long i = 0; i < MR; ++i)
+                {
+                    for (long j = 0; j < NR; ++j)
+                        c[i*NR+j] = acc[i][j];
+                }
+            }
+        };
+
+        template <>
+        struct gemm_kernel<float>
+        {
+            // Each row of the tile is NR/8 simd8f registers.  With AVX that's 12 of the
+            // 16 registers for the tile.  Otherwise each simd8f is a pair of 4 float
+            // registers, so the tile is kept small enough to leave room for the inputs.
+#ifdef DLIB_HAVE_AVX
+            const static long MR = 6;
+            const static long NR = 16;
+#else
+            const static long MR = 4;
+            const static long NR = 8;
+#endif
+            const static long NV = NR/8;
+
+            static void multiply (
+                long kc,
+                const float* a,
+                const float* b,
+                float* c
+            )
+            {
+                simd8f acc[MR][NV];
+                for (long i = 0; i < MR; ++i)
+                {
+                    for (long v = 0; v < NV; ++v)
+                        acc[i][v] = 0;
+                }
+                for (long p = 0; p < kc; ++p, a += MR, b += NR)
+                {
+                    simd8f bv[NV];
+                    for (long v = 0; v < NV; ++v)
+                        bv[v].load(b+8*v);
+                    for (long i = 0; i < MR; ++i)
+                    {
+                        const simd8f ai(a[i]);
+                        for (long v = 0; v < NV; ++v)
+                            acc[i][v] += ai*bv[v];
+                    }
+                }
+                for (long i = 0; i < MR; ++i)
+                {
+                    for (long v = 0; v < NV; ++v)
+                        acc[i][v].store(c+i*NR+8*v);
+                }
+            }
+        };
+
+        template <
+            typename matrix_dest_type,
+            typename EXP1,
+            typename EXP2
+            >
+        void packed_matrix_multiply (
+            matrix_dest_type& dest,
+            const EXP1& lhs,
+            const EXP2& rhs,
+            thread_pool* tp
+        )
+        /*!
+            requires
+                - EXP1::type, EXP2::type and matrix_dest_type::type are all float or all
+                  double.
+            ensures
+                - #dest == dest + lhs*rhs
+                - If tp != 0 then the work is split over the threads in *tp, otherwise it
+                  is all done in the calling thread.  #dest is the same, bit for bit,
+                  either way.
+        !*/
+        {
+            typedef typename EXP1::type T;
+            typedef gemm_kernel<T> kernel;
+            const long MR = kernel::MR;
+            const long NR = kernel::NR;
+            const long KC = 256;
+            const long MC = MR*(sizeof(T) == sizeof(float) ? 12 : 18);
+            const long NC = NR*(sizeof(T) == sizeof(float) ? 128 : 256);
+
+            const long m = lhs.nr();
+            const long n = rhs.nc();
+            const long k = lhs.nc();
+            const long kc_max = std::min(KC, k);
+
+            // dest is cut into macro tiles MC rows tall and NC columns wide, numbered down
+            // each column of tiles.  Each thread packs the blocks of lhs and rhs for its
+            // tiles into buffers of its own, so the threads only share dest and never
+            // write the same part of it.  Every element of dest is added up in the same
+            // order whichever thread computes it.
+            const long num_row_tiles = (m+MC-1)/MC;
+            const long num_col_tiles = (n+NC-1)/NC;
+            auto multiply_tiles = [&](long begin, long end)
+            {
+                std::vector<T> lhs_block(((std::min(MC,m)+MR-1)/MR)*MR*kc_max);
+                std::vector<T> rhs_block(((std::min(NC,n)+NR-1)/NR)*NR*kc_max);
+                T tile[MR*NR];
+
+                while (begin < end)
+                {
+                    // The tiles in [begin,end) that are in the same column of tiles.
+                    const long col_tile = begin/num_row_tiles;
+                    const long col_end = std::min(end, (col_tile+1)*num_row_tiles);
+                    const long jc = col_tile*NC;
+                    const long nc = std::min(NC, n-jc);
+                    const long ic_begin = (begin%num_row_tiles)*MC;
+                    const long ic_end = std::min(m, ic_begin + (col_end-begin)*MC);
+                    begin = col_end;
+
+                    for (long pc = 0; pc < k; pc += KC)
+                    {
+                        const long kc = std::min(KC, k-pc);
+
+                        // Copy rhs(pc:pc+kc, jc:jc+nc) into slivers NR columns wide, each
+                        // stored one row after another.  The columns past the edge of rhs
+                        // are filled with zeros so the kernel doesn't need to check for
+                        // them.
+                        for (long j = 0; j < nc; j += NR)
+                        {
+                            T* b = &rhs_block[j*kc];
+                            const long nr = std::min(NR, nc-j);
+                            for (long p = 0; p < kc; ++p, b += NR)
+                            {
+                                long jj = 0;
+                                for (; jj < nr; ++jj)
+                                    b[jj] = rhs(pc+p, jc+j+jj);
+                                for (; jj < NR; ++jj)
+                                    b[jj] = 0;
+                            }
+                        }
+
+                        for (long ic = ic_begin; ic < ic_end; ic += MC)
+                        {
+                            const long mc = std::min(MC, m-ic);
+
+                            // Likewise, copy lhs(ic:ic+mc, pc:pc+kc) into slivers MR rows
+                            // tall, each stored one column after another.
+                            for (long i = 0; i < mc; i += MR)
+                            {
+                                T* a = &lhs_block[i*kc];
+                                const long mr = std::min(MR, mc-i);
+                                for (long p = 0; p < kc; ++p, a += MR)
+                                {
+                                    long ii = 0;
+                                    for (; ii < mr; ++ii)
+                                        a[ii] = lhs(ic+i+ii, pc+p);
+                                    for (; ii < MR; ++ii)
+                                        a[ii] = 0;
+                                }
+                            }
+
+                            for (long j = 0; j < nc; j += NR)
+                            {
+                                const long nr = std::min(NR, nc-j);
+                                for (long i = 0; i < mc; i += MR)
+                                {
+                                    const long mr = std::min(MR, mc-i);
+                                    kernel::multiply(kc, &lhs_block[i*kc], &rhs_block[j*kc], tile);
+                                    for (long ii = 0; ii < mr; ++ii)
+                                    {
+                                        for (long jj = 0; jj < nr; ++jj)
+                                            dest(ic+i+ii, jc+j+jj) += tile[ii*NR+jj];
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            };
+
+            // Handing out the tiles costs more than it saves on small products.
+            const double min_parallel_work = 1<<21;
+            if (tp == 0 || (double)m*n*k < min_parallel_work)
+                multiply_tiles(0, num_row_tiles*num_col_tiles);
+            else
+                parallel_for_blocked(*tp, 0, num_row_tiles*num_col_tiles, multiply_tiles);
+        }
+
+        template <
+            typename matrix_dest_type,
+            typename EXP1,
+            typename EXP2
+            >
+        void packed_matrix_multiply (
+            matrix_dest_type& dest,
+            const EXP1& lhs,
+            const EXP2& rhs,
+            thread_pool& tp
+        )
+        /*!
+            requires
+                - EXP1::type, EXP2::type and matrix_dest_type::type are all float or all
+                  double.
+            ensures
+                - #dest == dest + lhs*rhs
+                - The work is split over the threads in tp.  #dest is the same, bit for
+                  bit, however many threads tp has.
+        !*/
+        {
+            packed_matrix_multiply(dest, lhs, rhs, &tp);
+        }
+
+        template <
+            typename matrix_dest_type,
+            typename EXP1,
+            typename EXP2
+            >
+        void packed_matrix_multiply (
+            matrix_dest_type& dest,
+            const EXP1& lhs,
+            const EXP2& rhs
+        )
+        /*!
+            requires
+                - EXP1::type, EXP2::type and matrix_dest_type::type are all float or all
+                  double.
+            ensures
+                - #dest == dest + lhs*rhs
+                - All the work is done in the calling thread.
+        !*/
+        {
+            packed_matrix_multiply(dest, lhs, rhs, static_cast<thread_pool*>(0));
+        }
+
+        template <
+            typename matrix_dest_type,
+            typename EXP1,
+            typename EXP2
+            >
+        void blocked_matrix_multiply (
+            matrix_dest_type& dest,
+            const EXP1& lhs,
+            const EXP2& rhs
+        )
+        /*!
+            ensures
+                - #dest == dest + lhs*rhs
+        !*/
+        {
+            // This is a cache friendly algorithm that computes the matrix multiply in
+            // blocks.
+            const long bs = 90;
+
+            // Loop over all the blocks in the lhs matrix
+            for (long r = 0; r < lhs.nr(); r+=bs)
+            {
+                for (long c = 0; c < lhs.nc(); c+=bs)
+                {
+                    // make a rect for the block from lhs 
+                    rectangle lhs_block(c, r, std::min(c+bs-1,lhs.nc()-1), std::min(r+bs-1,lhs.nr()-1));
+
+                    // now loop over all the rhs blocks we have to multiply with the current lhs block
+                    for (long i = 0; i < rhs.nc(); i += bs)
+                    {
+                        // make a rect for the block from rhs 
+                        rectangle rhs_block(i, c, std::min(i+bs-1,rhs.nc()-1), std::min(c+bs-1,rhs.nr()-1));
+
+                        // make a target rect in res
+                        rectangle res_block(rhs_block.left(),lhs_block.top(), rhs_block.right(), lhs_block.bottom());
+
+                        // This loop is optimized assuming that the data is laid out in 
+                        // row major order in memory.
+                        for (long r = lhs_block.top(); r <= lhs_block.bottom(); ++r)
+                        {
+                            for (long c = lhs_block.left(); c<= lhs_block.right(); ++c)
+                            {
+                                const typename EXP2::type temp = lhs(r,c);
+                                for (long i = rhs_block.left(); i <= rhs_block.right(); ++i)
+                                {
+                                    dest(r,i) += rhs(c,i)*temp;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        template <typename dest_type, typename EXP1, typename EXP2>
+        struct use_packed_matrix_multiply
+        {
+            typedef typename EXP1::type T;
+            const static bool value = (is_same_type<T,float>::value || is_same_type<T,double>::value) &&
+                                      is_same_type<T,typename EXP2::type>::value &&
+                                      is_same_type<T,typename dest_type::type>::value;
+        };
+    }
+
 // ------------------------------------------------------------------------------------
 
     /*!  This file defines the default_matrix_multiply() function.  It is a function 
@@ -68,7 +409,8 @@ namespace dlib
         typename EXP1,
         typename EXP2
         >
-    typename enable_if_c<ma::matrix_is_vector<EXP1>::value == false && ma::matrix_is_vector<EXP2>::value == false>::type 
+    typename enable_if_c<ma::matrix_is_vector<EXP1>::value == false && ma::matrix_is_vector<EXP2>::value == false &&
+                         ma::use_packed_matrix_multiply<matrix_dest_type,EXP1,EXP2>::value>::type 
     default_matrix_multiply (
         matrix_dest_type& dest,
         const EXP1& lhs,
@@ -78,52 +420,48 @@ namespace dlib
         const long bs = 90;
 
         // if the matrices are small enough then just use the simple multiply algorithm
-        if (lhs.nc() <= 2 || rhs.nc() <= 2 || lhs.nr() <= 2 || rhs.nr() <= 2 || (lhs.size() <= bs*10 && rhs.size() <= bs*10) )
+        if (lhs.nc() <= 2 || rhs.nc() <= 2 || (lhs.size() <= bs*10 && rhs.size() <= bs*10) )
         {
             matrix_assign_default(dest, lhs*rhs, 1, true);
         }
+        else if (lhs.nr() <= 2)
+        {
+            // With so few rows there is too little arithmetic to make up for copying rhs,
+            // so just stream through it.
+            ma::blocked_matrix_multiply(dest, lhs, rhs);
+        }
         else
         {
-            // if the lhs and rhs matrices are big enough we should use a cache friendly
-            // algorithm that computes the matrix multiply in blocks.  
-
-
-            // Loop over all the blocks in the lhs matrix
-            for (long r = 0; r < lhs.nr(); r+=bs)
-            {
-                for (long c = 0; c < lhs.nc(); c+=bs)
-                {
-                    // make a rect for the block from lhs 
-                    rectangle lhs_block(c, r, std::min(c+bs-1,lhs.nc()-1), std::min(r+bs-1,lhs.nr()-1));
+            ma::packed_matrix_multiply(dest, lhs, rhs);
+        }
+    }
 
-                    // now loop over all the rhs blocks we have to multiply with the current lhs block
-                    for (long i = 0; i < rhs.nc(); i += bs)
-                    {
-                        // make a rect for the block from rhs 
-                        rectangle rhs_block(i, c, std::min(i+bs-1,rhs.nc()-1), std::min(c+bs-1,rhs.nr()-1));
+// ------------------------------------------------------------------------------------
 
-                        // make a target rect in res
-                        rectangle res_block(rhs_block.left(),lhs_block.top(), rhs_block.right(), lhs_block.bottom());
+    template <
+        typename matrix_dest_type,
+        typename EXP1,
+        typename EXP2
+        >
+    typename enable_if_c<ma::matrix_is_vector<EXP1>::value == false && ma::matrix_is_vector<EXP2>::value == false &&
+                         ma::use_packed_matrix_multiply<matrix_dest_type,EXP1,EXP2>::value == false>::type 
+    default_matrix_multiply (
+        matrix_dest_type& dest,
+        const EXP1& lhs,
+        const EXP2& rhs
+    )
+    {
+        const long bs = 90;
 
-                        // This loop is optimized assuming that the data is laid out in 
-                        // row major order in memory.
-                        for (long r = lhs_block.top(); r <= lhs_block.bottom(); ++r)
-                        {
-                            for (long c = lhs_block.left(); c<= lhs_block.right(); ++c)
-                            {
-                                const typename EXP2::type temp = lhs(r,c);
-                                for (long i = rhs_block.left(); i <= rhs_block.right(); ++i)
-                                {
-                                    dest(r,i) += rhs(c,i)*temp;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+        // if the matrices are small enough then just use the simple multiply algorithm
+        if (lhs.nc() <= 2 || rhs.nc() <= 2 || lhs.nr() <= 2 || rhs.nr() <= 2 || (lhs.size() <= bs*10 && rhs.size() <= bs*10) )
+        {
+            matrix_assign_default(dest, lhs*rhs, 1, true);
+        }
+        else
+        {
+            ma::blocked_matrix_multiply(dest, lhs, rhs);
         }
-
-
     }
 
 // ------------------------------------------------------------------------------------
@@ -8,6 +8,7 @@
 #include "matrix.h" 
 #include "matrix_utilities.h"
 #include "matrix_subexp.h"
+#include "matrix_la_blocked.h"
 #include <algorithm>
 #include <complex>
 #include <cmath>
@@ -113,6 +114,13 @@ namespace dlib
         // Symmetric Householder reduction to tridiagonal form.
         void tred2();
 
+        // Blocked symmetric Householder reduction to tridiagonal form.  This does the
+        // same thing as tred2() but is much faster on big matrices.
+        void tridiagonalize_blocked();
+
+        // Reduce to tridiagonal form with whichever of the above is best for n.
+        void tridiagonalize();
+
 
         // Symmetric tridiagonal QL algorithm.
         void tql2 ();
@@ -197,7 +205,7 @@ namespace dlib
             }
 #endif
             // Tridiagonalize.
-            tred2();
+            tridiagonalize();
 
             // Diagonalize.
             tql2();
@@ -277,7 +285,7 @@ namespace dlib
         }
 #endif
         // Tridiagonalize.
-        tred2();
+        tridiagonalize();
 
         // Diagonalize.
         tql2();
@@ -550,13 +558,198 @@ namespace dlib
         }
         V(n-1,n-1) = 1.0;
         e(0) = 0.0;
-    } 
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename matrix_exp_type>
+    void eigenvalue_decomposition<matrix_exp_type>::
+    tridiagonalize()
+    {
+        if (n > blocked_la::block_size)
+            tridiagonalize_blocked();
+        else
+            tred2();
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename matrix_exp_type>
+    void eigenvalue_decomposition<matrix_exp_type>::
+    tridiagonalize_blocked()
+    {
+        using std::abs;
+        using std::sqrt;
+
+        //  This is the blocked algorithm used by LAPACK's dsytrd and dorgtr, see
+        //  "Block reduction of matrices to condensed forms for eigenvalue computations"
+        //  by Dongarra, Sorensen, and Hammarling.  Column i is reduced with the
+        //  reflection I - tau(i)*v*trans(v), where v(0:i) is 0 and v(i+1) is 1.  The
+        //  reflections are made a panel of columns at a time.  While working on a
+        //  panel the rest of the matrix isn't updated.  Instead, the panel's
+        //  reflections are kept in Vp along with a matrix Wp such that the updated
+        //  matrix is A - Vp*trans(Wp) - Wp*trans(Vp).  Once the panel is done that
+        //  update is applied to the rest of the matrix with matrix multiplies.  The
+        //  output is the same as tred2()'s: d and e hold the diagonal and subdiagonal
+        //  of the tridiagonal matrix and V the product of the reflections.
+
+        typedef matrix<type,0,0,mem_manager_type,row_major_layout> work_matrix_type;
+        typedef matrix<type,0,0,mem_manager_type,column_major_layout> panel_matrix_type;
+        typedef matrix<type,0,1,mem_manager_type,column_major_layout> panel_vector_type;
+
+        const long bs = blocked_la::block_size;
+
+        // We keep all of the symmetric matrix A rather than just its lower triangle.
+        // That way column i can be read from row i, which is contiguous in memory.
+        // Once the reflection for column i is made we save v(i+2:n) below the
+        // subdiagonal of column i since those elements aren't needed anymore.
+        work_matrix_type A(V);
+        panel_vector_type tau(n), a(n), y(n);
+        tau = 0;
+        e(0) = 0;
+
+        for (long k0 = 0; k0 < n; k0 += bs)
+        {
+            const long kb = std::min(bs, n-k0);
+            panel_matrix_type Vp(n, kb), Wp(n, kb);
+            Vp = 0;
+            Wp = 0;
+
+            for (long j = 0; j < kb; ++j)
+            {
+                const long i = k0+j;
+
+                // Apply the panel's previous reflections to column i.
+                for (long r = i; r < n; ++r)
+                {
+                    type temp = A(i,r);
+                    for (long q = 0; q < j; ++q)
+                        temp -= Vp(r,q)*Wp(i,q) + Wp(r,q)*Vp(i,q);
+                    a(r) = temp;
+                }
+                d(i) = a(i);
+                if (i+1 == n)
+                    break;
+
+                // Generate the reflection that zeros a(i+2:n).
+                type scale = 0;
+                for (long r = i+2; r < n; ++r)
+                    scale = std::max(scale, abs(a(r)));
+                type xnorm = 0;
+                if (scale != 0)
+                {
+                    for (long r = i+2; r < n; ++r)
+                        xnorm += (a(r)/scale)*(a(r)/scale);
+                    xnorm = scale*sqrt(xnorm);
+                }
+
+                const type alpha = a(i+1);
+                type beta = alpha;
+                if (xnorm != 0)
+                {
+                    beta = hypot(alpha, xnorm);
+                    if (alpha >= 0)
+                        beta = -beta;
+                    tau(i) = (beta - alpha)/beta;
+                    const type temp = 1/(alpha - beta);
+                    for (long r = i+2; r < n; ++r)
+                        a(r) *= temp;
+                }
+                e(i+1) = beta;
+
+                Vp(i+1,j) = 1;
+                for (long r = i+2; r < n; ++r)
+                {
+                    Vp(r,j) = a(r);
+                    A(r,i) = a(r);
+                }
+
+                if (tau(i) == 0)
+                    continue;
+
+                // Compute the column of Wp for this reflection.  It is
+                //   y = tau*(A22 - Vp*trans(Wp) - Wp*trans(Vp))*v
+                //   Wp(:,j) = y - tau/2*dot(y,v)*v
+                // where A22 is the part of A below and to the right of A(i,i).
+                blocked_la::parallel_for_blocked_if_worthwhile(i+1, n, n-i-1,
+                    [&](long begin, long end)
+                    {
+                        for (long r = begin; r < end; ++r)
+                        {
+                            type temp = 0;
+                            for (long c = i+1; c < n; ++c)
+                                temp += A(r,c)*Vp(c,j);
+                            y(r) = temp;
+                        }
+                    });
+                for (long q = 0; q < j; ++q)
+                {
+                    type wv = 0, vv = 0;
+                    for (long r = i+1; r < n; ++r)
+                    {
+                        wv += Wp(r,q)*Vp(r,j);
+                        vv += Vp(r,q)*Vp(r,j);
+                    }
+                    for (long r = i+1; r < n; ++r)
+                        y(r) -= Vp(r,q)*wv + Wp(r,q)*vv;
+                }
+                type yv = 0;
+                for (long r = i+1; r < n; ++r)
+                {
+                    y(r) *= tau(i);
+                    yv += y(r)*Vp(r,j);
+                }
+                const type temp = -tau(i)/2*yv;
+                for (long r = i+1; r < n; ++r)
+                    Wp(r,j) = y(r) + temp*Vp(r,j);
+            }
+
+            // Apply the panel to the rest of A.
+            const long s = k0+kb;
+            if (s < n)
+            {
+                blocked_la::subtract_product(A, s, s, subm(Vp,s,0,n-s,kb), trans(subm(Wp,s,0,n-s,kb)));
+                blocked_la::subtract_product(A, s, s, subm(Wp,s,0,n-s,kb), trans(subm(Vp,s,0,n-s,kb)));
+            }
+        }
+
+        // Now form the product of the reflections in V.  This is also done a panel at
+        // a time, starting with the last one.  The reflections of the panel starting
+        // at column k0 only touch rows and columns k0+1 through n-1.
+        V = identity_matrix<type>(n);
+        for (long k0 = ((n-1)/bs)*bs; k0 >= 0; k0 -= bs)
+        {
+            const long r0 = k0+1;
+            if (r0 >= n)
+                continue;
+
+            const long kb = std::min(bs, n-k0);
+            panel_matrix_type Vb(n-r0, kb);
+            panel_vector_type tb(kb);
+            for (long j = 0; j < kb; ++j)
+            {
+                const long i = k0+j;
+                for (long r = r0; r < n; ++r)
+                {
+                    if (r < i+1)
+                        Vb(r-r0,j) = 0;
+                    else if (r == i+1)
+                        Vb(r-r0,j) = 1;
+                    else
+                        Vb(r-r0,j) = A(r,i);
+                }
+                tb(j) = tau(i);
+            }
+            const panel_matrix_type Tm = blocked_la::block_reflector_factor(Vb, tb);
+            blocked_la::apply_block_reflector(false, Vb, Tm, V, r0, r0, n-r0);
+        }
+    }
 
 // ----------------------------------------------------------------------------------------
 
     template <typename matrix_exp_type>
     void eigenvalue_decomposition<matrix_exp_type>::
-    tql2 () 
+    tql2 ()
     {
         using std::pow;
         using std::min;
@@ -574,6 +767,13 @@ namespace dlib
         }
         e(n-1) = 0.0;
 
+        // The cosines and sines of the rotations done by each QL sweep.
+        std::vector<type> rot_c(n), rot_s(n);
+
+        // The rotations combine pairs of columns of V so we accumulate them in a
+        // column major copy of V, where each column is contiguous in memory.
+        matrix<type,0,0,mem_manager_type,column_major_layout> Z(V);
+
         type f = 0.0;
         type tst1 = 0.0;
         const type eps = std::numeric_limits<type>::epsilon();
@@ -650,15 +850,36 @@ namespace dlib
                         p = c * d(i) - s * g;
                         d(i+1) = h + s * (c * g + s * d(i));
 
-                        // Accumulate transformation.
+                        rot_c[i] = c;
+                        rot_s[i] = s;
+                    }
 
-                        for (long k = 0; k < n; k++) 
+                    // Accumulate transformation.  All the rotations from this sweep
+                    // are applied to one block of rows of Z before moving on to the
+                    // next block.  That keeps the block in cache and lets the blocks
+                    // be done in parallel.
+                    blocked_la::parallel_for_blocked_if_worthwhile(0, n, 4*(m-l), 
+                        [&](long begin, long end)
                         {
-                            h = V(k,i+1);
-                            V(k,i+1) = s * V(k,i) + c * h;
-                            V(k,i) = c * V(k,i) - s * h;
-                        }
-                    }
+                            const long bs = blocked_la::block_size;
+                            for (long k0 = begin; k0 < end; k0 += bs) 
+                            {
+                                const long kend = std::min(k0+bs, end);
+                                for (long i = m-1; i >= l; i--) 
+                                {
+                                    type* zi = &Z(0,i);
+                                    type* zi1 = &Z(0,i+1);
+                                    const type rc = rot_c[i];
+                                    const type rs = rot_s[i];
+                                    for (long k = k0; k < kend; k++) 
+                                    {
+                                        const type t = zi1[k];
+                                        zi1[k] = rs * zi[k] + rc * t;
+                                        zi[k] = rc * zi[k] - rs * t;
+                                    }
+                                }
+                            }
+                        });
                     p = -s * s2 * c3 * el1 * e(l) / dl1;
                     e(l) = s * p;
                     d(l) = c * p;
@@ -670,6 +891,7 @@ namespace dlib
             d(l) = d(l) + f;
             e(l) = 0.0;
         }
+        V = Z;
 
         /*
             The code to sort the eigenvalues and eigenvectors 
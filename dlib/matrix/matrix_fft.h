@@ -7,6 +7,13 @@
 #include "matrix_utilities.h"
 #include "../hash.h"
 #include "../algs.h"
+#include "matrix_la_blocked.h"
+#include <complex>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <algorithm>
 
 #ifdef DLIB_USE_MKL_FFT
 #include <mkl_dfti.h>
@@ -42,364 +49,853 @@ namespace dlib
     // ------------------------------------------------------------------------------------
 
         /*
-            The next few functions related to doing FFTs are derived from Stefan
-            Gustavson's (stegu@itn.liu.se) public domain 2D Fourier transformation code.
-            The code has a long history, originally a FORTRAN implementation published in:
-            Programming for Digital Signal Processing, IEEE Press 1979, Section 1, by G. D.
-            Bergland and M. T. Dolan.  In 2003 it was cleaned up and turned into modern C
-            by Steven Gustavson.  Davis King then rewrote it in modern C++ in 2014 and also
-            changed the transform so that the outputs are identical to those given from FFTW.
+            The FFT code below works for any transform length.  Lengths that factor into
+            small primes are done with a mixed radix Stockham FFT.  It has special
+            butterflies for the factors 2, 3, 4, and 5 and a generic butterfly for any
+            other prime factor up to fft_max_generic_radix.  The Stockham formulation
+            ping-pongs between two buffers and leaves the outputs in their natural order,
+            so there is no bit reversal pass, and the inner loop of every pass runs over
+            contiguous elements that all share the same twiddle factor, which the compiler
+            turns into SIMD code.  Lengths with a bigger prime factor are done with
+            Bluestein's algorithm, which turns the transform into a convolution whose
+            length only has the factors 2, 3, and 5.
+
+            The outputs are identical to those given from FFTW.  That is, the forward
+            transform uses exp(-2*pi*i*j*k/n), the inverse uses exp(+2*pi*i*j*k/n), and
+            neither is scaled.
         */
 
+        // The largest prime factor that is done with the O(p^2) generic butterfly.
+        // Lengths with bigger prime factors use Bluestein's algorithm.
+        const long fft_max_generic_radix = 31;
+
+        // The number of columns transformed together in a 2D FFT.
+        const long fft_column_block = 16;
+
     // ------------------------------------------------------------------------------------
 
-        /* Get binary log of integer argument - exact if n is a power of 2 */
-        inline long fastlog2(long n)
+        template <typename T>
+        std::complex<T> fft_root_of_unity (
+            long long k,
+            long long n
+        )
+        /*!
+            requires
+                - n > 0
+            ensures
+                - returns exp(-2*pi*i*k/n)
+        !*/
         {
-            long log = -1;
-            while(n) {
-                log++;
-                n >>= 1;
+            const long double two_pi = 6.283185307179586476925286766559005768L;
+            const long double angle = -two_pi*static_cast<long double>(k%n)/n;
+            return std::complex<T>(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle)));
+        }
+
+        template <bool inverse, typename T>
+        inline std::complex<T> fft_twiddle (
+            const std::complex<T>& a,
+            const std::complex<T>& w
+        )
+        /*!
+            ensures
+                - returns a*w if inverse == false and a*conj(w) otherwise.
+                - The product is written out by hand since the operator* of std::complex
+                  has to deal with infinities and NaNs, which keeps the compiler from
+                  vectorizing the loops it is in.
+        !*/
+        {
+            const T wi = inverse ? -w.imag() : w.imag();
+            return std::complex<T>(a.real()*w.real() - a.imag()*wi, a.real()*wi + a.imag()*w.real());
+        }
+
+        template <bool inverse, typename T>
+        inline std::complex<T> fft_rotate (
+            const std::complex<T>& a
+        )
+        /*!
+            ensures
+                - returns a*-i if inverse == false and a*i otherwise.
+        !*/
+        {
+            if (inverse)
+                return std::complex<T>(-a.imag(), a.real());
+            else
+                return std::complex<T>(a.imag(), -a.real());
+        }
+
+        inline long fft_fast_size (
+            long n
+        )
+        /*!
+            ensures
+                - returns the smallest number >= n that has no prime factors other than 2,
+                  3, and 5.
+        !*/
+        {
+            long best = 1;
+            while (best < n)
+                best *= 2;
+            for (long p5 = 1; p5 < best; p5 *= 5)
+            {
+                for (long p35 = p5; p35 < best; p35 *= 3)
+                {
+                    long v = p35;
+                    while (v < n)
+                        v *= 2;
+                    best = std::min(best, v);
+                }
             }
-            return log ;
+            return best;
         }
 
     // ------------------------------------------------------------------------------------
 
-        /* Radix-2 iteration subroutine */
-        template <typename T>
-        void R2TX(int nthpo, std::complex<T> *c0, std::complex<T> *c1)
+        /*
+            The functions below each do one pass of the Stockham FFT with radix r.  The
+            input x and the output y both hold r*m*s elements.  For all p < m, q < s, and
+            k < r they set:
+                y[q + s*(r*p+k)] = W(p*k, r*m) * sum over j < r of x[q + s*(p+j*m)]*W(j*k, r)
+            where W(a,n) is exp(-2*pi*i*a/n) for the forward transform and its conjugate
+            for the inverse.  w[p*(r-1)+k-1] must be W(p*k, r*m) for the forward transform.
+        */
+
+        template <bool inverse, typename T>
+        void fft_radix2_pass (
+            const long m,
+            const long s,
+            const std::complex<T>* w,
+            const std::complex<T>* x,
+            std::complex<T>* y
+        )
         {
-            for(int k=0; k<nthpo; k+=2) 
+            for (long p = 0; p < m; ++p)
             {
-                std::complex<T> temp = c0[k] + c1[k];
-                c1[k] = c0[k] - c1[k];
-                c0[k] = temp;
+                const std::complex<T> w1 = w[p];
+                const std::complex<T>* x0 = x + s*p;
+                const std::complex<T>* x1 = x0 + s*m;
+                std::complex<T>* y0 = y + 2*s*p;
+                std::complex<T>* y1 = y0 + s;
+                for (long q = 0; q < s; ++q)
+                {
+                    const std::complex<T> a0 = x0[q], a1 = x1[q];
+                    y0[q] = a0 + a1;
+                    y1[q] = fft_twiddle<inverse>(a0 - a1, w1);
+                }
             }
         }
 
-    // ------------------------------------------------------------------------------------
+        template <bool inverse, typename T>
+        void fft_radix3_pass (
+            const long m,
+            const long s,
+            const std::complex<T>* w,
+            const std::complex<T>* x,
+            std::complex<T>* y
+        )
+        {
+            const T half = 0.5;
+            const T sin60 = -fft_root_of_unity<T>(1,3).imag();
+            for (long p = 0; p < m; ++p)
+            {
+                const std::complex<T> w1 = w[2*p], w2 = w[2*p+1];
+                const std::complex<T>* x0 = x + s*p;
+                const std::complex<T>* x1 = x0 + s*m;
+                const std::complex<T>* x2 = x1 + s*m;
+                std::complex<T>* y0 = y + 3*s*p;
+                std::complex<T>* y1 = y0 + s;
+                std::complex<T>* y2 = y1 + s;
+                for (long q = 0; q < s; ++q)
+                {
+                    const std::complex<T> a0 = x0[q], a1 = x1[q], a2 = x2[q];
+                    const std::complex<T> t1 = a1 + a2;
+                    const std::complex<T> t2 = a0 - t1*half;
+                    const std::complex<T> t3 = fft_rotate<inverse>((a1 - a2)*sin60);
+                    y0[q] = a0 + t1;
+                    y1[q] = fft_twiddle<inverse>(t2 + t3, w1);
+                    y2[q] = fft_twiddle<inverse>(t2 - t3, w2);
+                }
+            }
+        }
 
-        /* Radix-4 iteration subroutine */
-        template <typename T>
-        void R4TX(int nthpo, std::complex<T> *c0, std::complex<T> *c1,
-            std::complex<T> *c2, std::complex<T> *c3)
+        template <bool inverse, typename T>
+        void fft_radix4_pass (
+            const long m,
+            const long s,
+            const std::complex<T>* w,
+            const std::complex<T>* x,
+            std::complex<T>* y
+        )
         {
-            for(int k=0;k<nthpo;k+=4) 
+            for (long p = 0; p < m; ++p)
             {
-                std::complex<T> t1, t2, t3, t4;
-                t1 = c0[k] + c2[k];
-                t2 = c0[k] - c2[k];
-                t3 = c1[k] + c3[k];
-                t4 = c1[k] - c3[k];
-
-                c0[k] = t1 + t3;
-                c1[k] = t1 - t3;
-                c2[k] = std::complex<T>(t2.real()-t4.imag(), t2.imag()+t4.real());
-                c3[k] = std::complex<T>(t2.real()+t4.imag(), t2.imag()-t4.real());
+                const std::complex<T> w1 = w[3*p], w2 = w[3*p+1], w3 = w[3*p+2];
+                const std::complex<T>* x0 = x + s*p;
+                const std::complex<T>* x1 = x0 + s*m;
+                const std::complex<T>* x2 = x1 + s*m;
+                const std::complex<T>* x3 = x2 + s*m;
+                std::complex<T>* y0 = y + 4*s*p;
+                std::complex<T>* y1 = y0 + s;
+                std::complex<T>* y2 = y1 + s;
+                std::complex<T>* y3 = y2 + s;
+                for (long q = 0; q < s; ++q)
+                {
+                    const std::complex<T> a0 = x0[q], a1 = x1[q], a2 = x2[q], a3 = x3[q];
+                    const std::complex<T> t0 = a0 + a2;
+                    const std::complex<T> t1 = a0 - a2;
+                    const std::complex<T> t2 = a1 + a3;
+                    const std::complex<T> t3 = fft_rotate<inverse>(a1 - a3);
+                    y0[q] = t0 + t2;
+                    y1[q] = fft_twiddle<inverse>(t1 + t3, w1);
+                    y2[q] = fft_twiddle<inverse>(t0 - t2, w2);
+                    y3[q] = fft_twiddle<inverse>(t1 - t3, w3);
+                }
+            }
+        }
+
+        template <bool inverse, typename T>
+        void fft_radix5_pass (
+            const long m,
+            const long s,
+            const std::complex<T>* w,
+            const std::complex<T>* x,
+            std::complex<T>* y
+        )
+        {
+            const std::complex<T> r1 = fft_root_of_unity<T>(1,5);
+            const std::complex<T> r2 = fft_root_of_unity<T>(2,5);
+            const T c1 = r1.real(), s1 = -r1.imag();
+            const T c2 = r2.real(), s2 = -r2.imag();
+            for (long p = 0; p < m; ++p)
+            {
+                const std::complex<T> w1 = w[4*p], w2 = w[4*p+1], w3 = w[4*p+2], w4 = w[4*p+3];
+                const std::complex<T>* x0 = x + s*p;
+                const std::complex<T>* x1 = x0 + s*m;
+                const std::complex<T>* x2 = x1 + s*m;
+                const std::complex<T>* x3 = x2 + s*m;
+                const std::complex<T>* x4 = x3 + s*m;
+                std::complex<T>* y0 = y + 5*s*p;
+                std::complex<T>* y1 = y0 + s;
+                std::complex<T>* y2 = y1 + s;
+                std::complex<T>* y3 = y2 + s;
+                std::complex<T>* y4 = y3 + s;
+                for (long q = 0; q < s; ++q)
+                {
+                    const std::complex<T> a0 = x0[q], a1 = x1[q], a2 = x2[q], a3 = x3[q], a4 = x4[q];
+                    const std::complex<T> t1 = a1 + a4;
+                    const std::complex<T> t2 = a2 + a3;
+                    const std::complex<T> t3 = a1 - a4;
+                    const std::complex<T> t4 = a2 - a3;
+                    const std::complex<T> u1 = a0 + t1*c1 + t2*c2;
+                    const std::complex<T> u2 = a0 + t1*c2 + t2*c1;
+                    const std::complex<T> v1 = fft_rotate<inverse>(t3*s1 + t4*s2);
+                    const std::complex<T> v2 = fft_rotate<inverse>(t3*s2 - t4*s1);
+                    y0[q] = a0 + t1 + t2;
+                    y1[q] = fft_twiddle<inverse>(u1 + v1, w1);
+                    y2[q] = fft_twiddle<inverse>(u2 + v2, w2);
+                    y3[q] = fft_twiddle<inverse>(u2 - v2, w3);
+                    y4[q] = fft_twiddle<inverse>(u1 - v1, w4);
+                }
+            }
+        }
+
+        template <bool inverse, typename T>
+        void fft_generic_pass (
+            const long r,
+            const long m,
+            const long s,
+            const std::complex<T>* w,
+            const std::complex<T>* roots,
+            const std::complex<T>* x,
+            std::complex<T>* y
+        )
+        /*!
+            requires
+                - r <= fft_max_generic_radix
+                - roots[k] == W(k,r) for the forward transform, for all k < r.
+        !*/
+        {
+            std::complex<T> a[fft_max_generic_radix];
+            for (long p = 0; p < m; ++p)
+            {
+                for (long q = 0; q < s; ++q)
+                {
+                    for (long j = 0; j < r; ++j)
+                        a[j] = x[q + s*(p+j*m)];
+
+                    for (long k = 0; k < r; ++k)
+                    {
+                        std::complex<T> sum = a[0];
+                        long idx = 0;
+                        for (long j = 1; j < r; ++j)
+                        {
+                            idx += k;
+                            if (idx >= r)
+                                idx -= r;
+                            sum += fft_twiddle<inverse>(a[j], roots[idx]);
+                        }
+                        if (k != 0)
+                            sum = fft_twiddle<inverse>(sum, w[p*(r-1)+k-1]);
+                        y[q + s*(r*p+k)] = sum;
+                    }
+                }
             }
         }
 
     // ------------------------------------------------------------------------------------
 
         template <typename T>
-        class twiddles
+        class fft_plan
         {
             /*!
-                The point of this object is to cache the twiddle values so we don't
-                recompute them over and over inside R8TX().
+                WHAT THIS OBJECT REPRESENTS
+                    This object holds everything needed to compute FFTs of one particular
+                    length.  That's the factorization of the length into radices along
+                    with the twiddle factors of each pass, or for lengths with large prime
+                    factors, the chirp and the transformed filter used by Bluestein's
+                    algorithm.  Making a plan costs about as much as a few transforms, so
+                    they are cached by get_fft_plan().  Since a plan is never modified once
+                    made, any number of threads can use the same plan at once.
             !*/
+
         public:
 
-            twiddles()
+            explicit fft_plan (
+                long n_
+            ) : n(n_)
+            {
+                std::vector<long> radices;
+                long len = n;
+                while (len%4 == 0)
+                {
+                    radices.push_back(4);
+                    len /= 4;
+                }
+                if (len%2 == 0)
+                {
+                    radices.push_back(2);
+                    len /= 2;
+                }
+                for (long f = 3; f*f <= len; f += 2)
+                {
+                    while (len%f == 0)
+                    {
+                        radices.push_back(f);
+                        len /= f;
+                    }
+                }
+                if (len > 1)
+                    radices.push_back(len);
+
+                if (radices.size() != 0 && *std::max_element(radices.begin(), radices.end()) > fft_max_generic_radix)
+                    setup_bluestein();
+                else
+                    setup_passes(radices);
+
+                // The twiddle factors needed to turn a transform of this length into
+                // one of 2*n real numbers.
+                half_tw.resize(n+1);
+                for (long k = 0; k <= n; ++k)
+                    half_tw[k] = fft_root_of_unity<T>(k, 2*n);
+            }
+
+            long size (
+            ) const { return n; }
+
+            long work_size (
+                long batch
+            ) const
+            /*!
+                ensures
+                    - returns the number of elements the work buffer given to execute()
+                      must have when transforming batch vectors at once.
+            !*/
             {
-                data.resize(64);
+                if (conv_plan)
+                    return 2*conv_plan->size();
+                return n*batch;
             }
-            
-            const std::complex<T>* get_twiddles (
-                int p 
-            ) 
+
+            const std::complex<T>* half_twiddles (
+            ) const { return &half_tw[0]; }
+            /*!
+                ensures
+                    - returns a pointer P such that P[k] == exp(-2*pi*i*k/(2*size())), for
+                      all 0 <= k <= size().
+            !*/
+
+            void execute (
+                std::complex<T>* data,
+                std::complex<T>* work,
+                long batch,
+                bool inverse
+            ) const
             /*!
                 requires
-                    - 0 <= p <= 64
+                    - batch > 0
+                    - data points to size()*batch elements which hold batch interleaved
+                      vectors.  That is, data[j*batch+b] is the j-th element of the b-th
+                      vector.
+                    - work points to work_size(batch) elements that don't overlap data.
                 ensures
-                    - returns a pointer to the twiddle factors needed by R8TX if nxtlt == 2^p
+                    - replaces each of the batch vectors in data with its FFT, or with its
+                      unscaled inverse FFT if inverse == true.
             !*/
             {
-                // Compute the twiddle factors for this p value if we haven't done so
-                // already.
-                if (data[p].size() == 0)
+                if (conv_plan)
                 {
-                    const int nxtlt = 0x1 << p;
-                    data[p].reserve(nxtlt*7);
-                    const T twopi = 6.2831853071795865; /* 2.0 * pi */
-                    const T scale = twopi/(nxtlt*8.0);
-                    std::complex<T> cs[7];
-                    for (int j = 0; j < nxtlt; ++j)
-                    {
-                        const T arg = j*scale;
-                        cs[0] = std::complex<T>(std::cos(arg),std::sin(arg));
-                        cs[1] = cs[0]*cs[0];
-                        cs[2] = cs[1]*cs[0];
-                        cs[3] = cs[1]*cs[1];
-                        cs[4] = cs[2]*cs[1];
-                        cs[5] = cs[2]*cs[2];
-                        cs[6] = cs[3]*cs[2];
-                        data[p].insert(data[p].end(), cs, cs+7);
-                    }
+                    if (inverse)
+                        bluestein<true>(data, work, batch);
+                    else
+                        bluestein<false>(data, work, batch);
+                }
+                else
+                {
+                    if (inverse)
+                        run_passes<true>(data, work, batch);
+                    else
+                        run_passes<false>(data, work, batch);
                 }
-
-                return &data[p][0];
             }
 
         private:
-            std::vector<std::vector<std::complex<T> > > data;
-        };
 
-    // ----------------------------------------------------------------------------------------
+            struct pass
+            {
+                long radix;
+                long twiddles; // offset of this pass's twiddle factors in tw
+                long roots;    // offset of the roots of unity used by fft_generic_pass()
+            };
+
+            void setup_passes (
+                const std::vector<long>& radices
+            )
+            {
+                long len = n;
+                for (auto r : radices)
+                {
+                    const long m = len/r;
+                    pass p;
+                    p.radix = r;
+                    p.twiddles = tw.size();
+                    for (long i = 0; i < m; ++i)
+                    {
+                        for (long k = 1; k < r; ++k)
+                            tw.push_back(fft_root_of_unity<T>(i*k, len));
+                    }
+                    p.roots = tw.size();
+                    if (r > 5)
+                    {
+                        for (long k = 0; k < r; ++k)
+                            tw.push_back(fft_root_of_unity<T>(k, r));
+                    }
+                    passes.push_back(p);
+                    len = m;
+                }
+            }
 
-        /* Radix-8 iteration subroutine */
-        template <typename T>
-        void R8TX(int nxtlt, int nthpo, int length, const std::complex<T>* cs,
-            std::complex<T> *cc0, std::complex<T> *cc1, std::complex<T> *cc2, std::complex<T> *cc3,
-            std::complex<T> *cc4, std::complex<T> *cc5, std::complex<T> *cc6, std::complex<T> *cc7)
-        {
-            const T irt2 = 0.707106781186548;  /* 1.0/sqrt(2.0) */
+            void setup_bluestein (
+            )
+            {
+                // We use the identity j*k == (j*j + k*k - (k-j)*(k-j))/2 to write the
+                // transform as a convolution with the chirp exp(-pi*i*j*j/n).  That
+                // convolution is done with FFTs of a length that we can transform quickly.
+                const long m = fft_fast_size(2*n-1);
+                conv_plan = std::make_shared<const fft_plan<T> >(m);
+
+                chirp.resize(n);
+                for (long long k = 0; k < n; ++k)
+                    chirp[k] = fft_root_of_unity<T>(k*k%(2*n), 2*n);
+
+                std::vector<std::complex<T> > work(conv_plan->work_size(1));
+                filter.assign(m, std::complex<T>(0));
+                filter[0] = std::conj(chirp[0]);
+                for (long k = 1; k < n; ++k)
+                    filter[k] = filter[m-k] = std::conj(chirp[k]);
+                conv_plan->execute(&filter[0], &work[0], 1, false);
+                // Fold the scaling of the inverse transform into the filter.
+                for (auto& f : filter)
+                    f /= static_cast<T>(m);
+            }
 
-            for(int j=0; j<nxtlt; j++) 
+            template <bool inverse>
+            void run_passes (
+                std::complex<T>* data,
+                std::complex<T>* work,
+                long batch
+            ) const
             {
-                for(int k=j;k<nthpo;k+=length) 
+                std::complex<T>* x = data;
+                std::complex<T>* y = work;
+                long s = batch;
+                long len = n;
+                for (auto& p : passes)
                 {
-                    std::complex<T> a0, a1, a2, a3, a4, a5, a6, a7;
-                    std::complex<T> b0, b1, b2, b3, b4, b5, b6, b7;
-                    a0 = cc0[k] + cc4[k];
-                    a1 = cc1[k] + cc5[k];
-                    a2 = cc2[k] + cc6[k];
-                    a3 = cc3[k] + cc7[k];
-                    a4 = cc0[k] - cc4[k];
-                    a5 = cc1[k] - cc5[k];
-                    a6 = cc2[k] - cc6[k];
-                    a7 = cc3[k] - cc7[k];
-
-                    b0 = a0 + a2;
-                    b1 = a1 + a3;
-                    b2 = a0 - a2;
-                    b3 = a1 - a3;
-
-                    b4 = std::complex<T>(a4.real()-a6.imag(), a4.imag()+a6.real());
-                    b5 = std::complex<T>(a5.real()-a7.imag(), a5.imag()+a7.real());
-                    b6 = std::complex<T>(a4.real()+a6.imag(), a4.imag()-a6.real());
-                    b7 = std::complex<T>(a5.real()+a7.imag(), a5.imag()-a7.real());
-
-                    const std::complex<T> tmp0(-b3.imag(), b3.real());
-                    const std::complex<T> tmp1(irt2*(b5.real()-b5.imag()), irt2*(b5.real()+b5.imag()));
-                    const std::complex<T> tmp2(-irt2*(b7.real()+b7.imag()), irt2*(b7.real()-b7.imag()));
-
-                    cc0[k] = b0 + b1;
-                    cc1[k] = b0 - b1;
-                    cc2[k] = b2 + tmp0;
-                    cc3[k] = b2 - tmp0;
-                    cc4[k] = b4 + tmp1;
-                    cc5[k] = b4 - tmp1;
-                    cc6[k] = b6 + tmp2;
-                    cc7[k] = b6 - tmp2;
-                    if(j>0) 
+                    const long m = len/p.radix;
+                    const std::complex<T>* w = &tw[p.twiddles];
+                    switch (p.radix)
                     {
-                        cc1[k] *= cs[3];
-                        cc2[k] *= cs[1];
-                        cc3[k] *= cs[5];
-                        cc4[k] *= cs[0];
-                        cc5[k] *= cs[4];
-                        cc6[k] *= cs[2];
-                        cc7[k] *= cs[6];
+                        case 2: fft_radix2_pass<inverse>(m, s, w, x, y); break;
+                        case 3: fft_radix3_pass<inverse>(m, s, w, x, y); break;
+                        case 4: fft_radix4_pass<inverse>(m, s, w, x, y); break;
+                        case 5: fft_radix5_pass<inverse>(m, s, w, x, y); break;
+                        default: fft_generic_pass<inverse>(p.radix, m, s, w, &tw[p.roots], x, y); break;
                     }
+                    std::swap(x,y);
+                    s *= p.radix;
+                    len = m;
                 }
 
-                cs += 7;
+                if (x != data)
+                    std::copy(x, x+n*batch, data);
             }
-        }
+
+            template <bool inverse>
+            void bluestein (
+                std::complex<T>* data,
+                std::complex<T>* work,
+                long batch
+            ) const
+            {
+                // The inverse transform is done as conj(fft(conj(data))).
+                const long m = conv_plan->size();
+                std::complex<T>* buf = work;
+                std::complex<T>* conv_work = work + m;
+                for (long b = 0; b < batch; ++b)
+                {
+                    for (long j = 0; j < n; ++j)
+                    {
+                        const std::complex<T> v = data[j*batch+b];
+                        buf[j] = fft_twiddle<false>(inverse ? std::conj(v) : v, chirp[j]);
+                    }
+                    std::fill(buf+n, buf+m, std::complex<T>(0));
+
+                    conv_plan->execute(buf, conv_work, 1, false);
+                    for (long k = 0; k < m; ++k)
+                        buf[k] = fft_twiddle<false>(buf[k], filter[k]);
+                    conv_plan->execute(buf, conv_work, 1, true);
+
+                    for (long k = 0; k < n; ++k)
+                    {
+                        const std::complex<T> v = fft_twiddle<false>(buf[k], chirp[k]);
+                        data[k*batch+b] = inverse ? std::conj(v) : v;
+                    }
+                }
+            }
+
+            long n;
+            std::vector<pass> passes;
+            std::vector<std::complex<T> > tw;
+            std::vector<std::complex<T> > half_tw;
+
+            std::shared_ptr<const fft_plan<T> > conv_plan;
+            std::vector<std::complex<T> > chirp;
+            std::vector<std::complex<T> > filter;
+        };
 
     // ------------------------------------------------------------------------------------
 
-        template <typename T, long NR, long NC, typename MM, typename layout>
-        void fft1d_inplace(matrix<std::complex<T>,NR,NC,MM,layout>& data, bool do_backward_fft, twiddles<T>& cs)
+        template <typename T>
+        std::shared_ptr<const fft_plan<T> > get_fft_plan (
+            long n
+        )
         /*!
-            requires
-                - is_vector(data) == true
-                - is_power_of_two(data.size()) == true
             ensures
-                - This routine replaces the input std::complex<double> vector by its finite
-                  discrete complex fourier transform if do_backward_fft==true.  It replaces
-                  the input std::complex<double> vector by its finite discrete complex
-                  inverse fourier transform if do_backward_fft==false.
-
-                  The implementation is a radix-2 FFT, but with faster shortcuts for
-                  radix-4 and radix-8. It performs as many radix-8 iterations as possible,
-                  and then finishes with a radix-2 or -4 iteration if needed.
+                - returns a plan for FFTs of length n.  Plans are cached since programs
+                  usually transform the same few sizes over and over.  This function is
+                  threadsafe.
         !*/
         {
-            COMPILE_TIME_ASSERT((is_same_type<double,T>::value || is_same_type<float,T>::value || is_same_type<long double,T>::value ));
+            const size_t max_cached_plans = 32;
+            static std::mutex m;
+            static std::map<long, std::shared_ptr<const fft_plan<T> > > plans;
 
-            if (data.size() == 0)
-                return;
-
-            std::complex<T>* const b = &data(0);
-            int L[16],L1,L2,L3,L4,L5,L6,L7,L8,L9,L10,L11,L12,L13,L14,L15;
-            int j1,j2,j3,j4,j5,j6,j7,j8,j9,j10,j11,j12,j13,j14;
-            int j, ij, ji;
-            int n2pow, n8pow, nthpo, ipass, nxtlt, length;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                auto i = plans.find(n);
+                if (i != plans.end())
+                    return i->second;
+            }
 
-            n2pow = fastlog2(data.size());
-            nthpo = data.size();
+            // Make the plan without holding the lock since that's the slow part.
+            auto plan = std::make_shared<const fft_plan<T> >(n);
+            std::lock_guard<std::mutex> lock(m);
+            if (plans.size() >= max_cached_plans)
+                plans.clear();
+            plans[n] = plan;
+            return plan;
+        }
 
-            n8pow = n2pow/3;
+    // ------------------------------------------------------------------------------------
 
-            if(n8pow)
-            {
-                /* Radix 8 iterations */
-                for(ipass=1;ipass<=n8pow;ipass++) 
-                {
-                    const int p = n2pow - 3*ipass;
-                    nxtlt = 0x1 << p;
-                    length = 8*nxtlt;
-                    R8TX(nxtlt, nthpo, length, cs.get_twiddles(p),
-                        b, b+nxtlt, b+2*nxtlt, b+3*nxtlt,
-                        b+4*nxtlt, b+5*nxtlt, b+6*nxtlt, b+7*nxtlt);
-                }
-            }
+        template <typename T>
+        void fft1d (
+            std::complex<T>* data,
+            long n,
+            bool inverse
+        )
+        {
+            if (n <= 1)
+                return;
+            auto plan = get_fft_plan<T>(n);
+            std::vector<std::complex<T> > work(plan->work_size(1));
+            plan->execute(data, &work[0], 1, inverse);
+        }
 
-            if(n2pow%3 == 1) 
+        template <typename T>
+        void fft_rows (
+            std::complex<T>* data,
+            long nr,
+            long nc,
+            bool inverse
+        )
+        /*!
+            requires
+                - data is an nr by nc row major matrix.
+            ensures
+                - replaces each row of data with its FFT.  The rows are split up between
+                  the threads in default_thread_pool() when there are enough of them.
+        !*/
+        {
+            auto plan = get_fft_plan<T>(nc);
+            blocked_la::parallel_for_blocked_if_worthwhile(0, nr, 4*nc, [&](long begin, long end)
             {
-                /* A final radix 2 iteration is needed */
-                R2TX(nthpo, b, b+1); 
-            }
+                std::vector<std::complex<T> > work(plan->work_size(1));
+                for (long r = begin; r < end; ++r)
+                    plan->execute(data + r*nc, &work[0], 1, inverse);
+            });
+        }
 
-            if(n2pow%3 == 2)  
+        template <typename T>
+        void fft_columns (
+            std::complex<T>* data,
+            long nr,
+            long nc,
+            long num_cols,
+            bool inverse
+        )
+        /*!
+            requires
+                - data is an nr by nc row major matrix.
+                - num_cols <= nc
+            ensures
+                - replaces each of the first num_cols columns of data with its FFT.
+                - The columns are copied, fft_column_block at a time, into a small buffer
+                  where they are transformed together.  That way every pass of the FFT
+                  runs over contiguous memory.  The blocks are split up between the
+                  threads in default_thread_pool() when there are enough of them.
+        !*/
+        {
+            auto plan = get_fft_plan<T>(nr);
+            const long num_blocks = (num_cols+fft_column_block-1)/fft_column_block;
+            blocked_la::parallel_for_blocked_if_worthwhile(0, num_blocks, 4*nr*fft_column_block, [&](long begin, long end)
             {
-                /* A final radix 4 iteration is needed */
-                R4TX(nthpo, b, b+1, b+2, b+3); 
-            }
+                std::vector<std::complex<T> > buf(nr*fft_column_block);
+                std::vector<std::complex<T> > work(plan->work_size(fft_column_block));
+                for (long i = begin; i < end; ++i)
+                {
+                    const long c = i*fft_column_block;
+                    const long width = std::min(fft_column_block, num_cols-c);
+                    for (long r = 0; r < nr; ++r)
+                        std::copy(data + r*nc + c, data + r*nc + c + width, &buf[r*width]);
+                    plan->execute(&buf[0], &work[0], width, inverse);
+                    for (long r = 0; r < nr; ++r)
+                        std::copy(&buf[r*width], &buf[r*width] + width, data + r*nc + c);
+                }
+            });
+        }
 
-            for(j=1;j<=15;j++) 
+        template <typename T>
+        void fft_contiguous (
+            std::complex<T>* data,
+            long nr,
+            long nc,
+            bool inverse
+        )
+        /*!
+            requires
+                - data is an nr by nc row major matrix.
+            ensures
+                - replaces data with its 1D FFT if it's a vector and its 2D FFT otherwise.
+        !*/
+        {
+            if (nr == 1 || nc == 1)
             {
-                L[j] = 1;
-                if(j-n2pow <= 0) L[j] = 0x1 << (n2pow + 1 - j);
+                fft1d(data, nr*nc, inverse);
             }
-
-            L15=L[1];L14=L[2];L13=L[3];L12=L[4];L11=L[5];L10=L[6];L9=L[7];
-            L8=L[8];L7=L[9];L6=L[10];L5=L[11];L4=L[12];L3=L[13];L2=L[14];L1=L[15];
-
-            ij = 0;
-
-            for(j1=0;j1<L1;j1++)
-                for(j2=j1;j2<L2;j2+=L1)
-                    for(j3=j2;j3<L3;j3+=L2)
-                        for(j4=j3;j4<L4;j4+=L3)
-                            for(j5=j4;j5<L5;j5+=L4)
-                                for(j6=j5;j6<L6;j6+=L5)
-                                    for(j7=j6;j7<L7;j7+=L6)
-                                        for(j8=j7;j8<L8;j8+=L7)
-                                            for(j9=j8;j9<L9;j9+=L8)
-                                                for(j10=j9;j10<L10;j10+=L9)
-                                                    for(j11=j10;j11<L11;j11+=L10)
-                                                        for(j12=j11;j12<L12;j12+=L11)
-                                                            for(j13=j12;j13<L13;j13+=L12)
-                                                                for(j14=j13;j14<L14;j14+=L13)
-                                                                    for(ji=j14;ji<L15;ji+=L14) 
-                                                                    {
-                                                                        if(ij<ji)
-                                                                            swap(b[ij], b[ji]);
-                                                                        ij++;
-                                                                    }
-
-
-            // unscramble outputs
-            if(!do_backward_fft) 
+            else
             {
-                for(long i=1, j=data.size()-1; i<data.size()/2; i++,j--)
-                {
-                    swap(b[j], b[i]);
-                }
+                fft_rows(data, nr, nc, inverse);
+                fft_columns(data, nr, nc, nc, inverse);
             }
         }
 
-    // ------------------------------------------------------------------------------------
+        inline void fft_contiguous (
+            std::complex<float>* data,
+            long nr,
+            long nc,
+            bool inverse
+        )
+        {
+            // Like dlib always has, we transform float data in double precision so the
+            // results are accurate to float precision.
+            std::vector<std::complex<double> > temp(data, data+nr*nc);
+            fft_contiguous(&temp[0], nr, nc, inverse);
+            for (long i = 0; i < nr*nc; ++i)
+                data[i] = std::complex<float>(temp[i]);
+        }
 
         template < typename T, long NR, long NC, typename MM, typename L >
-        void fft2d_inplace(
+        void fft_matrix_inplace (
             matrix<std::complex<T>,NR,NC,MM,L>& data,
-            bool do_backward_fft
+            bool inverse
         )
         {
+            COMPILE_TIME_ASSERT((is_same_type<double,T>::value || is_same_type<float,T>::value || is_same_type<long double,T>::value ));
+
             if (data.size() == 0)
                 return;
 
-            matrix<std::complex<double> > buff;
-            twiddles<double> cs;
+            // A column major matrix is laid out like the transpose of a row major one, and
+            // the 2D FFT of a transposed matrix is the transpose of its 2D FFT.
+            if (is_same_type<L,column_major_layout>::value)
+                fft_contiguous(&data(0,0), data.nc(), data.nr(), inverse);
+            else
+                fft_contiguous(&data(0,0), data.nr(), data.nc(), inverse);
+        }
 
-            // Compute transform row by row
-            for(long r=0; r<data.nr(); ++r) 
+    // ------------------------------------------------------------------------------------
+
+        template <typename T>
+        void real_fft1d (
+            const T* x,
+            long n,
+            std::complex<T>* out
+        )
+        {
+            if (n%2 != 0)
             {
-                buff = matrix_cast<std::complex<double> >(rowm(data,r));
-                fft1d_inplace(buff, do_backward_fft, cs);
-                set_rowm(data,r) = matrix_cast<std::complex<T> >(buff);
+                std::copy(x, x+n, out);
+                fft1d(out, n, false);
+                return;
             }
 
-            // Compute transform column by column
-            for(long c=0; c<data.nc(); ++c) 
+            // Put the even samples in the real part and the odd samples in the imaginary
+            // part of a signal half as long.  Since the transforms of real signals are
+            // conjugate symmetric we can separate the transforms of the even and odd
+            // samples afterwards and combine them into the full transform.
+            const long h = n/2;
+            for (long k = 0; k < h; ++k)
+                out[k] = std::complex<T>(x[2*k], x[2*k+1]);
+            auto plan = get_fft_plan<T>(h);
+            std::vector<std::complex<T> > work(plan->work_size(1));
+            plan->execute(out, &work[0], 1, false);
+
+            // Output k only depends on elements k and h-k of the half length transform,
+            // so we can do them in pairs and write the outputs over the transform.
+            const std::complex<T>* w = plan->half_twiddles();
+            const T half = 0.5;
+            const std::complex<T> z0 = out[0];
+            out[0] = z0.real() + z0.imag();
+            out[h] = z0.real() - z0.imag();
+            for (long k = 1, j = h-1; k <= j; ++k, --j)
             {
-                buff = matrix_cast<std::complex<double> >(colm(data,c));
-                fft1d_inplace(buff, do_backward_fft, cs);
-                set_colm(data,c) = matrix_cast<std::complex<T> >(buff);
+                const std::complex<T> a = out[k], b = out[j];
+                const std::complex<T> xk = (a + std::conj(b))*half + fft_twiddle<false>(fft_rotate<false>(a - std::conj(b))*half, w[k]);
+                const std::complex<T> xj = (b + std::conj(a))*half + fft_twiddle<false>(fft_rotate<false>(b - std::conj(a))*half, w[j]);
+                out[k] = xk;
+                out[j] = xj;
+                out[n-k] = std::conj(xk);
+                out[n-j] = std::conj(xj);
             }
         }
-        
-    // ----------------------------------------------------------------------------------------
-
-        template <
-            typename EXP, 
-            typename T
-            >
-        void fft2d(
-            const matrix_exp<EXP>& data, 
-            matrix<std::complex<T> >& data_out,
-            bool do_backward_fft
+
+        template <typename T>
+        void real_fft2d (
+            const T* x,
+            long nr,
+            long nc,
+            std::complex<T>* out
         )
         {
-            // make sure requires clause is not broken
-            DLIB_CASSERT(is_power_of_two(data.nr()) && is_power_of_two(data.nc()),
-                "\t matrix fft(data)"
-                << "\n\t The number of rows and columns must be powers of two."
-                << "\n\t data.nr(): "<< data.nr()
-                << "\n\t data.nc(): "<< data.nc()
-                << "\n\t is_power_of_two(data.nr()): " << is_power_of_two(data.nr())
-                << "\n\t is_power_of_two(data.nc()): " << is_power_of_two(data.nc())
-            );
+            // Transform the rows two at a time by putting one in the real part and the
+            // other in the imaginary part of a complex row.  Since the transforms of real
+            // rows are conjugate symmetric the two can be separated afterwards.
+            auto plan = get_fft_plan<T>(nc);
+            const T half = 0.5;
+            blocked_la::parallel_for_blocked_if_worthwhile(0, (nr+1)/2, 8*nc, [&](long begin, long end)
+            {
+                std::vector<std::complex<T> > work(plan->work_size(1));
+                for (long i = begin; i < end; ++i)
+                {
+                    const T* x0 = x + 2*i*nc;
+                    std::complex<T>* out0 = out + 2*i*nc;
+                    if (2*i+1 == nr)
+                    {
+                        std::copy(x0, x0+nc, out0);
+                        plan->execute(out0, &work[0], 1, false);
+                        continue;
+                    }
 
-            if (data.size() == 0)
-                return;
+                    const T* x1 = x0 + nc;
+                    std::complex<T>* out1 = out0 + nc;
+                    for (long c = 0; c < nc; ++c)
+                        out0[c] = std::complex<T>(x0[c], x1[c]);
+                    plan->execute(out0, &work[0], 1, false);
 
-            matrix<std::complex<double> > buff;
-            data_out.set_size(data.nr(), data.nc());
-            twiddles<double> cs;
+                    out1[0] = out0[0].imag();
+                    out0[0] = out0[0].real();
+                    for (long k = 1, j = nc-1; k <= j; ++k, --j)
+                    {
+                        const std::complex<T> a = out0[k], b = out0[j];
+                        out0[k] = (a + std::conj(b))*half;
+                        out0[j] = (b + std::conj(a))*half;
+                        out1[k] = fft_rotate<false>(a - std::conj(b))*half;
+                        out1[j] = fft_rotate<false>(b - std::conj(a))*half;
+                    }
+                }
+            });
 
-            // Compute transform row by row
-            for(long r=0; r<data.nr(); ++r) 
+            // The 2D transform is also conjugate symmetric, i.e. F(r,c) == conj(F(-r,-c)),
+            // so we only need to transform the left half of the columns.
+            const long num_cols = nc/2+1;
+            fft_columns(out, nr, nc, num_cols, false);
+            for (long r = 0; r < nr; ++r)
             {
-                buff = matrix_cast<std::complex<double> >(rowm(data,r));
-                fft1d_inplace(buff, do_backward_fft, cs);
-                set_rowm(data_out,r) = matrix_cast<std::complex<T> >(buff);
+                const std::complex<T>* mirror = out + ((nr-r)%nr)*nc;
+                for (long c = num_cols; c < nc; ++c)
+                    out[r*nc+c] = std::conj(mirror[nc-c]);
             }
+        }
 
-            // Compute transform column by column
-            for(long c=0; c<data_out.nc(); ++c) 
-            {
-                buff = matrix_cast<std::complex<double> >(colm(data_out,c));
-                fft1d_inplace(buff, do_backward_fft, cs);
-                set_colm(data_out,c) = matrix_cast<std::complex<T> >(buff);
-            }
+        template <typename T>
+        void real_fft (
+            const matrix<T>& data,
+            matrix<std::complex<T> >& out
+        )
+        {
+            COMPILE_TIME_ASSERT((is_same_type<double,T>::value || is_same_type<long double,T>::value ));
+
+            out.set_size(data.nr(), data.nc());
+            if (data.size() == 0)
+                return;
+
+            if (data.nr() == 1 || data.nc() == 1)
+                real_fft1d(&data(0,0), data.size(), &out(0,0));
+            else
+                real_fft2d(&data(0,0), data.nr(), data.nc(), &out(0,0));
         }
-        
+
+        inline void real_fft (
+            const matrix<float>& data,
+            matrix<std::complex<float> >& out
+        )
+        {
+            const matrix<double> temp = matrix_cast<double>(data);
+            matrix<std::complex<double> > temp_out;
+            real_fft(temp, temp_out);
+            out = matrix_cast<std::complex<float> >(temp_out);
+        }
+
     // ------------------------------------------------------------------------------------
 
     } // end namespace impl
@@ -407,33 +903,24 @@ namespace dlib
 // ----------------------------------------------------------------------------------------
 
     template <typename EXP>
-    matrix<typename EXP::type> fft (const matrix_exp<EXP>& data)
+    typename enable_if<is_complex<typename EXP::type>,matrix<typename EXP::type> >::type fft (
+        const matrix_exp<EXP>& data
+    )
     {
-        // You have to give a complex matrix
-        COMPILE_TIME_ASSERT(is_complex<typename EXP::type>::value);
-        // make sure requires clause is not broken
-        DLIB_CASSERT(is_power_of_two(data.nr()) && is_power_of_two(data.nc()),
-            "\t matrix fft(data)"
-            << "\n\t The number of rows and columns must be powers of two."
-            << "\n\t data.nr(): "<< data.nr()
-            << "\n\t data.nc(): "<< data.nc()
-            << "\n\t is_power_of_two(data.nr()): " << is_power_of_two(data.nr())
-            << "\n\t is_power_of_two(data.nc()): " << is_power_of_two(data.nc())
-            );
+        matrix<typename EXP::type> temp(data);
+        impl::fft_matrix_inplace(temp, false);
+        return temp;
+    }
 
-        if (data.nr() == 1 || data.nc() == 1)
-        {
-            matrix<typename EXP::type> temp(data);
-            impl::twiddles<typename EXP::type::value_type> cs;
-            impl::fft1d_inplace(temp, false, cs);
-            return temp;
-        }
-        else
-        {
-            matrix<typename EXP::type> temp;
-            impl::fft2d(data, temp, false);
-            return temp;
-        }
+    template <typename EXP>
+    typename disable_if<is_complex<typename EXP::type>,matrix<std::complex<typename EXP::type> > >::type fft (
+        const matrix_exp<EXP>& data
+    )
+    {
+        const matrix<typename EXP::type> temp(data);
+        matrix<std::complex<typename EXP::type> > out;
+        impl::real_fft(temp, out);
+        return out;
     }
 
     template <typename EXP>
@@ -441,30 +928,12 @@ namespace dlib
     {
         // You have to give a complex matrix
         COMPILE_TIME_ASSERT(is_complex<typename EXP::type>::value);
-        // make sure requires clause is not broken
-        DLIB_CASSERT(is_power_of_two(data.nr()) && is_power_of_two(data.nc()),
-            "\t matrix ifft(data)"
-            << "\n\t The number of rows and columns must be powers of two."
-            << "\n\t data.nr(): "<< data.nr()
-            << "\n\t data.nc(): "<< data.nc()
-            << "\n\t is_power_of_two(data.nr()): " << is_power_of_two(data.nr())
-            << "\n\t is_power_of_two(data.nc()): " << is_power_of_two(data.nc())
-            );
 
-        matrix<typename EXP::type> temp;
-        if (data.size() == 0)
+        matrix<typename EXP::type> temp(data);
+        if (temp.size() == 0)
             return temp;
 
-        if (data.nr() == 1 || data.nc() == 1)
-        {
-            temp = data;
-            impl::twiddles<typename EXP::type::value_type> cs;
-            impl::fft1d_inplace(temp, true, cs);
-        }
-        else
-        {
-            impl::fft2d(data, temp, true);
-        }
+        impl::fft_matrix_inplace(temp, true);
         temp /= data.size();
         return temp;
     }
@@ -472,75 +941,17 @@ namespace dlib
 // ----------------------------------------------------------------------------------------
 
     template < typename T, long NR, long NC, typename MM, typename L >
-    typename enable_if_c<NR==1||NC==1>::type fft_inplace (matrix<std::complex<T>,NR,NC,MM,L>& data)
+    void fft_inplace (matrix<std::complex<T>,NR,NC,MM,L>& data)
     // Note that we don't divide the outputs by data.size() so this isn't quite the inverse.
     {
-        // make sure requires clause is not broken
-        DLIB_CASSERT(is_power_of_two(data.nr()) && is_power_of_two(data.nc()),
-            "\t void fft_inplace(data)"
-            << "\n\t The number of rows and columns must be powers of two."
-            << "\n\t data.nr(): "<< data.nr()
-            << "\n\t data.nc(): "<< data.nc()
-            << "\n\t is_power_of_two(data.nr()): " << is_power_of_two(data.nr())
-            << "\n\t is_power_of_two(data.nc()): " << is_power_of_two(data.nc())
-            );
-
-        impl::twiddles<T> cs;
-        impl::fft1d_inplace(data, false, cs);
+        impl::fft_matrix_inplace(data, false);
     }
 
     template < typename T, long NR, long NC, typename MM, typename L >
-    typename disable_if_c<NR==1||NC==1>::type fft_inplace (matrix<std::complex<T>,NR,NC,MM,L>& data)
-    // Note that we don't divide the outputs by data.size() so this isn't quite the inverse.
+    void ifft_inplace (matrix<std::complex<T>,NR,NC,MM,L>& data)
     {
-        // make sure requires clause is not broken
-        DLIB_CASSERT(is_power_of_two(data.nr()) && is_power_of_two(data.nc()),
-            "\t void fft_inplace(data)"
-            << "\n\t The number of rows and columns must be powers of two."
-            << "\n\t data.nr(): "<< data.nr()
-            << "\n\t data.nc(): "<< data.nc()
-            << "\n\t is_power_of_two(data.nr()): " << is_power_of_two(data.nr())
-            << "\n\t is_power_of_two(data.nc()): " << is_power_of_two(data.nc())
-            );
-
-        impl::fft2d_inplace(data, false);
+        impl::fft_matrix_inplace(data, true);
     }
-
-// ----------------------------------------------------------------------------------------
-
-    template < typename T, long NR, long NC, typename MM, typename L >
-    typename enable_if_c<NR==1||NC==1>::type ifft_inplace (matrix<std::complex<T>,NR,NC,MM,L>& data)
-    {
-        // make sure requires clause is not broken
-        DLIB_CASSERT(is_power_of_two(data.nr()) && is_power_of_two(data.nc()),
-            "\t void ifft_inplace(data)"
-            << "\n\t The number of rows and columns must be powers of two."
-            << "\n\t data.nr(): "<< data.nr()
-            << "\n\t data.nc(): "<< data.nc()
-            << "\n\t is_power_of_two(data.nr()): " << is_power_of_two(data.nr())
-            << "\n\t is_power_of_two(data.nc()): " << is_power_of_two(data.nc())
-            );
-
-        impl::twiddles<T> cs;
-        impl::fft1d_inplace(data, true, cs);
-    }
-
-    template < typename T, long NR, long NC, typename MM, typename L >
-    typename disable_if_c<NR==1||NC==1>::type ifft_inplace (matrix<std::complex<T>,NR,NC,MM,L>& data)
-    {
-        // make sure requires clause is not broken
-        DLIB_CASSERT(is_power_of_two(data.nr()) && is_power_of_two(data.nc()),
-            "\t void ifft_inplace(data)"
-            << "\n\t The number of rows and columns must be powers of two."
-            << "\n\t data.nr(): "<< data.nr()
-            << "\n\t data.nc(): "<< data.nc()
-            << "\n\t is_power_of_two(data.nr()): " << is_power_of_two(data.nr())
-            << "\n\t is_power_of_two(data.nc()): " << is_power_of_two(data.nc())
-            );
-
-        impl::fft2d_inplace(data, true);
-    }
-
 // ----------------------------------------------------------------------------------------
 
     /*
@@ -653,16 +1064,6 @@ namespace dlib
         const matrix<std::complex<double>,NR,NC,MM,L>& data,
         bool do_backward_fft)
     {
-        // make sure requires clause is not broken
-        DLIB_CASSERT(is_power_of_two(data.nr()) && is_power_of_two(data.nc()),
-            "\t matrix fft(data)"
-            << "\n\t The number of rows and columns must be powers of two."
-            << "\n\t data.nr(): "<< data.nr()
-            << "\n\t data.nc(): "<< data.nc()
-            << "\n\t is_power_of_two(data.nr()): " << is_power_of_two(data.nr())
-            << "\n\t is_power_of_two(data.nc()): " << is_power_of_two(data.nc())
-            );
-
         if (data.size() == 0)
             return data;
 
@@ -724,16 +1125,6 @@ namespace dlib
         bool do_backward_fft
     )
     {
-        // make sure requires clause is not broken
-        DLIB_CASSERT(is_power_of_two(data.nr()) && is_power_of_two(data.nc()),
-            "\t void ifft_inplace(data)"
-            << "\n\t The number of rows and columns must be powers of two."
-            << "\n\t data.nr(): "<< data.nr()
-            << "\n\t data.nc(): "<< data.nc()
-            << "\n\t is_power_of_two(data.nr()): " << is_power_of_two(data.nr())
-            << "\n\t is_power_of_two(data.nc()): " << is_power_of_two(data.nc())
-            );
-
         if (data.size() == 0)
             return;
 
@@ -29,8 +29,6 @@ namespace dlib
     /*!
         requires
             - data contains elements of type std::complex<> that itself contains double, float, or long double.
-            - is_power_of_two(data.nr()) == true
-            - is_power_of_two(data.nc()) == true
         ensures
             - Computes the 1 or 2 dimensional discrete Fourier transform of the given data
               matrix and returns it.  In particular, we return a matrix D such that:
@@ -40,6 +38,32 @@ namespace dlib
                 - starting with D(0,0), D contains progressively higher frequency components
                   of the input data.
                 - ifft(D) == D
+            - The outputs are the same as those given by FFTW.  So the forward transform
+              uses exp(-2*pi*i*j*k/N) and isn't scaled.
+            - data can have any number of rows and columns, not just powers of two.  The
+              transform is fastest when they only have small prime factors (e.g. 2, 3,
+              and 5).  Other sizes are done with Bluestein's algorithm, which is about 4
+              to 8 times slower than a nearby size with small factors but still takes only
+              O(N*log(N)) time.
+            - The rows and columns of large 2D transforms are transformed in parallel
+              using the threads in default_thread_pool().
+            - The setup needed for each transform length is cached, so repeated transforms
+              of the same size are faster than the first one.
+    !*/
+
+    template <typename EXP>
+    matrix<std::complex<typename EXP::type> > fft (
+        const matrix_exp<EXP>& data
+    );  
+    /*!
+        requires
+            - data contains real numbers, that is, elements of type double, float, or
+              long double.
+        ensures
+            - returns fft(complex_matrix(data)).  However, this version takes advantage
+              of the symmetry of the transform of real data, i.e. D(r,c) == conj(D(-r,-c)),
+              and does about half the work.  The exception is 1D transforms of odd
+              length, which cost the same as the complex version.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -51,8 +75,6 @@ namespace dlib
     /*!
         requires
             - data contains elements of type std::complex<> that itself contains double, float, or long double.
-            - is_power_of_two(data.nr()) == true
-            - is_power_of_two(data.nc()) == true
         ensures
             - Computes the 1 or 2 dimensional inverse discrete Fourier transform of the
               given data vector and returns it.  In particular, we return a matrix D such
@@ -77,8 +99,6 @@ namespace dlib
     /*!
         requires
             - data contains elements of type std::complex<> that itself contains double, float, or long double.
-            - is_power_of_two(data.nr()) == true
-            - is_power_of_two(data.nc()) == true
         ensures
             - This function is identical to fft() except that it does the FFT in-place.
               That is, after this function executes we will have:
@@ -100,8 +120,6 @@ namespace dlib
     /*!
         requires
             - data contains elements of type std::complex<> that itself contains double, float, or long double.
-            - is_power_of_two(data.nr()) == true
-            - is_power_of_two(data.nc()) == true
         ensures
             - This function is identical to ifft() except that it does the inverse FFT
               in-place.  That is, after this function executes we will have:
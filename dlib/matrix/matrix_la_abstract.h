@@ -416,7 +416,9 @@ namespace dlib
                 if A is very nearly singular).
 
                 If DLIB_USE_LAPACK is defined then the LAPACK routine xGETRF 
-                is used to compute the LU decomposition.
+                is used to compute the LU decomposition.  Otherwise, a blocked
+                algorithm is used which does most of its work in matrix multiplies
+                that are run in parallel using default_thread_pool().
         !*/
 
     public:
@@ -563,7 +565,9 @@ namespace dlib
                 the is_spd() flag.
             
                 If DLIB_USE_LAPACK is defined then the LAPACK routine xPOTRF 
-                is used to compute the cholesky decomposition.
+                is used to compute the cholesky decomposition.  Otherwise, a blocked
+                algorithm is used which does most of its work in matrix multiplies
+                that are run in parallel using default_thread_pool().
         !*/
 
     public:
@@ -665,7 +669,9 @@ namespace dlib
                 least squares solution of Ax=b using the QR factors.  
 
                 If DLIB_USE_LAPACK is #defined then the xGEQRF routine
-                from LAPACK is used to compute the QR decomposition.
+                from LAPACK is used to compute the QR decomposition.  Otherwise, a
+                blocked algorithm is used which does most of its work in matrix
+                multiplies that are run in parallel using default_thread_pool().
         !*/
 
     public:
@@ -811,7 +817,9 @@ namespace dlib
                       eigenvectors in V should be orthonormal. 
                         - So A == V*D*trans(V)
                     - If DLIB_USE_LAPACK is #defined then this object uses the xSYEVR LAPACK
-                      routine.
+                      routine.  Otherwise, big matrices are reduced to tridiagonal form
+                      with a blocked algorithm which, like the rest of the computation,
+                      runs in parallel using default_thread_pool().
 
                 On the other hand, if A is not symmetric then:
                     - Some of the eigenvalues and eigenvectors might be complex numbers.  
@@ -0,0 +1,231 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_MATRIx_LA_BLOCKED_H_
+#define DLIB_MATRIx_LA_BLOCKED_H_
+
+#include "matrix.h"
+#include "matrix_utilities.h"
+#include "matrix_subexp.h"
+#include "../threads/parallel_for_extension.h"
+#include <algorithm>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    namespace blocked_la
+    {
+        /*!
+            This namespace contains the pieces shared by the blocked versions of the QR,
+            LU, Cholesky and symmetric eigenvalue decompositions that are used when
+            LAPACK isn't available.  Each of those algorithms factors a narrow panel of
+            columns with the usual unblocked code and then applies the panel to the rest
+            of the matrix with a few big matrix multiplies.  That moves almost all the
+            floating point work into default_matrix_multiply(), which is much faster
+            than the dot products and rank 1 updates of the unblocked code, and splits
+            it across the threads in default_thread_pool().
+        !*/
+
+        // The number of columns in each panel.
+        const long block_size = 64;
+
+        // Loops that do less work than this run in the calling thread since handing
+        // them to the thread pool would cost more than it saves.
+        const long min_parallel_work = 1L<<16;
+
+    // ------------------------------------------------------------------------------------
+
+        template <
+            typename funct_type
+            >
+        void parallel_for_blocked_if_worthwhile (
+            long begin,
+            long end,
+            long work_per_index,
+            const funct_type& funct
+        )
+        /*!
+            ensures
+                - Calls funct(b,e) on a set of ranges [b,e) that together cover [begin,end),
+                  just like parallel_for_blocked(begin,end,funct).  However, if
+                  (end-begin)*work_per_index is small this just calls funct(begin,end).
+        !*/
+        {
+            if (end-begin <= 1 || (end-begin)*work_per_index < min_parallel_work)
+                funct(begin, end);
+            else
+                parallel_for_blocked(begin, end, funct);
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        template <
+            typename dest_type,
+            typename EXP1,
+            typename EXP2
+            >
+        void subtract_product (
+            dest_type& dest,
+            long top,
+            long left,
+            const matrix_exp<EXP1>& lhs,
+            const matrix_exp<EXP2>& rhs
+        )
+        /*!
+            requires
+                - lhs.nc() == rhs.nr()
+                - get_rect(dest).contains(rectangle(left,top,left+rhs.nc()-1,top+lhs.nr()-1))
+                - lhs and rhs don't reference the part of dest being written to.
+            ensures
+                - performs: set_subm(dest,top,left,lhs.nr(),rhs.nc()) -= lhs*rhs
+                  The work is split into column (or row) blocks which are computed in
+                  parallel.
+        !*/
+        {
+            const long nr = lhs.nr();
+            const long nc = rhs.nc();
+            if (nr == 0 || nc == 0 || lhs.nc() == 0)
+                return;
+
+            const long work = lhs.nc()*block_size;
+            // Split whichever side of the output is bigger so that each task gets a
+            // reasonably sized block to multiply.
+            if (nc >= nr)
+            {
+                const long num = (nc+block_size-1)/block_size;
+                parallel_for_blocked_if_worthwhile(0, num, nr*work, [&](long begin, long end)
+                {
+                    const long c = begin*block_size;
+                    const long width = std::min(end*block_size, nc) - c;
+                    auto sub = set_subm(dest, top, left+c, nr, width);
+                    default_matrix_multiply(sub, -lhs, subm(rhs, 0, c, rhs.nr(), width));
+                });
+            }
+            else
+            {
+                const long num = (nr+block_size-1)/block_size;
+                parallel_for_blocked_if_worthwhile(0, num, nc*work, [&](long begin, long end)
+                {
+                    const long r = begin*block_size;
+                    const long height = std::min(end*block_size, nr) - r;
+                    auto sub = set_subm(dest, top+r, left, height, nc);
+                    default_matrix_multiply(sub, -subm(lhs, r, 0, height, lhs.nc()), rhs);
+                });
+            }
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        template <
+            typename T,
+            typename MM,
+            typename L
+            >
+        matrix<T,0,0,MM,L> block_reflector_factor (
+            const matrix<T,0,0,MM,L>& V,
+            const matrix<T,0,1,MM,L>& tau
+        )
+        /*!
+            requires
+                - V.nc() == tau.size()
+                - V is lower trapezoidal.  That is, V(r,c) == 0 for all r < c.
+            ensures
+                - Let H(i) == identity_matrix<T>(V.nr()) - tau(i)*colm(V,i)*trans(colm(V,i)),
+                  a Householder reflection.  This function returns the upper triangular
+                  matrix T such that:
+                    - H(0)*H(1)*...*H(V.nc()-1) == identity_matrix<T>(V.nr()) - V*T*trans(V)
+                  That is, it computes the compact WY representation of the product of
+                  the reflections, as described in "A storage-efficient WY representation
+                  for products of Householder transformations" by Schreiber and Van Loan.
+        !*/
+        {
+            const long k = V.nc();
+            matrix<T,0,0,MM,L> Tm(k,k);
+            Tm = 0;
+            for (long i = 0; i < k; ++i)
+            {
+                Tm(i,i) = tau(i);
+                if (i == 0 || tau(i) == 0)
+                    continue;
+
+                // Tm(0:i,i) = -tau(i)*Tm(0:i,0:i)*trans(V(:,0:i))*V(:,i)
+                matrix<T,0,1,MM,L> w = trans(subm(V,i,0,V.nr()-i,i))*subm(V,i,i,V.nr()-i,1);
+                for (long r = 0; r < i; ++r)
+                {
+                    T temp = 0;
+                    for (long c = r; c < i; ++c)
+                        temp += Tm(r,c)*w(c);
+                    Tm(r,i) = -tau(i)*temp;
+                }
+            }
+            return Tm;
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        template <
+            typename dest_type,
+            typename T,
+            typename MM,
+            typename L
+            >
+        void apply_block_reflector (
+            bool transpose,
+            const matrix<T,0,0,MM,L>& V,
+            const matrix<T,0,0,MM,L>& Tm,
+            dest_type& dest,
+            long top,
+            long left,
+            long width
+        )
+        /*!
+            requires
+                - Tm == block_reflector_factor(V, tau) for some tau.
+                - get_rect(dest).contains(rectangle(left,top,left+width-1,top+V.nr()-1))
+            ensures
+                - Let H == identity_matrix<T>(V.nr()) - V*Tm*trans(V) and let
+                  X == subm(dest,top,left,V.nr(),width).  Then:
+                    - if (transpose) then
+                        - performs: X = trans(H)*X
+                    - else
+                        - performs: X = H*X
+                - The columns of X are processed in parallel.
+        !*/
+        {
+            const long k = V.nc();
+            if (k == 0 || width <= 0)
+                return;
+
+            const long num = (width+block_size-1)/block_size;
+            parallel_for_blocked_if_worthwhile(0, num, 4*V.nr()*k*block_size, [&](long begin, long end)
+            {
+                const long c = begin*block_size;
+                const long w = std::min(end*block_size, width) - c;
+                auto X = set_subm(dest, top, left+c, V.nr(), w);
+
+                // W = trans(V)*X
+                matrix<T,0,0,MM,L> W(k,w), W2(k,w);
+                W = 0;
+                default_matrix_multiply(W, trans(V), subm(dest, top, left+c, V.nr(), w));
+
+                // W2 = Tm*W or trans(Tm)*W
+                W2 = 0;
+                if (transpose)
+                    default_matrix_multiply(W2, trans(Tm), W);
+                else
+                    default_matrix_multiply(W2, Tm, W);
+
+                // X -= V*W2
+                default_matrix_multiply(X, -V, W2);
+            });
+        }
+
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_MATRIx_LA_BLOCKED_H_
+
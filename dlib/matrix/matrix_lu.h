@@ -9,6 +9,7 @@
 #include "matrix_utilities.h"
 #include "matrix_subexp.h"
 #include "matrix_trsm.h"
+#include "matrix_la_blocked.h"
 #include <algorithm>
 
 #ifdef DLIB_USE_LAPACK 
@@ -136,67 +137,87 @@ namespace dlib
 
 #else
 
-        // Use a "left-looking", dot-product, Crout/Doolittle algorithm.
+        // Use a blocked "right-looking" algorithm.  Each panel of columns is factored
+        // with partial pivoting and then used to update the rest of the matrix with
+        // a triangular solve and a matrix multiply.
 
 
         piv = trans(range(0,m-1));
         pivsign = 1;
 
-        column_vector_type LUcolj(m);
-
-        // Outer loop.
-        for (long j = 0; j < n; j++) 
+        const long bs = blocked_la::block_size;
+        const long mn = std::min(m,n);
+        for (long k0 = 0; k0 < mn; k0 += bs)
         {
+            const long kend = std::min(k0+bs, mn);
 
-            // Make a copy of the j-th column to localize references.
-            LUcolj = colm(LU,j);
-
-            // Apply previous transformations.
-            for (long i = 0; i < m; i++) 
-            {
-                // Most of the time is spent in the following dot product.
-                const long kmax = std::min(i,j);
-                type s;
-                if (kmax > 0)
-                    s = rowm(LU,i, kmax)*colm(LUcolj,0,kmax);
-                else 
-                    s = 0;
-
-                LU(i,j) = LUcolj(i) -= s;
-            }
-
-            // Find pivot and exchange if necessary.
-            long p = j;
-            for (long i = j+1; i < m; i++) 
+            // Factor the panel.
+            for (long j = k0; j < kend; j++) 
             {
-                if (abs(LUcolj(i)) > abs(LUcolj(p))) 
+                // Find pivot and exchange if necessary.
+                long p = j;
+                for (long i = j+1; i < m; i++) 
                 {
-                    p = i;
+                    if (abs(LU(i,j)) > abs(LU(p,j))) 
+                    {
+                        p = i;
+                    }
                 }
-            }
-            if (p != j) 
-            {
-                long k=0;
-                for (k = 0; k < n; k++) 
+                if (p != j) 
                 {
-                    type t = LU(p,k); 
-                    LU(p,k) = LU(j,k); 
-                    LU(j,k) = t;
+                    for (long k = 0; k < n; k++) 
+                    {
+                        type t = LU(p,k); 
+                        LU(p,k) = LU(j,k); 
+                        LU(j,k) = t;
+                    }
+                    std::swap(piv(p), piv(j));
+                    pivsign = -pivsign;
                 }
-                k = piv(p); 
-                piv(p) = piv(j); 
-                piv(j) = k;
-                pivsign = -pivsign;
-            }
 
-            // Compute multipliers.
-            if ((j < m) && (LU(j,j) != 0.0)) 
-            {
-                for (long i = j+1; i < m; i++) 
+                // Compute multipliers.
+                if (LU(j,j) != 0.0) 
                 {
-                    LU(i,j) /= LU(j,j);
+                    for (long i = j+1; i < m; i++) 
+                    {
+                        LU(i,j) /= LU(j,j);
+                    }
+                }
+
+                // Update the rest of the panel.
+                for (long k = j+1; k < kend; k++) 
+                {
+                    const type t = LU(j,k);
+                    for (long i = j+1; i < m; i++) 
+                    {
+                        LU(i,k) -= LU(i,j)*t;
+                    }
                 }
             }
+
+            if (kend == n)
+                break;
+
+            // Compute the rows of U to the right of the panel, that is, solve
+            // L11*U12 == A12 where L11 is the unit lower triangular part of the panel.
+            blocked_la::parallel_for_blocked_if_worthwhile(kend, n, (kend-k0)*(kend-k0), 
+                [&](long begin, long end)
+                {
+                    for (long k = begin; k < end; ++k)
+                    {
+                        for (long j = k0; j < kend; ++j)
+                        {
+                            const type t = LU(j,k);
+                            for (long i = j+1; i < kend; ++i)
+                                LU(i,k) -= LU(i,j)*t;
+                        }
+                    }
+                });
+
+            // A22 -= L21*U12
+            blocked_la::subtract_product(LU, kend, kend, 
+                subm(LU, kend, k0, m-kend, kend-k0), 
+                subm(LU, k0, kend, kend-k0, n-kend));
         }
 
 #endif
@@ -15,6 +15,7 @@
 #endif
 
 #include "matrix_trsm.h"
+#include "matrix_la_blocked.h"
 
 namespace dlib 
 {
@@ -84,6 +85,23 @@ namespace dlib
         const matrix_type solve_vect (
             const matrix_exp<EXP>& B
         ) const;
+
+        typedef matrix<type,0,0,mem_manager_type,column_major_layout> reflector_matrix_type;
+        typedef matrix<type,0,1,mem_manager_type,column_major_layout> reflector_vector_type;
+
+        void get_block_reflector (
+            long k,
+            long kb,
+            reflector_matrix_type& V,
+            reflector_matrix_type& Tm
+        ) const;
+        /*!
+            ensures
+                - #V and #Tm are the compact WY representation of the Householder
+                  reflections for columns k through k+kb-1 of the decomposition.  They
+                  can be given to blocked_la::apply_block_reflector() to apply those
+                  reflections to rows k through m-1 of a matrix.
+        !*/
 #endif
 
 
@@ -145,47 +163,62 @@ namespace dlib
 
 #else
         Rdiag.set_size(n);
-        long i=0, j=0, k=0;
 
-        // Main loop.
-        for (k = 0; k < n; k++) 
+        // Factor the columns one panel at a time.  Within a panel we use the
+        // unblocked Householder algorithm and then we apply all the panel's
+        // reflections to the remaining columns at once using matrix multiplies.
+        const long bs = blocked_la::block_size;
+        for (long k0 = 0; k0 < n; k0 += bs)
         {
-            // Compute 2-norm of k-th column without under/overflow.
-            type nrm = 0;
-            for (i = k; i < m; i++) 
-            {
-                nrm = hypot(nrm,QR_(i,k));
-            }
+            const long kend = std::min(k0+bs, n);
 
-            if (nrm != 0.0) 
+            for (long k = k0; k < kend; k++) 
             {
-                // Form k-th Householder vector.
-                if (QR_(k,k) < 0) 
+                // Compute 2-norm of k-th column without under/overflow.
+                type nrm = 0;
+                for (long i = k; i < m; i++) 
                 {
-                    nrm = -nrm;
+                    nrm = hypot(nrm,QR_(i,k));
                 }
-                for (i = k; i < m; i++) 
-                {
-                    QR_(i,k) /= nrm;
-                }
-                QR_(k,k) += 1.0;
 
-                // Apply transformation to remaining columns.
-                for (j = k+1; j < n; j++) 
+                if (nrm != 0.0) 
                 {
-                    type s = 0.0; 
-                    for (i = k; i < m; i++) 
+                    // Form k-th Householder vector.
+                    if (QR_(k,k) < 0) 
                     {
-                        s += QR_(i,k)*QR_(i,j);
+                        nrm = -nrm;
                     }
-                    s = -s/QR_(k,k);
-                    for (i = k; i < m; i++) 
+                    for (long i = k; i < m; i++) 
                     {
-                        QR_(i,j) += s*QR_(i,k);
+                        QR_(i,k) /= nrm;
+                    }
+                    QR_(k,k) += 1.0;
+
+                    // Apply transformation to the remaining columns in the panel.
+                    for (long j = k+1; j < kend; j++) 
+                    {
+                        type s = 0.0; 
+                        for (long i = k; i < m; i++) 
+                        {
+                            s += QR_(i,k)*QR_(i,j);
+                        }
+                        s = -s/QR_(k,k);
+                        for (long i = k; i < m; i++) 
+                        {
+                            QR_(i,j) += s*QR_(i,k);
+                        }
                     }
                 }
+                Rdiag(k) = -nrm;
+            }
+
+            // Apply the panel to the rest of the matrix.
+            if (kend < n)
+            {
+                reflector_matrix_type V, Tm;
+                get_block_reflector(k0, kend-k0, V, Tm);
+                blocked_la::apply_block_reflector(true, V, Tm, QR_, k0, kend, n-kend);
             }
-            Rdiag(k) = -nrm;
         }
 #endif
     }
@@ -286,33 +319,51 @@ namespace dlib
         lapack::ormqr('L','N', QR_, tau, X);
 
 #else
-        long i=0, j=0, k=0;
-
-        X.set_size(m,n);
-        for (k = n-1; k >= 0; k--) 
+        if (n <= blocked_la::block_size)
         {
-            for (i = 0; i < m; i++) 
-            {
-                X(i,k) = 0.0;
-            }
-            X(k,k) = 1.0;
-            for (j = k; j < n; j++) 
+            long i=0, j=0, k=0;
+
+            X.set_size(m,n);
+            for (k = n-1; k >= 0; k--) 
             {
-                if (QR_(k,k) != 0) 
+                for (i = 0; i < m; i++) 
                 {
-                    type s = 0.0;
-                    for (i = k; i < m; i++) 
-                    {
-                        s += QR_(i,k)*X(i,j);
-                    }
-                    s = -s/QR_(k,k);
-                    for (i = k; i < m; i++) 
+                    X(i,k) = 0.0;
+                }
+                X(k,k) = 1.0;
+                for (j = k; j < n; j++) 
+                {
+                    if (QR_(k,k) != 0) 
                     {
-                        X(i,j) += s*QR_(i,k);
+                        type s = 0.0;
+                        for (i = k; i < m; i++) 
+                        {
+                            s += QR_(i,k)*X(i,j);
+                        }
+                        s = -s/QR_(k,k);
+                        for (i = k; i < m; i++) 
+                        {
+                            X(i,j) += s*QR_(i,k);
+                        }
                     }
                 }
             }
         }
+        else
+        {
+            // Accumulate the reflections a panel at a time, starting with the last
+            // one.  Each panel only touches the rows and columns after its first
+            // column.
+            X = colm(identity_matrix<type>(m), range(0,n-1));
+            const long bs = blocked_la::block_size;
+            for (long k0 = ((n-1)/bs)*bs; k0 >= 0; k0 -= bs)
+            {
+                const long kb = std::min(bs, n-k0);
+                reflector_matrix_type V, Tm;
+                get_block_reflector(k0, kb, V, Tm);
+                blocked_la::apply_block_reflector(false, V, Tm, X, k0, k0, n-k0);
+            }
+        }
 #endif
     }
 
@@ -454,6 +505,37 @@ namespace dlib
         return subm(X,0,0,n,nx);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename matrix_exp_type>
+    void qr_decomposition<matrix_exp_type>::
+    get_block_reflector (
+        long k,
+        long kb,
+        reflector_matrix_type& V,
+        reflector_matrix_type& Tm
+    ) const
+    {
+        // Column j of QR_ holds the Householder vector v, starting at row j, of the
+        // reflection I - v*trans(v)/v(j).  Columns where the norm was 0 don't have
+        // a reflection and have QR_(j,j) == 0.
+        V.set_size(m-k, kb);
+        reflector_vector_type tau(kb);
+        for (long j = 0; j < kb; ++j)
+        {
+            for (long i = 0; i < j; ++i)
+                V(i,j) = 0;
+            for (long i = j; i < m-k; ++i)
+                V(i,j) = QR_(k+i,k+j);
+
+            if (QR_(k+j,k+j) != 0)
+                tau(j) = 1/QR_(k+j,k+j);
+            else
+                tau(j) = 0;
+        }
+        Tm = blocked_la::block_reflector_factor(V, tau);
+    }
+
 // ----------------------------------------------------------------------------------------
 
 #endif // DLIB_USE_LAPACK not defined
@@ -0,0 +1,713 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_SPARSE_MATRIx_H_
+#define DLIB_SPARSE_MATRIx_H_
+
+#include "sparse_matrix_abstract.h"
+#include "matrix.h"
+#include "matrix_utilities.h"
+#include "matrix_la.h"
+#include "matrix_la_blocked.h"
+#include "../sparse_vector.h"
+#include "../serialize.h"
+#include "../threads/parallel_for_extension.h"
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class sparse_matrix_row
+    {
+    public:
+        typedef std::pair<unsigned long,T> value_type;
+        typedef typename std::vector<value_type>::const_iterator const_iterator;
+        typedef const_iterator iterator;
+
+        sparse_matrix_row(
+        ) : b(), e(b) {}
+
+        sparse_matrix_row(
+            const_iterator b_,
+            const_iterator e_
+        ) : b(b_), e(e_) {}
+
+        const_iterator begin(
+        ) const { return b; }
+
+        const_iterator end(
+        ) const { return e; }
+
+        unsigned long size (
+        ) const { return e - b; }
+
+        bool empty (
+        ) const { return b == e; }
+
+    private:
+        const_iterator b;
+        const_iterator e;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class sparse_matrix
+    {
+    public:
+        typedef T type;
+        typedef sparse_matrix_row<T> row_type;
+
+        sparse_matrix (
+        ) : nr_(0), nc_(0), offsets(1,0) {}
+
+        sparse_matrix (
+            long rows,
+            long cols
+        ) : nr_(rows), nc_(cols)
+        {
+            DLIB_ASSERT(rows >= 0 && cols >= 0,
+                "\t sparse_matrix::sparse_matrix(rows,cols)"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t rows: " << rows
+                << "\n\t cols: " << cols
+                );
+            offsets.assign(nr_+1, 0);
+        }
+
+        template <typename sparse_vector_type>
+        explicit sparse_matrix (
+            const std::vector<sparse_vector_type>& rows
+        )
+        {
+            nc_ = load_rows(rows);
+        }
+
+        template <typename sparse_vector_type>
+        sparse_matrix (
+            const std::vector<sparse_vector_type>& rows,
+            long cols
+        )
+        {
+            const unsigned long max_index_plus_one = load_rows(rows);
+            // This is always checked since a key >= cols would make the multiply routines
+            // read past the end of their inputs.
+            DLIB_CASSERT(cols >= 0 && max_index_plus_one <= (unsigned long)cols,
+                "\t sparse_matrix::sparse_matrix(rows,cols)"
+                << "\n\t The given rows don't fit into cols columns."
+                << "\n\t cols: " << cols
+                << "\n\t largest key in rows + 1: " << max_index_plus_one
+                );
+            nc_ = cols;
+        }
+
+        template <typename EXP>
+        explicit sparse_matrix (
+            const matrix_exp<EXP>& m
+        ) : nr_(m.nr()), nc_(m.nc())
+        {
+            COMPILE_TIME_ASSERT((is_same_type<typename EXP::type,T>::value));
+            offsets.resize(nr_+1);
+            offsets[0] = 0;
+            for (long r = 0; r < m.nr(); ++r)
+            {
+                for (long c = 0; c < m.nc(); ++c)
+                {
+                    const T val = m(r,c);
+                    if (val != 0)
+                        entries.push_back(value_type(c,val));
+                }
+                offsets[r+1] = entries.size();
+            }
+        }
+
+        long nr (
+        ) const { return nr_; }
+
+        long nc (
+        ) const { return nc_; }
+
+        unsigned long num_nonzero (
+        ) const { return entries.size(); }
+
+        row_type row (
+            long r
+        ) const
+        {
+            DLIB_ASSERT(0 <= r && r < nr(),
+                "\t sparse_matrix::row(r)"
+                << "\n\t You have supplied an invalid row index."
+                << "\n\t r:    " << r
+                << "\n\t nr(): " << nr()
+                );
+            return row_type(entries.begin()+offsets[r], entries.begin()+offsets[r+1]);
+        }
+
+        T operator() (
+            long r,
+            long c
+        ) const
+        {
+            DLIB_ASSERT(0 <= r && r < nr() && 0 <= c && c < nc(),
+                "\t T sparse_matrix::operator(r,c)"
+                << "\n\t You have supplied invalid indices."
+                << "\n\t r:    " << r
+                << "\n\t c:    " << c
+                << "\n\t nr(): " << nr()
+                << "\n\t nc(): " << nc()
+                );
+            const auto end = entries.begin()+offsets[r+1];
+            const auto i = std::lower_bound(entries.begin()+offsets[r], end, (unsigned long)c,
+                [](const value_type& a, unsigned long idx) { return a.first < idx; });
+            if (i != end && i->first == (unsigned long)c)
+                return i->second;
+            return 0;
+        }
+
+        void swap (
+            sparse_matrix& item
+        )
+        {
+            std::swap(nr_, item.nr_);
+            std::swap(nc_, item.nc_);
+            offsets.swap(item.offsets);
+            entries.swap(item.entries);
+        }
+
+        friend void serialize (
+            const sparse_matrix& item,
+            std::ostream& out
+        )
+        {
+            int version = 1;
+            serialize(version, out);
+            serialize(item.nr_, out);
+            serialize(item.nc_, out);
+            serialize(item.offsets, out);
+            serialize(item.entries, out);
+        }
+
+        friend void deserialize (
+            sparse_matrix& item,
+            std::istream& in
+        )
+        {
+            int version = 0;
+            deserialize(version, in);
+            if (version != 1)
+                throw serialization_error("Unexpected version found while deserializing dlib::sparse_matrix.");
+            deserialize(item.nr_, in);
+            deserialize(item.nc_, in);
+            deserialize(item.offsets, in);
+            deserialize(item.entries, in);
+
+            bool is_valid = item.nr_ >= 0 && item.nc_ >= 0 &&
+                            item.offsets.size() == (unsigned long)item.nr_+1 &&
+                            item.offsets.front() == 0 &&
+                            item.offsets.back() == item.entries.size() &&
+                            std::is_sorted(item.offsets.begin(), item.offsets.end());
+            for (unsigned long i = 0; is_valid && i < item.entries.size(); ++i)
+                is_valid = item.entries[i].first < (unsigned long)item.nc_;
+            if (!is_valid)
+                throw serialization_error("Invalid data found while deserializing dlib::sparse_matrix.");
+        }
+
+        template <typename U>
+        friend sparse_matrix<U> trans (
+            const sparse_matrix<U>& A
+        );
+
+    private:
+        typedef std::pair<unsigned long,T> value_type;
+
+        template <typename sparse_vector_type>
+        unsigned long load_rows (
+            const std::vector<sparse_vector_type>& rows
+        )
+        /*!
+            ensures
+                - Fills offsets and entries with the contents of rows and sets nr_.
+                - returns the largest key in rows plus 1.
+        !*/
+        {
+            // You are getting this error because you are attempting to use sparse vectors
+            // but you aren't using an unsigned integer as your key type.
+            COMPILE_TIME_ASSERT(is_unsigned_type<typename sparse_vector_type::value_type::first_type>::value);
+
+            nr_ = rows.size();
+            offsets.resize(nr_+1);
+            offsets[0] = 0;
+            unsigned long total = 0;
+            for (auto& v : rows)
+                total += v.size();
+            entries.clear();
+            entries.reserve(total);
+
+            unsigned long max_index_plus_one = 0;
+            for (long r = 0; r < nr_; ++r)
+            {
+                const unsigned long begin = entries.size();
+                bool is_sorted = true;
+                for (auto& p : rows[r])
+                {
+                    if (entries.size() != begin && p.first <= entries.back().first)
+                        is_sorted = false;
+                    entries.push_back(value_type(p.first, p.second));
+                }
+
+                // Unsorted sparse vectors get sorted and their duplicate keys merged, just
+                // like make_sparse_vector() does.
+                if (!is_sorted)
+                {
+                    std::sort(entries.begin()+begin, entries.end(),
+                        [](const value_type& a, const value_type& b) { return a.first < b.first; });
+                    unsigned long j = begin;
+                    for (unsigned long i = begin+1; i < entries.size(); ++i)
+                    {
+                        if (entries[i].first == entries[j].first)
+                            entries[j].second += entries[i].second;
+                        else
+                            entries[++j] = entries[i];
+                    }
+                    entries.resize(j+1);
+                }
+
+                if (entries.size() != begin)
+                    max_index_plus_one = std::max(max_index_plus_one, entries.back().first+1);
+                offsets[r+1] = entries.size();
+            }
+            return max_index_plus_one;
+        }
+
+        long nr_;
+        long nc_;
+        // Row r is stored in entries[offsets[r]] through entries[offsets[r+1]-1].
+        std::vector<unsigned long> offsets;
+        std::vector<value_type> entries;
+    };
+
+    template <typename T>
+    void swap (
+        sparse_matrix<T>& a,
+        sparse_matrix<T>& b
+    ) { a.swap(b); }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename U>
+    sparse_matrix<U> trans (
+        const sparse_matrix<U>& A
+    )
+    {
+        // This is a counting sort of A's elements by column.
+        sparse_matrix<U> B;
+        B.nr_ = A.nc_;
+        B.nc_ = A.nr_;
+        B.offsets.assign(B.nr_+1, 0);
+        for (auto& p : A.entries)
+            ++B.offsets[p.first+1];
+        for (long r = 0; r < B.nr_; ++r)
+            B.offsets[r+1] += B.offsets[r];
+
+        B.entries.resize(A.entries.size());
+        std::vector<unsigned long> next(B.offsets.begin(), B.offsets.end()-1);
+        for (long r = 0; r < A.nr_; ++r)
+        {
+            for (unsigned long i = A.offsets[r]; i < A.offsets[r+1]; ++i)
+            {
+                const auto& p = A.entries[i];
+                B.entries[next[p.first]++] = std::make_pair((unsigned long)r, p.second);
+            }
+        }
+        return B;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        template <
+            typename T,
+            typename funct_type
+            >
+        void for_each_row_block (
+            const sparse_matrix<T>& A,
+            long work_per_element,
+            const funct_type& funct
+        )
+        /*!
+            ensures
+                - Calls funct(begin,end) on a set of row ranges that together cover
+                  [0,A.nr()).  The calls are made in parallel and each range holds about
+                  the same number of elements of A, so rows of very different lengths
+                  still split the work evenly between the threads.
+        !*/
+        {
+            // Count each row as one element too since every row costs something even
+            // when it's empty.
+            const unsigned long total = A.num_nonzero() + A.nr();
+            const long num_threads = default_thread_pool().num_threads_in_pool();
+            if (A.nr() <= 1 || num_threads <= 1 ||
+                (long)total*work_per_element < blocked_la::min_parallel_work)
+            {
+                funct(0, A.nr());
+                return;
+            }
+
+            const unsigned long per_block = total/(8*num_threads) + 1;
+            std::vector<long> bounds(1,0);
+            unsigned long count = 0;
+            for (long r = 0; r < A.nr(); ++r)
+            {
+                count += A.row(r).size() + 1;
+                if (count >= per_block)
+                {
+                    bounds.push_back(r+1);
+                    count = 0;
+                }
+            }
+            if (bounds.back() != A.nr())
+                bounds.push_back(A.nr());
+
+            parallel_for(0, bounds.size()-1, [&](long i)
+            {
+                funct(bounds[i], bounds[i+1]);
+            }, 1);
+        }
+
+        template <
+            typename T
+            >
+        void multiply_rows (
+            const sparse_matrix<T>& A,
+            const T* X,
+            long k,
+            T* Y,
+            long begin,
+            long end
+        )
+        /*!
+            requires
+                - X is a row major A.nc() by k matrix and Y a row major A.nr() by k matrix.
+            ensures
+                - performs: rowm(Y,range(begin,end-1)) = rowm(A*X,range(begin,end-1))
+        !*/
+        {
+            const long block = 8;
+            for (long r = begin; r < end; ++r)
+            {
+                const auto row = A.row(r);
+                T* y = Y + r*k;
+                long j = 0;
+                // Do the output row block columns at a time, holding each block in a
+                // small array the compiler can keep in vector registers while we run
+                // down the row of A.
+                for (; j + block <= k; j += block)
+                {
+                    T acc[block] = {};
+                    for (auto& p : row)
+                    {
+                        const T val = p.second;
+                        const T* x = X + p.first*k + j;
+                        for (long t = 0; t < block; ++t)
+                            acc[t] += val*x[t];
+                    }
+                    for (long t = 0; t < block; ++t)
+                        y[j+t] = acc[t];
+                }
+                for (; j < k; ++j)
+                {
+                    T acc = 0;
+                    for (auto& p : row)
+                        acc += p.second*X[p.first*k + j];
+                    y[j] = acc;
+                }
+            }
+        }
+
+        template <typename T, long NR, long NC, typename MM, typename temp_type>
+        const matrix<T,NR,NC,MM,row_major_layout>& row_major_version (
+            const matrix<T,NR,NC,MM,row_major_layout>& m,
+            temp_type&
+        ) { return m; }
+
+        template <typename EXP, typename temp_type>
+        const temp_type& row_major_version (
+            const matrix_exp<EXP>& m,
+            temp_type& temp
+        )
+        {
+            temp = m;
+            return temp;
+        }
+    }
+
+    template <typename T, typename EXP>
+    matrix<T,0,EXP::NC> operator* (
+        const sparse_matrix<T>& A,
+        const matrix_exp<EXP>& X
+    )
+    {
+        COMPILE_TIME_ASSERT((is_same_type<T,typename EXP::type>::value));
+        DLIB_ASSERT(A.nc() == X.nr(),
+            "\t matrix operator*(sparse_matrix A, matrix_exp X)"
+            << "\n\t You can only multiply matrices that have compatible dimensions."
+            << "\n\t A.nr(): " << A.nr()
+            << "\n\t A.nc(): " << A.nc()
+            << "\n\t X.nr(): " << X.nr()
+            << "\n\t X.nc(): " << X.nc()
+            );
+
+        matrix<T,0,EXP::NC> result(A.nr(), X.nc());
+        if (result.size() == 0)
+            return result;
+        if (X.size() == 0)
+        {
+            result = 0;
+            return result;
+        }
+
+        matrix<T,0,EXP::NC> temp;
+        const auto& Xr = impl::row_major_version(X.ref(), temp);
+        const T* x = &Xr(0,0);
+        T* y = &result(0,0);
+        const long k = X.nc();
+        impl::for_each_row_block(A, k, [&](long begin, long end)
+        {
+            impl::multiply_rows(A, x, k, y, begin, end);
+        });
+        return result;
+    }
+
+    template <typename T, typename EXP, bool B>
+    matrix<T,0,EXP::NC> operator* (
+        const sparse_matrix<T>& A,
+        const matrix_mul_scal_exp<EXP,B>& X
+    )
+    {
+        // Without this overload the operator*(scalar, matrix_mul_scal_exp) defined in
+        // matrix.h would be picked for things like A*(2*X).
+        const matrix_exp<matrix_mul_scal_exp<EXP,B> >& temp = X;
+        return A*temp;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    struct op_sparse_matrix_to_rows : does_not_alias
+    {
+        op_sparse_matrix_to_rows( const sparse_matrix<T>& m_) : m(m_){}
+
+        const sparse_matrix<T>& m;
+
+        const static long cost = 1;
+        const static long NR = 0;
+        const static long NC = 1;
+        typedef sparse_matrix_row<T> type;
+        typedef sparse_matrix_row<T> const_ret_type;
+        typedef default_memory_manager mem_manager_type;
+        typedef row_major_layout layout_type;
+
+        const_ret_type apply (long r, long ) const { return m.row(r); }
+
+        long nr () const { return m.nr(); }
+        long nc () const { return 1; }
+    };
+
+    template <typename T>
+    const matrix_op<op_sparse_matrix_to_rows<T> > mat (
+        const sparse_matrix<T>& m
+    )
+    {
+        typedef op_sparse_matrix_to_rows<T> op;
+        return matrix_op<op>(op(m));
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    matrix<T> sparse_to_dense (
+        const sparse_matrix<T>& A
+    )
+    {
+        matrix<T> result(A.nr(), A.nc());
+        result = 0;
+        for (long r = 0; r < A.nr(); ++r)
+        {
+            for (auto& p : A.row(r))
+                result(r,p.first) += p.second;
+        }
+        return result;
+    }
+
+// ----------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------
+
+    namespace simpl
+    {
+        template <
+            typename T,
+            typename MM,
+            typename L
+            >
+        void find_matrix_range (
+            const sparse_matrix<T>& A,
+            const sparse_matrix<T>& At,
+            unsigned long l,
+            matrix<T,0,0,MM,L>& Q,
+            unsigned long q
+        )
+        /*!
+            requires
+                - At == trans(A) or q == 0
+            ensures
+                - performs: find_matrix_range(A,l,Q,q)
+        !*/
+        {
+            // This is the same gaussian matrix the std::vector<sparse_vector_type>
+            // version of find_matrix_range() multiplies A by.
+            matrix<T,0,0,MM> G(A.nc(), l);
+            for (long r = 0; r < G.nr(); ++r)
+            {
+                for (long c = 0; c < G.nc(); ++c)
+                    G(r,c) = static_cast<T>(gaussian_random_hash(r,0,c));
+            }
+            Q = A*G;
+            G.set_size(0,0); // free RAM
+            orthogonalize(Q);
+
+            // Do some extra iterations of the power method to make sure we get Q into the
+            // span of the most important singular vectors of A.
+            for (unsigned long itr = 0; itr < q; ++itr)
+            {
+                matrix<T,0,0,MM,L> Z = At*Q;
+                Q.set_size(0,0); // free RAM
+                orthogonalize(Z);
+
+                Q = A*Z;
+                Z.set_size(0,0); // free RAM
+                orthogonalize(Q);
+            }
+        }
+    }
+
+    template <
+        typename T,
+        typename MM,
+        typename L
+        >
+    void find_matrix_range (
+        const sparse_matrix<T>& A,
+        unsigned long l,
+        matrix<T,0,0,MM,L>& Q,
+        unsigned long q
+    )
+    {
+        DLIB_ASSERT(A.nr() >= (long)l, "Invalid inputs were given to this function.");
+        if (q == 0)
+            simpl::find_matrix_range(A, sparse_matrix<T>(), l, Q, q);
+        else
+            simpl::find_matrix_range(A, trans(A), l, Q, q);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    namespace simpl
+    {
+        template <
+            typename T,
+            long Unr, long Unc,
+            long Wnr, long Wnc,
+            long Vnr, long Vnc,
+            typename MM,
+            typename L
+            >
+        void svd_fast (
+            bool compute_u,
+            const sparse_matrix<T>& A,
+            matrix<T,Unr,Unc,MM,L>& u,
+            matrix<T,Wnr,Wnc,MM,L>& w,
+            matrix<T,Vnr,Vnc,MM,L>& v,
+            unsigned long l,
+            unsigned long q
+        )
+        {
+            const unsigned long k = std::min(l, std::min<unsigned long>(A.nr(),A.nc()));
+
+            DLIB_ASSERT(l > 0 && A.nr() > 0 && A.nc() > 0,
+                "\t void svd_fast()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t l: " << l
+                << "\n\t A.nr(): " << A.nr()
+                << "\n\t A.nc(): " << A.nc()
+                );
+
+            // trans(A) is needed both for the power iterations and for B, so make it once.
+            const sparse_matrix<T> At = trans(A);
+            matrix<T,0,0,MM,L> Q;
+            find_matrix_range(A, At, k, Q, q);
+
+            // Compute trans(B) = trans(Q)*A.   The reason we store B transposed
+            // is so that when we take its SVD later using svd3() it doesn't consume
+            // a whole lot of RAM.  That is, we make sure the square matrix coming out
+            // of svd3() has size lxl rather than the potentially much larger nxn.
+            matrix<T,0,0,MM,L> B = At*Q;
+            svd3(B, v,w,u);
+            if (compute_u)
+                u = Q*u;
+        }
+    }
+
+    template <
+        typename T,
+        long Unr, long Unc,
+        long Wnr, long Wnc,
+        long Vnr, long Vnc,
+        typename MM,
+        typename L
+        >
+    void svd_fast (
+        const sparse_matrix<T>& A,
+        matrix<T,Unr,Unc,MM,L>& u,
+        matrix<T,Wnr,Wnc,MM,L>& w,
+        matrix<T,Vnr,Vnc,MM,L>& v,
+        unsigned long l,
+        unsigned long q = 1
+    )
+    {
+        simpl::svd_fast(true, A,u,w,v,l,q);
+    }
+
+    template <
+        typename T,
+        long Wnr, long Wnc,
+        long Vnr, long Vnc,
+        typename MM,
+        typename L
+        >
+    void svd_fast (
+        const sparse_matrix<T>& A,
+        matrix<T,Wnr,Wnc,MM,L>& w,
+        matrix<T,Vnr,Vnc,MM,L>& v,
+        unsigned long l,
+        unsigned long q = 1
+    )
+    {
+        matrix<T,0,0,MM,L> u;
+        simpl::svd_fast(false, A,u,w,v,l,q);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_SPARSE_MATRIx_H_
+
@@ -0,0 +1,393 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_SPARSE_MATRIx_ABSTRACT_H_
+#ifdef DLIB_SPARSE_MATRIx_ABSTRACT_H_
+
+#include "matrix_abstract.h"
+#include "../svm/sparse_vector_abstract.h"
+#include "../serialize.h"
+#include <vector>
+#include <utility>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class sparse_matrix_row
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object is a read only view of one row of a sparse_matrix.  It is a
+                sparse vector, as defined in dlib/svm/sparse_vector_abstract.h.  That is, it
+                is a range of std::pair<unsigned long,T> objects, sorted by their unique
+                keys, where each pair holds the column index and value of one of the
+                elements of the row that are stored in the sparse_matrix.  Therefore you can hand it to any of the
+                sparse vector functions, like dot(), add_to() or max_index_plus_one().
+
+                A sparse_matrix_row is only valid as long as the sparse_matrix it came from
+                isn't modified or destroyed.
+        !*/
+
+    public:
+        typedef std::pair<unsigned long,T> value_type;
+        typedef an_immutable_random_access_iterator const_iterator;
+        typedef const_iterator iterator;
+
+        sparse_matrix_row(
+        );
+        /*!
+            ensures
+                - #size() == 0
+        !*/
+
+        const_iterator begin(
+        ) const;
+        /*!
+            ensures
+                - returns an iterator to the first element of this row.
+        !*/
+
+        const_iterator end(
+        ) const;
+        /*!
+            ensures
+                - returns an iterator one past the last element of this row.
+        !*/
+
+        unsigned long size (
+        ) const;
+        /*!
+            ensures
+                - returns the number of elements stored for this row.
+        !*/
+
+        bool empty (
+        ) const;
+        /*!
+            ensures
+                - returns size() == 0
+        !*/
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class sparse_matrix
+    {
+        /*!
+            REQUIREMENTS ON T
+                T must be float, double, or long double.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object represents a sparse matrix stored in compressed sparse row
+                (CSR) format.  That is, the nonzero elements of each row are stored
+                contiguously, sorted by column, in one big array, and there is a second
+                array that records where each row begins.  Compared to a std::vector of
+                sparse vectors this uses only two memory allocations and no per-element
+                pointers, so looping over the elements is much cheaper.  It is also what
+                the multithreaded matrix multiply routines below work with.
+
+                There is no separate compressed sparse column (CSC) type.  The CSC form of
+                a matrix A is exactly the CSR form of trans(A), so if you need it just call
+                trans(A).
+
+                A sparse_matrix is not a matrix_exp.  However, multiplying it by a
+                matrix_exp gives a normal dlib::matrix, so you can write things like A*x or
+                trans(A)*X.  Moreover, mat(A) gives you a column vector of sparse vectors,
+                one per row of A, just like mat() of a std::vector of sparse vectors does.
+                So a sparse_matrix can be given as the training samples to any of the
+                linear trainers that take sparse vectors, like svm_c_linear_trainer.
+        !*/
+
+    public:
+        typedef T type;
+        typedef sparse_matrix_row<T> row_type;
+
+        sparse_matrix (
+        );
+        /*!
+            ensures
+                - #nr() == 0
+                - #nc() == 0
+        !*/
+
+        sparse_matrix (
+            long rows,
+            long cols
+        );
+        /*!
+            requires
+                - rows >= 0 && cols >= 0
+            ensures
+                - #nr() == rows
+                - #nc() == cols
+                - #num_nonzero() == 0
+                  (i.e. this is a matrix of all zeros)
+        !*/
+
+        template <typename sparse_vector_type>
+        explicit sparse_matrix (
+            const std::vector<sparse_vector_type>& rows
+        );
+        /*!
+            requires
+                - rows contains unsorted sparse vectors (see
+                  dlib/svm/sparse_vector_abstract.h) whose keys are unsigned integers.
+            ensures
+                - #nr() == rows.size()
+                - #nc() == one more than the largest key in rows, or 0 if rows doesn't
+                  contain any elements.
+                - for all valid r: row r of *this is the vector rows[r].  If rows[r] has
+                  duplicate keys then their values are added together, as usual for
+                  unsorted sparse vectors.
+        !*/
+
+        template <typename sparse_vector_type>
+        sparse_matrix (
+            const std::vector<sparse_vector_type>& rows,
+            long cols
+        );
+        /*!
+            requires
+                - rows contains unsorted sparse vectors whose keys are unsigned integers.
+                - all the keys in rows are < cols
+            ensures
+                - #nr() == rows.size()
+                - #nc() == cols
+                - for all valid r: row r of *this is the vector rows[r], as above.
+        !*/
+
+        template <typename EXP>
+        explicit sparse_matrix (
+            const matrix_exp<EXP>& m
+        );
+        /*!
+            requires
+                - EXP::type == T
+            ensures
+                - #nr() == m.nr()
+                - #nc() == m.nc()
+                - *this contains the nonzero elements of m.
+        !*/
+
+        long nr (
+        ) const;
+        /*!
+            ensures
+                - returns the number of rows in this matrix.
+        !*/
+
+        long nc (
+        ) const;
+        /*!
+            ensures
+                - returns the number of columns in this matrix.
+        !*/
+
+        unsigned long num_nonzero (
+        ) const;
+        /*!
+            ensures
+                - returns the number of elements actually stored in this matrix.
+        !*/
+
+        row_type row (
+            long r
+        ) const;
+        /*!
+            requires
+                - 0 <= r < nr()
+            ensures
+                - returns a sparse vector containing the stored elements of the r-th row
+                  of this matrix.  Any element not in it is 0.
+        !*/
+
+        T operator() (
+            long r,
+            long c
+        ) const;
+        /*!
+            requires
+                - 0 <= r < nr()
+                - 0 <= c < nc()
+            ensures
+                - returns the value of the element at row r and column c of this matrix.
+                  This is a binary search over the r-th row, so it's not a fast way to
+                  look at all the elements.  Use row() for that.
+        !*/
+
+        void swap (
+            sparse_matrix& item
+        );
+        /*!
+            ensures
+                - swaps *this and item
+        !*/
+    };
+
+    template <typename T>
+    void swap (
+        sparse_matrix<T>& a,
+        sparse_matrix<T>& b
+    ) { a.swap(b); }
+    /*!
+        provides a global swap function
+    !*/
+
+    template <typename T>
+    void serialize (
+        const sparse_matrix<T>& item,
+        std::ostream& out
+    );
+    /*!
+        provides serialization support
+    !*/
+
+    template <typename T>
+    void deserialize (
+        sparse_matrix<T>& item,
+        std::istream& in
+    );
+    /*!
+        provides deserialization support
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    sparse_matrix<T> trans (
+        const sparse_matrix<T>& A
+    );
+    /*!
+        ensures
+            - returns the transpose of A.  Note that this makes a new sparse_matrix, which
+              takes O(A.num_nonzero()) time.  So if you are going to multiply by trans(A)
+              many times you should compute it once and keep it around.
+    !*/
+
+    template <typename T, typename EXP>
+    matrix<T,0,EXP::NC> operator* (
+        const sparse_matrix<T>& A,
+        const matrix_exp<EXP>& X
+    );
+    /*!
+        requires
+            - EXP::type == T
+            - A.nc() == X.nr()
+        ensures
+            - returns the matrix product A*X.
+            - The rows of the result are computed in parallel using the threads in
+              default_thread_pool().  The rows are split up so that each thread gets
+              about the same number of nonzero elements of A.
+    !*/
+
+    template <typename T>
+    const matrix_exp mat (
+        const sparse_matrix<T>& A
+    );
+    /*!
+        ensures
+            - returns a matrix R such that:
+                - is_col_vector(R) == true
+                - R.size() == A.nr()
+                - for all valid r: R(r) == A.row(r)
+              That is, R is a column vector of sparse vectors, one for each row of A.
+              It is the same kind of object mat() of a std::vector of sparse vectors
+              gives, so anything expecting a set of sparse samples will accept it.
+            - R refers to A, so A must outlive R.
+    !*/
+
+    template <typename T>
+    matrix<T> sparse_to_dense (
+        const sparse_matrix<T>& A
+    );
+    /*!
+        ensures
+            - returns a dense version of A.  That is, returns a matrix M such that:
+                - M.nr() == A.nr()
+                - M.nc() == A.nc()
+                - for all valid r and c: M(r,c) == A(r,c)
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T,
+        typename MM,
+        typename L
+        >
+    void find_matrix_range (
+        const sparse_matrix<T>& A,
+        unsigned long l,
+        matrix<T,0,0,MM,L>& Q,
+        unsigned long q
+    );
+    /*!
+        requires
+            - A.nr() >= l
+        ensures
+            - This is just like the version of find_matrix_range() that takes a
+              std::vector of sparse vectors, except that A is a sparse_matrix.  If
+              A == sparse_matrix<T>(B) then both versions give the same Q, up to rounding
+              differences.  This version is faster though, since all the products with A
+              are done by the routines above.
+    !*/
+
+    template <
+        typename T,
+        long Unr, long Unc,
+        long Wnr, long Wnc,
+        long Vnr, long Vnc,
+        typename MM,
+        typename L
+        >
+    void svd_fast (
+        const sparse_matrix<T>& A,
+        matrix<T,Unr,Unc,MM,L>& u,
+        matrix<T,Wnr,Wnc,MM,L>& w,
+        matrix<T,Vnr,Vnc,MM,L>& v,
+        unsigned long l,
+        unsigned long q = 1
+    );
+    /*!
+        requires
+            - l > 0
+            - A.nr() > 0 && A.nc() > 0
+        ensures
+            - computes the singular value decomposition of A, exactly like the svd_fast()
+              overload in dlib/matrix/matrix_la_abstract.h that takes a std::vector of
+              sparse vectors.  The only difference is that A is a sparse_matrix with
+              A.nr() rows and A.nc() columns.
+    !*/
+
+    template <
+        typename T,
+        long Wnr, long Wnc,
+        long Vnr, long Vnc,
+        typename MM,
+        typename L
+        >
+    void svd_fast (
+        const sparse_matrix<T>& A,
+        matrix<T,Wnr,Wnc,MM,L>& w,
+        matrix<T,Vnr,Vnc,MM,L>& v,
+        unsigned long l,
+        unsigned long q = 1
+    );
+    /*!
+        This function is identical to the above svd_fast() except it doesn't compute u.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_SPARSE_MATRIx_ABSTRACT_H_
+
+
@@ -161,6 +161,39 @@ namespace dlib
         return impl_cca(L,R,Ltrans, Rtrans, num_correlations, extra_rank, q, num_output_correlations, regularization); 
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    matrix<T,0,1> cca (
+        const sparse_matrix<T>& L,
+        const sparse_matrix<T>& R,
+        matrix<T>& Ltrans,
+        matrix<T>& Rtrans,
+        unsigned long num_correlations,
+        unsigned long extra_rank = 5,
+        unsigned long q = 2,
+        double regularization = 0
+    )
+    {
+        DLIB_ASSERT( num_correlations > 0 && L.nr() == R.nr() && 
+                     L.nc() > 0 && R.nc() > 0 &&
+                     regularization >= 0, 
+            "\t matrix cca()"
+            << "\n\t Invalid inputs were given to this function."
+            << "\n\t num_correlations: " << num_correlations 
+            << "\n\t regularization:   " << regularization 
+            << "\n\t L.nr(): " << L.nr()
+            << "\n\t R.nr(): " << R.nr()
+            << "\n\t L.nc(): " << L.nc()
+            << "\n\t R.nc(): " << R.nc()
+            );
+
+        using std::min;
+        const unsigned long n = min(L.nc(), R.nc());
+        const unsigned long num_output_correlations = min(num_correlations, std::min<unsigned long>(R.nr(),n));
+        return impl_cca(L,R,Ltrans, Rtrans, num_correlations, extra_rank, q, num_output_correlations, regularization); 
+    }
+
 // ----------------------------------------------------------------------------------------
 
     template <typename sparse_vector_type, typename Rand_type, typename T>
@@ -149,6 +149,37 @@ namespace dlib
                 sparse_matrix_vector_multiply(trans(Ltrans), your_sparse_vector)
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    matrix<T,0,1> cca (
+        const sparse_matrix<T>& L,
+        const sparse_matrix<T>& R,
+        matrix<T>& Ltrans,
+        matrix<T>& Rtrans,
+        unsigned long num_correlations,
+        unsigned long extra_rank = 5,
+        unsigned long q = 2,
+        double regularization = 0
+    );
+    /*!
+        requires
+            - num_correlations > 0
+            - L.nr() == R.nr()
+            - L.nc() > 0 && R.nc() > 0
+            - regularization >= 0
+        ensures
+            - This is just an overload of the cca() function defined above.  Except in this
+              case L and R are sparse_matrix objects (see dlib/matrix/sparse_matrix_abstract.h),
+              which makes the products with L and R much faster than with a std::vector of
+              sparse vectors.  Ltrans has L.nc() rows and Rtrans has R.nc() rows.
+            - If L == sparse_matrix<T>(L2) and R == sparse_matrix<T>(R2), for some
+              std::vectors of sparse vectors L2 and R2, then this function does the same
+              thing as cca(L2,R2,Ltrans,Rtrans,num_correlations,extra_rank,q,regularization).
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -672,9 +672,10 @@ namespace dlib
             return df;
         }
 
+        template <typename T>
         scalar_type dot (
             const scalar_vector_type& w,
-            const sample_type& sample
+            const T& sample
         ) const
         {
             if (have_bias && !last_weight_1)
@@ -41,6 +41,48 @@ namespace
         return max_error;
     }
 
+// ----------------------------------------------------------------------------------------
+
+    std::vector<matrix<rgb_pixel>> make_random_rgb_images (
+        size_t num_images,
+        long nr,
+        long nc,
+        dlib::rand& rnd
+    )
+    {
+        std::vector<matrix<rgb_pixel>> images(num_images, matrix<rgb_pixel>(nr,nc));
+        for (auto& img : images)
+            for (auto& p : img)
+                p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+        return images;
+    }
+
+    template <typename net_type>
+    void randomize_small_parameters (
+        net_type& net,
+        const std::vector<matrix<rgb_pixel>>& images,
+        size_t max_size,
+        dlib::rand& rnd
+    )
+    /*!
+        Gives every parameter tensor of net with fewer than max_size elements, such as
+        those of the bn_ layers but not the filters, random values in [0.5,1.5).  Then
+        runs net on images so the running statistics of its bn_con layers aren't
+        identity transforms either.  With a single sample the bn_con layers use their
+        running statistics, so that's how to get outputs that don't depend on the batch.
+    !*/
+    {
+        // The layers allocate their parameters on the first forward pass.  Doing that on
+        // a single sample leaves the running statistics alone, so the batch after the
+        // parameters are set is the only one they come from.
+        resizable_tensor x;
+        net.to_tensor(images.begin(), images.begin()+1, x);
+        net.subnet().forward(x);
+        visit_layer_parameters(net, [&](size_t, tensor& t) { if (t.size() != 0 && t.size() < max_size) t = matrix_cast<float>(randm(t.num_samples(), t.size()/t.num_samples(), rnd))+0.5; });
+        net.to_tensor(images.begin(), images.end(), x);
+        net.subnet().forward(x);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     void test_tanh()
@@ -993,6 +1035,50 @@ namespace
         DLIB_TEST_MSG(max(abs(mat(v)-mat(vv))) < 1e-6, max(abs(mat(v)-mat(vv))));
     }
 
+    void compare_fused_solvers()
+    {
+        float t = 2;
+        tt::tensor_rand rnd;
+        resizable_tensor s, m, v, params, params_grad;
+        s.set_size(89,90,60,7);
+        m.copy_size(s);
+        v.copy_size(s);
+        params.copy_size(s);
+        params_grad.copy_size(s);
+        rnd.fill_uniform(m);
+        rnd.fill_uniform(v);
+        rnd.fill_uniform(params);
+        rnd.fill_uniform(params_grad);
+        const size_t begin = 11;
+        const size_t end = params.size()-1000;
+
+        for (int which = 0; which < 3; ++which)
+        {
+            resizable_tensor mm(m), vv(v), m2(m), v2(v), sums;
+            rnd.fill_uniform(s);
+            if (which == 0)
+                cpu::compute_adamw_update(begin,end,s, mm, vv, t, 0.01, 0.01, 0.9, 0.99, params, params_grad);
+            else if (which == 1)
+                cpu::compute_lamb_update(begin,end,s, mm, vv, t, 0.01, 0.01, 0.9, 0.99, params, params_grad, sums);
+            else
+                cpu::compute_nesterov_update(begin,end,s, vv, 0.01, 0.001, 0.9, params, params_grad);
+            matrix<float> s1 = rowm(mat(s), range(begin,end-1));
+
+            rnd.fill_uniform(s);
+            if (which == 0)
+                cuda::compute_adamw_update(begin,end,s, m2, v2, t, 0.01, 0.01, 0.9, 0.99, params, params_grad);
+            else if (which == 1)
+                cuda::compute_lamb_update(begin,end,s, m2, v2, t, 0.01, 0.01, 0.9, 0.99, params, params_grad, sums);
+            else
+                cuda::compute_nesterov_update(begin,end,s, v2, 0.01, 0.001, 0.9, params, params_grad);
+            matrix<float> s2 = rowm(mat(s), range(begin,end-1));
+
+            DLIB_TEST_MSG(max(abs(s1-s2)) < 1e-6, max(abs(s1-s2)));
+            DLIB_TEST_MSG(max(abs(mat(m2)-mat(mm))) < 1e-6, max(abs(mat(m2)-mat(mm))));
+            DLIB_TEST_MSG(max(abs(mat(v2)-mat(vv))) < 1e-6, max(abs(mat(v2)-mat(vv))));
+        }
+    }
+
     void test_multiply_zero_padded()
     {
         print_spinner();
@@ -1497,6 +1583,1563 @@ namespace
 
 // ----------------------------------------------------------------------------------------
 
+    void test_cpu_conv_algorithms()
+    {
+        // Check that the direct and Winograd convolution kernels produce the same results
+        // as the img2col based implementation.
+        print_spinner();
+        cpu::tensor_conv conv;
+        tt::tensor_rand rnd;
+        dlib::rand prnd;
+
+        const cpu_conv_algorithm algos[] = {cpu_conv_algorithm::direct, cpu_conv_algorithm::winograd, cpu_conv_algorithm::automatic};
+        for (int iter = 0; iter < 100; ++iter)
+        {
+            resizable_tensor data(prnd.get_random_32bit_number()%3+1,
+                prnd.get_random_32bit_number()%12+1,
+                prnd.get_random_32bit_number()%20+5,
+                prnd.get_random_32bit_number()%20+5
+            );
+            const long filter_sizes[] = {1, 3, 5};
+            const long fnr = filter_sizes[iter%3];
+            const long fnc = (iter%4 == 0) ? filter_sizes[(iter/3)%3] : fnr;
+            resizable_tensor filters(prnd.get_random_32bit_number()%12+1, data.k(), fnr, fnc);
+            rnd.fill_uniform(data);
+            rnd.fill_uniform(filters);
+
+            const int stride_y = (iter%2 == 0) ? 1 : prnd.get_random_32bit_number()%3+1;
+            const int stride_x = (iter%2 == 0) ? 1 : prnd.get_random_32bit_number()%3+1;
+            const int padding_y = prnd.get_random_32bit_number()%(fnr/2+1);
+            const int padding_x = prnd.get_random_32bit_number()%(fnc/2+1);
+            conv.setup(data,filters,stride_y,stride_x,padding_y,padding_x);
+
+            resizable_tensor truth, output;
+            set_dnn_cpu_conv_algorithm(cpu_conv_algorithm::img2col);
+            conv(false, truth, data, filters);
+
+            for (auto algo : algos)
+            {
+                set_dnn_cpu_conv_algorithm(algo);
+                output.copy_size(truth);
+                output = 1;
+                conv(false, output, data, filters);
+                DLIB_TEST_MSG(max(abs(mat(truth)-mat(output))) < 1e-3, max(abs(mat(truth)-mat(output))));
+                conv(true, output, data, filters);
+                DLIB_TEST_MSG(max(abs(2*mat(truth)-mat(output))) < 1e-3, max(abs(2*mat(truth)-mat(output))));
+            }
+
+            resizable_tensor gi, data_gradient1, data_gradient2, filter_gradient1, filter_gradient2;
+            gi.copy_size(truth);
+            rnd.fill_uniform(gi);
+            data_gradient1.copy_size(data);
+            data_gradient2.copy_size(data);
+            data_gradient1 = 1;
+            data_gradient2 = 1;
+            filter_gradient1.copy_size(filters);
+            filter_gradient2.copy_size(filters);
+            filter_gradient1 = 1;
+            filter_gradient2 = 1;
+
+            set_dnn_cpu_conv_algorithm(cpu_conv_algorithm::img2col);
+            conv.get_gradient_for_data(true, gi, filters, data_gradient1);
+            conv.get_gradient_for_filters(true, gi, data, filter_gradient1);
+            set_dnn_cpu_conv_algorithm(cpu_conv_algorithm::automatic);
+            conv.get_gradient_for_data(true, gi, filters, data_gradient2);
+            conv.get_gradient_for_filters(true, gi, data, filter_gradient2);
+            DLIB_TEST(max(abs(mat(data_gradient1)-mat(data_gradient2))) < 1e-3);
+            DLIB_TEST(max(abs(mat(filter_gradient1)-mat(filter_gradient2))) < 1e-3);
+
+            set_dnn_cpu_conv_algorithm(cpu_conv_algorithm::img2col);
+            conv.get_gradient_for_filters(false, gi, data, filter_gradient1);
+            set_dnn_cpu_conv_algorithm(cpu_conv_algorithm::automatic);
+            conv.get_gradient_for_filters(false, gi, data, filter_gradient2);
+            DLIB_TEST(max(abs(mat(filter_gradient1)-mat(filter_gradient2))) < 1e-3);
+        }
+
+        // Only unpadded, unstrided 1x1 convolutions are plain matrix multiplies.
+        // tensor_conv requires the padding to be smaller than the filter, so a 1x1
+        // filter can't be padded.  Check the closest cases it does allow instead: a
+        // strided 1x1 filter and filters that are 1 wide in one dimension and padded in
+        // the other.
+        const long shapes[][6] = {
+            // k, fnr, fnc, stride, padding_y, padding_x
+            {2,  1, 1, 2, 0, 0},
+            {16, 1, 1, 2, 0, 0},
+            {2,  1, 3, 1, 0, 1},
+            {16, 1, 3, 1, 0, 1},
+            {2,  3, 1, 1, 1, 0},
+            {16, 3, 1, 1, 1, 0}
+        };
+        for (auto& shape : shapes)
+        {
+            resizable_tensor data(2, shape[0], 7, 9);
+            resizable_tensor filters(5, shape[0], shape[1], shape[2]);
+            rnd.fill_uniform(data);
+            rnd.fill_uniform(filters);
+            conv.setup(data,filters,shape[3],shape[3],shape[4],shape[5]);
+
+            resizable_tensor truth, output;
+            set_dnn_cpu_conv_algorithm(cpu_conv_algorithm::img2col);
+            conv(false, truth, data, filters);
+            for (auto algo : algos)
+            {
+                set_dnn_cpu_conv_algorithm(algo);
+                output.copy_size(truth);
+                output = 1;
+                conv(false, output, data, filters);
+                DLIB_TEST_MSG(max(abs(mat(truth)-mat(output))) < 1e-4, max(abs(mat(truth)-mat(output))));
+            }
+        }
+        set_dnn_cpu_conv_algorithm(cpu_conv_algorithm::automatic);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_cpu_threading()
+    {
+        // The CPU kernels split large tensors across threads.  Make sure that gives the
+        // same answers as running everything in a single thread.
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<10,relu<bn_con<max_pool<2,2,2,2,
+                         prelu<bn_con<con<16,3,3,1,1,input_rgb_image>>>>>>>>;
+        net_type net;
+        dlib::rand rnd;
+        std::vector<matrix<rgb_pixel>> images = make_random_rgb_images(4, 48, 48, rnd);
+        std::vector<unsigned long> labels = {1,2,3,4};
+
+        resizable_tensor x;
+        net.to_tensor(images.begin(), images.end(), x);
+
+        const size_t orig_num_threads = dnn_cpu_num_threads();
+
+        set_dnn_cpu_num_threads(1);
+        const double loss1 = net.compute_parameter_gradients(x, labels.begin());
+        const matrix<float> out1 = mat(net.subnet().get_output());
+        const matrix<float> grad1 = mat(layer<5>(net).get_parameter_gradient());
+        const matrix<float> grad2 = mat(layer<7>(net).get_parameter_gradient());
+
+        set_dnn_cpu_num_threads(4);
+        DLIB_TEST(dnn_cpu_num_threads() == 4);
+        const double loss2 = net.compute_parameter_gradients(x, labels.begin());
+        DLIB_TEST(std::abs(loss1-loss2) < 1e-4);
+        DLIB_TEST(max(abs(out1-mat(net.subnet().get_output()))) < 1e-4);
+        DLIB_TEST(max(abs(grad1-mat(layer<5>(net).get_parameter_gradient()))) < 1e-4);
+        DLIB_TEST(max(abs(grad2-mat(layer<7>(net).get_parameter_gradient()))) < 1e-4);
+
+        set_dnn_cpu_num_threads(orig_num_threads);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_cpu_threaded_gemm()
+    {
+        // Big products in tt::gemm() are split over the threads picked by
+        // set_dnn_cpu_num_threads(), and should come out the same however many there are.
+        print_spinner();
+        resizable_tensor lhs(300,200), rhs(200,100), lhs_t(200,300), rhs_t(100,200);
+        tt::tensor_rand rnd(0);
+        rnd.fill_uniform(lhs);
+        rnd.fill_uniform(rhs);
+        lhs_t = trans(mat(lhs));
+        rhs_t = trans(mat(rhs));
+        resizable_tensor init(300,100);
+        rnd.fill_uniform(init);
+        const matrix<float> truth = 2*mat(lhs)*mat(rhs) + 0.5*mat(init);
+
+        const size_t orig_num_threads = dnn_cpu_num_threads();
+        for (bool trans_lhs : {false, true})
+        {
+            for (bool trans_rhs : {false, true})
+            {
+                const tensor& l = trans_lhs ? lhs_t : lhs;
+                const tensor& r = trans_rhs ? rhs_t : rhs;
+                resizable_tensor dest1, dest2;
+                dest1 = mat(init);
+                dest2 = mat(init);
+
+                set_dnn_cpu_num_threads(1);
+                tt::gemm(0.5, dest1, 2, l, trans_lhs, r, trans_rhs);
+                set_dnn_cpu_num_threads(4);
+                tt::gemm(0.5, dest2, 2, l, trans_lhs, r, trans_rhs);
+
+                DLIB_TEST(mat(dest1) == mat(dest2));
+                DLIB_TEST_MSG(max(abs(mat(dest1) - truth)) < 1e-3, max(abs(mat(dest1) - truth)));
+            }
+        }
+        set_dnn_cpu_num_threads(orig_num_threads);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_quantized_net()
+    {
+        // Check that quantize_network() closely approximates the float network, including
+        // folding affine_, bn_ and relu_ layers and following tag and skip layers.
+        print_spinner();
+        using net_type = loss_metric<fc<16,avg_pool_everything<
+                         relu<add_prev1<affine<con<16,3,3,1,1,relu<bn_con<con<16,3,3,1,1,
+                         skip1<tag3<relu<tag1<max_pool<2,2,2,2,tag2<relu<bn_con<con<16,5,5,2,2,
+                         input_rgb_image>>>>>>>>>>>>>>>>>>>;
+        net_type net;
+        // Use the kind of affine_ you get from converting a bn_con.
+        layer<5>(net).layer_details() = affine_(CONV_MODE);
+
+        dlib::rand rnd;
+        std::vector<matrix<rgb_pixel>> images = make_random_rgb_images(20, 40, 40, rnd);
+
+        // Give the affine_ and bn_ layers something other than an identity transform to fold.
+        randomize_small_parameters(net, images, 100, rnd);
+        layer<5>(net).layer_details().get_gamma() = matrix_cast<float>(randm(1,16,rnd))+0.5;
+        layer<5>(net).layer_details().get_beta() = matrix_cast<float>(randm(1,16,rnd))-0.5;
+
+        quantized_net qnet = quantize_network(net, images.begin(), images.end(), 8);
+        DLIB_TEST(qnet.num_quantized_layers() == 4);
+        // The affine_, bn_ and relu_ layers after each con_ are folded into it and the
+        // relu_ after add_prev_ into that, leaving the 4 quantized layers, max_pool, the
+        // relu that follows it, add_prev and avg_pool.
+        DLIB_TEST_MSG(qnet.num_ops() == 8, qnet);
+
+        resizable_tensor x;
+        net.to_tensor(images.begin(), images.end(), x);
+        const matrix<float> expected = mat(net.subnet().forward(x));
+        const matrix<float> out = mat(qnet.forward(x));
+        DLIB_TEST(out.nr() == expected.nr() && out.nc() == expected.nc());
+        const double err = max(abs(out-expected))/max(abs(expected));
+        DLIB_TEST_MSG(err < 0.05, err);
+
+
+        std::ostringstream sout;
+        serialize(qnet, sout);
+        std::istringstream sin(sout.str());
+        quantized_net qnet2;
+        deserialize(qnet2, sin);
+        DLIB_TEST(max(abs(mat(qnet2.forward(x))-out)) == 0);
+
+        // On integer valued inputs that fit in 7 bits quantized_conv() should do the same
+        // thing as a float convolution.
+        resizable_tensor data(2,3,9,8), filters(5,3,3,3), expected_out, out2;
+        for (auto& v : filters)
+            v = (int)(rnd.get_random_32bit_number()%255)-127;
+        const long filter_stride = 32;
+        std::vector<std::int8_t> qfilters(5*filter_stride, 0);
+        for (long f = 0; f < 5; ++f)
+            for (long j = 0; j < 27; ++j)
+                qfilters[f*filter_stride+j] = filters.host()[f*27+j];
+        const std::vector<float> scales(5, 0.5f), biases(5, 3);
+        for (long offset : {0, 64})
+        {
+            for (auto& v : data)
+                v = (int)(rnd.get_random_32bit_number()%128)-offset;
+            for (int stride = 1; stride <= 2; ++stride)
+            {
+                cpu::tensor_conv conv;
+                conv.setup(data, filters, stride, stride, 1, 1);
+                conv(false, expected_out, data, filters);
+                cpu::quantized_conv(out2, data, 1, offset, &qfilters[0], filter_stride, &scales[0], &biases[0], 5, 3, 3, stride, stride, 1, 1, false);
+                DLIB_TEST(max(abs(mat(out2) - (mat(expected_out)*0.5f+3))) < 1e-6*max(abs(mat(expected_out))));
+            }
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_inference_net()
+    {
+        // Check that compile_for_inference() computes the same thing as the network it
+        // was made from.
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<5,relu<fc<10,avg_pool_everything<
+                         relu<add_prev1<bn_con<con<8,3,3,1,1,relu<bn_con<con<8,3,3,1,1,
+                         tag1<relu<bn_con<con<8,3,3,2,2,
+                         input_rgb_image>>>>>>>>>>>>>>>>;
+        net_type net;
+
+        dlib::rand rnd;
+        std::vector<matrix<rgb_pixel>> images = make_random_rgb_images(6, 20, 20, rnd);
+
+        randomize_small_parameters(net, images, 100, rnd);
+        resizable_tensor x;
+        net.to_tensor(images.begin(), images.end(), x);
+
+        inference_net inet = compile_for_inference(net);
+        // Each con_ absorbs its bn_con and relu, add_prev absorbs the relu after it and
+        // so does the first fc.
+        DLIB_TEST_MSG(inet.num_ops() == 7, inet);
+
+        const matrix<float> out = mat(inet.forward(x));
+        // The most memory is needed by add_prev, which reads two of the 8x9x9 con outputs
+        // and writes a third.  Everything else fits in the space they leave.
+        DLIB_TEST_MSG(inet.peak_memory_usage() == 3*x.num_samples()*8*9*9*sizeof(float), inet.peak_memory_usage());
+        DLIB_TEST(out.nr() == (long)images.size() && out.nc() == 5);
+        for (size_t i = 0; i < images.size(); ++i)
+        {
+            resizable_tensor xi;
+            net.to_tensor(images.begin()+i, images.begin()+i+1, xi);
+            const matrix<float> expected = mat(net.subnet().forward(xi));
+            DLIB_TEST_MSG(max(abs(rowm(out,i)-expected)) < 1e-4*max(abs(expected)), max(abs(rowm(out,i)-expected)));
+            // This also makes inet plan its memory again for the smaller input.
+            DLIB_TEST(max(abs(mat(inet.forward(xi))-expected)) < 1e-4*max(abs(expected)));
+        }
+
+        std::ostringstream sout;
+        serialize(inet, sout);
+        std::istringstream sin(sout.str());
+        inference_net inet2;
+        deserialize(inet2, sin);
+        DLIB_TEST(max(abs(mat(inet2.forward(x))-out)) == 0);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_shared_inference_net()
+    {
+        // Check that shared_inference_net gives the same labels as the network it was
+        // made from, even when several threads use it at once.
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<3,relu<bn_con<con<4,3,3,1,1,input_rgb_image>>>>>;
+        net_type net;
+
+        dlib::rand rnd;
+        std::vector<matrix<rgb_pixel>> images = make_random_rgb_images(40, 8, 8, rnd);
+
+        resizable_tensor x;
+        net.to_tensor(images.begin(), images.end(), x);
+        net.subnet().forward(x);
+
+        // Run the images one at a time so the bn_con layer uses its running statistics.
+        std::vector<unsigned long> expected;
+        for (auto& img : images)
+            expected.push_back(net(img));
+
+        shared_inference_net<net_type> snet(net);
+        std::vector<std::vector<unsigned long>> results(4);
+        thread_pool tp(4);
+        parallel_for(tp, 0, results.size(), [&](long i) { results[i] = snet(images, 3+i); });
+        for (auto& labels : results)
+            DLIB_TEST(labels == expected);
+        DLIB_TEST(snet.num_contexts() >= 1 && snet.num_contexts() <= results.size());
+        DLIB_TEST(snet(images[5]) == expected[5]);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_inference_batcher()
+    {
+        // Submit requests from several threads and check they come back with the same
+        // labels the network gives and that every request is accounted for in the stats.
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<3,relu<bn_con<con<4,3,3,1,1,input_rgb_image>>>>>;
+        net_type net;
+
+        dlib::rand rnd;
+        std::vector<matrix<rgb_pixel>> images = make_random_rgb_images(40, 8, 8, rnd);
+
+        resizable_tensor x;
+        net.to_tensor(images.begin(), images.end(), x);
+        net.subnet().forward(x);
+
+        std::vector<unsigned long> expected;
+        for (auto& img : images)
+            expected.push_back(net(img));
+
+        inference_batcher<net_type> batcher(net, 8, std::chrono::milliseconds(2), 2);
+        std::vector<unsigned long> labels(images.size());
+        thread_pool tp(4);
+        parallel_for(tp, 0, 4, [&](long t)
+        {
+            std::vector<std::future<unsigned long>> results;
+            for (size_t i = t; i < images.size(); i += 4)
+                results.push_back(batcher.submit(images[i]));
+            for (size_t i = t, j = 0; i < images.size(); i += 4, ++j)
+                labels[i] = results[j].get();
+        });
+        DLIB_TEST(labels == expected);
+        DLIB_TEST(batcher(images[7]) == expected[7]);
+
+        const auto stats = batcher.get_stats();
+        DLIB_TEST(stats.num_requests == images.size()+1);
+        DLIB_TEST(stats.batch_size_histogram.size() == 9);
+        size_t num_batches = 0, num_requests = 0;
+        for (size_t i = 0; i < stats.batch_size_histogram.size(); ++i)
+        {
+            num_batches += stats.batch_size_histogram[i];
+            num_requests += i*stats.batch_size_histogram[i];
+        }
+        DLIB_TEST(num_batches == stats.num_batches);
+        DLIB_TEST(num_requests == stats.num_requests);
+        DLIB_TEST(stats.latency_p50 <= stats.latency_p99 && stats.latency_p99 <= stats.latency_max);
+        DLIB_TEST(batcher.num_pending() == 0);
+
+        batcher.clear_stats();
+        DLIB_TEST(batcher.get_stats().num_requests == 0);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_mapped_network()
+    {
+        // A network saved with save_mapped_network() and loaded with
+        // load_mapped_network() must be identical to the original, even though its
+        // parameters now live in the mapped file.
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<3,prelu<add_prev1<bn_con<con<4,3,3,1,1,tag1<relu<con<4,3,3,1,1,input_rgb_image>>>>>>>>>;
+        net_type net;
+
+        dlib::rand rnd;
+        std::vector<matrix<rgb_pixel>> images = make_random_rgb_images(4, 8, 8, rnd);
+        resizable_tensor x;
+        net.to_tensor(images.begin(), images.end(), x);
+        net.subnet().forward(x);
+        const matrix<float> out = mat(net.subnet().get_output());
+
+        std::ostringstream sout;
+        serialize(net, sout);
+        save_mapped_network(net, "dnn_mapped_network.dnet");
+
+        {
+            net_type net2;
+            load_mapped_network(net2, "dnn_mapped_network.dnet");
+            std::ostringstream sout2;
+            serialize(net2, sout2);
+            DLIB_TEST(sout.str() == sout2.str());
+            net2.subnet().forward(x);
+            DLIB_TEST(max(abs(mat(net2.subnet().get_output()) - out)) == 0);
+
+            // Writing to the parameters of a loaded network must not change the file.
+            visit_layer_parameters(net2, [](size_t, tensor& t) { t = 0; });
+        }
+
+        net_type net3;
+        load_mapped_network(net3, "dnn_mapped_network.dnet");
+        std::ostringstream sout3;
+        serialize(net3, sout3);
+        DLIB_TEST(sout.str() == sout3.str());
+
+#ifndef DLIB_USE_CUDA
+        // The parameters use the mapped file as their memory, so loading the network
+        // shouldn't allocate host memory for them.
+        {
+            size_t num_params = 0;
+            visit_layer_parameters(net, [&](size_t, tensor& t) { if (t.size() != 0) ++num_params; });
+            size_t before = get_host_memory_pool_stats().num_allocations;
+            net_type net4;
+            std::istringstream sin(sout.str());
+            deserialize(net4, sin);
+            const size_t num_deserialize_allocations = get_host_memory_pool_stats().num_allocations - before;
+            before = get_host_memory_pool_stats().num_allocations;
+            net_type net5;
+            load_mapped_network(net5, "dnn_mapped_network.dnet");
+            const size_t num_mapped_allocations = get_host_memory_pool_stats().num_allocations - before;
+            DLIB_TEST(num_params > 0);
+            DLIB_TEST(num_mapped_allocations + num_params <= num_deserialize_allocations);
+        }
+#endif
+
+        using other_net_type = loss_multiclass_log<fc<3,input_rgb_image>>;
+        other_net_type other;
+        bool threw = false;
+        try { load_mapped_network(other, "dnn_mapped_network.dnet"); }
+        catch (serialization_error&) { threw = true; }
+        DLIB_TEST(threw);
+
+        // An ordinary serialized network isn't a mapped network file.
+        {
+            std::ofstream fout("dnn_mapped_network.dnet", std::ios::binary);
+            serialize(net, fout);
+        }
+        threw = false;
+        try { load_mapped_network(net3, "dnn_mapped_network.dnet"); }
+        catch (serialization_error&) { threw = true; }
+        DLIB_TEST(threw);
+
+        // Corrupt tensor offsets must be rejected rather than giving misaligned or out of
+        // bounds pointers.  So rewrite the header of a good file with bad offsets.
+        save_mapped_network(net, "dnn_mapped_network.dnet");
+        std::string contents;
+        {
+            std::ifstream fin("dnn_mapped_network.dnet", std::ios::binary);
+            contents.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+        }
+        const size_t preamble_size = sizeof(impl::mapped_network_magic) + sizeof(uint64);
+        byte_orderer bo;
+        uint64 header_size;
+        std::memcpy(&header_size, &contents[sizeof(impl::mapped_network_magic)], sizeof(header_size));
+        bo.little_to_host(header_size);
+        std::istringstream sin(contents.substr(preamble_size, header_size));
+        int version;
+        net_type header_net;
+        std::vector<impl::mapped_tensor_info> infos;
+        deserialize(version, sin);
+        deserialize(header_net, sin);
+        deserialize(infos, sin);
+        const std::string data = contents.substr(impl::align_to_mapped_network(preamble_size + header_size));
+        for (uint64 bad_offset : {infos[1].offset+2, std::numeric_limits<uint64>::max()-3, (uint64)data.size()})
+        {
+            auto bad_infos = infos;
+            bad_infos[1].offset = bad_offset;
+            std::ostringstream sout;
+            serialize(version, sout);
+            serialize(header_net, sout);
+            serialize(bad_infos, sout);
+            const std::string header = sout.str();
+            const std::string padding(impl::align_to_mapped_network(preamble_size + header.size()) - preamble_size - header.size(), 0);
+            uint64 bad_header_size = header.size();
+            bo.host_to_little(bad_header_size);
+            std::ofstream fout("dnn_mapped_network.dnet", std::ios::binary);
+            fout.write(impl::mapped_network_magic, sizeof(impl::mapped_network_magic));
+            fout.write((const char*)&bad_header_size, sizeof(bad_header_size));
+            fout.write(header.data(), header.size());
+            fout.write(padding.data(), padding.size());
+            fout.write(data.data(), data.size());
+            fout.close();
+
+            threw = false;
+            try { load_mapped_network(net3, "dnn_mapped_network.dnet"); }
+            catch (serialization_error&) { threw = true; }
+            DLIB_TEST(threw);
+        }
+
+        std::remove("dnn_mapped_network.dnet");
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_dnn_profiler()
+    {
+        // The profiler should see every forward, backward and update of each layer of
+        // the network it was made for, and ignore other networks.
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<3,relu<add_prev1<con<4,3,3,1,1,tag1<relu<con<4,3,3,1,1,input_rgb_image>>>>>>>>;
+        net_type net, other_net;
+
+        dlib::rand rnd;
+        std::vector<matrix<rgb_pixel>> images = make_random_rgb_images(4, 8, 8, rnd);
+        std::vector<unsigned long> labels = {0, 1, 2, 0};
+
+        dnn_profiler<net_type> prof(net);
+        DLIB_TEST(!prof.is_running());
+        auto profiles = prof.get_layer_profiles();
+        // The loss, fc, relu, add_prev, con, relu and con layers.
+        DLIB_TEST(profiles.size() == 7);
+        DLIB_TEST(profiles[0].index == 0 && profiles[0].name == "loss_multiclass_log");
+        DLIB_TEST(profiles[1].index == 1 && profiles[1].name == "fc");
+        DLIB_TEST(profiles[4].index == 4 && profiles[4].name == "con");
+        DLIB_TEST(profiles[5].index == 6 && profiles[5].name == "relu");
+
+        prof.start();
+        DLIB_TEST(prof.is_running());
+        dnn_profiler<net_type> prof2(other_net);
+        bool threw = false;
+        try { prof2.start(); } catch (dlib::error&) { threw = true; }
+        DLIB_TEST(threw);
+
+        dnn_trainer<net_type> trainer(net, sgd(), {0});
+        for (int i = 0; i < 3; ++i)
+            trainer.train_one_step(images, labels);
+        trainer.get_net();
+        other_net(images[0]);
+        prof.stop();
+        net(images[0]);
+
+        profiles = prof.get_layer_profiles();
+        DLIB_TEST(profiles[0].forward.count == 3);
+        DLIB_TEST(profiles[0].num_samples == 4 && profiles[0].k == 3);
+        for (size_t i = 1; i < profiles.size(); ++i)
+        {
+            DLIB_TEST(profiles[i].forward.count == 3);
+            DLIB_TEST(profiles[i].backward.count == 3);
+            DLIB_TEST(profiles[i].num_samples == 4);
+        }
+        DLIB_TEST(profiles[1].update.count == 3 && profiles[1].k == 3);
+        DLIB_TEST(profiles[2].update.count == 0);
+        // 4 samples, 4 filters of 3x3x3 weights, applied at 8x8 places, 2 flops each.
+        DLIB_TEST(profiles[6].forward_flops == 2.0*4*4*8*8*3*3*3);
+        DLIB_TEST(prof.num_trace_events() == 3*(1 + 2*6) + 3*3);
+
+        std::ostringstream sout;
+        prof.write_chrome_trace(sout);
+        DLIB_TEST(sout.str().find("\"traceEvents\"") != std::string::npos);
+        sout.str("");
+        sout << prof;
+        DLIB_TEST(sout.str().find("loss_multiclass_log") != std::string::npos);
+
+        prof.clear();
+        DLIB_TEST(prof.num_trace_events() == 0);
+        DLIB_TEST(prof.get_layer_profiles()[1].forward.count == 0);
+
+        // Stopping or destroying a profiler while another thread is in the middle of a
+        // layer must wait for that layer, so nothing gets recorded into a profiler that's
+        // stopped or gone.
+        net_type net3;
+        std::atomic<bool> done(false);
+        std::thread runner([&]() { while (!done) net3(images[0]); });
+        for (int i = 0; i < 20; ++i)
+        {
+            dnn_profiler<net_type> prof3(net3);
+            prof3.start();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            prof3.stop();
+            const size_t num_events = prof3.num_trace_events();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            DLIB_TEST(prof3.num_trace_events() == num_events);
+            prof3.start();
+        }
+        done = true;
+        runner.join();
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_dnn_data_loader()
+    {
+        // Training from a dnn_data_loader with one worker should give exactly the same
+        // network as training on the same samples passed to train_one_step() directly.
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<2,relu<con<4,3,3,1,1,input_rgb_image>>>>;
+        auto make_sample = [](matrix<rgb_pixel>& img, unsigned long& label, dlib::rand& rnd)
+        {
+            label = rnd.get_random_32bit_number()%2;
+            img.set_size(6,6);
+            for (auto& p : img)
+            {
+                const unsigned char v = label*128 + rnd.get_random_8bit_number()%128;
+                p = rgb_pixel(v, v, v);
+            }
+        };
+
+        // Start both networks from the same random initialization.
+        net_type net1, net2;
+        {
+            matrix<rgb_pixel> img;
+            unsigned long label;
+            dlib::rand rnd;
+            make_sample(img, label, rnd);
+            net_type init;
+            init(img);
+            net1 = init;
+            net2 = init;
+        }
+        dnn_trainer<net_type> trainer1(net1, sgd(), {0});
+        dnn_trainer<net_type> trainer2(net2, sgd(), {0});
+        trainer1.set_learning_rate(0.01);
+        trainer2.set_learning_rate(0.01);
+
+        dnn_data_loader<net_type> loader(net1, make_sample, 8, 1, 2, 5);
+        DLIB_TEST(loader.get_mini_batch_size() == 8);
+        DLIB_TEST(loader.num_workers() == 1);
+        DLIB_TEST(loader.num_prefetch() == 2);
+
+        dlib::rand rnd(5);
+        std::vector<matrix<rgb_pixel>> images(8);
+        std::vector<unsigned long> labels(8);
+        for (int iter = 0; iter < 20; ++iter)
+        {
+            trainer1.train_one_step(loader);
+            for (size_t i = 0; i < images.size(); ++i)
+                make_sample(images[i], labels[i], rnd);
+            trainer2.train_one_step(images, labels);
+        }
+        trainer1.test_one_step(loader);
+        for (size_t i = 0; i < images.size(); ++i)
+            make_sample(images[i], labels[i], rnd);
+        trainer2.test_one_step(images, labels);
+
+        DLIB_TEST(trainer1.get_train_one_step_calls() == 20);
+        DLIB_TEST(trainer1.get_test_one_step_calls() == 1);
+        DLIB_TEST(trainer1.get_average_loss() == trainer2.get_average_loss());
+        DLIB_TEST(trainer1.get_average_test_loss() == trainer2.get_average_test_loss());
+        trainer1.get_net();
+        trainer2.get_net();
+        DLIB_TEST(max(abs(mat(layer<1>(net1).layer_details().get_layer_params()) -
+                          mat(layer<1>(net2).layer_details().get_layer_params()))) == 0);
+
+        DLIB_TEST(loader.get_num_mini_batches() == 21);
+        DLIB_TEST(loader.get_num_stalls() <= 21);
+        DLIB_TEST(loader.get_total_stall_seconds() >= 0);
+        loader.clear_stats();
+        DLIB_TEST(loader.get_num_mini_batches() == 0);
+        DLIB_TEST(loader.get_num_stalls() == 0);
+
+        // Several workers
+        dnn_data_loader<net_type> loader4(net1, make_sample, 3, 4, 1);
+        dnn_data_loader<net_type>::mini_batch batch;
+        for (int i = 0; i < 10; ++i)
+        {
+            loader4.get_next(batch);
+            DLIB_TEST(batch.samples.size() == 3);
+            DLIB_TEST(batch.labels.size() == 3);
+            DLIB_TEST(batch.data.num_samples() == 3);
+            DLIB_TEST(batch.data.k() == 3 && batch.data.nr() == 6 && batch.data.nc() == 6);
+        }
+        DLIB_TEST(loader4.get_num_mini_batches() == 10);
+
+        // A network that has never seen to_tensor() can be trained from a loader too.
+        net_type net3;
+        dnn_trainer<net_type> trainer3(net3, sgd(), {0});
+        trainer3.train_one_step(loader4);
+        trainer3.get_net();
+        DLIB_TEST(net3.sample_expansion_factor() == 1);
+        DLIB_TEST(loader4.get_num_mini_batches() == 11);
+
+        // Exceptions thrown by the generator come out of get_next().
+        int count = 0;
+        std::mutex m;
+        dnn_data_loader<net_type> bad_loader(net1, [&](matrix<rgb_pixel>& img, unsigned long& label, dlib::rand& rnd)
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (++count > 5)
+                throw std::runtime_error("bad sample");
+            make_sample(img, label, rnd);
+        }, 4, 2);
+        int num_ok = 0;
+        for (int i = 0; i < 2; ++i)
+        {
+            try
+            {
+                bad_loader.get_next(batch);
+                ++num_ok;
+            }
+            catch (std::runtime_error& e)
+            {
+                DLIB_TEST(std::string(e.what()) == "bad sample");
+            }
+        }
+        DLIB_TEST(num_ok <= 1);
+        bool threw = false;
+        try { trainer1.train_one_step(bad_loader); } catch (std::runtime_error&) { threw = true; }
+        DLIB_TEST(threw);
+        DLIB_TEST(trainer1.get_train_one_step_calls() == 20);
+    }
+
+    void test_host_memory_pool()
+    {
+#ifndef DLIB_USE_CUDA
+        print_spinner();
+        const size_t max_cached = get_host_memory_pool_max_cached_bytes();
+        trim_host_memory_pool();
+        clear_host_memory_pool_stats();
+        auto stats = get_host_memory_pool_stats();
+        DLIB_TEST(stats.bytes_cached == 0);
+        DLIB_TEST(stats.num_allocations == 0);
+        const size_t in_use = stats.bytes_in_use;
+
+        {
+            resizable_tensor a(2,3,10,10), b(1,1,1,3);
+            DLIB_TEST(reinterpret_cast<uintptr_t>(a.host())%64 == 0);
+            DLIB_TEST(reinterpret_cast<uintptr_t>(b.host())%64 == 0);
+            stats = get_host_memory_pool_stats();
+            DLIB_TEST(stats.num_allocations == 2);
+            DLIB_TEST(stats.num_cache_hits == 0);
+            // 2400 bytes is rounded up to 2560 and 12 bytes to 64.
+            DLIB_TEST(stats.bytes_in_use == in_use + 2560 + 64);
+            DLIB_TEST(stats.peak_bytes_in_use == stats.bytes_in_use);
+        }
+        stats = get_host_memory_pool_stats();
+        DLIB_TEST(stats.bytes_in_use == in_use);
+        DLIB_TEST(stats.bytes_cached == 2560 + 64);
+
+        // A tensor of a slightly different shape reuses the freed block.
+        {
+            resizable_tensor a(2,3,10,9);
+            stats = get_host_memory_pool_stats();
+            DLIB_TEST(stats.num_allocations == 3);
+            DLIB_TEST(stats.num_cache_hits == 1);
+            DLIB_TEST(stats.bytes_cached == 64);
+        }
+
+        set_host_memory_pool_max_cached_bytes(1000);
+        DLIB_TEST(get_host_memory_pool_max_cached_bytes() == 1000);
+        stats = get_host_memory_pool_stats();
+        DLIB_TEST(stats.bytes_cached == 0);
+        {
+            resizable_tensor a(2,3,10,10), b(1,1,1,3);
+        }
+        // Only the small block fits in the cache.
+        DLIB_TEST(get_host_memory_pool_stats().bytes_cached == 64);
+        trim_host_memory_pool();
+        DLIB_TEST(get_host_memory_pool_stats().bytes_cached == 0);
+        set_host_memory_pool_max_cached_bytes(max_cached);
+#endif
+    }
+
+    void test_tiled_mmod_detector()
+    {
+        // Tiled detection should find the same objects as running the network on the
+        // whole image, no matter how the image is split into tiles.
+        print_spinner();
+        mmod_options options;
+        options.detector_windows = {mmod_options::detector_window_details(20,20,"a"),
+                                    mmod_options::detector_window_details(30,15,"b")};
+        options.use_bounding_box_regression = true;
+        using net_type = loss_mmod<con<10,3,3,1,1,relu<bn_con<con<8,5,5,2,2,input_rgb_image_pyramid<pyramid_down<6>>>>>>>;
+
+        // The network and the inference_net it's run as compute the same numbers up to
+        // floating point rounding, which can move the edge of a regressed box that's on
+        // half a pixel by one pixel.
+        auto same_detection = [](const mmod_rect& a, const mmod_rect& b)
+        {
+            return a.label == b.label &&
+                   std::abs(a.detection_confidence - b.detection_confidence) < 1e-4 &&
+                   std::abs(a.rect.left() - b.rect.left()) <= 1 &&
+                   std::abs(a.rect.top() - b.rect.top()) <= 1 &&
+                   std::abs(a.rect.right() - b.rect.right()) <= 1 &&
+                   std::abs(a.rect.bottom() - b.rect.bottom()) <= 1;
+        };
+
+        // The con_ layers draw their initial weights from std::rand(), so seed it here
+        // rather than depend on which tests ran before this one.  These seeds give
+        // detections in the padding and the empty parts of the input layer's tiled
+        // pyramid image, as well as near levels that are closer together than the
+        // pyramid padding.
+        for (unsigned int seed : {1, 7, 8, 9, 11, 58})
+        {
+            std::srand(seed);
+            net_type net(options);
+
+            dlib::rand rnd(seed);
+            matrix<rgb_pixel> img(150,210);
+            for (auto& p : img)
+                p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+
+            const auto full = net.process(img, 0.3);
+            DLIB_TEST(full.size() > 100);
+
+            size_t prev_memory = std::numeric_limits<size_t>::max();
+            for (long tile_size : {5000, 60, 23})
+            {
+                tiled_mmod_detector<net_type> det(net, tile_size, 3, 2);
+                DLIB_TEST(det.get_tile_size() == tile_size);
+                DLIB_TEST(det.get_max_batch_size() == 3);
+                DLIB_TEST(det.get_num_threads() == 2);
+                // A 5x5 filter with stride 2 and then a 3x3 filter see 9 pixels, and the
+                // tiles extend past their cores by half of that.
+                DLIB_TEST(det.get_margin() == 5);
+                DLIB_TEST(det.peak_memory_usage() == 0);
+
+                auto dets = det(img, 0.3);
+                for (size_t i = 1; i < dets.size(); ++i)
+                    DLIB_TEST(dets[i-1].detection_confidence >= dets[i].detection_confidence);
+                DLIB_TEST_MSG(dets.size() == full.size(), "seed: " << seed << " tile_size: " << tile_size
+                    << " " << dets.size() << " " << full.size());
+                std::vector<bool> used(dets.size(), false);
+                for (auto&& f : full)
+                {
+                    bool found = false;
+                    for (size_t i = 0; i < dets.size() && !found; ++i)
+                    {
+                        if (!used[i] && same_detection(dets[i], f))
+                            used[i] = found = true;
+                    }
+                    DLIB_TEST_MSG(found, "seed: " << seed << " tile_size: " << tile_size << " " << f.rect << " " << f.label);
+                }
+
+                // Smaller tiles need less memory.
+                DLIB_TEST(det.peak_memory_usage() < prev_memory);
+                prev_memory = det.peak_memory_usage();
+            }
+        }
+    }
+
+    void test_reduced_precision()
+    {
+        print_spinner();
+        // Every 16 bit value survives a round trip through a float.
+        for (long i = 0; i < 65536; ++i)
+        {
+            const std::uint16_t h = i;
+            const float f16 = float16_to_float(h);
+            const float bf16 = bfloat16_to_float(h);
+            if (std::isnan(f16))
+                DLIB_TEST(std::isnan(float16_to_float(float_to_float16(f16))));
+            else
+                DLIB_TEST(float_to_float16(f16) == h);
+            if (std::isnan(bf16))
+                DLIB_TEST(std::isnan(bfloat16_to_float(float_to_bfloat16(bf16))));
+            else
+                DLIB_TEST(float_to_bfloat16(bf16) == h);
+        }
+        DLIB_TEST(float16_to_float(0x3c00) == 1);
+        DLIB_TEST(float16_to_float(0x7bff) == 65504);
+        DLIB_TEST(float16_to_float(0x0001) == std::pow(2.0f, -24.0f));
+        DLIB_TEST(bfloat16_to_float(0xbf80) == -1);
+
+        // Rounding goes to the nearest value, with ties going to the even one.
+        DLIB_TEST(round_to_precision(1 + std::pow(2.0f,-11.0f), storage_precision::float16) == 1);
+        DLIB_TEST(round_to_precision(1 + 3*std::pow(2.0f,-11.0f), storage_precision::float16) == 1 + std::pow(2.0f,-9.0f));
+        DLIB_TEST(round_to_precision(1 + 1.5f*std::pow(2.0f,-11.0f), storage_precision::float16) == 1 + std::pow(2.0f,-10.0f));
+        DLIB_TEST(round_to_precision(std::pow(2.0f,-25.0f), storage_precision::float16) == 0);
+        DLIB_TEST(round_to_precision(3*std::pow(2.0f,-25.0f), storage_precision::float16) == std::pow(2.0f,-23.0f));
+        DLIB_TEST(round_to_precision(65519, storage_precision::float16) == 65504);
+        DLIB_TEST(std::isinf(round_to_precision(65520, storage_precision::float16)));
+        DLIB_TEST(round_to_precision(1 + std::pow(2.0f,-8.0f), storage_precision::bfloat16) == 1);
+        DLIB_TEST(round_to_precision(1 + 3*std::pow(2.0f,-8.0f), storage_precision::bfloat16) == 1 + std::pow(2.0f,-6.0f));
+        DLIB_TEST(round_to_precision(1e30f, storage_precision::bfloat16)/1e30f - 1 < 1.0/256);
+        DLIB_TEST(round_to_precision(0.3f, storage_precision::float32) == 0.3f);
+
+        // The bulk conversions, which may use SIMD instructions, agree with the scalar ones.
+        dlib::rand rnd;
+        std::vector<float> vals(1003), back(vals.size());
+        std::vector<std::uint16_t> h(vals.size());
+        for (auto& v : vals)
+            v = rnd.get_random_gaussian()*std::pow(10.0, rnd.get_integer_in_range(-9, 6));
+        for (auto precision : {storage_precision::bfloat16, storage_precision::float16})
+        {
+            convert_to_reduced_precision(&vals[0], &h[0], vals.size(), precision);
+            convert_from_reduced_precision(&h[0], &back[0], vals.size(), precision);
+            for (size_t i = 0; i < vals.size(); ++i)
+            {
+                DLIB_TEST(h[i] == (precision == storage_precision::bfloat16 ? float_to_bfloat16(vals[i]) : float_to_float16(vals[i])));
+                DLIB_TEST(back[i] == round_to_precision(vals[i], precision));
+            }
+        }
+
+        // A network whose parameters are already rounded to 16 bits gives the same
+        // outputs when compiled with 16 bit filters, since only the storage changes.
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<7,relu<fc<30,relu<con<4,3,3,1,1,input_rgb_image>>>>>>;
+        std::vector<matrix<rgb_pixel>> images = make_random_rgb_images(3, 10, 12, rnd);
+        for (auto precision : {storage_precision::bfloat16, storage_precision::float16})
+        {
+            net_type net;
+            resizable_tensor x;
+            net.to_tensor(images.begin(), images.end(), x);
+            net.subnet().forward(x);
+            const matrix<float> full = mat(compile_for_inference(net).forward(x));
+
+            visit_layer_parameters(net, [&](size_t, tensor& t) { round_to_precision(t, precision); });
+            const matrix<float> expected = mat(net.subnet().forward(x));
+            DLIB_TEST(max(abs(full-expected)) > 0);
+            DLIB_TEST_MSG(max(abs(full-expected)) < 0.02*max(abs(expected)), max(abs(full-expected)));
+
+            inference_net inet = compile_for_inference(net, precision);
+            std::ostringstream sout;
+            sout << inet;
+            DLIB_TEST_MSG(sout.str().find(precision == storage_precision::bfloat16 ? "bfloat16 fc" : "float16 con") != std::string::npos, sout.str());
+            const matrix<float> out = mat(inet.forward(x));
+            DLIB_TEST_MSG(max(abs(out-expected)) < 1e-5*max(abs(expected)), max(abs(out-expected)));
+
+            std::ostringstream sout2;
+            serialize(inet, sout2);
+            std::istringstream sin(sout2.str());
+            inference_net inet2;
+            deserialize(inet2, sin);
+            DLIB_TEST(max(abs(mat(inet2.forward(x))-out)) == 0);
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_micro_batches()
+    {
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<3,relu<fc<10,relu<con<4,3,3,1,1,input<matrix<float>>>>>>>>;
+
+        dlib::rand rnd;
+        auto make_batch = [&](std::vector<matrix<float>>& samples, std::vector<unsigned long>& labels)
+        {
+            samples.resize(10);
+            labels.resize(10);
+            for (size_t i = 0; i < samples.size(); ++i)
+            {
+                labels[i] = rnd.get_random_32bit_number()%3;
+                samples[i] = matrix_cast<float>(randm(6,6,rnd)) + labels[i];
+            }
+        };
+
+        // Start both networks from the same random initialization.
+        net_type net1, net2;
+        std::vector<matrix<float>> samples;
+        std::vector<unsigned long> labels;
+        make_batch(samples, labels);
+        net1(samples[0]);
+        net2 = net1;
+
+        dnn_trainer<net_type> trainer1(net1, sgd(), {0});
+        dnn_trainer<net_type> trainer2(net2, sgd(), {0});
+        DLIB_TEST(trainer1.get_micro_batch_size() == 0);
+        // 10 samples in micro-batches of 3 leaves a last micro-batch with 1 sample.
+        trainer2.set_micro_batch_size(3);
+        DLIB_TEST(trainer2.get_micro_batch_size() == 3);
+        trainer1.set_learning_rate(0.1);
+        trainer2.set_learning_rate(0.1);
+
+        for (int iter = 0; iter < 10; ++iter)
+        {
+            make_batch(samples, labels);
+            trainer1.train_one_step(samples, labels);
+            trainer2.train_one_step(samples, labels);
+        }
+        make_batch(samples, labels);
+        trainer1.test_one_step(samples, labels);
+        trainer2.test_one_step(samples, labels);
+
+        // Accumulating the gradients of the micro-batches gives the same steps as
+        // running the whole mini-batch at once, and each mini-batch counts as one step.
+        DLIB_TEST(trainer2.get_train_one_step_calls() == 10);
+        DLIB_TEST(std::abs(trainer1.get_average_loss() - trainer2.get_average_loss()) < 1e-5);
+        DLIB_TEST(std::abs(trainer1.get_average_test_loss() - trainer2.get_average_test_loss()) < 1e-5);
+        trainer1.get_net();
+        trainer2.get_net();
+        std::vector<tensor*> params1, params2;
+        visit_layer_parameters(net1, [&](size_t, tensor& t) { params1.push_back(&t); });
+        visit_layer_parameters(net2, [&](size_t, tensor& t) { params2.push_back(&t); });
+        for (size_t i = 0; i < params1.size(); ++i)
+        {
+            if (params1[i]->size() != 0)
+                DLIB_TEST_MSG(max(abs(mat(*params1[i]) - mat(*params2[i]))) < 1e-5, max(abs(mat(*params1[i]) - mat(*params2[i]))));
+        }
+    }
+
+    void test_process_group()
+    {
+        print_spinner();
+        // Let the operating system pick the ports, so this can't collide with anything
+        // else running on the machine.
+        std::vector<network_address> workers;
+        std::vector<std::unique_ptr<listener>> listeners;
+        auto make_workers = [&](size_t num)
+        {
+            workers.clear();
+            listeners.resize(num);
+            for (auto& list : listeners)
+            {
+                DLIB_TEST(create_listener(list, 0, "127.0.0.1") == 0);
+                workers.push_back(network_address("127.0.0.1", list->get_listening_port()));
+            }
+        };
+        make_workers(3);
+
+        // Sums and broadcasts, including sizes smaller than the number of workers.
+        std::vector<int> errors(workers.size());
+        std::vector<std::thread> threads;
+        for (size_t rank = 0; rank < workers.size(); ++rank)
+        {
+            threads.emplace_back([&, rank]() {
+                dnn_process_group group(rank, workers, std::move(listeners[rank]));
+                if (group.rank() != rank || group.size() != workers.size())
+                    ++errors[rank];
+                for (size_t num : {0, 1, 2, 7, 1000})
+                {
+                    std::vector<float> data(num);
+                    for (size_t i = 0; i < num; ++i)
+                        data[i] = rank*1000 + i;
+                    group.sum(data.data(), num);
+                    for (size_t i = 0; i < num; ++i)
+                    {
+                        if (data[i] != 3000 + 3*i)
+                            ++errors[rank];
+                    }
+
+                    for (size_t i = 0; i < num; ++i)
+                        data[i] = rank*1000 + i;
+                    group.broadcast(data.data(), num);
+                    for (size_t i = 0; i < num; ++i)
+                    {
+                        if (data[i] != i)
+                            ++errors[rank];
+                    }
+                }
+
+                resizable_tensor a(2,3), b(5);
+                a = rank;
+                b = 2*rank;
+                group.average({&a, &b});
+                if (max(abs(mat(a) - 1)) != 0 || max(abs(mat(b) - 2)) != 0)
+                    ++errors[rank];
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        threads.clear();
+        for (auto e : errors)
+            DLIB_TEST(e == 0);
+
+        // Two workers that each train on half of every mini-batch take the same steps as
+        // one trainer that gets the whole mini-batches.
+        using net_type = loss_multiclass_log<fc<3,relu<fc<10,input<matrix<float>>>>>>;
+        dlib::rand rnd;
+        std::vector<std::vector<matrix<float>>> batches(10);
+        std::vector<std::vector<unsigned long>> batch_labels(batches.size());
+        for (size_t b = 0; b < batches.size(); ++b)
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                batch_labels[b].push_back(rnd.get_random_32bit_number()%3);
+                batches[b].push_back(matrix_cast<float>(randm(5,1,rnd)) + batch_labels[b].back());
+            }
+        }
+
+        net_type net;
+        net(batches[0][0]);
+        std::vector<net_type> worker_nets(2, net);
+        dnn_trainer<net_type> trainer(net, sgd(), {0});
+        trainer.set_learning_rate(0.1);
+        for (size_t b = 0; b < batches.size(); ++b)
+            trainer.train_one_step(batches[b], batch_labels[b]);
+        trainer.get_net();
+
+        make_workers(2);
+        std::vector<double> worker_losses(2);
+        for (size_t rank = 0; rank < 2; ++rank)
+        {
+            threads.emplace_back([&, rank]() {
+                dnn_process_group group(rank, workers, std::move(listeners[rank]));
+                dnn_trainer<net_type> trainer(worker_nets[rank], sgd(), {0});
+                trainer.set_process_group(group);
+                // Sync to disk on every step, which all the workers need to agree on.
+                trainer.set_synchronization_file("dnn_process_group_sync_" + cast_to_string(rank), std::chrono::seconds(0));
+                trainer.set_learning_rate(0.1);
+                for (size_t b = 0; b < batches.size(); ++b)
+                {
+                    std::vector<matrix<float>> samples(batches[b].begin()+4*rank, batches[b].begin()+4*rank+4);
+                    std::vector<unsigned long> labels(batch_labels[b].begin()+4*rank, batch_labels[b].begin()+4*rank+4);
+                    trainer.train_one_step(samples, labels);
+                }
+                trainer.get_net();
+                worker_losses[rank] = trainer.get_average_loss();
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        DLIB_TEST(worker_losses[0] == worker_losses[1]);
+        DLIB_TEST(std::abs(worker_losses[0] - trainer.get_average_loss()) < 1e-5);
+        for (auto& wnet : worker_nets)
+        {
+            const matrix<float> diff1 = mat(layer<1>(wnet).layer_details().get_layer_params()) - mat(layer<1>(net).layer_details().get_layer_params());
+            const matrix<float> diff3 = mat(layer<3>(wnet).layer_details().get_layer_params()) - mat(layer<3>(net).layer_details().get_layer_params());
+            DLIB_TEST_MSG(max(abs(diff1)) < 1e-5, max(abs(diff1)));
+            DLIB_TEST_MSG(max(abs(diff3)) < 1e-5, max(abs(diff3)));
+        }
+
+        // train() stops once the learning rate drops below the minimum, and all the
+        // workers stop at the same step, even though each one checks the learning rate
+        // while its training thread may still be busy with the step before.
+        threads.clear();
+        make_workers(2);
+        std::vector<net_type> stop_nets(2, net);
+        std::vector<double> stop_learning_rates(2);
+        for (size_t rank = 0; rank < 2; ++rank)
+        {
+            threads.emplace_back([&, rank]() {
+                dnn_process_group group(rank, workers, std::move(listeners[rank]));
+                dnn_trainer<net_type> trainer(stop_nets[rank], sgd(), {0});
+                trainer.set_process_group(group);
+                trainer.set_mini_batch_size(4);
+                trainer.set_learning_rate_schedule(linspace(0.1, 0.01, 7));
+                std::vector<matrix<float>> samples;
+                std::vector<unsigned long> labels;
+                for (size_t b = 0; b < batches.size(); ++b)
+                {
+                    samples.insert(samples.end(), batches[b].begin()+4*rank, batches[b].begin()+4*rank+4);
+                    labels.insert(labels.end(), batch_labels[b].begin()+4*rank, batch_labels[b].begin()+4*rank+4);
+                }
+                trainer.train(samples, labels);
+                stop_learning_rates[rank] = trainer.get_learning_rate();
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        DLIB_TEST(stop_learning_rates[0] == stop_learning_rates[1]);
+        DLIB_TEST(stop_learning_rates[0] < 0.01);
+        const matrix<float> stop_diff = mat(layer<1>(stop_nets[0]).layer_details().get_layer_params()) -
+                                        mat(layer<1>(stop_nets[1]).layer_details().get_layer_params());
+        DLIB_TEST(max(abs(stop_diff)) == 0);
+
+        for (size_t rank = 0; rank < 2; ++rank)
+        {
+            const std::string filename = "dnn_process_group_sync_" + cast_to_string(rank);
+            DLIB_TEST(file_exists(filename) || file_exists(filename + "_"));
+            std::remove(filename.c_str());
+            std::remove((filename + "_").c_str());
+        }
+    }
+
+    template <typename solver_type>
+    void check_solver_training (
+        const solver_type& solver,
+        double learning_rate,
+        const std::vector<matrix<float>>& samples,
+        const std::vector<unsigned long>& labels
+    )
+    {
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<3,relu<fc<10,input<matrix<float>>>>>>;
+        net_type net;
+        dnn_trainer<net_type, solver_type> trainer(net, solver);
+        trainer.set_learning_rate(learning_rate);
+        trainer.set_mini_batch_size(30);
+        trainer.set_max_num_epochs(100);
+        trainer.train(samples, labels);
+        const std::vector<unsigned long> predicted = net(samples);
+        int num_right = 0;
+        for (size_t i = 0; i < labels.size(); ++i)
+            num_right += predicted[i] == labels[i];
+        DLIB_TEST_MSG(num_right > 0.9*labels.size(), solver << " got " << num_right);
+
+        // The solvers' state is saved and restored.
+        std::ostringstream sout;
+        serialize(trainer.get_solvers()[1], sout);
+        std::istringstream sin(sout.str());
+        solver_type solver2;
+        deserialize(solver2, sin);
+        std::ostringstream sout2;
+        serialize(solver2, sout2);
+        DLIB_TEST(sout.str() == sout2.str());
+    }
+
+    void test_fused_solvers()
+    {
+        print_spinner();
+        // Check the update kernels against the formulas they implement, on a range that
+        // doesn't cover the whole tensors.
+        const float t = 3;
+        const float lr = 0.01, wd = 0.1, m1 = 0.9, m2 = 0.99;
+        tt::tensor_rand trnd;
+        resizable_tensor s(100), m(100), v(100), params(100), params_grad(100);
+        trnd.fill_gaussian(m);
+        trnd.fill_uniform(v);
+        trnd.fill_gaussian(params);
+        trnd.fill_gaussian(params_grad);
+        const long begin = 10, end = 90;
+        const matrix<float> g = rowm(mat(params_grad), range(begin,end-1));
+        const matrix<float> w = rowm(mat(params), range(begin,end-1));
+        const matrix<float> m_new = m1*rowm(mat(m), range(begin,end-1)) + (1-m1)*g;
+        const matrix<float> v_new = m2*rowm(mat(v), range(begin,end-1)) + (1-m2)*squared(g);
+
+        {
+            resizable_tensor mm(m), vv(v);
+            tt::compute_adamw_update(begin, end, s, mm, vv, t, lr, wd, m1, m2, params, params_grad);
+            const float alpha = lr*std::sqrt(1-std::pow(m2,t))/(1-std::pow(m1,t));
+            const matrix<float> expected = -alpha*pointwise_divide(m_new, sqrt(v_new)+1e-8) - lr*wd*w;
+            DLIB_TEST(max(abs(rowm(mat(s), range(begin,end-1)) - expected)) < 1e-6);
+            DLIB_TEST(max(abs(rowm(mat(mm), range(begin,end-1)) - m_new)) < 1e-6);
+            DLIB_TEST(max(abs(rowm(mat(vv), range(begin,end-1)) - v_new)) < 1e-6);
+            // Nothing outside the range changes.
+            DLIB_TEST(max(abs(rowm(mat(mm), range(0,begin-1)) - rowm(mat(m), range(0,begin-1)))) == 0);
+            DLIB_TEST(max(abs(rowm(mat(vv), range(end,99)) - rowm(mat(v), range(end,99)))) == 0);
+        }
+        {
+            resizable_tensor mm(m), vv(v), sums;
+            tt::compute_lamb_update(begin, end, s, mm, vv, t, lr, wd, m1, m2, params, params_grad, sums);
+            const matrix<float> r = pointwise_divide(m_new/(1-std::pow(m1,t)), sqrt(v_new/(1-std::pow(m2,t)))+1e-6) + wd*w;
+            DLIB_TEST(sums.size() == 2);
+            DLIB_TEST(std::abs(mat(sums)(0) - length_squared(w)) < 1e-5*length_squared(w));
+            DLIB_TEST(std::abs(mat(sums)(1) - length_squared(r)) < 1e-5*length_squared(r));
+            const matrix<float> expected = -lr*(length(w)/length(r))*r;
+            DLIB_TEST_MSG(max(abs(rowm(mat(s), range(begin,end-1)) - expected)) < 1e-6, max(abs(rowm(mat(s), range(begin,end-1)) - expected)));
+            DLIB_TEST(std::abs(length(rowm(mat(s), range(begin,end-1))) - lr*length(w)) < 1e-5);
+            DLIB_TEST(max(abs(rowm(mat(mm), range(begin,end-1)) - m_new)) < 1e-6);
+            DLIB_TEST(max(abs(rowm(mat(vv), range(begin,end-1)) - v_new)) < 1e-6);
+        }
+        {
+            resizable_tensor vv(v);
+            tt::compute_nesterov_update(begin, end, s, vv, lr, wd, m1, params, params_grad);
+            const matrix<float> step = lr*(wd*w + g);
+            const matrix<float> vel = m1*rowm(mat(v), range(begin,end-1)) - step;
+            DLIB_TEST(max(abs(rowm(mat(vv), range(begin,end-1)) - vel)) < 1e-6);
+            DLIB_TEST(max(abs(rowm(mat(s), range(begin,end-1)) - (m1*vel - step))) < 1e-6);
+        }
+
+        // Train a small network with each of the solvers.
+        dlib::rand rnd;
+        std::vector<matrix<float>> samples;
+        std::vector<unsigned long> labels;
+        for (int i = 0; i < 90; ++i)
+        {
+            labels.push_back(i%3);
+            samples.push_back(matrix_cast<float>(randm(4,1,rnd)));
+            samples.back()(labels.back()) += 1;
+        }
+        check_solver_training(adamw(0.01, 0.9, 0.999), 0.01, samples, labels);
+        check_solver_training(lamb(0.01, 0.9, 0.999), 0.01, samples, labels);
+        check_solver_training(nesterov_sgd(0.0005, 0.9), 0.1, samples, labels);
+
+        std::ostringstream sout;
+        sout << adamw() << "\n" << lamb() << "\n" << nesterov_sgd();
+        DLIB_TEST(sout.str().find("adamw: ") == 0);
+        DLIB_TEST(sout.str().find("\nlamb: ") != std::string::npos);
+        DLIB_TEST(sout.str().find("\nnesterov_sgd: ") != std::string::npos);
+    }
+
+    template <typename SUBNET> using ckpt_block = relu<add_prev1<bn_con<con<4,3,3,1,1,relu<bn_con<con<4,3,3,1,1,tag1<SUBNET>>>>>>>>;
+    template <typename SUBNET> using ckpt = checkpoint<ckpt_block,SUBNET>;
+    template <typename SUBNET> using ckpt_pair = ckpt<ckpt_block<SUBNET>>;
+
+    void test_checkpoint()
+    {
+        print_spinner();
+        // The same network with and without checkpoints, including a checkpoint nested in
+        // another one and an in-place layer on top of one.
+        using net_type1 = loss_multiclass_log<fc<3,relu<ckpt_block<ckpt_block<ckpt_block<relu<con<4,3,3,1,1,input<matrix<float>>>>>>>>>>;
+        using net_type2 = loss_multiclass_log<fc<3,relu<ckpt<checkpoint<ckpt_pair,relu<con<4,3,3,1,1,input<matrix<float>>>>>>>>>;
+        DLIB_TEST(net_type1::num_layers == net_type2::num_layers);
+        DLIB_TEST(net_type1::num_computational_layers == net_type2::num_computational_layers);
+
+        dlib::rand rnd;
+        std::vector<matrix<float>> samples(6);
+        std::vector<unsigned long> labels(6);
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            labels[i] = rnd.get_random_32bit_number()%3;
+            samples[i] = matrix_cast<float>(randm(7,7,rnd)) + labels[i];
+        }
+
+        net_type1 net1;
+        net_type2 net2;
+        net1(samples[0]);
+        net2(samples[0]);
+        std::vector<tensor*> params1, params2;
+        visit_layer_parameters(net1, [&](size_t, tensor& t) { params1.push_back(&t); });
+        visit_layer_parameters(net2, [&](size_t, tensor& t) { params2.push_back(&t); });
+        DLIB_TEST(params1.size() == params2.size());
+        for (size_t i = 0; i < params1.size(); ++i)
+            memcpy(*params2[i], *params1[i]);
+
+        resizable_tensor x;
+        net1.to_tensor(samples.begin(), samples.end(), x);
+        const double loss1 = net1.compute_parameter_gradients(x, labels.begin());
+        const double loss2 = net2.compute_parameter_gradients(x, labels.begin());
+        DLIB_TEST_MSG(std::abs(loss1 - loss2) < 1e-5, loss1 << " " << loss2);
+
+        std::vector<tensor*> grads1, grads2;
+        visit_layer_parameter_gradients(net1, [&](size_t, tensor& t) { grads1.push_back(&t); });
+        visit_layer_parameter_gradients(net2, [&](size_t, tensor& t) { grads2.push_back(&t); });
+        DLIB_TEST(grads1.size() == grads2.size());
+        for (size_t i = 0; i < grads1.size(); ++i)
+        {
+            DLIB_TEST(have_same_dimensions(*grads1[i], *grads2[i]));
+            if (grads1[i]->size() != 0)
+                DLIB_TEST_MSG(max(abs(mat(*grads1[i]) - mat(*grads2[i]))) < 1e-4, i << ": " << max(abs(mat(*grads1[i]) - mat(*grads2[i]))));
+        }
+        DLIB_TEST(max(abs(mat(net1.subnet().get_final_data_gradient()) - mat(net2.subnet().get_final_data_gradient()))) < 1e-5);
+
+        // Only the outputs of the checkpoints are kept, not the ones inside of them.
+        DLIB_TEST(layer<6>(net1).get_output().size() != 0);
+        DLIB_TEST(layer<6>(net2).get_output().size() == 0);
+        DLIB_TEST(layer<2>(net2).get_output().size() != 0);
+        DLIB_TEST(max(abs(mat(layer<2>(net1).get_output()) - mat(layer<2>(net2).get_output()))) < 1e-5);
+
+        // The checkpoints survive serialization and training.
+        std::ostringstream sout;
+        serialize(net2, sout);
+        std::istringstream sin(sout.str());
+        net_type2 net3;
+        deserialize(net3, sin);
+        dnn_trainer<net_type2> trainer(net3, sgd(), {0});
+        trainer.set_learning_rate(0.01);
+        const double start_loss = trainer.get_net().compute_loss(x, labels.begin());
+        for (int iter = 0; iter < 30; ++iter)
+            trainer.train_one_step(samples, labels);
+        DLIB_TEST(trainer.get_net().compute_loss(x, labels.begin()) < start_loss);
+    }
+
+    void test_grouped_conv()
+    {
+        // A grouped convolution should give the same results as doing a separate con_ on
+        // each group of channels.
+        print_spinner();
+        dlib::rand rnd;
+        struct setting { long groups, k_per_group, filters_per_group, nr, nc, sy, sx, py, px; };
+        const setting settings[] = {
+            {2, 3, 2, 3, 3, 1, 1, 1, 1},
+            {3, 2, 1, 3, 5, 2, 2, 0, 2},
+            {4, 1, 1, 3, 3, 1, 1, 1, 1},  // depthwise
+            {5, 1, 2, 5, 5, 1, 2, 2, 0},
+            {2, 4, 3, 1, 1, 1, 1, 0, 0},
+            // These have enough channels per group to go through img2col().
+            {2, 6, 3, 3, 3, 2, 1, 1, 0},
+            {3, 5, 2, 1, 1, 1, 1, 0, 0},
+        };
+        for (auto& s : settings)
+        {
+            resizable_tensor data(2, s.groups*s.k_per_group, 19, 21);
+            resizable_tensor filters(s.groups*s.filters_per_group, s.k_per_group, s.nr, s.nc);
+            tt::tensor_rand trand(rnd.get_random_32bit_number());
+            trand.fill_gaussian(data);
+            trand.fill_gaussian(filters);
+
+            tt::tensor_conv conv;
+            resizable_tensor output;
+            conv.setup(data, filters, s.sy, s.sx, s.py, s.px, s.groups);
+            conv(false, output, data, filters);
+            DLIB_TEST(output.k() == filters.num_samples());
+
+            resizable_tensor gradient_input, data_grad, filters_grad, expected_data_grad, expected_filters_grad;
+            gradient_input.copy_size(output);
+            trand.fill_gaussian(gradient_input);
+            // The data gradient is added to what is already there.
+            data_grad.copy_size(data);
+            trand.fill_gaussian(data_grad);
+            expected_data_grad = data_grad;
+            filters_grad.copy_size(filters);
+            filters_grad = 0;
+            expected_filters_grad = filters_grad;
+            conv.get_gradient_for_data(true, gradient_input, filters, data_grad);
+            conv.get_gradient_for_filters(false, gradient_input, data, filters_grad);
+
+            double max_err = 0;
+            for (long g = 0; g < s.groups; ++g)
+            {
+                resizable_tensor gdata(data.num_samples(), s.k_per_group, data.nr(), data.nc());
+                resizable_tensor gfilters(s.filters_per_group, s.k_per_group, s.nr, s.nc);
+                tt::copy_tensor(false, gdata, 0, data, g*s.k_per_group, s.k_per_group);
+                memcpy(gfilters, alias_tensor(s.filters_per_group, s.k_per_group, s.nr, s.nc)(filters, g*gfilters.size()));
+
+                tt::tensor_conv dense;
+                resizable_tensor goutput, expected_output;
+                dense.setup(gdata, gfilters, s.sy, s.sx, s.py, s.px);
+                dense(false, goutput, gdata, gfilters);
+                expected_output.copy_size(goutput);
+                tt::copy_tensor(false, expected_output, 0, output, g*s.filters_per_group, s.filters_per_group);
+                max_err = std::max<double>(max_err, max(abs(mat(goutput)-mat(expected_output))));
+
+                resizable_tensor ggradient_input, gdata_grad, gfilters_grad;
+                ggradient_input.copy_size(goutput);
+                tt::copy_tensor(false, ggradient_input, 0, gradient_input, g*s.filters_per_group, s.filters_per_group);
+                gdata_grad.copy_size(gdata);
+                gdata_grad = 0;
+                gfilters_grad.copy_size(gfilters);
+                dense.get_gradient_for_data(true, ggradient_input, gfilters, gdata_grad);
+                dense.get_gradient_for_filters(false, ggradient_input, gdata, gfilters_grad);
+                tt::copy_tensor(true, expected_data_grad, g*s.k_per_group, gdata_grad, 0, s.k_per_group);
+                auto expected_gfilters_grad = alias_tensor(s.filters_per_group, s.k_per_group, s.nr, s.nc)(expected_filters_grad, g*gfilters.size());
+                memcpy(expected_gfilters_grad, gfilters_grad);
+            }
+            DLIB_TEST_MSG(max_err < 1e-4, max_err);
+            DLIB_TEST_MSG(max(abs(mat(data_grad)-mat(expected_data_grad))) < 1e-4, max(abs(mat(data_grad)-mat(expected_data_grad))));
+            DLIB_TEST_MSG(max(abs(mat(filters_grad)-mat(expected_filters_grad))) < 1e-3, max(abs(mat(filters_grad)-mat(expected_filters_grad))));
+        }
+
+        // Check the layers' gradients numerically and that they survive serialization.
+        {
+            print_spinner();
+            depthwise_con_<3,3,1,1> l;
+            auto res = test_layer(l);
+            DLIB_TEST_MSG(res, res);
+        }
+        {
+            print_spinner();
+            depthwise_con_<2,2,2,2> l;
+            auto res = test_layer(l);
+            DLIB_TEST_MSG(res, res);
+        }
+        {
+            print_spinner();
+            grouped_con_<4,3,3,1,1,1> l;
+            auto res = test_layer(l);
+            DLIB_TEST_MSG(res, res);
+        }
+
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<3,relu<con<8,1,1,1,1,relu<depthwise_con<3,3,1,1,
+                         grouped_con<6,3,3,2,2,3,input<matrix<rgb_pixel>>>>>>>>>;
+        net_type net;
+        std::vector<matrix<rgb_pixel>> samples;
+        std::vector<unsigned long> labels;
+        for (int i = 0; i < 30; ++i)
+        {
+            matrix<rgb_pixel> img(12,12);
+            const unsigned long label = i%3;
+            for (auto& p : img)
+            {
+                p = rgb_pixel(rnd.get_random_8bit_number()/4, rnd.get_random_8bit_number()/4, rnd.get_random_8bit_number()/4);
+                (&p.red)[label] += 150;
+            }
+            samples.push_back(img);
+            labels.push_back(label);
+        }
+        dnn_trainer<net_type> trainer(net, sgd(), {});
+        trainer.set_learning_rate(0.1);
+        trainer.set_min_learning_rate(0.01);
+        trainer.set_mini_batch_size(10);
+        trainer.set_max_num_epochs(100);
+        trainer.train(samples, labels);
+        DLIB_TEST(layer<5>(net).layer_details().num_channels() == 6);
+        int num_right = 0;
+        const auto predicted = net(samples);
+        for (size_t i = 0; i < samples.size(); ++i)
+            num_right += predicted[i] == labels[i];
+        DLIB_TEST_MSG(num_right == (int)samples.size(), num_right);
+
+        std::ostringstream sout;
+        serialize(net, sout);
+        net_type net2;
+        std::istringstream sin(sout.str());
+        deserialize(net2, sin);
+        DLIB_TEST(net2(samples) == predicted);
+        DLIB_TEST(max(abs(mat(layer<6>(net2).layer_details().get_layer_params()) - mat(layer<6>(net).layer_details().get_layer_params()))) == 0);
+    }
+
+    // The networks from dnn_face_recognition_ex.cpp and dnn_mmod_face_detection_ex.cpp.
+    template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+    using onnx_residual = add_prev1<block<N,BN,1,tag1<SUBNET>>>;
+    template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+    using onnx_residual_down = add_prev2<avg_pool<2,2,2,2,skip1<tag2<block<N,BN,2,tag1<SUBNET>>>>>>;
+    template <int N, template <typename> class BN, int stride, typename SUBNET>
+    using onnx_block = BN<con<N,3,3,1,1,relu<BN<con<N,3,3,stride,stride,SUBNET>>>>>;
+    template <int N, typename SUBNET> using onnx_ares      = relu<onnx_residual<onnx_block,N,bn_con,SUBNET>>;
+    template <int N, typename SUBNET> using onnx_ares_down = relu<onnx_residual_down<onnx_block,N,bn_con,SUBNET>>;
+    template <typename SUBNET> using onnx_level0 = onnx_ares_down<256,SUBNET>;
+    template <typename SUBNET> using onnx_level1 = onnx_ares<256,onnx_ares<256,onnx_ares_down<256,SUBNET>>>;
+    template <typename SUBNET> using onnx_level2 = onnx_ares<128,onnx_ares<128,onnx_ares_down<128,SUBNET>>>;
+    template <typename SUBNET> using onnx_level3 = onnx_ares<64,onnx_ares<64,onnx_ares<64,onnx_ares_down<64,SUBNET>>>>;
+    template <typename SUBNET> using onnx_level4 = onnx_ares<32,onnx_ares<32,onnx_ares<32,SUBNET>>>;
+    using onnx_face_net = loss_metric<fc_no_bias<128,avg_pool_everything<
+                          onnx_level0<onnx_level1<onnx_level2<onnx_level3<onnx_level4<
+                          max_pool<3,3,2,2,relu<bn_con<con<32,7,7,2,2,
+                          input_rgb_image_sized<150>>>>>>>>>>>>>;
+
+    template <long N, typename SUBNET> using onnx_con5d = con<N,5,5,2,2,SUBNET>;
+    template <typename SUBNET> using onnx_downsampler = relu<bn_con<onnx_con5d<32,relu<bn_con<onnx_con5d<32,relu<bn_con<onnx_con5d<16,SUBNET>>>>>>>>>;
+    template <typename SUBNET> using onnx_rcon5 = relu<bn_con<con<45,5,5,1,1,SUBNET>>>;
+    using onnx_mmod_net = loss_mmod<con<1,9,9,1,1,onnx_rcon5<onnx_rcon5<onnx_rcon5<onnx_downsampler<
+                          input_rgb_image_pyramid<pyramid_down<6>>>>>>>>;
+
+    template <typename net_type>
+    void test_onnx_round_trip (
+        net_type& net,
+        const std::vector<matrix<rgb_pixel>>& images
+    )
+    {
+        print_spinner();
+        dlib::rand rnd;
+        randomize_small_parameters(net, images, 1000, rnd);
+        resizable_tensor x;
+        net.to_tensor(images.begin(), images.begin()+1, x);
+        const matrix<float> expected = mat(net.subnet().forward(x));
+
+        std::ostringstream sout;
+        export_to_onnx(net, sout);
+        std::istringstream sin(sout.str());
+        inference_net inet = import_from_onnx(sin);
+        // Importing folds the nodes back into the same operations.
+        DLIB_TEST(inet.num_ops() == compile_for_inference(net).num_ops());
+        const matrix<float> out = mat(inet.forward(x));
+        DLIB_TEST(out.size() == expected.size());
+        DLIB_TEST_MSG(max(abs(out-expected)) < 1e-4*max(abs(expected)), max(abs(out-expected)));
+
+        // A truncated model is an error rather than a crash.
+        std::istringstream sin2(sout.str().substr(0, sout.str().size()/2));
+        bool threw = false;
+        try { import_from_onnx(sin2); }
+        catch (serialization_error&) { threw = true; }
+        DLIB_TEST(threw);
+    }
+
+    void test_onnx()
+    {
+        dlib::rand rnd;
+        std::vector<matrix<rgb_pixel>> images = make_random_rgb_images(2, 150, 150, rnd);
+
+        onnx_face_net face_net;
+        test_onnx_round_trip(face_net, images);
+
+        mmod_options options(use_image_pyramid::no, std::vector<std::vector<mmod_rect>>{{mmod_rect(rectangle(40,40))}});
+        onnx_mmod_net mmod_net(options);
+        test_onnx_round_trip(mmod_net, images);
+    }
+
     void test_max_pool(
         const int window_height,
         const int window_width,
@@ -3347,6 +4990,7 @@ namespace
             test_add();
             test_multiply_zero_padded();
             compare_adam();
+            compare_fused_solvers();
             test_copy_tensor_gpu();
             test_copy_tensor_add_to_gpu();
             test_scale_channels();
@@ -3378,6 +5022,25 @@ namespace
             test_avg_pool(4,5,3,1,2,4);
             test_avg_pool(4,4,2,2,1,3);
             test_avg_pool(4,5,40,50,0,1);
+            test_cpu_conv_algorithms();
+            test_cpu_threading();
+            test_cpu_threaded_gemm();
+            test_quantized_net();
+            test_inference_net();
+            test_shared_inference_net();
+            test_inference_batcher();
+            test_mapped_network();
+            test_dnn_profiler();
+            test_dnn_data_loader();
+            test_host_memory_pool();
+            test_tiled_mmod_detector();
+            test_reduced_precision();
+            test_micro_batches();
+            test_process_group();
+            test_fused_solvers();
+            test_checkpoint();
+            test_grouped_conv();
+            test_onnx();
             test_tanh();
             test_softmax();
             test_softmax_all();
@@ -154,6 +154,117 @@ namespace
         test_real_compile_time_sized_ffts<1,16>();
     }
 
+// ----------------------------------------------------------------------------------------
+
+    matrix<complex<double> > dft_matrix(long n)
+    {
+        matrix<complex<double> > W(n,n);
+        for (long j = 0; j < n; ++j)
+        {
+            for (long k = 0; k < n; ++k)
+                W(j,k) = std::polar(1.0, -2*pi*((j*k)%n)/n);
+        }
+        return W;
+    }
+
+    matrix<complex<double> > naive_fft(const matrix<complex<double> >& m)
+    {
+        // Doing a 1D transform along a dimension of length 1 doesn't change anything, so
+        // this works for vectors as well as 2D matrices.
+        return dft_matrix(m.nr())*m*dft_matrix(m.nc());
+    }
+
+    void test_arbitrary_size_ffts()
+    {
+        const long sizes[] = {1, 2, 3, 5, 6, 7, 9, 12, 15, 17, 25, 30, 37, 45, 49, 60, 64, 97, 100, 210};
+        dlib::rand rnd;
+        for (auto nr : sizes)
+        {
+            print_spinner();
+            for (auto nc : sizes)
+            {
+                if (nr != 1 && nc != 1 && rnd.get_random_double() < 0.7)
+                    continue;
+
+                const matrix<complex<double> > m1 = rand_complex(nr,nc);
+                const matrix<complex<float> > fm1 = matrix_cast<complex<float> >(m1);
+                const matrix<complex<double> > f1 = naive_fft(m1);
+                const double eps = 1e-20*m1.size()*m1.size();
+
+                DLIB_TEST_MSG(max(norm(fft(m1)-f1)) < eps, nr << " " << nc << " " << max(norm(fft(m1)-f1)));
+                DLIB_TEST(max(norm(ifft(f1)-m1)) < 1e-16);
+                DLIB_TEST(max(norm(matrix_cast<complex<double> >(fft(fm1))-f1)) < 1e-7*m1.size());
+
+                matrix<complex<double> > temp = m1;
+                fft_inplace(temp);
+                DLIB_TEST(max(norm(temp-f1)) < eps);
+                ifft_inplace(temp);
+                DLIB_TEST(max(norm(temp/temp.size()-m1)) < 1e-16);
+
+                matrix<complex<double>,0,0,default_memory_manager,column_major_layout> cm = m1;
+                fft_inplace(cm);
+                DLIB_TEST(max(norm(cm-f1)) < eps);
+                DLIB_TEST(max(norm(ifft(cm)-m1)) < 1e-16);
+
+                // Real inputs take a different code path.
+                const matrix<double> r1 = real(m1);
+                const matrix<complex<double> > rf1 = naive_fft(complex_matrix(r1));
+                DLIB_TEST_MSG(max(norm(fft(r1)-rf1)) < eps, nr << " " << nc);
+                DLIB_TEST(max(norm(matrix_cast<complex<double> >(fft(matrix_cast<float>(r1)))-rf1)) < 1e-7*m1.size());
+                DLIB_TEST(max(squared(real(ifft(fft(r1)))-r1)) < 1e-16);
+            }
+        }
+    }
+
+    matrix<complex<double> > naive_fft1d(const matrix<complex<double> >& m)
+    {
+        const long n = m.size();
+        matrix<complex<double> > f(n,1);
+        for (long k = 0; k < n; ++k)
+        {
+            complex<double> sum = 0;
+            for (long j = 0; j < n; ++j)
+                sum += m(j)*std::polar(1.0, -2*pi*((j*k)%n)/n);
+            f(k) = sum;
+        }
+        return f;
+    }
+
+    void test_large_prime_ffts()
+    {
+        // These lengths have prime factors too big for the mixed radix code, so they get
+        // done with Bluestein's algorithm.
+        const long sizes[] = {37, 131, 1009, 2*1013, 4099};
+        for (auto n : sizes)
+        {
+            print_spinner();
+            const matrix<complex<double> > m1 = rand_complex(n,1);
+            const matrix<complex<double> > f1 = naive_fft1d(m1);
+            DLIB_TEST_MSG(max(norm(fft(m1)-f1)) < 1e-20*n*n*n, n << " " << max(norm(fft(m1)-f1)));
+            DLIB_TEST(max(norm(ifft(fft(m1))-m1)) < 1e-16);
+            DLIB_TEST(max(norm(fft(real(m1))-fft(complex_matrix(real(m1))))) < 1e-20*n*n);
+            DLIB_TEST(max(norm(fft(trans(m1))-trans(f1))) < 1e-20*n*n*n);
+        }
+    }
+
+    void test_large_2d_ffts()
+    {
+        // Big enough that the rows and columns get split up between threads.  The answer
+        // should be the same as doing the 1D transforms one at a time.
+        print_spinner();
+        const matrix<complex<double> > m1 = rand_complex(300,515);
+        matrix<complex<double> > f1 = m1;
+        for (long r = 0; r < f1.nr(); ++r)
+            set_rowm(f1,r) = fft(rowm(f1,r));
+        for (long c = 0; c < f1.nc(); ++c)
+            set_colm(f1,c) = fft(colm(f1,c));
+
+        DLIB_TEST(max(norm(fft(m1)-f1)) < 1e-16);
+        DLIB_TEST(max(norm(ifft(f1)-m1)) < 1e-16);
+        DLIB_TEST(max(norm(fft(real(m1))-fft(complex_matrix(real(m1))))) < 1e-16);
+        DLIB_TEST(max(norm(fft(real(rowm(m1,range(0,298))))-fft(complex_matrix(real(rowm(m1,range(0,298))))))) < 1e-16);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class test_fft : public tester
@@ -171,6 +282,9 @@ namespace
             test_against_saved_good_ffts();
             test_random_ffts();
             test_random_real_ffts();
+            test_arbitrary_size_ffts();
+            test_large_prime_ffts();
+            test_large_2d_ffts();
         }
     } a;
 
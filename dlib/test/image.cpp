@@ -4,6 +4,7 @@
 #include <string>
 #include <cstdlib>
 #include <ctime>
+#include <limits>
 #include <dlib/pixel.h>
 #include <dlib/array2d.h>
 #include <dlib/image_transforms.h>
@@ -1622,6 +1623,42 @@ namespace
         }
     }
 
+    template <typename in_pixel_type, typename out_pixel_type, typename filter_type>
+    void test_fft_filtering (
+        dlib::rand& rnd,
+        double scale,
+        bool use_abs,
+        bool add_to
+    )
+    {
+        print_spinner();
+        array2d<in_pixel_type> img(rnd.get_random_32bit_number()%60+1,
+            rnd.get_random_32bit_number()%60+1);
+        matrix<filter_type> filt(rnd.get_random_32bit_number()%30+1,
+            rnd.get_random_32bit_number()%30+1);
+        for (long r = 0; r < img.nr(); ++r)
+            for (long c = 0; c < img.nc(); ++c)
+                img[r][c] = rnd.get_random_32bit_number()%100;
+        for (auto& v : filt)
+            v = rnd.get_random_gaussian();
+
+        // Filtering with FFTs should give the same outputs as the direct loops.
+        array2d<out_pixel_type> out1(img.nr(), img.nc()), out2(img.nr(), img.nc());
+        for (long r = 0; r < img.nr(); ++r)
+            for (long c = 0; c < img.nc(); ++c)
+                out1[r][c] = out2[r][c] = r+c;
+        const long default_threshold = get_conv_fft_threshold();
+        set_conv_fft_threshold(std::numeric_limits<long>::max());
+        const rectangle area1 = spatially_filter_image(img, out1, filt, scale, use_abs, add_to);
+        set_conv_fft_threshold(0);
+        const rectangle area2 = spatially_filter_image(img, out2, filt, scale, use_abs, add_to);
+        set_conv_fft_threshold(default_threshold);
+
+        DLIB_TEST(area1 == area2);
+        const double err = max(abs(matrix_cast<double>(mat(out1)) - matrix_cast<double>(mat(out2))));
+        DLIB_TEST_MSG(err < 1e-2, err);
+    }
+
     template <typename T>
     void test_separable_filtering_center (
         dlib::rand& rnd
@@ -2054,6 +2091,14 @@ namespace
                 test_filtering_center<float>(rnd);
             for (int i = 0; i < 100; ++i)
                 test_filtering_center<int>(rnd);
+            for (int i = 0; i < 10; ++i)
+            {
+                test_fft_filtering<float,float,float>(rnd, 1, false, false);
+                test_fft_filtering<float,float,float>(rnd, 1, false, true);
+                test_fft_filtering<float,float,float>(rnd, 3, true, false);
+                test_fft_filtering<unsigned char,double,double>(rnd, 2, true, true);
+                test_fft_filtering<unsigned char,float,double>(rnd, 1, false, false);
+            }
             for (int i = 0; i < 100; ++i)
                 test_separable_filtering_center<int>(rnd);
             for (int i = 0; i < 100; ++i)
@@ -8,6 +8,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <vector>
+#include <limits>
 #include "../stl_checked.h"
 #include "../array.h"
 #include "../rand.h"
@@ -823,6 +824,69 @@ namespace
         }
     }
 
+    template <typename T>
+    void test_fft_conv()
+    {
+        print_spinner();
+        dlib::rand rnd;
+        const long default_threshold = get_conv_fft_threshold();
+        // The sums have up to 900 terms that are each in [0,1].
+        const double eps = is_same_type<T,float>::value ? 1e-3 : 1e-10;
+        for (int i = 0; i < 30; ++i)
+        {
+            const long nr1 = rnd.get_integer_in_range(1,70);
+            const long nc1 = rnd.get_integer_in_range(1,70);
+            const long nr2 = rnd.get_integer_in_range(1,30);
+            const long nc2 = rnd.get_integer_in_range(1,30);
+            const matrix<T> a = matrix_cast<T>(randm(nr1,nc1,rnd));
+            const matrix<T> b = matrix_cast<T>(randm(nr2,nc2,rnd));
+
+            // Compare the direct loops to the FFT path for all the border modes.
+            set_conv_fft_threshold(std::numeric_limits<long>::max());
+            const matrix<T> c1 = conv(a,b), c2 = conv_same(a,b), c3 = conv_valid(a,b);
+            const matrix<T> x1 = xcorr(a,b), x2 = xcorr_same(a,b), x3 = xcorr_valid(a,b);
+            set_conv_fft_threshold(0);
+            const matrix<T> fc1 = conv(a,b), fc2 = conv_same(a,b), fc3 = conv_valid(a,b);
+            const matrix<T> fx1 = xcorr(a,b), fx2 = xcorr_same(a,b), fx3 = xcorr_valid(a,b);
+            set_conv_fft_threshold(default_threshold);
+
+            DLIB_TEST(max(abs(c1-fc1)) < eps);
+            DLIB_TEST(max(abs(c2-fc2)) < eps);
+            DLIB_TEST(fc3.nr() == c3.nr() && fc3.nc() == c3.nc());
+            DLIB_TEST(c3.size() == 0 || max(abs(c3-fc3)) < eps);
+            DLIB_TEST(max(abs(x1-fx1)) < eps);
+            DLIB_TEST(max(abs(x2-fx2)) < eps);
+            DLIB_TEST(fx3.nr() == x3.nr() && fx3.nc() == x3.nc());
+            DLIB_TEST(x3.size() == 0 || max(abs(x3-fx3)) < eps);
+
+            // Apply the filters in both orders so the cached tile transforms get reused
+            // and also rebuilt for a bigger filter.
+            const matrix<T> small = matrix_cast<T>(randm(std::max<long>(nr2/2,1), std::max<long>(nc2/2,1), rnd));
+            fft_convolver<T> convolver(a);
+            DLIB_TEST(convolver.nr() == a.nr() && convolver.nc() == a.nc());
+            DLIB_TEST(max(abs(convolver.xcorr_same(small) - xcorr_same(a,small))) < eps);
+            DLIB_TEST(max(abs(convolver.conv(b) - c1)) < eps);
+            DLIB_TEST(max(abs(convolver.conv_same(b) - c2)) < eps);
+            DLIB_TEST(c3.size() == 0 || max(abs(convolver.conv_valid(b) - c3)) < eps);
+            DLIB_TEST(max(abs(convolver.xcorr(b) - x1)) < eps);
+            DLIB_TEST(max(abs(convolver.xcorr_same(b) - x2)) < eps);
+            DLIB_TEST(x3.size() == 0 || max(abs(convolver.xcorr_valid(b) - x3)) < eps);
+            DLIB_TEST(max(abs(convolver.conv(small) - conv(a,small))) < eps);
+        }
+
+        // Integer convolutions never use FFTs so they stay exact.
+        set_conv_fft_threshold(0);
+        const matrix<int> a = matrix_cast<int>(round(20*randm(20,30,rnd)));
+        const matrix<int> b = matrix_cast<int>(round(20*randm(9,8,rnd)));
+        matrix<int> expected(a.nr()+b.nr()-1, a.nc()+b.nc()-1);
+        expected = 0;
+        for (long r = 0; r < a.nr(); ++r)
+            for (long c = 0; c < a.nc(); ++c)
+                set_subm(expected, r, c, b.nr(), b.nc()) += a(r,c)*b;
+        DLIB_TEST(conv(a,b) == expected);
+        set_conv_fft_threshold(default_threshold);
+    }
+
     void test_complex()
     {
         matrix<complex<double> > a, b;
@@ -1086,6 +1150,92 @@ namespace
 
     }
 
+    template <typename T>
+    void test_default_matrix_multiply()
+    {
+        // Check the float and double default_matrix_multiply() against a simple loop, on
+        // sizes that aren't multiples of the kernel's tile and block sizes and on matrix
+        // expressions rather than just matrices.
+        dlib::rand rnd;
+        for (int iter = 0; iter < 30; ++iter)
+        {
+            const long m = 1 + rnd.get_random_32bit_number()%150;
+            const long n = 1 + rnd.get_random_32bit_number()%150;
+            const long k = 1 + rnd.get_random_32bit_number()%600;
+            const matrix<T> lhs = matrix_cast<T>(randm(m,k,rnd)-0.5);
+            const matrix<T> rhs = matrix_cast<T>(randm(k,n,rnd)-0.5);
+
+            matrix<double> expected(m,n);
+            for (long r = 0; r < m; ++r)
+            {
+                for (long c = 0; c < n; ++c)
+                {
+                    double sum = 0;
+                    for (long i = 0; i < k; ++i)
+                        sum += (double)lhs(r,i)*rhs(i,c);
+                    expected(r,c) = sum;
+                }
+            }
+            const double eps = (sizeof(T) == sizeof(float) ? 1e-5 : 1e-13)*k;
+
+            // default_matrix_multiply() adds to its destination.
+            matrix<T> dest(m,n);
+            dest = 1;
+            default_matrix_multiply(dest, lhs, rhs);
+            DLIB_TEST(max(abs(matrix_cast<double>(dest) - expected - 1)) < eps);
+
+            dest = 0;
+            default_matrix_multiply(dest, trans(matrix<T>(trans(lhs))), 2*rhs);
+            DLIB_TEST(max(abs(matrix_cast<double>(dest) - 2*expected)) < 2*eps);
+
+            matrix<T> big(m+3,n+3);
+            big = 0;
+            auto sub = set_subm(big,1,2,m,n);
+            default_matrix_multiply(sub, lhs, rhs);
+            DLIB_TEST(max(abs(matrix_cast<double>(subm(big,1,2,m,n)) - expected)) < eps);
+            DLIB_TEST(sum(abs(big)) - sum(abs(subm(big,1,2,m,n))) == 0);
+        }
+    }
+
+    template <typename T>
+    void test_threaded_matrix_multiply()
+    {
+        // The packed multiply splits the result into tiles and spreads them over a thread
+        // pool.  Check it gives exactly what a single thread does on sizes that cut
+        // through the tiles in both directions and through the blocks along k.
+        print_spinner();
+        dlib::rand rnd;
+        const long m = 301, n = 2100, k = 300;
+        const matrix<T> lhs = matrix_cast<T>(randm(m,k,rnd)-0.5);
+        const matrix<T> rhs = matrix_cast<T>(randm(k,n,rnd)-0.5);
+        const matrix<T> lhs_t = trans(lhs);
+
+        thread_pool single(0);
+        matrix<T> expected(m,n);
+        expected = 1;
+        ma::packed_matrix_multiply(expected, lhs, rhs, single);
+
+        for (unsigned long num_threads : {2, 3, 4})
+        {
+            thread_pool tp(num_threads);
+            matrix<T> dest(m,n);
+            dest = 1;
+            ma::packed_matrix_multiply(dest, lhs, rhs, tp);
+            DLIB_TEST(dest == expected);
+
+            // The threads also read matrix expressions rather than just matrices.
+            dest = 1;
+            ma::packed_matrix_multiply(dest, trans(lhs_t), rhs, tp);
+            DLIB_TEST(dest == expected);
+        }
+
+        // default_matrix_multiply() does the same tiles without any thread pool.
+        matrix<T> dest(m,n);
+        dest = 1;
+        default_matrix_multiply(dest, lhs, rhs);
+        DLIB_TEST(dest == expected);
+    }
+
     class matrix_tester : public tester
     {
     public:
@@ -1108,8 +1258,14 @@ namespace
             for (int i = 0; i < 10; ++i)
                 matrix_test();
 
+            test_fft_conv<double>();
+            test_fft_conv<float>();
             test_complex();
             test_linpiece();
+            test_default_matrix_multiply<float>();
+            test_default_matrix_multiply<double>();
+            test_threaded_matrix_multiply<float>();
+            test_threaded_matrix_multiply<double>();
         }
     } a;
 
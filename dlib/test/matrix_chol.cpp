@@ -135,6 +135,10 @@ namespace
 
         typedef matrix<double,0,0,default_memory_manager, column_major_layout> mat;
         test_cholesky(mat(uniform_matrix<double>(101,101,1) + 10*symm(randmat<double>(101,101))));
+
+        // big enough to be factored in several blocks
+        test_cholesky(uniform_matrix<double>(300,300,1) + 10*symm(randmat<double>(300,300)));
+        test_cholesky(mat(uniform_matrix<double>(200,200,1) + 10*symm(randmat<double>(200,200))));
     }
 
 // ----------------------------------------------------------------------------------------
@@ -148,8 +152,171 @@ namespace
 
         typedef matrix<float,0,0,default_memory_manager, column_major_layout> mat;
         test_cholesky(mat(uniform_matrix<float>(3,3,1) + 2*symm(randmat<float>(3,3))));
+        test_cholesky(uniform_matrix<float>(150,150,1) + 2*symm(randmat<float>(150,150)));
     }
 
+// ----------------------------------------------------------------------------------------
+
+#ifndef DLIB_USE_LAPACK
+    // With LAPACK, cholesky_decomposition calls potrf instead of the blocked code and
+    // potrf makes its own is_spd() call on borderline matrices.
+
+    template <typename type>
+    bool unblocked_cholesky (
+        const matrix<type>& A,
+        matrix<type>& L
+    )
+    /*!
+        requires
+            - A.nr() == A.nc()
+        ensures
+            - Computes the Cholesky decomposition of A the way cholesky_decomposition did
+              before it was blocked, one column at a time with dot products.  #L is what
+              get_l() returned and the return value is what is_spd() returned.
+    !*/
+    {
+        bool isspd = true;
+        const long n = A.nc();
+        L.set_size(n,n); 
+
+        const type eps = std::numeric_limits<type>::epsilon();
+        const type eps2 = max(abs(diag(A)))*std::sqrt(std::numeric_limits<type>::epsilon())/100;
+
+        // compute the upper left corner
+        if (A(0,0) > 0)
+        {
+            L(0,0) = std::sqrt(A(0,0));
+            if (A(0,0) <= eps2)
+                isspd = false;
+        }
+        else
+        {
+            isspd = false;
+            L(0,0) = 0;
+        }
+
+        // compute the first column
+        for (long r = 1; r < A.nr(); ++r)
+        {
+            if (L(0,0) > eps*std::abs(A(r,0)))
+            {
+                L(r,0) = A(r,0)/L(0,0);
+            }
+            else
+            {
+                isspd = false;
+                L(r,0) = 0;
+            }
+
+            isspd = isspd && (std::abs(A(r,0) - A(0,r)) <= eps*std::abs(A(r,0)) ); 
+        }
+
+        // now compute all the other columns
+        for (long c = 1; c < A.nc(); ++c)
+        {
+            // compute the diagonal element
+            type temp = A(c,c);
+            for (long i = 0; i < c; ++i)
+                temp -= L(c,i)*L(c,i);
+
+            if (temp > 0)
+            {
+                L(c,c) = std::sqrt(temp);
+                if (temp <= eps2)
+                    isspd = false;
+            }
+            else
+            {
+                L(c,c) = 0;
+                isspd = false;
+            }
+
+            for (long r = 0; r < c; ++r)
+                L(r,c) = 0;
+
+            // compute the non diagonal elements
+            for (long r = c+1; r < A.nr(); ++r)
+            {
+                temp = A(r,c);
+                for (long i = 0; i < c; ++i)
+                    temp -= L(r,i)*L(c,i);
+
+                if (L(c,c) > eps*std::abs(temp))
+                {
+                    L(r,c) = temp/L(c,c);
+                }
+                else
+                {
+                    isspd = false;
+                    L(r,c) = 0;
+                }
+
+                isspd = isspd && (std::abs(A(r,c) - A(c,r)) <= eps*std::abs(A(r,c)) ); 
+            }
+        }
+        return isspd;
+    }
+
+    template <typename type>
+    void test_cholesky_against_unblocked (
+        const matrix<type>& A,
+        long rank
+    )
+    /*!
+        requires
+            - The first rank columns of A's Cholesky factor are well defined, and rank
+              == A.nc() if A is positive definite.
+        ensures
+            - Checks that cholesky_decomposition gives the same factor and the same
+              is_spd() answer as unblocked_cholesky().  Only the first rank columns of
+              the factors are compared, since after those the pivots are rounding noise.
+    !*/
+    {
+        print_spinner();
+        const long n = A.nc();
+        const type eps = 10000*std::sqrt((type)n)*max(abs(A))*std::numeric_limits<type>::epsilon();
+        dlog << LDEBUG << "test_cholesky_against_unblocked():  " << n << " x " << n << "  rank: " << rank;
+
+        cholesky_decomposition<matrix<type>> test(A);
+        matrix<type> L;
+        const bool isspd = unblocked_cholesky(A, L);
+
+        DLIB_TEST(test.is_spd() == isspd);
+        DLIB_TEST(isspd == (rank == n));
+        const matrix<type> L2 = test.get_l();
+        DLIB_TEST_MSG(max(abs(colm(L2,range(0,rank-1)) - colm(L,range(0,rank-1)))) < eps,
+            max(abs(colm(L2,range(0,rank-1)) - colm(L,range(0,rank-1)))));
+        if (isspd)
+            DLIB_TEST_MSG(max(abs(L2*trans(L2) - A)) < eps, max(abs(L2*trans(L2) - A)));
+    }
+
+    void test_blocked_cholesky()
+    {
+        // Compare against unblocked_cholesky() on sizes on both sides of the block size,
+        // on positive semidefinite matrices of low rank, and on matrices that are only
+        // not positive definite because of their last diagonal element.
+        const long bs = blocked_la::block_size;
+        const long sizes[] = {bs-1, bs, bs+1, 2*bs+3};
+        for (long n : sizes)
+        {
+            test_cholesky_against_unblocked<double>(uniform_matrix<double>(n,n,1) + 10*symm(randmat<double>(n,n)), n);
+
+            for (long rank : {n/2, n-2})
+            {
+                const matrix<double> B = randmat<double>(n,rank);
+                test_cholesky_against_unblocked<double>(10*B*trans(B), rank);
+            }
+
+            matrix<double> A = uniform_matrix<double>(n,n,1) + 10*symm(randmat<double>(n,n));
+            const matrix<double> L = chol(A);
+            A(n-1,n-1) -= L(n-1,n-1)*L(n-1,n-1) + 1;
+            test_cholesky_against_unblocked(A, n-1);
+        }
+        test_cholesky_against_unblocked<float>(uniform_matrix<float>(2*bs+3,2*bs+3,1) + 2*symm(randmat<float>(2*bs+3,2*bs+3)), 2*bs+3);
+    }
+
+#endif // DLIB_USE_LAPACK
+
 // ----------------------------------------------------------------------------------------
 
     class matrix_tester : public tester
@@ -172,6 +339,10 @@ namespace
             matrix_test_double();
             dlog << LINFO << "begin testing with float";
             matrix_test_float();
+#ifndef DLIB_USE_LAPACK
+            dlog << LINFO << "begin comparing with the unblocked algorithm";
+            test_blocked_cholesky();
+#endif
         }
     } a;
 
@@ -208,6 +208,324 @@ namespace
         }
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename type>
+    void test_big_symmetric_eigenvalues()
+    {
+        // Big symmetric matrices are reduced to tridiagonal form a block of columns at
+        // a time.  Check the results against the singular values computed by svd(),
+        // which are the same as the eigenvalues since these matrices are positive
+        // definite.
+        const long sizes[] = {65, 128, 200, 301};
+        for (long n : sizes)
+        {
+            print_spinner();
+            matrix<type> m = randm<type>(n,n);
+            m = m*trans(m) + identity_matrix<type>(n);
+            const type eps = 10*max(abs(m))*sqrt(std::numeric_limits<type>::epsilon());
+
+            eigenvalue_decomposition<matrix<type> > test(make_symmetric(m));
+            const matrix<type> V = test.get_pseudo_v();
+            DLIB_TEST(equal(trans(V)*V, identity_matrix<type>(n), eps));
+            DLIB_TEST_MSG(equal(m, V*diagm(test.get_real_eigenvalues())*trans(V), eps),
+                max(abs(m - V*diagm(test.get_real_eigenvalues())*trans(V))));
+
+            matrix<type> u, w, v;
+            svd(m, u, w, v);
+            matrix<type,0,1> eig1 = test.get_real_eigenvalues();
+            matrix<type,0,1> eig2 = diag(w);
+            sort(&eig1(0), &eig1(0) + eig1.size());
+            sort(&eig2(0), &eig2(0) + eig2.size());
+            DLIB_TEST_MSG(max(abs(eig1 - eig2)) < eps, max(abs(eig1 - eig2)));
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+#ifndef DLIB_USE_LAPACK
+    // With LAPACK, symmetric matrices go to syevr instead of the blocked tridiagonal
+    // reduction.
+
+    template <typename type>
+    void unblocked_symmetric_eigenvalues (
+        const matrix<type>& A,
+        matrix<type>& V,
+        matrix<type,0,1>& d
+    )
+    /*!
+        requires
+            - A is symmetric
+        ensures
+            - Computes the eigenvalues and eigenvectors of A the way
+              eigenvalue_decomposition did before it was blocked, reducing A to
+              tridiagonal form with tred2 and then diagonalizing it with tql2, both a
+              row or column at a time.  #d holds the eigenvalues, in no particular
+              order, and the columns of #V the eigenvectors.
+    !*/
+    {
+        using std::abs;
+        using std::sqrt;
+        const long n = A.nr();
+        V = A;
+        d.set_size(n);
+        matrix<type,0,1> e(n);
+
+        // tred2: Symmetric Householder reduction to tridiagonal form.
+        for (long j = 0; j < n; j++) 
+            d(j) = V(n-1,j);
+
+        for (long i = n-1; i > 0; i--) 
+        {
+            // Scale to avoid under/overflow.
+            type scale = 0.0;
+            type h = 0.0;
+            for (long k = 0; k < i; k++) 
+                scale = scale + abs(d(k));
+            if (scale == 0.0) 
+            {
+                e(i) = d(i-1);
+                for (long j = 0; j < i; j++) 
+                {
+                    d(j) = V(i-1,j);
+                    V(i,j) = 0.0;
+                    V(j,i) = 0.0;
+                }
+            }
+            else 
+            {
+                // Generate Householder vector.
+                for (long k = 0; k < i; k++) 
+                {
+                    d(k) /= scale;
+                    h += d(k) * d(k);
+                }
+                type f = d(i-1);
+                type g = sqrt(h);
+                if (f > 0) 
+                    g = -g;
+                e(i) = scale * g;
+                h = h - f * g;
+                d(i-1) = f - g;
+                for (long j = 0; j < i; j++) 
+                    e(j) = 0.0;
+
+                // Apply similarity transformation to remaining columns.
+                for (long j = 0; j < i; j++) 
+                {
+                    f = d(j);
+                    V(j,i) = f;
+                    g = e(j) + V(j,j) * f;
+                    for (long k = j+1; k <= i-1; k++) 
+                    {
+                        g += V(k,j) * d(k);
+                        e(k) += V(k,j) * f;
+                    }
+                    e(j) = g;
+                }
+                f = 0.0;
+                for (long j = 0; j < i; j++) 
+                {
+                    e(j) /= h;
+                    f += e(j) * d(j);
+                }
+                type hh = f / (h + h);
+                for (long j = 0; j < i; j++) 
+                    e(j) -= hh * d(j);
+                for (long j = 0; j < i; j++) 
+                {
+                    f = d(j);
+                    g = e(j);
+                    for (long k = j; k <= i-1; k++) 
+                        V(k,j) -= (f * e(k) + g * d(k));
+                    d(j) = V(i-1,j);
+                    V(i,j) = 0.0;
+                }
+            }
+            d(i) = h;
+        }
+
+        // Accumulate transformations.
+        for (long i = 0; i < n-1; i++) 
+        {
+            V(n-1,i) = V(i,i);
+            V(i,i) = 1.0;
+            type h = d(i+1);
+            if (h != 0.0) 
+            {
+                for (long k = 0; k <= i; k++) 
+                    d(k) = V(k,i+1) / h;
+                for (long j = 0; j <= i; j++) 
+                {
+                    type g = 0.0;
+                    for (long k = 0; k <= i; k++) 
+                        g += V(k,i+1) * V(k,j);
+                    for (long k = 0; k <= i; k++) 
+                        V(k,j) -= g * d(k);
+                }
+            }
+            for (long k = 0; k <= i; k++) 
+                V(k,i+1) = 0.0;
+        }
+        for (long j = 0; j < n; j++) 
+        {
+            d(j) = V(n-1,j);
+            V(n-1,j) = 0.0;
+        }
+        V(n-1,n-1) = 1.0;
+        e(0) = 0.0;
+
+        // tql2: Symmetric tridiagonal QL algorithm.
+        for (long i = 1; i < n; i++) 
+            e(i-1) = e(i);
+        e(n-1) = 0.0;
+
+        type f = 0.0;
+        type tst1 = 0.0;
+        const type eps = std::numeric_limits<type>::epsilon();
+        for (long l = 0; l < n; l++) 
+        {
+            // Find small subdiagonal element
+            tst1 = std::max(tst1,abs(d(l)) + abs(e(l)));
+            long m = l;
+            while (m < n) 
+            {
+                if (abs(e(m)) <= eps*tst1) 
+                    break;
+                m++;
+            }
+            if (m == n)
+                --m;
+
+            // If m == l, d(l) is an eigenvalue, otherwise, iterate.
+            if (m > l) 
+            {
+                do 
+                {
+                    // Compute implicit shift
+                    type g = d(l);
+                    type p = (d(l+1) - g) / (2.0 * e(l));
+                    type r = std::hypot(p,(type)1.0);
+                    if (p < 0) 
+                        r = -r;
+                    d(l) = e(l) / (p + r);
+                    d(l+1) = e(l) * (p + r);
+                    type dl1 = d(l+1);
+                    type h = g - d(l);
+                    for (long i = l+2; i < n; i++) 
+                        d(i) -= h;
+                    f = f + h;
+
+                    // Implicit QL transformation.
+                    p = d(m);
+                    type c = 1.0;
+                    type c2 = c;
+                    type c3 = c;
+                    type el1 = e(l+1);
+                    type s = 0.0;
+                    type s2 = 0.0;
+                    for (long i = m-1; i >= l; i--) 
+                    {
+                        c3 = c2;
+                        c2 = c;
+                        s2 = s;
+                        g = c * e(i);
+                        h = c * p;
+                        r = std::hypot(p,e(i));
+                        e(i+1) = s * r;
+                        s = e(i) / r;
+                        c = p / r;
+                        p = c * d(i) - s * g;
+                        d(i+1) = h + s * (c * g + s * d(i));
+
+                        // Accumulate transformation.
+                        for (long k = 0; k < n; k++) 
+                        {
+                            h = V(k,i+1);
+                            V(k,i+1) = s * V(k,i) + c * h;
+                            V(k,i) = c * V(k,i) - s * h;
+                        }
+                    }
+                    p = -s * s2 * c3 * el1 * e(l) / dl1;
+                    e(l) = s * p;
+                    d(l) = c * p;
+
+                    // Check for convergence.
+                } while (abs(e(l)) > eps*tst1);
+            }
+            d(l) = d(l) + f;
+            e(l) = 0.0;
+        }
+    }
+
+    template <typename type>
+    void test_symmetric_eigenvalues_against_unblocked (
+        const matrix<type>& A
+    )
+    /*!
+        requires
+            - A is symmetric and its eigenvalues are well separated.
+        ensures
+            - Checks that eigenvalue_decomposition gives the same eigenvalues and
+              eigenvectors as unblocked_symmetric_eigenvalues(), up to their order and
+              the signs of the eigenvectors.
+    !*/
+    {
+        print_spinner();
+        const long n = A.nr();
+        const type eps = 10000*std::sqrt((type)n)*max(abs(A))*std::numeric_limits<type>::epsilon();
+        dlog << LDEBUG << "test_symmetric_eigenvalues_against_unblocked():  " << n << " x " << n;
+
+        matrix<type> V;
+        matrix<type,0,1> d;
+        unblocked_symmetric_eigenvalues(A, V, d);
+
+        // A symmetric matrix goes down the same path whether or not it's marked as one.
+        eigenvalue_decomposition<matrix<type>> test1(A);
+        eigenvalue_decomposition<matrix<type>> test2(make_symmetric(A));
+        for (auto test : {&test1, &test2})
+        {
+            const matrix<type> V2 = test->get_pseudo_v();
+            const matrix<type,0,1> d2 = test->get_real_eigenvalues();
+            DLIB_TEST(max(abs(test->get_imag_eigenvalues())) == 0);
+
+            // Pair up the eigenvalues by sorting them.
+            std::vector<std::pair<type,long>> order1, order2;
+            for (long i = 0; i < n; ++i)
+            {
+                order1.push_back(std::make_pair(d(i), i));
+                order2.push_back(std::make_pair(d2(i), i));
+            }
+            std::sort(order1.begin(), order1.end());
+            std::sort(order2.begin(), order2.end());
+            for (long i = 0; i < n; ++i)
+            {
+                const long i1 = order1[i].second;
+                const long i2 = order2[i].second;
+                DLIB_TEST_MSG(std::abs(d(i1) - d2(i2)) < eps, std::abs(d(i1) - d2(i2)));
+                const type dot_product = dot(colm(V,i1), colm(V2,i2));
+                DLIB_TEST_MSG(std::abs(std::abs(dot_product) - 1) < eps/max(abs(A)), dot_product);
+            }
+        }
+    }
+
+    void test_blocked_symmetric_eigenvalues()
+    {
+        // Compare against unblocked_symmetric_eigenvalues() on sizes on both sides of
+        // the block size.
+        const long bs = blocked_la::block_size;
+        const long sizes[] = {bs-1, bs, bs+1, 2*bs+3};
+        for (long n : sizes)
+        {
+            const matrix<double> m = randm<double>(n,n);
+            test_symmetric_eigenvalues_against_unblocked<double>(10*(m + trans(m)));
+        }
+        const matrix<float> m = randm<float>(2*bs+3,2*bs+3);
+        test_symmetric_eigenvalues_against_unblocked<float>(m + trans(m));
+    }
+
+#endif // DLIB_USE_LAPACK
+
 // ----------------------------------------------------------------------------------------
 
     class matrix_tester : public tester
@@ -236,6 +554,14 @@ namespace
             test_eigenvalue2<3>();
             test_eigenvalue2<2>();
             test_eigenvalue2<1>();
+
+            test_big_symmetric_eigenvalues<double>();
+            test_big_symmetric_eigenvalues<float>();
+
+#ifndef DLIB_USE_LAPACK
+            dlog << LINFO << "begin comparing with the unblocked algorithm";
+            test_blocked_symmetric_eigenvalues();
+#endif
         }
     } a;
 
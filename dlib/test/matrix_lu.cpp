@@ -160,6 +160,7 @@ namespace
         test_lu(mat(3*randmat<double>(4,4)));
         test_lu(mat(3*randmat<double>(9,4)));
         test_lu(mat(3*randmat<double>(3,8)));
+        test_lu(mat(3*randmat<double>(300,300)));
     }
 
 // ----------------------------------------------------------------------------------------
@@ -192,6 +193,154 @@ namespace
         test_lu(mat(3*randmat<float>(3,8)));
     }
 
+// ----------------------------------------------------------------------------------------
+
+#ifndef DLIB_USE_LAPACK
+    // With LAPACK, lu_decomposition calls getrf instead of the blocked code.
+
+    template <typename type>
+    void unblocked_lu (
+        const matrix<type>& A,
+        matrix<type>& LU,
+        matrix<long,0,1>& piv
+    )
+    /*!
+        ensures
+            - Computes the LU decomposition of A the way lu_decomposition did before it
+              was blocked, one column at a time with a left-looking Crout/Doolittle
+              algorithm.  That is, #LU holds L below the diagonal and U on and above it,
+              and rowm(A,#piv) == L*U.
+    !*/
+    {
+        using std::abs;
+        const long m = A.nr();
+        const long n = A.nc();
+        LU = A;
+        piv = trans(range(0,m-1));
+
+        matrix<type,0,1> LUcolj(m);
+        for (long j = 0; j < n; j++) 
+        {
+            LUcolj = colm(LU,j);
+
+            // Apply previous transformations.
+            for (long i = 0; i < m; i++) 
+            {
+                const long kmax = std::min(i,j);
+                type s;
+                if (kmax > 0)
+                    s = rowm(LU,i, kmax)*colm(LUcolj,0,kmax);
+                else 
+                    s = 0;
+
+                LU(i,j) = LUcolj(i) -= s;
+            }
+
+            // Find pivot and exchange if necessary.
+            long p = j;
+            for (long i = j+1; i < m; i++) 
+            {
+                if (abs(LUcolj(i)) > abs(LUcolj(p))) 
+                    p = i;
+            }
+            if (p != j) 
+            {
+                for (long k = 0; k < n; k++) 
+                    std::swap(LU(p,k), LU(j,k));
+                std::swap(piv(p), piv(j));
+            }
+
+            // Compute multipliers.
+            if ((j < m) && (LU(j,j) != 0.0)) 
+            {
+                for (long i = j+1; i < m; i++) 
+                    LU(i,j) /= LU(j,j);
+            }
+        }
+    }
+
+    template <typename type>
+    void test_lu_against_unblocked (
+        const matrix<type>& A,
+        long rank
+    )
+    /*!
+        requires
+            - rank is the numerical rank of A, or min(A.nr(),A.nc()) if A is full rank.
+        ensures
+            - Checks that lu_decomposition gives the same factors as unblocked_lu().  For
+              the first rank columns the two do the same arithmetic in a different order,
+              so they should agree up to rounding.  After that the columns are rounding
+              noise and the pivots picked from them are arbitrary, so the trailing block
+              of U only has to be small in both.
+    !*/
+    {
+        print_spinner();
+        const long m = A.nr();
+        const long n = A.nc();
+        const type eps = 10000*std::sqrt((type)std::max(m,n))*max(abs(A))*std::numeric_limits<type>::epsilon();
+        dlog << LDEBUG << "test_lu_against_unblocked():  " << m << " x " << n << "  rank: " << rank;
+
+        lu_decomposition<matrix<type>> test(A);
+        matrix<type> LU;
+        matrix<long,0,1> piv;
+        unblocked_lu(A, LU, piv);
+
+        const matrix<type> L = test.get_l();
+        const matrix<type> U = test.get_u();
+        DLIB_TEST_MSG(max(abs(L*U - rowm(A,test.get_pivot()))) < eps, max(abs(L*U - rowm(A,test.get_pivot()))));
+
+        // The first rank pivots and rows of U match.
+        DLIB_TEST(rowm(test.get_pivot(), range(0,rank-1)) == rowm(piv, range(0,rank-1)));
+        DLIB_TEST_MSG(max(abs(subm(U,0,0,rank,n) - upperm(subm(LU,0,0,rank,n)))) < eps,
+            max(abs(subm(U,0,0,rank,n) - upperm(subm(LU,0,0,rank,n)))));
+
+        // Later pivoting moves the rows of the first rank columns of L around, so compare
+        // them by the row of A they came from.
+        matrix<type> L1(m,rank), L2(m,rank);
+        for (long i = 0; i < m; ++i)
+        {
+            set_rowm(L1, test.get_pivot()(i)) = subm(L, i, 0, 1, rank);
+            set_rowm(L2, piv(i)) = subm(lowerm(LU,1), i, 0, 1, rank);
+        }
+        DLIB_TEST_MSG(max(abs(L1 - L2)) < eps/max(abs(A)), max(abs(L1 - L2)));
+
+        if (rank < std::min(m,n))
+        {
+            const long mn = std::min(m,n);
+            DLIB_TEST(max(abs(upperm(subm(U,rank,rank,mn-rank,n-rank)))) < eps);
+            DLIB_TEST(max(abs(upperm(subm(LU,rank,rank,mn-rank,n-rank)))) < eps);
+        }
+    }
+
+    void test_blocked_lu()
+    {
+        // Compare against unblocked_lu() on sizes on both sides of the block size, on
+        // matrices of low rank, and on nearly singular matrices whose last column is
+        // almost a copy of another one.
+        const long bs = blocked_la::block_size;
+        const long sizes[] = {bs-1, bs, bs+1, 2*bs+3};
+        for (long n : sizes)
+        {
+            test_lu_against_unblocked<double>(10*randmat<double>(n,n), n);
+            test_lu_against_unblocked<double>(10*randmat<double>(n+7,n), n);
+            test_lu_against_unblocked<double>(10*randmat<double>(n,n+7), n);
+
+            for (long rank : {n/2, n-2})
+            {
+                test_lu_against_unblocked<double>(10*randmat<double>(n,rank)*randmat<double>(rank,n), rank);
+                test_lu_against_unblocked<double>(10*randmat<double>(n+7,rank)*randmat<double>(rank,n), rank);
+            }
+
+            matrix<double> A = 10*randmat<double>(n,n);
+            set_colm(A,n-1) = colm(A,3) + 1e-9*randmat<double>(n,1);
+            test_lu_against_unblocked(A, n);
+        }
+        test_lu_against_unblocked<float>(3*randmat<float>(2*bs+3,2*bs+3), 2*bs+3);
+    }
+
+#endif // DLIB_USE_LAPACK
+
 // ----------------------------------------------------------------------------------------
 
     class matrix_tester : public tester
@@ -214,6 +363,10 @@ namespace
             matrix_test_double();
             dlog << LINFO << "begin testing with float";
             matrix_test_float();
+#ifndef DLIB_USE_LAPACK
+            dlog << LINFO << "begin comparing with the unblocked algorithm";
+            test_blocked_lu();
+#endif
         }
     } a;
 
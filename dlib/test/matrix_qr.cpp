@@ -152,6 +152,7 @@ namespace
         typedef matrix<double,0,0,default_memory_manager, column_major_layout> mat;
         test_qr(mat(3*randmat<double>(9,4)));
         test_qr(mat(3*randmat<double>(9,9)));
+        test_qr(mat(3*randmat<double>(300,250)));
     }
 
 // ----------------------------------------------------------------------------------------
@@ -177,6 +178,165 @@ namespace
         test_qr(mat(3*randmat<float>(9,9)));
     }
 
+// ----------------------------------------------------------------------------------------
+
+#ifndef DLIB_USE_LAPACK
+    // With LAPACK, qr_decomposition calls geqrf instead of the blocked code and the
+    // signs of its Householder vectors, and so of the columns of Q, may differ.
+
+    template <typename type>
+    bool unblocked_qr (
+        const matrix<type>& A,
+        matrix<type>& Q,
+        matrix<type>& R
+    )
+    /*!
+        requires
+            - A.nr() >= A.nc()
+        ensures
+            - Computes the QR decomposition of A the way qr_decomposition did before it
+              was blocked, applying each Householder reflection to the rest of the
+              matrix as soon as it's found.  #Q and #R are what get_q() and get_r()
+              returned and the return value is what is_full_rank() returned.
+    !*/
+    {
+        const long m = A.nr();
+        const long n = A.nc();
+        matrix<type> QR_ = A;
+        matrix<type,0,1> Rdiag(n);
+
+        for (long k = 0; k < n; k++) 
+        {
+            // Compute 2-norm of k-th column without under/overflow.
+            type nrm = 0;
+            for (long i = k; i < m; i++) 
+                nrm = std::hypot(nrm,QR_(i,k));
+
+            if (nrm != 0.0) 
+            {
+                // Form k-th Householder vector.
+                if (QR_(k,k) < 0) 
+                    nrm = -nrm;
+                for (long i = k; i < m; i++) 
+                    QR_(i,k) /= nrm;
+                QR_(k,k) += 1.0;
+
+                // Apply transformation to remaining columns.
+                for (long j = k+1; j < n; j++) 
+                {
+                    type s = 0.0; 
+                    for (long i = k; i < m; i++) 
+                        s += QR_(i,k)*QR_(i,j);
+                    s = -s/QR_(k,k);
+                    for (long i = k; i < m; i++) 
+                        QR_(i,j) += s*QR_(i,k);
+                }
+            }
+            Rdiag(k) = -nrm;
+        }
+
+        R = upperm(subm(QR_,0,0,n,n));
+        for (long k = 0; k < n; k++) 
+            R(k,k) = Rdiag(k);
+
+        Q.set_size(m,n);
+        for (long k = n-1; k >= 0; k--) 
+        {
+            set_colm(Q,k) = 0;
+            Q(k,k) = 1.0;
+            for (long j = k; j < n; j++) 
+            {
+                if (QR_(k,k) != 0) 
+                {
+                    type s = 0.0;
+                    for (long i = k; i < m; i++) 
+                        s += QR_(i,k)*Q(i,j);
+                    s = -s/QR_(k,k);
+                    for (long i = k; i < m; i++) 
+                        Q(i,j) += s*QR_(i,k);
+                }
+            }
+        }
+
+        type eps = max(abs(Rdiag));
+        if (eps != 0)
+            eps *= std::sqrt(std::numeric_limits<type>::epsilon())/100;
+        else
+            eps = 1;
+        return min(abs(Rdiag)) > eps;
+    }
+
+    template <typename type>
+    void test_qr_against_unblocked (
+        const matrix<type>& A,
+        long rank
+    )
+    /*!
+        requires
+            - rank is the numerical rank of A, or A.nc() if A is full rank.
+        ensures
+            - Checks that qr_decomposition gives the same factors as unblocked_qr().  The
+              first rank columns of Q and rows of R should agree up to rounding.  After
+              that the columns are rounding noise, so the reflections made from them are
+              arbitrary and the trailing block of R only has to be small in both.
+    !*/
+    {
+        print_spinner();
+        const long m = A.nr();
+        const long n = A.nc();
+        const type eps = 10000*std::sqrt((type)m)*max(abs(A))*std::numeric_limits<type>::epsilon();
+        dlog << LDEBUG << "test_qr_against_unblocked():  " << m << " x " << n << "  rank: " << rank;
+
+        qr_decomposition<matrix<type>> test(A);
+        matrix<type> Q, R;
+        const bool full_rank = unblocked_qr(A, Q, R);
+
+        const matrix<type> Q2 = test.get_q();
+        const matrix<type> R2 = test.get_r();
+        DLIB_TEST_MSG(max(abs(Q2*R2 - A)) < eps, max(abs(Q2*R2 - A)));
+        DLIB_TEST(max(abs(trans(Q2)*Q2 - identity_matrix<type>(n))) < eps/max(abs(A)));
+        DLIB_TEST(test.is_full_rank() == full_rank);
+        DLIB_TEST(full_rank == (rank == n));
+
+        DLIB_TEST_MSG(max(abs(colm(Q2,range(0,rank-1)) - colm(Q,range(0,rank-1)))) < eps/max(abs(A)),
+            max(abs(colm(Q2,range(0,rank-1)) - colm(Q,range(0,rank-1)))));
+        DLIB_TEST_MSG(max(abs(rowm(R2,range(0,rank-1)) - rowm(R,range(0,rank-1)))) < eps,
+            max(abs(rowm(R2,range(0,rank-1)) - rowm(R,range(0,rank-1)))));
+
+        if (rank < n)
+        {
+            DLIB_TEST(max(abs(subm(R2,rank,rank,n-rank,n-rank))) < eps);
+            DLIB_TEST(max(abs(subm(R,rank,rank,n-rank,n-rank))) < eps);
+        }
+    }
+
+    void test_blocked_qr()
+    {
+        // Compare against unblocked_qr() on sizes on both sides of the block size, on
+        // matrices of low rank, and on nearly singular matrices whose last column is
+        // almost a copy of another one.
+        const long bs = blocked_la::block_size;
+        const long sizes[] = {bs-1, bs, bs+1, 2*bs+3};
+        for (long n : sizes)
+        {
+            test_qr_against_unblocked<double>(10*randmat<double>(n,n), n);
+            test_qr_against_unblocked<double>(10*randmat<double>(n+7,n), n);
+
+            for (long rank : {n/2, n-2})
+            {
+                test_qr_against_unblocked<double>(10*randmat<double>(n,rank)*randmat<double>(rank,n), rank);
+                test_qr_against_unblocked<double>(10*randmat<double>(n+7,rank)*randmat<double>(rank,n), rank);
+            }
+
+            matrix<double> A = 10*randmat<double>(n,n);
+            set_colm(A,n-1) = colm(A,3) + 1e-12*randmat<double>(n,1);
+            test_qr_against_unblocked(A, n-1);
+        }
+        test_qr_against_unblocked<float>(3*randmat<float>(2*bs+3,2*bs+3), 2*bs+3);
+    }
+
+#endif // DLIB_USE_LAPACK
+
 // ----------------------------------------------------------------------------------------
 
     class matrix_tester : public tester
@@ -199,6 +359,10 @@ namespace
             matrix_test_double();
             dlog << LINFO << "begin testing with float";
             matrix_test_float();
+#ifndef DLIB_USE_LAPACK
+            dlog << LINFO << "begin comparing with the unblocked algorithm";
+            test_blocked_qr();
+#endif
         }
     } a;
 
@@ -993,6 +993,83 @@ namespace
         }
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void test_non_max_suppression (
+    )
+    {
+        print_spinner();
+        dlib::rand rnd;
+        for (int iter = 0; iter < 50; ++iter)
+        {
+            // Boxes of very different sizes, some partly outside the image and some
+            // empty, with a few overlap testers, including one that counts any
+            // intersection as an overlap.
+            std::vector<rectangle> boxes;
+            const long num = rnd.get_random_32bit_number()%500;
+            for (long i = 0; i < num; ++i)
+            {
+                const long size = 1 + rnd.get_random_32bit_number()%(iter%2 ? 20 : 200);
+                const long x = rnd.get_integer_in_range(-50, 600);
+                const long y = rnd.get_integer_in_range(-50, 400);
+                if (i%50 == 7)
+                    boxes.push_back(rectangle(x, y, x-1, y-1));
+                else
+                    boxes.push_back(rectangle(x, y, x+size, y+size*2/3));
+            }
+
+            const test_box_overlap testers[] = {test_box_overlap(), test_box_overlap(0,0), test_box_overlap(0.3, 0.9)};
+            for (auto& tester : testers)
+            {
+                std::vector<unsigned long> keep;
+                std::vector<rectangle> kept;
+                for (unsigned long i = 0; i < boxes.size(); ++i)
+                {
+                    if (!overlaps_any_box(tester, kept, boxes[i]))
+                    {
+                        keep.push_back(i);
+                        kept.push_back(boxes[i]);
+                    }
+                }
+                DLIB_TEST(non_max_suppression(tester, boxes) == keep);
+
+                box_overlap_index index(tester, rectangle(0,0,100,100), 1 + iter%37);
+                for (unsigned long i = 0; i < boxes.size(); ++i)
+                {
+                    DLIB_TEST(index.overlaps_any_box(boxes[i]) == overlaps_any_box(tester, index.get_boxes(), boxes[i]));
+                    if (i%3 == 0)
+                        index.add(boxes[i]);
+                }
+                DLIB_TEST(index.size() == (boxes.size()+2)/3);
+                index.clear();
+                DLIB_TEST(index.size() == 0);
+                DLIB_TEST(!index.overlaps_any_box(rectangle(0,0,10,10)));
+            }
+        }
+
+        std::vector<float> scores(1000);
+        std::vector<unsigned long> idx;
+        for (int iter = 0; iter < 20; ++iter)
+        {
+            const size_t num = rnd.get_random_32bit_number()%scores.size();
+            for (auto& s : scores)
+                s = rnd.get_random_gaussian()*3;
+            // A threshold between two floats and one that is a float.
+            const double thresh = iter%2 ? 4.00000001 : 4.0;
+            if (num > 10)
+                scores[num/2] = 4.0f;
+
+            find_scores_above_threshold(scores.data(), num, thresh, idx);
+            std::vector<unsigned long> truth;
+            for (size_t i = 0; i < num; ++i)
+            {
+                if (scores[i] > thresh)
+                    truth.push_back(i);
+            }
+            DLIB_TEST(idx == truth);
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class object_detector_tester : public tester
@@ -1007,6 +1084,7 @@ namespace
         void perform_test (
         )
         {
+            test_non_max_suppression();
             test_fhog_pyramid();
             test_1_boxes();
             test_1_poly_nn_boxes();
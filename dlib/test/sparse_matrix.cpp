@@ -0,0 +1,367 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+
+#include <dlib/matrix.h>
+#include <dlib/sparse_vector.h>
+#include <dlib/statistics.h>
+#include <dlib/svm.h>
+#include <dlib/rand.h>
+#include <vector>
+#include <map>
+#include <sstream>
+
+#include "tester.h"
+
+namespace
+{
+    using namespace test;
+    using namespace dlib;
+    using namespace std;
+
+    logger dlog("test.sparse_matrix");
+
+    dlib::rand rnd;
+
+    typedef std::vector<std::pair<unsigned long,double> > sparse_vect;
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    matrix<T> make_sparse_dense_matrix (
+        long nr,
+        long nc,
+        double density
+    )
+    /*!
+        ensures
+            - returns a dense nr by nc matrix where about density of the elements are
+              nonzero.
+    !*/
+    {
+        matrix<T> m(nr,nc);
+        for (long r = 0; r < nr; ++r)
+        {
+            for (long c = 0; c < nc; ++c)
+            {
+                if (rnd.get_random_double() < density)
+                    m(r,c) = static_cast<T>(rnd.get_random_gaussian());
+                else
+                    m(r,c) = 0;
+            }
+        }
+        return m;
+    }
+
+    std::vector<sparse_vect> dense_to_sparse_rows (
+        const matrix<double>& m
+    )
+    {
+        std::vector<sparse_vect> rows(m.nr());
+        for (long r = 0; r < m.nr(); ++r)
+        {
+            for (long c = 0; c < m.nc(); ++c)
+            {
+                if (m(r,c) != 0)
+                    rows[r].push_back(make_pair(c, m(r,c)));
+            }
+        }
+        return rows;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_construction()
+    {
+        print_spinner();
+
+        sparse_matrix<double> empty;
+        DLIB_TEST(empty.nr() == 0);
+        DLIB_TEST(empty.nc() == 0);
+        DLIB_TEST(empty.num_nonzero() == 0);
+
+        sparse_matrix<double> zeros(3,4);
+        DLIB_TEST(zeros.nr() == 3);
+        DLIB_TEST(zeros.nc() == 4);
+        DLIB_TEST(zeros.num_nonzero() == 0);
+        DLIB_TEST(sparse_to_dense(zeros) == zeros_matrix<double>(3,4));
+
+        // unsorted sparse vectors with duplicate keys get summed up.
+        std::vector<sparse_vect> rows(3);
+        rows[0].push_back(make_pair(4, 1.0));
+        rows[0].push_back(make_pair(1, 2.0));
+        rows[0].push_back(make_pair(4, 3.0));
+        rows[2].push_back(make_pair(0, 5.0));
+        rows[2].push_back(make_pair(2, 6.0));
+        sparse_matrix<double> A(rows);
+        DLIB_TEST(A.nr() == 3);
+        DLIB_TEST(A.nc() == 5);
+        DLIB_TEST(A.num_nonzero() == 4);
+        DLIB_TEST(A(0,4) == 4);
+        DLIB_TEST(A(0,1) == 2);
+        DLIB_TEST(A(0,0) == 0);
+        DLIB_TEST(A(1,3) == 0);
+        DLIB_TEST(A(2,2) == 6);
+        DLIB_TEST(A.row(1).size() == 0);
+        DLIB_TEST(A.row(0).size() == 2);
+        DLIB_TEST(A.row(0).begin()->first == 1);
+
+        matrix<double> D(3,5);
+        D = 0, 2, 0, 0, 4,
+            0, 0, 0, 0, 0,
+            5, 0, 6, 0, 0;
+        DLIB_TEST(sparse_to_dense(A) == D);
+        DLIB_TEST(sparse_to_dense(sparse_matrix<double>(D)) == D);
+        DLIB_TEST(sparse_matrix<double>(D).num_nonzero() == 4);
+
+        sparse_matrix<double> B(rows, 10);
+        DLIB_TEST(B.nc() == 10);
+        DLIB_TEST(sparse_to_dense(B) == join_rows(D, zeros_matrix<double>(3,5)));
+
+        std::vector<std::map<unsigned long,double> > map_rows(2);
+        map_rows[0][7] = 1;
+        map_rows[1][2] = 3;
+        map_rows[1][0] = -1;
+        sparse_matrix<double> C(map_rows);
+        DLIB_TEST(C.nr() == 2);
+        DLIB_TEST(C.nc() == 8);
+        DLIB_TEST(C(1,0) == -1);
+        DLIB_TEST(C(1,2) == 3);
+        DLIB_TEST(C(0,7) == 1);
+
+        // the rows are normal sparse vectors.
+        DLIB_TEST(dot(A.row(0), A.row(0)) == 20);
+        DLIB_TEST(max_index_plus_one(A.row(2)) == 3);
+        DLIB_TEST(max_index_plus_one(mat(A)) == 5);
+        DLIB_TEST(max_index_plus_one(mat(B)) == 5);
+        DLIB_TEST(mat(A).size() == 3);
+
+        swap(A, C);
+        DLIB_TEST(A.nr() == 2);
+        DLIB_TEST(C.nr() == 3);
+        DLIB_TEST(sparse_to_dense(C) == D);
+
+        ostringstream sout;
+        serialize(C, sout);
+        istringstream sin(sout.str());
+        sparse_matrix<double> E;
+        deserialize(E, sin);
+        DLIB_TEST(E.nr() == 3);
+        DLIB_TEST(E.nc() == 5);
+        DLIB_TEST(sparse_to_dense(E) == D);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    void test_multiply(
+        long nr,
+        long nc,
+        double density
+    )
+    {
+        print_spinner();
+        const T eps = 100*std::numeric_limits<T>::epsilon()*std::sqrt((T)nc+1);
+
+        const matrix<T> D = make_sparse_dense_matrix<T>(nr, nc, density);
+        const sparse_matrix<T> A(D);
+        DLIB_TEST(sparse_to_dense(A) == D);
+        DLIB_TEST(sparse_to_dense(trans(A)) == trans(D));
+        DLIB_TEST(sparse_to_dense(trans(trans(A))) == D);
+
+        const long widths[] = {1, 3, 8, 19};
+        for (long k : widths)
+        {
+            const matrix<T> X = matrix_cast<T>(gaussian_randm(nc, k, k));
+            const matrix<T> Xt = matrix_cast<T>(gaussian_randm(nr, k, k+1));
+
+            matrix<T> Y = A*X;
+            DLIB_TEST(Y.nr() == nr);
+            DLIB_TEST(Y.nc() == k);
+            DLIB_TEST_MSG(max(abs(Y - D*X)) < eps, max(abs(Y - D*X)));
+
+            Y = trans(A)*Xt;
+            DLIB_TEST_MSG(max(abs(Y - trans(D)*Xt)) < eps, max(abs(Y - trans(D)*Xt)));
+
+            // column major inputs and general expressions work too.
+            matrix<T,0,0,default_memory_manager,column_major_layout> Xc(X);
+            DLIB_TEST(max(abs(A*Xc - D*X)) < eps);
+            DLIB_TEST(max(abs(A*(2*X) - 2*D*X)) < 2*eps);
+        }
+
+        const matrix<T,0,1> x = matrix_cast<T>(gaussian_randm(nc, 1, 7));
+        const matrix<T,0,1> y = A*x;
+        DLIB_TEST(y.size() == nr);
+        DLIB_TEST(max(abs(y - D*x)) < eps);
+        const matrix<T> X2 = matrix_cast<T>(gaussian_randm(nc, 3, 8));
+        DLIB_TEST(max(abs(A*colm(X2,1) - D*colm(X2,1))) < eps);
+    }
+
+    void test_empty_multiply()
+    {
+        print_spinner();
+        const sparse_matrix<double> A(0,5), B(5,0);
+        matrix<double> Y = A*gaussian_randm(5,3);
+        DLIB_TEST(Y.nr() == 0);
+        DLIB_TEST(Y.nc() == 3);
+        Y = B*matrix<double>(0,3);
+        DLIB_TEST(Y == zeros_matrix<double>(5,3));
+        Y = trans(A)*matrix<double>(0,3);
+        DLIB_TEST(Y == zeros_matrix<double>(5,3));
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_find_matrix_range()
+    {
+        print_spinner();
+        const matrix<double> D = make_sparse_dense_matrix<double>(60, 40, 0.2);
+        const std::vector<sparse_vect> rows = dense_to_sparse_rows(D);
+        const sparse_matrix<double> A(rows, D.nc());
+
+        for (unsigned long q = 0; q < 3; ++q)
+        {
+            // This should give the same answer as the std::vector version.
+            matrix<double> Q1, Q2;
+            find_matrix_range(rows, 10, Q1, q);
+            find_matrix_range(A, 10, Q2, q);
+            DLIB_TEST_MSG(max(abs(Q1 - Q2)) < 1e-10, max(abs(Q1 - Q2)));
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_svd_fast(
+        long rank,
+        long m,
+        long n
+    )
+    {
+        print_spinner();
+        const matrix<double> D = randm(m,rank,rnd)*randm(rank,n,rnd);
+        const sparse_matrix<double> A(D);
+        matrix<double> u,v;
+        matrix<double,0,1> w;
+
+        svd_fast(A, u, w, v, rank, 2);
+        DLIB_TEST(u.nr() == m);
+        DLIB_TEST(u.nc() == rank);
+        DLIB_TEST(w.nr() == rank);
+        DLIB_TEST(w.nc() == 1);
+        DLIB_TEST(v.nr() == n);
+        DLIB_TEST(v.nc() == rank);
+        DLIB_TEST(max(abs(trans(u)*u - identity_matrix<double>(u.nc()))) < 1e-13);
+        DLIB_TEST(max(abs(trans(v)*v - identity_matrix<double>(u.nc()))) < 1e-13);
+        DLIB_TEST(max(abs(tmp(D - u*diagm(w)*trans(v)))) < 1e-12);
+
+        matrix<double> v2;
+        matrix<double,0,1> w2;
+        svd_fast(A, w2, v2, rank, 2);
+        DLIB_TEST(max(abs(w - w2)) < 1e-12);
+        DLIB_TEST(max(abs(v - v2)) < 1e-12);
+
+        svd_fast(A, u, w, v, rank+5, 1);
+        DLIB_TEST(max(abs(trans(u)*u - identity_matrix<double>(u.nc()))) < 1e-13);
+        DLIB_TEST(max(abs(trans(v)*v - identity_matrix<double>(u.nc()))) < 1e-13);
+        DLIB_TEST(max(abs(tmp(D - u*diagm(w)*trans(v)))) < 1e-12);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_cca()
+    {
+        print_spinner();
+        const matrix<double> L = make_sparse_dense_matrix<double>(100, 30, 0.3);
+        const matrix<double> R = L*randm(30,20,rnd);
+        const std::vector<sparse_vect> Lrows = dense_to_sparse_rows(L);
+        const std::vector<sparse_vect> Rrows = dense_to_sparse_rows(R);
+
+        matrix<double> Ltrans, Rtrans, Ltrans2, Rtrans2;
+        const matrix<double,0,1> cor = cca(Lrows, Rrows, Ltrans, Rtrans, 5);
+        const matrix<double,0,1> cor2 = cca(sparse_matrix<double>(Lrows, L.nc()),
+                                            sparse_matrix<double>(Rrows, R.nc()),
+                                            Ltrans2, Rtrans2, 5);
+        DLIB_TEST(cor.size() == cor2.size());
+        DLIB_TEST_MSG(max(abs(cor - cor2)) < 1e-8, max(abs(cor - cor2)));
+        DLIB_TEST_MSG(max(abs(Ltrans - Ltrans2)) < 1e-8, max(abs(Ltrans - Ltrans2)));
+        DLIB_TEST_MSG(max(abs(Rtrans - Rtrans2)) < 1e-8, max(abs(Rtrans - Rtrans2)));
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_linear_trainer()
+    {
+        print_spinner();
+        std::vector<sparse_vect> samples;
+        std::vector<double> labels;
+        for (int i = 0; i < 200; ++i)
+        {
+            sparse_vect samp;
+            const double label = (i%2) ? +1 : -1;
+            for (unsigned long d = 0; d < 50; ++d)
+            {
+                if (rnd.get_random_double() < 0.1)
+                    samp.push_back(make_pair(d, rnd.get_random_gaussian() + label*(d%3 == 0)));
+            }
+            samples.push_back(samp);
+            labels.push_back(label);
+        }
+        const sparse_matrix<double> A(samples);
+
+        typedef sparse_linear_kernel<sparse_vect> kernel_type;
+        svm_c_linear_trainer<kernel_type> trainer;
+        trainer.set_c(10);
+        const decision_function<kernel_type> df1 = trainer.train(samples, labels);
+        const decision_function<kernel_type> df2 = trainer.train(A, labels);
+        DLIB_TEST(std::abs(df1.b - df2.b) < 1e-12);
+        DLIB_TEST(max(abs(sparse_to_dense(df1.basis_vectors(0)) - sparse_to_dense(df2.basis_vectors(0)))) < 1e-12);
+
+        svm_c_linear_dcd_trainer<kernel_type> dcd_trainer;
+        dcd_trainer.set_c(10);
+        const decision_function<kernel_type> df3 = dcd_trainer.train(samples, labels);
+        const decision_function<kernel_type> df4 = dcd_trainer.train(A, labels);
+        DLIB_TEST(std::abs(df3.b - df4.b) < 1e-12);
+        DLIB_TEST(max(abs(sparse_to_dense(df3.basis_vectors(0)) - sparse_to_dense(df4.basis_vectors(0)))) < 1e-12);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    class sparse_matrix_tester : public tester
+    {
+    public:
+        sparse_matrix_tester (
+        ) :
+            tester ("test_sparse_matrix",
+                    "Runs tests on the sparse_matrix object.")
+        {}
+
+        void perform_test (
+        )
+        {
+            test_construction();
+
+            test_multiply<double>(1, 1, 1);
+            test_empty_multiply();
+            test_multiply<double>(30, 20, 0);
+            test_multiply<double>(30, 20, 0.3);
+            test_multiply<float>(50, 70, 0.2);
+            // big enough to be split up between threads
+            test_multiply<double>(3000, 500, 0.02);
+            test_multiply<float>(500, 3000, 0.02);
+
+            test_find_matrix_range();
+            for (int iter = 0; iter < 50; ++iter)
+            {
+                const unsigned long rank = rnd.get_random_32bit_number()%10 + 1;
+                const unsigned long m = rank + rnd.get_random_32bit_number()%10;
+                const unsigned long n = rank + rnd.get_random_32bit_number()%10;
+                test_svd_fast(rank, m, n);
+            }
+
+            test_cca();
+            test_linear_trainer();
+        }
+    } a;
+
+}
+
+
@@ -0,0 +1,146 @@
+// The contents of this file are in the public domain. See LICENSE_FOR_EXAMPLE_PROGRAMS.txt
+/*
+    This example shows how to serve a deep neural network over HTTP using the
+    server_http object and the inference_batcher from the dlib C++ Library.
+
+    When many clients send requests at the same time it's wasteful to run the network
+    once per request.  A forward pass over a batch of images costs much less than the
+    same number of single image passes, because the layers get to work on many images
+    at once.  The inference_batcher collects the requests coming in on the server's
+    threads into batches and hands each request back its own result.
+
+    This program runs the face recognition network from dnn_face_recognition_ex.cpp.
+    You POST a JPEG of a face to http://localhost:5000/embed and get back the 128D
+    face descriptor as text.  The face should be cropped and aligned like the face
+    chips in dnn_face_recognition_ex.cpp.  Going to http://localhost:5000/stats shows
+    the latency and batch size counters.  For example, with curl you could run:
+        curl --data-binary @face.jpg http://localhost:5000/embed
+
+    You can download the network from:
+        http://dlib.net/files/dlib_face_recognition_resnet_model_v1.dat.bz2
+*/
+
+#include <dlib/dnn.h>
+#include <dlib/server.h>
+#include <dlib/image_io.h>
+#include <dlib/image_transforms.h>
+#include <iostream>
+#include <sstream>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+// The face recognition network from dnn_face_recognition_ex.cpp.
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual = add_prev1<block<N,BN,1,tag1<SUBNET>>>;
+
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual_down = add_prev2<avg_pool<2,2,2,2,skip1<tag2<block<N,BN,2,tag1<SUBNET>>>>>>;
+
+template <int N, template <typename> class BN, int stride, typename SUBNET>
+using block  = BN<con<N,3,3,1,1,relu<BN<con<N,3,3,stride,stride,SUBNET>>>>>;
+
+template <int N, typename SUBNET> using ares      = relu<residual<block,N,affine,SUBNET>>;
+template <int N, typename SUBNET> using ares_down = relu<residual_down<block,N,affine,SUBNET>>;
+
+template <typename SUBNET> using alevel0 = ares_down<256,SUBNET>;
+template <typename SUBNET> using alevel1 = ares<256,ares<256,ares_down<256,SUBNET>>>;
+template <typename SUBNET> using alevel2 = ares<128,ares<128,ares_down<128,SUBNET>>>;
+template <typename SUBNET> using alevel3 = ares<64,ares<64,ares<64,ares_down<64,SUBNET>>>>;
+template <typename SUBNET> using alevel4 = ares<32,ares<32,ares<32,SUBNET>>>;
+
+using anet_type = loss_metric<fc_no_bias<128,avg_pool_everything<
+                            alevel0<
+                            alevel1<
+                            alevel2<
+                            alevel3<
+                            alevel4<
+                            max_pool<3,3,2,2,relu<affine<con<32,7,7,2,2,
+                            input_rgb_image_sized<150>
+                            >>>>>>>>>>>>;
+
+// ----------------------------------------------------------------------------------------
+
+class face_server : public server_http
+{
+public:
+    face_server (
+        const anet_type& net
+    ) :
+        // Run at most 32 faces at once and don't hold a request back for more than
+        // 10ms waiting for others to arrive.
+        batcher(net, 32, std::chrono::milliseconds(10))
+    {}
+
+private:
+    const std::string on_request (
+        const incoming_things& incoming,
+        outgoing_things& outgoing
+    )
+    {
+        // on_request() is called from many threads at once, one per connection, and
+        // the batcher is safe to use from all of them.
+        outgoing.headers["Content-Type"] = "text/plain";
+        ostringstream sout;
+        if (incoming.path == "/embed" && incoming.request_type == "POST")
+        {
+            std::vector<unsigned char> buf(incoming.body.begin(), incoming.body.end());
+            matrix<rgb_pixel> img, face(150,150);
+            load_jpeg(img, buf.data(), buf.size());
+            resize_image(img, face);
+
+            // This blocks until the face has gone through the network as part of
+            // some batch.
+            const matrix<float,0,1> descriptor = batcher(std::move(face));
+            sout << trans(descriptor);
+        }
+        else if (incoming.path == "/stats")
+        {
+            sout << batcher.get_stats();
+        }
+        else
+        {
+            outgoing.http_return = 404;
+            outgoing.http_return_status = "Not Found";
+            sout << "POST a JPEG to /embed or GET /stats\n";
+        }
+        return sout.str();
+    }
+
+    inference_batcher<anet_type> batcher;
+};
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    if (argc != 2)
+    {
+        cout << "Give the path to dlib_face_recognition_resnet_model_v1.dat as the" << endl;
+        cout << "argument to this program." << endl;
+        return 1;
+    }
+
+    anet_type net;
+    deserialize(argv[1]) >> net;
+    // The batcher needs a network whose layers have been allocated, which happens the
+    // first time it's run.
+    matrix<rgb_pixel> blank(150,150);
+    assign_all_pixels(blank, 0);
+    net(blank);
+
+    face_server our_server(net);
+    our_server.set_listening_port(5000);
+    // Tell the server to begin accepting connections.
+    our_server.start_async();
+
+    cout << "Press enter to end this program" << endl;
+    cin.get();
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+}
+
@@ -0,0 +1,129 @@
+/*
+
+    This program finds the filter size at which conv_same() and spatially_filter_image()
+    should switch from their direct loops to FFT based convolution on this machine.  For
+    a range of square filter sizes it times both ways of filtering an image and prints
+    the times in milliseconds.  At the end it prints the threshold to give to
+    set_conv_fft_threshold(), which is the number of filter elements above which the FFT
+    path won every remaining test.
+
+    It also shows the time to apply a whole bank of filters to one image with
+    fft_convolver, which only transforms the image once.
+
+    usage: conv_fft_benchmark [image size] [number of repetitions]
+
+*/
+
+#include <dlib/matrix.h>
+#include <dlib/array2d.h>
+#include <dlib/image_transforms.h>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <limits>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+template <typename F>
+double time_it (
+    long reps,
+    F&& funct
+)
+{
+    funct(); // warm up and build the FFT plans.
+    const auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < reps; ++i)
+        funct();
+    return 1000*std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count()/reps;
+}
+
+const long direct = std::numeric_limits<long>::max();
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const long size = argc > 1 ? std::stol(argv[1]) : 512;
+    const long reps = argc > 2 ? std::stol(argv[2]) : 3;
+    const long default_threshold = get_conv_fft_threshold();
+
+    const matrix<double> img = gaussian_randm(size, size, 0);
+    const matrix<float> fimg = matrix_cast<float>(img);
+    array2d<float> aimg;
+    assign_image(aimg, fimg);
+
+    cout << size << "x" << size << " image" << endl;
+    cout << setw(10) << "filter"
+         << setw(14) << "conv direct" << setw(12) << "conv fft"
+         << setw(16) << "filter direct" << setw(14) << "filter fft" << endl;
+
+    // The smallest filter size after which the FFT path always won.
+    long conv_crossover = 0, filter_crossover = 0;
+    for (long k = 3; k <= 41; k += 2)
+    {
+        const matrix<double> filt = gaussian_randm(k, k, k);
+        const matrix<float> ffilt = matrix_cast<float>(filt);
+        matrix<double> out;
+        array2d<float> aout;
+
+        set_conv_fft_threshold(direct);
+        const double t1 = time_it(reps, [&]() { out = conv_same(img, filt); });
+        const double t3 = time_it(reps, [&]() { spatially_filter_image(aimg, aout, ffilt, 1); });
+        set_conv_fft_threshold(0);
+        const double t2 = time_it(reps, [&]() { out = conv_same(img, filt); });
+        const double t4 = time_it(reps, [&]() { spatially_filter_image(aimg, aout, ffilt, 1); });
+
+        if (t2 >= t1)
+            conv_crossover = 0;
+        else if (conv_crossover == 0)
+            conv_crossover = k;
+        if (t4 >= t3)
+            filter_crossover = 0;
+        else if (filter_crossover == 0)
+            filter_crossover = k;
+
+        ostringstream sout;
+        sout << k << "x" << k;
+        cout << setw(10) << sout.str()
+             << setw(14) << t1 << setw(12) << t2
+             << setw(16) << t3 << setw(14) << t4 << endl;
+    }
+
+    const long num_filters = 16;
+    const long k = 31;
+    std::vector<matrix<double> > filters;
+    for (long i = 0; i < num_filters; ++i)
+        filters.push_back(gaussian_randm(k, k, 100+i));
+    matrix<double> out;
+    set_conv_fft_threshold(0);
+    const double tsep = time_it(reps, [&]() { for (auto& f : filters) out = xcorr_same(img, f); });
+    const double tbank = time_it(reps, [&]()
+    {
+        fft_convolver<double> convolver(img);
+        for (auto& f : filters)
+            out = convolver.xcorr_same(f);
+    });
+    cout << endl << num_filters << " " << k << "x" << k << " filters, xcorr_same(): " << tsep
+         << "  fft_convolver: " << tbank << endl << endl;
+
+    // spatially_filter_image() has SIMD loops for float images so it usually crosses over
+    // later than conv_same().  The threshold is shared, so we recommend the larger one.
+    const long crossover = std::max(conv_crossover, filter_crossover);
+    cout << "default threshold: " << default_threshold << endl;
+    if (crossover == 0)
+        cout << "the FFT path never won for every larger filter, use a threshold above " << 41*41 << endl;
+    else
+        cout << "recommended set_conv_fft_threshold(" << crossover*crossover << ")" << endl;
+
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+
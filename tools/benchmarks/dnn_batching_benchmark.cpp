@@ -0,0 +1,178 @@
+/*
+
+    This program is a load generator for inference_batcher.  It starts a server_http in
+    this process that runs the network from dnn_face_recognition_ex.cpp on every face
+    POSTed to it, then has a number of client threads send it requests over TCP as fast
+    as they can.  This is done once with batching turned off (a max batch size of 1) and
+    then with larger max batch sizes, and the throughput and the latencies seen by the
+    clients are printed for each, along with the batcher's own counters.  The network
+    is randomly initialized, which doesn't matter for timing purposes, so no model files
+    are needed.
+
+    The faces are sent as raw RGB pixels so that image decoding doesn't get timed.
+
+    usage: dnn_batching_benchmark [num clients] [requests per client] [max wait in ms]
+
+*/
+
+#include <dlib/dnn.h>
+#include <dlib/server.h>
+#include <dlib/iosockstream.h>
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual = add_prev1<block<N,BN,1,tag1<SUBNET>>>;
+
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual_down = add_prev2<avg_pool<2,2,2,2,skip1<tag2<block<N,BN,2,tag1<SUBNET>>>>>>;
+
+template <int N, template <typename> class BN, int stride, typename SUBNET>
+using block  = BN<con<N,3,3,1,1,relu<BN<con<N,3,3,stride,stride,SUBNET>>>>>;
+
+template <int N, typename SUBNET> using ares      = relu<residual<block,N,affine,SUBNET>>;
+template <int N, typename SUBNET> using ares_down = relu<residual_down<block,N,affine,SUBNET>>;
+
+template <typename SUBNET> using alevel0 = ares_down<256,SUBNET>;
+template <typename SUBNET> using alevel1 = ares<256,ares<256,ares_down<256,SUBNET>>>;
+template <typename SUBNET> using alevel2 = ares<128,ares<128,ares_down<128,SUBNET>>>;
+template <typename SUBNET> using alevel3 = ares<64,ares<64,ares<64,ares_down<64,SUBNET>>>>;
+template <typename SUBNET> using alevel4 = ares<32,ares<32,ares<32,SUBNET>>>;
+
+using anet_type = loss_metric<fc_no_bias<128,avg_pool_everything<
+                            alevel0<
+                            alevel1<
+                            alevel2<
+                            alevel3<
+                            alevel4<
+                            max_pool<3,3,2,2,relu<affine<con<32,7,7,2,2,
+                            input_rgb_image_sized<150>
+                            >>>>>>>>>>>>;
+
+// ----------------------------------------------------------------------------------------
+
+class face_server : public server_http
+{
+public:
+    std::unique_ptr<inference_batcher<anet_type>> batcher;
+
+private:
+    const std::string on_request (
+        const incoming_things& incoming,
+        outgoing_things& outgoing
+    )
+    {
+        if (incoming.body.size() != 150*150*3)
+            throw dlib::error("expected a 150x150 RGB image");
+
+        matrix<rgb_pixel> face(150,150);
+        std::memcpy(&face(0,0), incoming.body.data(), incoming.body.size());
+        const matrix<float,0,1> descriptor = (*batcher)(std::move(face));
+
+        outgoing.headers["Content-Type"] = "text/plain";
+        std::ostringstream sout;
+        sout << trans(descriptor);
+        return sout.str();
+    }
+};
+
+// ----------------------------------------------------------------------------------------
+
+double percentile (
+    std::vector<double> v,
+    double p
+)
+{
+    auto i = v.begin() + std::min<size_t>(v.size()-1, p*v.size());
+    std::nth_element(v.begin(), i, v.end());
+    return *i;
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const size_t num_clients = argc > 1 ? std::stoi(argv[1]) : 16;
+    const size_t requests_per_client = argc > 2 ? std::stoi(argv[2]) : 4;
+    const auto max_wait = std::chrono::milliseconds(argc > 3 ? std::stoi(argv[3]) : 10);
+    const unsigned short port = 5123;
+
+    dlib::rand rnd;
+    std::string request_body(150*150*3, 0);
+    for (auto& c : request_body)
+        c = rnd.get_random_8bit_number();
+    std::ostringstream sout;
+    sout << "POST /embed HTTP/1.0\r\nContent-Length: " << request_body.size() << "\r\n\r\n" << request_body;
+    const std::string request = sout.str();
+
+    anet_type net;
+    matrix<rgb_pixel> blank(150,150);
+    assign_all_pixels(blank, 0);
+    net(blank);
+
+    face_server server;
+    server.set_listening_port(port);
+    server.set_max_connections(num_clients+10);
+    server.start_async();
+
+    cout << num_clients << " clients, " << requests_per_client << " requests each, max wait "
+         << max_wait.count() << " ms" << endl;
+    double baseline = 0;
+    for (size_t max_batch_size : {1, 4, 8, 16, 32})
+    {
+        server.batcher.reset(new inference_batcher<anet_type>(net, max_batch_size, max_wait));
+
+        std::vector<std::vector<double>> latencies(num_clients);
+        std::vector<std::thread> clients;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t c = 0; c < num_clients; ++c)
+        {
+            clients.emplace_back([&, c]()
+            {
+                for (size_t i = 0; i < requests_per_client; ++i)
+                {
+                    const auto t0 = std::chrono::steady_clock::now();
+                    iosockstream con(network_address("127.0.0.1", port));
+                    con << request << std::flush;
+                    const std::string response((std::istreambuf_iterator<char>(con)), std::istreambuf_iterator<char>());
+                    if (response.compare(0, 12, "HTTP/1.0 200") != 0)
+                        cout << "bad response: " << response.substr(0, response.find('\r')) << endl;
+                    latencies[c].push_back(std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count());
+                }
+            });
+        }
+        for (auto& t : clients)
+            t.join();
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+        std::vector<double> all;
+        for (auto& l : latencies)
+            all.insert(all.end(), l.begin(), l.end());
+        const double faces_per_sec = all.size()/secs;
+        if (baseline == 0)
+            baseline = faces_per_sec;
+
+        const auto stats = server.batcher->get_stats();
+        cout << "max batch size " << max_batch_size << ": " << faces_per_sec << " faces per second, speedup "
+             << faces_per_sec/baseline << ", client latency p50 " << percentile(all,0.5)*1000 << " ms, p99 "
+             << percentile(all,0.99)*1000 << " ms, mean batch size " << stats.mean_batch_size() << endl;
+        cout << stats << endl;
+    }
+
+    server.clear();
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+
@@ -0,0 +1,141 @@
+/*
+
+    This program times the CPU convolution algorithms selected by
+    set_dnn_cpu_conv_algorithm() on the networks from dnn_face_recognition_ex.cpp and
+    dnn_mmod_face_detection_ex.cpp.  The networks are randomly initialized, which
+    doesn't matter for timing purposes, so no model files are needed.
+
+*/
+
+#include <dlib/dnn.h>
+#include <dlib/image_transforms.h>
+#include <iostream>
+#include <chrono>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+// The face recognition ResNet from dnn_face_recognition_ex.cpp
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual = add_prev1<block<N,BN,1,tag1<SUBNET>>>;
+
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual_down = add_prev2<avg_pool<2,2,2,2,skip1<tag2<block<N,BN,2,tag1<SUBNET>>>>>>;
+
+template <int N, template <typename> class BN, int stride, typename SUBNET> 
+using block  = BN<con<N,3,3,1,1,relu<BN<con<N,3,3,stride,stride,SUBNET>>>>>;
+
+template <int N, typename SUBNET> using ares      = relu<residual<block,N,affine,SUBNET>>;
+template <int N, typename SUBNET> using ares_down = relu<residual_down<block,N,affine,SUBNET>>;
+
+template <typename SUBNET> using alevel0 = ares_down<256,SUBNET>;
+template <typename SUBNET> using alevel1 = ares<256,ares<256,ares_down<256,SUBNET>>>;
+template <typename SUBNET> using alevel2 = ares<128,ares<128,ares_down<128,SUBNET>>>;
+template <typename SUBNET> using alevel3 = ares<64,ares<64,ares<64,ares_down<64,SUBNET>>>>;
+template <typename SUBNET> using alevel4 = ares<32,ares<32,ares<32,SUBNET>>>;
+
+using face_net_type = loss_metric<fc_no_bias<128,avg_pool_everything<
+                            alevel0<
+                            alevel1<
+                            alevel2<
+                            alevel3<
+                            alevel4<
+                            max_pool<3,3,2,2,relu<affine<con<32,7,7,2,2,
+                            input_rgb_image_sized<150>
+                            >>>>>>>>>>>>;
+
+// The face detector from dnn_mmod_face_detection_ex.cpp
+template <long num_filters, typename SUBNET> using con5d = con<num_filters,5,5,2,2,SUBNET>;
+template <long num_filters, typename SUBNET> using con5  = con<num_filters,5,5,1,1,SUBNET>;
+
+template <typename SUBNET> using downsampler  = relu<affine<con5d<32, relu<affine<con5d<32, relu<affine<con5d<16,SUBNET>>>>>>>>>;
+template <typename SUBNET> using rcon5  = relu<affine<con5<45,SUBNET>>>;
+
+using mmod_net_type = loss_mmod<con<1,9,9,1,1,rcon5<rcon5<rcon5<downsampler<input_rgb_image_pyramid<pyramid_down<6>>>>>>>>;
+
+// ----------------------------------------------------------------------------------------
+
+template <typename net_type>
+double time_forward (
+    net_type& net,
+    const resizable_tensor& x,
+    int iterations
+)
+{
+    // warm up so that the layers are allocated before we start timing.
+    net.subnet().forward(x);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        net.subnet().forward(x);
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count()/iterations;
+}
+
+template <typename net_type>
+void compare_algorithms (
+    const std::string& name,
+    net_type& net,
+    const resizable_tensor& x,
+    int iterations
+)
+{
+    const std::pair<cpu_conv_algorithm, const char*> algos[] = {
+        {cpu_conv_algorithm::img2col,   "img2col"},
+        {cpu_conv_algorithm::direct,    "direct"},
+        {cpu_conv_algorithm::winograd,  "winograd"},
+        {cpu_conv_algorithm::automatic, "automatic"}
+    };
+
+    cout << name << " (input " << x.num_samples() << "x" << x.k() << "x" << x.nr() << "x" << x.nc() << ")" << endl;
+    double baseline = 0;
+    for (auto& a : algos)
+    {
+        set_dnn_cpu_conv_algorithm(a.first);
+        const double ms = time_forward(net, x, iterations);
+        if (a.first == cpu_conv_algorithm::img2col)
+            baseline = ms;
+        cout << "   " << a.second << ": " << ms << " ms per forward pass, speedup " << baseline/ms << endl;
+    }
+    set_dnn_cpu_conv_algorithm(cpu_conv_algorithm::automatic);
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+#ifdef DLIB_USE_CUDA
+    cout << "dlib was built with CUDA so tt::tensor_conv doesn't use the CPU algorithms timed here." << endl;
+#endif
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 5;
+
+    dlib::rand rnd;
+    std::vector<matrix<rgb_pixel>> faces(8);
+    for (auto& img : faces)
+    {
+        img.set_size(150,150);
+        for (auto& p : img)
+            p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+    }
+
+    face_net_type face_net;
+    resizable_tensor x;
+    face_net.to_tensor(faces.begin(), faces.end(), x);
+    compare_algorithms("dnn_face_recognition_ex network", face_net, x, iterations);
+
+    matrix<rgb_pixel> photo(480,640);
+    for (auto& p : photo)
+        p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+
+    mmod_net_type mmod_net;
+    mmod_net.to_tensor(&photo, &photo+1, x);
+    compare_algorithms("dnn_mmod_face_detection_ex network", mmod_net, x, iterations);
+
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
@@ -0,0 +1,114 @@
+/*
+
+    This program compares a MobileNet style network built from depthwise separable
+    convolutions (a depthwise_con followed by a 1x1 con) against the same network with
+    each of those pairs replaced by a full 3x3 con.  It also times a network where the 3x3
+    convolutions are grouped_con layers with 4 groups.  For each network it prints the
+    number of parameters, the floating point operations of a forward pass as estimated by
+    dnn_profiler, and the time taken by forward and backward passes on the CPU.
+
+    usage: dnn_grouped_conv_benchmark [iterations]
+
+*/
+
+#include <dlib/dnn.h>
+#include <iostream>
+#include <chrono>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+template <long N, int stride, typename SUBNET>
+using dense_block = relu<bn_con<con<N,3,3,stride,stride,SUBNET>>>;
+
+template <long N, int stride, typename SUBNET>
+using separable_block = relu<bn_con<con<N,1,1,1,1,relu<bn_con<depthwise_con<3,3,stride,stride,SUBNET>>>>>>;
+
+template <long N, int stride, typename SUBNET>
+using grouped_block = relu<bn_con<grouped_con<N,3,3,stride,stride,4,SUBNET>>>;
+
+template <template <long,int,typename> class block>
+using net_type = loss_multiclass_log<fc<10,avg_pool_everything<
+                            block<256,1,block<256,2,
+                            block<128,1,block<128,2,
+                            block<64,1,block<64,2,
+                            relu<bn_con<con<32,3,3,2,2,
+                            input_rgb_image
+                            >>>>>>>>>>>>;
+
+// ----------------------------------------------------------------------------------------
+
+template <typename net_type>
+void time_network (
+    const std::string& name,
+    const std::vector<matrix<rgb_pixel>>& images,
+    int iterations
+)
+{
+    net_type net;
+    resizable_tensor x;
+    net.to_tensor(images.begin(), images.end(), x);
+    std::vector<unsigned long> labels(images.size(), 0);
+
+    // warm up so that the layers are allocated before we start timing.
+    net.subnet().forward(x);
+    net.compute_parameter_gradients(x, labels.begin());
+
+    dnn_profiler<net_type> profiler(net);
+    profiler.start();
+    net.subnet().forward(x);
+    profiler.stop();
+    double flops = 0;
+    for (auto& l : profiler.get_layer_profiles())
+        flops += l.forward_flops;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        net.subnet().forward(x);
+    const double forward_ms = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count()/iterations;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        net.compute_parameter_gradients(x, labels.begin());
+    const double train_ms = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count()/iterations;
+
+    size_t num_params = 0;
+    visit_layer_parameters(net, [&](size_t, tensor& t) { num_params += t.size(); });
+
+    cout << name << endl;
+    cout << "   parameters:          " << num_params << endl;
+    cout << "   forward GFLOP:       " << flops/1e9 << endl;
+    cout << "   forward:             " << forward_ms << " ms" << endl;
+    cout << "   forward + backward:  " << train_ms << " ms" << endl;
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 5;
+
+    dlib::rand rnd;
+    std::vector<matrix<rgb_pixel>> images(8);
+    for (auto& img : images)
+    {
+        img.set_size(128,128);
+        for (auto& p : img)
+            p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+    }
+    cout << "mini-batch of " << images.size() << " 128x128 images" << endl;
+
+    time_network<net_type<dense_block>>("con 3x3", images, iterations);
+    time_network<net_type<separable_block>>("depthwise_con 3x3 + con 1x1", images, iterations);
+    time_network<net_type<grouped_block>>("grouped_con 3x3, 4 groups", images, iterations);
+
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+
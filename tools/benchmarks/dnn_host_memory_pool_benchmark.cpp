@@ -0,0 +1,85 @@
+/*
+
+    This program measures what the host memory pool saves when a network is run on
+    images of varying sizes.  Each image is run through its own copy of the network,
+    the way a server that makes a network per request would, so every tensor the
+    network uses is allocated and freed once per image.  The same images are run with
+    the pool's cache turned off, which is the same as allocating with new and delete,
+    and then with it turned on.
+
+    usage: dnn_host_memory_pool_benchmark [number of images]
+
+*/
+
+#include <dlib/dnn.h>
+#include <iostream>
+#include <chrono>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+using net_type = loss_multiclass_log<fc<10,avg_pool_everything<
+                            relu<con<32,3,3,1,1,
+                            max_pool<2,2,2,2,relu<con<16,3,3,1,1,
+                            input_rgb_image
+                            >>>>>>>>;
+
+// ----------------------------------------------------------------------------------------
+
+double time_images (
+    const net_type& net,
+    const std::vector<matrix<rgb_pixel>>& images
+)
+{
+    const auto start = chrono::steady_clock::now();
+    for (auto& img : images)
+    {
+        net_type temp(net);
+        temp(img);
+    }
+    return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const size_t num_images = argc > 1 ? atoi(argv[1]) : 50;
+
+    dlib::rand rnd;
+    std::vector<matrix<rgb_pixel>> images(num_images);
+    for (auto& img : images)
+    {
+        img.set_size(100 + rnd.get_random_32bit_number()%200, 100 + rnd.get_random_32bit_number()%200);
+        for (auto& p : img)
+            p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+    }
+
+    net_type net;
+    net(images[0]);
+
+    const size_t max_cached = get_host_memory_pool_max_cached_bytes();
+
+    set_host_memory_pool_max_cached_bytes(0);
+    time_images(net, images);
+    clear_host_memory_pool_stats();
+    const double no_pool = time_images(net, images);
+    cout << "without cache: " << no_pool/num_images*1000 << " ms per image" << endl;
+    cout << "    " << get_host_memory_pool_stats() << endl;
+
+    set_host_memory_pool_max_cached_bytes(max_cached);
+    time_images(net, images);
+    clear_host_memory_pool_stats();
+    const double pool = time_images(net, images);
+    cout << "with cache:    " << pool/num_images*1000 << " ms per image" << endl;
+    cout << "    " << get_host_memory_pool_stats() << endl;
+    cout << "speedup: " << no_pool/pool << endl;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+
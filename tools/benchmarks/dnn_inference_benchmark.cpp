@@ -0,0 +1,168 @@
+/*
+
+    This program compares the network from dnn_face_recognition_ex.cpp with the version
+    of it made by compile_for_inference().  It reports the time per forward pass of each,
+    how much memory each needs for the layer outputs and how far apart their face
+    descriptors are.  The network is randomly initialized, which doesn't matter for
+    timing purposes, so no model files are needed.
+
+*/
+
+#include <dlib/dnn.h>
+#include <iostream>
+#include <chrono>
+#include <set>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+// The face recognition ResNet from dnn_face_recognition_ex.cpp, in both its training
+// form with bn_con layers and its inference form where they have become affine layers.
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual = add_prev1<block<N,BN,1,tag1<SUBNET>>>;
+
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual_down = add_prev2<avg_pool<2,2,2,2,skip1<tag2<block<N,BN,2,tag1<SUBNET>>>>>>;
+
+template <int N, template <typename> class BN, int stride, typename SUBNET> 
+using block  = BN<con<N,3,3,1,1,relu<BN<con<N,3,3,stride,stride,SUBNET>>>>>;
+
+template <int N, typename SUBNET> using res       = relu<residual<block,N,bn_con,SUBNET>>;
+template <int N, typename SUBNET> using ares      = relu<residual<block,N,affine,SUBNET>>;
+template <int N, typename SUBNET> using res_down  = relu<residual_down<block,N,bn_con,SUBNET>>;
+template <int N, typename SUBNET> using ares_down = relu<residual_down<block,N,affine,SUBNET>>;
+
+template <typename SUBNET> using level0 = res_down<256,SUBNET>;
+template <typename SUBNET> using level1 = res<256,res<256,res_down<256,SUBNET>>>;
+template <typename SUBNET> using level2 = res<128,res<128,res_down<128,SUBNET>>>;
+template <typename SUBNET> using level3 = res<64,res<64,res<64,res_down<64,SUBNET>>>>;
+template <typename SUBNET> using level4 = res<32,res<32,res<32,SUBNET>>>;
+
+template <typename SUBNET> using alevel0 = ares_down<256,SUBNET>;
+template <typename SUBNET> using alevel1 = ares<256,ares<256,ares_down<256,SUBNET>>>;
+template <typename SUBNET> using alevel2 = ares<128,ares<128,ares_down<128,SUBNET>>>;
+template <typename SUBNET> using alevel3 = ares<64,ares<64,ares<64,ares_down<64,SUBNET>>>>;
+template <typename SUBNET> using alevel4 = ares<32,ares<32,ares<32,SUBNET>>>;
+
+using net_type = loss_metric<fc_no_bias<128,avg_pool_everything<
+                            level0<
+                            level1<
+                            level2<
+                            level3<
+                            level4<
+                            max_pool<3,3,2,2,relu<bn_con<con<32,7,7,2,2,
+                            input_rgb_image_sized<150>
+                            >>>>>>>>>>>>;
+
+using anet_type = loss_metric<fc_no_bias<128,avg_pool_everything<
+                            alevel0<
+                            alevel1<
+                            alevel2<
+                            alevel3<
+                            alevel4<
+                            max_pool<3,3,2,2,relu<affine<con<32,7,7,2,2,
+                            input_rgb_image_sized<150>
+                            >>>>>>>>>>>>;
+
+// ----------------------------------------------------------------------------------------
+
+template <typename funct_type>
+double time_it (
+    funct_type&& funct,
+    int iterations
+)
+{
+    // warm up so that the layers are allocated before we start timing.
+    funct();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        funct();
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count()/iterations;
+}
+
+// ----------------------------------------------------------------------------------------
+
+class layer_outputs
+{
+    /*!
+        A visitor for visit_layers() that collects the output tensor of each layer.  Only
+        add_layer objects own their outputs, tag and skip layers return the output of some
+        other layer.  An in-place layer writes into the output of the layer below it, in
+        which case that layer's get_output() throws.
+    !*/
+public:
+    layer_outputs(std::set<const tensor*>& outputs_) : outputs(outputs_) {}
+
+    template <typename T, typename U, typename E>
+    void operator()(size_t, const add_layer<T,U,E>& l) const
+    {
+        try { outputs.insert(&l.get_output()); } catch (dlib::error&) {}
+    }
+
+    template <typename T>
+    void operator()(size_t, const T&) const {}
+
+private:
+    std::set<const tensor*>& outputs;
+};
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 5;
+    const int batch_size = argc > 2 ? std::stoi(argv[2]) : 8;
+
+    dlib::rand rnd;
+    std::vector<matrix<rgb_pixel>> faces(batch_size);
+    for (auto& img : faces)
+    {
+        img.set_size(150,150);
+        for (auto& p : img)
+            p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+    }
+
+    // Run the training network once so its layers get allocated, then convert it to the
+    // inference form just like dnn_face_recognition_ex.cpp's model is.
+    net_type net;
+    resizable_tensor x;
+    net.to_tensor(faces.begin(), faces.begin()+1, x);
+    net.subnet().forward(x);
+    anet_type anet = net;
+
+    inference_net inet = compile_for_inference(anet);
+    cout << "compiled " << anet_type::num_layers << " layers into " << inet.num_ops() << " operations" << endl;
+
+    anet.to_tensor(faces.begin(), faces.end(), x);
+    const double float_ms = time_it([&]() { anet.subnet().forward(x); }, iterations);
+    const double inet_ms  = time_it([&]() { inet.forward(x); }, iterations);
+
+    std::set<const tensor*> outputs;
+    visit_layers(anet, layer_outputs(outputs));
+    size_t output_bytes = 0;
+    for (auto t : outputs)
+        output_bytes += t->size()*sizeof(float);
+
+    const matrix<float> expected = mat(anet.subnet().forward(x));
+    const matrix<float> out = mat(inet.forward(x));
+    double worst = 0;
+    for (long r = 0; r < expected.nr(); ++r)
+        worst = std::max<double>(worst, length(rowm(out,r)-rowm(expected,r))/length(rowm(expected,r)));
+
+    cout << "batch of " << x.num_samples() << " faces" << endl;
+    cout << "   network:       " << float_ms << " ms per forward pass, keeps " << outputs.size()
+         << " layer outputs totaling " << output_bytes/1024/1024 << " MB" << endl;
+    cout << "   inference_net: " << inet_ms << " ms per forward pass, speedup " << float_ms/inet_ms
+         << ", peak memory " << inet.peak_memory_usage()/1024/1024 << " MB" << endl;
+    cout << "   largest relative error of a face descriptor: " << worst << endl;
+
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
@@ -0,0 +1,125 @@
+/*
+
+    This program compares how long it takes to load the network from
+    dnn_face_recognition_ex.cpp when it's saved with serialize() and when it's saved
+    with save_mapped_network().  The network is randomly initialized, which doesn't
+    matter for timing purposes, so no model files are needed.  The files are written to
+    the current directory.
+
+    usage: dnn_mapped_network_benchmark [number of loads]
+
+*/
+
+#include <dlib/dnn.h>
+#include <iostream>
+#include <chrono>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+// The face recognition ResNet from dnn_face_recognition_ex.cpp, in both its training
+// form with bn_con layers and its inference form where they have become affine layers.
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual = add_prev1<block<N,BN,1,tag1<SUBNET>>>;
+
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual_down = add_prev2<avg_pool<2,2,2,2,skip1<tag2<block<N,BN,2,tag1<SUBNET>>>>>>;
+
+template <int N, template <typename> class BN, int stride, typename SUBNET> 
+using block  = BN<con<N,3,3,1,1,relu<BN<con<N,3,3,stride,stride,SUBNET>>>>>;
+
+template <int N, typename SUBNET> using res       = relu<residual<block,N,bn_con,SUBNET>>;
+template <int N, typename SUBNET> using ares      = relu<residual<block,N,affine,SUBNET>>;
+template <int N, typename SUBNET> using res_down  = relu<residual_down<block,N,bn_con,SUBNET>>;
+template <int N, typename SUBNET> using ares_down = relu<residual_down<block,N,affine,SUBNET>>;
+
+template <typename SUBNET> using level0 = res_down<256,SUBNET>;
+template <typename SUBNET> using level1 = res<256,res<256,res_down<256,SUBNET>>>;
+template <typename SUBNET> using level2 = res<128,res<128,res_down<128,SUBNET>>>;
+template <typename SUBNET> using level3 = res<64,res<64,res<64,res_down<64,SUBNET>>>>;
+template <typename SUBNET> using level4 = res<32,res<32,res<32,SUBNET>>>;
+
+template <typename SUBNET> using alevel0 = ares_down<256,SUBNET>;
+template <typename SUBNET> using alevel1 = ares<256,ares<256,ares_down<256,SUBNET>>>;
+template <typename SUBNET> using alevel2 = ares<128,ares<128,ares_down<128,SUBNET>>>;
+template <typename SUBNET> using alevel3 = ares<64,ares<64,ares<64,ares_down<64,SUBNET>>>>;
+template <typename SUBNET> using alevel4 = ares<32,ares<32,ares<32,SUBNET>>>;
+
+using net_type = loss_metric<fc_no_bias<128,avg_pool_everything<
+                            level0<
+                            level1<
+                            level2<
+                            level3<
+                            level4<
+                            max_pool<3,3,2,2,relu<bn_con<con<32,7,7,2,2,
+                            input_rgb_image_sized<150>
+                            >>>>>>>>>>>>;
+
+using anet_type = loss_metric<fc_no_bias<128,avg_pool_everything<
+                            alevel0<
+                            alevel1<
+                            alevel2<
+                            alevel3<
+                            alevel4<
+                            max_pool<3,3,2,2,relu<affine<con<32,7,7,2,2,
+                            input_rgb_image_sized<150>
+                            >>>>>>>>>>>>;
+
+// ----------------------------------------------------------------------------------------
+
+template <typename F>
+double time_loads (
+    int num_loads,
+    F load
+)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_loads; ++i)
+        load();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count()/num_loads;
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const int num_loads = argc > 1 ? std::stoi(argv[1]) : 5;
+
+    net_type net;
+    matrix<rgb_pixel> blank(150,150);
+    assign_all_pixels(blank, 0);
+    net(blank);
+    anet_type anet = net;
+
+    serialize("dnn_mapped_network_benchmark.dat") << anet;
+    save_mapped_network(anet, "dnn_mapped_network_benchmark.dnet");
+
+    const double dat_secs = time_loads(num_loads, [&]()
+    {
+        anet_type temp;
+        deserialize("dnn_mapped_network_benchmark.dat") >> temp;
+    });
+    const double mapped_secs = time_loads(num_loads, [&]()
+    {
+        anet_type temp;
+        load_mapped_network(temp, "dnn_mapped_network_benchmark.dnet");
+    });
+
+    cout << "deserialize():         " << dat_secs*1000 << " ms" << endl;
+    cout << "load_mapped_network(): " << mapped_secs*1000 << " ms, speedup " << dat_secs/mapped_secs << endl;
+
+    // Make sure the mapped network really is the same network.
+    anet_type mapped;
+    load_mapped_network(mapped, "dnn_mapped_network_benchmark.dnet");
+    const matrix<float,0,1> a = anet(blank), b = mapped(blank);
+    cout << "max difference in output: " << max(abs(a-b)) << endl;
+
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
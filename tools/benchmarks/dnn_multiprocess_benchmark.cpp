@@ -0,0 +1,128 @@
+/*
+
+    This program times data-parallel training with dnn_process_group.  It trains a
+    network of fc_ layers on synthetic data, with a fixed mini-batch size of 128 split
+    between 1, 2, ..., N worker processes on this machine that talk over localhost.  For
+    each number of workers it prints the time per training step and the speedup over one
+    worker.  Each worker is this same program, started with the --worker option.
+
+    Only use as many workers as the machine has cores, or NUMA nodes if the BLAS library
+    uses all the cores of one, otherwise they just compete for them.
+
+    usage: dnn_multiprocess_benchmark [max number of workers] [steps]
+
+*/
+
+#include <dlib/dnn.h>
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+using net_type = loss_multiclass_log<fc<10,relu<fc<512,relu<fc<512,input<matrix<float>>>>>>>>;
+
+const unsigned short base_port = 12900;
+const size_t mini_batch_size = 128;
+
+// ----------------------------------------------------------------------------------------
+
+int run_worker(size_t rank, size_t num_workers, int num_steps)
+{
+    std::vector<network_address> workers;
+    for (size_t i = 0; i < num_workers; ++i)
+        workers.push_back(network_address("127.0.0.1", base_port+i));
+    dnn_process_group group(rank, workers);
+
+    net_type net;
+    dnn_trainer<net_type> trainer(net);
+    trainer.set_process_group(group);
+
+    // Each worker makes its own share of every mini-batch.
+    dlib::rand rnd(rank);
+    const size_t share = mini_batch_size/num_workers;
+    std::vector<matrix<float>> samples(share);
+    std::vector<unsigned long> labels(share);
+    auto make_batch = [&]()
+    {
+        for (size_t i = 0; i < share; ++i)
+        {
+            labels[i] = rnd.get_random_32bit_number()%10;
+            samples[i] = matrix_cast<float>(randm(1024,1,rnd));
+            samples[i](labels[i]) += 1;
+        }
+    };
+
+    // The first step allocates everything, so don't time it.
+    make_batch();
+    trainer.train_one_step(samples, labels);
+    trainer.get_net();
+
+    const auto start = chrono::steady_clock::now();
+    for (int i = 0; i < num_steps; ++i)
+    {
+        make_batch();
+        trainer.train_one_step(samples, labels);
+    }
+    trainer.get_net();
+    const double secs = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+
+    if (rank == 0)
+        cout << secs/num_steps*1000 << endl;
+    return 0;
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    if (argc == 5 && string(argv[1]) == "--worker")
+        return run_worker(atoi(argv[2]), atoi(argv[3]), atoi(argv[4]));
+
+    const size_t max_workers = argc > 1 ? atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    const int num_steps = argc > 2 ? atoi(argv[2]) : 50;
+    const string output_file = "dnn_multiprocess_benchmark_output.txt";
+
+    cout << "mini-batch size: " << mini_batch_size << endl;
+    double time_one_worker = 0;
+    for (size_t n = 1; n <= max_workers; ++n)
+    {
+        // Start the workers and wait for them all to finish.  Only the one with rank 0
+        // prints anything, which is its time per step.
+        std::remove(output_file.c_str());
+        std::vector<std::thread> threads;
+        for (size_t rank = 0; rank < n; ++rank)
+        {
+            const string cmd = string("\"") + argv[0] + "\" --worker " + cast_to_string(rank) + " " + cast_to_string(n) + " " +
+                               cast_to_string(num_steps) + (rank == 0 ? " > " + output_file : "");
+            threads.emplace_back([cmd]() { std::system(cmd.c_str()); });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        double ms_per_step = 0;
+        std::ifstream fin(output_file);
+        if (!(fin >> ms_per_step))
+        {
+            cout << "the workers failed" << endl;
+            return 1;
+        }
+        if (n == 1)
+            time_one_worker = ms_per_step;
+        cout << n << " workers:\t" << ms_per_step << " ms per step, "
+             << mini_batch_size/ms_per_step*1000 << " samples per second, speedup: " << time_one_worker/ms_per_step << endl;
+    }
+    std::remove(output_file.c_str());
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+
@@ -0,0 +1,71 @@
+/*
+
+    This program times an inference_net whose con_ and fc_ filters are stored as
+    float32, bfloat16 and float16.  The network is a stack of large fc_ layers, which on
+    small mini-batches spend most of their time reading their weights from memory, so
+    halving the size of the weights makes them faster.  It also prints how far the 16
+    bit versions' outputs are from the float32 ones.
+
+    usage: dnn_reduced_precision_benchmark [mini-batch size] [iterations]
+
+*/
+
+#include <dlib/dnn.h>
+#include <iostream>
+#include <chrono>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+using net_type = loss_multiclass_log<fc<1000,relu<fc<4096,relu<fc<4096,relu<fc<4096,input<matrix<float>>>>>>>>>>;
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const size_t batch_size = argc > 1 ? atoi(argv[1]) : 1;
+    const int num_iterations = argc > 2 ? atoi(argv[2]) : 20;
+
+    dlib::rand rnd;
+    std::vector<matrix<float>> samples(batch_size);
+    for (auto& s : samples)
+        s = matrix_cast<float>(randm(2048, 1, rnd));
+
+    net_type net;
+    resizable_tensor x;
+    net.to_tensor(samples.begin(), samples.end(), x);
+    net.subnet().forward(x);
+
+    size_t num_params = 0;
+    visit_layer_parameters(net, [&](size_t, tensor& t) { num_params += t.size(); });
+
+    matrix<float> reference;
+    double float_time = 0;
+    for (auto precision : {storage_precision::float32, storage_precision::bfloat16, storage_precision::float16})
+    {
+        inference_net inet = compile_for_inference(net, precision);
+        const matrix<float> out = mat(inet.forward(x));
+        if (precision == storage_precision::float32)
+            reference = out;
+
+        const auto start = chrono::steady_clock::now();
+        for (int i = 0; i < num_iterations; ++i)
+            inet.forward(x);
+        const double secs = chrono::duration<double>(chrono::steady_clock::now()-start).count()/num_iterations;
+        if (precision == storage_precision::float32)
+            float_time = secs;
+
+        const size_t bytes = num_params*(precision == storage_precision::float32 ? 4 : 2);
+        cout << precision << ":\t" << secs*1000 << " ms per forward, " << bytes/1024.0/1024.0 << " MB of parameters, "
+             << "speedup: " << float_time/secs << ", largest relative difference: "
+             << max(abs(out-reference))/max(abs(reference)) << endl;
+    }
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+
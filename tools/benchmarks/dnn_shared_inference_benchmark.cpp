@@ -0,0 +1,148 @@
+/*
+
+    This program measures the throughput of shared_inference_net when many threads run
+    the network from dnn_face_recognition_ex.cpp at the same time, using 1, 2, 4, ...
+    threads up to the number of cores on the machine.  It also reports how much memory
+    each thread needs compared to giving each thread its own copy of the network.  The
+    network is randomly initialized, which doesn't matter for timing purposes, so no
+    model files are needed.
+
+*/
+
+#include <dlib/dnn.h>
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+// The face recognition ResNet from dnn_face_recognition_ex.cpp, in both its training
+// form with bn_con layers and its inference form where they have become affine layers.
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual = add_prev1<block<N,BN,1,tag1<SUBNET>>>;
+
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual_down = add_prev2<avg_pool<2,2,2,2,skip1<tag2<block<N,BN,2,tag1<SUBNET>>>>>>;
+
+template <int N, template <typename> class BN, int stride, typename SUBNET> 
+using block  = BN<con<N,3,3,1,1,relu<BN<con<N,3,3,stride,stride,SUBNET>>>>>;
+
+template <int N, typename SUBNET> using res       = relu<residual<block,N,bn_con,SUBNET>>;
+template <int N, typename SUBNET> using ares      = relu<residual<block,N,affine,SUBNET>>;
+template <int N, typename SUBNET> using res_down  = relu<residual_down<block,N,bn_con,SUBNET>>;
+template <int N, typename SUBNET> using ares_down = relu<residual_down<block,N,affine,SUBNET>>;
+
+template <typename SUBNET> using level0 = res_down<256,SUBNET>;
+template <typename SUBNET> using level1 = res<256,res<256,res_down<256,SUBNET>>>;
+template <typename SUBNET> using level2 = res<128,res<128,res_down<128,SUBNET>>>;
+template <typename SUBNET> using level3 = res<64,res<64,res<64,res_down<64,SUBNET>>>>;
+template <typename SUBNET> using level4 = res<32,res<32,res<32,SUBNET>>>;
+
+template <typename SUBNET> using alevel0 = ares_down<256,SUBNET>;
+template <typename SUBNET> using alevel1 = ares<256,ares<256,ares_down<256,SUBNET>>>;
+template <typename SUBNET> using alevel2 = ares<128,ares<128,ares_down<128,SUBNET>>>;
+template <typename SUBNET> using alevel3 = ares<64,ares<64,ares<64,ares_down<64,SUBNET>>>>;
+template <typename SUBNET> using alevel4 = ares<32,ares<32,ares<32,SUBNET>>>;
+
+using net_type = loss_metric<fc_no_bias<128,avg_pool_everything<
+                            level0<
+                            level1<
+                            level2<
+                            level3<
+                            level4<
+                            max_pool<3,3,2,2,relu<bn_con<con<32,7,7,2,2,
+                            input_rgb_image_sized<150>
+                            >>>>>>>>>>>>;
+
+using anet_type = loss_metric<fc_no_bias<128,avg_pool_everything<
+                            alevel0<
+                            alevel1<
+                            alevel2<
+                            alevel3<
+                            alevel4<
+                            max_pool<3,3,2,2,relu<affine<con<32,7,7,2,2,
+                            input_rgb_image_sized<150>
+                            >>>>>>>>>>>>;
+
+// ----------------------------------------------------------------------------------------
+
+std::vector<size_t> thread_counts (
+)
+{
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < max_threads; n *= 2)
+        counts.push_back(n);
+    counts.push_back(max_threads);
+    return counts;
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const int batches_per_thread = argc > 1 ? std::stoi(argv[1]) : 4;
+    const size_t batch_size = argc > 2 ? std::stoi(argv[2]) : 8;
+
+    dlib::rand rnd;
+    std::vector<matrix<rgb_pixel>> faces(batch_size);
+    for (auto& img : faces)
+    {
+        img.set_size(150,150);
+        for (auto& p : img)
+            p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+    }
+
+    net_type net;
+    resizable_tensor x;
+    net.to_tensor(faces.begin(), faces.begin()+1, x);
+    net.subnet().forward(x);
+    anet_type anet = net;
+
+    size_t param_bytes = 0;
+    visit_layer_parameters(anet, [&](size_t, tensor& t) { param_bytes += t.size()*sizeof(float); });
+    inference_net inet = compile_for_inference(anet);
+    anet.to_tensor(faces.begin(), faces.end(), x);
+    inet.forward(x);
+    cout << "parameters: " << param_bytes/1024/1024 << " MB, shared by all threads" << endl;
+    cout << "memory per thread for a batch of " << batch_size << " faces: " << inet.peak_memory_usage()/1024/1024
+         << " MB, whereas a copy of the network per thread would also hold its own parameters" << endl;
+
+    // Each calling thread is its own unit of parallelism, so keep the kernels serial.
+    set_dnn_cpu_num_threads(1);
+    shared_inference_net<anet_type> snet(anet);
+    double baseline = 0;
+    for (auto n : thread_counts())
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < n; ++t)
+        {
+            threads.emplace_back([&]()
+            {
+                for (int i = 0; i < batches_per_thread; ++i)
+                    snet(faces, batch_size);
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        const auto stop = std::chrono::steady_clock::now();
+
+        const double secs = std::chrono::duration<double>(stop-start).count();
+        const double faces_per_sec = n*batches_per_thread*batch_size/secs;
+        if (baseline == 0)
+            baseline = faces_per_sec;
+        cout << "   " << n << " threads: " << faces_per_sec << " faces per second, speedup " << faces_per_sec/baseline << endl;
+    }
+    cout << "execution contexts created: " << snet.num_contexts() << endl;
+
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
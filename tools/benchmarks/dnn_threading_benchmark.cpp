@@ -0,0 +1,152 @@
+/*
+
+    This program measures how the CPU implementations of the tt:: tensor routines scale
+    with the number of threads given to set_dnn_cpu_num_threads().  It times forward
+    passes of the network from dnn_face_recognition_ex.cpp and training steps of a small
+    ResNet like the one in dnn_introduction2_ex.cpp, both randomly initialized, using 1,
+    2, 4, ... threads up to the number of cores on the machine.
+
+*/
+
+#include <dlib/dnn.h>
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+// The face recognition ResNet from dnn_face_recognition_ex.cpp
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual = add_prev1<block<N,BN,1,tag1<SUBNET>>>;
+
+template <template <int,template<typename>class,int,typename> class block, int N, template<typename>class BN, typename SUBNET>
+using residual_down = add_prev2<avg_pool<2,2,2,2,skip1<tag2<block<N,BN,2,tag1<SUBNET>>>>>>;
+
+template <int N, template <typename> class BN, int stride, typename SUBNET> 
+using block  = BN<con<N,3,3,1,1,relu<BN<con<N,3,3,stride,stride,SUBNET>>>>>;
+
+template <int N, typename SUBNET> using ares      = relu<residual<block,N,affine,SUBNET>>;
+template <int N, typename SUBNET> using ares_down = relu<residual_down<block,N,affine,SUBNET>>;
+
+template <typename SUBNET> using alevel0 = ares_down<256,SUBNET>;
+template <typename SUBNET> using alevel1 = ares<256,ares<256,ares_down<256,SUBNET>>>;
+template <typename SUBNET> using alevel2 = ares<128,ares<128,ares_down<128,SUBNET>>>;
+template <typename SUBNET> using alevel3 = ares<64,ares<64,ares<64,ares_down<64,SUBNET>>>>;
+template <typename SUBNET> using alevel4 = ares<32,ares<32,ares<32,SUBNET>>>;
+
+using face_net_type = loss_metric<fc_no_bias<128,avg_pool_everything<
+                            alevel0<
+                            alevel1<
+                            alevel2<
+                            alevel3<
+                            alevel4<
+                            max_pool<3,3,2,2,relu<affine<con<32,7,7,2,2,
+                            input_rgb_image_sized<150>
+                            >>>>>>>>>>>>;
+
+// A small ResNet in the style of dnn_introduction2_ex.cpp, trained with batch
+// normalization.
+template <int N, typename SUBNET> using bres = relu<residual<block,N,bn_con,SUBNET>>;
+
+using train_net_type = loss_multiclass_log<fc<10,avg_pool_everything<
+                            bres<32,bres<32,bres<32,
+                            max_pool<2,2,2,2,relu<bn_con<con<32,3,3,1,1,
+                            input_rgb_image
+                            >>>>>>>>>>;
+
+// ----------------------------------------------------------------------------------------
+
+std::vector<size_t> thread_counts (
+)
+{
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < max_threads; n *= 2)
+        counts.push_back(n);
+    counts.push_back(max_threads);
+    return counts;
+}
+
+template <typename funct_type>
+double time_it (
+    funct_type&& funct,
+    int iterations
+)
+{
+    // warm up so that the layers are allocated before we start timing.
+    funct();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        funct();
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count()/iterations;
+}
+
+template <typename funct_type>
+void report_scaling (
+    const std::string& name,
+    funct_type&& funct,
+    int iterations
+)
+{
+    cout << name << endl;
+    double baseline = 0;
+    for (auto n : thread_counts())
+    {
+        set_dnn_cpu_num_threads(n);
+        const double ms = time_it(funct, iterations);
+        if (n == 1)
+            baseline = ms;
+        cout << "   " << n << " threads: " << ms << " ms, speedup " << baseline/ms << endl;
+    }
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+#ifdef DLIB_USE_CUDA
+    cout << "dlib was built with CUDA so the CPU tensor routines timed here aren't used." << endl;
+#endif
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 5;
+
+    dlib::rand rnd;
+    auto random_images = [&](size_t num, long size)
+    {
+        std::vector<matrix<rgb_pixel>> images(num);
+        for (auto& img : images)
+        {
+            img.set_size(size,size);
+            for (auto& p : img)
+                p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+        }
+        return images;
+    };
+
+    face_net_type face_net;
+    resizable_tensor x;
+    const auto faces = random_images(8, 150);
+    face_net.to_tensor(faces.begin(), faces.end(), x);
+    report_scaling("dnn_face_recognition_ex network, forward pass of 8 faces",
+        [&]() { face_net.subnet().forward(x); }, iterations);
+
+    train_net_type train_net;
+    resizable_tensor y;
+    const auto images = random_images(32, 32);
+    std::vector<unsigned long> labels(images.size());
+    for (auto& l : labels)
+        l = rnd.get_random_32bit_number()%10;
+    train_net.to_tensor(images.begin(), images.end(), y);
+    report_scaling("small ResNet, forward and backward pass of 32 32x32 images",
+        [&]() { train_net.compute_parameter_gradients(y, labels.begin()); }, iterations);
+
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
@@ -0,0 +1,104 @@
+/*
+
+    This program compares running the face detector network from dnn_mmod_ex.cpp on a
+    large image the usual way, with the whole image pyramid in one tensor, to running it
+    with a tiled_mmod_detector.  It prints the time each takes, the memory used for the
+    layer outputs, and how many detections they agree on.  The network is randomly
+    initialized, which doesn't matter for timing purposes, so no model files are needed.
+
+    usage: dnn_tiled_mmod_benchmark [image width] [image height] [tile size] [threads]
+
+*/
+
+#include <dlib/dnn.h>
+#include <iostream>
+#include <chrono>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+template <long num_filters, typename SUBNET> using con5d = con<num_filters,5,5,2,2,SUBNET>;
+template <long num_filters, typename SUBNET> using con5  = con<num_filters,5,5,1,1,SUBNET>;
+
+template <typename SUBNET> using downsampler  = relu<bn_con<con5d<32, relu<bn_con<con5d<32, relu<bn_con<con5d<16,SUBNET>>>>>>>>>;
+template <typename SUBNET> using rcon5  = relu<bn_con<con5<45,SUBNET>>>;
+
+using net_type = loss_mmod<con<1,9,9,1,1,rcon5<rcon5<rcon5<downsampler<input_rgb_image_pyramid<pyramid_down<6>>>>>>>>;
+
+// ----------------------------------------------------------------------------------------
+
+// Adds up the outputs of the con and relu layers.  The relu layers work in place on the
+// outputs of the bn_con layers, so that's all the memory the network uses for its layer
+// outputs.
+struct count_output_memory
+{
+    size_t& bytes;
+    template <typename U, typename E>
+    void operator()(size_t, const add_layer<relu_,U,E>& l) { bytes += l.get_output().size()*sizeof(float); }
+    template <long a, long b, long c, int d, int e, int f, int g, typename U, typename E>
+    void operator()(size_t, const add_layer<con_<a,b,c,d,e,f,g>,U,E>& l) { bytes += l.get_output().size()*sizeof(float); }
+    template <typename T>
+    void operator()(size_t, const T&) {}
+};
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const long nc = argc > 1 ? atoi(argv[1]) : 2000;
+    const long nr = argc > 2 ? atoi(argv[2]) : 1500;
+    const long tile_size = argc > 3 ? atoi(argv[3]) : 512;
+    const size_t num_threads = argc > 4 ? atoi(argv[4]) : 1;
+
+    mmod_options options;
+    options.detector_windows = {mmod_options::detector_window_details(40,40)};
+    net_type net(options);
+
+    dlib::rand rnd;
+    matrix<rgb_pixel> img(nr, nc);
+    for (auto& p : img)
+        p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+
+    // Random weights give random scores, so use a threshold that keeps a reasonable
+    // number of detections.
+    const double thresh = 0.5;
+
+    auto start = chrono::steady_clock::now();
+    const auto full = net.process(img, thresh);
+    const double full_time = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    size_t full_memory = 0;
+    visit_layers(net, count_output_memory{full_memory});
+
+    tiled_mmod_detector<net_type> det(net, tile_size, 1, num_threads);
+    start = chrono::steady_clock::now();
+    const auto tiled = det(img, thresh);
+    const double tiled_time = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+
+    size_t num_same = 0;
+    for (auto& a : full)
+    {
+        for (auto& b : tiled)
+        {
+            if (a.rect == b.rect)
+            {
+                ++num_same;
+                break;
+            }
+        }
+    }
+
+    cout << "image: " << nc << "x" << nr << ", tile size: " << tile_size << ", margin: " << det.get_margin() << endl;
+    cout << "whole image: " << full_time << " seconds, " << full_memory/1024.0/1024.0 << " MB of layer outputs, "
+         << full.size() << " detections" << endl;
+    cout << "tiled:       " << tiled_time << " seconds, " << det.peak_memory_usage()/1024.0/1024.0 << " MB per thread, "
+         << tiled.size() << " detections" << endl;
+    cout << "detections in common: " << num_same << endl;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+
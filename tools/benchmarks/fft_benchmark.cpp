@@ -0,0 +1,88 @@
+/*
+
+    This program times dlib's fft() on a range of 1D and 2D sizes.  For each size it
+    reports the time of one transform of complex data, of real data, and of complex data
+    zero padded up to the next power of two in each dimension, which is what you had to
+    do before fft() accepted sizes that aren't powers of two.  The times are in
+    milliseconds.
+
+    The rows and columns of large 2D transforms are split across the threads in
+    default_thread_pool(), so set the DLIB_NUM_THREADS environment variable to see how
+    they scale.
+
+    usage: fft_benchmark [number of repetitions]
+
+*/
+
+#include <dlib/matrix.h>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+template <typename F>
+double time_it (
+    long reps,
+    F&& funct
+)
+{
+    funct(); // warm up and build the FFT plans.
+    const auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < reps; ++i)
+        funct();
+    return 1000*std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count()/reps;
+}
+
+long next_power_of_two (
+    long n
+)
+{
+    long p = 1;
+    while (p < n)
+        p *= 2;
+    return p;
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const long reps = argc > 1 ? std::stol(argv[1]) : 10;
+
+    const long sizes[][2] = {
+        {1,4096}, {1,4000}, {1,4099}, {1,65536}, {1,100000},
+        {256,256}, {250,250}, {512,512}, {500,500}, {480,640}, {1024,1024}, {1000,1000}, {720,1280}
+    };
+
+    cout << setw(14) << "size" << setw(12) << "complex" << setw(12) << "real" << setw(16) << "padded to 2^k" << endl;
+    for (auto& s : sizes)
+    {
+        const long nr = s[0], nc = s[1];
+        const matrix<double> x = gaussian_randm(nr, nc, nr*nc);
+        const matrix<complex<double> > z = complex_matrix(x, gaussian_randm(nr, nc, nr+nc));
+        matrix<complex<double> > padded = zeros_matrix<complex<double> >(next_power_of_two(nr), next_power_of_two(nc));
+        set_subm(padded, 0, 0, nr, nc) = z;
+
+        matrix<complex<double> > out;
+        const double tc = time_it(reps, [&]() { out = fft(z); });
+        const double tr = time_it(reps, [&]() { out = fft(x); });
+        const double tp = time_it(reps, [&]() { out = fft(padded); });
+
+        ostringstream sout;
+        sout << nr << "x" << nc;
+        cout << setw(14) << sout.str() << setw(12) << tc << setw(12) << tr << setw(16) << tp << endl;
+    }
+
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+
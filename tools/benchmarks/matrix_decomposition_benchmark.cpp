@@ -0,0 +1,103 @@
+/*
+
+    This program times dlib's cholesky_decomposition, lu_decomposition,
+    qr_decomposition (including the call to get_q()) and eigenvalue_decomposition of
+    a symmetric matrix on random NxN double precision matrices, for N from 256 up to
+    a maximum size.  It also prints the largest reconstruction error of each
+    decomposition as a sanity check.  The times are in seconds.
+
+    When dlib is built without LAPACK these are dlib's own blocked implementations,
+    which do most of their work in default_matrix_multiply() and spread it over the
+    threads in default_thread_pool().  With DLIB_USE_LAPACK defined the LAPACK routines
+    are timed instead.
+
+    usage: matrix_decomposition_benchmark [max size]
+
+*/
+
+#include <dlib/matrix.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+template <typename F>
+double time_it (
+    F&& funct
+)
+{
+    const auto start = std::chrono::steady_clock::now();
+    funct();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const long max_size = argc > 1 ? std::stol(argv[1]) : 4096;
+
+#ifdef DLIB_USE_LAPACK
+    cout << "dlib was built with LAPACK, so these are the LAPACK routines." << endl;
+#endif
+    cout << setw(6) << "N"
+         << setw(12) << "cholesky" << setw(12) << "lu" << setw(12) << "qr"
+         << setw(12) << "sym eig" << setw(14) << "max error" << endl;
+
+    for (long n = 256; n <= max_size; n *= 2)
+    {
+        const matrix<double> A = gaussian_randm(n,n,n);
+        const matrix<double> S = make_symmetric(A);
+        const matrix<double> P = A*trans(A) + n*identity_matrix<double>(n);
+        matrix<double> L, U, Q, R, V, D;
+        matrix<long,0,1> piv;
+
+        const double tchol = time_it([&]()
+        {
+            cholesky_decomposition<matrix<double>> chol(P);
+            L = chol.get_l();
+        });
+        double error = max(abs(L*trans(L) - P))/max(abs(P));
+
+        const double tlu = time_it([&]()
+        {
+            lu_decomposition<matrix<double>> lu(A);
+            L = lu.get_l();
+            U = lu.get_u();
+            piv = lu.get_pivot();
+        });
+        error = std::max(error, max(abs(L*U - rowm(A,piv)))/max(abs(A)));
+
+        const double tqr = time_it([&]()
+        {
+            qr_decomposition<matrix<double>> qr(A);
+            Q = qr.get_q();
+            R = qr.get_r();
+        });
+        error = std::max(error, max(abs(Q*R - A))/max(abs(A)));
+
+        const double teig = time_it([&]()
+        {
+            eigenvalue_decomposition<matrix<double>> eig(make_symmetric(S));
+            V = eig.get_pseudo_v();
+            D = diagm(eig.get_real_eigenvalues());
+        });
+        error = std::max(error, max(abs(V*D*trans(V) - S))/max(abs(S)));
+
+        cout << setw(6) << n
+             << setw(12) << tchol << setw(12) << tlu << setw(12) << tqr
+             << setw(12) << teig << setw(14) << error << endl;
+    }
+
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+
@@ -0,0 +1,112 @@
+/*
+
+    This program times dlib's built in matrix multiply, the one used when dlib isn't
+    linked to a BLAS library, on float and double matrices of several shapes: square
+    matrices, tall and skinny ones like the im2col matrices a convolution multiplies,
+    and a small batch of vectors times a large matrix like an fc layer computes.  For
+    comparison it also times the simple cache blocked algorithm dlib used before for
+    float and double, and the BLAS library dlib was built with, if any.  The results are
+    in GFLOPS, so bigger is better.
+
+    usage: matrix_multiply_benchmark [seconds per test]
+
+*/
+
+#include <dlib/matrix.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+template <typename F>
+double gflops (
+    F&& multiply,
+    long m,
+    long n,
+    long k,
+    double seconds
+)
+{
+    multiply();
+    long iterations = 0;
+    const auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do
+    {
+        multiply();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    } while (elapsed < seconds);
+    return 2.0*m*n*k*iterations/elapsed/1e9;
+}
+
+template <typename T>
+void time_shape (
+    const std::string& name,
+    long m,
+    long n,
+    long k,
+    double seconds
+)
+{
+    const matrix<T> lhs = matrix_cast<T>(randm(m,k));
+    const matrix<T> rhs = matrix_cast<T>(randm(k,n));
+    matrix<T> dest(m,n);
+
+    const double blocked = gflops([&]() { dest = 0; ma::blocked_matrix_multiply(dest, lhs, rhs); }, m, n, k, seconds);
+    const double packed = gflops([&]() { dest = 0; default_matrix_multiply(dest, lhs, rhs); }, m, n, k, seconds);
+
+    cout << setw(8) << (sizeof(T) == sizeof(float) ? "float" : "double")
+         << setw(36) << name + " " + cast_to_string(m) + "x" + cast_to_string(k) + "*" + cast_to_string(k) + "x" + cast_to_string(n)
+         << setw(12) << blocked << setw(12) << packed;
+#ifdef DLIB_USE_BLAS
+    // With DLIB_USE_BLAS defined this goes to the BLAS library's gemm.
+    const double blas = gflops([&]() { dest = lhs*rhs; }, m, n, k, seconds);
+    cout << setw(12) << blas;
+#endif
+    cout << endl;
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const double seconds = argc > 1 ? std::stod(argv[1]) : 1;
+
+    cout << setw(8) << "type" << setw(36) << "shape" << setw(12) << "blocked" << setw(12) << "packed";
+#ifdef DLIB_USE_BLAS
+    cout << setw(12) << "BLAS";
+#endif
+    cout << endl;
+
+    for (int use_double = 0; use_double < 2; ++use_double)
+    {
+        auto time = [&](const std::string& name, long m, long n, long k)
+        {
+            if (use_double)
+                time_shape<double>(name, m, n, k, seconds);
+            else
+                time_shape<float>(name, m, n, k, seconds);
+        };
+        time("square", 64, 64, 64);
+        time("square", 256, 256, 256);
+        time("square", 1024, 1024, 1024);
+        time("tall-skinny", 16384, 64, 576);
+        time("tall-skinny", 4096, 256, 1152);
+        time("small batch", 1, 1024, 1024);
+        time("small batch", 8, 1024, 1024);
+        time("small batch", 32, 4096, 1024);
+    }
+
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+
@@ -0,0 +1,139 @@
+/*
+
+    This program times the two steps of turning a detector's output into detections on
+    synthetic data.  First, finding the scores above the detection threshold, with a
+    plain loop and with find_scores_above_threshold().  Second, non-max suppression of
+    thousands of candidate boxes, by checking each box against every box kept so far
+    and with non_max_suppression().  It also checks that both ways give the same
+    results.
+
+    The boxes are made like those of a detector run on an image pyramid.  There are
+    objects scattered around the image, each with a cluster of boxes of about its size
+    around it, plus boxes of all sizes scattered over the whole image.
+
+    usage: nms_benchmark [number of boxes] [image width] [image height]
+
+*/
+
+#include <dlib/image_processing.h>
+#include <dlib/rand.h>
+#include <iostream>
+#include <chrono>
+
+using namespace dlib;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------
+
+std::vector<rectangle> make_boxes (
+    size_t num,
+    long nc,
+    long nr
+)
+{
+    dlib::rand rnd;
+    std::vector<std::pair<double,rectangle>> dets;
+    std::vector<rectangle> objects;
+    for (size_t i = 0; i < num/20; ++i)
+    {
+        const long size = 40*std::pow(1.2, rnd.get_random_32bit_number()%15);
+        objects.push_back(centered_rect(point(rnd.get_random_32bit_number()%nc, rnd.get_random_32bit_number()%nr), size, size));
+    }
+
+    while (dets.size() < num)
+    {
+        rectangle rect;
+        if (rnd.get_random_double() < 0.8)
+        {
+            const rectangle& obj = objects[rnd.get_random_32bit_number()%objects.size()];
+            const double scale = 1 + 0.2*rnd.get_random_gaussian();
+            rect = centered_rect(center(obj) + point(obj.width()*0.2*rnd.get_random_gaussian(), obj.height()*0.2*rnd.get_random_gaussian()),
+                                 obj.width()*scale, obj.height()*scale);
+        }
+        else
+        {
+            const long size = 40*std::pow(1.2, rnd.get_random_32bit_number()%15);
+            rect = centered_rect(point(rnd.get_random_32bit_number()%nc, rnd.get_random_32bit_number()%nr), size, size);
+        }
+        dets.push_back(std::make_pair(rnd.get_random_double(), rect));
+    }
+
+    std::sort(dets.rbegin(), dets.rend(), [](const std::pair<double,rectangle>& a, const std::pair<double,rectangle>& b)
+              { return a.first < b.first; });
+    std::vector<rectangle> boxes;
+    for (auto& d : dets)
+        boxes.push_back(d.second);
+    return boxes;
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const size_t num_boxes = argc > 1 ? atoi(argv[1]) : 10000;
+    const long nc = argc > 2 ? atoi(argv[2]) : 4000;
+    const long nr = argc > 3 ? atoi(argv[3]) : 3000;
+
+    // The output of a 2 window detector on a 2000x1500 pyramid image.  Random scores
+    // with a threshold that keeps about 1 in 1000 of them.
+    dlib::rand rnd;
+    std::vector<float> scores(2*2000*1500);
+    for (auto& s : scores)
+        s = rnd.get_random_gaussian();
+    const double thresh = 3.1;
+
+    const int num_scans = 20;
+    std::vector<unsigned long> idx1, idx2;
+    auto start = chrono::steady_clock::now();
+    for (int iter = 0; iter < num_scans; ++iter)
+    {
+        idx1.clear();
+        for (size_t i = 0; i < scores.size(); ++i)
+        {
+            if (scores[i] > thresh)
+                idx1.push_back(i);
+        }
+    }
+    const double loop_time = chrono::duration<double>(chrono::steady_clock::now()-start).count()/num_scans;
+
+    start = chrono::steady_clock::now();
+    for (int iter = 0; iter < num_scans; ++iter)
+        find_scores_above_threshold(scores.data(), scores.size(), thresh, idx2);
+    const double simd_time = chrono::duration<double>(chrono::steady_clock::now()-start).count()/num_scans;
+
+    cout << "threshold scan of " << scores.size() << " scores, " << idx1.size() << " above threshold" << endl;
+    cout << "    plain loop:                  " << loop_time*1000 << " ms" << endl;
+    cout << "    find_scores_above_threshold: " << simd_time*1000 << " ms" << endl;
+    cout << "    speedup: " << loop_time/simd_time << (idx1 == idx2 ? "" : "  RESULTS DIFFER") << endl;
+
+
+    const std::vector<rectangle> boxes = make_boxes(num_boxes, nc, nr);
+    const test_box_overlap overlaps(0.4);
+
+    start = chrono::steady_clock::now();
+    std::vector<unsigned long> keep1;
+    std::vector<rectangle> kept;
+    for (unsigned long i = 0; i < boxes.size(); ++i)
+    {
+        if (overlaps_any_box(overlaps, kept, boxes[i]))
+            continue;
+        kept.push_back(boxes[i]);
+        keep1.push_back(i);
+    }
+    const double linear_time = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+
+    start = chrono::steady_clock::now();
+    const std::vector<unsigned long> keep2 = non_max_suppression(overlaps, boxes);
+    const double index_time = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+
+    cout << "non-max suppression of " << boxes.size() << " boxes, " << keep1.size() << " kept" << endl;
+    cout << "    checking every kept box: " << linear_time*1000 << " ms" << endl;
+    cout << "    non_max_suppression:     " << index_time*1000 << " ms" << endl;
+    cout << "    speedup: " << linear_time/index_time << (keep1 == keep2 ? "" : "  RESULTS DIFFER") << endl;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+
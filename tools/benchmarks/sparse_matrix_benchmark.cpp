@@ -0,0 +1,120 @@
+/*
+
+    This program compares sparse data stored as a std::vector of sparse vectors against
+    the same data stored in a dlib::sparse_matrix.  It times A*x, A*X and trans(A)*X,
+    where x is a dense vector and X a dense matrix with 32 columns, and then svd_fast()
+    with both representations.  The std::vector products are computed with the usual
+    loops over the sparse vectors, one row at a time.  The times are in seconds.
+
+    The sparse_matrix products are split across the threads in default_thread_pool(), so
+    set the DLIB_NUM_THREADS environment variable to see how they scale.
+
+    usage: sparse_matrix_benchmark [rows] [columns] [nonzeros per row]
+
+*/
+
+#include <dlib/matrix.h>
+#include <dlib/sparse_vector.h>
+#include <dlib/rand.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+
+using namespace dlib;
+using namespace std;
+
+typedef std::vector<std::pair<unsigned long,double> > sparse_vect;
+
+// ----------------------------------------------------------------------------------------
+
+template <typename F>
+double time_it (
+    F&& funct
+)
+{
+    const auto start = std::chrono::steady_clock::now();
+    funct();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+// ----------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) try
+{
+    const long num_rows = argc > 1 ? std::stol(argv[1]) : 200000;
+    const long num_cols = argc > 2 ? std::stol(argv[2]) : 100000;
+    const long nnz_per_row = argc > 3 ? std::stol(argv[3]) : 50;
+
+    dlib::rand rnd;
+    std::vector<sparse_vect> rows(num_rows);
+    for (auto& v : rows)
+    {
+        for (long i = 0; i < nnz_per_row; ++i)
+            v.push_back(make_pair(rnd.get_integer(num_cols), rnd.get_random_gaussian()));
+        make_sparse_vector_inplace(v);
+    }
+
+    sparse_matrix<double> A;
+    const double tconvert = time_it([&]() { A = sparse_matrix<double>(rows, num_cols); });
+    cout << num_rows << " x " << num_cols << " with " << A.num_nonzero() << " nonzeros" << endl;
+    cout << "converting to sparse_matrix: " << tconvert << endl << endl;
+
+    const long k = 32;
+    const matrix<double,0,1> x = gaussian_randm(num_cols, 1, 0);
+    const matrix<double> X = gaussian_randm(num_cols, k, 1);
+    const matrix<double> Xt = gaussian_randm(num_rows, k, 2);
+    matrix<double,0,1> y1, y2;
+    matrix<double> Y1, Y2;
+
+    cout << setw(14) << "" << setw(14) << "std::vector" << setw(14) << "sparse_matrix" << setw(14) << "max diff" << endl;
+
+    double t1 = time_it([&]()
+    {
+        y1.set_size(num_rows);
+        for (long r = 0; r < num_rows; ++r)
+            y1(r) = dot(rows[r], x);
+    });
+    double t2 = time_it([&]() { y2 = A*x; });
+    cout << setw(14) << "A*x" << setw(14) << t1 << setw(14) << t2 << setw(14) << max(abs(y1-y2)) << endl;
+
+    t1 = time_it([&]()
+    {
+        Y1.set_size(num_rows, k);
+        Y1 = 0;
+        for (long r = 0; r < num_rows; ++r)
+        {
+            for (auto& p : rows[r])
+                set_rowm(Y1,r) += p.second*rowm(X,p.first);
+        }
+    });
+    t2 = time_it([&]() { Y2 = A*X; });
+    cout << setw(14) << "A*X" << setw(14) << t1 << setw(14) << t2 << setw(14) << max(abs(Y1-Y2)) << endl;
+
+    t1 = time_it([&]()
+    {
+        Y1.set_size(num_cols, k);
+        Y1 = 0;
+        for (long r = 0; r < num_rows; ++r)
+        {
+            for (auto& p : rows[r])
+                set_rowm(Y1,p.first) += p.second*rowm(Xt,r);
+        }
+    });
+    t2 = time_it([&]() { Y2 = trans(A)*Xt; });
+    cout << setw(14) << "trans(A)*X" << setw(14) << t1 << setw(14) << t2 << setw(14) << max(abs(Y1-Y2)) << endl;
+
+    matrix<double> u1, v1, u2, v2;
+    matrix<double,0,1> w1, w2;
+    t1 = time_it([&]() { svd_fast(rows, u1, w1, v1, 50, 1); });
+    t2 = time_it([&]() { svd_fast(A, u2, w2, v2, 50, 1); });
+    cout << setw(14) << "svd_fast" << setw(14) << t1 << setw(14) << t2 << setw(14) << max(abs(w1-w2))/max(w1) << endl;
+
+    return 0;
+}
+catch (std::exception& e)
+{
+    cout << e.what() << endl;
+    return 1;
+}
+